@@ -9,7 +9,9 @@
 
 #include "bundle6/create.h"
 
+#include "bundle7/bundle7.h"
 #include "bundle7/create.h"
+#include "bundle7/profile.h"
 
 #include "cla/posix/cla_tcp_util.h"
 
@@ -23,10 +25,12 @@
 #include "platform/posix/pipe_queue_util.h"
 #include "platform/posix/socket_util.h"
 
+#include "ud3tn/admission_control.h"
 #include "ud3tn/common.h"
 #include "ud3tn/bundle.h"
 #include "ud3tn/bundle_processor.h"
 #include "ud3tn/eid.h"
+#include "ud3tn/memory_budget.h"
 
 #include <pb_decode.h>
 #include <pb_encode.h>
@@ -43,6 +47,10 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
+// Size of the administrative record header prepended to BPDU payloads, i.e.
+// the CBOR array header and the record type.
+#define BPDU_AR_HEADER_SIZE 2
+
 struct aap2_agent_config {
 	const struct bundle_agent_interface *bundle_agent_interface;
 
@@ -62,6 +70,9 @@ struct aap2_agent_comm_config {
 	bool is_subscriber;
 	char *registered_eid;
 	char *secret;
+	// Profile of the BPv7 bundles sent from the registered EID, NULL if
+	// it could not be created or for BPv6.
+	struct bundle7_profile *profile;
 	int keepalive_timeout_ms;
 
 	// TODO: Move to common multiplexer/demux state in BP. For now, allow
@@ -157,6 +168,7 @@ static void aap2_agent_listener_task(void *const param)
 		child_config->is_subscriber = false;
 		child_config->registered_eid = NULL;
 		child_config->secret = NULL;
+		child_config->profile = NULL;
 		child_config->keepalive_timeout_ms = -1; // infinite
 
 		child_config->pb_istream = (pb_istream_t){
@@ -247,9 +259,12 @@ static void agent_msg_recv(struct bundle_adu data, void *param,
 		data.source
 	);
 
+	// Accounted before writing, as the reader may release it immediately.
+	memory_budget_charge(MEMORY_BUDGET_AGENT, data.length);
 	if (pipeq_write_all(config->bundle_pipe_fd[1],
 			    &data, sizeof(struct bundle_adu)) <= 0) {
 		LOG_ERRNO("AAP2Agent", "write()", errno);
+		memory_budget_release(MEMORY_BUDGET_AGENT, data.length);
 		bundle_adu_free_members(data);
 	}
 }
@@ -306,6 +321,8 @@ static void deregister_sink(struct aap2_agent_comm_config *config)
 	config->registered_eid = NULL;
 	free(config->secret);
 	config->secret = NULL;
+	bundle7_profile_unref(config->profile);
+	config->profile = NULL;
 }
 
 static uint64_t allocate_sequence_number(
@@ -366,6 +383,17 @@ static aap2_ResponseStatus process_configure_msg(
 	config->secret = msg->secret;
 	msg->secret = NULL; // take over freeing
 
+	// The same bundles as created by bundle7_create_local().
+	if (config->parent->bp_version == 7)
+		config->profile = bundle7_profile_create(
+			config->registered_eid,
+			"dtn:none",
+			config->parent->lifetime_ms,
+			DEFAULT_BPV7_CRC_TYPE,
+			BUNDLE7_PROFILE_BLOCKS_NONE,
+			0
+		);
+
 	config->keepalive_timeout_ms = -1; // infinite by default
 	if (msg->keepalive_seconds != 0) {
 		if (msg->keepalive_seconds >= (INT32_MAX / 1000 / 2)) {
@@ -437,20 +465,11 @@ static aap2_ResponseStatus process_adu_msg(
 			const uint8_t typecode = 3;
 		#endif
 
-		const size_t ar_size = payload_length + 2;
-		uint8_t *const ar_bytes = malloc(ar_size);
-
-		memcpy(
-			ar_bytes + 2,
-			payload_data,
-			payload_length
-		);
-		ar_bytes[0] = 0x82;     // CBOR array of length 2
-		ar_bytes[1] = typecode; // Integer (record type)
-
-		free(payload_data);
-		payload_data = ar_bytes;
-		payload_length = ar_size;
+		// The header is written to the space reserved in front of
+		// the payload by receive_payload(), the payload is not copied.
+		payload_data[0] = 0x82;     // CBOR array of length 2
+		payload_data[1] = typecode; // Integer (record type)
+		payload_length += BPDU_AR_HEADER_SIZE;
 		flags |= BUNDLE_FLAG_ADMINISTRATIVE_RECORD;
 	}
 
@@ -472,6 +491,16 @@ static aap2_ResponseStatus process_adu_msg(
 			config->parent->lifetime_ms,
 			flags
 		);
+	else if (config->profile)
+		bundle = bundle7_profile_create_bundle(
+			config->profile,
+			payload_data,
+			payload_length,
+			msg->dst_eid,
+			time_ms,
+			seqnum,
+			flags
+		);
 	else
 		bundle = bundle7_create_local(
 			payload_data,
@@ -489,6 +518,16 @@ static aap2_ResponseStatus process_adu_msg(
 		return aap2_ResponseStatus_RESPONSE_STATUS_ERROR;
 	}
 
+	// Reject the bundle at the source instead of dropping it in the BP.
+	if (admission_control_check(bundle) == ADMISSION_REJECT) {
+		LOGF_INFO(
+			"AAP2Agent: Rejecting bundle to \"%s\": Backlog full",
+			bundle->destination
+		);
+		bundle_free(bundle);
+		return aap2_ResponseStatus_RESPONSE_STATUS_BACKLOG_FULL;
+	}
+
 	bundle_processor_inform(
 		config->parent->bundle_agent_interface->bundle_signaling_queue,
 		(struct bundle_processor_signal){
@@ -569,14 +608,15 @@ static int process_aap_message(
 	return result;
 }
 
-static uint8_t *receive_payload(pb_istream_t *istream, size_t payload_length)
+static uint8_t *receive_payload(pb_istream_t *istream, size_t payload_length,
+				size_t headroom)
 {
 	if (payload_length > BUNDLE_MAX_SIZE) {
 		LOG_WARN("AAP2Agent: Payload too large!");
 		return NULL;
 	}
 
-	uint8_t *payload = malloc(payload_length);
+	uint8_t *payload = malloc(headroom + payload_length);
 
 	if (!payload) {
 		LOG_ERROR("AAP2Agent: Payload alloc error!");
@@ -584,7 +624,11 @@ static uint8_t *receive_payload(pb_istream_t *istream, size_t payload_length)
 	}
 
 
-	const bool success = pb_read(istream, payload, payload_length);
+	const bool success = pb_read(
+		istream,
+		payload + headroom,
+		payload_length
+	);
 
 	if (!success) {
 		free(payload);
@@ -604,12 +648,14 @@ static int send_bundle_from_pipe(struct aap2_agent_comm_config *const config)
 		LOG_ERRNO("AAP2Agent", "read()", errno);
 		return -1;
 	}
+	memory_budget_release(MEMORY_BUDGET_AGENT, data.length);
 
 	aap2_AAPMessage msg = aap2_AAPMessage_init_default;
 
 	msg.which_msg = aap2_AAPMessage_adu_tag;
-	msg.msg.adu.dst_eid = data.destination;
-	msg.msg.adu.src_eid = data.source;
+	// The message is only encoded, the interned EIDs are not modified.
+	msg.msg.adu.dst_eid = (char *)data.destination;
+	msg.msg.adu.src_eid = (char *)data.source;
 	msg.msg.adu.payload_length = data.length;
 	msg.msg.adu.creation_timestamp_ms = data.bundle_creation_timestamp_ms;
 	msg.msg.adu.sequence_number = data.bundle_sequence_number;
@@ -709,6 +755,7 @@ static void shutdown_bundle_pipe(int bundle_pipe_fd[2])
 			LOG_ERRNO("AAP2Agent", "read()", errno);
 			break;
 		}
+		memory_budget_release(MEMORY_BUDGET_AGENT, data.length);
 
 		LOGF_WARN(
 			"AAP2Agent: Dropping unsent bundle from '%s'.",
@@ -884,7 +931,13 @@ static void aap2_agent_comm_task(void *const param)
 			if (request.which_msg == aap2_AAPMessage_adu_tag) {
 				payload = receive_payload(
 					&config->pb_istream,
-					request.msg.adu.payload_length
+					request.msg.adu.payload_length,
+					(
+						request.msg.adu.adu_flags &
+						aap2_BundleADUFlags_BUNDLE_ADU_BPDU
+					)
+					? BPDU_AR_HEADER_SIZE
+					: 0
 				);
 			}
 
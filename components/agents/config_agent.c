@@ -7,6 +7,7 @@
 #include "ud3tn/eid.h"
 
 #include "platform/hal_io.h"
+#include "platform/hal_semaphore.h"
 #include "platform/hal_types.h"
 
 #include <stdbool.h>
@@ -16,6 +17,8 @@
 #include <string.h>
 
 static struct config_parser parser;
+// The callback may be invoked concurrently by multiple BP workers.
+static Semaphore_t parser_sem;
 
 struct config_agent_params {
 	const char *local_eid;
@@ -43,12 +46,14 @@ static void callback(struct bundle_adu data, void *param, const void *ctx)
 		free(node_id);
 	}
 
+	hal_semaphore_take_blocking(parser_sem);
 	config_parser_reset(&parser);
 	config_parser_read(
 		&parser,
 		data.payload,
 		data.length
 	);
+	hal_semaphore_release(parser_sem);
 	bundle_adu_free_members(data);
 }
 
@@ -65,6 +70,9 @@ int config_agent_setup(
 		&bundle_processor_handle_router_command,
 		bundle_processor_context
 	));
+	parser_sem = hal_semaphore_init_binary();
+	ASSERT(parser_sem != NULL);
+	hal_semaphore_release(parser_sem);
 
 	struct config_agent_params *const ca_param = malloc(
 		sizeof(struct config_agent_params)
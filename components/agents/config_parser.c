@@ -5,6 +5,7 @@
 
 #include "ud3tn/eid.h"
 #include "ud3tn/node.h"
+#include "ud3tn/object_pool.h"
 #include "ud3tn/router.h"
 
 #include <stdbool.h>
@@ -135,7 +136,7 @@ static bool read_cla_addr(
 
 static void begin_read_contact(struct config_parser *parser)
 {
-	struct contact_list *new_entry = malloc(sizeof(struct contact_list));
+	struct contact_list *new_entry = object_pool_alloc(&contact_list_pool);
 
 	new_entry->next = NULL;
 	new_entry->data = contact_create(parser->router_command->data);
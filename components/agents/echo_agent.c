@@ -2,6 +2,7 @@
 #include "agents/echo_agent.h"
 
 #include "platform/hal_io.h"
+#include "platform/hal_semaphore.h"
 #include "platform/hal_time.h"
 
 #include "ud3tn/agent_util.h"
@@ -17,7 +18,12 @@ struct echo_agent_params {
 	bool is_ipn;
 	const char *local_eid;
 	uint64_t lifetime_ms;
+	// Profile of the BPv7 responses, NULL if it could not be created.
+	struct bundle7_profile *profile;
 
+	// Protects the sequence numbers, as the callback may be invoked
+	// concurrently by multiple BP workers.
+	Semaphore_t sequence_sem;
 	uint64_t last_bundle_timestamp_s;
 	uint64_t last_bundle_sequence_number;
 };
@@ -39,33 +45,46 @@ static void callback(struct bundle_adu data, void *p, const void *bp_context)
 {
 	struct echo_agent_params *const params = p;
 
+	hal_semaphore_take_blocking(params->sequence_sem);
+
 	const uint64_t time_ms = hal_time_get_timestamp_ms();
 	const uint64_t seqnum = allocate_sequence_number(
 		params,
 		time_ms
 	);
 
+	hal_semaphore_release(params->sequence_sem);
+
 	LOGF_DEBUG(
 		"Echo Agent: Responding to echo request from %s.",
 		data.source
 	);
 
+	// Only copied if the payload is still referenced by other bundles.
+	uint8_t *const payload = bundle_adu_take_payload(&data);
+
+	if (!payload && data.length != 0) {
+		LOG_ERROR("Echo Agent: Cannot obtain payload of echo request!");
+		bundle_adu_free_members(data);
+		return;
+	}
+
 	agent_create_forward_bundle_direct(
 		bp_context,
 		params->local_eid,
 		data.protocol_version,
+		params->profile,
 		params->is_ipn ? AGENT_ID_ECHO_IPN : AGENT_ID_ECHO_DTN,
 		data.source,
 		time_ms,
 		seqnum,
 		params->lifetime_ms,
-		data.payload,
+		payload,
 		data.length,
 		0
 	);
 
 	// Pointer responsibility was taken by agent_create_forward_bundle
-	data.payload = NULL;
 	bundle_adu_free_members(data);
 }
 
@@ -79,6 +98,14 @@ int echo_agent_setup(struct bundle_agent_interface *const bai,
 	params->is_ipn = get_eid_scheme(bai->local_eid) == EID_SCHEME_IPN;
 	params->local_eid = bai->local_eid;
 	params->lifetime_ms = lifetime_ms;
+	params->profile = agent_create_profile(
+		bai->local_eid,
+		params->is_ipn ? AGENT_ID_ECHO_IPN : AGENT_ID_ECHO_DTN,
+		lifetime_ms
+	);
+	params->sequence_sem = hal_semaphore_init_binary();
+	ASSERT(params->sequence_sem != NULL);
+	hal_semaphore_release(params->sequence_sem);
 	params->last_bundle_timestamp_s = 0;
 	params->last_bundle_sequence_number = 0;
 
@@ -7,6 +7,7 @@
 #include "agents/application_agent.h"
 
 #include "bundle7/parser.h"
+#include "bundle7/profile.h"
 
 #include "cla/posix/cla_tcp_util.h"
 
@@ -20,11 +21,13 @@
 #include "platform/posix/pipe_queue_util.h"
 #include "platform/posix/socket_util.h"
 
+#include "ud3tn/admission_control.h"
 #include "ud3tn/agent_util.h"
 #include "ud3tn/common.h"
 #include "ud3tn/bundle.h"
 #include "ud3tn/bundle_processor.h"
 #include "ud3tn/eid.h"
+#include "ud3tn/memory_budget.h"
 
 #include <stddef.h>
 #include <stdlib.h>
@@ -60,6 +63,9 @@ struct application_agent_comm_config {
 	int socket_fd;
 	int bundle_pipe_fd[2];
 	char *registered_agent_id;
+	// Profile of the BPv7 bundles sent by the registered agent, NULL if
+	// it could not be created or for BPv6.
+	struct bundle7_profile *profile;
 	uint64_t last_bundle_timestamp_ms;
 	uint64_t last_bundle_sequence_number;
 };
@@ -132,6 +138,7 @@ static void application_agent_listener_task(void *const param)
 		child_config->last_bundle_timestamp_ms = 0;
 		child_config->last_bundle_sequence_number = 0;
 		child_config->registered_agent_id = NULL;
+		child_config->profile = NULL;
 
 		if (pipe(child_config->bundle_pipe_fd) == -1) {
 			LOG_ERRNO("AppAgent", "pipe()", errno);
@@ -202,9 +209,12 @@ static void agent_msg_recv(struct bundle_adu data, void *param,
 		data.source
 	);
 
+	// Accounted before writing, as the reader may release it immediately.
+	memory_budget_charge(MEMORY_BUDGET_AGENT, data.length);
 	if (pipeq_write_all(config->bundle_pipe_fd[1],
 			    &data, sizeof(struct bundle_adu)) <= 0) {
 		LOG_ERRNO("AppAgent", "write()", errno);
+		memory_budget_release(MEMORY_BUDGET_AGENT, data.length);
 		bundle_adu_free_members(data);
 	}
 }
@@ -245,6 +255,18 @@ static void deregister_sink(struct application_agent_comm_config *config)
 
 	free(config->registered_agent_id);
 	config->registered_agent_id = NULL;
+	bundle7_profile_unref(config->profile);
+	config->profile = NULL;
+}
+
+static struct bundle7_profile *create_profile(
+	struct application_agent_comm_config *config)
+{
+	return agent_create_profile(
+		config->parent->bundle_agent_interface->local_eid,
+		config->registered_agent_id,
+		config->parent->lifetime_ms
+	);
 }
 
 static uint64_t allocate_sequence_number(
@@ -286,6 +308,8 @@ static int16_t process_aap_message(
 		} else {
 			config->registered_agent_id = msg.eid;
 			msg.eid = NULL; // take over freeing of EID
+			if (config->parent->bp_version == 7)
+				config->profile = create_profile(config);
 			response.type = AAP_MESSAGE_ACK;
 		}
 		break;
@@ -312,17 +336,24 @@ static int16_t process_aap_message(
 			LOG_DEBUG("AppAgent: ADU is a BPDU, prepending AR header!");
 
 			const size_t ar_size = msg.payload_length + 2;
-			uint8_t *const ar_bytes = malloc(ar_size);
+			// Growing the buffer in place avoids a second copy of
+			// the payload in most cases.
+			uint8_t *const ar_bytes = realloc(msg.payload, ar_size);
 
-			memcpy(
+			if (!ar_bytes) {
+				LOG_ERROR("AppAgent: Allocating AR header failed!");
+				response.type = AAP_MESSAGE_NACK;
+				break;
+			}
+
+			memmove(
 				ar_bytes + 2,
-				msg.payload,
+				ar_bytes,
 				msg.payload_length
 			);
 			ar_bytes[0] = 0x82;          // CBOR array of length 2
 			ar_bytes[1] = BIBE_TYPECODE; // Integer (record type)
 
-			free(msg.payload);
 			msg.payload = ar_bytes;
 			msg.payload_length = ar_size;
 		}
@@ -332,9 +363,10 @@ static int16_t process_aap_message(
 			config,
 			time_ms
 		);
-		struct bundle *bundle = agent_create_forward_bundle(
-			config->parent->bundle_agent_interface,
+		struct bundle *bundle = agent_create_bundle(
 			config->parent->bp_version,
+			config->profile,
+			config->parent->bundle_agent_interface->local_eid,
 			config->registered_agent_id,
 			msg.eid,
 			time_ms,
@@ -348,13 +380,30 @@ static int16_t process_aap_message(
 				: 0
 			)
 		);
-		// Pointer responsibility was taken by create_forward_bundle
+		// Pointer responsibility was taken by create_bundle
 		msg.payload = NULL;
 
 		if (!bundle) {
 			LOG_ERROR("AppAgent: Bundle creation failed!");
 			response.type = AAP_MESSAGE_NACK;
+		} else if (admission_control_check(bundle) == ADMISSION_REJECT) {
+			// Reject the bundle at the source instead of dropping it
+			// in the BP. AAP has no dedicated status for that.
+			LOGF_INFO(
+				"AppAgent: Rejecting bundle to \"%s\": Backlog full",
+				bundle->destination
+			);
+			bundle_free(bundle);
+			response.type = AAP_MESSAGE_NACK;
 		} else {
+			bundle_processor_inform(
+				config->parent->bundle_agent_interface
+					->bundle_signaling_queue,
+				(struct bundle_processor_signal){
+					.type = BP_SIGNAL_BUNDLE_LOCAL_DISPATCH,
+					.bundle = bundle,
+				}
+			);
 			LOGF_DEBUG("AppAgent: Injected new bundle %p.", bundle);
 			response.type = AAP_MESSAGE_SENDCONFIRM;
 			response.bundle_id = (
@@ -459,7 +508,8 @@ static int send_bundle(const int socket_fd, struct bundle_adu data)
 			? AAP_MESSAGE_RECVBIBE
 			: AAP_MESSAGE_RECVBUNDLE
 		),
-		.eid = data.source,
+		// The message is only read, the interned EID is not modified.
+		.eid = (char *)data.source,
 		.eid_length = strlen(data.source),
 		.payload = data.payload,
 		.payload_length = data.length,
@@ -480,6 +530,7 @@ static void shutdown_bundle_pipe(int bundle_pipe_fd[2])
 			LOG_ERRNO("AppAgent", "read()", errno);
 			break;
 		}
+		memory_budget_release(MEMORY_BUDGET_AGENT, data.length);
 
 		LOGF_WARN(
 			"AppAgent: Dropping unsent bundle from '%s'.",
@@ -556,6 +607,7 @@ static void application_agent_comm_task(void *const param)
 				LOG_ERRNO("AppAgent", "read()", errno);
 				break;
 			}
+			memory_budget_release(MEMORY_BUDGET_AGENT, data.length);
 			if (send_bundle(config->socket_fd, data) < 0)
 				break;
 		}
@@ -81,7 +81,7 @@ void bundle6_serialize_dictionary(char *buf,
 // Just get the length of the dict in bytes (more efficient)
 size_t bundle6_get_dict_length(struct bundle *bundle)
 {
-	char *const basic_eids[] = {
+	const char *const basic_eids[] = {
 		bundle->destination,
 		bundle->source,
 		bundle->report_to,
@@ -3,6 +3,7 @@
 
 #include "ud3tn/bundle.h"
 #include "ud3tn/common.h"
+#include "ud3tn/eid_intern.h"
 
 #include <stdbool.h>
 #include <stddef.h>
@@ -39,16 +40,16 @@ struct bundle *bundle6_create_local(
 	if (bundle->payload_block == NULL || bundle->blocks == NULL)
 		goto fail;
 
-	bundle->source = strdup(source);
+	bundle->source = eid_intern(source);
 	if (bundle->source == NULL || strchr(source, ':') == NULL)
 		goto fail;
 
-	bundle->destination = strdup(destination);
+	bundle->destination = eid_intern(destination);
 	if (bundle->destination == NULL || strchr(destination, ':') == NULL)
 		goto fail;
 
-	bundle->report_to = strdup("dtn:none");
-	bundle->current_custodian = strdup("dtn:none");
+	bundle->report_to = eid_intern("dtn:none");
+	bundle->current_custodian = eid_intern_ref(bundle->report_to);
 
 	bundle->payload_block->data = payload;
 	bundle->payload_block->length = payload_length;
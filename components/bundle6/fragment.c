@@ -38,20 +38,16 @@ struct bundle *bundle6_fragment_bundle(
 	if (!bundle_is_fragmented(working_bundle))
 		working_bundle->total_adu_length =
 			working_bundle->payload_block->length;
-	/* Set the payload block's properties */
-	remainder->payload_block->length =
-		working_bundle->payload_block->length - first_payload_length;
-	remainder->payload_block->data =
-		malloc(remainder->payload_block->length);
-	if (remainder->payload_block->data == NULL) {
+	/* Reference the remaining payload, both fragments share the buffer */
+	if (bundle_block_share_slice(
+			remainder->payload_block,
+			working_bundle->payload_block,
+			first_payload_length,
+			working_bundle->payload_block->length -
+				first_payload_length) != UD3TN_OK) {
 		bundle_free(remainder);
 		return NULL;
 	}
-	memcpy(
-		remainder->payload_block->data,
-		working_bundle->payload_block->data + first_payload_length,
-		remainder->payload_block->length
-	);
 	/* Find PL block position in working bundle */
 	/* Add following blocks to remainder */
 	cur_block = working_bundle->blocks;
@@ -66,13 +62,7 @@ struct bundle *bundle6_fragment_bundle(
 		}
 		cur_block = cur_block->next;
 	}
-	/* Shorten first fragment's PL block */
-	working_bundle->payload_block->data = realloc(
-		working_bundle->payload_block->data,
-		first_payload_length
-	);
-	ASSERT(working_bundle->payload_block->data != NULL);
-	/* Set correct lengths and offsets */
+	/* Shorten first fragment's PL block, set correct lengths and offsets */
 	working_bundle->payload_block->length = first_payload_length;
 	remainder->fragment_offset =
 		working_bundle->fragment_offset + first_payload_length;
@@ -2,6 +2,8 @@
 #include "bundle6/parser.h"
 
 #include "ud3tn/common.h"
+#include "ud3tn/eid_intern.h"
+#include "ud3tn/memory_budget.h"
 
 #include <inttypes.h>
 #include <stddef.h>
@@ -11,6 +13,12 @@
 #include <stdbool.h>
 
 
+static void release_budget(struct bundle6_parser *state)
+{
+	memory_budget_release(MEMORY_BUDGET_PARSING, state->budget_bytes);
+	state->budget_bytes = 0;
+}
+
 struct parser *bundle6_parser_init(
 	struct bundle6_parser *state,
 	void (*send_callback)(struct bundle *, void *), void *param)
@@ -21,6 +29,8 @@ struct parser *bundle6_parser_init(
 	state->send_callback = send_callback;
 	state->send_param = param;
 	state->bundle = NULL;
+	state->arena = (struct bundle_arena){ NULL, 0 };
+	state->budget_bytes = 0;
 	state->dict = NULL;
 	state->basedata->status = PARSER_STATUS_ERROR;
 	if (bundle6_parser_reset(state) != UD3TN_OK)
@@ -50,6 +60,8 @@ enum ud3tn_result bundle6_parser_reset(struct bundle6_parser *state)
 	state->current_size = sizeof(struct bundle);
 	state->last_block = 0;
 
+	bundle_arena_release(&state->arena);
+	release_budget(state);
 	if (state->bundle != NULL)
 		bundle_reset(state->bundle);
 	else
@@ -72,6 +84,8 @@ enum ud3tn_result bundle6_parser_deinit(struct bundle6_parser *state)
 	free(state->basedata);
 	if (state->bundle != NULL)
 		bundle_free(state->bundle);
+	bundle_arena_release(&state->arena);
+	release_budget(state);
 	if (state->dict != NULL)
 		free(state->dict);
 
@@ -150,39 +164,33 @@ fail:
 	return NULL;
 }
 
-static inline size_t decimal_digits(uint64_t number)
-{
-	size_t digits = 0;
+// "ipn:" + nodenum + "." + servicenum + "\0"
+#define CBHE_EID_BUFFER_SIZE (4 + 20 + 1 + 20 + 1)
 
-	if (number == 0)
-		return 1;
-	while (number != 0) {
-		digits++;
-		number /= 10;
-	}
-	return digits;
+static void bundle6_format_eid_cbhe(const struct bundle6_eid_reference ref,
+				    char eid[CBHE_EID_BUFFER_SIZE])
+{
+	if (ref.scheme_offset == 0 || ref.ssp_offset == 0)
+		strcpy(eid, "dtn:none");
+	else
+		snprintf(eid, CBHE_EID_BUFFER_SIZE, "ipn:%" PRIu64 ".%" PRIu64,
+			 ref.scheme_offset, ref.ssp_offset);
 }
 
 static char *bundle6_create_eid_cbhe(const struct bundle6_eid_reference ref)
 {
-	if (ref.scheme_offset == 0 || ref.ssp_offset == 0)
-		return strdup("dtn:none");
+	char eid[CBHE_EID_BUFFER_SIZE];
 
-	// "ipn:" + nodenum + "." + servicenum + "\0"
-	const size_t length = 4
-			+ decimal_digits(ref.scheme_offset)
-			+ 1
-			+ decimal_digits(ref.ssp_offset)
-			+ 1;
-	char *const eid = malloc(length);
-
-	if (eid == NULL)
-		return NULL;
-
-	snprintf(eid, length, "ipn:%" PRIu64 ".%" PRIu64,
-		 ref.scheme_offset, ref.ssp_offset);
+	bundle6_format_eid_cbhe(ref, eid);
+	return strdup(eid);
+}
 
-	return eid;
+static const char *bundle6_intern_eid_cbhe(
+	const struct bundle6_eid_reference ref)
+{
+	if (ref.scheme_offset == 0 || ref.ssp_offset == 0)
+		return eid_intern("dtn:none");
+	return eid_intern_ipn(ref.scheme_offset, ref.ssp_offset);
 }
 
 static bool bundle_is_valid(struct bundle *const bundle)
@@ -195,10 +203,15 @@ static inline void bundle6_parser_send_bundle(struct bundle6_parser *state)
 	struct bundle *ptr = state->bundle;
 
 	state->bundle = NULL;
+	bundle_arena_release(&state->arena);
+	release_budget(state);
 	if (state->send_callback == NULL || !bundle_is_valid(ptr))
 		bundle_free(ptr);
-	else
+	else {
+		// The fields are hot in the cache now, so obtain the ID early.
+		bundle_get_id(ptr);
 		state->send_callback(ptr, state->send_param);
+	}
 }
 
 static inline void bundle6_parser_next(struct bundle6_parser *state)
@@ -254,20 +267,20 @@ static inline void bundle6_parser_next(struct bundle6_parser *state)
 		state->current_index = 0;
 		// CBHE (RFC 6260)
 		if (state->dict_length == 0) {
-			state->bundle->source = bundle6_create_eid_cbhe(
+			state->bundle->source = bundle6_intern_eid_cbhe(
 				state->source_eidref
 			);
 			// destination
-			state->bundle->destination = bundle6_create_eid_cbhe(
+			state->bundle->destination = bundle6_intern_eid_cbhe(
 				state->destination_eidref
 			);
 			// report-to
-			state->bundle->report_to = bundle6_create_eid_cbhe(
+			state->bundle->report_to = bundle6_intern_eid_cbhe(
 				state->report_to_eidref
 			);
 			// custodian
 			state->bundle->current_custodian =
-				bundle6_create_eid_cbhe(
+				bundle6_intern_eid_cbhe(
 					state->custodian_eidref
 				);
 
@@ -335,18 +348,22 @@ static inline void bundle6_parser_next(struct bundle6_parser *state)
 		state->basedata->next_bytes =
 			(*state->current_block_entry)->data->length;
 		state->current_size += state->basedata->next_bytes;
-		if (state->current_size > BUNDLE_MAX_SIZE) {
+		if (state->current_size > BUNDLE_MAX_SIZE ||
+		    !memory_budget_acquire(MEMORY_BUDGET_PARSING,
+					   state->basedata->next_bytes)) {
+			state->basedata->status = PARSER_STATUS_ERROR;
+			break;
+		}
+		state->budget_bytes += state->basedata->next_bytes;
+		if (bundle_arena_alloc_block_data(
+				&state->arena,
+				(*state->current_block_entry)->data,
+				state->basedata->next_bytes) != UD3TN_OK) {
 			state->basedata->status = PARSER_STATUS_ERROR;
 		} else {
 			state->basedata->next_buffer =
-				malloc(state->basedata->next_bytes);
-			if (state->basedata->next_buffer == NULL) {
-				state->basedata->status = PARSER_STATUS_ERROR;
-			} else {
-				(*state->current_block_entry)->data->data =
-					state->basedata->next_buffer;
-				state->basedata->flags |= PARSER_FLAG_BULK_READ;
-			}
+				(*state->current_block_entry)->data->data;
+			state->basedata->flags |= PARSER_FLAG_BULK_READ;
 		}
 		break;
 	default:
@@ -387,6 +404,215 @@ static inline int bundle6_parser_wait_for_sdnv(
 	return 0;
 }
 
+/**
+ * Describes where the SDNV of a stage is stored and the stage following it
+ */
+struct bundle6_sdnv_field {
+	// Size of the (unsigned integer) value in bytes
+	uint8_t size;
+	void *value;
+	enum bundle6_parser_stage next_stage;
+};
+
+#define SDNV_FIELD(field, next) \
+	((struct bundle6_sdnv_field){ sizeof(field), &(field), (next) })
+
+static bool bundle6_parser_get_sdnv_field(struct bundle6_parser *state,
+					  struct bundle6_sdnv_field *field)
+{
+	struct bundle *const bundle = state->bundle;
+
+	switch (state->current_stage) {
+	case PARSER_STAGE_PROC_FLAGS:
+		ASSERT(sizeof(bundle->proc_flags) == sizeof(uint32_t));
+		*field = SDNV_FIELD(bundle->proc_flags,
+				    PARSER_STAGE_BLOCK_LENGTH);
+		return true;
+	case PARSER_STAGE_BLOCK_LENGTH:
+		*field = SDNV_FIELD(bundle->primary_block_length,
+				    PARSER_STAGE_DESTINATION_EID_SCHEME);
+		return true;
+	case PARSER_STAGE_DESTINATION_EID_SCHEME:
+		*field = SDNV_FIELD(state->destination_eidref.scheme_offset,
+				    PARSER_STAGE_DESTINATION_EID_SSP);
+		return true;
+	case PARSER_STAGE_DESTINATION_EID_SSP:
+		*field = SDNV_FIELD(state->destination_eidref.ssp_offset,
+				    PARSER_STAGE_SOURCE_EID_SCHEME);
+		return true;
+	case PARSER_STAGE_SOURCE_EID_SCHEME:
+		*field = SDNV_FIELD(state->source_eidref.scheme_offset,
+				    PARSER_STAGE_SOURCE_EID_SSP);
+		return true;
+	case PARSER_STAGE_SOURCE_EID_SSP:
+		*field = SDNV_FIELD(state->source_eidref.ssp_offset,
+				    PARSER_STAGE_REPORT_EID_SCHEME);
+		return true;
+	case PARSER_STAGE_REPORT_EID_SCHEME:
+		*field = SDNV_FIELD(state->report_to_eidref.scheme_offset,
+				    PARSER_STAGE_REPORT_EID_SSP);
+		return true;
+	case PARSER_STAGE_REPORT_EID_SSP:
+		*field = SDNV_FIELD(state->report_to_eidref.ssp_offset,
+				    PARSER_STAGE_CUSTODIAN_EID_SCHEME);
+		return true;
+	case PARSER_STAGE_CUSTODIAN_EID_SCHEME:
+		*field = SDNV_FIELD(state->custodian_eidref.scheme_offset,
+				    PARSER_STAGE_CUSTODIAN_EID_SSP);
+		return true;
+	case PARSER_STAGE_CUSTODIAN_EID_SSP:
+		*field = SDNV_FIELD(state->custodian_eidref.ssp_offset,
+				    PARSER_STAGE_TIMESTAMP);
+		return true;
+	case PARSER_STAGE_TIMESTAMP:
+		*field = SDNV_FIELD(bundle->creation_timestamp_ms,
+				    PARSER_STAGE_SEQUENCE_NUM);
+		return true;
+	case PARSER_STAGE_SEQUENCE_NUM:
+		*field = SDNV_FIELD(bundle->sequence_number,
+				    PARSER_STAGE_LIFETIME);
+		return true;
+	case PARSER_STAGE_LIFETIME:
+		*field = SDNV_FIELD(bundle->lifetime_ms,
+				    PARSER_STAGE_DICT_LENGTH);
+		return true;
+	case PARSER_STAGE_DICT_LENGTH:
+		*field = SDNV_FIELD(state->dict_length,
+				    PARSER_STAGE_DICTIONARY);
+		return true;
+	case PARSER_STAGE_FRAGMENT_OFFSET:
+		*field = SDNV_FIELD(bundle->fragment_offset,
+				    PARSER_STAGE_ADU_LENGTH);
+		return true;
+	case PARSER_STAGE_ADU_LENGTH:
+		*field = SDNV_FIELD(bundle->total_adu_length,
+				    PARSER_STAGE_BLOCK_TYPE);
+		return true;
+	case PARSER_STAGE_BLOCK_FLAGS:
+		*field = (struct bundle6_sdnv_field){
+			sizeof(uint8_t),
+			&(*state->current_block_entry)->data->flags,
+			PARSER_STAGE_BLOCK_DATA_LENGTH,
+		};
+		return true;
+	case PARSER_STAGE_BLOCK_EID_REF_CNT:
+		*field = SDNV_FIELD(state->current_size,
+				    PARSER_STAGE_BLOCK_EID_REF_SCH);
+		return true;
+	case PARSER_STAGE_BLOCK_EID_REF_SCH:
+		*field = SDNV_FIELD(state->cur_eidref.scheme_offset,
+				    PARSER_STAGE_BLOCK_EID_REF_SSP);
+		return true;
+	case PARSER_STAGE_BLOCK_EID_REF_SSP:
+		*field = SDNV_FIELD(state->cur_eidref.ssp_offset,
+				    PARSER_STAGE_BLOCK_EID_REF_SCH);
+		return true;
+	case PARSER_STAGE_BLOCK_DATA_LENGTH:
+		*field = SDNV_FIELD((*state->current_block_entry)->data->length,
+				    PARSER_STAGE_BLOCK_DATA);
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+ * Processes the value of an SDNV after it has been read completely
+ */
+static void bundle6_parser_sdnv_done(struct bundle6_parser *state)
+{
+	switch (state->current_stage) {
+	case PARSER_STAGE_BLOCK_FLAGS: {
+		enum bundle_block_flags flags =
+			(*state->current_block_entry)->data->flags;
+		state->last_block = HAS_FLAG(
+			flags,
+			BUNDLE_V6_BLOCK_FLAG_LAST_BLOCK
+		);
+		if (HAS_FLAG(flags, BUNDLE_V6_BLOCK_FLAG_HAS_EID_REF_FIELD)) {
+			state->next_stage =
+				PARSER_STAGE_BLOCK_EID_REF_CNT;
+		}
+		break;
+	}
+	case PARSER_STAGE_BLOCK_EID_REF_CNT:
+		state->current_index = 0;
+		if (state->current_size == 0)
+			state->next_stage = PARSER_STAGE_BLOCK_DATA_LENGTH;
+		break;
+	case PARSER_STAGE_BLOCK_EID_REF_SSP: {
+		struct endpoint_list *entry = malloc(
+			sizeof(struct endpoint_list));
+		if (entry == NULL) {
+			state->basedata->status = PARSER_STATUS_ERROR;
+			break;
+		}
+
+		if (state->dict_length == 0) {
+			// CBHE
+			entry->eid = bundle6_create_eid_cbhe(
+				state->cur_eidref
+			);
+		} else {
+			// read from dict
+			entry->eid = bundle6_read_eid(
+				state->dict, state->dict_length,
+				state->cur_eidref);
+		}
+
+		entry->next = (*state->current_block_entry)
+			->data->eid_refs;
+		(*state->current_block_entry)
+			->data->eid_refs = entry;
+		state->current_index++;
+
+		if (entry->eid == NULL)
+			state->basedata->status = PARSER_STATUS_ERROR;
+		else if (state->current_index == state->current_size)
+			state->next_stage =
+				PARSER_STAGE_BLOCK_DATA_LENGTH;
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+static void bundle6_parser_read_sdnv_byte(struct bundle6_parser *state,
+	uint8_t byte)
+{
+	struct bundle6_sdnv_field field;
+
+	if (!bundle6_parser_get_sdnv_field(state, &field)) {
+		state->basedata->status = PARSER_STATUS_ERROR;
+		return;
+	}
+
+	switch (field.size) {
+	case sizeof(uint8_t):
+		sdnv_read_u8(&state->sdnv_state, field.value, byte);
+		break;
+	case sizeof(uint16_t):
+		sdnv_read_u16(&state->sdnv_state, field.value, byte);
+		break;
+	case sizeof(uint32_t):
+		sdnv_read_u32(&state->sdnv_state, field.value, byte);
+		break;
+	default:
+		sdnv_read_u64(&state->sdnv_state, field.value, byte);
+		break;
+	}
+	if (bundle6_parser_wait_for_sdnv(state, field.next_stage))
+		bundle6_parser_sdnv_done(state);
+}
+
+static inline void bundle6_parser_advance(struct bundle6_parser *state)
+{
+	if (state->current_stage != state->next_stage &&
+	    state->basedata->status != PARSER_STATUS_ERROR)
+		bundle6_parser_next(state);
+}
+
 static void bundle6_parser_read_byte(struct bundle6_parser *state,
 	uint8_t byte)
 {
@@ -407,95 +633,27 @@ static void bundle6_parser_read_byte(struct bundle6_parser *state,
 		state->next_stage = PARSER_STAGE_PROC_FLAGS;
 		break;
 	case PARSER_STAGE_PROC_FLAGS:
-		ASSERT(sizeof(state->bundle->proc_flags) == sizeof(uint32_t));
-		sdnv_read_u32(&state->sdnv_state,
-			      (uint32_t *)&state->bundle->proc_flags, byte);
-		bundle6_parser_wait_for_sdnv(
-				state, PARSER_STAGE_BLOCK_LENGTH);
-		break;
 	case PARSER_STAGE_BLOCK_LENGTH:
-		sdnv_read_u16(&state->sdnv_state,
-			      &state->bundle->primary_block_length, byte);
-		bundle6_parser_wait_for_sdnv(
-			state, PARSER_STAGE_DESTINATION_EID_SCHEME);
-		break;
 	case PARSER_STAGE_DESTINATION_EID_SCHEME:
-		sdnv_read_u64(&state->sdnv_state,
-			      &state->destination_eidref.scheme_offset, byte);
-		bundle6_parser_wait_for_sdnv(
-			state, PARSER_STAGE_DESTINATION_EID_SSP);
-		break;
 	case PARSER_STAGE_DESTINATION_EID_SSP:
-		sdnv_read_u64(&state->sdnv_state,
-			      &state->destination_eidref.ssp_offset, byte);
-		bundle6_parser_wait_for_sdnv(
-			state, PARSER_STAGE_SOURCE_EID_SCHEME);
-		break;
 	case PARSER_STAGE_SOURCE_EID_SCHEME:
-		sdnv_read_u64(&state->sdnv_state,
-			      &state->source_eidref.scheme_offset, byte);
-		bundle6_parser_wait_for_sdnv(
-			state, PARSER_STAGE_SOURCE_EID_SSP);
-		break;
 	case PARSER_STAGE_SOURCE_EID_SSP:
-		sdnv_read_u64(&state->sdnv_state,
-			      &state->source_eidref.ssp_offset, byte);
-		bundle6_parser_wait_for_sdnv(
-			state, PARSER_STAGE_REPORT_EID_SCHEME);
-		break;
 	case PARSER_STAGE_REPORT_EID_SCHEME:
-		sdnv_read_u64(&state->sdnv_state,
-			      &state->report_to_eidref.scheme_offset, byte);
-		bundle6_parser_wait_for_sdnv(
-			state, PARSER_STAGE_REPORT_EID_SSP);
-		break;
 	case PARSER_STAGE_REPORT_EID_SSP:
-		sdnv_read_u64(&state->sdnv_state,
-			      &state->report_to_eidref.ssp_offset, byte);
-		bundle6_parser_wait_for_sdnv(
-			state, PARSER_STAGE_CUSTODIAN_EID_SCHEME);
-		break;
 	case PARSER_STAGE_CUSTODIAN_EID_SCHEME:
-		sdnv_read_u64(&state->sdnv_state,
-			      &state->custodian_eidref.scheme_offset, byte);
-		bundle6_parser_wait_for_sdnv(
-			state, PARSER_STAGE_CUSTODIAN_EID_SSP);
-		break;
 	case PARSER_STAGE_CUSTODIAN_EID_SSP:
-		sdnv_read_u64(&state->sdnv_state,
-			      &state->custodian_eidref.ssp_offset, byte);
-		bundle6_parser_wait_for_sdnv(
-			state, PARSER_STAGE_TIMESTAMP);
-		break;
 	case PARSER_STAGE_TIMESTAMP:
-		sdnv_read_u64(
-			&state->sdnv_state,
-			&state->bundle->creation_timestamp_ms,
-			byte);
-		bundle6_parser_wait_for_sdnv(
-			state, PARSER_STAGE_SEQUENCE_NUM);
-		break;
 	case PARSER_STAGE_SEQUENCE_NUM:
-		sdnv_read_u64(
-			&state->sdnv_state,
-			&state->bundle->sequence_number,
-			byte);
-		bundle6_parser_wait_for_sdnv(
-			state, PARSER_STAGE_LIFETIME);
-		break;
 	case PARSER_STAGE_LIFETIME:
-		sdnv_read_u64(
-			&state->sdnv_state,
-			&state->bundle->lifetime_ms,
-			byte);
-		bundle6_parser_wait_for_sdnv(
-			state, PARSER_STAGE_DICT_LENGTH);
-		break;
 	case PARSER_STAGE_DICT_LENGTH:
-		sdnv_read_u16(&state->sdnv_state, &state->dict_length,
-			      byte);
-		bundle6_parser_wait_for_sdnv(
-			state, PARSER_STAGE_DICTIONARY);
+	case PARSER_STAGE_FRAGMENT_OFFSET:
+	case PARSER_STAGE_ADU_LENGTH:
+	case PARSER_STAGE_BLOCK_FLAGS:
+	case PARSER_STAGE_BLOCK_EID_REF_CNT:
+	case PARSER_STAGE_BLOCK_EID_REF_SCH:
+	case PARSER_STAGE_BLOCK_EID_REF_SSP:
+	case PARSER_STAGE_BLOCK_DATA_LENGTH:
+		bundle6_parser_read_sdnv_byte(state, byte);
 		break;
 	case PARSER_STAGE_DICTIONARY:
 		--state->cur_bytes_remaining;
@@ -506,24 +664,32 @@ static void bundle6_parser_read_byte(struct bundle6_parser *state,
 			// Allocate EID references
 			//
 			// source
-			state->bundle->source = bundle6_read_eid(
-				state->dict, state->dict_length,
-				state->source_eidref
+			state->bundle->source = eid_intern_take(
+				bundle6_read_eid(
+					state->dict, state->dict_length,
+					state->source_eidref
+				)
 			);
 			// destination
-			state->bundle->destination = bundle6_read_eid(
-				state->dict, state->dict_length,
-				state->destination_eidref
+			state->bundle->destination = eid_intern_take(
+				bundle6_read_eid(
+					state->dict, state->dict_length,
+					state->destination_eidref
+				)
 			);
 			// report-to
-			state->bundle->report_to = bundle6_read_eid(
-				state->dict, state->dict_length,
-				state->report_to_eidref
+			state->bundle->report_to = eid_intern_take(
+				bundle6_read_eid(
+					state->dict, state->dict_length,
+					state->report_to_eidref
+				)
 			);
 			// custodian
-			state->bundle->current_custodian = bundle6_read_eid(
-				state->dict, state->dict_length,
-				state->custodian_eidref
+			state->bundle->current_custodian = eid_intern_take(
+				bundle6_read_eid(
+					state->dict, state->dict_length,
+					state->custodian_eidref
+				)
 			);
 			if (state->bundle->source == NULL ||
 			    state->bundle->destination == NULL ||
@@ -541,107 +707,10 @@ static void bundle6_parser_read_byte(struct bundle6_parser *state,
 					PARSER_STAGE_BLOCK_TYPE;
 		}
 		break;
-	case PARSER_STAGE_FRAGMENT_OFFSET:
-		sdnv_read_u32(
-			&state->sdnv_state,
-			&state->bundle->fragment_offset,
-			byte);
-		bundle6_parser_wait_for_sdnv(
-			state, PARSER_STAGE_ADU_LENGTH);
-		break;
-	case PARSER_STAGE_ADU_LENGTH:
-		sdnv_read_u32(
-			&state->sdnv_state,
-			&state->bundle->total_adu_length,
-			byte);
-		bundle6_parser_wait_for_sdnv(
-			state, PARSER_STAGE_BLOCK_TYPE);
-		break;
 	case PARSER_STAGE_BLOCK_TYPE:
 		state->next_stage = PARSER_STAGE_BLOCK_FLAGS;
 		bundle6_parser_begin_block(state, byte);
 		break;
-	case PARSER_STAGE_BLOCK_FLAGS:
-		sdnv_read_u8(
-			&state->sdnv_state,
-			(uint8_t *)&(*state->current_block_entry)->data->flags,
-			byte
-		);
-		if (bundle6_parser_wait_for_sdnv(state,
-						 PARSER_STAGE_BLOCK_DATA_LENGTH)) {
-			enum bundle_block_flags flags =
-				(*state->current_block_entry)->data->flags;
-			state->last_block = HAS_FLAG(
-				flags,
-				BUNDLE_V6_BLOCK_FLAG_LAST_BLOCK
-			);
-			if (HAS_FLAG(flags, BUNDLE_V6_BLOCK_FLAG_HAS_EID_REF_FIELD)) {
-				state->next_stage =
-					PARSER_STAGE_BLOCK_EID_REF_CNT;
-			}
-		}
-		break;
-	case PARSER_STAGE_BLOCK_EID_REF_CNT:
-		sdnv_read_u32(&state->sdnv_state, &state->current_size, byte);
-		if (bundle6_parser_wait_for_sdnv(
-			state, PARSER_STAGE_BLOCK_EID_REF_SCH)) {
-			state->current_index = 0;
-			if (state->current_size == 0)
-				state->next_stage = PARSER_STAGE_BLOCK_DATA_LENGTH;
-		}
-		break;
-	case PARSER_STAGE_BLOCK_EID_REF_SCH:
-		sdnv_read_u64(&state->sdnv_state,
-			      &state->cur_eidref.scheme_offset, byte);
-		bundle6_parser_wait_for_sdnv(
-			state, PARSER_STAGE_BLOCK_EID_REF_SSP);
-		break;
-	case PARSER_STAGE_BLOCK_EID_REF_SSP:
-		sdnv_read_u64(&state->sdnv_state,
-			      &state->cur_eidref.ssp_offset, byte);
-		if (bundle6_parser_wait_for_sdnv(
-				state, PARSER_STAGE_BLOCK_EID_REF_SCH)) {
-			struct endpoint_list *entry = malloc(
-				sizeof(struct endpoint_list));
-			if (entry == NULL) {
-				state->basedata->status = PARSER_STATUS_ERROR;
-				break;
-			}
-
-			if (state->dict_length == 0) {
-				// CBHE
-				entry->eid = bundle6_create_eid_cbhe(
-					state->cur_eidref
-				);
-			} else {
-				// read from dict
-				entry->eid = bundle6_read_eid(
-					state->dict, state->dict_length,
-					state->cur_eidref);
-			}
-
-			entry->next = (*state->current_block_entry)
-				->data->eid_refs;
-			(*state->current_block_entry)
-				->data->eid_refs = entry;
-			state->current_index++;
-
-			if (entry->eid == NULL)
-				state->basedata->status = PARSER_STATUS_ERROR;
-			else if (state->current_index == state->current_size)
-				state->next_stage =
-					PARSER_STAGE_BLOCK_DATA_LENGTH;
-		}
-		break;
-	case PARSER_STAGE_BLOCK_DATA_LENGTH:
-		sdnv_read_u32(
-			&state->sdnv_state,
-			&(*state->current_block_entry)
-				->data->length,
-			byte);
-		bundle6_parser_wait_for_sdnv(
-			state, PARSER_STAGE_BLOCK_DATA);
-		break;
 	case PARSER_STAGE_BLOCK_DATA:
 		if (state->cur_bytes_remaining) {
 			state->basedata->status = PARSER_STATUS_ERROR;
@@ -663,9 +732,58 @@ static void bundle6_parser_read_byte(struct bundle6_parser *state,
 		break;
 	}
 
-	if (state->current_stage != state->next_stage &&
-	    state->basedata->status != PARSER_STATUS_ERROR)
-		bundle6_parser_next(state);
+	bundle6_parser_advance(state);
+}
+
+/**
+ * Decodes an SDNV available completely at the start of the given buffer at
+ * once, instead of passing its bytes to bundle6_parser_read_byte().
+ *
+ * @return The number of bytes consumed, or zero if the byte-wise state
+ *	machine has to be used, e.g. because the SDNV continues in the next
+ *	chunk of input data or is invalid.
+ */
+static size_t bundle6_parser_read_sdnv(struct bundle6_parser *state,
+	const uint8_t *buffer, size_t length)
+{
+	struct bundle6_sdnv_field field;
+	int_fast8_t size;
+
+	if (state->sdnv_state.bytes_parsed != 0 ||
+	    !bundle6_parser_get_sdnv_field(state, &field))
+		return 0;
+
+	switch (field.size) {
+	case sizeof(uint8_t):
+		size = sdnv_decode_u8(buffer, length, field.value);
+		break;
+	case sizeof(uint16_t):
+		size = sdnv_decode_u16(buffer, length, field.value);
+		break;
+	case sizeof(uint32_t):
+		size = sdnv_decode_u32(buffer, length, field.value);
+		break;
+	default:
+		size = sdnv_decode_u64(buffer, length, field.value);
+		break;
+	}
+	if (size == 0)
+		return 0;
+
+	if (state->current_block == PARSER_BLOCK_PRIMARY &&
+	    bundle6_parser_length_known(state)) {
+		// Let the byte-wise path report the exhausted length.
+		if (state->primary_bytes_remaining < size)
+			return 0;
+		state->primary_bytes_remaining -= size;
+	}
+
+	state->sdnv_state.status = SDNV_DONE;
+	state->sdnv_state.bytes_parsed = size;
+	if (bundle6_parser_wait_for_sdnv(state, field.next_stage))
+		bundle6_parser_sdnv_done(state);
+	bundle6_parser_advance(state);
+	return size;
 }
 
 size_t bundle6_parser_read(struct bundle6_parser *parser,
@@ -707,6 +825,14 @@ size_t bundle6_parser_read(struct bundle6_parser *parser,
 
 			i += parser->basedata->next_bytes;
 		} else {
+			const size_t sdnv_bytes = bundle6_parser_read_sdnv(
+				parser, buffer + i, length - i
+			);
+
+			if (sdnv_bytes != 0) {
+				i += sdnv_bytes;
+				continue;
+			}
 			bundle6_parser_read_byte(parser, buffer[i]);
 			i++;
 		}
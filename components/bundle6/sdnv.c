@@ -1,11 +1,20 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
 #include "bundle6/sdnv.h"
 
+#include <string.h>
+
 /* 0b01111111 */
 #define SDNV_VALUE_MASK  0x7F
 /* 0b10000000 */
 #define SDNV_MARKER_MASK 0x80
 
+/* Process SDNVs of up to eight bytes in a single 64 bit word. */
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define SDNV_WORD_AT_A_TIME 1
+#else
+#define SDNV_WORD_AT_A_TIME 0
+#endif
+
 void sdnv_reset(struct sdnv_state *state)
 {
 	state->status = SDNV_IN_PROGRESS;
@@ -102,103 +111,184 @@ void sdnv_read_u64(struct sdnv_state *state, uint64_t *value, uint8_t byte)
 	sdnv_read_generic(state, value, byte, sdnv_validate_byte_u64);
 }
 
+/*
+ * Combines the 7 bit groups held by the bytes of the word, the least
+ * significant group in the least significant byte, into a 56 bit value.
+ */
+static inline uint64_t sdnv_compact(uint64_t word)
+{
+	word &= 0x7F7F7F7F7F7F7F7F;
+	word = (word & 0x007F007F007F007F) | ((word & 0x7F007F007F007F00) >> 1);
+	word = (word & 0x00003FFF00003FFF) | ((word & 0x3FFF00003FFF0000) >> 2);
+	return (word & 0x000000000FFFFFFF) | ((word & 0x0FFFFFFF00000000) >> 4);
+}
+
+/* The inverse of sdnv_compact() for values of up to 56 bits. */
+static inline uint64_t sdnv_spread(uint64_t value)
+{
+	value = (value & 0x000000000FFFFFFF) | ((value & 0x00FFFFFFF0000000) << 4);
+	value = (value & 0x00003FFF00003FFF) | ((value & 0x0FFFC0000FFFC000) << 2);
+	return (value & 0x007F007F007F007F) | ((value & 0x3F803F803F803F80) << 1);
+}
+
+/*
+ * Decodes an SDNV of at most max_size bytes. Values requiring more than 64
+ * bits are rejected, just as values exceeding the type by the callers, which
+ * matches the checks of the sdnv_validate_byte_*() functions.
+ */
+static inline int_fast8_t sdnv_decode(const uint8_t *buffer, size_t length,
+				      const uint_fast8_t max_size,
+				      uint64_t *value)
+{
+	uint_fast8_t size = 0;
+	uint64_t result = 0;
+
+#if SDNV_WORD_AT_A_TIME
+	if (length >= 8) {
+		uint64_t word;
+
+		memcpy(&word, buffer, sizeof(word));
+
+		/* The first byte without the marker bit ends the SDNV. */
+		const uint64_t ends = ~word & 0x8080808080808080;
+
+		if (ends != 0) {
+			size = __builtin_ctzll(ends) / 8 + 1;
+			if (size > max_size)
+				return 0;
+			/* Drop the following bytes, reverse the SDNV bytes. */
+			*value = sdnv_compact(__builtin_bswap64(
+				word << (64 - 8 * size)
+			));
+			return size;
+		}
+		if (max_size <= 8)
+			return 0;
+	}
+#endif /* SDNV_WORD_AT_A_TIME */
+
+	while (size < max_size && size < length) {
+		const uint8_t byte = buffer[size++];
+
+		if (result > (UINT64_MAX >> 7))
+			return 0;
+		result = (result << 7) | (byte & SDNV_VALUE_MASK);
+		if (!(byte & SDNV_MARKER_MASK)) {
+			*value = result;
+			return size;
+		}
+	}
+	return 0;
+}
+
+#define sdnv_decode_generic(buffer, length, value, max_size, max_value) \
+do { \
+	uint64_t _result; \
+	const int_fast8_t _size = sdnv_decode( \
+		(buffer), (length), (max_size), &_result); \
+	if (_size == 0 || _result > (max_value)) \
+		return 0; \
+	*(value) = _result; \
+	return _size; \
+} while (0)
+
+int_fast8_t sdnv_decode_u8(const uint8_t *buffer, size_t length,
+			   uint8_t *value)
+{
+	sdnv_decode_generic(buffer, length, value, 2, UINT8_MAX);
+}
+
+int_fast8_t sdnv_decode_u16(const uint8_t *buffer, size_t length,
+			    uint16_t *value)
+{
+	sdnv_decode_generic(buffer, length, value, 3, UINT16_MAX);
+}
+
+int_fast8_t sdnv_decode_u32(const uint8_t *buffer, size_t length,
+			    uint32_t *value)
+{
+	sdnv_decode_generic(buffer, length, value, 5, UINT32_MAX);
+}
+
+int_fast8_t sdnv_decode_u64(const uint8_t *buffer, size_t length,
+			    uint64_t *value)
+{
+	sdnv_decode_generic(buffer, length, value, MAX_SDNV_SIZE, UINT64_MAX);
+}
+
+static inline int_fast8_t sdnv_get_size(uint64_t value)
+{
+	/* 7 bits per byte, at least one byte also for zero */
+	return (64 - __builtin_clzll(value | 1) + 6) / 7;
+}
+
 int_fast8_t sdnv_get_size_u8(uint8_t value)
 {
-	if ((value & 0x80) == 0)
-		return 1;
-	else
-		return 2;
+	return sdnv_get_size(value);
 }
 
 int_fast8_t sdnv_get_size_u16(uint16_t value)
 {
-	if      ((value & 0xFF80) == 0)
-		return 1;
-	else if ((value & 0xC000) == 0)
-		return 2;
-	else
-		return 3;
+	return sdnv_get_size(value);
 }
 
 int_fast8_t sdnv_get_size_u32(uint32_t value)
 {
-	if      ((value & 0xFFFFFF80) == 0)
-		return 1;
-	else if ((value & 0xFFFFC000) == 0)
-		return 2;
-	else if ((value & 0xFFE00000) == 0)
-		return 3;
-	else if ((value & 0xF0000000) == 0)
-		return 4;
-	else
-		return 5;
+	return sdnv_get_size(value);
 }
 
 int_fast8_t sdnv_get_size_u64(uint64_t value)
 {
-	if      ((value & 0xFFFFFFFFFFFFFF80) == 0)
-		return 1;
-	else if ((value & 0xFFFFFFFFFFFFC000) == 0)
-		return 2;
-	else if ((value & 0xFFFFFFFFFFE00000) == 0)
-		return 3;
-	else if ((value & 0xFFFFFFFFF0000000) == 0)
-		return 4;
-	else if ((value & 0xFFFFFFF800000000) == 0)
-		return 5;
-	else if ((value & 0xFFFFFC0000000000) == 0)
-		return 6;
-	else if ((value & 0xFFFE000000000000) == 0)
-		return 7;
-	else if ((value & 0xFF00000000000000) == 0)
-		return 8;
-	else if ((value & 0x8000000000000000) == 0)
-		return 9;
-	else
-		return 10;
-}
-
-#define sdnv_write_generic(sdnv_bytes, buffer, value) \
-do { \
-	__typeof__(sdnv_bytes) _sdnv_bytes = (sdnv_bytes); \
-	__typeof__(buffer) _buffer = (buffer); \
-	__typeof__(value) _value = (value); \
-	uint8_t *_last_byte = _buffer + _sdnv_bytes - 1; \
-	for (uint8_t *_b = _last_byte; _b >= _buffer; _b--) { \
-		(*_b) = (_value & SDNV_VALUE_MASK) | SDNV_MARKER_MASK; \
-		_value >>= 7; \
-	} \
-	(*_last_byte) &= SDNV_VALUE_MASK; \
-} while (0)
+	return sdnv_get_size(value);
+}
 
-int_fast8_t sdnv_write_u8(uint8_t *buffer, uint8_t value)
+static inline int_fast8_t sdnv_write(uint8_t *buffer, uint64_t value)
 {
-	int_fast8_t sdnv_bytes = sdnv_get_size_u8(value);
+	const int_fast8_t sdnv_bytes = sdnv_get_size(value);
 
-	sdnv_write_generic(sdnv_bytes, buffer, value);
+#if SDNV_WORD_AT_A_TIME
+	if (sdnv_bytes <= 8) {
+		/* All but the last (least significant) byte get the marker. */
+		const uint64_t markers = (
+			0x8080808080808080 &
+			(UINT64_MAX >> (64 - 8 * sdnv_bytes)) &
+			~(uint64_t)0xFF
+		);
+		const uint64_t word = __builtin_bswap64(
+			(sdnv_spread(value) | markers) << (64 - 8 * sdnv_bytes)
+		);
+
+		memcpy(buffer, &word, sdnv_bytes);
+		return sdnv_bytes;
+	}
+#endif /* SDNV_WORD_AT_A_TIME */
+
+	uint8_t *last_byte = buffer + sdnv_bytes - 1;
+
+	for (uint8_t *b = last_byte; b >= buffer; b--) {
+		*b = (value & SDNV_VALUE_MASK) | SDNV_MARKER_MASK;
+		value >>= 7;
+	}
+	*last_byte &= SDNV_VALUE_MASK;
 	return sdnv_bytes;
 }
 
-int_fast8_t sdnv_write_u16(uint8_t *buffer, uint16_t value)
+int_fast8_t sdnv_write_u8(uint8_t *buffer, uint8_t value)
 {
-	int_fast8_t sdnv_bytes = sdnv_get_size_u16(value);
+	return sdnv_write(buffer, value);
+}
 
-	sdnv_write_generic(sdnv_bytes, buffer, value);
-	return sdnv_bytes;
+int_fast8_t sdnv_write_u16(uint8_t *buffer, uint16_t value)
+{
+	return sdnv_write(buffer, value);
 }
 
 int_fast8_t sdnv_write_u32(uint8_t *buffer, uint32_t value)
 {
-	int_fast8_t sdnv_bytes = sdnv_get_size_u32(value);
-
-	sdnv_write_generic(sdnv_bytes, buffer, value);
-	return sdnv_bytes;
+	return sdnv_write(buffer, value);
 }
 
 int_fast8_t sdnv_write_u64(uint8_t *buffer, uint64_t value)
 {
-	int_fast8_t sdnv_bytes = sdnv_get_size_u64(value);
-
-	sdnv_write_generic(sdnv_bytes, buffer, value);
-	return sdnv_bytes;
+	return sdnv_write(buffer, value);
 }
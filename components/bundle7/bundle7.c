@@ -4,7 +4,9 @@
 
 #include "ud3tn/common.h"
 #include "ud3tn/bundle.h"
+#include "ud3tn/crc.h"
 #include "ud3tn/eid.h"
+#include "ud3tn/eid_intern.h"
 
 #include <stddef.h>
 #include <string.h>
@@ -47,6 +49,25 @@ size_t bundle7_cbor_uint_sizeof(uint64_t num)
 }
 
 
+// length: SSP length without "dtn:" prefix
+static size_t dtn_eid_sizeof(const size_t length)
+{
+	return 1 // CBOR array header
+		+ bundle7_cbor_uint_sizeof(BUNDLE_V7_EID_SCHEMA_DTN)
+		// String
+		+ bundle7_cbor_uint_sizeof(length)
+		+ length;
+}
+
+static size_t ipn_eid_sizeof(const uint64_t node, const uint64_t service)
+{
+	return 1 // CBOR array header
+		+ bundle7_cbor_uint_sizeof(BUNDLE_V7_EID_SCHEMA_IPN)
+		+ 1 // CBOR array header
+		+ bundle7_cbor_uint_sizeof(node)
+		+ bundle7_cbor_uint_sizeof(service);
+}
+
 size_t bundle7_eid_sizeof(const char *eid)
 {
 	// dtn:none -> [1,0] -> 0x82 0x01 0x00
@@ -55,14 +76,7 @@ size_t bundle7_eid_sizeof(const char *eid)
 
 	// dtn:
 	if (eid[0] == 'd') {
-		// length without "dtn:" prefix
-		size_t length = strlen(eid) - 4;
-
-		return 1 // CBOR array header
-			+ bundle7_cbor_uint_sizeof(BUNDLE_V7_EID_SCHEMA_DTN)
-			// String
-			+ bundle7_cbor_uint_sizeof(length)
-			+ length;
+		return dtn_eid_sizeof(strlen(eid) - 4);
 	// ipn:
 	} else {
 		uint64_t node, service;
@@ -70,14 +84,25 @@ size_t bundle7_eid_sizeof(const char *eid)
 		if (validate_ipn_eid(eid, &node, &service) != UD3TN_OK)
 			// Error
 			return 0;
-		return 1 // CBOR array header
-			+ bundle7_cbor_uint_sizeof(BUNDLE_V7_EID_SCHEMA_IPN)
-			+ 1 // CBOR array header
-			+ bundle7_cbor_uint_sizeof(node)
-			+ bundle7_cbor_uint_sizeof(service);
+		return ipn_eid_sizeof(node, service);
 	}
 }
 
+size_t bundle7_interned_eid_sizeof(const char *eid)
+{
+	if (eid == NULL)
+		return bundle7_eid_sizeof(eid);
+
+	const struct eid_intern_info *const info = eid_intern_get_info(eid);
+
+	if (info->valid && info->scheme == EID_SCHEME_IPN)
+		return ipn_eid_sizeof(info->ipn_node, info->ipn_service);
+	// Valid dtn EIDs except for "dtn:none"
+	if (info->valid && info->dtn_node_length != 0)
+		return dtn_eid_sizeof(info->length - 4);
+	return bundle7_eid_sizeof(eid);
+}
+
 
 uint16_t bundle7_convert_to_protocol_block_flags(
 	const struct bundle_block *block)
@@ -95,9 +120,15 @@ uint16_t bundle7_convert_to_protocol_block_flags(
 void bundle7_recalculate_primary_block_length(struct bundle *bundle)
 {
 	// Primary Block
-	const size_t dst_eid_size = bundle7_eid_sizeof(bundle->destination);
-	const size_t src_eid_size = bundle7_eid_sizeof(bundle->source);
-	const size_t rpt_eid_size = bundle7_eid_sizeof(bundle->report_to);
+	const size_t dst_eid_size = bundle7_interned_eid_sizeof(
+		bundle->destination
+	);
+	const size_t src_eid_size = bundle7_interned_eid_sizeof(
+		bundle->source
+	);
+	const size_t rpt_eid_size = bundle7_interned_eid_sizeof(
+		bundle->report_to
+	);
 
 	ASSERT(dst_eid_size != 0);
 	ASSERT(src_eid_size != 0);
@@ -292,3 +323,40 @@ size_t bundle7_get_last_fragment_min_size(struct bundle *bundle)
 
 	return bundle->primary_block_length + size;
 }
+
+
+enum ud3tn_result bundle7_verify_crc(struct bundle *bundle)
+{
+	// CBOR byte string heads of the CRC fields, followed by zeros
+	static const uint8_t crc16_field[] = { 0x42, 0x00, 0x00 };
+	static const uint8_t crc32_field[] = { 0x44, 0x00, 0x00, 0x00, 0x00 };
+	enum ud3tn_result result = UD3TN_OK;
+
+	for (struct bundle_block_list *e = bundle->blocks; e; e = e->next) {
+		struct bundle_block *const block = e->data;
+		struct crc_stream crc;
+
+		if (!block->crc_pending)
+			continue;
+
+		// Continue the calculation from the end of the block header
+		if (block->crc_type == BUNDLE_CRC_TYPE_16) {
+			crc_init(&crc, CRC16_X25);
+			crc.checksum = block->crc_partial;
+			crc_feed_bytes(&crc, block->data, block->length);
+			crc_feed_bytes(&crc, crc16_field, sizeof(crc16_field));
+		} else {
+			crc_init(&crc, CRC32);
+			crc.checksum = block->crc_partial;
+			crc_feed_bytes(&crc, block->data, block->length);
+			crc_feed_bytes(&crc, crc32_field, sizeof(crc32_field));
+		}
+		crc.feed_eof(&crc);
+
+		block->crc_pending = false;
+		if (crc.checksum != block->crc.checksum)
+			result = UD3TN_FAIL;
+	}
+
+	return result;
+}
@@ -4,6 +4,7 @@
 
 #include "ud3tn/bundle.h"
 #include "ud3tn/common.h"
+#include "ud3tn/eid_intern.h"
 
 #include <stdbool.h>
 #include <stddef.h>
@@ -12,9 +13,9 @@
 #include <string.h>
 
 
-struct bundle *bundle7_create_local(
+// Creates the bundle with everything but the EIDs, which are left NULL.
+static struct bundle *create_without_eids(
 	void *payload, size_t payload_length,
-	const char *source, const char *destination,
 	uint64_t creation_time_ms, uint64_t sequence_number,
 	uint64_t lifetime_ms, enum bundle_proc_flags proc_flags)
 {
@@ -39,30 +40,71 @@ struct bundle *bundle7_create_local(
 	bundle->payload_block = bundle_block_create(BUNDLE_BLOCK_TYPE_PAYLOAD);
 	bundle->blocks = bundle_block_entry_create(bundle->payload_block);
 
-	if (bundle->payload_block == NULL || bundle->blocks == NULL)
-		goto fail;
+	if (bundle->payload_block == NULL || bundle->blocks == NULL) {
+		free(payload);
+		bundle_free(bundle);
+		return NULL;
+	}
 
-	bundle->source = strdup(source);
-	if (bundle->source == NULL)
-		goto fail;
+	// From here on, bundle_free takes care of the payload.
+	bundle->payload_block->data = payload;
+	bundle->payload_block->length = payload_length;
 
-	bundle->destination = strdup(destination);
-	if (bundle->destination == NULL)
-		goto fail; // bundle_free takes care of source
+	return bundle;
+}
 
-	bundle->report_to = strdup("dtn:none");
-	if (bundle->report_to == NULL)
-		goto fail; // bundle_free takes care of source and destination
+struct bundle *bundle7_create_local(
+	void *payload, size_t payload_length,
+	const char *source, const char *destination,
+	uint64_t creation_time_ms, uint64_t sequence_number,
+	uint64_t lifetime_ms, enum bundle_proc_flags proc_flags)
+{
+	struct bundle *bundle = create_without_eids(
+		payload, payload_length,
+		creation_time_ms, sequence_number,
+		lifetime_ms, proc_flags
+	);
 
-	bundle->payload_block->data = payload;
-	bundle->payload_block->length = payload_length;
+	if (bundle == NULL)
+		return NULL;
+
+	bundle->source = eid_intern(source);
+	bundle->destination = eid_intern(destination);
+	bundle->report_to = eid_intern("dtn:none");
+	// bundle_free takes care of the EIDs that could be interned
+	if (bundle->source == NULL || bundle->destination == NULL ||
+	    bundle->report_to == NULL) {
+		bundle_free(bundle);
+		return NULL;
+	}
 
 	bundle7_recalculate_primary_block_length(bundle);
 
 	return bundle;
+}
 
-fail:
-	free(payload);
-	bundle_free(bundle);
-	return NULL;
+struct bundle *bundle7_create_local_interned(
+	void *payload, size_t payload_length,
+	const char *source, const char *destination, const char *report_to,
+	uint64_t creation_time_ms, uint64_t sequence_number,
+	uint64_t lifetime_ms, enum bundle_proc_flags proc_flags)
+{
+	ASSERT(source != NULL && destination != NULL && report_to != NULL);
+
+	struct bundle *bundle = create_without_eids(
+		payload, payload_length,
+		creation_time_ms, sequence_number,
+		lifetime_ms, proc_flags
+	);
+
+	if (bundle == NULL)
+		return NULL;
+
+	bundle->source = eid_intern_ref(source);
+	bundle->destination = eid_intern_ref(destination);
+	bundle->report_to = eid_intern_ref(report_to);
+
+	bundle7_recalculate_primary_block_length(bundle);
+
+	return bundle;
 }
@@ -4,6 +4,7 @@
 
 #include "ud3tn/bundle.h"
 #include "ud3tn/eid.h"
+#include "ud3tn/eid_intern.h"
 
 #include "cbor.h"
 
@@ -302,14 +303,11 @@ CborError serialize_dtn(const char *eid, CborEncoder *encoder)
 }
 
 
-CborError serialize_ipn(const char *eid, CborEncoder *encoder)
+static CborError serialize_ipn_numbers(const uint64_t nodenum,
+				       const uint64_t servicenum,
+				       CborEncoder *encoder)
 {
 	CborEncoder inner, ssp;
-	uint64_t nodenum, servicenum;
-
-	// Parse node and service numbers
-	if (validate_ipn_eid(eid, &nodenum, &servicenum) != UD3TN_OK)
-		return CborErrorIllegalType;
 
 	// EID container
 	cbor_encoder_create_array(encoder, &inner, 2);
@@ -330,6 +328,18 @@ CborError serialize_ipn(const char *eid, CborEncoder *encoder)
 }
 
 
+CborError serialize_ipn(const char *eid, CborEncoder *encoder)
+{
+	uint64_t nodenum, servicenum;
+
+	// Parse node and service numbers
+	if (validate_ipn_eid(eid, &nodenum, &servicenum) != UD3TN_OK)
+		return CborErrorIllegalType;
+
+	return serialize_ipn_numbers(nodenum, servicenum, encoder);
+}
+
+
 size_t bundle7_eid_get_max_serialized_size(const char *eid)
 {
 	// dtn:none
@@ -411,13 +421,31 @@ CborError bundle7_eid_serialize_cbor(const char *eid, CborEncoder *encoder)
 		return CborErrorIllegalType;
 }
 
-int bundle7_eid_serialize(const char *eid, uint8_t *buffer, size_t buffer_size)
+CborError bundle7_interned_eid_serialize_cbor(const char *eid,
+					      CborEncoder *encoder)
+{
+	if (eid == NULL)
+		return serialize_dtn_none(encoder);
+
+	const struct eid_intern_info *const info = eid_intern_get_info(eid);
+
+	// The numbers have already been parsed when interning the EID.
+	if (info->valid && info->scheme == EID_SCHEME_IPN)
+		return serialize_ipn_numbers(info->ipn_node, info->ipn_service,
+					     encoder);
+	return bundle7_eid_serialize_cbor(eid, encoder);
+}
+
+static int serialize_to_buffer(const char *eid, uint8_t *buffer,
+			       size_t buffer_size,
+			       CborError (*serialize)(const char *,
+						      CborEncoder *))
 {
 	CborEncoder encoder;
 	CborError err;
 
 	cbor_encoder_init(&encoder, buffer, buffer_size, 0);
-	err = bundle7_eid_serialize_cbor(eid, &encoder);
+	err = serialize(eid, &encoder);
 
 	// A non-recoverable error occurred
 	if (err != CborNoError && err != CborErrorOutOfMemory)
@@ -429,3 +457,16 @@ int bundle7_eid_serialize(const char *eid, uint8_t *buffer, size_t buffer_size)
 
 	return cbor_encoder_get_buffer_size(&encoder, buffer);
 }
+
+int bundle7_eid_serialize(const char *eid, uint8_t *buffer, size_t buffer_size)
+{
+	return serialize_to_buffer(eid, buffer, buffer_size,
+				   bundle7_eid_serialize_cbor);
+}
+
+int bundle7_interned_eid_serialize(const char *eid, uint8_t *buffer,
+				   size_t buffer_size)
+{
+	return serialize_to_buffer(eid, buffer, buffer_size,
+				   bundle7_interned_eid_serialize_cbor);
+}
@@ -1,10 +1,10 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "bundle7/bundle7.h"
 #include "bundle7/fragment.h"
 
 #include "ud3tn/bundle.h"
 #include "ud3tn/bundle_fragmenter.h"
 
-#include <assert.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
@@ -27,6 +27,11 @@ struct bundle *bundle7_fragment_bundle(struct bundle *working_bundle,
 	if (first_payload_length >= working_bundle->payload_block->length)
 		return working_bundle;
 
+	// The payload CRC of the fragments is calculated for their slices of
+	// the payload, so a deferred CRC has to be verified before.
+	if (bundle7_verify_crc(working_bundle) != UD3TN_OK)
+		return NULL;
+
 	// Create second fragment and initialize payload
 	struct bundle *remainder = bundlefragmenter_create_new_fragment(
 		working_bundle, false);
@@ -62,7 +67,8 @@ struct bundle *bundle7_fragment_bundle(struct bundle *working_bundle,
 		cur_block = cur_block->next;
 	}
 
-	// Copy second fragment to payload block
+	// Let the second fragment's payload block reference the remaining
+	// payload, both fragments share the buffer (no copy is made).
 	remainder->payload_block = bundle_block_create(
 		BUNDLE_BLOCK_TYPE_PAYLOAD
 	);
@@ -70,19 +76,17 @@ struct bundle *bundle7_fragment_bundle(struct bundle *working_bundle,
 		bundle_free(remainder);
 		return NULL;
 	}
-	remainder->payload_block->length =
-		working_bundle->payload_block->length - first_payload_length;
-	remainder->payload_block->data =
-		malloc(remainder->payload_block->length);
-	if (remainder->payload_block->data == NULL) {
+	if (bundle_block_share_slice(
+			remainder->payload_block,
+			working_bundle->payload_block,
+			first_payload_length,
+			working_bundle->payload_block->length -
+				first_payload_length) != UD3TN_OK) {
+		bundle_block_free(remainder->payload_block);
+		remainder->payload_block = NULL;
 		bundle_free(remainder);
 		return NULL;
 	}
-	memcpy(
-		remainder->payload_block->data,
-		working_bundle->payload_block->data + first_payload_length,
-		remainder->payload_block->length
-	);
 
 	// Link last block with payload block
 	struct bundle_block_list *payload_entry = bundle_block_entry_create(
@@ -104,13 +108,8 @@ struct bundle *bundle7_fragment_bundle(struct bundle *working_bundle,
 		working_bundle->total_adu_length =
 			working_bundle->payload_block->length;
 
-	// Shorten first fragment's payload block
-	working_bundle->payload_block->data =
-		realloc(working_bundle->payload_block->data, first_payload_length);
-
-	assert(working_bundle->payload_block->data != NULL);
-
-	// Set correct lengths and offsets
+	// Shorten first fragment's payload block (the slice of the shared
+	// buffer) and set correct lengths and offsets
 	working_bundle->payload_block->length = first_payload_length;
 	remainder->fragment_offset =
 		working_bundle->fragment_offset + first_payload_length;
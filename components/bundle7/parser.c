@@ -1,13 +1,15 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
 #include "bundle7/parser.h"
-#include "bundle7/timestamp.h"
 
 #include "ud3tn/common.h"
+#include "ud3tn/eid.h"
+#include "ud3tn/eid_intern.h"
+#include "ud3tn/memory_budget.h"
 
-#include "compilersupport_p.h" // Private TinyCBOR header, used for endianness
-
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 /**
  * Shortcut access to current bundle block
@@ -21,625 +23,725 @@
 #define FAIL(state) ((state)->basedata->status = PARSER_STATUS_ERROR)
 
 
-// -----------------------------
-// Cyclic Redundancy Check (CRC)
-// -----------------------------
-
-static void crc_verify(struct bundle7_parser *state, uint32_t checksum,
-	uint32_t expected)
-{
-	if (checksum != expected)
-		state->basedata->flags |= PARSER_FLAG_CRC_INVALID;
-}
-
-
-// --------------------
-// Bundle start and end
-// --------------------
-
-static CborError bundle_start(struct bundle7_parser *, CborValue *);
-static CborError bundle_end(struct bundle7_parser *, CborValue *);
-
+// CBOR major types, see RFC 8949, section 3.1
+enum cbor_major_type {
+	CBOR_MAJOR_UINT = 0,
+	CBOR_MAJOR_BYTE_STRING = 2,
+	CBOR_MAJOR_TEXT_STRING = 3,
+	CBOR_MAJOR_ARRAY = 4,
+	CBOR_MAJOR_SIMPLE = 7,
+};
 
-// -------------
-// Primary block
-// -------------
-
-static CborError primary_block_start(struct bundle7_parser *, CborValue *);
-static CborError protocol_version(struct bundle7_parser *, CborValue *);
-static CborError primary_proc_flags(struct bundle7_parser *, CborValue *);
-static CborError crc_type(struct bundle7_parser *, CborValue *);
-static CborError destination_eid(struct bundle7_parser *, CborValue *);
-static CborError source_eid(struct bundle7_parser *, CborValue *);
-static CborError report_to_eid(struct bundle7_parser *, CborValue *);
-static CborError creation_timestamp(struct bundle7_parser *, CborValue *);
-static CborError lifetime(struct bundle7_parser *, CborValue *);
-static CborError fragment_offset(struct bundle7_parser *, CborValue *);
-static CborError total_adu_length(struct bundle7_parser *, CborValue *);
-static CborError primary_block_crc(struct bundle7_parser *, CborValue *);
+// Additional information denoting an indefinite length or a "break"
+#define CBOR_INFO_INDEFINITE 31
 
 
-// ----------------
-// Extension Blocks
-// ----------------
-
-static CborError block_start(struct bundle7_parser *, CborValue *);
-static CborError block_type(struct bundle7_parser *, CborValue *);
-static CborError block_number(struct bundle7_parser *, CborValue *);
-static CborError block_proc_flags(struct bundle7_parser *, CborValue *);
-static CborError block_crc_type(struct bundle7_parser *, CborValue *);
-static CborError block_crc(struct bundle7_parser *, CborValue *);
-static CborError block_data(struct bundle7_parser *, CborValue *);
-static CborError block_end(struct bundle7_parser *, CborValue *);
-
-
-// --------------------
-// Bundle start and end
-// --------------------
-
-CborError bundle_start(struct bundle7_parser *state, CborValue *it)
+static void release_budget(struct bundle7_parser *state)
 {
-	if (!cbor_value_is_array(it) || cbor_value_is_length_known(it))
-		return CborErrorIllegalType;
-
-	state->next = primary_block_start;
-	return cbor_value_enter_container(it, it);
+	memory_budget_release(MEMORY_BUDGET_PARSING, state->budget_bytes);
+	state->budget_bytes = 0;
 }
 
-
-CborError bundle_end(struct bundle7_parser *state, CborValue *it)
+/**
+ * Add the given number of bytes to the size of the bundle.
+ *
+ * @return false if the bundle would exceed the bundle quota
+ */
+static bool account(struct bundle7_parser *state, const uint64_t bytes)
 {
-	struct bundle *bundle;
-
-	if (*it->source.ptr != 0xff)
-		return CborErrorIllegalType;
-	it->source.ptr++;
-
-	// Transition into "Done" state
-	// NOTE that it is expected that a transition to "DONE" also occurs if
-	// the CRC is invalid. In this case, however, the "send" callback
-	// is not called. The caller may check for this case by examining the
-	// parser flags for `PARSER_FLAG_CRC_INVALID` when the `status` is
-	// `PARSER_STATUS_DONE`.
-	state->basedata->status = PARSER_STATUS_DONE;
-
-	// Clear bundle reference
-	bundle = state->bundle;
-	state->bundle = NULL;
-
-	// Call "send" callback if set and all CRCs passed, otherwise discard
-	// parsed bundle silently
-	if (state->send_callback == NULL ||
-	    state->basedata->flags & PARSER_FLAG_CRC_INVALID)
-		bundle_free(bundle);
-	else
-		state->send_callback(bundle, state->send_param);
-
-	return CborNoError;
+	if (bytes > state->bundle_quota - state->bundle_size)
+		return false;
+	state->bundle_size += bytes;
+	return true;
 }
 
 
-// -------------
-// Primary Block
-// -------------
+// ---------
+// CBOR Head
+// ---------
 
-CborError primary_block_start(struct bundle7_parser *state, CborValue *it)
+/**
+ * Decode the head of the next CBOR item, which may be split up across
+ * multiple reads. The head is complete if no bytes are missing afterwards.
+ *
+ * @return Number of bytes consumed
+ */
+static size_t read_head(struct bundle7_parser *state, const uint8_t *buffer,
+			const size_t length)
 {
-	if (!cbor_value_is_array(it) || !cbor_value_is_length_known(it))
-		return CborErrorIllegalType;
+	size_t consumed = 0;
+
+	if (state->head.length == 0) {
+		const uint8_t info = buffer[0] & 0x1f;
+
+		state->head.bytes[0] = buffer[0];
+		state->head.length = 1;
+		consumed = 1;
+
+		if (info < 24) {
+			state->head.value = info;
+			state->head.missing = 0;
+		} else if (info < 28) {
+			// 1, 2, 4 or 8 bytes in network byte order
+			state->head.value = 0;
+			state->head.missing = 1 << (info - 24);
+		} else if (info == CBOR_INFO_INDEFINITE) {
+			state->head.value = 0;
+			state->head.missing = 0;
+		} else {
+			// Reserved values
+			FAIL(state);
+			return consumed;
+		}
+	}
 
-	// Primary block CRC
-	state->flags |= BUNDLE_V7_PARSER_CRC_FEED;
+	while (state->head.missing != 0 && consumed < length) {
+		const uint8_t byte = buffer[consumed++];
 
-	crc_init(&state->crc16, CRC16_X25);
-	crc_init(&state->crc32, CRC32);
+		state->head.bytes[state->head.length++] = byte;
+		state->head.value = (state->head.value << 8) | byte;
+		state->head.missing--;
+	}
 
-	state->next = protocol_version;
-	return cbor_value_enter_container(it, it);
+	return consumed;
 }
 
-
-CborError protocol_version(struct bundle7_parser *state, CborValue *it)
+static inline bool head_is(const struct bundle7_parser *state,
+			   const enum cbor_major_type major)
 {
-	uint64_t version;
-
-	if (!cbor_value_is_unsigned_integer(it))
-		return CborErrorIllegalType;
-
-	cbor_value_get_uint64(it, &version);
-	state->bundle->protocol_version = version;
-
-	state->next = primary_proc_flags;
-	return cbor_value_advance_fixed(it);
+	return (state->head.bytes[0] >> 5) == major &&
+		(state->head.bytes[0] & 0x1f) != CBOR_INFO_INDEFINITE;
 }
 
-
-CborError primary_proc_flags(struct bundle7_parser *state, CborValue *it)
+static inline bool head_is_uint(const struct bundle7_parser *state)
 {
-	uint64_t flags;
-
-	if (!cbor_value_is_unsigned_integer(it))
-		return CborErrorIllegalType;
-
-	cbor_value_get_uint64(it, &flags);
-
-	state->bundle->proc_flags = (uint32_t)flags & BP_V7_FLAGS;
-	state->next = crc_type;
-	return cbor_value_advance_fixed(it);
+	return head_is(state, CBOR_MAJOR_UINT);
 }
 
-
-CborError crc_type(struct bundle7_parser *state, CborValue *it)
+/**
+ * Determine whether the head is encoded using the fewest bytes possible, as
+ * required for the "core deterministic encoding" (RFC 8949, section 4.2.1).
+ */
+static bool head_is_shortest(const struct bundle7_parser *state)
 {
-	uint64_t type;
-
-	if (!cbor_value_is_unsigned_integer(it))
-		return CborErrorIllegalType;
-
-	cbor_value_get_uint64(it, &type);
-
-	// Validate CRC type
-	if (type > BUNDLE_CRC_TYPE_32)
-		return CborErrorIllegalType;
-
-	state->bundle->crc_type = type;
-
-	// Deactivate CRC feeding if CRC is not enabled
-	if (state->bundle->crc_type == BUNDLE_CRC_TYPE_NONE)
-		state->flags &= ~BUNDLE_V7_PARSER_CRC_FEED;
-
-	state->next = destination_eid;
-	return cbor_value_advance_fixed(it);
+	switch (state->head.length) {
+	case 1:
+		return true;
+	case 2:
+		return state->head.value >= 24;
+	case 3:
+		return state->head.value > UINT8_MAX;
+	case 5:
+		return state->head.value > UINT16_MAX;
+	default:
+		return state->head.value > UINT32_MAX;
+	}
 }
 
-
-CborError parse_eid(struct bundle7_parser *state, CborValue *it, char **eid,
-	CborError (*next)(struct bundle7_parser *, CborValue *))
+static inline bool head_is_array(const struct bundle7_parser *state,
+				 const uint64_t items)
 {
-	CborError err = bundle7_eid_parse_cbor(it, eid);
-
-	if (err)
-		return err;
-
-	state->next = next;
-	return CborNoError;
+	return head_is(state, CBOR_MAJOR_ARRAY) && state->head.value == items;
 }
 
-
-CborError destination_eid(struct bundle7_parser *state, CborValue *it)
+/**
+ * Let the content of a string of the given length be copied to the given
+ * destination. string_read() is invoked when it is complete.
+ */
+static void copy_string(struct bundle7_parser *state, uint8_t *destination,
+			const size_t length)
 {
-	return parse_eid(state, it, &state->bundle->destination, source_eid);
+	state->copy_pos = destination;
+	state->copy_remaining = length;
 }
 
 
-CborError source_eid(struct bundle7_parser *state, CborValue *it)
-{
-	return parse_eid(state, it, &state->bundle->source, report_to_eid);
-}
-
+// -----------------------------
+// Cyclic Redundancy Check (CRC)
+// -----------------------------
 
-CborError report_to_eid(struct bundle7_parser *state, CborValue *it)
+/**
+ * Start the CRC calculation for a new block. Only the CRC type the block
+ * declares is calculated, the preceding items are buffered until it is known.
+ */
+static void crc_start(struct bundle7_parser *state)
 {
-	return parse_eid(state, it, &state->bundle->report_to,
-		creation_timestamp);
+	state->crc_prefix_length = 0;
+	state->flags |= BUNDLE_V7_PARSER_CRC_FEED | BUNDLE_V7_PARSER_CRC_PREFIX;
+	state->flags &= ~(BUNDLE_V7_PARSER_NOT_REENCODABLE |
+			  BUNDLE_V7_PARSER_CRC_DEFERRED);
 }
 
-
-CborError creation_timestamp(struct bundle7_parser *state, CborValue *it)
+static enum ud3tn_result crc_feed(struct bundle7_parser *state,
+				  const uint8_t *data, const size_t length)
 {
-	CborError err;
-
-	err = bundle7_timestamp_parse(it,
-		&state->bundle->creation_timestamp_ms,
-		&state->bundle->sequence_number);
-	if (err)
-		return err;
-
-	state->next = lifetime;
-	return CborNoError;
+	if (!(state->flags & BUNDLE_V7_PARSER_CRC_FEED))
+		return UD3TN_OK;
+	if (!(state->flags & BUNDLE_V7_PARSER_CRC_PREFIX)) {
+		crc_feed_bytes(&state->crc, data, length);
+		return UD3TN_OK;
+	}
+	// Only heads precede the CRC type, which fit unless the block has
+	// more items in front of it than allowed.
+	if (length > sizeof(state->crc_prefix) - state->crc_prefix_length)
+		return UD3TN_FAIL;
+	memcpy(state->crc_prefix + state->crc_prefix_length, data, length);
+	state->crc_prefix_length += length;
+	return UD3TN_OK;
 }
 
-
-CborError lifetime(struct bundle7_parser *state, CborValue *it)
+static void crc_set_type(struct bundle7_parser *state,
+			 const enum bundle_crc_type type)
 {
-	uint64_t value;
-
-	if (!cbor_value_is_unsigned_integer(it))
-		return CborErrorIllegalType;
-
-	cbor_value_get_uint64(it, &value);
-	state->bundle->lifetime_ms = value;
-
-	const uint8_t *last_ptr = it->source.ptr;
-	CborError err = cbor_value_advance_fixed(it);
-
-	if (bundle_is_fragmented(state->bundle)) {
-		state->next = fragment_offset;
-	} else if (state->bundle->crc_type != BUNDLE_CRC_TYPE_NONE) {
-		state->next = primary_block_crc;
-	} else {
-		state->next = block_start;
-
-		// -1 Byte infinite array header
-		state->bundle->primary_block_length = state->bundle_size - 1 +
-			(it->source.ptr - last_ptr);
+	state->flags &= ~BUNDLE_V7_PARSER_CRC_PREFIX;
+	if (type == BUNDLE_CRC_TYPE_NONE) {
+		state->flags &= ~BUNDLE_V7_PARSER_CRC_FEED;
+		return;
 	}
-
-	return err;
+	crc_init(&state->crc, type == BUNDLE_CRC_TYPE_16 ? CRC16_X25 : CRC32);
+	crc_feed_bytes(&state->crc, state->crc_prefix,
+		       state->crc_prefix_length);
 }
 
-
-CborError fragment_offset(struct bundle7_parser *state, CborValue *it)
+static size_t crc_length(const enum bundle_crc_type type)
 {
-	uint64_t offset;
-
-	if (!cbor_value_is_unsigned_integer(it))
-		return CborErrorIllegalType;
-
-	cbor_value_get_uint64(it, &offset);
-	state->bundle->fragment_offset = offset;
-
-	state->next = total_adu_length;
-	return cbor_value_advance_fixed(it);
+	return type == BUNDLE_CRC_TYPE_16 ? 2 : 4;
 }
 
-
-CborError total_adu_length(struct bundle7_parser *state, CborValue *it)
+/**
+ * Compare the received CRC value against the checksum of the block, for which
+ * the CRC field is populated with zeros.
+ */
+static void crc_verify(struct bundle7_parser *state,
+		       const enum bundle_crc_type type, union crc *field)
 {
-	uint64_t length;
+	static const uint8_t zeros[4];
+	const size_t length = crc_length(type);
+	uint32_t received = 0;
+
+	// The value is transmitted in network byte order
+	for (size_t i = 0; i < length; i++)
+		received = (received << 8) | state->crc_value.bytes[i];
+	field->checksum = received;
+
+	crc_feed_bytes(&state->crc, zeros, length);
+	state->crc.feed_eof(&state->crc);
+	if (state->crc.checksum != received)
+		state->basedata->flags |= PARSER_FLAG_CRC_INVALID;
 
-	if (!cbor_value_is_unsigned_integer(it))
-		return CborErrorIllegalType;
+	state->flags &= ~BUNDLE_V7_PARSER_CRC_FEED;
+}
 
-	cbor_value_get_uint64(it, &length);
-	state->bundle->total_adu_length = length;
+/**
+ * Determine whether the CRC of the block can be verified on demand, which is
+ * only worthwhile for the payload. The received CRC is only valid for the
+ * serialized block if it is encoded like the serializer does.
+ */
+static bool crc_deferrable(const struct bundle7_parser *state,
+			   const struct bundle_block *block)
+{
+	return state->defer_crc &&
+		block->type == BUNDLE_BLOCK_TYPE_PAYLOAD &&
+		block->length != 0 &&
+		!(state->flags & BUNDLE_V7_PARSER_NOT_REENCODABLE);
+}
 
-	const uint8_t *last_ptr = it->source.ptr;
-	CborError err = cbor_value_advance_fixed(it);
+/**
+ * Retain the received CRC of a block whose data has not been fed into the
+ * CRC calculation, see bundle7_verify_crc().
+ */
+static void crc_defer(struct bundle7_parser *state, struct bundle_block *block)
+{
+	const size_t length = crc_length(block->crc_type);
+	uint32_t received = 0;
 
-	if (state->bundle->crc_type != BUNDLE_CRC_TYPE_NONE) {
-		state->next = primary_block_crc;
-	} else {
-		state->next = block_start;
+	for (size_t i = 0; i < length; i++)
+		received = (received << 8) | state->crc_value.bytes[i];
+	block->crc.checksum = received;
+	block->crc_pending = true;
 
-		// -1 Byte infinite array header
-		state->bundle->primary_block_length = state->bundle_size - 1 +
-			(it->source.ptr - last_ptr);
-	}
+	// Deterministic encoding is mandatory for bundles (RFC 9171, section
+	// 4.1), the CRC field cannot be verified later otherwise.
+	if (state->flags & BUNDLE_V7_PARSER_NOT_REENCODABLE)
+		state->basedata->flags |= PARSER_FLAG_CRC_INVALID;
 
-	return err;
+	state->flags &= ~(BUNDLE_V7_PARSER_CRC_FEED |
+			  BUNDLE_V7_PARSER_CRC_DEFERRED);
 }
 
-
-CborError primary_block_crc(struct bundle7_parser *state, CborValue *it)
+static enum ud3tn_result crc_field(struct bundle7_parser *state,
+				   const enum bundle_crc_type type)
 {
-	union crc crc;
-	size_t len = sizeof(crc);
-	CborError err;
-
-	if (!cbor_value_is_byte_string(it))
-		return CborErrorIllegalType;
+	const size_t length = crc_length(type);
 
-	err = cbor_value_copy_byte_string(it, crc.bytes, &len, it);
-	if (err)
-		return err;
+	if (!head_is(state, CBOR_MAJOR_BYTE_STRING) ||
+	    state->head.value != length || !account(state, length))
+		return UD3TN_FAIL;
+	copy_string(state, state->crc_value.bytes, length);
+	return UD3TN_OK;
+}
 
-	// Deactivate CRC feeding for the CRC field itself
-	state->flags &= ~BUNDLE_V7_PARSER_CRC_FEED;
 
-	if (state->bundle->crc_type == BUNDLE_CRC_TYPE_16) {
-		// Ensure correct CRC 16 length
-		if (len != 2)
-			return CborErrorIllegalType;
+// --------------------
+// Bundle start and end
+// --------------------
 
-		// CRC field is populated with zero
-		state->crc16.feed(&state->crc16, 0x42); // CBOR 2-b array header
-		state->crc16.feed(&state->crc16, 0x00);
-		state->crc16.feed(&state->crc16, 0x00);
-		state->crc16.feed_eof(&state->crc16);
+static void bundle_end(struct bundle7_parser *state)
+{
+	struct bundle *bundle;
 
-		// Swap from network byte order to native order and clear all
-		// higher bits
-		state->bundle->crc.checksum = cbor_ntohs(crc.checksum & 0xffff);
+	// Transition into "Done" state
+	// NOTE that it is expected that a transition to "DONE" also occurs if
+	// the CRC is invalid. In this case, however, the "send" callback
+	// is not called. The caller may check for this case by examining the
+	// parser flags for `PARSER_FLAG_CRC_INVALID` when the `status` is
+	// `PARSER_STATUS_DONE`.
+	state->basedata->status = PARSER_STATUS_DONE;
 
-		crc_verify(state,
-			state->crc16.checksum,
-			state->bundle->crc.checksum);
+	// Clear bundle reference, the next bundle gets a new arena
+	bundle = state->bundle;
+	state->bundle = NULL;
+	bundle_arena_release(&state->arena);
+	release_budget(state);
 
-		// -1 Byte infinite array header + 3 Bytes CRC field
-		state->bundle->primary_block_length = state->bundle_size - 1 + 3;
-	} else {
-		// Ensure correct CRC 32 length
-		if (len != 4)
-			return CborErrorIllegalType;
-
-		// CRC field is populated with zero
-		state->crc32.feed(&state->crc32, 0x44); // CBOR 4-b array header
-		state->crc32.feed(&state->crc32, 0x00);
-		state->crc32.feed(&state->crc32, 0x00);
-		state->crc32.feed(&state->crc32, 0x00);
-		state->crc32.feed(&state->crc32, 0x00);
-		state->crc32.feed_eof(&state->crc32);
-
-		// Swap from network byte order to native order
-		state->bundle->crc.checksum = cbor_ntohl(crc.checksum);
-
-		crc_verify(state,
-			state->crc32.checksum,
-			state->bundle->crc.checksum);
-
-		// -1 Byte infinite array header + 5 Bytes CRC field
-		state->bundle->primary_block_length = state->bundle_size - 1 + 5;
+	// Call "send" callback if set and all CRCs passed, otherwise discard
+	// parsed bundle silently
+	if (state->send_callback == NULL ||
+	    state->basedata->flags & PARSER_FLAG_CRC_INVALID)
+		bundle_free(bundle);
+	else {
+		// The fields are hot in the cache now, so obtain the ID early.
+		bundle_get_id(bundle);
+		state->send_callback(bundle, state->send_param);
 	}
-
-	state->next = block_start;
-
-	return CborNoError;
 }
 
 
-// ----------------
-// Extension Blocks
-// ----------------
+// -------------
+// Primary Block
+// -------------
 
-CborError block_start(struct bundle7_parser *state, CborValue *it)
+static const char **eid_field(struct bundle7_parser *state)
 {
-	if (!cbor_value_is_array(it))
-		return CborErrorIllegalType;
-
-	// Reset CRC streams
-	crc_init(&state->crc16, CRC16_X25);
-	crc_init(&state->crc32, CRC32);
-
-	// Enable CRC feeding again
-	state->flags |= BUNDLE_V7_PARSER_CRC_FEED;
-
-	state->next = block_type;
-	return cbor_value_enter_container(it, it);
+	switch (state->stage) {
+	case BUNDLE7_STAGE_DESTINATION:
+		return &state->bundle->destination;
+	case BUNDLE7_STAGE_SOURCE:
+		return &state->bundle->source;
+	default:
+		ASSERT(state->stage == BUNDLE7_STAGE_REPORT_TO);
+		return &state->bundle->report_to;
+	}
 }
 
-
-CborError block_type(struct bundle7_parser *state, CborValue *it)
+// Store the interned EID and continue with the next field.
+static enum ud3tn_result eid_set(struct bundle7_parser *state,
+				 const char *eid)
 {
-	uint64_t type;
-
-	if (!cbor_value_is_unsigned_integer(it))
-		return CborErrorIllegalType;
+	*eid_field(state) = eid;
+	if (eid == NULL)
+		return UD3TN_FAIL;
 
-	cbor_value_get_uint64(it, &type);
+	state->stage++;
+	state->item = 0;
+	return UD3TN_OK;
+}
 
-	if (*state->current_block_entry == NULL) {
-		// Create bundle block
-		struct bundle_block *block = bundle_block_create(type);
+static enum ud3tn_result eid_end(struct bundle7_parser *state)
+{
+	const char *const eid = eid_intern_take(state->eid);
 
-		if (block == NULL)
-			return CborErrorOutOfMemory;
+	state->eid = NULL;
+	return eid_set(state, eid);
+}
 
-		// Create bundle block list entry
-		*state->current_block_entry = bundle_block_entry_create(block);
+/**
+ * EIDs are encoded as [scheme, SSP], the SSP being either a text string or
+ * zero ("dtn" scheme), or an array of node and service number ("ipn" scheme).
+ */
+static enum ud3tn_result eid_item(struct bundle7_parser *state)
+{
+	const uint64_t value = state->head.value;
 
-		if (*state->current_block_entry == NULL) {
-			bundle_block_free(block);
-			return CborErrorOutOfMemory;
+	switch (state->item) {
+	case 0:
+		if (!head_is_array(state, 2))
+			return UD3TN_FAIL;
+		state->item = 1;
+		return UD3TN_OK;
+	case 1:
+		if (!head_is_uint(state))
+			return UD3TN_FAIL;
+		if (value == BUNDLE_V7_EID_SCHEMA_DTN)
+			state->item = 2;
+		else if (value == BUNDLE_V7_EID_SCHEMA_IPN)
+			state->item = 3;
+		else
+			return UD3TN_FAIL;
+		return UD3TN_OK;
+	case 2:
+		// Special case: null-EID ("dtn:none")
+		if (head_is_uint(state)) {
+			if (value != 0)
+				return UD3TN_FAIL;
+			return eid_set(state, eid_intern("dtn:none"));
 		}
-	} else {
-		// Was already created but the last operation failed with a
-		// too-short chunk (CborErrorUnexpectedEOF).
-		ASSERT((*state->current_block_entry)->data->type == type);
+		if (!head_is(state, CBOR_MAJOR_TEXT_STRING) ||
+		    value > EID_MAX_LEN - 4 || !account(state, value))
+			return UD3TN_FAIL;
+		state->eid = malloc(4 + value + 1);
+		if (state->eid == NULL)
+			return UD3TN_FAIL;
+		memcpy(state->eid, "dtn:", 4);
+		state->eid[4 + value] = '\0';
+		if (value == 0)
+			return eid_end(state);
+		copy_string(state, (uint8_t *)state->eid + 4, value);
+		return UD3TN_OK;
+	case 3:
+		if (!head_is_array(state, 2))
+			return UD3TN_FAIL;
+		state->item = 4;
+		return UD3TN_OK;
+	case 4:
+		if (!head_is_uint(state))
+			return UD3TN_FAIL;
+		state->ipn_node = value;
+		state->item = 5;
+		return UD3TN_OK;
+	default:
+		if (!head_is_uint(state))
+			return UD3TN_FAIL;
+		// No string is allocated, parsing only happens for new EIDs.
+		return eid_set(state, eid_intern_ipn(state->ipn_node, value));
 	}
-
-	state->next = block_number;
-	return cbor_value_advance_fixed(it);
 }
 
-
-CborError block_number(struct bundle7_parser *state, CborValue *it)
+/**
+ * The creation timestamp is encoded as [DTN time, sequence number].
+ */
+static enum ud3tn_result timestamp_item(struct bundle7_parser *state)
 {
-	uint64_t number;
-
-	if (!cbor_value_is_unsigned_integer(it))
-		return CborErrorIllegalType;
+	switch (state->item) {
+	case 0:
+		if (!head_is_array(state, 2))
+			return UD3TN_FAIL;
+		break;
+	case 1:
+		if (!head_is_uint(state))
+			return UD3TN_FAIL;
+		state->bundle->creation_timestamp_ms = state->head.value;
+		break;
+	default:
+		if (!head_is_uint(state))
+			return UD3TN_FAIL;
+		state->bundle->sequence_number = state->head.value;
+		state->stage = BUNDLE7_STAGE_LIFETIME;
+		state->item = 0;
+		return UD3TN_OK;
+	}
+	state->item++;
+	return UD3TN_OK;
+}
 
-	cbor_value_get_uint64(it, &number);
-	BLOCK(state)->number = number;
+static void primary_block_end(struct bundle7_parser *state)
+{
+	if (state->bundle->crc_type != BUNDLE_CRC_TYPE_NONE) {
+		state->stage = BUNDLE7_STAGE_PRIMARY_CRC;
+		return;
+	}
 
-	state->next = block_proc_flags;
-	return cbor_value_advance_fixed(it);
+	// -1 Byte infinite array header
+	state->bundle->primary_block_length = state->bundle_size - 1;
+	state->stage = BUNDLE7_STAGE_BLOCK;
 }
 
-
-CborError block_proc_flags(struct bundle7_parser *state, CborValue *it)
+static enum ud3tn_result lifetime(struct bundle7_parser *state)
 {
-	uint64_t flags;
-
-	if (!cbor_value_is_unsigned_integer(it))
-		return CborErrorIllegalType;
+	const bool fragmented = bundle_is_fragmented(state->bundle);
+	const bool has_crc = state->bundle->crc_type != BUNDLE_CRC_TYPE_NONE;
 
-	cbor_value_get_uint64(it, &flags);
+	if (!head_is_uint(state))
+		return UD3TN_FAIL;
+	state->bundle->lifetime_ms = state->head.value;
 
-	BLOCK(state)->flags = (((uint8_t)flags) & (
-		BUNDLE_BLOCK_FLAG_MUST_BE_REPLICATED |
-		BUNDLE_BLOCK_FLAG_DISCARD_IF_UNPROC |
-		BUNDLE_BLOCK_FLAG_REPORT_IF_UNPROC |
-		BUNDLE_BLOCK_FLAG_DELETE_BUNDLE_IF_UNPROC
-	));
+	// The remaining fields depend on the flags and CRC type
+	if (state->items != 8U + (fragmented ? 2U : 0U) + (has_crc ? 1U : 0U))
+		return UD3TN_FAIL;
 
-	state->next = block_crc_type;
-	return cbor_value_advance_fixed(it);
+	if (fragmented)
+		state->stage = BUNDLE7_STAGE_FRAGMENT_OFFSET;
+	else
+		primary_block_end(state);
+	return UD3TN_OK;
 }
 
 
-CborError block_crc_type(struct bundle7_parser *state, CborValue *it)
-{
-	uint64_t crc_type;
-
-	if (!cbor_value_is_unsigned_integer(it))
-		return CborErrorIllegalType;
-
-	cbor_value_get_uint64(it, &crc_type);
-	BLOCK(state)->crc_type = crc_type;
-
-	state->next = block_data;
+// ----------------
+// Extension Blocks
+// ----------------
 
-	// Deactivate CRC feeding
-	if (crc_type == BUNDLE_CRC_TYPE_NONE)
-		state->flags &= ~BUNDLE_V7_PARSER_CRC_FEED;
+static void block_end(struct bundle7_parser *state)
+{
+	// The payload block is the last block of the bundle
+	if (BLOCK(state)->type == BUNDLE_BLOCK_TYPE_PAYLOAD) {
+		state->bundle->payload_block = BLOCK(state);
+		state->stage = BUNDLE7_STAGE_BUNDLE_END;
+	} else {
+		state->stage = BUNDLE7_STAGE_BLOCK;
+	}
 
-	return cbor_value_advance_fixed(it);
+	// Iterate to next block entry element
+	state->current_block_entry = &(*state->current_block_entry)->next;
 }
 
-
-CborError block_crc(struct bundle7_parser *state, CborValue *it)
+static enum ud3tn_result block_type(struct bundle7_parser *state)
 {
-	union crc crc;
-	size_t len = sizeof(crc);
-	CborError err;
+	struct bundle_block *block;
 
-	if (!cbor_value_is_byte_string(it))
-		return CborErrorIllegalType;
+	if (!head_is_uint(state))
+		return UD3TN_FAIL;
 
-	// Deactivate CRC feeding for the CRC field itself
-	state->flags &= ~BUNDLE_V7_PARSER_CRC_FEED;
+	// Create bundle block
+	block = bundle_block_create(state->head.value);
+	if (block == NULL)
+		return UD3TN_FAIL;
 
-	err = cbor_value_copy_byte_string(it, crc.bytes, &len, it);
-	if (err)
-		return err;
-
-	// Feed CRC with raw CBOR block data
-	if (BLOCK(state)->crc_type == BUNDLE_CRC_TYPE_16) {
-		// Ensure correct CRC 16 checksum length
-		if (len != 2)
-			return CborErrorIllegalType;
-
-		crc_feed_bytes(&state->crc16,
-			BLOCK(state)->data,
-			BLOCK(state)->length);
-
-		// CRC field is populated with zero
-		state->crc16.feed(&state->crc16, 0x42); // CBOR byte string(2)
-		state->crc16.feed(&state->crc16, 0x00);
-		state->crc16.feed(&state->crc16, 0x00);
-		state->crc16.feed_eof(&state->crc16);
-
-		// Swap from network byte order to native order and clear all
-		// higher bits
-		BLOCK(state)->crc.checksum = cbor_ntohs(crc.checksum & 0xffff);
-
-		crc_verify(state,
-			state->crc16.checksum,
-			BLOCK(state)->crc.checksum);
-	} else {
-		// Ensure correct CRC 32 checksum length
-		if (len != 4)
-			return CborErrorIllegalType;
-
-		crc_feed_bytes(&state->crc32,
-			BLOCK(state)->data,
-			BLOCK(state)->length);
-
-		// CRC field is populated with zero
-		state->crc32.feed(&state->crc32, 0x44); // CBOR byte string(4)
-		state->crc32.feed(&state->crc32, 0x00);
-		state->crc32.feed(&state->crc32, 0x00);
-		state->crc32.feed(&state->crc32, 0x00);
-		state->crc32.feed(&state->crc32, 0x00);
-		state->crc32.feed_eof(&state->crc32);
-
-		// Swap from network byte order to native order
-		BLOCK(state)->crc.checksum = cbor_ntohl(crc.checksum);
-
-		crc_verify(state,
-			state->crc32.checksum,
-			BLOCK(state)->crc.checksum);
+	// Create bundle block list entry
+	ASSERT(*state->current_block_entry == NULL);
+	*state->current_block_entry = bundle_block_entry_create(block);
+	if (*state->current_block_entry == NULL) {
+		bundle_block_free(block);
+		return UD3TN_FAIL;
 	}
-	block_end(state, it);
 
-	return CborNoError;
+	return UD3TN_OK;
 }
 
+static enum ud3tn_result block_crc_type(struct bundle7_parser *state)
+{
+	if (!head_is_uint(state) || state->head.value > BUNDLE_CRC_TYPE_32)
+		return UD3TN_FAIL;
+	BLOCK(state)->crc_type = state->head.value;
+	crc_set_type(state, BLOCK(state)->crc_type);
+
+	// The CRC field is only present if a CRC type is set
+	if (BLOCK(state)->crc_type == BUNDLE_CRC_TYPE_NONE)
+		return state->items == 5 ? UD3TN_OK : UD3TN_FAIL;
+	return state->items == 6 ? UD3TN_OK : UD3TN_FAIL;
+}
 
-CborError block_data(struct bundle7_parser *state, CborValue *it)
+static enum ud3tn_result block_data_end(struct bundle7_parser *state)
 {
-	size_t length;
-	CborError err;
+	struct bundle_block *const block = BLOCK(state);
 
-	if (!cbor_value_is_byte_string(it))
-		return CborErrorIllegalType;
+	if (block->crc_type == BUNDLE_CRC_TYPE_NONE) {
+		block_end(state);
+		return UD3TN_OK;
+	}
 
-	err = cbor_value_get_string_length(it, &length);
-	// CBOR length may be unknown (which is not allowed by the BPbis spec)
-	if (err)
-		return err;
+	// The data is checksummed in one go after it has been received.
+	if (crc_deferrable(state, block)) {
+		block->crc_partial = state->crc.checksum;
+		state->flags |= BUNDLE_V7_PARSER_CRC_DEFERRED;
+	} else if (crc_feed(state, block->data, block->length) != UD3TN_OK) {
+		return UD3TN_FAIL;
+	}
+	state->stage = BUNDLE7_STAGE_BLOCK_CRC;
+	return UD3TN_OK;
+}
 
-	// Activate CRC feeding again
-	state->flags |= BUNDLE_V7_PARSER_CRC_FEED;
+static enum ud3tn_result block_data(struct bundle7_parser *state)
+{
+	const uint64_t length = state->head.value;
 
-	BLOCK(state)->length = length;
+	if (!head_is(state, CBOR_MAJOR_BYTE_STRING) || length > UINT32_MAX ||
+	    !account(state, length))
+		return UD3TN_FAIL;
 
 	// Block-specific data
 	// -------------------
 	//
-	BLOCK(state)->data = malloc(length);
-	if (BLOCK(state)->data == NULL)
-		return CborErrorOutOfMemory;
+	if (!memory_budget_acquire(MEMORY_BUDGET_PARSING, length))
+		return UD3TN_FAIL;
+	state->budget_bytes += length;
+	if (bundle_arena_alloc_block_data(&state->arena, BLOCK(state),
+					  length) != UD3TN_OK)
+		return UD3TN_FAIL;
+	BLOCK(state)->length = length;
 
-	// Enable "bulk read" mode
-	state->basedata->next_buffer = BLOCK(state)->data;
-	state->basedata->next_bytes = length;
-	state->basedata->flags |= PARSER_FLAG_BULK_READ;
-	state->bundle_size += length;
+	if (length == 0)
+		return block_data_end(state);
 
-	if (BLOCK(state)->crc_type != BUNDLE_CRC_TYPE_NONE)
-		state->next = block_crc;
-	else
-		state->next = block_end;
+	// The data is copied directly into the block, if it is not contained
+	// in the current input, a bulk read is requested for the rest of it.
+	copy_string(state, BLOCK(state)->data, length);
+	return UD3TN_OK;
+}
 
-	// The CBOR byte string length is represented in the same manner as a
-	// CBOR uint. We thus change the type to uint to allow cleanly
-	// advancing the iterator to just the start of the block payload.
-	it->type = CborIntegerType;
-	// NOTE: This may return an error depending on the following data
-	// which it tries to preparse. It is already ensured that the header
-	// and length can safely be read and advanced over by the result of
-	// cbor_value_get_string_length. As we have requested a BULK_READ,
-	// control will be handed over to the bulk_read handler and afterwards
-	// we re-initialize the parser.
-	cbor_value_advance_fixed(it);
-	return CborNoError;
+/**
+ * Request the caller to place the rest of the block data into the block.
+ */
+static void block_data_bulk_read(struct bundle7_parser *state)
+{
+	state->basedata->next_buffer = state->copy_pos;
+	state->basedata->next_bytes = state->copy_remaining;
+	state->basedata->flags |= PARSER_FLAG_BULK_READ;
+	state->stage = BUNDLE7_STAGE_BLOCK_DATA_BULK;
+	state->copy_pos = NULL;
+	state->copy_remaining = 0;
 }
 
 
+// -------------
+// Parser Stages
+// -------------
+
 /**
- * Bulk read operation handler
- *
- * This function gets called with an null-pointer instead of an iterator after
- * the "bulk read" operation was performed and the bulk buffer was filled.
- *
- * @return This function never fails and always returns CborNoError
+ * Process the completed head of the next CBOR item of the bundle.
  */
-CborError block_end(struct bundle7_parser *state, CborValue *it)
+static enum ud3tn_result head_read(struct bundle7_parser *state)
 {
-	(void)it;
-
-	// Update parsing callback directly because there is no transition for
-	// this callback as it gets called after the bulk read operation with
-	// a null pointer instead an CBOR iterator.
-	//
-	// Set the "next" callback to the same function to prevent undesirable
-	// transitions to an old callback of a previous stage
-	if (BLOCK(state)->type == BUNDLE_BLOCK_TYPE_PAYLOAD) {
-		state->bundle->payload_block = BLOCK(state);
-		state->parse = bundle_end;
-		state->next = bundle_end;
-	} else {
-		state->parse = block_start;
-		state->next = block_start;
+	const uint64_t value = state->head.value;
+
+	switch (state->stage) {
+	case BUNDLE7_STAGE_BUNDLE_START:
+		// Bundles are indefinite-length arrays
+		if (state->head.bytes[0] != 0x9f)
+			return UD3TN_FAIL;
+		state->stage = BUNDLE7_STAGE_PRIMARY_BLOCK;
+		return UD3TN_OK;
+	case BUNDLE7_STAGE_PRIMARY_BLOCK:
+		if (!head_is(state, CBOR_MAJOR_ARRAY))
+			return UD3TN_FAIL;
+		state->items = value;
+		crc_start(state);
+		break;
+	case BUNDLE7_STAGE_VERSION:
+		if (!head_is_uint(state))
+			return UD3TN_FAIL;
+		state->bundle->protocol_version = value;
+		break;
+	case BUNDLE7_STAGE_PROC_FLAGS:
+		if (!head_is_uint(state))
+			return UD3TN_FAIL;
+		state->bundle->proc_flags = (uint32_t)value & BP_V7_FLAGS;
+		break;
+	case BUNDLE7_STAGE_CRC_TYPE:
+		if (!head_is_uint(state) || value > BUNDLE_CRC_TYPE_32)
+			return UD3TN_FAIL;
+		state->bundle->crc_type = value;
+		crc_set_type(state, state->bundle->crc_type);
+		break;
+	case BUNDLE7_STAGE_DESTINATION:
+	case BUNDLE7_STAGE_SOURCE:
+	case BUNDLE7_STAGE_REPORT_TO:
+		return eid_item(state);
+	case BUNDLE7_STAGE_CREATION_TIMESTAMP:
+		return timestamp_item(state);
+	case BUNDLE7_STAGE_LIFETIME:
+		return lifetime(state);
+	case BUNDLE7_STAGE_FRAGMENT_OFFSET:
+		if (!head_is_uint(state))
+			return UD3TN_FAIL;
+		state->bundle->fragment_offset = value;
+		break;
+	case BUNDLE7_STAGE_TOTAL_ADU_LENGTH:
+		if (!head_is_uint(state))
+			return UD3TN_FAIL;
+		state->bundle->total_adu_length = value;
+		primary_block_end(state);
+		return UD3TN_OK;
+	case BUNDLE7_STAGE_PRIMARY_CRC:
+		return crc_field(state, state->bundle->crc_type);
+	case BUNDLE7_STAGE_BLOCK:
+		// The block array contains a CRC field if the CRC type is set
+		if (!head_is(state, CBOR_MAJOR_ARRAY) ||
+		    (value != 5 && value != 6))
+			return UD3TN_FAIL;
+		state->items = value;
+		crc_start(state);
+		break;
+	case BUNDLE7_STAGE_BLOCK_TYPE:
+		if (block_type(state) != UD3TN_OK)
+			return UD3TN_FAIL;
+		break;
+	case BUNDLE7_STAGE_BLOCK_NUMBER:
+		if (!head_is_uint(state))
+			return UD3TN_FAIL;
+		BLOCK(state)->number = value;
+		if (BLOCK(state)->number != value)
+			state->flags |= BUNDLE_V7_PARSER_NOT_REENCODABLE;
+		break;
+	case BUNDLE7_STAGE_BLOCK_PROC_FLAGS:
+		if (!head_is_uint(state))
+			return UD3TN_FAIL;
+		BLOCK(state)->flags = (((uint8_t)value) & (
+			BUNDLE_BLOCK_FLAG_MUST_BE_REPLICATED |
+			BUNDLE_BLOCK_FLAG_DISCARD_IF_UNPROC |
+			BUNDLE_BLOCK_FLAG_REPORT_IF_UNPROC |
+			BUNDLE_BLOCK_FLAG_DELETE_BUNDLE_IF_UNPROC
+		));
+		if ((uint64_t)BLOCK(state)->flags != value)
+			state->flags |= BUNDLE_V7_PARSER_NOT_REENCODABLE;
+		break;
+	case BUNDLE7_STAGE_BLOCK_CRC_TYPE:
+		if (block_crc_type(state) != UD3TN_OK)
+			return UD3TN_FAIL;
+		break;
+	case BUNDLE7_STAGE_BLOCK_DATA:
+		return block_data(state);
+	case BUNDLE7_STAGE_BLOCK_CRC:
+		return crc_field(state, BLOCK(state)->crc_type);
+	case BUNDLE7_STAGE_BUNDLE_END:
+		// The payload block has to be followed by the "break" symbol
+		if (state->head.bytes[0] != 0xff)
+			return UD3TN_FAIL;
+		bundle_end(state);
+		return UD3TN_OK;
+	default:
+		return UD3TN_FAIL;
 	}
 
-	// Iterate to next block entry element
-	state->current_block_entry = &(*state->current_block_entry)->next;
+	// Proceed to the next field of the block
+	state->stage++;
+	return UD3TN_OK;
+}
 
-	return CborNoError;
+/**
+ * Process the completed content of a string, copy_pos points to its end.
+ */
+static enum ud3tn_result string_read(struct bundle7_parser *state)
+{
+	switch (state->stage) {
+	case BUNDLE7_STAGE_DESTINATION:
+	case BUNDLE7_STAGE_SOURCE:
+	case BUNDLE7_STAGE_REPORT_TO:
+		if (crc_feed(state, (uint8_t *)state->eid + 4,
+			     state->copy_pos - ((uint8_t *)state->eid + 4)) !=
+		    UD3TN_OK)
+			return UD3TN_FAIL;
+		return eid_end(state);
+	case BUNDLE7_STAGE_PRIMARY_CRC:
+		crc_verify(state, state->bundle->crc_type,
+			   &state->bundle->crc);
+		// -1 Byte infinite array header
+		state->bundle->primary_block_length = state->bundle_size - 1;
+		state->stage = BUNDLE7_STAGE_BLOCK;
+		return UD3TN_OK;
+	case BUNDLE7_STAGE_BLOCK_DATA:
+		return block_data_end(state);
+	case BUNDLE7_STAGE_BLOCK_CRC:
+		if (state->flags & BUNDLE_V7_PARSER_CRC_DEFERRED)
+			crc_defer(state, BLOCK(state));
+		else
+			crc_verify(state, BLOCK(state)->crc_type,
+				   &BLOCK(state)->crc);
+		block_end(state);
+		return UD3TN_OK;
+	default:
+		return UD3TN_FAIL;
+	}
 }
 
 
@@ -658,7 +760,10 @@ struct parser *bundle7_parser_init(struct bundle7_parser *state,
 	state->send_callback = send_callback;
 	state->send_param = param;
 	state->bundle = NULL;
-	state->next = NULL;  // force reset to do its job
+	state->arena = (struct bundle_arena){ NULL, 0 };
+	state->budget_bytes = 0;
+	state->eid = NULL;
+	state->defer_crc = BUNDLE7_PARSER_DEFER_CRC;
 
 	// Set to error that the reset handler does not abort
 	state->basedata->status = PARSER_STATUS_ERROR;
@@ -675,15 +780,24 @@ struct parser *bundle7_parser_init(struct bundle7_parser *state,
 enum ud3tn_result bundle7_parser_reset(struct bundle7_parser *state)
 {
 	if (state->basedata->status == PARSER_STATUS_GOOD &&
-	    state->next == bundle_start)
+	    state->stage == BUNDLE7_STAGE_BUNDLE_START)
 		return UD3TN_OK;
 
 	state->basedata->status = PARSER_STATUS_GOOD;
 	state->basedata->flags = PARSER_FLAG_NONE;
 
-	state->parse = bundle_start;
+	state->stage = BUNDLE7_STAGE_BUNDLE_START;
+	state->item = 0;
+	state->head.length = 0;
+	state->copy_pos = NULL;
+	state->copy_remaining = 0;
+	free(state->eid);
+	state->eid = NULL;
+
 	state->flags = 0;
 	state->bundle_size = 0;
+	bundle_arena_release(&state->arena);
+	release_budget(state);
 
 	if (state->bundle != NULL)
 		bundle_reset(state->bundle);
@@ -703,6 +817,10 @@ enum ud3tn_result bundle7_parser_deinit(struct bundle7_parser *state)
 	free(state->basedata);
 	if (state->bundle != NULL)
 		bundle_free(state->bundle);
+	bundle_arena_release(&state->arena);
+	release_budget(state);
+	free(state->eid);
+	state->eid = NULL;
 
 	return UD3TN_OK;
 }
@@ -711,138 +829,73 @@ enum ud3tn_result bundle7_parser_deinit(struct bundle7_parser *state)
 size_t bundle7_parser_read(struct bundle7_parser *state,
 	const uint8_t *buffer, size_t length)
 {
-	CborParser parser;
-	CborValue it;
-	CborError err;
 	size_t parsed = 0;
-	bool initialize_parser = true;
-
-	// Special case:
-	//     Bulk read operation was performed and this function gets called
-	//     with an empty buffer to continue processing
-	if (buffer == NULL) {
-		// If no CRC is to be read, block_end needs to be called now.
-		// "block_end" never fails - therefore no error handling
-		if (state->parse == block_end) {
-			state->parse(state, NULL);
-			state->parse = state->next;
-		}
-		return 0;
-	}
-
-	while (parsed < length && state->basedata->status == PARSER_STATUS_GOOD) {
-		// For arbitrarily-long data such as block payload data, a
-		// "BULK_READ" operation is requested, normally to be handled
-		// by the RX task. Though, sometimes we can handle this on our
-		// own (if we have enough data in the current buffer). Thus, we
-		// first check whether, given the bytes in the buffer, we can
-		// perform the bulk read operation on our own.
-		// NOTE: At this point the CBOR parser may be in an invalid
-		// state because we have to interrupt it before it starts
-		// trying to read the bytes from the array by itself. This is
-		// not possible as the array might be too short and we want to
-		// be able to "stream" the data.
-		if (state->basedata->flags & PARSER_FLAG_BULK_READ) {
-			if (parsed + state->basedata->next_bytes > length) {
-				// Bulk read operation was requested but cannot
-				// be performed by us. -> RX task will do it.
-				break;
-			}
-
-			memcpy(
-				state->basedata->next_buffer,
-				buffer + parsed,
-				state->basedata->next_bytes
-			);
 
-			parsed += state->basedata->next_bytes;
+	// The "bulk read" operation has been performed by the caller, which
+	// usually invokes this function with an empty buffer afterwards.
+	if (state->stage == BUNDLE7_STAGE_BLOCK_DATA_BULK &&
+	    state->basedata->status == PARSER_STATUS_GOOD &&
+	    !(state->basedata->flags & PARSER_FLAG_BULK_READ)) {
+		state->stage = BUNDLE7_STAGE_BLOCK_DATA;
+		if (block_data_end(state) != UD3TN_OK)
+			FAIL(state);
+	}
 
-			// Disables bulk read mode again
-			state->basedata->flags &= ~PARSER_FLAG_BULK_READ;
+	if (buffer == NULL)
+		return 0;
 
-			// Process copied data and proceed to next block if
-			// there is not CRC to be read.
-			// This call to "block_end" is always successful.
-			if (state->parse == block_end) {
-				state->parse(state, NULL);
-				state->parse = state->next;
+	while (state->basedata->status == PARSER_STATUS_GOOD &&
+	       !(state->basedata->flags & PARSER_FLAG_BULK_READ)) {
+		// Content of a string
+		if (state->copy_pos != NULL) {
+			const size_t bytes = MIN(state->copy_remaining,
+						 length - parsed);
+
+			memcpy(state->copy_pos, buffer + parsed, bytes);
+			state->copy_pos += bytes;
+			state->copy_remaining -= bytes;
+			parsed += bytes;
+
+			if (state->copy_remaining != 0) {
+				// Data of arbitrary length is read by the
+				// caller, directly into the block.
+				if (state->stage == BUNDLE7_STAGE_BLOCK_DATA)
+					block_data_bulk_read(state);
+				break;
 			}
 
-			// Re-initialize after the "bulk read".
-			initialize_parser = true;
-
-			// Force checking the loop condition again.
+			if (string_read(state) != UD3TN_OK)
+				FAIL(state);
+			state->copy_pos = NULL;
 			continue;
 		}
 
-		if (initialize_parser) {
-			err = cbor_parser_init(
-				buffer + parsed,
-				length - parsed,
-				0, &parser, &it
-			);
-
-			// CBOR decoding error when preparsing first byte
-			if (err) {
-				// Insufficient data
-				if (err == CborErrorUnexpectedEOF)
-					break;
-
-				// We allow "unexpected" breaks
-				//
-				// The bundle is an indefinite array and its end
-				// is marked by the "break" symbol.
-				// Therefore, the buffer could contain a single
-				// "break". This happens because we cut the
-				// indefinite array by the chunked reading
-				// operation.
-				if (err != CborErrorUnexpectedBreak) {
-					FAIL(state);
-					break;
-				}
-			}
-
-			initialize_parser = false;
-		}
-
-		// Parsing step
-		err = state->parse(state, &it);
-
-		// Parsing error
-		if (err) {
-			if (err != CborErrorUnexpectedEOF)
-				FAIL(state);
+		if (parsed == length)
 			break;
-		}
 
-		// Transition to next stage
-		size_t new_parsed = (cbor_value_get_next_byte(&it) - buffer);
-
-		state->bundle_size += new_parsed - parsed;
+		// Head of the next item
+		parsed += read_head(state, buffer + parsed, length - parsed);
+		if (state->basedata->status != PARSER_STATUS_GOOD ||
+		    state->head.missing != 0)
+			break;
 
 		// Bundle is larger than allowed
-		if (state->bundle_size > state->bundle_quota) {
+		if (!account(state, state->head.length) ||
+		    head_read(state) != UD3TN_OK) {
 			FAIL(state);
 			break;
 		}
 
-		if (state->flags & BUNDLE_V7_PARSER_CRC_FEED) {
-			crc_feed_bytes(&state->crc16,
-				buffer + parsed, new_parsed - parsed);
-			crc_feed_bytes(&state->crc32,
-				buffer + parsed, new_parsed - parsed);
+		// The head is part of the current block, which is only known
+		// after processing it (e.g., for the start of a block).
+		if (!head_is_shortest(state))
+			state->flags |= BUNDLE_V7_PARSER_NOT_REENCODABLE;
+		if (crc_feed(state, state->head.bytes,
+			     state->head.length) != UD3TN_OK) {
+			FAIL(state);
+			break;
 		}
-
-		state->parse = state->next;
-		parsed = new_parsed;
-
-		// If we have reached the end of the current item/container,
-		// we re-initialize the parser as we might want to read more
-		// than that. The parser is not fully aware of the bundle
-		// CBOR structure because we interrupt the process due to
-		// the chunked and bulk read mechanics.
-		if (cbor_value_at_end(&it))
-			initialize_parser = true;
+		state->head.length = 0;
 	}
 
 	return parsed;
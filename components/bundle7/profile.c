@@ -0,0 +1,509 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "bundle7/bundle7.h"
+#include "bundle7/bundle_age.h"
+#include "bundle7/eid.h"
+#include "bundle7/hopcount.h"
+#include "bundle7/profile.h"
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/common.h"
+#include "ud3tn/crc.h"
+#include "ud3tn/eid_intern.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CBOR_MAJOR_UINT 0x00
+#define CBOR_MAJOR_BYTE_STRING 0x40
+
+// Block numbers of the extension blocks, the payload block has number 1.
+#define BUNDLE_AGE_BLOCK_NUMBER 2
+#define HOP_COUNT_BLOCK_NUMBER 3
+
+// Writes the head of a CBOR data item of the given major type, i.e. the
+// complete item for unsigned integers, in the shortest form like TinyCBOR.
+// Returns the number of bytes written, see bundle7_cbor_uint_sizeof().
+static size_t write_cbor_head(uint8_t *buffer, const uint8_t major_type,
+			      const uint64_t value)
+{
+	size_t length;
+
+	if (value <= 23) {
+		buffer[0] = major_type | (uint8_t)value;
+		return 1;
+	} else if (value <= UINT8_MAX) {
+		buffer[0] = major_type | 24;
+		length = 1;
+	} else if (value <= UINT16_MAX) {
+		buffer[0] = major_type | 25;
+		length = 2;
+	} else if (value <= UINT32_MAX) {
+		buffer[0] = major_type | 26;
+		length = 4;
+	} else {
+		buffer[0] = major_type | 27;
+		length = 8;
+	}
+
+	// Network byte order
+	for (size_t i = 0; i < length; i++)
+		buffer[1 + i] = (uint8_t)(value >> (8 * (length - 1 - i)));
+
+	return 1 + length;
+}
+
+static void add_block(struct bundle7_profile *profile,
+		      const enum bundle_block_type type, const uint8_t number)
+{
+	struct bundle7_profile_block *const block = (
+		&profile->blocks[profile->block_count++]
+	);
+
+	// All type codes and numbers used are below 24, thus, all fields are
+	// encoded into a single byte.
+	block->type = type;
+	block->number = number;
+	block->header[0] = 0x85; // CBOR array of length 5, no CRC
+	block->header[1] = (uint8_t)type;
+	block->header[2] = number;
+	block->header[3] = 0; // No block processing control flags
+	block->header[4] = BUNDLE_CRC_TYPE_NONE;
+}
+
+struct bundle7_profile *bundle7_profile_create(
+	const char *source, const char *report_to, uint64_t lifetime_ms,
+	enum bundle_crc_type crc_type,
+	enum bundle7_profile_blocks extension_blocks, uint16_t hop_limit)
+{
+	const char *const source_interned = eid_intern(source);
+	const char *const report_to_interned = eid_intern(report_to);
+
+	if (source_interned == NULL || report_to_interned == NULL)
+		goto fail_eids;
+
+	const size_t source_size = bundle7_interned_eid_sizeof(
+		source_interned
+	);
+	const size_t report_to_size = bundle7_interned_eid_sizeof(
+		report_to_interned
+	);
+
+	if (source_size == 0 || report_to_size == 0)
+		goto fail_eids;
+
+	struct bundle7_profile *const profile = malloc(
+		sizeof(struct bundle7_profile) + source_size + report_to_size
+	);
+
+	if (profile == NULL)
+		goto fail_eids;
+
+	profile->ref_count = 1;
+	profile->source = source_interned;
+	profile->report_to = report_to_interned;
+	profile->lifetime_ms = lifetime_ms;
+	profile->crc_type = crc_type;
+	profile->extension_blocks = extension_blocks;
+	profile->hop_limit = hop_limit;
+
+	profile->block_count = 0;
+	if (extension_blocks & BUNDLE7_PROFILE_BUNDLE_AGE)
+		add_block(profile, BUNDLE_BLOCK_TYPE_BUNDLE_AGE,
+			  BUNDLE_AGE_BLOCK_NUMBER);
+	if (extension_blocks & BUNDLE7_PROFILE_HOP_COUNT)
+		add_block(profile, BUNDLE_BLOCK_TYPE_HOP_COUNT,
+			  HOP_COUNT_BLOCK_NUMBER);
+	add_block(profile, BUNDLE_BLOCK_TYPE_PAYLOAD, 1);
+
+	profile->eid_segment_length = source_size + report_to_size;
+	if (bundle7_interned_eid_serialize(
+			source_interned, profile->eid_segment,
+			source_size) != (int)source_size ||
+	    bundle7_interned_eid_serialize(
+			report_to_interned, profile->eid_segment + source_size,
+			report_to_size) != (int)report_to_size) {
+		free(profile);
+		goto fail_eids;
+	}
+
+	// Lifetime, followed by the CRC field with the checksum set to zero,
+	// as the checksum is calculated over it.
+	profile->tail_length = write_cbor_head(
+		profile->tail,
+		CBOR_MAJOR_UINT,
+		lifetime_ms
+	);
+	uint8_t *const crc_field = &profile->tail[profile->tail_length];
+
+	if (crc_type == BUNDLE_CRC_TYPE_32) {
+		crc_field[0] = CBOR_MAJOR_BYTE_STRING | 4;
+		memset(&crc_field[1], 0, 4);
+		profile->tail_length += 5;
+	} else if (crc_type == BUNDLE_CRC_TYPE_16) {
+		crc_field[0] = CBOR_MAJOR_BYTE_STRING | 2;
+		memset(&crc_field[1], 0, 2);
+		profile->tail_length += 3;
+	}
+
+	profile->fixed_length = (
+		1 + // CBOR array header
+		1 + // Protocol version
+		1 + // CRC type
+		profile->eid_segment_length +
+		1 + // CBOR array header of the creation timestamp
+		profile->tail_length
+	);
+
+	return profile;
+
+fail_eids:
+	eid_intern_release(source_interned);
+	eid_intern_release(report_to_interned);
+	return NULL;
+}
+
+struct bundle7_profile *bundle7_profile_ref(struct bundle7_profile *profile)
+{
+	if (profile != NULL)
+		__atomic_add_fetch(&profile->ref_count, 1, __ATOMIC_RELAXED);
+	return profile;
+}
+
+void bundle7_profile_unref(struct bundle7_profile *profile)
+{
+	if (profile == NULL)
+		return;
+	ASSERT(profile->ref_count != 0);
+	if (__atomic_sub_fetch(&profile->ref_count, 1, __ATOMIC_ACQ_REL) != 0)
+		return;
+	eid_intern_release(profile->source);
+	eid_intern_release(profile->report_to);
+	free(profile);
+}
+
+// Encodes the primary block of the bundle into bundle->encoded_primary_block,
+// copying the fields that are the same for all bundles from the profile.
+static enum ud3tn_result encode_primary_block(
+	const struct bundle7_profile *profile, struct bundle *bundle)
+{
+	const uint32_t flags = bundle->proc_flags & BP_V7_FLAGS;
+	const size_t destination_size = bundle7_interned_eid_sizeof(
+		bundle->destination
+	);
+	// Size of the lifetime at the start of the tail of the profile
+	const size_t profile_lifetime_size = bundle7_cbor_uint_sizeof(
+		profile->lifetime_ms
+	);
+
+	if (destination_size == 0)
+		return UD3TN_FAIL;
+
+	const size_t length = (
+		profile->fixed_length -
+		profile_lifetime_size +
+		bundle7_cbor_uint_sizeof(bundle->lifetime_ms) +
+		bundle7_cbor_uint_sizeof(flags) +
+		destination_size +
+		bundle7_cbor_uint_sizeof(bundle->creation_timestamp_ms) +
+		bundle7_cbor_uint_sizeof(bundle->sequence_number)
+	);
+	uint8_t *const buffer = malloc(length);
+	uint8_t *cur = buffer;
+
+	if (buffer == NULL)
+		return UD3TN_FAIL;
+
+	// CBOR array header with the number of items, see
+	// primary_block_get_item_count() in serializer.c.
+	*cur++ = 0x80 + (profile->crc_type != BUNDLE_CRC_TYPE_NONE ? 9 : 8);
+	*cur++ = 7; // Protocol version
+	cur += write_cbor_head(cur, CBOR_MAJOR_UINT, flags);
+	*cur++ = (uint8_t)profile->crc_type;
+
+	if (bundle7_interned_eid_serialize(bundle->destination, cur,
+					   destination_size) !=
+			(int)destination_size) {
+		free(buffer);
+		return UD3TN_FAIL;
+	}
+	cur += destination_size;
+	memcpy(cur, profile->eid_segment, profile->eid_segment_length);
+	cur += profile->eid_segment_length;
+
+	*cur++ = 0x82; // CBOR array of length 2
+	cur += write_cbor_head(cur, CBOR_MAJOR_UINT,
+			       bundle->creation_timestamp_ms);
+	cur += write_cbor_head(cur, CBOR_MAJOR_UINT, bundle->sequence_number);
+	if (bundle->lifetime_ms == profile->lifetime_ms) {
+		memcpy(cur, profile->tail, profile->tail_length);
+		cur += profile->tail_length;
+	} else {
+		cur += write_cbor_head(cur, CBOR_MAJOR_UINT,
+				       bundle->lifetime_ms);
+		memcpy(cur, &profile->tail[profile_lifetime_size],
+		       profile->tail_length - profile_lifetime_size);
+		cur += profile->tail_length - profile_lifetime_size;
+	}
+
+	ASSERT((size_t)(cur - buffer) == length);
+
+	// The checksum is calculated over the block including the CRC field,
+	// with the checksum set to zero, and replaces it afterwards.
+	if (profile->crc_type != BUNDLE_CRC_TYPE_NONE) {
+		struct crc_stream crc;
+
+		crc_init(
+			&crc,
+			profile->crc_type == BUNDLE_CRC_TYPE_32
+			? CRC32
+			: CRC16_X25
+		);
+		crc_feed_bytes(&crc, buffer, length);
+		crc.feed_eof(&crc);
+
+		const size_t crc_length = (
+			profile->crc_type == BUNDLE_CRC_TYPE_32 ? 4 : 2
+		);
+
+		// Network byte order
+		for (size_t i = 0; i < crc_length; i++)
+			buffer[length - crc_length + i] = (uint8_t)(
+				crc.checksum >> (8 * (crc_length - 1 - i))
+			);
+	}
+
+	bundle->encoded_primary_block = buffer;
+	bundle->primary_block_length = length;
+
+	return UD3TN_OK;
+}
+
+// Creates the given extension block with its initial data.
+static struct bundle_block *create_extension_block(
+	const struct bundle7_profile *profile,
+	const struct bundle7_profile_block *profile_block)
+{
+	struct bundle_block *const block = bundle_block_create(
+		profile_block->type
+	);
+
+	if (block == NULL)
+		return NULL;
+
+	block->number = profile_block->number;
+
+	if (profile_block->type == BUNDLE_BLOCK_TYPE_BUNDLE_AGE) {
+		block->data = malloc(BUNDLE_AGE_MAX_ENCODED_SIZE);
+		if (block->data != NULL)
+			block->length = bundle_age_serialize(
+				0,
+				block->data,
+				BUNDLE_AGE_MAX_ENCODED_SIZE
+			);
+	} else {
+		const struct bundle_hop_count hop_count = {
+			.limit = profile->hop_limit,
+			.count = 0,
+		};
+
+		block->data = malloc(BUNDLE7_HOP_COUNT_MAX_ENCODED_SIZE);
+		if (block->data != NULL)
+			block->length = bundle7_hop_count_serialize(
+				&hop_count,
+				block->data,
+				BUNDLE7_HOP_COUNT_MAX_ENCODED_SIZE
+			);
+	}
+
+	if (block->data == NULL) {
+		bundle_block_free(block);
+		return NULL;
+	}
+
+	return block;
+}
+
+// Creates the bundle, taking over the given reference to the interned
+// destination EID.
+static struct bundle *create_bundle(
+	struct bundle7_profile *profile,
+	void *payload, size_t payload_length,
+	const char *destination,
+	uint64_t creation_time_ms, uint64_t sequence_number,
+	uint64_t lifetime_ms, enum bundle_proc_flags proc_flags)
+{
+	struct bundle *const bundle = bundle_init();
+
+	if (bundle == NULL) {
+		eid_intern_release(destination);
+		free(payload);
+		return NULL;
+	}
+
+	bundle->protocol_version = 0x7;
+	bundle->proc_flags = proc_flags;
+	bundle->creation_timestamp_ms = creation_time_ms;
+	bundle->sequence_number = sequence_number;
+	bundle->lifetime_ms = lifetime_ms;
+	bundle->crc_type = profile->crc_type;
+	// From here on, bundle_free takes care of the destination EID.
+	bundle->destination = destination;
+
+	// Create the blocks from the last one (payload) to the first one.
+	bundle->payload_block = bundle_block_create(BUNDLE_BLOCK_TYPE_PAYLOAD);
+	bundle->blocks = bundle_block_entry_create(bundle->payload_block);
+
+	if (bundle->payload_block == NULL || bundle->blocks == NULL) {
+		free(payload);
+		bundle_free(bundle);
+		return NULL;
+	}
+
+	// From here on, bundle_free takes care of the payload.
+	bundle->payload_block->data = payload;
+	bundle->payload_block->length = payload_length;
+
+	for (int i = (int)profile->block_count - 2; i >= 0; i--) {
+		struct bundle_block *const block = create_extension_block(
+			profile,
+			&profile->blocks[i]
+		);
+		struct bundle_block_list *const entry = (
+			block != NULL ? bundle_block_entry_create(block) : NULL
+		);
+
+		if (entry == NULL) {
+			bundle_block_free(block);
+			bundle_free(bundle);
+			return NULL;
+		}
+		entry->next = bundle->blocks;
+		bundle->blocks = entry;
+	}
+
+	bundle->source = eid_intern_ref(profile->source);
+	bundle->report_to = eid_intern_ref(profile->report_to);
+	if (encode_primary_block(profile, bundle) != UD3TN_OK) {
+		bundle_free(bundle);
+		return NULL;
+	}
+
+	bundle->profile = bundle7_profile_ref(profile);
+
+	return bundle;
+}
+
+struct bundle *bundle7_profile_create_bundle(
+	struct bundle7_profile *profile,
+	void *payload, size_t payload_length,
+	const char *destination,
+	uint64_t creation_time_ms, uint64_t sequence_number,
+	enum bundle_proc_flags proc_flags)
+{
+	const char *const destination_interned = eid_intern(destination);
+
+	if (destination_interned == NULL) {
+		free(payload);
+		return NULL;
+	}
+
+	return create_bundle(
+		profile,
+		payload, payload_length,
+		destination_interned,
+		creation_time_ms, sequence_number,
+		profile->lifetime_ms, proc_flags
+	);
+}
+
+struct bundle *bundle7_profile_create_bundle_interned(
+	struct bundle7_profile *profile,
+	void *payload, size_t payload_length,
+	const char *destination,
+	uint64_t creation_time_ms, uint64_t sequence_number,
+	uint64_t lifetime_ms, enum bundle_proc_flags proc_flags)
+{
+	ASSERT(destination != NULL);
+
+	return create_bundle(
+		profile,
+		payload, payload_length,
+		eid_intern_ref(destination),
+		creation_time_ms, sequence_number,
+		lifetime_ms, proc_flags
+	);
+}
+
+bool bundle7_profile_matches(const struct bundle *bundle)
+{
+	const struct bundle7_profile *const profile = bundle->profile;
+
+	if (profile == NULL || bundle->encoded_primary_block == NULL)
+		return false;
+
+	const struct bundle_block_list *entry = bundle->blocks;
+
+	for (size_t i = 0; i < profile->block_count; i++) {
+		if (entry == NULL)
+			return false;
+
+		const struct bundle_block *const block = entry->data;
+
+		// A block without CRC never has a pending CRC, see
+		// bundle7_verify_crc().
+		if (block->type != profile->blocks[i].type ||
+		    block->number != profile->blocks[i].number ||
+		    block->crc_type != BUNDLE_CRC_TYPE_NONE ||
+		    bundle7_convert_to_protocol_block_flags(block) != 0)
+			return false;
+		entry = entry->next;
+	}
+
+	return entry == NULL;
+}
+
+enum ud3tn_result bundle7_profile_serialize(
+	struct bundle *bundle,
+	void (*write)(void *cla_obj, const void *, const size_t),
+	void (*write_ref)(void *cla_obj, const void *, const size_t),
+	void *cla_obj)
+{
+	const struct bundle7_profile *const profile = bundle->profile;
+	// The block header followed by the head of the data byte string, the
+	// length of which is at most 32 bit.
+	uint8_t buffer[BUNDLE7_PROFILE_BLOCK_HEADER_SIZE + 5];
+	const struct bundle_block_list *entry = bundle->blocks;
+
+	ASSERT(bundle7_profile_matches(bundle));
+
+	// Bundle start (CBOR indefinite array)
+	buffer[0] = 0x9f;
+	write(cla_obj, buffer, 1);
+
+	write_ref(cla_obj, bundle->encoded_primary_block,
+		  bundle->primary_block_length);
+
+	for (size_t i = 0; i < profile->block_count; i++) {
+		const struct bundle_block *const block = entry->data;
+
+		memcpy(buffer, profile->blocks[i].header,
+		       BUNDLE7_PROFILE_BLOCK_HEADER_SIZE);
+		write(cla_obj, buffer, BUNDLE7_PROFILE_BLOCK_HEADER_SIZE +
+		      write_cbor_head(
+				&buffer[BUNDLE7_PROFILE_BLOCK_HEADER_SIZE],
+				CBOR_MAJOR_BYTE_STRING,
+				block->length
+		      ));
+		write_ref(cla_obj, block->data, block->length);
+		entry = entry->next;
+	}
+
+	// CBOR "break"
+	buffer[0] = 0xff;
+	write(cla_obj, buffer, 1);
+
+	return UD3TN_OK;
+}
@@ -3,8 +3,10 @@
 #include "bundle7/reports.h"
 #include "bundle7/eid.h"
 #include "bundle7/create.h"
+#include "bundle7/profile.h"
 
 #include "ud3tn/common.h"
+#include "ud3tn/result.h"
 
 #include "cbor.h"
 
@@ -23,13 +25,16 @@
  * Calculates the length of the last 2 or 4 fields of the Administrative
  * Records "Custody Signals" and "Bundle Status Report".
  *
- * @return number of maximal required bytes for the last fields
+ * @return number of required bytes for the last fields, zero if the source
+ *         EID cannot be serialized
  */
 static inline size_t record_get_last_fields_size(const struct bundle *bundle)
 {
 	// Source EID
-	size_t payload_size = bundle7_eid_get_max_serialized_size(
-		bundle->source);
+	size_t payload_size = bundle7_interned_eid_sizeof(bundle->source);
+
+	if (payload_size == 0)
+		return 0;
 
 	// Creation Timestamp
 	payload_size += 1 // array header
@@ -69,7 +74,7 @@ static CborError serialize_last_fields(const struct bundle *bundle,
 	CborError err;
 
 	// Source EID
-	err = bundle7_eid_serialize_cbor(bundle->source, encoder);
+	err = bundle7_interned_eid_serialize_cbor(bundle->source, encoder);
 	if (err)
 		return err;
 
@@ -89,6 +94,88 @@ static CborError serialize_last_fields(const struct bundle *bundle,
 }
 
 
+// Returns the time reported for the given status information field.
+static uint64_t status_info_time(
+	const struct bundle_status_report *report,
+	enum bundle_status_report_status_flags flag)
+{
+	switch (flag) {
+	case BUNDLE_SR_FLAG_BUNDLE_RECEIVED:
+		return report->bundle_received_time;
+	case BUNDLE_SR_FLAG_BUNDLE_FORWARDED:
+		return report->bundle_forwarded_time;
+	case BUNDLE_SR_FLAG_BUNDLE_DELIVERED:
+		return report->bundle_delivered_time;
+	case BUNDLE_SR_FLAG_BUNDLE_DELETED:
+		return report->bundle_deleted_time;
+	default:
+		return 0;
+	}
+}
+
+
+// Checks whether the time is reported for the given status information field.
+static inline bool status_info_has_time(
+	const struct bundle *bundle,
+	const struct bundle_status_report *report,
+	enum bundle_status_report_status_flags flag)
+{
+	return (
+		HAS_FLAG(report->status, flag) &&
+		HAS_FLAG(bundle->proc_flags, BUNDLE_FLAG_REPORT_STATUS_TIME)
+	);
+}
+
+
+/**
+ * Calculates the length of one of the bundle status information fields,
+ * i.e. the array header, the assertion and the optional time.
+ */
+static inline size_t status_info_get_size(
+	const struct bundle *bundle,
+	const struct bundle_status_report *report,
+	enum bundle_status_report_status_flags flag)
+{
+	if (status_info_has_time(bundle, report, flag))
+		return 2 + bundle7_cbor_uint_sizeof(
+			status_info_time(report, flag)
+		);
+	return 2;
+}
+
+
+/**
+ * Calculates the exact length of the Bundle Status Report generated for the
+ * given bundle, so that it can be encoded without over-allocating.
+ *
+ * @return number of bytes of the record, zero in case of error
+ */
+static size_t status_report_get_size(
+	const struct bundle *bundle,
+	const struct bundle_status_report *report)
+{
+	const size_t last_fields_size = record_get_last_fields_size(bundle);
+
+	if (last_fields_size == 0)
+		return 0;
+
+	return 1 // administrative record array header
+		+ bundle7_cbor_uint_sizeof(BUNDLE_AR_STATUS_REPORT)
+		+ 1 // bundle status report array header
+		+ 1 // status info array header
+		+ status_info_get_size(bundle, report,
+				       BUNDLE_SR_FLAG_BUNDLE_RECEIVED)
+		+ status_info_get_size(bundle, report,
+				       BUNDLE_SR_FLAG_BUNDLE_FORWARDED)
+		+ status_info_get_size(bundle, report,
+				       BUNDLE_SR_FLAG_BUNDLE_DELIVERED)
+		+ status_info_get_size(bundle, report,
+				       BUNDLE_SR_FLAG_BUNDLE_DELETED)
+		+ bundle7_cbor_uint_sizeof(report->reason)
+		+ last_fields_size;
+}
+
+
 /**
  * Serializes the 5 bundle status information fields in the Bundle Status
  * Report.
@@ -102,35 +189,18 @@ static void serialize_status_info(
 	CborEncoder *encoder,
 	enum bundle_status_report_status_flags flag)
 {
-	uint64_t time;
 	CborEncoder recursed;
 
 	// Set assertion "true"
 	if (HAS_FLAG(report->status, flag)) {
 		// Times are reported
-		if (HAS_FLAG(bundle->proc_flags, BUNDLE_FLAG_REPORT_STATUS_TIME)) {
+		if (status_info_has_time(bundle, report, flag)) {
 			cbor_encoder_create_array(encoder, &recursed, 2);
 			cbor_encode_boolean(&recursed, true);
-
-			// Find corresponding time
-			switch (flag) {
-			case BUNDLE_SR_FLAG_BUNDLE_RECEIVED:
-				time = report->bundle_received_time;
-				break;
-			case BUNDLE_SR_FLAG_BUNDLE_FORWARDED:
-				time = report->bundle_forwarded_time;
-				break;
-			case BUNDLE_SR_FLAG_BUNDLE_DELIVERED:
-				time = report->bundle_delivered_time;
-				break;
-			case BUNDLE_SR_FLAG_BUNDLE_DELETED:
-				time = report->bundle_deleted_time;
-				break;
-			default:
-				time = 0;
-				break;
-			}
-			cbor_encode_uint(&recursed, time);
+			cbor_encode_uint(
+				&recursed,
+				status_info_time(report, flag)
+			);
 		// Times are not reported
 		} else {
 			cbor_encoder_create_array(encoder, &recursed, 1);
@@ -145,33 +215,71 @@ static void serialize_status_info(
 }
 
 
+enum ud3tn_result bundle7_report_template_init(
+	struct bundle7_report_template *template,
+	const char *source)
+{
+	// The lifetime of every report is set from the bundle it refers to.
+	template->profile = bundle7_profile_create(
+		source,
+		"dtn:none",
+		0,
+		DEFAULT_BPV7_CRC_TYPE,
+		BUNDLE7_PROFILE_BLOCKS_NONE,
+		0
+	);
+
+	return template->profile != NULL ? UD3TN_OK : UD3TN_FAIL;
+}
+
+
+void bundle7_report_template_deinit(struct bundle7_report_template *template)
+{
+	bundle7_profile_unref(template->profile);
+	template->profile = NULL;
+}
+
+
 struct bundle *bundle7_generate_status_report(
 	const struct bundle *const bundle,
-	const struct bundle_status_report *prototype,
+	const struct bundle_status_report *report,
 	const char *source,
 	const uint64_t timestamp_ms)
+{
+	struct bundle7_report_template template;
+
+	if (bundle7_report_template_init(&template, source) != UD3TN_OK)
+		return NULL;
+
+	struct bundle *result = bundle7_generate_status_report_templated(
+		&template, bundle, report, timestamp_ms
+	);
+
+	bundle7_report_template_deinit(&template);
+	return result;
+}
+
+
+struct bundle *bundle7_generate_status_report_templated(
+	const struct bundle7_report_template *template,
+	const struct bundle *const bundle,
+	const struct bundle_status_report *prototype,
+	const uint64_t timestamp_ms)
 {
 	uint8_t *payload;
 	CborEncoder container, record, report, status_info;
 	CborError err;
 
-	// 5 bytes for:
-	//
-	// - administrative record array header
-	// - administrative record type number
-	// - bundle status report array header
-	// - status info array header
-	// - reason code
-	//
-	// Status info = 44 bytes
-	//
-	// - 4x 1 byte array header
-	// - 4x 1 byte bool value
-	// - 4x 9 bytes uint64_t times
-	//
-	// + size of last fields
-	//
-	const size_t payload_size = 49 + record_get_last_fields_size(bundle);
+	// Lifetime
+	const uint64_t exp_time_ms = bundle_get_expiration_time_ms(bundle);
+
+	if (exp_time_ms <= timestamp_ms)
+		return NULL;
+
+	const size_t payload_size = status_report_get_size(bundle, prototype);
+
+	if (payload_size == 0)
+		return NULL;
 
 	payload = malloc(payload_size);
 	if (payload == NULL)
@@ -218,36 +326,25 @@ struct bundle *bundle7_generate_status_report(
 	cbor_encoder_close_container(&record, &report);
 	cbor_encoder_close_container(&container, &record);
 
-	// Compress payload memory
-	size_t written = cbor_encoder_get_buffer_size(&container, payload);
-
-	if (written == 0) {
+	// The buffer has been sized exactly, anything else is a bug.
+	if (cbor_encoder_get_extra_bytes_needed(&container) != 0 ||
+	    cbor_encoder_get_buffer_size(&container, payload) !=
+			payload_size) {
 		free(payload);
 		return NULL;
 	}
 
-	uint8_t *compress = realloc(payload, written);
-
-	if (compress == NULL) {
-		// False positive in some versions of cppcheck. It is correct
-		// to free here as `realloc` failed and does not free.
-		// cppcheck-suppress doubleFree
-		free(payload);
-		return NULL;
-	}
-
-	// Lifetime
-	const uint64_t exp_time_ms = bundle_get_expiration_time_ms(bundle);
-
-	if (exp_time_ms <= timestamp_ms) {
-		free(compress);
-		return NULL;
-	}
-
-	return bundle7_create_local(
-		compress, written, source, bundle->report_to,
+	// The report-to EID of the bundle is interned already, as are the
+	// EIDs of the template, so the report only takes new references. The
+	// primary block is completed from the one prepared in the template.
+	return bundle7_profile_create_bundle_interned(
+		template->profile,
+		payload, payload_size,
+		bundle->report_to,
 		timestamp_ms, 1,
-		exp_time_ms - timestamp_ms, BUNDLE_FLAG_ADMINISTRATIVE_RECORD);
+		exp_time_ms - timestamp_ms,
+		BUNDLE_FLAG_ADMINISTRATIVE_RECORD
+	);
 }
 
 
@@ -1,5 +1,6 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
 #include "bundle7/eid.h"
+#include "bundle7/profile.h"
 #include "bundle7/serializer.h"
 
 #include "cbor.h"
@@ -79,6 +80,20 @@ static CborError write_crc(
 }
 
 
+static CborError write_received_crc(
+	struct CborEncoder *encoder, const struct bundle_block *block)
+{
+	union crc field;
+
+	if (block->crc_type == BUNDLE_CRC_TYPE_32) {
+		field.checksum = cbor_htonl(block->crc.checksum);
+		return cbor_encode_byte_string(encoder, field.bytes, 4);
+	}
+	field.checksum = cbor_htons(block->crc.checksum);
+	return cbor_encode_byte_string(encoder, field.bytes, 2);
+}
+
+
 /*
  * Number of bytes required for CBOR-encoded max. value:
  *
@@ -121,47 +136,48 @@ static uint32_t bundle7_filter_protocol_proc_flags(const struct bundle *bundle)
 	return flags;
 }
 
-enum ud3tn_result bundle7_serialize(
-	struct bundle *bundle,
+// Appends the written data to a fixed-size memory buffer.
+struct memory_sink {
+	uint8_t *data;
+	size_t length;
+	size_t capacity;
+};
+
+static void write_to_memory(void *obj, const void *data, const size_t length)
+{
+	struct memory_sink *const sink = obj;
+
+	if (sink->length + length <= sink->capacity)
+		memcpy(sink->data + sink->length, data, length);
+	// Track the required length also if the buffer is too small.
+	sink->length += length;
+}
+
+static enum ud3tn_result serialize_primary_block(
+	struct bundle *bundle, uint8_t *buffer,
 	void (*write)(void *cla_obj, const void *, const size_t),
 	void *cla_obj)
 {
-	// Assert that the bundle has correct version
-	if (bundle->protocol_version != 7)
-		return UD3TN_FAIL;
-
-	uint8_t *buffer;
 	CborEncoder encoder;
 	struct crc_stream crc;
 	int written;
 
-	buffer = malloc(BUFFER_SIZE);
-	if (buffer == NULL)
-		return UD3TN_FAIL;
-
-	// Bundle start (CBOR indefinite array)
-	buffer[0] = 0x9f;
-
-	// -------------
-	// Primary Block
-	// -------------
-
-	buffer[1] = 0x80 + primary_block_get_item_count(bundle);
+	buffer[0] = 0x80 + primary_block_get_item_count(bundle);
 
 	init_crc(&crc, bundle->crc_type);
 
-	cbor_encoder_init(&encoder, buffer + 2, BUFFER_SIZE - 2, 0);
+	cbor_encoder_init(&encoder, buffer + 1, BUFFER_SIZE - 1, 0);
 	cbor_encode_uint(&encoder, bundle->protocol_version);
 	cbor_encode_uint(&encoder,
 		bundle7_filter_protocol_proc_flags(bundle));
 	cbor_encode_uint(&encoder, bundle->crc_type);
 
 	write(cla_obj, buffer, cbor_encoder_get_buffer_size(&encoder, buffer));
-	feed_crc(&crc, bundle->crc_type, buffer + 1,
-		cbor_encoder_get_buffer_size(&encoder, buffer + 1));
+	feed_crc(&crc, bundle->crc_type, buffer,
+		cbor_encoder_get_buffer_size(&encoder, buffer));
 
 	// Destination EID
-	written = bundle7_eid_serialize(bundle->destination,
+	written = bundle7_interned_eid_serialize(bundle->destination,
 		buffer, BUFFER_SIZE);
 	if (written <= 0)
 		return UD3TN_FAIL;
@@ -169,7 +185,7 @@ enum ud3tn_result bundle7_serialize(
 	feed_crc(&crc, bundle->crc_type, buffer, written);
 
 	// Source EID
-	written = bundle7_eid_serialize(bundle->source,
+	written = bundle7_interned_eid_serialize(bundle->source,
 		buffer, BUFFER_SIZE);
 	if (written <= 0)
 		return UD3TN_FAIL;
@@ -177,7 +193,7 @@ enum ud3tn_result bundle7_serialize(
 	feed_crc(&crc, bundle->crc_type, buffer, written);
 
 	// Report-To EID
-	written = bundle7_eid_serialize(bundle->report_to,
+	written = bundle7_interned_eid_serialize(bundle->report_to,
 		buffer, BUFFER_SIZE);
 	if (written <= 0)
 		return UD3TN_FAIL;
@@ -207,6 +223,86 @@ enum ud3tn_result bundle7_serialize(
 
 	write(cla_obj, buffer, cbor_encoder_get_buffer_size(&encoder, buffer));
 
+	return UD3TN_OK;
+}
+
+// Encode the primary block into bundle->encoded_primary_block, which is kept
+// until the primary block is modified, see bundle_recalculate_header_length().
+static void encode_primary_block(struct bundle *bundle, uint8_t *buffer)
+{
+	struct memory_sink sink = {
+		.data = malloc(bundle->primary_block_length),
+		.length = 0,
+		.capacity = bundle->primary_block_length,
+	};
+
+	if (sink.data == NULL)
+		return;
+
+	// Only cache the result if it matches the calculated length, as the
+	// serialized size of the bundle is derived from it.
+	if (serialize_primary_block(bundle, buffer, write_to_memory,
+				    &sink) != UD3TN_OK ||
+	    sink.length != sink.capacity) {
+		free(sink.data);
+		return;
+	}
+
+	bundle->encoded_primary_block = sink.data;
+}
+
+enum ud3tn_result bundle7_serialize(
+	struct bundle *bundle,
+	void (*write)(void *cla_obj, const void *, const size_t),
+	void *cla_obj)
+{
+	return bundle7_serialize_ref(bundle, write, write, cla_obj);
+}
+
+enum ud3tn_result bundle7_serialize_ref(
+	struct bundle *bundle,
+	void (*write)(void *cla_obj, const void *, const size_t),
+	void (*write_ref)(void *cla_obj, const void *, const size_t),
+	void *cla_obj)
+{
+	// Assert that the bundle has correct version
+	if (bundle->protocol_version != 7)
+		return UD3TN_FAIL;
+
+	// Only the block lengths have to be encoded for bundles that still have
+	// the shape of the profile they have been created from.
+	if (bundle7_profile_matches(bundle))
+		return bundle7_profile_serialize(bundle, write, write_ref,
+						 cla_obj);
+
+	uint8_t *buffer;
+	CborEncoder encoder;
+	struct crc_stream crc;
+
+	buffer = malloc(BUFFER_SIZE);
+	if (buffer == NULL)
+		return UD3TN_FAIL;
+
+	// Bundle start (CBOR indefinite array)
+	buffer[0] = 0x9f;
+	write(cla_obj, buffer, 1);
+
+	// -------------
+	// Primary Block
+	// -------------
+
+	if (bundle->encoded_primary_block == NULL)
+		encode_primary_block(bundle, buffer);
+
+	if (bundle->encoded_primary_block != NULL) {
+		write_ref(cla_obj, bundle->encoded_primary_block,
+			  bundle->primary_block_length);
+	} else if (serialize_primary_block(bundle, buffer,
+					   write, cla_obj) != UD3TN_OK) {
+		free(buffer);
+		return UD3TN_FAIL;
+	}
+
 	// ----------------
 	// Extension Blocks
 	// ----------------
@@ -215,8 +311,15 @@ enum ud3tn_result bundle7_serialize(
 
 	while (cur_block != NULL) {
 		const struct bundle_block *block = cur_block->data;
+		// A received CRC that has not been verified (see
+		// bundle7_verify_crc()) is passed on unchanged instead of
+		// being recalculated, so that the next hop detects if the
+		// block has been corrupted.
+		const enum bundle_crc_type crc_type = (
+			block->crc_pending ? BUNDLE_CRC_TYPE_NONE : block->crc_type
+		);
 
-		init_crc(&crc, block->crc_type);
+		init_crc(&crc, crc_type);
 
 		// CBOR array header with embedded number of items
 		buffer[0] = 0x80 + block_get_item_count(block);
@@ -241,14 +344,18 @@ enum ud3tn_result bundle7_serialize(
 
 		write(cla_obj, buffer, cbor_encoder_get_buffer_size(&encoder,
 								    buffer));
-		feed_crc(&crc, block->crc_type, buffer,
+		feed_crc(&crc, crc_type, buffer,
 			 cbor_encoder_get_buffer_size(&encoder, buffer));
 
-		write(cla_obj, block->data, block->length);
-		feed_crc(&crc, block->crc_type,
-			 block->data, block->length);
+		write_ref(cla_obj, block->data, block->length);
+		feed_crc(&crc, crc_type, block->data, block->length);
 
-		if (block->crc_type != BUNDLE_CRC_TYPE_NONE) {
+		if (block->crc_pending) {
+			cbor_encoder_init(&encoder, buffer, BUFFER_SIZE, 0);
+			write_received_crc(&encoder, block);
+			write(cla_obj, buffer,
+			      cbor_encoder_get_buffer_size(&encoder, buffer));
+		} else if (block->crc_type != BUNDLE_CRC_TYPE_NONE) {
 			// Reset CBOR encoder
 			cbor_encoder_init(&encoder, buffer, BUFFER_SIZE, 0);
 
@@ -6,6 +6,7 @@
 
 #include "platform/hal_io.h"
 
+#include "bundle7/bundle7.h"
 #include "bundle7/create.h"
 #include "bundle7/reports.h"
 
@@ -16,7 +17,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
-
+#include <string.h>
 
 size_t bibe_parser_parse(const uint8_t *const buffer,
 			 const size_t length,
@@ -79,112 +80,97 @@ size_t bibe_parser_parse(const uint8_t *const buffer,
 	size_t bundle_str_len;
 	enum CborError retval;
 
+	// Only a string of known length is contiguous in the buffer, i.e. can
+	// be referenced in place instead of being copied.
+	if (!cbor_value_is_length_known(&report))
+		return CborErrorUnknownLength;
 	retval = cbor_value_get_string_length(&report, &bundle_str_len);
 	if (retval)
 		return retval;
-	// Allocate memory for the encapsulated bundle
-	bpdu->encapsulated_bundle = malloc(bundle_str_len);
-	if (bpdu->encapsulated_bundle == NULL)
-		return CborErrorInternalError;
-	bpdu->payload_length = bundle_str_len;
-	// From the cbor docs:
-	//   "The next pointer, if not null, will be updated to point to the next item after
-	//    this string. If value points to the last item, then next will be invalid."
-	// Since we don't have a next element, we need to pass a null pointer to the function here.
-	retval = cbor_value_copy_byte_string(
-		&report,
-		bpdu->encapsulated_bundle,
-		&bundle_str_len,
-		NULL
+	if (cbor_value_advance(&report))
+		return CborErrorUnexpectedEOF;
+	// The string ends where the next item would begin. Discard const, the
+	// BPDU only refers to the bundle, which is not modified.
+	bpdu->encapsulated_bundle = (uint8_t *)(
+		cbor_value_get_next_byte(&report) - bundle_str_len
 	);
-	if (retval)
-		goto fail;
-	if (cbor_value_advance(&report)) {
-		retval = CborErrorUnexpectedEOF;
-		goto fail;
-	}
+	bpdu->payload_length = bundle_str_len;
 
 	// Leave BPDU container
 	if (!cbor_value_at_end(&report) ||
-	    cbor_value_leave_container(&it, &report)) {
-		retval = CborErrorInternalError;
-		goto fail;
-	}
+	    cbor_value_leave_container(&it, &report))
+		return CborErrorInternalError;
 
 	return 0;
-
-fail:
-	free(bpdu->encapsulated_bundle);
-	return retval;
 }
 
-static void write_to_buffer(
-	uint8_t *buffer, const void *data, size_t position, const size_t length)
+// The BPDU header precedes the encapsulated bundle: an array of three items,
+// the transmission ID and retransmission time (both zero) and the head of the
+// byte string containing the bundle.
+static size_t bpdu_header_length(const size_t payload_len)
 {
-	memcpy(&buffer[position], data, length);
+	return 3 + bundle7_cbor_uint_sizeof(payload_len);
 }
 
-struct bibe_header bibe_encode_header(const char *const dest_eid,
-				      const size_t payload_len)
+static struct aap_message sendbibe_message(const char *const dest_eid,
+					   const size_t payload_len)
 {
-	struct bibe_header hdr;
-	const size_t eid_len = strlen(dest_eid);
-	// len == 8 bytes + 1 byte header
-	const size_t CBOR_MAX_UINT_LENGTH = 9;
+	return (struct aap_message){
+		.type = AAP_MESSAGE_SENDBIBE,
+		.eid_length = strlen(dest_eid),
+		// Discard const, the used AAP functions do not modify the EID.
+		.eid = (char *)dest_eid,
+		.payload_length = payload_len + bpdu_header_length(payload_len),
+		.payload = NULL,
+	};
+}
 
-	/* Encoding length of the bundle byte string */
-	uint8_t *temp_buffer = malloc(CBOR_MAX_UINT_LENGTH);
-	CborEncoder encoder;
+size_t bibe_get_header_length(const char *const dest_eid,
+			      const size_t payload_len)
+{
+	const struct aap_message msg = sendbibe_message(dest_eid, payload_len);
 
-	cbor_encoder_init(&encoder, temp_buffer, CBOR_MAX_UINT_LENGTH, 0);
-	cbor_encode_uint(&encoder, (uint64_t)payload_len);
-	const size_t bpdu_size = cbor_encoder_get_buffer_size(
-		&encoder,
-		temp_buffer
-	) + 3; // buffer size + 3 for the BPDU data
-	temp_buffer[0] |= 0x40; // see bundle7 serializer.c lines 235-239
+	// NOTE: The BPDU header is still included here
+	return aap_get_serialized_size(&msg) - payload_len;
+}
 
-	/* Encoding the BPDU */
-	uint8_t *bibe_bytes = malloc(bpdu_size);
+size_t bibe_encode_header_into(uint8_t *const buffer,
+			       const char *const dest_eid,
+			       const size_t payload_len)
+{
+	const struct aap_message msg = sendbibe_message(dest_eid, payload_len);
+	const size_t bpdu_size = bpdu_header_length(payload_len);
+	const size_t hdr_len = aap_get_serialized_size(&msg) - payload_len;
+	uint8_t *const bpdu = &buffer[hdr_len - bpdu_size];
+	CborEncoder encoder;
 
-	bibe_bytes[0] = 0x83; // 83 (100|00011) -> Array of length 3
-	bibe_bytes[1] = 0x00; // 00             -> Integer 0 (transm. ID)
-	bibe_bytes[2] = 0x00; // 00             -> Integer 0 (retr. time)
-	// bibe_bytes[3 to x] contains the length of the bundle byte string
-	// the encapsulated bundle itself will be sent via cla_bibe.c's send_packet_data
+	aap_serialize_into(buffer, &msg, false);
 
-	for (size_t i = 3; i < bpdu_size; i++)
-		bibe_bytes[i] = temp_buffer[i - 3];
+	/* Appending the BPDU header to the AAP message */
+	bpdu[0] = 0x83; // 83 (100|00011) -> Array of length 3
+	bpdu[1] = 0x00; // 00             -> Integer 0 (transm. ID)
+	bpdu[2] = 0x00; // 00             -> Integer 0 (retr. time)
+	// bpdu[3 to x] contains the length of the bundle byte string
+	// the encapsulated bundle itself will be sent by the caller
+	cbor_encoder_init(&encoder, &bpdu[3], bpdu_size - 3, 0);
+	cbor_encode_uint(&encoder, (uint64_t)payload_len);
+	bpdu[3] |= 0x40; // major type 2 -> byte string
 
-	free(temp_buffer);
+	return hdr_len;
+}
 
-	/* Building and encoding the AAP message */
-	struct aap_message msg = {
-		.type = AAP_MESSAGE_SENDBIBE,
-		.eid_length = eid_len,
-		// Discard const, the used AAP functions do not modify the EID.
-		.eid = (char *)dest_eid,
-		.payload_length = payload_len + bpdu_size,
-		.payload = NULL,
-	};
+struct bibe_header bibe_encode_header(const char *const dest_eid,
+				      const size_t payload_len)
+{
+	struct bibe_header hdr;
 
-	// NOTE: bpdu_size is still included here
-	hdr.hdr_len = aap_get_serialized_size(&msg) - payload_len;
+	hdr.hdr_len = bibe_get_header_length(dest_eid, payload_len);
 	hdr.data = malloc(hdr.hdr_len);
 
 	ASSERT(hdr.data);
 	ASSERT(hdr.hdr_len != 0);
 
-	aap_serialize_into(hdr.data, &msg, false);
-	/* Appending the BPDU to the AAP message */
-	write_to_buffer(
-		hdr.data,
-		bibe_bytes,
-		hdr.hdr_len - bpdu_size,
-		bpdu_size
-	);
-
-	free(bibe_bytes);
+	bibe_encode_header_into(hdr.data, dest_eid, payload_len);
 
 	return hdr;
 }
@@ -46,9 +46,6 @@ const struct available_cla_list_entry AVAILABLE_CLAS[] = {
 	#endif
 };
 
-
-static void cla_register(struct cla_config *config);
-
 static enum ud3tn_result initialize_single(
 	char *cur_cla_config,
 	const struct bundle_agent_interface *bundle_agent_interface)
@@ -165,6 +162,7 @@ enum ud3tn_result cla_link_init(struct cla_link *link,
 
 	link->tx_queue_handle = NULL;
 	link->tx_queue_sem = NULL;
+	bundle_iov_init(&link->tx_iov);
 
 	// Semaphores used for waiting for the tasks to exit
 	// NOTE: They are already locked on creation!
@@ -297,6 +295,7 @@ void cla_link_cleanup(struct cla_link *link)
 	link->config->vtable->cla_rx_task_reset_parsers(link);
 	rx_task_data_deinit(&link->rx_task_data);
 
+	bundle_iov_free(&link->tx_iov);
 	free(link->cla_addr);
 }
 
@@ -367,7 +366,7 @@ char *cla_get_cla_addr_from_link(const struct cla_link *const link)
 
 static struct cla_config *global_instances[ARRAY_SIZE(AVAILABLE_CLAS)];
 
-static void cla_register(struct cla_config *config)
+void cla_register(struct cla_config *config)
 {
 	const char *name = config->vtable->cla_name_get();
 
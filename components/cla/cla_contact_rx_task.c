@@ -13,11 +13,13 @@
 
 #include "ud3tn/bundle_processor.h"
 #include "ud3tn/common.h"
-#include "ud3tn/eid.h"
+#include "ud3tn/eid_intern.h"
+#include "ud3tn/memory_budget.h"
 
 #include <signal.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <string.h>
 
 #if defined(CLA_RX_READ_TIMEOUT) && CLA_RX_READ_TIMEOUT != 0
 static const unsigned long CLA_RX_READ_TIMEOUT_MS = CLA_RX_READ_TIMEOUT;
@@ -35,7 +37,9 @@ static void bundle_send(struct bundle *bundle, void *param)
 		return;
 	}
 
-	char *const source_node_id = get_node_id(bundle->source);
+	const char *const source_node_id = eid_intern_get_node_id(
+		bundle->source
+	);
 
 	if (source_node_id) {
 		const int cmp_result = strncmp(
@@ -44,8 +48,6 @@ static void bundle_send(struct bundle *bundle, void *param)
 			strlen(config->bundle_agent_interface->local_eid)
 		);
 
-		free(source_node_id);
-
 		if (cmp_result == 0) {
 			LOGF_WARN("CLA: Dropping bundle from \"%s\" (EID spoofing detected)",
 			bundle->source);
@@ -76,7 +78,6 @@ enum ud3tn_result rx_task_data_init(struct rx_task_data *rx_data,
 {
 	rx_data->payload_type = PAYLOAD_UNKNOWN;
 	rx_data->timeout_occured = false;
-	rx_data->input_buffer.end = &rx_data->input_buffer.start[0];
 
 	if (!bundle6_parser_init(&rx_data->bundle6_parser,
 				 &bundle_send, cla_config))
@@ -88,6 +89,12 @@ enum ud3tn_result rx_task_data_init(struct rx_task_data *rx_data,
 	if (!blackhole_parser_init(&rx_data->blackhole_parser))
 		return UD3TN_FAIL;
 
+	rx_data->input_buffer.start = malloc(CLA_RX_BUFFER_SIZE);
+	if (!rx_data->input_buffer.start)
+		return UD3TN_FAIL;
+	rx_data->input_buffer.read = rx_data->input_buffer.start;
+	rx_data->input_buffer.end = rx_data->input_buffer.start;
+
 	return UD3TN_OK;
 }
 
@@ -107,6 +114,11 @@ void rx_task_data_deinit(struct rx_task_data *rx_data)
 	ASSERT(bundle6_parser_deinit(&rx_data->bundle6_parser) == UD3TN_OK);
 	ASSERT(bundle7_parser_deinit(&rx_data->bundle7_parser) == UD3TN_OK);
 	ASSERT(blackhole_parser_deinit(&rx_data->blackhole_parser) == UD3TN_OK);
+
+	free(rx_data->input_buffer.start);
+	rx_data->input_buffer.start = NULL;
+	rx_data->input_buffer.read = NULL;
+	rx_data->input_buffer.end = NULL;
 }
 
 size_t select_bundle_parser_version(struct rx_task_data *rx_data,
@@ -139,31 +151,116 @@ size_t select_bundle_parser_version(struct rx_task_data *rx_data,
 }
 
 
+static inline size_t input_buffer_available(const struct rx_task_data *rx_data)
+{
+	return rx_data->input_buffer.end - rx_data->input_buffer.read;
+}
+
+static inline void input_buffer_clear(struct rx_task_data *rx_data)
+{
+	rx_data->input_buffer.read = rx_data->input_buffer.start;
+	rx_data->input_buffer.end = rx_data->input_buffer.start;
+}
+
+/**
+ * Receive as much data as the link provides and fits into the free space at
+ * the end of the input buffer. If less than half of the buffer is free, the
+ * unconsumed bytes are moved to its start first, which is cheap as this is
+ * usually no more than the beginning of a single bundle.
+ */
+static enum ud3tn_result input_buffer_fill(struct cla_link *link)
+{
+	struct rx_task_data *const rx_data = &link->rx_task_data;
+	uint8_t *const buffer_end = (
+		rx_data->input_buffer.start + CLA_RX_BUFFER_SIZE
+	);
+	const size_t available = input_buffer_available(rx_data);
+	size_t read = 0;
+
+	if (available == 0) {
+		input_buffer_clear(rx_data);
+	} else if ((size_t)(buffer_end - rx_data->input_buffer.end) <
+			CLA_RX_BUFFER_SIZE / 2 &&
+		   rx_data->input_buffer.read != rx_data->input_buffer.start) {
+		memmove(rx_data->input_buffer.start,
+			rx_data->input_buffer.read,
+			available);
+		rx_data->input_buffer.read = rx_data->input_buffer.start;
+		rx_data->input_buffer.end = (
+			rx_data->input_buffer.start + available
+		);
+	}
+
+	ASSERT(rx_data->input_buffer.end < buffer_end);
+
+	const enum ud3tn_result result = link->config->vtable->cla_read(
+		link,
+		rx_data->input_buffer.end,
+		buffer_end - rx_data->input_buffer.end,
+		&read
+	);
+
+	if (result != UD3TN_OK)
+		return result;
+
+	ASSERT(rx_data->input_buffer.end + read <= buffer_end);
+	rx_data->input_buffer.end += read;
+
+	return UD3TN_OK;
+}
+
+/**
+ * Determine the time since bytes have last been received via the link and
+ * update the timestamp of the last reception.
+ */
+static uint64_t update_rx_time(struct cla_link *link)
+{
+	const uint64_t cur_time = hal_time_get_timestamp_ms();
+	const uint64_t time_since_last_rx = cur_time - link->last_rx_time_ms;
+
+	link->last_rx_time_ms = cur_time;
+	return time_since_last_rx;
+}
+
 /**
- * Read contents currently within the receive buffer.
+ * Pass the unconsumed contents of the receive buffer to the parsers until
+ * they request more data than is available or a bulk read.
+ *
+ * @return Number of bytes consumed from the input buffer.
  */
-static uint8_t *buffer_read(struct cla_link *link, uint8_t *stream)
+static size_t buffer_read(struct cla_link *link)
 {
 	struct rx_task_data *const rx_data = &link->rx_task_data;
+	size_t consumed = 0;
 
-	while (stream < rx_data->input_buffer.end) {
+	while (rx_data->input_buffer.read < rx_data->input_buffer.end) {
 		size_t parsed = link->config->vtable
 			->cla_rx_task_forward_to_specific_parser(
 				link,
-				stream,
-				rx_data->input_buffer.end - stream
+				rx_data->input_buffer.read,
+				input_buffer_available(rx_data)
 			);
 
-		/* Advance stream pointer. */
-		stream += parsed;
+		ASSERT(parsed <= input_buffer_available(rx_data));
+		rx_data->input_buffer.read += parsed;
+		consumed += parsed;
 
 		if (rx_data->cur_parser->status != PARSER_STATUS_GOOD) {
-			if (rx_data->cur_parser->status == PARSER_STATUS_ERROR)
+			const bool done = (
+				rx_data->cur_parser->status ==
+				PARSER_STATUS_DONE
+			);
+
+			if (!done)
 				LOG_WARN("RX: Parser failed, reset.");
 			link->config->vtable->cla_rx_task_reset_parsers(
 				link
 			);
-			break;
+			// Continue with the next bundle in the buffer, if
+			// the parsers are ready for it.
+			if (!done ||
+			    rx_data->cur_parser->status != PARSER_STATUS_GOOD)
+				break;
 		} else if (HAS_FLAG(rx_data->cur_parser->flags,
 				    PARSER_FLAG_BULK_READ)) {
 			/* Bulk read requested - not handled by us. */
@@ -179,7 +276,7 @@ static uint8_t *buffer_read(struct cla_link *link, uint8_t *stream)
 		}
 	}
 
-	return stream;
+	return consumed;
 }
 
 /**
@@ -190,21 +287,52 @@ static uint8_t *buffer_read(struct cla_link *link, uint8_t *stream)
  * buffer (NULL pointer) and the bulk read flag cleared to trigger further
  * processing.
  *
- * Bytes in the current input buffer are considered and copied appropriately --
- * meaning that non-parsed input bytes are copied into the bulk read buffer and
- * the remaining bytes are read directly from the input stream.
- * @return Pointer to the position up to the input buffer is consumed after the
- *         operation.
+ * Bytes in the current input buffer are considered and copied appropriately.
+ * Requests of up to half of the input buffer, e.g. the payload of a small
+ * bundle, are served from the input buffer, i.e. the data following them is
+ * received with the same call into the CLA. Larger requests are read directly
+ * into the bulk read buffer.
+ *
+ * @return Number of bytes consumed from the input buffer.
  */
-uint8_t *rx_bulk_read(struct cla_link *link)
+size_t rx_bulk_read(struct cla_link *link)
 {
 	struct rx_task_data *const rx_data = &link->rx_task_data;
-	uint8_t *parsed;
+	const size_t next_bytes = rx_data->cur_parser->next_bytes;
+	// NOTE: Not derived from the read position, which is moved when the
+	// input buffer is compacted or cleared.
+	size_t consumed;
+
+	ASSERT(rx_data->input_buffer.end >= rx_data->input_buffer.read);
+
+	while (input_buffer_available(rx_data) < next_bytes &&
+	       next_bytes <= CLA_RX_BUFFER_SIZE / 2) {
+		// NOTE: This may move the unconsumed bytes.
+		if (input_buffer_fill(link) != UD3TN_OK) {
+			link->config->vtable->cla_rx_task_reset_parsers(
+				link
+			);
+			input_buffer_clear(rx_data);
+			return 0;
+		}
 
-	ASSERT(rx_data->input_buffer.end >= rx_data->input_buffer.start);
+		const uint64_t time_since_last_rx = update_rx_time(link);
+
+		if (CLA_RX_READ_TIMEOUT_MS &&
+		    time_since_last_rx > CLA_RX_READ_TIMEOUT_MS) {
+			LOGF_WARN(
+				"RX: Timeout after %llu ms in bulk read mode, reset.",
+				time_since_last_rx
+			);
+			link->config->vtable->cla_rx_task_reset_parsers(link);
+			input_buffer_clear(rx_data);
+			return 0;
+		}
+	}
 
 	/*
-	 * Bulk read operation requested that is smaller than the input buffer.
+	 * Bulk read operation requested that is smaller than the unconsumed
+	 * part of the input buffer.
 	 *
 	 * -------------------------------------
 	 * |   |   |   |   |   |   |   |   |   | input buffer
@@ -213,25 +341,18 @@ uint8_t *rx_bulk_read(struct cla_link *link)
 	 * |_______________________|___________|
 	 *
 	 *   bulk read operation     remaining
-	 *
-	 *
 	 */
-	if (rx_data->cur_parser->next_bytes <=
-			(size_t)(rx_data->input_buffer.end -
-				 rx_data->input_buffer.start)) {
+	if (next_bytes <= input_buffer_available(rx_data)) {
 		/* Fill bulk read buffer from input buffer. */
 		memcpy(
 			rx_data->cur_parser->next_buffer,
-			rx_data->input_buffer.start,
-			rx_data->cur_parser->next_bytes
-		);
-		parsed = (
-			rx_data->input_buffer.start +
-			rx_data->cur_parser->next_bytes
+			rx_data->input_buffer.read,
+			next_bytes
 		);
+		rx_data->input_buffer.read += next_bytes;
+		consumed = next_bytes;
 
 	/*
-	 *
 	 * -----------------------------
 	 * |   |   |   |   |   |   |   |  input buffer
 	 * -----------------------------
@@ -249,18 +370,19 @@ uint8_t *rx_bulk_read(struct cla_link *link)
 	 *                    pointer for HAL read operation
 	 */
 	} else {
-		size_t filled = rx_data->input_buffer.end -
-				rx_data->input_buffer.start;
+		const size_t filled = input_buffer_available(rx_data);
 
 		/* Copy the whole input buffer to bulk read buffer. */
 		if (filled)
 			memcpy(
 				rx_data->cur_parser->next_buffer,
-				rx_data->input_buffer.start,
+				rx_data->input_buffer.read,
 				filled
 			);
+		input_buffer_clear(rx_data);
+		consumed = filled;
 
-		size_t to_read = rx_data->cur_parser->next_bytes - filled;
+		size_t to_read = next_bytes - filled;
 		uint8_t *pos = rx_data->cur_parser->next_buffer + filled;
 		size_t read;
 
@@ -279,42 +401,31 @@ uint8_t *rx_bulk_read(struct cla_link *link)
 				link->config->vtable->cla_rx_task_reset_parsers(
 					link
 				);
-				return rx_data->input_buffer.end;
+				return filled;
 			}
 
-			const uint64_t cur_time = hal_time_get_timestamp_ms();
+			// Timeout check - if we waited for too long since the
+			// last bytes parsed, reset.
+			const uint64_t time_since_last_rx = update_rx_time(
+				link
+			);
 
-			if (CLA_RX_READ_TIMEOUT_MS) {
-				// Timeout check - if we waited for too long
-				// since the last bytes parsed, reset.
-				const uint64_t time_since_last_rx = (
-					cur_time - link->last_rx_time_ms
+			if (CLA_RX_READ_TIMEOUT_MS &&
+			    time_since_last_rx > CLA_RX_READ_TIMEOUT_MS) {
+				LOGF_WARN(
+					"RX: Timeout after %llu ms in bulk read mode, reset.",
+					time_since_last_rx
 				);
-
-				if (time_since_last_rx >
-						CLA_RX_READ_TIMEOUT_MS) {
-					LOGF_WARN(
-						"RX: Timeout after %llu ms in bulk read mode, reset.",
-						time_since_last_rx
-					);
-					link->config->vtable
-						->cla_rx_task_reset_parsers(
-							link
-						);
-					return rx_data->input_buffer.end;
-				}
+				link->config->vtable->cla_rx_task_reset_parsers(
+					link
+				);
+				return filled;
 			}
 
-			link->last_rx_time_ms = cur_time;
-
 			ASSERT(read <= to_read);
 			to_read -= read;
 			pos += read;
 		}
-
-		// We have read everything that was in the buffer (+ more,
-		// but that is not relevant to the caller).
-		parsed = rx_data->input_buffer.end;
 	}
 
 	/* Disable bulk read mode. */
@@ -337,71 +448,64 @@ uint8_t *rx_bulk_read(struct cla_link *link)
 	}
 
 	// Feed parser with the remainder
-	if (parsed < rx_data->input_buffer.end)
-		return buffer_read(link, parsed);
-
-	return parsed;
+	return consumed + buffer_read(link);
 }
 
-
 /**
- * Reads a chunk of bytes into the input buffer and forwards the input buffer
- * to the specific parser.
+ * Receives as much data as available (and fitting) into the input buffer and
+ * forwards the unconsumed part of the input buffer to the specific parser.
  *
- * @return Number of bytes remaining in the input buffer after the operation.
+ * @return Number of bytes consumed from the input buffer.
  */
-uint8_t *rx_chunk_read(struct cla_link *link)
+size_t rx_chunk_read(struct cla_link *link)
 {
 	struct rx_task_data *const rx_data = &link->rx_task_data;
-	// Receive Step - Receive data from I/O system into buffer
-	size_t read = 0;
 
-	ASSERT(rx_data->input_buffer.start + CLA_RX_BUFFER_SIZE >=
-	       rx_data->input_buffer.end);
-
-	enum ud3tn_result result = link->config->vtable->cla_read(
-		link,
-		rx_data->input_buffer.end,
-		(rx_data->input_buffer.start + CLA_RX_BUFFER_SIZE)
-			- rx_data->input_buffer.end,
-		&read
-	);
-
-	ASSERT(rx_data->input_buffer.start + CLA_RX_BUFFER_SIZE >=
-	       rx_data->input_buffer.end + read);
-
-	/* We could not read from input, thus, reset all parsers. */
-	if (result != UD3TN_OK) {
+	/*
+	 * No bytes were parsed but the input buffer is full. We assume
+	 * that there was an attempt to send a too large value not
+	 * fitting into the input buffer.
+	 *
+	 * We discard the current buffer content and reset all parsers.
+	 */
+	if (rx_data->input_buffer.read == rx_data->input_buffer.start &&
+	    rx_data->input_buffer.end ==
+	    rx_data->input_buffer.start + CLA_RX_BUFFER_SIZE) {
+		LOG_WARN("RX: RX buffer is full and does not clear. Resetting all parsers!");
 		link->config->vtable->cla_rx_task_reset_parsers(link);
-		return rx_data->input_buffer.end;
+		input_buffer_clear(rx_data);
 	}
 
-	rx_data->input_buffer.end += read;
-
-	const uint64_t cur_time = hal_time_get_timestamp_ms();
+	// Receive Step - Receive data from I/O system into buffer
+	if (input_buffer_fill(link) != UD3TN_OK) {
+		/* We could not read from input, thus, reset all parsers. */
+		link->config->vtable->cla_rx_task_reset_parsers(link);
+		input_buffer_clear(rx_data);
+		return 0;
+	}
 
 	// Timeout check - if we waited for too long since the last
 	// bytes parsed, reset, and parse this chunk as "something new".
-	if (CLA_RX_READ_TIMEOUT_MS) {
-		const uint64_t time_since_last_rx = (
-			cur_time - link->last_rx_time_ms
-		);
+	const uint64_t time_since_last_rx = update_rx_time(link);
 
-		if (time_since_last_rx > CLA_RX_READ_TIMEOUT_MS) {
-			LOGF_WARN(
-				"RX: New data received after %llu seconds, restarting parsers.",
-				time_since_last_rx
-			);
-			link->config->vtable->cla_rx_task_reset_parsers(link);
-		}
+	if (CLA_RX_READ_TIMEOUT_MS &&
+	    time_since_last_rx > CLA_RX_READ_TIMEOUT_MS) {
+		LOGF_WARN(
+			"RX: New data received after %llu seconds, restarting parsers.",
+			time_since_last_rx
+		);
+		link->config->vtable->cla_rx_task_reset_parsers(link);
 	}
 
-	link->last_rx_time_ms = cur_time;
+	// Parsing Step - pass the buffer contents to the parsers
+	return buffer_read(link);
+}
 
-	// Parsing Step - read back buffer contents and return start pointer
-	uint8_t *stream = rx_data->input_buffer.start;
+static bool rx_task_should_stop(void *param)
+{
+	struct cla_link *const link = param;
 
-	return buffer_read(link, stream);
+	return hal_semaphore_is_blocked(link->rx_task_notification);
 }
 
 static void cla_contact_rx_task(void *const param)
@@ -409,71 +513,22 @@ static void cla_contact_rx_task(void *const param)
 	struct cla_link *link = param;
 	struct rx_task_data *const rx_data = &link->rx_task_data;
 
-	uint8_t *parsed;
-
 	while (!hal_semaphore_is_blocked(link->rx_task_notification)) {
-		if (HAS_FLAG(rx_data->cur_parser->flags, PARSER_FLAG_BULK_READ))
-			parsed = rx_bulk_read(link);
-		else
-			parsed = rx_chunk_read(link);
-
-		/* The whole input buffer was consumed, reset it. */
-		if (parsed == rx_data->input_buffer.end) {
-			rx_data->input_buffer.end = rx_data->input_buffer.start;
-		/*
-		 * Remove parsed bytes from input buffer by shifting
-		 * the parsed buffer bytes to the left.
-		 *
-		 *               remaining = 4
-		 * ---------------------------------------
-		 * | / | / | / | x | x | x | x |   |   |   ...
-		 * ---------------------------------------
-		 *               ^               ^
-		 *               |               |
-		 *               |               |
-		 *             parsed           end
-		 *
-		 * memmove:
-		 *     Copying takes place as if an intermediate buffer
-		 *     were used, allowing the destination and source to
-		 *     overlap.
-		 *
-		 * ---------------------------------------
-		 * | x | x | x | x |   |   |   |   |   |   ...
-		 * ---------------------------------------
-		 *                   ^
-		 *                   |
-		 *                   |
-		 *                  end
-		 */
-		} else if (parsed != rx_data->input_buffer.start) {
-			ASSERT(parsed > rx_data->input_buffer.start);
-
-			memmove(rx_data->input_buffer.start,
-				parsed,
-				rx_data->input_buffer.end - parsed);
-
-			/*
-			 * Move end pointer backwards for that amount of bytes
-			 * that were parsed.
-			 */
-			rx_data->input_buffer.end -=
-				parsed - rx_data->input_buffer.start;
 		/*
-		 * No bytes were parsed but the input buffer is full. We assume
-		 * that there was an attempt to send a too large value not
-		 * fitting into the input buffer.
-		 *
-		 * We discard the current buffer content and reset all parsers.
+		 * Stop reading while the memory budget is exhausted, so that
+		 * the peer is throttled (e.g., by TCP flow control) instead of
+		 * bundles being dropped. The pause does not count as
+		 * inactivity of the link (see CLA_RX_READ_TIMEOUT).
 		 */
-		} else if (rx_data->input_buffer.end ==
-			 rx_data->input_buffer.start + CLA_RX_BUFFER_SIZE) {
-			LOG_WARN("RX: RX buffer is full and does not clear. Resetting all parsers!");
-			link->config->vtable->cla_rx_task_reset_parsers(
-				link
-			);
-			rx_data->input_buffer.end = rx_data->input_buffer.start;
+		if (memory_budget_wait(rx_task_should_stop, link)) {
+			link->last_rx_time_ms = hal_time_get_timestamp_ms();
+			continue;
 		}
+
+		if (HAS_FLAG(rx_data->cur_parser->flags, PARSER_FLAG_BULK_READ))
+			rx_bulk_read(link);
+		else
+			rx_chunk_read(link);
 	}
 
 	hal_semaphore_release(link->rx_task_sem);
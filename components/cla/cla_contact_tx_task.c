@@ -13,9 +13,14 @@
 #include "ud3tn/bundle.h"
 #include "ud3tn/bundle_processor.h"
 #include "ud3tn/common.h"
+#include "ud3tn/node.h"
+#include "ud3tn/object_pool.h"
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #if defined(CLA_TX_RATE_LIMIT) && CLA_TX_RATE_LIMIT != 0
 static const int rate_sleep_time_ms = 1000 / CLA_TX_RATE_LIMIT;
@@ -26,15 +31,21 @@ static const int rate_sleep_time_ms;
 // BPv7 5.4-4 / RFC5050 5.4-5
 static void prepare_bundle_for_forwarding(struct bundle *bundle)
 {
-	struct bundle_block_list **blocks = &bundle->blocks;
+	// Only walk the blocks if there may be a Previous Node block at all.
+	struct bundle_block_list **blocks = (
+		bundle_has_block_type(bundle, BUNDLE_BLOCK_TYPE_PREVIOUS_NODE)
+		? &bundle->blocks
+		: NULL
+	);
 
 	// BPv7 5.4-4: "If the bundle has a Previous Node block ..., then that
 	// block MUST be removed ... before the bundle is forwarded."
-	while (*blocks != NULL) {
+	while (blocks != NULL && *blocks != NULL) {
 		if ((*blocks)->data->type == BUNDLE_BLOCK_TYPE_PREVIOUS_NODE) {
 			// Replace the first occurrence of the previous node
 			// block by its successor and free it.
 			*blocks = bundle_block_entry_free(*blocks);
+			bundle_invalidate_block_caches(bundle);
 			break;
 		}
 		blocks = &(*blocks)->next;
@@ -49,9 +60,85 @@ static void prepare_bundle_for_forwarding(struct bundle *bundle)
 		LOGF_ERROR("TX: Bundle %p age block update failed!", bundle);
 }
 
+struct packet_buffer {
+	uint8_t *pos;
+	const uint8_t *end;
+	bool overflow;
+};
+
+static void write_to_packet_buffer(void *param, const void *data,
+				   const size_t length)
+{
+	struct packet_buffer *const pb = param;
+
+	if (pb->overflow || length > (size_t)(pb->end - pb->pos)) {
+		pb->overflow = true;
+		return;
+	}
+	memcpy(pb->pos, data, length);
+	pb->pos += length;
+}
+
+static enum ud3tn_result send_small_bundle(
+	struct cla_link *const link, struct bundle *const bundle,
+	const size_t size, char *const cla_address)
+{
+	const struct cla_vtable *const vtable = link->config->vtable;
+	uint8_t buffer[CLA_TX_PACKET_HEADROOM + BUNDLE_SMALL_MAX_SIZE];
+	uint8_t *const data = &buffer[CLA_TX_PACKET_HEADROOM];
+	struct packet_buffer pb = {
+		.pos = data,
+		.end = data + size,
+		.overflow = false,
+	};
+
+	// Nothing is sent if the bundle cannot be serialized completely.
+	if (bundle_serialize(bundle, write_to_packet_buffer, &pb) != UD3TN_OK ||
+	    pb.overflow || pb.pos != data + size)
+		return UD3TN_FAIL;
+
+	if (vtable->cla_send_packet != NULL) {
+		vtable->cla_send_packet(link, data, size, cla_address);
+	} else {
+		vtable->cla_begin_packet(link, size, cla_address);
+		vtable->cla_send_packet_data(link, data, size);
+		vtable->cla_end_packet(link);
+	}
+	return UD3TN_OK;
+}
+
+enum ud3tn_result cla_contact_tx_send_bundle(
+	struct cla_link *const link, struct bundle *const bundle,
+	char *const cla_address)
+{
+	const struct cla_vtable *const vtable = link->config->vtable;
+	const size_t size = bundle_get_serialized_size(bundle);
+	enum ud3tn_result result;
+
+	if (size <= BUNDLE_SMALL_MAX_SIZE)
+		return send_small_bundle(link, bundle, size, cla_address);
+
+	// Falls back to passing the pieces to the CLA one by one if the
+	// buffers for the iovecs cannot be allocated.
+	if (vtable->cla_send_packet_iov != NULL &&
+	    bundle_serialize_iov(bundle, &link->tx_iov) == UD3TN_OK) {
+		vtable->cla_send_packet_iov(link, &link->tx_iov, cla_address);
+		return UD3TN_OK;
+	}
+
+	vtable->cla_begin_packet(link, size, cla_address);
+	result = bundle_serialize(
+		bundle,
+		(void (*)(void *, const void *, const size_t))
+			vtable->cla_send_packet_data,
+		(void *)link
+	);
+	vtable->cla_end_packet(link);
+	return result;
+}
+
 static void bp_inform_tx(QueueIdentifier_t signaling_queue,
 			 struct bundle *const b,
-			 struct cla_link *const link,
 			 const bool success)
 {
 	bundle_processor_inform(
@@ -63,7 +150,9 @@ static void bp_inform_tx(QueueIdentifier_t signaling_queue,
 				: BP_SIGNAL_TRANSMISSION_FAILURE
 			),
 			.bundle = b,
-			.peer_cla_addr = cla_get_cla_addr_from_link(link),
+			// Not evaluated by the BP, thus, not copied for every
+			// bundle.
+			.peer_cla_addr = NULL,
 		}
 	);
 }
@@ -74,8 +163,6 @@ static void cla_contact_tx_task(void *param)
 	struct cla_contact_tx_task_command cmd;
 
 	enum ud3tn_result s;
-	void const *cla_send_packet_data =
-		link->config->vtable->cla_send_packet_data;
 	QueueIdentifier_t signaling_queue =
 		link->config->bundle_agent_interface->bundle_signaling_queue;
 
@@ -97,30 +184,22 @@ static void cla_contact_tx_task(void *param)
 				b,
 				link->config->vtable->cla_name_get()
 			);
-			link->config->vtable->cla_begin_packet(
+			s = cla_contact_tx_send_bundle(
 				link,
-				bundle_get_serialized_size(b),
-				cmd.cla_address
-			);
-			s = bundle_serialize(
 				b,
-				cla_send_packet_data,
-				(void *)link
+				cmd.cla_address
 			);
-			link->config->vtable->cla_end_packet(link);
 
 			if (s == UD3TN_OK) {
 				bp_inform_tx(
 					signaling_queue,
 					b,
-					link,
 					true
 				);
 			} else {
 				bp_inform_tx(
 					signaling_queue,
 					b,
-					link,
 					false
 				);
 			}
@@ -129,7 +208,7 @@ static void cla_contact_tx_task(void *param)
 
 			rbl = rbl->next;
 			// Free the bundle list from the command step-by-step.
-			free(tmp);
+			object_pool_free(&routed_bundle_list_pool, tmp);
 
 			if (rate_sleep_time_ms)
 				hal_task_delay(rate_sleep_time_ms);
@@ -155,14 +234,13 @@ static void cla_contact_tx_task(void *param)
 				bp_inform_tx(
 					signaling_queue,
 					b,
-					link,
 					false
 				);
 
 				struct routed_bundle_list *tmp = rbl;
 
 				rbl = rbl->next;
-				free(tmp);
+				object_pool_free(&routed_bundle_list_pool, tmp);
 			}
 
 			free(cmd.cla_address);
@@ -23,8 +23,8 @@
 #include "ud3tn/cmdline.h"
 #include "ud3tn/common.h"
 #include "ud3tn/eid.h"
+#include "ud3tn/hashtable.h"
 #include "ud3tn/result.h"
-#include "ud3tn/simplehtab.h"
 
 #include <sys/socket.h>
 #include <unistd.h>
@@ -40,8 +40,7 @@ static const char *CLA_NAME = "bibe";
 struct bibe_config {
 	struct cla_tcp_config base;
 
-	struct htab_entrylist *param_htab_elem[CLA_TCP_PARAM_HTAB_SLOT_COUNT];
-	struct htab param_htab;
+	struct hashtable param_htab;
 	Semaphore_t param_htab_sem;
 
 	const char *node;
@@ -178,7 +177,7 @@ static void bibe_link_management_task(void *p)
 	hal_semaphore_release(param->param_semphr);
 
 	hal_semaphore_take_blocking(param->config->param_htab_sem);
-	htab_remove(&param->config->param_htab, param->cla_sock_addr);
+	hashtable_remove(&param->config->param_htab, param->cla_sock_addr);
 	hal_semaphore_release(param->config->param_htab_sem);
 
 	hal_semaphore_take_blocking(param->param_semphr);
@@ -243,14 +242,9 @@ static void launch_connection_management_task(
 
 	aap_parser_init(&contact_params->link.aap_parser);
 
-	struct htab_entrylist *htab_entry = NULL;
-
-	htab_entry = htab_add(
-		&bibe_config->param_htab,
-		contact_params->cla_sock_addr,
-		contact_params
-	);
-	if (!htab_entry) {
+	if (hashtable_add(&bibe_config->param_htab,
+			  contact_params->cla_sock_addr,
+			  contact_params) != UD3TN_OK) {
 		LOG_ERROR("BIBE: Error creating htab entry!");
 		goto fail_sem;
 	}
@@ -262,13 +256,11 @@ static void launch_connection_management_task(
 
 	if (task_creation_result != UD3TN_OK) {
 		LOG_ERROR("BIBE: Error creating management task!");
-		if (htab_entry) {
-			ASSERT(contact_params->cla_sock_addr);
-			ASSERT(htab_remove(
-				&bibe_config->param_htab,
-				contact_params->cla_sock_addr
-			) == contact_params);
-		}
+		ASSERT(contact_params->cla_sock_addr);
+		ASSERT(hashtable_remove(
+			&bibe_config->param_htab,
+			contact_params->cla_sock_addr
+		) == contact_params);
 		goto fail_sem;
 	}
 
@@ -340,10 +332,6 @@ size_t bibe_forward_to_specific_parser(struct cla_link *const link,
 			// Parsing the BPDU
 			struct bibe_protocol_data_unit bpdu;
 
-			// Ensure it is always initialized, so we can safely
-			// invoke free() below.
-			bpdu.encapsulated_bundle = NULL;
-
 			size_t err = bibe_parser_parse(
 				msg.payload,
 				msg.payload_length,
@@ -352,15 +340,14 @@ size_t bibe_forward_to_specific_parser(struct cla_link *const link,
 
 			if (err == 0 && bpdu.payload_length != 0) {
 				// Parsing and forwarding the encapsulated
-				// bundle
+				// bundle, which is read from the AAP payload
+				// in place
 				bundle7_parser_read(
 					&rx_data->bundle7_parser,
 					bpdu.encapsulated_bundle,
 					bpdu.payload_length
 				);
 			}
-
-			free(bpdu.encapsulated_bundle);
 		}
 
 		aap_message_clear(&msg);
@@ -391,7 +378,7 @@ static struct bibe_contact_parameters *get_contact_parameters(
 	if (eid_delimiter)
 		eid_delimiter[0] = '\0'; // null-terminate after sock address
 
-	struct bibe_contact_parameters *param = htab_get(
+	struct bibe_contact_parameters *param = hashtable_get(
 		&bibe_config->param_htab,
 		cla_sock_addr
 	);
@@ -495,10 +482,10 @@ static enum ud3tn_result bibe_start_scheduled_contact(
 		}
 		hal_semaphore_release(param->param_semphr);
 		// Task is cleaning up already, just insert a new entry then.
-		// NOTE this calls htab_remove earlier than the connection
+		// NOTE this calls hashtable_remove earlier than the connection
 		// management task but the 2nd call invoked by the latter
 		// is no issue - it will not find the entry and return.
-		htab_remove(&bibe_config->param_htab, cla_addr);
+		hashtable_remove(&bibe_config->param_htab, cla_addr);
 	}
 
 	launch_connection_management_task(bibe_config, cla_addr, eid);
@@ -541,7 +528,17 @@ static enum ud3tn_result bibe_end_scheduled_contact(
 	return UD3TN_OK;
 }
 
-void bibe_begin_packet(struct cla_link *link, size_t length, char *cla_addr)
+// Headers for destination EIDs of usual length are encoded on the stack.
+#define BIBE_HEADER_BUFFER_SIZE 128
+
+/*
+ * Sends the BIBE header for an encapsulated bundle of the given length,
+ * followed by the given iovecs, with a single call. The header is placed in
+ * the entry in front of the iovecs, which has to be available.
+ */
+static void send_with_header(struct cla_link *link, struct iovec *iov,
+			     const size_t iov_count, const size_t length,
+			     const char *cla_addr)
 {
 	struct cla_tcp_link *const tcp_link = (struct cla_tcp_link *)link;
 
@@ -552,17 +549,40 @@ void bibe_begin_packet(struct cla_link *link, size_t length, char *cla_addr)
 	ASSERT(dest_eid[0] != '\0' && dest_eid[1] != '\0');
 	dest_eid = &dest_eid[1]; // EID starts _after_ the '#'
 
-	struct bibe_header hdr;
+	uint8_t buffer[BIBE_HEADER_BUFFER_SIZE];
+	const size_t hdr_len = bibe_get_header_length(dest_eid, length);
+	uint8_t *const hdr = (
+		hdr_len <= BIBE_HEADER_BUFFER_SIZE
+		? buffer
+		: malloc(hdr_len)
+	);
 
-	hdr = bibe_encode_header(dest_eid, length);
+	if (!hdr) {
+		LOG_ERROR("BIBE: Allocating header failed. Data discarded.");
+		link->config->vtable->cla_disconnect_handler(link);
+		return;
+	}
 
-	if (tcp_send_all(tcp_link->connection_socket,
-			 hdr.data, hdr.hdr_len) == -1) {
+	iov[-1] = (struct iovec) {
+		.iov_base = hdr,
+		.iov_len = bibe_encode_header_into(hdr, dest_eid, length),
+	};
+	if (tcp_send_iov_all(tcp_link->connection_socket, iov - 1,
+			     iov_count + 1) == -1) {
 		LOG_ERROR("BIBE: Error during sending. Data discarded.");
 		link->config->vtable->cla_disconnect_handler(link);
 	}
 
-	free(hdr.data);
+	if (hdr != buffer)
+		free(hdr);
+}
+
+void bibe_begin_packet(struct cla_link *link, size_t length, char *cla_addr)
+{
+	struct iovec iov[1];
+
+	// Only the header, the data is passed via bibe_send_packet_data().
+	send_with_header(link, &iov[1], 0, length, cla_addr);
 }
 
 void bibe_end_packet(struct cla_link *link)
@@ -582,6 +602,29 @@ void bibe_send_packet_data(
 	}
 }
 
+void bibe_send_packet(struct cla_link *link, uint8_t *data,
+		      const size_t length, char *cla_addr)
+{
+	// The header does not fit into CLA_TX_PACKET_HEADROOM in general.
+	struct iovec iov[2] = {
+		[1] = {
+			.iov_base = data,
+			.iov_len = length,
+		},
+	};
+
+	send_with_header(link, &iov[1], 1, length, cla_addr);
+}
+
+void bibe_send_packet_iov(struct cla_link *link, struct bundle_iov *iov,
+			  char *cla_addr)
+{
+	// The serialized bundle is streamed as the payload of the AAP message
+	// in place, i.e. without encoding it into a buffer first.
+	send_with_header(link, iov->iov, iov->iov_count, iov->length,
+			 cla_addr);
+}
+
 const struct cla_vtable bibe_vtable = {
 	.cla_name_get = bibe_name_get,
 	.cla_launch = bibe_launch,
@@ -594,6 +637,8 @@ const struct cla_vtable bibe_vtable = {
 	.cla_begin_packet = bibe_begin_packet,
 	.cla_end_packet = bibe_end_packet,
 	.cla_send_packet_data = bibe_send_packet_data,
+	.cla_send_packet = bibe_send_packet,
+	.cla_send_packet_iov = bibe_send_packet_iov,
 
 	.cla_rx_task_reset_parsers = bibe_reset_parsers,
 	.cla_rx_task_forward_to_specific_parser =
@@ -622,8 +667,7 @@ static enum ud3tn_result bibe_init(
 		return UD3TN_FAIL;
 	hal_semaphore_release(config->param_htab_sem);
 
-	htab_init(&config->param_htab, CLA_TCP_PARAM_HTAB_SLOT_COUNT,
-		  config->param_htab_elem);
+	hashtable_init(&config->param_htab, CLA_TCP_PARAM_HTAB_SLOT_COUNT);
 
 	config->node = node;
 	config->service = service;
@@ -10,7 +10,7 @@
 
 #include "ud3tn/bundle_processor.h"
 #include "ud3tn/common.h"
-#include "ud3tn/simplehtab.h"
+#include "ud3tn/hashtable.h"
 #include "cla/cla_contact_tx_task.h"
 #include "ud3tn/result.h"
 
@@ -29,8 +29,7 @@ struct filecla_config {
 
 	QueueIdentifier_t signaling_queue;
 
-	struct htab_entrylist *contacts_elem[FILECLA_MAX_CONTACTS];
-	struct htab contacts;
+	struct hashtable contacts;
 	Semaphore_t contacts_semaphore;
 };
 
@@ -122,6 +121,7 @@ static void prepare_bundle_for_forwarding(struct bundle *bundle, char* previous_
 	struct bundle_block_list* entry = bundle_block_entry_create(block);
 	entry->next = bundle->blocks;
 	bundle->blocks = entry;
+	bundle_invalidate_block_caches(bundle);
 
 	const uint8_t dwell_time_ms = hal_time_get_timestamp_ms() -
 		bundle->reception_timestamp_ms;
@@ -444,7 +444,7 @@ static enum ud3tn_result filecla_start_scheduled_contact(
 	c->cla_config = file_config;
 
 	hal_semaphore_take_blocking(file_config->contacts_semaphore);
-	htab_add(&file_config->contacts, c->eid, c);
+	hashtable_add(&file_config->contacts, c->eid, c);
 	hal_semaphore_release(file_config->contacts_semaphore);
 
 	hal_task_create(
@@ -469,7 +469,7 @@ static struct cla_tx_queue filecla_get_tx_queue(
 	struct filecla_config *const file_config = ((struct filecla_config *) config);
 
 	hal_semaphore_take_blocking(file_config->contacts_semaphore);
-	struct filecla_contact *c = htab_get(&file_config->contacts, eid);
+	struct filecla_contact *c = hashtable_get(&file_config->contacts, eid);
 	hal_semaphore_release(file_config->contacts_semaphore);
 	if(c == NULL){
 		LOGF_ERROR("FileCLA: Unavailable contact for \"%s\"", eid);
@@ -490,7 +490,7 @@ static enum ud3tn_result filecla_end_scheduled_contact(
 	struct filecla_config *const file_config = ((struct filecla_config *) config);
 
 	hal_semaphore_take_blocking(file_config->contacts_semaphore);
-	struct filecla_contact *c = htab_remove(&file_config->contacts, eid);
+	struct filecla_contact *c = hashtable_remove(&file_config->contacts, eid);
 	hal_semaphore_release(file_config->contacts_semaphore);
 	if(c != NULL){
 
@@ -546,7 +546,7 @@ struct cla_config *filecla_create(
 	config->local_eid = bundle_agent_interface->local_eid;
 	config->signaling_queue = bundle_agent_interface->bundle_signaling_queue;
 
-	htab_init(&config->contacts, FILECLA_MAX_CONTACTS, config->contacts_elem);
+	hashtable_init(&config->contacts, FILECLA_MAX_CONTACTS);
 	config->contacts_semaphore = hal_semaphore_init_binary();
 	hal_semaphore_release(config->contacts_semaphore);
 
@@ -18,8 +18,8 @@
 #include "ud3tn/bundle_processor.h"
 #include "ud3tn/cmdline.h"
 #include "ud3tn/common.h"
+#include "ud3tn/hashtable.h"
 #include "ud3tn/result.h"
-#include "ud3tn/simplehtab.h"
 
 #include <sys/socket.h>
 #include <unistd.h>
@@ -28,14 +28,18 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+
+#if CLA_TX_PACKET_HEADROOM < 9
+#error "CLA_TX_PACKET_HEADROOM has to fit the MTCP header (9 bytes)"
+#endif // CLA_TX_PACKET_HEADROOM
 
 static const char *CLA_NAME = "mtcp";
 
 struct mtcp_config {
 	struct cla_tcp_config base;
 
-	struct htab_entrylist *param_htab_elem[CLA_TCP_PARAM_HTAB_SLOT_COUNT];
-	struct htab param_htab;
+	struct hashtable param_htab;
 	Semaphore_t param_htab_sem;
 };
 
@@ -142,7 +146,7 @@ static void mtcp_link_management_task(void *p)
 	hal_semaphore_release(param->param_semphr);
 
 	hal_semaphore_take_blocking(param->config->param_htab_sem);
-	htab_remove(&param->config->param_htab, param->cla_sock_addr);
+	hashtable_remove(&param->config->param_htab, param->cla_sock_addr);
 	hal_semaphore_release(param->config->param_htab_sem);
 
 	hal_semaphore_take_blocking(param->param_semphr);
@@ -212,14 +216,9 @@ static void launch_connection_management_task(
 
 	mtcp_parser_reset(&contact_params->link.mtcp_parser);
 
-	struct htab_entrylist *htab_entry = NULL;
-
-	htab_entry = htab_add(
-		&mtcp_config->param_htab,
-		contact_params->cla_sock_addr,
-		contact_params
-	);
-	if (!htab_entry) {
+	if (hashtable_add(&mtcp_config->param_htab,
+			  contact_params->cla_sock_addr,
+			  contact_params) != UD3TN_OK) {
 		LOG_ERROR("MTCP: Error creating htab entry!");
 		goto fail_sem;
 	}
@@ -231,13 +230,11 @@ static void launch_connection_management_task(
 
 	if (task_creation_result != UD3TN_OK) {
 		LOG_ERROR("MTCP: Error creating management task!");
-		if (htab_entry) {
-			ASSERT(contact_params->cla_sock_addr);
-			ASSERT(htab_remove(
-				&mtcp_config->param_htab,
-				contact_params->cla_sock_addr
-			) == contact_params);
-		}
+		ASSERT(contact_params->cla_sock_addr);
+		ASSERT(hashtable_remove(
+			&mtcp_config->param_htab,
+			contact_params->cla_sock_addr
+		) == contact_params);
 		goto fail_sem;
 	}
 
@@ -377,7 +374,7 @@ static struct mtcp_contact_parameters *get_contact_parameters(
 		return NULL;
 	}
 
-	struct mtcp_contact_parameters *param = htab_get(
+	struct mtcp_contact_parameters *param = hashtable_get(
 		&mtcp_config->param_htab,
 		cla_sock_addr
 	);
@@ -470,10 +467,10 @@ static enum ud3tn_result mtcp_start_scheduled_contact(
 		}
 		hal_semaphore_release(param->param_semphr);
 		// Task is cleaning up already, just insert a new entry then.
-		// NOTE this calls htab_remove earlier than the connection
+		// NOTE this calls hashtable_remove earlier than the connection
 		// management task but the 2nd call invoked by the latter
 		// is no issue - it will not find the entry and return.
-		htab_remove(&mtcp_config->param_htab, cla_addr);
+		hashtable_remove(&mtcp_config->param_htab, cla_addr);
 	}
 
 	launch_connection_management_task(mtcp_config, -1, cla_addr);
@@ -558,6 +555,50 @@ void mtcp_send_packet_data(
 	}
 }
 
+void mtcp_send_packet(struct cla_link *link, uint8_t *data, size_t length,
+		      char *cla_addr)
+{
+	struct cla_tcp_link *const tcp_link = (struct cla_tcp_link *)link;
+
+	const size_t BUFFER_SIZE = 9; // max. for uint64_t
+	uint8_t buffer[BUFFER_SIZE];
+
+	(void)cla_addr;
+
+	// Prepend the header to send the packet with a single call.
+	const size_t hdr_len = mtcp_encode_header(buffer, BUFFER_SIZE, length);
+
+	memcpy(data - hdr_len, buffer, hdr_len);
+	if (tcp_send_all(tcp_link->connection_socket, data - hdr_len,
+			 hdr_len + length) == -1) {
+		LOG_WARN("MTCP: Error during sending. Data discarded.");
+		link->config->vtable->cla_disconnect_handler(link);
+	}
+}
+
+void mtcp_send_packet_iov(struct cla_link *link, struct bundle_iov *iov,
+			  char *cla_addr)
+{
+	struct cla_tcp_link *const tcp_link = (struct cla_tcp_link *)link;
+
+	const size_t BUFFER_SIZE = 9; // max. for uint64_t
+	uint8_t buffer[BUFFER_SIZE];
+
+	(void)cla_addr;
+
+	// Prepend the header to send the packet with a single call.
+	iov->iov[-1] = (struct iovec) {
+		.iov_base = buffer,
+		.iov_len = mtcp_encode_header(buffer, BUFFER_SIZE,
+					      iov->length),
+	};
+	if (tcp_send_iov_all(tcp_link->connection_socket, iov->iov - 1,
+			     iov->iov_count + 1) == -1) {
+		LOG_WARN("MTCP: Error during sending. Data discarded.");
+		link->config->vtable->cla_disconnect_handler(link);
+	}
+}
+
 const struct cla_vtable mtcp_vtable = {
 	.cla_name_get = mtcp_name_get,
 	.cla_launch = mtcp_launch,
@@ -570,6 +611,8 @@ const struct cla_vtable mtcp_vtable = {
 	.cla_begin_packet = mtcp_begin_packet,
 	.cla_end_packet = mtcp_end_packet,
 	.cla_send_packet_data = mtcp_send_packet_data,
+	.cla_send_packet = mtcp_send_packet,
+	.cla_send_packet_iov = mtcp_send_packet_iov,
 
 	.cla_rx_task_reset_parsers = mtcp_reset_parsers,
 	.cla_rx_task_forward_to_specific_parser =
@@ -598,14 +641,13 @@ static enum ud3tn_result mtcp_init(
 		return UD3TN_FAIL;
 	hal_semaphore_release(config->param_htab_sem);
 
-	htab_init(&config->param_htab, CLA_TCP_PARAM_HTAB_SLOT_COUNT,
-		  config->param_htab_elem);
+	hashtable_init(&config->param_htab, CLA_TCP_PARAM_HTAB_SLOT_COUNT);
 
 	/* Start listening */
 	if (cla_tcp_listen(&config->base, node, service,
 			   CLA_TCP_MULTI_BACKLOG) != UD3TN_OK) {
 		hal_semaphore_take_blocking(config->param_htab_sem);
-		htab_trunc(&config->param_htab);
+		hashtable_clear(&config->param_htab, NULL);
 		hal_semaphore_delete(config->param_htab_sem);
 		return UD3TN_FAIL;
 	}
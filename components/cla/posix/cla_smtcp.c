@@ -23,6 +23,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 static const char *CLA_NAME = "smtcp";
 
@@ -67,6 +68,8 @@ const struct cla_vtable smtcp_vtable = {
 	.cla_begin_packet = mtcp_begin_packet,
 	.cla_end_packet = mtcp_end_packet,
 	.cla_send_packet_data = mtcp_send_packet_data,
+	.cla_send_packet = mtcp_send_packet,
+	.cla_send_packet_iov = mtcp_send_packet_iov,
 
 	.cla_rx_task_reset_parsers = mtcp_reset_parsers,
 	.cla_rx_task_forward_to_specific_parser =
@@ -14,6 +14,7 @@
 #include <unistd.h>
 
 #include <errno.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
@@ -28,6 +29,10 @@
 #define NI_MAXSERV 32
 #endif // NI_MAXSERV
 
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif // IOV_MAX
+
 char *cla_tcp_sockaddr_to_cla_addr(struct sockaddr *const sockaddr,
 				   const socklen_t sockaddr_len)
 {
@@ -304,7 +309,7 @@ ssize_t tcp_send_all(const int socket, const void *const buffer,
 	while (sent < length) {
 		const ssize_t r = send(
 			socket,
-			buffer,
+			(const uint8_t *)buffer + sent,
 			length - sent,
 			0
 		);
@@ -324,6 +329,42 @@ ssize_t tcp_send_all(const int socket, const void *const buffer,
 	return sent;
 }
 
+ssize_t tcp_send_iov_all(const int socket, struct iovec *iov, size_t iov_count)
+{
+	size_t sent = 0;
+
+	while (iov_count != 0) {
+		struct msghdr msg = {
+			.msg_iov = iov,
+			.msg_iovlen = MIN(iov_count, (size_t)IOV_MAX),
+		};
+		ssize_t r = sendmsg(socket, &msg, 0);
+
+		if (r == 0)
+			return r;
+		if (r < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK ||
+					errno == EINTR)
+				continue;
+			return r;
+		}
+
+		sent += r;
+		// Skip the data that has been sent.
+		while (iov_count != 0 && (size_t)r >= iov->iov_len) {
+			r -= iov->iov_len;
+			iov++;
+			iov_count--;
+		}
+		if (iov_count != 0) {
+			iov->iov_base = (uint8_t *)iov->iov_base + r;
+			iov->iov_len -= r;
+		}
+	}
+
+	return sent;
+}
+
 ssize_t tcp_recv_all(const int socket, void *const buffer, const size_t length)
 {
 	size_t recvd = 0;
@@ -19,8 +19,8 @@
 #include "ud3tn/cmdline.h"
 #include "ud3tn/common.h"
 #include "ud3tn/eid.h"
+#include "ud3tn/hashtable.h"
 #include "ud3tn/result.h"
-#include "ud3tn/simplehtab.h"
 
 #include <errno.h>
 #include <limits.h>
@@ -28,6 +28,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <netdb.h>
 #include <unistd.h>
@@ -38,8 +39,7 @@ static const char *CLA_NAME = "tcpclv3";
 struct tcpclv3_config {
 	struct cla_tcp_config base;
 
-	struct htab_entrylist *param_htab_elem[CLA_TCP_PARAM_HTAB_SLOT_COUNT];
-	struct htab param_htab;
+	struct hashtable param_htab;
 	Semaphore_t param_htab_sem;
 };
 
@@ -213,7 +213,7 @@ static enum ud3tn_result handle_established_connection(
 	// a) trying to connect / establish (non-opportunistic)
 	// b) already established
 	struct tcpclv3_contact_parameters *const other =
-		htab_get(&tcpclv3_config->param_htab, param->eid);
+		hashtable_get(&tcpclv3_config->param_htab, param->eid);
 
 	if (other && other != param) {
 		hal_semaphore_take_blocking(other->param_semphr);
@@ -225,7 +225,7 @@ static enum ud3tn_result handle_established_connection(
 			"TCPCLv3: Taking over management of connection with \"%s\"",
 			param->eid
 		);
-		htab_remove(&tcpclv3_config->param_htab, param->eid);
+		hashtable_remove(&tcpclv3_config->param_htab, param->eid);
 		if (!other->opportunistic) {
 			// Take over the "planned" status
 			other->opportunistic = true;
@@ -240,7 +240,7 @@ static enum ud3tn_result handle_established_connection(
 	}
 
 	// Will do nothing if element exists - this is expected
-	htab_add(&tcpclv3_config->param_htab, param->eid, param);
+	hashtable_add(&tcpclv3_config->param_htab, param->eid, param);
 
 	param->state = TCPCLV3_ESTABLISHED;
 
@@ -345,8 +345,8 @@ static void tcpclv3_link_management_task(void *p)
 	if (param->eid) {
 		hal_semaphore_take_blocking(param->config->param_htab_sem);
 		// Only delete in case it is our own entry...
-		if (htab_get(&param->config->param_htab, param->eid) == param)
-			htab_remove(&param->config->param_htab, param->eid);
+		if (hashtable_get(&param->config->param_htab, param->eid) == param)
+			hashtable_remove(&param->config->param_htab, param->eid);
 		hal_semaphore_release(param->config->param_htab_sem);
 	}
 
@@ -428,15 +428,10 @@ static void launch_connection_management_task(
 		goto fail_sem;
 	}
 
-	struct htab_entrylist *htab_entry = NULL;
-
 	if (contact_params->eid) {
-		htab_entry = htab_add(
-			&tcpclv3_config->param_htab,
-			contact_params->eid,
-			contact_params
-		);
-		if (!htab_entry) {
+		if (hashtable_add(&tcpclv3_config->param_htab,
+				  contact_params->eid,
+				  contact_params) != UD3TN_OK) {
 			LOG_ERROR("TCPCLv3: Error creating htab entry!");
 			goto fail_sem;
 		}
@@ -449,9 +444,8 @@ static void launch_connection_management_task(
 
 	if (task_creation_result != UD3TN_OK) {
 		LOG_ERROR("TCPCLv3: Error creating management task!");
-		if (htab_entry) {
-			ASSERT(contact_params->eid);
-			ASSERT(htab_remove(
+		if (contact_params->eid) {
+			ASSERT(hashtable_remove(
 				&tcpclv3_config->param_htab,
 				contact_params->eid
 			) == contact_params);
@@ -475,7 +469,7 @@ static struct tcpclv3_contact_parameters *get_contact_parameters(
 	struct tcpclv3_config *const tcpclv3_config =
 		(struct tcpclv3_config *)config;
 
-	return htab_get(&tcpclv3_config->param_htab, eid);
+	return hashtable_get(&tcpclv3_config->param_htab, eid);
 }
 
 static void tcpclv3_listener_task(void *p)
@@ -627,10 +621,10 @@ static enum ud3tn_result tcpclv3_start_scheduled_contact(
 		}
 		hal_semaphore_release(param->param_semphr);
 		// Task is cleaning up already, just insert a new entry then.
-		// NOTE this calls htab_remove earlier than the connection
+		// NOTE this calls hashtable_remove earlier than the connection
 		// management task but the 2nd call invoked by the latter
 		// is no issue - it will not find the entry and return.
-		htab_remove(&tcpclv3_config->param_htab, cla_addr);
+		hashtable_remove(&tcpclv3_config->param_htab, cla_addr);
 	}
 
 	launch_connection_management_task(tcpclv3_config, -1, eid, cla_addr);
@@ -843,15 +837,14 @@ static enum ud3tn_result tcpclv3_init(
 		return UD3TN_FAIL;
 	hal_semaphore_release(config->param_htab_sem);
 
-	htab_init(&config->param_htab, CLA_TCP_PARAM_HTAB_SLOT_COUNT,
-		  config->param_htab_elem);
+	hashtable_init(&config->param_htab, CLA_TCP_PARAM_HTAB_SLOT_COUNT);
 
 	/* Start listening */
 	if (cla_tcp_listen(&config->base, node, service,
 			   CLA_TCP_MULTI_BACKLOG)
 			!= UD3TN_OK) {
 		hal_semaphore_take_blocking(config->param_htab_sem);
-		htab_trunc(&config->param_htab);
+		hashtable_clear(&config->param_htab, NULL);
 		hal_semaphore_delete(config->param_htab_sem);
 		return UD3TN_FAIL;
 	}
@@ -13,8 +13,10 @@
 #include "platform/hal_task.h"
 
 #include <errno.h>
+#include <fcntl.h>
 #include <inttypes.h>
 #include <signal.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -85,3 +87,28 @@ void hal_platform_init(int argc, char *argv[])
 		LOG_ERROR("Error: Cannot allocate memory for restart buffer");
 	}
 }
+
+enum ud3tn_result hal_platform_get_random_bytes(void *buffer, size_t length)
+{
+	const int fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+	uint8_t *pos = buffer;
+
+	if (fd < 0)
+		return UD3TN_FAIL;
+
+	while (length > 0) {
+		const ssize_t result = read(fd, pos, length);
+
+		if (result <= 0) {
+			if (result < 0 && errno == EINTR)
+				continue;
+			close(fd);
+			return UD3TN_FAIL;
+		}
+		pos += result;
+		length -= (size_t)result;
+	}
+
+	close(fd);
+	return UD3TN_OK;
+}
@@ -15,9 +15,11 @@
 #include "platform/hal_semaphore.h"
 #include <sys/stat.h>
 #include "ud3tn/eid.h"
+#include "ud3tn/memory_budget.h"
 #include <stdio.h>
 #include <errno.h>
 #include <stdlib.h>
+#include <string.h>
 #include <dirent.h>
 #include <inttypes.h>
 
@@ -75,18 +77,6 @@ struct bundle_store* hal_store_init(const char* identifier) {
     return ((struct bundle_store*) s);
 }
 
-static void eid_to_filename(char* eid){
-	for(size_t i = 0; i<strlen(eid); i++){
-		if(!((eid[i] >= 'a' && eid[i] <= 'z') ||
-			 (eid[i] >= 'A' && eid[i] <= 'Z') ||
-			 (eid[i] >= '0' && eid[i] <= '9') ||
-			 eid[i] == '_' || eid[i] == '.' || eid[i] == '-'
-		 )){
-			eid[i] = '-';
-		}
-	}
-}
-
 void write_bundle_to_file(void* file, const void * b, const size_t size){
 
 	FILE* f = (FILE*) file;
@@ -108,35 +98,22 @@ enum ud3tn_result hal_store_bundle(struct bundle_store* base_store, struct bundl
     char* dirpath = malloc(sizeof(char) * (strlen(store->base.identifier) + 5 + 1));
     sprintf(dirpath, "%s/data", store->base.identifier);
 
-    // prepare filename
-    struct bundle_unique_identifier bundle_id = bundle_get_unique_identifier(bundle);
+    // prepare filename, the fixed-width bundle ID only contains hex digits
+    const struct bundle_id bundle_id = bundle_get_id(bundle);
     size_t max_len = (
         24 // store sequence number
         + 1 // -
         + 4 // protocol version
         + 1 // _
-        + strlen(bundle->source)
-        + 1 // _
-        + 24 // creation timestamp
-        + 1 // _
-        + 24 // sequence number
-        + 1 // _
-        + 10 // fragment offset
-        + 1 // _
-        + 10 // Payload length
+        + 32 // bundle ID
     );
     char* filename = malloc(sizeof(char) * (max_len + 1));
-    snprintf(filename, max_len, "%ld-%d_%s_%ld_%ld_%d_%d",
+    snprintf(filename, max_len + 1, "%" PRIu64 "-%d_%016" PRIx64 "%016" PRIx64,
         current_seqnum,
-        bundle_id.protocol_version,
-        bundle_id.source,
-        bundle_id.creation_timestamp_ms,
-        bundle_id.sequence_number,
-        bundle_id.fragment_offset,
-        bundle_id.payload_length
+        bundle->protocol_version,
+        bundle_id.hi,
+        bundle_id.lo
     );
-    bundle_free_unique_identifier(&bundle_id);
-    eid_to_filename(filename);
 
     // create path
     char* path = malloc(sizeof(char) * (strlen(dirpath) + 1 + max_len));
@@ -145,6 +122,11 @@ enum ud3tn_result hal_store_bundle(struct bundle_store* base_store, struct bundl
     free(dirpath);
 
     enum ud3tn_result return_result = UD3TN_FAIL;
+    const uint64_t budget_bytes = (
+        bundle->payload_block ? bundle->payload_block->length : 0
+    );
+
+    memory_budget_charge(MEMORY_BUDGET_STORE, budget_bytes);
 
     FILE* fd = fopen(path, "w");
     if(fd){
@@ -154,6 +136,7 @@ enum ud3tn_result hal_store_bundle(struct bundle_store* base_store, struct bundl
         LOGF_ERROR("Bundle Store : Failed to create file %s (error %d)", path, errno);
     }
 
+    memory_budget_release(MEMORY_BUDGET_STORE, budget_bytes);
     free(path);
     return return_result;
 }
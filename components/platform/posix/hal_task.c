@@ -8,6 +8,7 @@
  */
 
 #include "ud3tn/common.h"
+#include "ud3tn/object_pool.h"
 
 #include "platform/hal_io.h"
 #include "platform/hal_task.h"
@@ -35,6 +36,8 @@ static void *execute_pthread_compat(void *task_description)
 
 	free(task_description);
 	task_function(task_parameter);
+	// Pass on the objects cached by this thread before it is gone.
+	object_pool_thread_flush();
 	return NULL;
 }
 
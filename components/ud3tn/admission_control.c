@@ -0,0 +1,500 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/admission_control.h"
+#include "ud3tn/bundle.h"
+#include "ud3tn/common.h"
+#include "ud3tn/eid_intern.h"
+#include "ud3tn/hashtable.h"
+#include "ud3tn/memory_budget.h"
+#include "ud3tn/result.h"
+
+#include "platform/hal_io.h"
+#include "platform/hal_semaphore.h"
+#include "platform/hal_types.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+static struct admission_control_config AC = {
+	.policy = ADMISSION_POLICY,
+	.max_backlog_bytes = ADMISSION_MAX_BACKLOG_BYTES,
+	.max_node_backlog_bytes = ADMISSION_MAX_NODE_BACKLOG_BYTES,
+	.low_priority_share = ADMISSION_LOW_PRIORITY_SHARE,
+	.normal_priority_share = ADMISSION_NORMAL_PRIORITY_SHARE,
+};
+
+// Protects all of the below as the module is used by all BP workers and
+// the agents' threads (to reject bundles at the source).
+static Semaphore_t ac_sem;
+static struct admission_control_stats stats;
+// node ID -> (uint64_t *) bytes pending forwarding to that node
+static struct hashtable node_backlog;
+
+// FIFO of bundles held back under ADMISSION_POLICY_DEFER, shared by all
+// owners to bound the overall number of held-back bundles
+static struct deferred_entry {
+	struct bundle *bundle;
+	uint8_t owner;
+} deferred[ADMISSION_DEFER_QUEUE_LENGTH];
+static size_t deferred_head, deferred_count;
+static size_t deferred_count_by_owner[ADMISSION_DEFER_OWNER_COUNT];
+// Bit masks of owners having held-back bundles, of owners whose bundles
+// should be retried as resources were freed, and of owners already woken up
+// for retrying them
+static uint64_t deferred_owners, retry_pending, retry_woken;
+
+static uint64_t owner_bit(const uint8_t owner)
+{
+	ASSERT(owner < ADMISSION_DEFER_OWNER_COUNT);
+	return (uint64_t)1 << owner;
+}
+
+// NOTE: Has to be called with ac_sem held.
+static void schedule_retry(void)
+{
+	__atomic_or_fetch(&retry_pending, deferred_owners, __ATOMIC_RELAXED);
+}
+
+static uint64_t get_accounted_length(const struct bundle *const bundle)
+{
+	if (!bundle->payload_block)
+		return 0;
+	return bundle->payload_block->length;
+}
+
+static uint64_t apply_share(const uint64_t limit, const uint8_t share)
+{
+	if (share >= 100)
+		return limit;
+	return limit / 100 * share + (limit % 100) * share / 100;
+}
+
+static uint64_t get_limit_for_priority(const uint64_t limit,
+				       const enum bundle_routing_priority prio)
+{
+	if (limit == 0 || AC.policy != ADMISSION_POLICY_DROP_LOWEST)
+		return limit;
+
+	switch (prio) {
+	case BUNDLE_RPRIO_LOW:
+		return apply_share(limit, AC.low_priority_share);
+	case BUNDLE_RPRIO_NORMAL:
+		return apply_share(limit, AC.normal_priority_share);
+	default:
+		return limit;
+	}
+}
+
+static bool exceeds_limit(const uint64_t used, const uint64_t length,
+			  const uint64_t limit)
+{
+	if (limit == 0)
+		return false;
+	return used > limit || length > limit - used;
+}
+
+static uint64_t *get_node_counter(const char *const node_id)
+{
+	if (!node_id)
+		return NULL;
+
+	const struct eid_intern_info *const info = eid_intern_get_info(node_id);
+
+	return hashtable_get_hashed(
+		&node_backlog,
+		node_id,
+		info->length,
+		info->hash
+	);
+}
+
+// NOTE: Has to be called with ac_sem held.
+static enum admission_decision decide(struct bundle *bundle,
+				      const char *const node_id)
+{
+	if (AC.policy == ADMISSION_POLICY_NONE)
+		return ADMISSION_ACCEPT;
+
+	const uint64_t length = get_accounted_length(bundle);
+	const enum bundle_routing_priority prio =
+		bundle_get_routing_priority(bundle);
+	const uint64_t *node_used = get_node_counter(node_id);
+
+	if (!exceeds_limit(
+			stats.backlog_bytes,
+			length,
+			get_limit_for_priority(AC.max_backlog_bytes, prio)) &&
+	    !exceeds_limit(
+			node_used ? *node_used : 0,
+			length,
+			get_limit_for_priority(AC.max_node_backlog_bytes, prio)))
+		return ADMISSION_ACCEPT;
+
+	if (AC.policy == ADMISSION_POLICY_DEFER)
+		return ADMISSION_DEFER;
+	return ADMISSION_REJECT;
+}
+
+// NOTE: Has to be called with ac_sem held.
+static bool get_drop_filter(struct bundle *bundle, const char *const node_id,
+			    struct admission_drop_filter *const filter)
+{
+	if (AC.policy != ADMISSION_POLICY_DROP_LOWEST)
+		return false;
+
+	const uint64_t length = get_accounted_length(bundle);
+	const enum bundle_routing_priority prio =
+		bundle_get_routing_priority(bundle);
+	const uint64_t limit = get_limit_for_priority(
+		AC.max_backlog_bytes,
+		prio
+	);
+	const uint64_t node_limit = get_limit_for_priority(
+		AC.max_node_backlog_bytes,
+		prio
+	);
+	const uint64_t *node_used = get_node_counter(node_id);
+	const bool node_exceeded = exceeds_limit(
+		node_used ? *node_used : 0,
+		length,
+		node_limit
+	);
+
+	// Nothing is of lower priority or the bundle exceeds a limit alone.
+	if (prio == BUNDLE_RPRIO_LOW ||
+	    exceeds_limit(0, length, limit) ||
+	    exceeds_limit(0, length, node_limit))
+		return false;
+	if (!node_exceeded &&
+	    !exceeds_limit(stats.backlog_bytes, length, limit))
+		return false;
+
+	filter->priority = prio;
+	// If the node limit is exceeded, only bundles to the node help.
+	filter->node_id = node_exceeded ? node_id : NULL;
+	return true;
+}
+
+enum ud3tn_result admission_control_init(void)
+{
+	if (ac_sem)
+		return UD3TN_OK;
+
+	ac_sem = hal_semaphore_init_binary();
+	if (!ac_sem)
+		return UD3TN_FAIL;
+	hashtable_init(&node_backlog, ADMISSION_HTAB_SLOT_COUNT);
+	memset(&stats, 0, sizeof(stats));
+	deferred_head = 0;
+	deferred_count = 0;
+	memset(deferred_count_by_owner, 0, sizeof(deferred_count_by_owner));
+	deferred_owners = 0;
+	retry_pending = 0;
+	retry_woken = 0;
+	hal_semaphore_release(ac_sem);
+	return UD3TN_OK;
+}
+
+void admission_control_free(void)
+{
+	if (!ac_sem)
+		return;
+
+	// NOTE: Held-back bundles are owned by the caller of
+	// admission_control_defer and have to be popped before.
+	ASSERT(deferred_count == 0);
+	hashtable_clear(&node_backlog, free);
+	hal_semaphore_delete(ac_sem);
+	ac_sem = NULL;
+}
+
+struct admission_control_config admission_control_get_config(void)
+{
+	return AC;
+}
+
+void admission_control_update_config(struct admission_control_config config)
+{
+	hal_semaphore_take_blocking(ac_sem);
+	AC = config;
+	// Limits may have been raised.
+	schedule_retry();
+	hal_semaphore_release(ac_sem);
+}
+
+enum admission_decision admission_control_check(struct bundle *bundle)
+{
+	if (AC.policy == ADMISSION_POLICY_NONE)
+		return ADMISSION_ACCEPT;
+
+	const char *const node_id = eid_intern_get_node_id(
+		bundle->destination
+	);
+
+	struct admission_drop_filter filter;
+
+	hal_semaphore_take_blocking(ac_sem);
+
+	enum admission_decision result = decide(bundle, node_id);
+
+	// The BP tries to make room, see admission_control_get_drop_filter().
+	if (result == ADMISSION_REJECT &&
+	    get_drop_filter(bundle, node_id, &filter))
+		result = ADMISSION_ACCEPT;
+
+	hal_semaphore_release(ac_sem);
+
+	return result;
+}
+
+bool admission_control_get_drop_filter(struct bundle *bundle,
+				       struct admission_drop_filter *filter)
+{
+	if (AC.policy != ADMISSION_POLICY_DROP_LOWEST)
+		return false;
+
+	const char *const node_id = eid_intern_get_node_id(
+		bundle->destination
+	);
+
+	hal_semaphore_take_blocking(ac_sem);
+
+	const bool result = get_drop_filter(bundle, node_id, filter);
+
+	hal_semaphore_release(ac_sem);
+
+	return result;
+}
+
+bool admission_control_drop_filter_matches(
+	const struct admission_drop_filter *filter, struct bundle *bundle)
+{
+	return (
+		bundle_get_routing_priority(bundle) < filter->priority &&
+		(!filter->node_id ||
+		 eid_intern_get_node_id(bundle->destination) ==
+			filter->node_id)
+	);
+}
+
+enum admission_decision admission_control_admit(struct bundle *bundle)
+{
+	const char *const node_id = eid_intern_get_node_id(
+		bundle->destination
+	);
+	const uint64_t length = get_accounted_length(bundle);
+
+	hal_semaphore_take_blocking(ac_sem);
+
+	const enum admission_decision result = decide(bundle, node_id);
+
+	if (result != ADMISSION_ACCEPT) {
+		// Deferred bundles are counted in admission_control_defer.
+		if (result == ADMISSION_REJECT) {
+			stats.rejected_bundles++;
+			stats.rejected_bytes += length;
+		}
+		hal_semaphore_release(ac_sem);
+		return result;
+	}
+
+	if (node_id) {
+		uint64_t *node_used = get_node_counter(node_id);
+
+		if (!node_used) {
+			node_used = malloc(sizeof(uint64_t));
+			if (node_used) {
+				*node_used = 0;
+				if (hashtable_add(&node_backlog, node_id,
+						  node_used) != UD3TN_OK) {
+					free(node_used);
+					node_used = NULL;
+				}
+			}
+		}
+		// NOTE: If no memory is left for the counter, the bundle is
+		// still accounted for globally.
+		if (node_used)
+			*node_used += length;
+	}
+	stats.backlog_bytes += length;
+	stats.backlog_bytes_by_priority[bundle_get_routing_priority(bundle)] +=
+		length;
+	stats.admitted_bundles++;
+	stats.admitted_bytes += length;
+
+	hal_semaphore_release(ac_sem);
+
+	memory_budget_charge(MEMORY_BUDGET_FORWARDING, length);
+
+	return ADMISSION_ACCEPT;
+}
+
+static void sub_clamped(uint64_t *const value, const uint64_t length)
+{
+	*value = (*value > length) ? *value - length : 0;
+}
+
+void admission_control_release(struct bundle *bundle)
+{
+	const char *const node_id = eid_intern_get_node_id(
+		bundle->destination
+	);
+	const uint64_t length = get_accounted_length(bundle);
+
+	hal_semaphore_take_blocking(ac_sem);
+
+	uint64_t *const node_used = get_node_counter(node_id);
+
+	if (node_used) {
+		sub_clamped(node_used, length);
+		if (*node_used == 0)
+			free(hashtable_remove(&node_backlog, node_id));
+	}
+	sub_clamped(&stats.backlog_bytes, length);
+	sub_clamped(
+		&stats.backlog_bytes_by_priority[
+			bundle_get_routing_priority(bundle)
+		],
+		length
+	);
+	schedule_retry();
+
+	hal_semaphore_release(ac_sem);
+
+	memory_budget_release(MEMORY_BUDGET_FORWARDING, length);
+}
+
+// NOTE: Has to be called with ac_sem held.
+static enum ud3tn_result append_deferred(struct bundle *bundle,
+					 const uint8_t owner)
+{
+	if (deferred_count >= ADMISSION_DEFER_QUEUE_LENGTH)
+		return UD3TN_FAIL;
+
+	deferred[(deferred_head + deferred_count) %
+		 ADMISSION_DEFER_QUEUE_LENGTH] = (struct deferred_entry){
+		.bundle = bundle,
+		.owner = owner,
+	};
+	deferred_owners |= owner_bit(owner);
+	deferred_count++;
+	deferred_count_by_owner[owner]++;
+	stats.deferred_bundles++;
+	stats.deferred_bytes += get_accounted_length(bundle);
+	return UD3TN_OK;
+}
+
+enum ud3tn_result admission_control_defer(struct bundle *bundle,
+					  const uint8_t owner)
+{
+	enum ud3tn_result result = UD3TN_FAIL;
+
+	hal_semaphore_take_blocking(ac_sem);
+	if (AC.policy == ADMISSION_POLICY_DEFER)
+		result = append_deferred(bundle, owner);
+	if (result != UD3TN_OK) {
+		stats.rejected_bundles++;
+		stats.rejected_bytes += get_accounted_length(bundle);
+	}
+	hal_semaphore_release(ac_sem);
+
+	return result;
+}
+
+enum ud3tn_result admission_control_defer_admitted(struct bundle *bundle,
+						   const uint8_t owner)
+{
+	hal_semaphore_take_blocking(ac_sem);
+
+	const enum ud3tn_result result = append_deferred(bundle, owner);
+
+	hal_semaphore_release(ac_sem);
+
+	return result;
+}
+
+void admission_control_notify_capacity(void)
+{
+	hal_semaphore_take_blocking(ac_sem);
+	schedule_retry();
+	hal_semaphore_release(ac_sem);
+}
+
+size_t admission_control_get_retry_count(const uint8_t owner)
+{
+	const uint64_t bit = owner_bit(owner);
+	size_t result = 0;
+
+	// NOTE: Cheap check without the lock, a missed update is caught on
+	// the next call.
+	if (!(__atomic_load_n(&retry_pending, __ATOMIC_RELAXED) & bit))
+		return 0;
+
+	hal_semaphore_take_blocking(ac_sem);
+	if (retry_pending & bit) {
+		result = deferred_count_by_owner[owner];
+		__atomic_and_fetch(&retry_pending, ~bit, __ATOMIC_RELAXED);
+		__atomic_and_fetch(&retry_woken, ~bit, __ATOMIC_RELAXED);
+	}
+	hal_semaphore_release(ac_sem);
+
+	return result;
+}
+
+bool admission_control_claim_retry_wakeup(const uint8_t owner)
+{
+	const uint64_t bit = owner_bit(owner);
+
+	if (!(__atomic_load_n(&retry_pending, __ATOMIC_RELAXED) & bit))
+		return false;
+	return !(__atomic_fetch_or(&retry_woken, bit, __ATOMIC_RELAXED) & bit);
+}
+
+struct bundle *admission_control_pop_deferred(const uint8_t owner)
+{
+	const uint64_t bit = owner_bit(owner);
+	struct bundle *result = NULL;
+
+	hal_semaphore_take_blocking(ac_sem);
+	if (!(deferred_owners & bit)) {
+		hal_semaphore_release(ac_sem);
+		return NULL;
+	}
+
+	// Find the oldest entry of the owner and close the gap, keeping the
+	// order of all others. The backlog is short, thus, a scan is fine.
+	for (size_t i = 0; i < deferred_count; i++) {
+		const size_t slot = (deferred_head + i) %
+			ADMISSION_DEFER_QUEUE_LENGTH;
+
+		if (result) {
+			deferred[(slot + ADMISSION_DEFER_QUEUE_LENGTH - 1) %
+				 ADMISSION_DEFER_QUEUE_LENGTH] = deferred[slot];
+		} else if (deferred[slot].owner == owner) {
+			result = deferred[slot].bundle;
+		}
+	}
+	ASSERT(result != NULL);
+	deferred_count--;
+	deferred[(deferred_head + deferred_count) %
+		 ADMISSION_DEFER_QUEUE_LENGTH] = (struct deferred_entry){ 0 };
+	if (--deferred_count_by_owner[owner] == 0)
+		deferred_owners &= ~bit;
+	hal_semaphore_release(ac_sem);
+
+	return result;
+}
+
+struct admission_control_stats admission_control_get_stats(void)
+{
+	struct admission_control_stats result;
+
+	hal_semaphore_take_blocking(ac_sem);
+	result = stats;
+	hal_semaphore_release(ac_sem);
+
+	return result;
+}
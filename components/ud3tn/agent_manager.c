@@ -9,6 +9,7 @@
 #include "archipel-core/bundle_restore.h"
 
 #include "platform/hal_io.h"
+#include "platform/hal_semaphore.h"
 
 #include <stdbool.h>
 #include <stddef.h>
@@ -19,8 +20,8 @@ static struct agent *agent_search(struct agent_list **al_ptr,
 				  const char *sink_identifier);
 static int agent_list_add_entry(struct agent_list **al_ptr,
 				struct agent obj);
-static int agent_list_remove_entry(struct agent_list **al_ptr,
-				   const char *sink_identifier);
+static struct agent_list *agent_list_remove_entry(
+	struct agent_list **al_ptr, const char *sink_identifier);
 static struct agent_list **agent_search_ptr(struct agent_list **al_ptr,
 					    const char *sink_identifier);
 
@@ -29,10 +30,27 @@ static struct agent_list *rpc_ag_entry_node;
 static const char *local_eid;
 static QueueIdentifier_t bundle_restore_queue;
 
+// Protects the agent lists against concurrent access from multiple BP
+// workers. It is never held while invoking an agent's callback.
+static Semaphore_t agent_list_sem;
+
+static void agent_list_lock(void)
+{
+	hal_semaphore_take_blocking(agent_list_sem);
+}
+
+static void agent_list_unlock(void)
+{
+	hal_semaphore_release(agent_list_sem);
+}
+
 void agent_manager_init(const char *const ud3tn_local_eid, QueueIdentifier_t restore_queue)
 {
 	local_eid = ud3tn_local_eid;
 	bundle_restore_queue = restore_queue;
+	agent_list_sem = hal_semaphore_init_binary();
+	ASSERT(agent_list_sem != NULL);
+	hal_semaphore_release(agent_list_sem);
 }
 
 int agent_register(struct agent agent, const bool is_subscriber)
@@ -54,8 +72,11 @@ int agent_register(struct agent agent, const bool is_subscriber)
 		return -1;
 	}
 
+	agent_list_lock();
+
 	/* check if agent with that sink_id is already existing */
 	if (agent_search(al_ptr, agent.sink_identifier) != NULL) {
+		agent_list_unlock();
 		LOGF_WARN(
 			"AgentManager: Agent with sink_id %s is already registered!",
 			agent.sink_identifier
@@ -67,6 +88,7 @@ int agent_register(struct agent agent, const bool is_subscriber)
 
 	if (ag_ex && agent.secret != ag_ex->secret &&
 	    strcmp(agent.secret, ag_ex->secret) != 0) {
+		agent_list_unlock();
 		LOGF_WARN(
 			"AgentManager: Invalid secret provided for sink_id %s!",
 			agent.sink_identifier
@@ -74,7 +96,10 @@ int agent_register(struct agent agent, const bool is_subscriber)
 		return -1;
 	}
 
-	if (agent_list_add_entry(al_ptr, agent)) // adding failed
+	const int add_result = agent_list_add_entry(al_ptr, agent);
+
+	agent_list_unlock();
+	if (add_result) // adding failed
 		return -1;
 
 	LOGF_INFO(
@@ -92,15 +117,16 @@ int agent_deregister(const char *sink_identifier, const bool is_subscriber)
 	struct agent_list **const al_ptr = (
 		is_subscriber ? &agent_entry_node : &rpc_ag_entry_node
 	);
-	struct agent *ag_ptr;
+	struct agent_list *entry;
+	Semaphore_t released = NULL;
 
-	ag_ptr = agent_search(
-		al_ptr,
-		sink_identifier
-	);
+	agent_list_lock();
+
+	entry = agent_list_remove_entry(al_ptr, sink_identifier);
 
 	/* check if agent with that sink_id is not existing */
-	if (ag_ptr == NULL) {
+	if (entry == NULL) {
+		agent_list_unlock();
 		LOGF_WARN(
 			"AgentManager: Agent with sink_id %s is not registered!",
 			sink_identifier
@@ -108,22 +134,47 @@ int agent_deregister(const char *sink_identifier, const bool is_subscriber)
 		return -1;
 	}
 
-	if (agent_list_remove_entry(al_ptr, sink_identifier))
-		return -1;
+	// The entry cannot be found anymore, but callbacks that are already
+	// in progress still use the agent's parameters, which are freed by
+	// the agent after it has been deregistered.
+	if (entry->ref_count != 0) {
+		released = hal_semaphore_init_binary();
+		ASSERT(released != NULL);
+		entry->released = released;
+	}
+	agent_list_unlock();
+
+	if (released) {
+		hal_semaphore_take_blocking(released);
+		hal_semaphore_delete(released);
+	}
+	free(entry);
 
 	return 0;
 }
 
 bool is_agent_available(const char *agent_id) {
-	return agent_search(&agent_entry_node, agent_id) != NULL;
+	agent_list_lock();
+
+	const bool result = agent_search(&agent_entry_node, agent_id) != NULL;
+
+	agent_list_unlock();
+	return result;
 }
 
 int agent_forward(const char *sink_identifier, struct bundle_adu data,
 		  const void *bp_context)
 {
-	struct agent *ag_ptr = agent_search(&agent_entry_node, sink_identifier);
+	agent_list_lock();
 
-	if (ag_ptr == NULL) {
+	struct agent_list **const entry_ptr = agent_search_ptr(
+		&agent_entry_node,
+		sink_identifier
+	);
+	struct agent_list *const entry = entry_ptr ? *entry_ptr : NULL;
+
+	if (entry == NULL) {
+		agent_list_unlock();
 		LOGF_WARN(
 			"AgentManager: No agent registered for identifier \"%s\"!",
 			sink_identifier
@@ -132,7 +183,8 @@ int agent_forward(const char *sink_identifier, struct bundle_adu data,
 		return -1;
 	}
 
-	if (ag_ptr->callback == NULL) {
+	if (entry->agent_data.callback == NULL) {
+		agent_list_unlock();
 		LOGF_ERROR(
 			"AgentManager: Agent \"%s\" registered, but invalid (null) callback function!",
 			sink_identifier
@@ -140,7 +192,19 @@ int agent_forward(const char *sink_identifier, struct bundle_adu data,
 		bundle_adu_free_members(data);
 		return -1;
 	}
-	ag_ptr->callback(data, ag_ptr->param, bp_context);
+
+	// The callback may block, e.g. if an application does not read the
+	// bundles it receives, so it is invoked without holding the lock.
+	// The reference keeps the entry valid until it returns.
+	entry->ref_count++;
+	agent_list_unlock();
+
+	entry->agent_data.callback(data, entry->agent_data.param, bp_context);
+
+	agent_list_lock();
+	if (--entry->ref_count == 0 && entry->released)
+		hal_semaphore_release(entry->released);
+	agent_list_unlock();
 
 	return 0;
 }
@@ -185,6 +249,8 @@ static int agent_list_add_entry(struct agent_list **al_ptr, struct agent obj)
 
 	ag_ptr->next = NULL;
 	ag_ptr->agent_data = obj;
+	ag_ptr->ref_count = 0;
+	ag_ptr->released = NULL;
 
 	/* check if agent list is empty */
 	if (*al_ptr == NULL) {
@@ -216,19 +282,19 @@ static int agent_list_add_entry(struct agent_list **al_ptr, struct agent obj)
 	}
 }
 
-static int agent_list_remove_entry(struct agent_list **al_ptr,
-				   const char *sink_identifier)
+// Unlinks the entry, which has to be freed by the caller.
+static struct agent_list *agent_list_remove_entry(
+	struct agent_list **al_ptr, const char *sink_identifier)
 {
 	al_ptr = agent_search_ptr(al_ptr, sink_identifier);
-	struct agent_list *next_element;
+	struct agent_list *element;
 
-	if (!*al_ptr)
+	if (!al_ptr)
 		/* entry not existing --> no removal necessary */
-		return -1;
+		return NULL;
 
 	/* perform the removal while keeping the proper pointer value */
-	next_element = (*al_ptr)->next;
-	free(*al_ptr);
-	*al_ptr = next_element;
-	return 0;
+	element = *al_ptr;
+	*al_ptr = element->next;
+	return element;
 }
@@ -1,6 +1,8 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
 #include "bundle6/create.h"
+#include "bundle7/bundle7.h"
 #include "bundle7/create.h"
+#include "bundle7/profile.h"
 
 #include "ud3tn/agent_util.h"
 #include "ud3tn/common.h"
@@ -13,20 +15,15 @@
 #include <stdlib.h>
 #include <string.h>
 
-struct bundle *agent_create_bundle(const uint8_t bp_version,
-	const char *local_eid, char *sink_id, char *destination,
-	const uint64_t creation_timestamp_ms, const uint64_t sequence_number,
-	const uint64_t lifetime_ms, void *payload, size_t payload_length,
-	enum bundle_proc_flags flags)
+// Returns the EID of the given sink of the local node, which has to be freed.
+static char *create_source_eid(const char *local_eid, const char *sink_id)
 {
 	const size_t local_eid_length = strlen(local_eid);
 	const size_t sink_length = strlen(sink_id);
 	char *source_eid = malloc(local_eid_length + sink_length + 2);
 
-	if (source_eid == NULL) {
-		free(payload);
+	if (source_eid == NULL)
 		return NULL;
-	}
 
 	memcpy(source_eid, local_eid, local_eid_length + 1); // include '\0'
 	if (get_eid_scheme(source_eid) == EID_SCHEME_IPN) {
@@ -34,7 +31,6 @@ struct bundle *agent_create_bundle(const uint8_t bp_version,
 
 		if (!dot) {
 			free(source_eid);
-			free(payload);
 			return NULL;
 		}
 		memcpy(&dot[1], sink_id, sink_length + 1);
@@ -43,6 +39,51 @@ struct bundle *agent_create_bundle(const uint8_t bp_version,
 		       sink_id, sink_length + 1);
 	}
 
+	return source_eid;
+}
+
+struct bundle7_profile *agent_create_profile(const char *local_eid,
+	const char *sink_id, const uint64_t lifetime_ms)
+{
+	char *const source_eid = create_source_eid(local_eid, sink_id);
+
+	if (source_eid == NULL)
+		return NULL;
+
+	// The same bundles as created by bundle7_create_local().
+	struct bundle7_profile *const profile = bundle7_profile_create(
+		source_eid,
+		"dtn:none",
+		lifetime_ms,
+		DEFAULT_BPV7_CRC_TYPE,
+		BUNDLE7_PROFILE_BLOCKS_NONE,
+		0
+	);
+
+	free(source_eid);
+
+	return profile;
+}
+
+struct bundle *agent_create_bundle(const uint8_t bp_version,
+	struct bundle7_profile *profile,
+	const char *local_eid, char *sink_id, const char *destination,
+	const uint64_t creation_timestamp_ms, const uint64_t sequence_number,
+	const uint64_t lifetime_ms, void *payload, size_t payload_length,
+	enum bundle_proc_flags flags)
+{
+	if (bp_version == 7 && profile != NULL)
+		return bundle7_profile_create_bundle(
+			profile, payload, payload_length, destination,
+			creation_timestamp_ms, sequence_number, flags);
+
+	char *const source_eid = create_source_eid(local_eid, sink_id);
+
+	if (source_eid == NULL) {
+		free(payload);
+		return NULL;
+	}
+
 	struct bundle *result;
 
 	if (bp_version == 6)
@@ -63,13 +104,15 @@ struct bundle *agent_create_bundle(const uint8_t bp_version,
 
 struct bundle *agent_create_forward_bundle(
 	const struct bundle_agent_interface *bundle_agent_interface,
-	const uint8_t bp_version, char *sink_id, char *destination,
+	const uint8_t bp_version, struct bundle7_profile *profile,
+	char *sink_id, const char *destination,
 	const uint64_t creation_timestamp_ms, const uint64_t sequence_number,
 	const uint64_t lifetime_ms, void *payload, size_t payload_length,
 	enum bundle_proc_flags flags)
 {
 	struct bundle *bundle = agent_create_bundle(
 		bp_version,
+		profile,
 		bundle_agent_interface->local_eid,
 		sink_id,
 		destination,
@@ -98,13 +141,15 @@ struct bundle *agent_create_forward_bundle(
 struct bundle *agent_create_forward_bundle_direct(
 	const struct bp_context *bundle_processor_context,
 	const char *local_eid,
-	const uint8_t bp_version, char *sink_id, char *destination,
+	const uint8_t bp_version, struct bundle7_profile *profile,
+	char *sink_id, const char *destination,
 	const uint64_t creation_timestamp_s, const uint64_t sequence_number,
 	const uint64_t lifetime, void *payload, size_t payload_length,
 	enum bundle_proc_flags flags)
 {
 	struct bundle *bundle = agent_create_bundle(
 		bp_version,
+		profile,
 		local_eid,
 		sink_id,
 		destination,
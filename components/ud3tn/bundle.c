@@ -1,6 +1,8 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
 #include "ud3tn/bundle.h"
 #include "ud3tn/common.h"
+#include "ud3tn/eid_intern.h"
+#include "ud3tn/siphash.h"
 
 // RFC 5050
 #include "bundle6/bundle6.h"
@@ -10,6 +12,7 @@
 #include "bundle7/bundle7.h"
 #include "bundle7/bundle_age.h"
 #include "bundle7/eid.h"
+#include "bundle7/profile.h"
 #include "bundle7/serializer.h"
 
 #include <stdint.h>
@@ -17,6 +20,12 @@
 #include <string.h>
 #include <inttypes.h>
 
+struct object_pool bundle_pool =
+	OBJECT_POOL_INITIALIZER("bundle", struct bundle);
+struct object_pool bundle_block_pool =
+	OBJECT_POOL_INITIALIZER("bundle_block", struct bundle_block);
+struct object_pool bundle_block_list_pool =
+	OBJECT_POOL_INITIALIZER("bundle_block_list", struct bundle_block_list);
 
 static inline void bundle_reset_internal(struct bundle *bundle)
 {
@@ -40,6 +49,11 @@ static inline void bundle_reset_internal(struct bundle *bundle)
 	bundle->fragment_offset = 0;
 	bundle->total_adu_length = 0;
 	bundle->primary_block_length = 0;
+	bundle->serialized_size = 0;
+	bundle->encoded_primary_block = NULL;
+	bundle->block_type_filter = 0;
+	bundle->id = (struct bundle_id){ 0, 0 };
+	bundle->profile = NULL;
 	bundle->blocks = NULL;
 	bundle->payload_block = NULL;
 }
@@ -48,7 +62,7 @@ struct bundle *bundle_init(void)
 {
 	struct bundle *bundle;
 
-	bundle = malloc(sizeof(struct bundle));
+	bundle = object_pool_alloc(&bundle_pool);
 	bundle_reset_internal(bundle);
 	return bundle;
 }
@@ -59,10 +73,13 @@ inline void bundle_free_dynamic_parts(struct bundle *bundle)
 		return;
 
 	// EIDs
-	free(bundle->destination);
-	free(bundle->source);
-	free(bundle->report_to);
-	free(bundle->current_custodian);
+	eid_intern_release(bundle->destination);
+	eid_intern_release(bundle->source);
+	eid_intern_release(bundle->report_to);
+	eid_intern_release(bundle->current_custodian);
+
+	free(bundle->encoded_primary_block);
+	bundle7_profile_unref(bundle->profile);
 
 	while (bundle->blocks != NULL)
 		bundle->blocks = bundle_block_entry_free(bundle->blocks);
@@ -79,7 +96,7 @@ void bundle_free(struct bundle *bundle)
 	if (bundle == NULL)
 		return;
 	bundle_free_dynamic_parts(bundle);
-	free(bundle);
+	object_pool_free(&bundle_pool, bundle);
 }
 
 void bundle_drop(struct bundle *bundle)
@@ -93,22 +110,28 @@ void bundle_copy_headers(struct bundle *to, const struct bundle *from)
 	memcpy(to, from, sizeof(struct bundle));
 
 	// Increase EID reference counters
-	if (to->destination != NULL)
-		to->destination = strdup(to->destination);
-	if (to->source != NULL)
-		to->source = strdup(to->source);
-	if (to->report_to != NULL)
-		to->report_to = strdup(to->report_to);
-	if (to->current_custodian != NULL)
-		to->current_custodian = strdup(to->current_custodian);
+	eid_intern_ref(to->destination);
+	eid_intern_ref(to->source);
+	eid_intern_ref(to->report_to);
+	eid_intern_ref(to->current_custodian);
+	bundle7_profile_ref(to->profile);
 
 	// No extension blocks are copied
 	to->blocks = NULL;
 	to->payload_block = NULL;
+	to->serialized_size = 0;
+	to->encoded_primary_block = NULL;
+	to->block_type_filter = 0;
+	to->id = (struct bundle_id){ 0, 0 };
 }
 
 enum ud3tn_result bundle_recalculate_header_length(struct bundle *bundle)
 {
+	free(bundle->encoded_primary_block);
+	bundle->encoded_primary_block = NULL;
+	bundle->id = (struct bundle_id){ 0, 0 };
+	bundle_invalidate_block_caches(bundle);
+
 	switch (bundle->protocol_version) {
 	// RFC 5050
 	case 6:
@@ -133,20 +156,21 @@ struct bundle *bundle_dup(const struct bundle *bundle)
 	if (!bundle)
 		return NULL;
 
-	dup = malloc(sizeof(struct bundle));
+	dup = object_pool_alloc(&bundle_pool);
 	if (dup == NULL)
 		return NULL;
 	memcpy(dup, bundle, sizeof(struct bundle));
 
-	// Allocate new EID references
-	if (dup->source)
-		dup->source = strdup(dup->source);
-	if (dup->destination)
-		dup->destination = strdup(dup->destination);
-	if (dup->report_to)
-		dup->report_to = strdup(dup->report_to);
-	if (dup->current_custodian)
-		dup->current_custodian = strdup(dup->current_custodian);
+	// Obtain new EID references
+	eid_intern_ref(dup->source);
+	eid_intern_ref(dup->destination);
+	eid_intern_ref(dup->report_to);
+	eid_intern_ref(dup->current_custodian);
+	bundle7_profile_ref(dup->profile);
+
+	// The serialized size is retained, the encoded primary block is not
+	// shared to keep the ownership simple.
+	dup->encoded_primary_block = NULL;
 
 	// Duplicate extension blocks
 	dup->blocks = bundle_block_list_dup(bundle->blocks);
@@ -190,16 +214,22 @@ enum bundle_routing_priority bundle_get_routing_priority(
 
 size_t bundle_get_serialized_size(struct bundle *bundle)
 {
+	if (bundle->serialized_size != 0)
+		return bundle->serialized_size;
+
 	switch (bundle->protocol_version) {
 	// RFC 5050
 	case 6:
-		return bundle6_get_serialized_size(bundle);
+		bundle->serialized_size = bundle6_get_serialized_size(bundle);
+		break;
 	// BPv7-bis
 	case 7:
-		return bundle7_get_serialized_size(bundle);
+		bundle->serialized_size = bundle7_get_serialized_size(bundle);
+		break;
 	default:
 		return 0;
 	}
+	return bundle->serialized_size;
 }
 
 struct bundle_list *bundle_list_entry_create(struct bundle *bundle)
@@ -242,10 +272,29 @@ struct bundle_block *bundle_block_find_first_by_type(
 	return NULL;
 }
 
+bool bundle_has_block_type(struct bundle *bundle, enum bundle_block_type type)
+{
+	if (bundle->block_type_filter == 0) {
+		struct bundle_block_list *e;
+
+		for (e = bundle->blocks; e != NULL; e = e->next)
+			bundle->block_type_filter |= 1UL << (e->data->type % 32);
+	}
+	return (bundle->block_type_filter & (1UL << (type % 32))) != 0;
+}
+
+struct bundle_block *bundle_find_block(
+	struct bundle *bundle, enum bundle_block_type type)
+{
+	if (!bundle_has_block_type(bundle, type))
+		return NULL;
+	return bundle_block_find_first_by_type(bundle->blocks, type);
+}
+
 
 struct bundle_block *bundle_block_create(enum bundle_block_type t)
 {
-	struct bundle_block *block = malloc(sizeof(struct bundle_block));
+	struct bundle_block *block = object_pool_alloc(&bundle_block_pool);
 
 	if (block == NULL)
 		return NULL;
@@ -254,8 +303,11 @@ struct bundle_block *bundle_block_create(enum bundle_block_type t)
 	block->flags = BUNDLE_BLOCK_FLAG_NONE;
 	block->eid_refs = NULL;
 	block->crc_type = BUNDLE_CRC_TYPE_NONE;
+	block->crc_pending = false;
 	block->length = 0;
 	block->data = NULL;
+	block->buffer = NULL;
+	block->list_entry_in_use = false;
 	return block;
 }
 
@@ -265,9 +317,14 @@ struct bundle_block_list *bundle_block_entry_create(struct bundle_block *b)
 
 	if (b == NULL)
 		return NULL;
-	entry = malloc(sizeof(struct bundle_block_list));
-	if (entry == NULL)
-		return NULL;
+	if (!b->list_entry_in_use) {
+		entry = &b->list_entry;
+		b->list_entry_in_use = true;
+	} else {
+		entry = object_pool_alloc(&bundle_block_list_pool);
+		if (entry == NULL)
+			return NULL;
+	}
 	entry->data = b;
 	entry->next = NULL;
 	return entry;
@@ -276,23 +333,36 @@ struct bundle_block_list *bundle_block_entry_create(struct bundle_block *b)
 void bundle_block_free(struct bundle_block *b)
 {
 	if (b != NULL) {
-		if (b->eid_refs != NULL)
+		while (b->eid_refs != NULL) {
+			struct endpoint_list *const next = b->eid_refs->next;
+
+			free(b->eid_refs->eid);
 			free(b->eid_refs);
-		if (b->data != NULL)
+			b->eid_refs = next;
+		}
+		if (b->buffer != NULL)
+			shared_buffer_unref(b->buffer);
+		else if (b->data != NULL)
 			free(b->data);
-		free(b);
+		object_pool_free(&bundle_block_pool, b);
 	}
 }
 
 struct bundle_block_list *bundle_block_entry_free(struct bundle_block_list *e)
 {
 	struct bundle_block_list *next;
+	struct bundle_block *block;
 
 	if (!e)
 		return NULL;
 	next = e->next;
-	bundle_block_free(e->data);
-	free(e);
+	block = e->data;
+	// The entry is released together with the block if it is embedded.
+	if (block != NULL && e == &block->list_entry)
+		block->list_entry_in_use = false;
+	else
+		object_pool_free(&bundle_block_list_pool, e);
+	bundle_block_free(block);
 	return next;
 }
 
@@ -302,10 +372,11 @@ struct bundle_block *bundle_block_dup(struct bundle_block *b)
 
 	if (!b)
 		return NULL;
-	dup = malloc(sizeof(struct bundle_block));
+	dup = object_pool_alloc(&bundle_block_pool);
 	if (dup == NULL)
 		return NULL;
 	memcpy(dup, b, sizeof(struct bundle_block));
+	dup->list_entry_in_use = false;
 
 	const struct endpoint_list *cur_ref = b->eid_refs;
 
@@ -320,15 +391,50 @@ struct bundle_block *bundle_block_dup(struct bundle_block *b)
 		cur_ref = cur_ref->next;
 	}
 
-	dup->data = malloc(b->length);
-	if (dup->data == NULL)
-		goto err;
-	memcpy(dup->data, b->data, b->length);
+	// Shared data is immutable, let the duplicate reference it.
+	if (bundle_block_make_shared(b) != UD3TN_OK) {
+		dup->data = NULL;
+		bundle_block_free(dup);
+		return NULL;
+	}
+	dup->buffer = shared_buffer_ref(b->buffer);
 	return dup;
+}
 
-err:
-	bundle_block_free(dup);
-	return NULL;
+enum ud3tn_result bundle_block_make_shared(struct bundle_block *b)
+{
+	if (b->buffer != NULL)
+		return UD3TN_OK;
+	b->buffer = shared_buffer_wrap(b->data, b->length);
+	return b->buffer != NULL ? UD3TN_OK : UD3TN_FAIL;
+}
+
+enum ud3tn_result bundle_block_share_slice(
+	struct bundle_block *target, struct bundle_block *source,
+	uint32_t offset, uint32_t length)
+{
+	ASSERT(target->buffer == NULL && target->data == NULL);
+	ASSERT(offset <= source->length && length <= source->length - offset);
+	if (bundle_block_make_shared(source) != UD3TN_OK)
+		return UD3TN_FAIL;
+	target->buffer = shared_buffer_ref(source->buffer);
+	target->data = source->data + offset;
+	target->length = length;
+	return UD3TN_OK;
+}
+
+void bundle_block_replace_data(
+	struct bundle_block *b, uint8_t *data, uint32_t length)
+{
+	if (b->buffer != NULL)
+		shared_buffer_unref(b->buffer);
+	else
+		free(b->data);
+	b->buffer = NULL;
+	b->data = data;
+	b->length = length;
+	// The CRC is calculated for the new data when serializing the block.
+	b->crc_pending = false;
 }
 
 struct bundle_block_list *bundle_block_entry_dup(struct bundle_block_list *e)
@@ -384,6 +490,137 @@ enum ud3tn_result bundle_serialize(
 	return UD3TN_OK;
 }
 
+void bundle_iov_init(struct bundle_iov *iov)
+{
+	iov->iov = NULL;
+	iov->iov_count = 0;
+	iov->length = 0;
+	iov->entries = NULL;
+	iov->entries_capacity = 0;
+	iov->scratch = NULL;
+	iov->scratch_length = 0;
+	iov->scratch_capacity = 0;
+	iov->overflow = false;
+}
+
+void bundle_iov_free(struct bundle_iov *iov)
+{
+	free(iov->entries);
+	free(iov->scratch);
+	bundle_iov_init(iov);
+}
+
+// Append a reference to the data, merging it with the previous entry if the
+// data directly follows it (as do the pieces placed in the scratch buffer).
+static void iov_append(struct bundle_iov *out, const void *data,
+		       const size_t length)
+{
+	struct iovec *const last = (
+		out->iov_count != 0 ? &out->iov[out->iov_count - 1] : NULL
+	);
+
+	if (length == 0)
+		return;
+	out->length += length;
+	if (last && (const uint8_t *)last->iov_base + last->iov_len == data) {
+		last->iov_len += length;
+		return;
+	}
+	if (BUNDLE_IOV_HEADROOM + out->iov_count == out->entries_capacity) {
+		out->overflow = true;
+		return;
+	}
+	out->iov[out->iov_count++] = (struct iovec) {
+		.iov_base = (void *)data,
+		.iov_len = length,
+	};
+}
+
+static void iov_write_copy(void *obj, const void *data, const size_t length)
+{
+	struct bundle_iov *const out = obj;
+
+	if (length > out->scratch_capacity - out->scratch_length) {
+		out->overflow = true;
+		return;
+	}
+	memcpy(out->scratch + out->scratch_length, data, length);
+	iov_append(out, out->scratch + out->scratch_length, length);
+	out->scratch_length += length;
+}
+
+static void iov_write_ref(void *obj, const void *data, const size_t length)
+{
+	iov_append(obj, data, length);
+}
+
+// Grow the buffer to hold at least the given number of elements.
+static enum ud3tn_result iov_reserve(void **buffer, size_t *capacity,
+				     const size_t count, const size_t size)
+{
+	void *resized;
+
+	if (count <= *capacity)
+		return UD3TN_OK;
+	resized = realloc(*buffer, count * size);
+	if (resized == NULL)
+		return UD3TN_FAIL;
+	*buffer = resized;
+	*capacity = count;
+	return UD3TN_OK;
+}
+
+enum ud3tn_result bundle_serialize_iov(
+	struct bundle *bundle, struct bundle_iov *iov)
+{
+	const size_t size = bundle_get_serialized_size(bundle);
+	size_t referenced = 0, blocks = 0;
+	enum ud3tn_result result;
+
+	for (struct bundle_block_list *e = bundle->blocks; e; e = e->next) {
+		referenced += e->data->length;
+		blocks++;
+	}
+	if (size == 0 || referenced > size)
+		return UD3TN_FAIL;
+
+	// Everything but the block data is copied into the scratch buffer,
+	// which must not be moved after the first entry references it. Every
+	// block needs at most two entries (header and data), plus the bundle
+	// header and trailer and the primary block.
+	if (iov_reserve((void **)&iov->entries, &iov->entries_capacity,
+			BUNDLE_IOV_HEADROOM + 2 * blocks + 3,
+			sizeof(struct iovec)) != UD3TN_OK ||
+	    iov_reserve((void **)&iov->scratch, &iov->scratch_capacity,
+			size - referenced, 1) != UD3TN_OK)
+		return UD3TN_FAIL;
+
+	iov->iov = iov->entries + BUNDLE_IOV_HEADROOM;
+	iov->iov_count = 0;
+	iov->length = 0;
+	iov->scratch_length = 0;
+	iov->overflow = false;
+
+	switch (bundle->protocol_version) {
+	// RFC 5050
+	case 6:
+		result = bundle6_serialize_ref(bundle, iov_write_copy,
+					       iov_write_ref, iov);
+		break;
+	// BPv7
+	case 7:
+		result = bundle7_serialize_ref(bundle, iov_write_copy,
+					       iov_write_ref, iov);
+		break;
+	default:
+		return UD3TN_FAIL;
+	}
+
+	if (result != UD3TN_OK || iov->overflow || iov->length != size)
+		return UD3TN_FAIL;
+	return UD3TN_OK;
+}
+
 size_t bundle_get_first_fragment_min_size(struct bundle *bundle)
 {
 	switch (bundle->protocol_version) {
@@ -471,8 +708,8 @@ enum ud3tn_result bundle_age_update(struct bundle *bundle,
 	const uint64_t dwell_time_ms)
 {
 	uint64_t bundle_age;
-	struct bundle_block *block = bundle_block_find_first_by_type(
-		bundle->blocks, BUNDLE_BLOCK_TYPE_BUNDLE_AGE);
+	struct bundle_block *block = bundle_find_block(
+		bundle, BUNDLE_BLOCK_TYPE_BUNDLE_AGE);
 
 	// No Age Block found that needs to be updated
 	if (block == NULL)
@@ -489,51 +726,69 @@ enum ud3tn_result bundle_age_update(struct bundle *bundle,
 	if (buffer == NULL)
 		return UD3TN_FAIL;
 
-	free(block->data);
-	block->data = buffer;
-	block->length = bundle_age_serialize(bundle_age, buffer,
-		BUNDLE_AGE_MAX_ENCODED_SIZE);
+	bundle_block_replace_data(block, buffer, bundle_age_serialize(
+		bundle_age, buffer, BUNDLE_AGE_MAX_ENCODED_SIZE));
+	bundle_invalidate_block_caches(bundle);
 
 	return UD3TN_OK;
 }
 
-struct bundle_unique_identifier bundle_get_unique_identifier(
-	const struct bundle *bundle)
+static struct bundle_id compute_id(const struct bundle *bundle,
+				   const uint32_t fragment_offset,
+				   const uint32_t payload_length)
 {
-	return (struct bundle_unique_identifier){
-		.protocol_version = bundle->protocol_version,
-		.source = strdup(bundle->source),
-		.creation_timestamp_ms = bundle->creation_timestamp_ms,
-		.sequence_number = bundle->sequence_number,
-		.fragment_offset = bundle->fragment_offset,
-		.payload_length = bundle->payload_block->length
+	const uint64_t fields[] = {
+		bundle->creation_timestamp_ms,
+		bundle->sequence_number,
+		((uint64_t)fragment_offset << 32) | payload_length,
+		bundle->protocol_version,
 	};
+	struct siphash_state state;
+	uint64_t digest[2];
+
+	siphash_init(&state, true);
+	siphash_update(&state, fields, sizeof(fields));
+	if (bundle->source)
+		siphash_update(&state, bundle->source,
+			       eid_intern_get_info(bundle->source)->length);
+	siphash_final128(&state, digest);
+
+	// Zero marks IDs that have not been computed yet.
+	if (digest[0] == 0 && digest[1] == 0)
+		digest[0] = 1;
+	return (struct bundle_id){ .lo = digest[0], .hi = digest[1] };
 }
 
-void bundle_free_unique_identifier(struct bundle_unique_identifier *id)
+struct bundle_id bundle_get_id(struct bundle *bundle)
 {
-	free(id->source);
+	if (bundle->id.lo == 0 && bundle->id.hi == 0)
+		bundle->id = compute_id(
+			bundle,
+			bundle->fragment_offset,
+			bundle->payload_block ? bundle->payload_block->length : 0
+		);
+	return bundle->id;
 }
 
-bool bundle_is_equal(
-	const struct bundle *bundle, const struct bundle_unique_identifier *id)
+struct bundle_id bundle_get_parent_id(struct bundle *bundle)
 {
-	return (
-		bundle_is_equal_parent(bundle, id) &&
-		bundle->fragment_offset == id->fragment_offset &&
-		bundle->payload_block->length == id->payload_length
-	);
+	if (!bundle_is_fragmented(bundle))
+		return bundle_get_id(bundle);
+	return compute_id(bundle, 0, bundle->total_adu_length);
 }
 
-bool bundle_is_equal_parent(
-	const struct bundle *bundle, const struct bundle_unique_identifier *id)
+bool bundle_is_equal(struct bundle *bundle, const struct bundle_id *id)
 {
-	return (
-		bundle->protocol_version == id->protocol_version &&
-		strcmp(bundle->source, id->source) == 0 && // XXX '==' may be ok
-		bundle->creation_timestamp_ms == id->creation_timestamp_ms &&
-		bundle->sequence_number == id->sequence_number
-	);
+	const struct bundle_id bundle_id = bundle_get_id(bundle);
+
+	return bundle_id_equal(&bundle_id, id);
+}
+
+bool bundle_is_equal_parent(struct bundle *bundle, const struct bundle_id *id)
+{
+	const struct bundle_id parent_id = bundle_get_parent_id(bundle);
+
+	return bundle_id_equal(&parent_id, id);
 }
 
 struct bundle_adu bundle_adu_init(const struct bundle *bundle)
@@ -546,10 +801,11 @@ struct bundle_adu bundle_adu_init(const struct bundle *bundle)
 
 	bundle_adu.protocol_version = bundle->protocol_version;
 	bundle_adu.proc_flags = bundle->proc_flags & ~BUNDLE_FLAG_IS_FRAGMENT;
-	bundle_adu.source = strdup(bundle->source);
-	bundle_adu.destination = strdup(bundle->destination);
+	bundle_adu.source = eid_intern_ref(bundle->source);
+	bundle_adu.destination = eid_intern_ref(bundle->destination);
 	bundle_adu.payload = NULL;
 	bundle_adu.length = 0;
+	bundle_adu.payload_buffer = NULL;
 	bundle_adu.bundle_creation_timestamp_ms = bundle->creation_timestamp_ms;
 	bundle_adu.bundle_sequence_number = bundle->sequence_number;
 
@@ -560,16 +816,50 @@ struct bundle_adu bundle_to_adu(struct bundle *bundle)
 {
 	struct bundle_adu adu = bundle_adu_init(bundle);
 
-	adu.payload = bundle->payload_block->data;
-	adu.length = bundle->payload_block->length;
-	bundle->payload_block->data = NULL;
-	bundle->payload_block->length = 0;
+	struct bundle_block *const pl = bundle->payload_block;
+
+	adu.length = pl->length;
+	if (pl->buffer != NULL && shared_buffer_is_exclusive(pl->buffer) &&
+	    pl->data == pl->buffer->data &&
+	    pl->length == pl->buffer->length) {
+		// Nobody else references the data, take it over.
+		adu.payload = shared_buffer_take_slice(
+			pl->buffer,
+			pl->data,
+			pl->length
+		);
+	} else {
+		// Hand over the reference to shared data (if any).
+		adu.payload = pl->data;
+		adu.payload_buffer = pl->buffer;
+	}
+	pl->buffer = NULL;
+	pl->data = NULL;
+	pl->length = 0;
 	return adu;
 }
 
+uint8_t *bundle_adu_take_payload(struct bundle_adu *adu)
+{
+	uint8_t *payload = adu->payload;
+
+	if (adu->payload_buffer != NULL)
+		payload = shared_buffer_take_slice(
+			adu->payload_buffer,
+			adu->payload,
+			adu->length
+		);
+	adu->payload = NULL;
+	adu->payload_buffer = NULL;
+	return payload;
+}
+
 void bundle_adu_free_members(struct bundle_adu adu)
 {
-	free(adu.source);
-	free(adu.destination);
-	free(adu.payload);
+	eid_intern_release(adu.source);
+	eid_intern_release(adu.destination);
+	if (adu.payload_buffer != NULL)
+		shared_buffer_unref(adu.payload_buffer);
+	else
+		free(adu.payload);
 }
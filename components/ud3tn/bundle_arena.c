@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/bundle.h"
+#include "ud3tn/bundle_arena.h"
+#include "ud3tn/common.h"
+#include "ud3tn/result.h"
+#include "ud3tn/shared_buffer.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+enum ud3tn_result bundle_arena_alloc_block_data(
+	struct bundle_arena *arena, struct bundle_block *block, size_t length)
+{
+	ASSERT(block->data == NULL && block->buffer == NULL);
+
+	if (length == 0 || length > BUNDLE_ARENA_MAX_BLOCK_SIZE) {
+		block->data = malloc(length);
+		return (block->data != NULL || length == 0)
+			? UD3TN_OK
+			: UD3TN_FAIL;
+	}
+
+	if (arena->buffer == NULL ||
+	    arena->buffer->length - arena->used < length) {
+		bundle_arena_release(arena);
+		arena->buffer = shared_buffer_create(MAX(
+			(size_t)BUNDLE_ARENA_SIZE,
+			length
+		));
+		if (arena->buffer == NULL)
+			return UD3TN_FAIL;
+	}
+
+	// NOTE: The slice is written by the parser before the block is handed
+	// over, i.e. before anyone else may read it.
+	block->buffer = shared_buffer_ref(arena->buffer);
+	block->data = arena->buffer->data + arena->used;
+	arena->used += length;
+	return UD3TN_OK;
+}
+
+void bundle_arena_release(struct bundle_arena *arena)
+{
+	shared_buffer_unref(arena->buffer);
+	arena->buffer = NULL;
+	arena->used = 0;
+}
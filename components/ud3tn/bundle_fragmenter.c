@@ -20,7 +20,7 @@ struct bundle *bundlefragmenter_create_new_fragment(
 	ASSERT(prototype != NULL);
 	if (!prototype)
 		return NULL;
-	fragment = malloc(sizeof(struct bundle));
+	fragment = object_pool_alloc(&bundle_pool);
 	if (fragment == NULL)
 		return NULL;
 	bundle_copy_headers(fragment, prototype);
@@ -35,7 +35,7 @@ struct bundle *bundlefragmenter_create_new_fragment(
 		/* Create new PL block */
 		fragment_pl = bundle_block_create(BUNDLE_BLOCK_TYPE_PAYLOAD);
 		if (fragment_pl == NULL) {
-			free(fragment);
+			bundle_free(fragment);
 			return NULL;
 		}
 		fragment_pl->flags = prototype->payload_block->flags;
@@ -43,7 +43,7 @@ struct bundle *bundlefragmenter_create_new_fragment(
 		fragment->blocks = bundle_block_entry_create(fragment_pl);
 		if (fragment->blocks == NULL) {
 			bundle_block_free(fragment_pl);
-			free(fragment);
+			bundle_free(fragment);
 			return NULL;
 		}
 		/* Set the bundle's payload reference */
@@ -68,6 +68,12 @@ struct bundle *bundlefragmenter_initialize_first_fragment(struct bundle *input)
 	if (result == NULL)
 		return NULL;
 
+	// The payload is not copied but shared with the input bundle
+	if (bundle_block_make_shared(input->payload_block) != UD3TN_OK) {
+		bundle_free(result);
+		return NULL;
+	}
+
 	// Copy all extension blocks (includung payload block) to fragment
 	cur_block = bundle_block_list_dup(input->blocks);
 	result->blocks = cur_block;
@@ -1,18 +1,26 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/admission_control.h"
 #include "ud3tn/agent_manager.h"
 #include "ud3tn/bundle_processor.h"
 #include "ud3tn/contact_manager.h"
 #include "ud3tn/common.h"
 #include "ud3tn/eid.h"
+#include "ud3tn/eid_intern.h"
+#include "ud3tn/init.h"
+#include "ud3tn/memory_budget.h"
+#include "ud3tn/object_pool.h"
 #include "ud3tn/report_manager.h"
 #include "ud3tn/result.h"
 #include "ud3tn/router.h"
+#include "ud3tn/shared_buffer.h"
 
 #include "agents/config_agent.h"
 
 #include "bundle6/bundle6.h"
+#include "bundle7/bundle7.h"
 #include "bundle7/bundle_age.h"
 #include "bundle7/hopcount.h"
+#include "bundle7/reports.h"
 
 #include "platform/hal_io.h"
 #include "platform/hal_queue.h"
@@ -25,6 +33,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -37,30 +46,71 @@ enum bundle_handling_result {
 struct bp_context {
 	QueueIdentifier_t out_queue;
 	const char *local_eid;
-	char *local_eid_prefix;
-	bool local_eid_is_ipn;
+	// Structured form of the local EID to match endpoints against
+	struct eid_parsed local_eid_parsed;
 	bool status_reporting;
+	// Prepared once to not intern the EIDs of every BPv7 status report
+	struct bundle7_report_template report_template;
 	struct bundle_store* store;
 
 	struct contact_manager_params cm_param;
 
+	// Queues of the BP workers; only set if more than one worker is
+	// configured. They are shared by the BP task and all workers.
+	uint8_t worker_count;
+	QueueIdentifier_t *worker_queues;
+	// Index of the worker owning the context, BP_TASK_INDEX for the BP task
+	uint8_t worker_index;
+
 	struct reassembly_list {
 		struct reassembly_bundle_list {
 			struct bundle *bundle;
 			struct reassembly_bundle_list *next;
 		} *bundle_list;
+		// See bundle_get_parent_id()
+		struct bundle_id parent_id;
 		struct reassembly_list *next;
 	} *reassembly_list;
 
 	struct known_bundle_list {
-		struct bundle_unique_identifier id;
+		struct bundle_id id;
 		uint64_t deadline_ms;
 		struct known_bundle_list *next;
 	} *known_bundle_list;
 };
 
+static struct object_pool agent_manager_parameters_pool =
+	OBJECT_POOL_INITIALIZER(
+		"agent_manager_parameters",
+		struct agent_manager_parameters
+	);
+static struct object_pool reassembly_bundle_list_pool =
+	OBJECT_POOL_INITIALIZER(
+		"reassembly_bundle_list",
+		struct reassembly_bundle_list
+	);
+static struct object_pool known_bundle_list_pool =
+	OBJECT_POOL_INITIALIZER("known_bundle_list", struct known_bundle_list);
+
+// Worker index of the context of the BP task, which does not own a shard
+#define BP_TASK_INDEX UINT8_MAX
+
+#if BUNDLE_PROCESSOR_MAX_WORKERS > ADMISSION_DEFER_OWNER_COUNT
+#error "Every BP worker needs its own backlog of held-back bundles"
+#endif
+
+struct bp_worker_parameters {
+	QueueIdentifier_t signaling_queue;
+	struct bp_context ctx;
+};
+
 /* DECLARATIONS */
 
+static void start_workers(struct bp_context *const ctx, uint8_t worker_count);
+static bool delegate_to_worker(
+	const struct bp_context *const ctx,
+	const struct bundle_processor_signal signal);
+
 static inline void handle_signal(
 	struct bp_context *const ctx,
 	const struct bundle_processor_signal signal);
@@ -70,6 +120,8 @@ static void handle_contact_over(
 
 static enum ud3tn_result bundle_dispatch(
 	struct bp_context *const ctx, struct bundle *bundle);
+static bool endpoint_is_local(
+	const struct bp_context *const ctx, const char *eid);
 static bool bundle_endpoint_is_local(
 	const struct bp_context *const ctx, struct bundle *bundle);
 static enum ud3tn_result bundle_forward(
@@ -99,19 +151,23 @@ static void bundle_delete(
 	const struct bp_context *const ctx,
 	struct bundle *bundle, enum bundle_status_report_reason reason);
 static void bundle_discard(struct bundle *bundle);
+static void bundle_release_backlog(struct bundle *bundle);
+static void bundle_retry_deferred(const struct bp_context *const ctx);
 static void bundle_handle_custody_signal(
 	struct bundle_administrative_record *signal);
 static void bundle_dangling(
 	const struct bp_context *const ctx, struct bundle *bundle);
 static bool hop_count_validation(struct bundle *bundle);
+static bool crc_validation(
+	const struct bp_context *const ctx, struct bundle *bundle);
 static const char *get_agent_id(
 	const struct bp_context *const ctx, const char *dest_eid);
 static bool bundle_record_add_and_check_known(
-	struct bp_context *const ctx, const struct bundle *bundle);
+	struct bp_context *const ctx, struct bundle *bundle);
 static bool bundle_reassembled_is_known(
-	struct bp_context *const ctx, const struct bundle *bundle);
+	struct bp_context *const ctx, struct bundle *bundle);
 static void bundle_add_reassembled_as_known(
-	struct bp_context *const ctx, const struct bundle *bundle);
+	struct bp_context *const ctx, struct bundle *bundle);
 
 static void send_status_report(
 	const struct bp_context *const ctx,
@@ -120,6 +176,8 @@ static void send_status_report(
 	const enum bundle_status_report_reason reason);
 static enum ud3tn_result send_bundle(
 	const struct bp_context *const ctx, struct bundle *bundle);
+static void reschedule_bundle(
+	const struct bp_context *const ctx, struct bundle *bundle);
 
 static inline void bundle_add_rc(struct bundle *bundle,
 	const enum bundle_retention_constraints constraint)
@@ -165,8 +223,8 @@ int bundle_processor_perform_agent_action(
 	       type == BP_SIGNAL_AGENT_REGISTER_RPC ||
 	       type == BP_SIGNAL_AGENT_DEREGISTER_RPC);
 
-	struct agent_manager_parameters *const aaps = malloc(
-		sizeof(struct agent_manager_parameters)
+	struct agent_manager_parameters *const aaps = object_pool_alloc(
+		&agent_manager_parameters_pool
 	);
 	if (!aaps)
 		return -1;
@@ -188,7 +246,7 @@ int bundle_processor_perform_agent_action(
 	int result;
 
 	if (!feedback_queue) {
-		free(aaps);
+		object_pool_free(&agent_manager_parameters_pool, aaps);
 		return -1;
 	}
 
@@ -212,6 +270,11 @@ void bundle_processor_handle_router_command(
 {
 	const struct bp_context *const ctx = bp_context;
 
+	// Validating the new contacts can take a while for large contact
+	// plans, thus, do it before locking the routing table.
+	if (router_prepare_command(cmd) != UD3TN_OK)
+		return;
+
 	hal_semaphore_take_blocking(ctx->cm_param.semaphore);
 
 	// NOTE: May invoke router via bundle_dangling!
@@ -226,6 +289,7 @@ void bundle_processor_handle_router_command(
 	hal_semaphore_release(ctx->cm_param.semaphore);
 
 	if (result == UD3TN_OK) {
+		admission_control_notify_capacity();
 		wake_up_contact_manager(
 			ctx->cm_param.control_queue,
 			CM_SIGNAL_UPDATE_CONTACT_LIST
@@ -241,8 +305,10 @@ void bundle_processor_task(void * const param)
 	struct bp_context ctx = {
 		.out_queue = NULL,
 		.local_eid = p->local_eid,
-		.local_eid_prefix = NULL,
 		.status_reporting = p->status_reporting,
+		.worker_count = 0,
+		.worker_queues = NULL,
+		.worker_index = BP_TASK_INDEX,
 		.reassembly_list = NULL,
 		.known_bundle_list = NULL,
 		#ifdef ARCHIPEL_CORE
@@ -250,31 +316,20 @@ void bundle_processor_task(void * const param)
 		#endif
 	};
 
-	ASSERT(strlen(ctx.local_eid) > 3);
-	if (get_eid_scheme(ctx.local_eid) == EID_SCHEME_IPN) {
-		ctx.local_eid_is_ipn = true;
-		ctx.local_eid_prefix = strdup(ctx.local_eid);
-
-		char *const dot = strchr(ctx.local_eid_prefix, '.');
-
-		if (!dot) {
-			LOGF_ERROR(
-				"BundleProcessor: Invalid local EID \"%s\"",
-				ctx.local_eid_prefix
-			);
-			abort(); // should be a bug, is checked beforehand
-		} else {
-			dot[1] = '\0'; // truncate string after dot
-		}
-	} else {
-		ctx.local_eid_prefix = strdup(ctx.local_eid);
-
-		const size_t len = strlen(ctx.local_eid_prefix);
-
-		// remove slash if it is there to also match EIDs without
-		if (ctx.local_eid_prefix[len - 1] == '/')
-			ctx.local_eid_prefix[len - 1] = '\0';
+	if (eid_parse(ctx.local_eid, &ctx.local_eid_parsed) != UD3TN_OK ||
+	    (ctx.local_eid_parsed.scheme == EID_SCHEME_DTN &&
+	     ctx.local_eid_parsed.dtn_node_length == 0)) {
+		LOGF_ERROR(
+			"BundleProcessor: Invalid local EID \"%s\"",
+			ctx.local_eid
+		);
+		abort(); // should be a bug, is checked beforehand
 	}
+	if (ctx.status_reporting)
+		ASSERT(bundle7_report_template_init(
+			&ctx.report_template,
+			ctx.local_eid
+		) == UD3TN_OK);
 
 	/* Init routing tables */
 	ASSERT(routing_table_init() == UD3TN_OK);
@@ -305,10 +360,14 @@ void bundle_processor_task(void * const param)
 		abort();
 	}
 
+	if (p->worker_count > 1)
+		start_workers(&ctx, p->worker_count);
+
 	LOGF_INFO(
-		"BundleProcessor: BPA initialized for \"%s\", status reports %s",
+		"BundleProcessor: BPA initialized for \"%s\", status reports %s, %u worker(s)",
 		p->local_eid,
-		p->status_reporting ? "enabled" : "disabled"
+		p->status_reporting ? "enabled" : "disabled",
+		ctx.worker_count ? ctx.worker_count : 1
 	);
 
 	for (;;) {
@@ -316,8 +375,145 @@ void bundle_processor_task(void * const param)
 			-1) == UD3TN_OK
 		) {
 			handle_signal(&ctx, signal);
+			bundle_retry_deferred(&ctx);
+		}
+	}
+}
+
+static void bundle_processor_worker_task(void *const param)
+{
+	struct bp_worker_parameters *const p = param;
+	struct bundle_processor_signal signal;
+
+	for (;;) {
+		if (hal_queue_receive(p->signaling_queue, &signal,
+			-1) == UD3TN_OK
+		) {
+			handle_signal(&p->ctx, signal);
+			bundle_retry_deferred(&p->ctx);
+		}
+	}
+}
+
+static void start_workers(struct bp_context *const ctx, uint8_t worker_count)
+{
+	if (worker_count > BUNDLE_PROCESSOR_MAX_WORKERS)
+		worker_count = BUNDLE_PROCESSOR_MAX_WORKERS;
+
+	ctx->worker_queues = malloc(worker_count * sizeof(QueueIdentifier_t));
+	if (!ctx->worker_queues) {
+		LOG_ERROR("BundleProcessor: Cannot allocate worker queues!");
+		abort();
+	}
+
+	for (uint8_t i = 0; i < worker_count; i++) {
+		struct bp_worker_parameters *const wp = malloc(
+			sizeof(struct bp_worker_parameters)
+		);
+
+		if (!wp) {
+			LOG_ERROR("BundleProcessor: Cannot allocate worker!");
+			abort();
+		}
+
+		// The worker shares the static configuration, the contact
+		// manager and the worker queues with the BP task but has its
+		// own reassembly and duplicate detection state.
+		wp->ctx = *ctx;
+		wp->ctx.worker_count = worker_count;
+		wp->ctx.worker_index = i;
+		wp->ctx.reassembly_list = NULL;
+		wp->ctx.known_bundle_list = NULL;
+		wp->signaling_queue = hal_queue_create(
+			BUNDLE_QUEUE_LENGTH,
+			sizeof(struct bundle_processor_signal)
+		);
+
+		if (!wp->signaling_queue ||
+		    hal_task_create(bundle_processor_worker_task,
+				    wp) != UD3TN_OK) {
+			LOG_ERROR("BundleProcessor: Cannot start worker task!");
+			abort();
 		}
+		ctx->worker_queues[i] = wp->signaling_queue;
+	}
+
+	ctx->worker_count = worker_count;
+}
+
+uint8_t bundle_processor_get_worker_index(
+	const struct bundle *bundle, const bool destination_is_local,
+	const uint8_t worker_count)
+{
+	// Bundles addressed to us are assigned by source node, so that all
+	// fragments and copies of a bundle meet the same reassembly and
+	// duplicate detection state. All others are assigned by destination
+	// node, keeping bundles of one flow in order.
+	const char *const eid = (
+		destination_is_local
+		? bundle->source
+		: bundle->destination
+	);
+	const char *const node_id = eid_intern_get_node_id(eid);
+
+	ASSERT(worker_count != 0);
+	// The hash of interned EIDs is computed only once.
+	return eid_intern_get_info(
+		node_id ? node_id : eid
+	)->hash % worker_count;
+}
+
+static uint8_t get_bundle_shard(
+	const struct bp_context *const ctx, const struct bundle *bundle)
+{
+	return bundle_processor_get_worker_index(
+		bundle,
+		endpoint_is_local(ctx, bundle->destination),
+		ctx->worker_count
+	);
+}
+
+// Hold back the bundle for the worker owning it, regardless of the thread
+// deferring it, so that it is retried by that worker only. Bundles already
+// admitted are not subject to admission control again.
+static enum ud3tn_result defer_bundle(
+	const struct bp_context *const ctx, struct bundle *bundle)
+{
+	const uint8_t owner = (
+		ctx->worker_count ? get_bundle_shard(ctx, bundle) : 0
+	);
+
+	if (HAS_FLAG(bundle->ret_constraints,
+		     BUNDLE_RET_CONSTRAINT_FORWARD_PENDING))
+		return admission_control_defer_admitted(bundle, owner);
+	return admission_control_defer(bundle, owner);
+}
+
+// Passes bundle-related signals on to the responsible worker, if workers
+// are used. All other signals are handled by the BP task itself.
+static bool delegate_to_worker(
+	const struct bp_context *const ctx,
+	const struct bundle_processor_signal signal)
+{
+	if (!ctx->worker_count || ctx->worker_index != BP_TASK_INDEX)
+		return false;
+
+	switch (signal.type) {
+	case BP_SIGNAL_BUNDLE_INCOMING:
+	case BP_SIGNAL_BUNDLE_LOCAL_DISPATCH:
+	case BP_SIGNAL_TRANSMISSION_SUCCESS:
+	case BP_SIGNAL_TRANSMISSION_FAILURE:
+	case BP_SIGNAL_BUNDLE_RESCHEDULE:
+		break;
+	default:
+		return false;
 	}
+
+	hal_queue_push_to_back(
+		ctx->worker_queues[get_bundle_shard(ctx, signal.bundle)],
+		&signal
+	);
+	return true;
 }
 
 static inline void handle_signal(
@@ -327,6 +523,9 @@ static inline void handle_signal(
 	struct agent_manager_parameters *aaps;
 	int feedback;
 
+	if (delegate_to_worker(ctx, signal))
+		return;
+
 	switch (signal.type) {
 	case BP_SIGNAL_BUNDLE_INCOMING:
 		bundle_receive(ctx, signal.bundle);
@@ -348,6 +547,12 @@ static inline void handle_signal(
 	case BP_SIGNAL_BUNDLE_LOCAL_DISPATCH:
 		bundle_dispatch(ctx, signal.bundle);
 		break;
+	case BP_SIGNAL_BUNDLE_RESCHEDULE:
+		reschedule_bundle(ctx, signal.bundle);
+		break;
+	case BP_SIGNAL_RETRY_DEFERRED:
+		// Held-back bundles are retried after handling every signal.
+		break;
 	case BP_SIGNAL_AGENT_REGISTER:
 		aaps = signal.agent_manager_params;
 		feedback = agent_register(
@@ -356,14 +561,14 @@ static inline void handle_signal(
 		);
 		if (aaps->feedback_queue)
 			hal_queue_push_to_back(aaps->feedback_queue, &feedback);
-		free(aaps);
+		object_pool_free(&agent_manager_parameters_pool, aaps);
 		break;
 	case BP_SIGNAL_AGENT_DEREGISTER:
 		aaps = signal.agent_manager_params;
 		feedback = agent_deregister(aaps->agent.sink_identifier, true);
 		if (aaps->feedback_queue)
 			hal_queue_push_to_back(aaps->feedback_queue, &feedback);
-		free(aaps);
+		object_pool_free(&agent_manager_parameters_pool, aaps);
 		break;
 	case BP_SIGNAL_AGENT_REGISTER_RPC:
 		aaps = signal.agent_manager_params;
@@ -375,20 +580,21 @@ static inline void handle_signal(
 		);
 		if (aaps->feedback_queue)
 			hal_queue_push_to_back(aaps->feedback_queue, &feedback);
-		free(aaps);
+		object_pool_free(&agent_manager_parameters_pool, aaps);
 		break;
 	case BP_SIGNAL_AGENT_DEREGISTER_RPC:
 		aaps = signal.agent_manager_params;
 		feedback = agent_deregister(aaps->agent.sink_identifier, false);
 		if (aaps->feedback_queue)
 			hal_queue_push_to_back(aaps->feedback_queue, &feedback);
-		free(aaps);
+		object_pool_free(&agent_manager_parameters_pool, aaps);
 		break;
 	case BP_SIGNAL_NEW_LINK_ESTABLISHED:
 		// XXX: We do not use the provided CLA address.
 		free(signal.peer_cla_addr);
-		// NOTE: When we implement a "bundle backlog", we will attempt
-		// to route the bundles here.
+		// Bundles held back by admission control are retried after
+		// handling the signal.
+		admission_control_notify_capacity();
 		wake_up_contact_manager(
 			ctx->cm_param.control_queue,
 			CM_SIGNAL_PROCESS_CURRENT_BUNDLES
@@ -403,6 +609,7 @@ static inline void handle_signal(
 		break;
 	case BP_SIGNAL_CONTACT_OVER:
 		handle_contact_over(ctx, signal.contact);
+		admission_control_notify_capacity();
 		break;
 	default:
 		LOGF_WARN(
@@ -423,10 +630,14 @@ static void handle_link_down(
 	const struct bp_context *const ctx, const char* peer_cla_addr
 	) {
 
+	hal_semaphore_take_blocking(ctx->cm_param.semaphore);
+
 	struct contact_list* c = (*routing_table_get_raw_contact_list_ptr());
 
-	if(c == NULL)
+	if(c == NULL) {
+		hal_semaphore_release(ctx->cm_param.semaphore);
 		return;
+	}
 
 	LOGF_INFO("BundleProcessor: Link down on %s, disabling contact...", peer_cla_addr);
 
@@ -441,6 +652,9 @@ static void handle_link_down(
 	} while(c->next != NULL && (c = c->next) != NULL);
 
 	c->data->to_ms = hal_time_get_timestamp_ms();
+	routing_table_publish_snapshot();
+	hal_semaphore_release(ctx->cm_param.semaphore);
+
 	wake_up_contact_manager(
 		ctx->cm_param.control_queue,
 		CM_SIGNAL_UPDATE_CONTACT_LIST
@@ -490,20 +704,24 @@ enum ud3tn_result bundle_processor_bundle_dispatch(
 	return bundle_dispatch(bp_context, bundle);
 }
 
+// Checks whether the given interned EID refers to the local node, using the
+// structured form determined when interning it.
 static bool endpoint_is_local(
 	const struct bp_context *const ctx, const char *eid)
 {
-	const size_t local_len = strlen(ctx->local_eid_prefix);
-	const size_t dest_len = strlen(eid);
+	const struct eid_intern_info *const info = eid_intern_get_info(eid);
+	const struct eid_parsed *const local = &ctx->local_eid_parsed;
 
-	/* Compare EID _prefix_ with configured uD3TN EID */
+	if (!info->valid || info->scheme != local->scheme)
+		return false;
+	// `ipn` EIDs match if the node number is equal
+	if (local->scheme == EID_SCHEME_IPN)
+		return info->ipn_node == local->ipn_node;
+	// `dtn` EIDs match if the node name is equal ("dtn://" is skipped)
 	return (
-		// For the memcmp to be safe, the tested EID has to be at
-		// least as long as the local EID.
-		dest_len >= local_len &&
-		// The prefix (the local EID) has to match the EID.
-		memcmp(ctx->local_eid_prefix, eid,
-		       local_len) == 0
+		info->dtn_node_length == local->dtn_node_length &&
+		memcmp(&eid[6], &ctx->local_eid[6],
+		       local->dtn_node_length) == 0
 	);
 }
 
@@ -514,16 +732,80 @@ static bool bundle_endpoint_is_local(
 	return endpoint_is_local(ctx, bundle->destination);
 }
 
+static bool may_drop_for_admission(struct bundle *bundle, const void *param)
+{
+	return admission_control_drop_filter_matches(param, bundle);
+}
+
+/*
+ * Under ADMISSION_POLICY_DROP_LOWEST, drop bundles of lower priority queued
+ * for contacts until the given bundle fits into the backlog limits.
+ */
+static void make_room_for_bundle(
+	const struct bp_context *const ctx, struct bundle *bundle)
+{
+	struct admission_drop_filter filter;
+	struct bundle *victim;
+
+	while (admission_control_get_drop_filter(bundle, &filter)) {
+		hal_semaphore_take_blocking(ctx->cm_param.semaphore);
+		victim = router_evict_bundle(
+			*routing_table_get_raw_contact_list_ptr(),
+			may_drop_for_admission,
+			&filter
+		);
+		hal_semaphore_release(ctx->cm_param.semaphore);
+		if (victim == NULL)
+			return;
+		LOGF_INFO(
+			"BundleProcessor: Deleting bundle %p: Dropped for higher-priority bundle %p",
+			victim,
+			bundle
+		);
+		bundle_delete(ctx, victim, BUNDLE_SR_REASON_DEPLETED_STORAGE);
+	}
+}
+
 /* 5.4 */
 static enum ud3tn_result bundle_forward(
 	const struct bp_context *const ctx, struct bundle *bundle)
 {
+	struct admission_control_stats ac_stats;
+
+	make_room_for_bundle(ctx, bundle);
+	switch (admission_control_admit(bundle)) {
+	case ADMISSION_ACCEPT:
+		break;
+	case ADMISSION_DEFER:
+		if (defer_bundle(ctx, bundle) == UD3TN_OK) {
+			LOGF_DEBUG(
+				"BundleProcessor: Deferring bundle %p: Backlog full",
+				bundle
+			);
+			return UD3TN_OK;
+		}
+		// fall through
+	case ADMISSION_REJECT:
+	default:
+		ac_stats = admission_control_get_stats();
+		LOGF_INFO(
+			"BundleProcessor: Deleting bundle %p: Backlog full (%llu bundles, %llu bytes rejected so far)",
+			bundle,
+			(unsigned long long)ac_stats.rejected_bundles,
+			(unsigned long long)ac_stats.rejected_bytes
+		);
+		bundle_delete(ctx, bundle, BUNDLE_SR_REASON_DEPLETED_STORAGE);
+		return UD3TN_FAIL;
+	}
+
 	/* 4.3.4. Hop Count (BPv7-bis) */
 	if (!hop_count_validation(bundle)) {
 		LOGF_INFO(
 			"BundleProcessor: Deleting bundle %p: Hop Limit Exceeded",
 			bundle
 		);
+		// Not yet marked as pending forwarding, see bundle_release_backlog
+		admission_control_release(bundle);
 		bundle_delete(ctx, bundle, BUNDLE_SR_REASON_HOP_LIMIT_EXCEEDED);
 		return UD3TN_FAIL;
 	}
@@ -551,6 +833,7 @@ static void bundle_forwarding_success(
 			BUNDLE_SR_REASON_NO_INFO
 		);
 	}
+	bundle_release_backlog(bundle);
 	bundle_rem_rc(bundle, BUNDLE_RET_CONSTRAINT_FORWARD_PENDING, 0);
 	bundle_rem_rc(bundle, BUNDLE_RET_CONSTRAINT_FLAG_OWN, 1);
 }
@@ -583,6 +866,7 @@ static void bundle_forwarding_contraindicated(
 			bundle_forwarding_failed(ctx, bundle, reason);
 		} else {
 			LOGF_ERROR("BundleProcessor: Bundle %s persisted for later dispatch", bundle->destination);
+			bundle_release_backlog(bundle);
 			bundle_free(bundle);
 		}
 
@@ -633,6 +917,16 @@ static void bundle_receive(struct bp_context *const ctx, struct bundle *bundle)
 	// Set the reception time to calculate the bundle's residence time
 	bundle->reception_timestamp_ms = hal_time_get_timestamp_ms();
 
+	// Bundles with an invalid CRC are discarded silently, as by the parser
+	if (!crc_validation(ctx, bundle)) {
+		LOGF_INFO(
+			"BundleProcessor: Dropping bundle %p: CRC mismatch",
+			bundle
+		);
+		bundle_discard(bundle);
+		return;
+	}
+
 	/* 5.6-1 Add retention constraint */
 	bundle_add_rc(bundle, BUNDLE_RET_CONSTRAINT_DISPATCH_PENDING);
 	/* 5.6-2 Request reception */
@@ -685,6 +979,8 @@ static void bundle_receive(struct bp_context *const ctx, struct bundle *bundle)
 		if (*e != NULL)
 			e = &(*e)->next;
 	}
+	// Block flags may have been changed or blocks discarded.
+	bundle_invalidate_block_caches(bundle);
 
 	/* NOTE: Test for custody acceptance here. */
 	/* NOTE: We never accept custody, we do not have persistent storage. */
@@ -784,22 +1080,25 @@ static void bundle_deliver_local(
 	}
 }
 
-static bool may_reassemble(const struct bundle *b1, const struct bundle *b2)
-{
-	return (
-		b1->creation_timestamp_ms == b2->creation_timestamp_ms &&
-		b1->sequence_number == b2->sequence_number &&
-		strcmp(b1->source, b2->source) == 0 // XXX: '==' may be ok
-	);
-}
-
-static void add_to_reassembly_bundle_list(
+static enum ud3tn_result add_to_reassembly_bundle_list(
 	const struct bp_context *const ctx,
 	struct reassembly_list *item,
 	struct bundle *bundle)
 {
 	struct reassembly_bundle_list **cur_entry = &item->bundle_list;
 
+	// Fragments waiting for reassembly do not cause backpressure, as only
+	// receiving further fragments frees them, they are rejected instead.
+	if (!memory_budget_acquire(MEMORY_BUDGET_REASSEMBLY,
+				   bundle->payload_block->length)) {
+		LOGF_WARN(
+			"BundleProcessor: Deleting bundle %p: Reassembly memory budget exhausted.",
+			bundle
+		);
+		bundle_delete(ctx, bundle, BUNDLE_SR_REASON_DEPLETED_STORAGE);
+		return UD3TN_FAIL;
+	}
+
 	while (*cur_entry != NULL) {
 		struct reassembly_bundle_list *e = *cur_entry;
 
@@ -809,20 +1108,102 @@ static void add_to_reassembly_bundle_list(
 		cur_entry = &(*cur_entry)->next;
 	}
 
-	struct reassembly_bundle_list *new_entry = malloc(
-		sizeof(struct reassembly_bundle_list)
+	struct reassembly_bundle_list *new_entry = object_pool_alloc(
+		&reassembly_bundle_list_pool
 	);
 	if (!new_entry) {
 		LOGF_WARN(
 			"BundleProcessor: Deleting bundle %p: Cannot store in reassembly list.",
 			bundle
 		);
+		memory_budget_release(
+			MEMORY_BUDGET_REASSEMBLY,
+			bundle->payload_block->length
+		);
 		bundle_delete(ctx, bundle, BUNDLE_SR_REASON_DEPLETED_STORAGE);
-		return;
+		return UD3TN_FAIL;
 	}
 	new_entry->bundle = bundle;
 	new_entry->next = *cur_entry;
 	*cur_entry = new_entry;
+	return UD3TN_OK;
+}
+
+// Delete fragments whose lifetime expired while waiting for the remaining
+// fragments, along with the lists that become empty.
+static void purge_expired_fragments(struct bp_context *const ctx)
+{
+	const uint64_t cur_time_ms = hal_time_get_timestamp_ms();
+	struct reassembly_list **slot = &ctx->reassembly_list;
+
+	while (*slot) {
+		struct reassembly_list *const e = *slot;
+		struct reassembly_bundle_list **cur_entry = &e->bundle_list;
+
+		while (*cur_entry) {
+			struct reassembly_bundle_list *const eb = *cur_entry;
+			struct bundle *const b = eb->bundle;
+
+			if (bundle_get_expiration_time_ms(b) >= cur_time_ms) {
+				cur_entry = &eb->next;
+				continue;
+			}
+
+			*cur_entry = eb->next;
+			object_pool_free(&reassembly_bundle_list_pool, eb);
+			memory_budget_release(
+				MEMORY_BUDGET_REASSEMBLY,
+				b->payload_block->length
+			);
+			bundle_expired(ctx, b);
+		}
+
+		if (e->bundle_list) {
+			slot = &e->next;
+		} else {
+			*slot = e->next;
+			free(e);
+		}
+	}
+}
+
+// Check whether the fragments reference adjacent slices of one shared buffer
+// covering the whole ADU, e.g., because they have been created by this node.
+static struct shared_buffer *get_shared_adu_payload(
+	const struct reassembly_bundle_list *eb, const size_t adu_length,
+	uint8_t **const payload)
+{
+	struct shared_buffer *const buffer = (
+		eb->bundle->payload_block->buffer
+	);
+	const uint8_t *start = NULL;
+	size_t pos_in_bundle = 0;
+
+	if (buffer == NULL)
+		return NULL;
+	for (; eb && pos_in_bundle < adu_length; eb = eb->next) {
+		const struct bundle_block *const pl = eb->bundle->payload_block;
+		const size_t offset_in_bundle = (
+			pos_in_bundle - eb->bundle->fragment_offset
+		);
+
+		if (offset_in_bundle >= pl->length)
+			continue;
+		if (pl->buffer != buffer)
+			return NULL;
+		if (start == NULL)
+			start = pl->data + offset_in_bundle;
+		else if (pl->data + offset_in_bundle != start + pos_in_bundle)
+			return NULL;
+		pos_in_bundle += MIN(
+			pl->length - offset_in_bundle,
+			adu_length - pos_in_bundle
+		);
+	}
+	if (start == NULL || pos_in_bundle < adu_length)
+		return NULL;
+	*payload = (uint8_t *)start;
+	return shared_buffer_ref(buffer);
 }
 
 static void try_reassemble(
@@ -858,12 +1239,19 @@ static void try_reassemble(
 		return;
 	LOG_DEBUG("BundleProcessor: Reassembling bundle!");
 
-	// Reassemble by memcpy
+	// Reassemble by memcpy, unless the fragments share the payload
 	b = e->bundle_list->bundle;
 	const size_t adu_length = b->total_adu_length;
-	uint8_t *const payload = malloc(adu_length);
+	uint8_t *payload = NULL;
+	struct shared_buffer *const payload_buffer = get_shared_adu_payload(
+		e->bundle_list,
+		adu_length,
+		&payload
+	);
 	bool added_as_known = false;
 
+	if (!payload_buffer)
+		payload = malloc(adu_length);
 	if (!payload) {
 		LOG_ERROR("BundleProcessor: Cannot allocate reassembly buffer!");
 		return; // currently not enough memory to reassemble
@@ -873,6 +1261,7 @@ static void try_reassemble(
 
 	adu.payload = payload;
 	adu.length = adu_length;
+	adu.payload_buffer = payload_buffer;
 
 	pos_in_bundle = 0;
 	for (eb = e->bundle_list; eb; eb = eb->next) {
@@ -892,14 +1281,21 @@ static void try_reassemble(
 		);
 
 		if (offset_in_bundle < b->payload_block->length) {
-			memcpy(
-				&payload[pos_in_bundle],
-				&b->payload_block->data[offset_in_bundle],
-				bytes_copied
-			);
+			if (!payload_buffer)
+				memcpy(
+					&payload[pos_in_bundle],
+					&b->payload_block->data[
+						offset_in_bundle
+					],
+					bytes_copied
+				);
 			pos_in_bundle += bytes_copied;
 		}
 
+		memory_budget_release(
+			MEMORY_BUDGET_REASSEMBLY,
+			b->payload_block->length
+		);
 		bundle_rem_rc(b, BUNDLE_RET_CONSTRAINT_REASSEMBLY_PENDING, 0);
 		bundle_discard(b);
 	}
@@ -909,7 +1305,7 @@ static void try_reassemble(
 	while (e->bundle_list) {
 		eb = e->bundle_list;
 		e->bundle_list = e->bundle_list->next;
-		free(eb);
+		object_pool_free(&reassembly_bundle_list_pool, eb);
 	}
 	free(e);
 
@@ -921,6 +1317,7 @@ static void bundle_attempt_reassembly(
 	struct bp_context *const ctx, struct bundle *bundle)
 {
 	struct reassembly_list **r_list_e = &ctx->reassembly_list;
+	const struct bundle_id parent_id = bundle_get_parent_id(bundle);
 
 	if (bundle_reassembled_is_known(ctx, bundle)) {
 		LOGF_DEBUG(
@@ -934,19 +1331,24 @@ static void bundle_attempt_reassembly(
 			0
 		);
 		bundle_discard(bundle);
+		return;
 	}
 
+	// Fragments of other bundles may have expired in the meantime.
+	purge_expired_fragments(ctx);
+
 	// Find bundle
 	for (; *r_list_e; r_list_e = &(*r_list_e)->next) {
 		struct reassembly_list *const e = *r_list_e;
 
-		if (may_reassemble(e->bundle_list->bundle, bundle)) {
+		if (bundle_id_equal(&e->parent_id, &parent_id)) {
 			LOGF_DEBUG(
 				"BundleProcessor: Fragment list for new fragment %p found, updating.",
 				bundle
 			);
-			add_to_reassembly_bundle_list(ctx, e, bundle);
-			try_reassemble(ctx, r_list_e);
+			if (add_to_reassembly_bundle_list(ctx, e,
+							  bundle) == UD3TN_OK)
+				try_reassemble(ctx, r_list_e);
 			return;
 		}
 	}
@@ -965,8 +1367,13 @@ static void bundle_attempt_reassembly(
 		return;
 	}
 	new_list->bundle_list = NULL;
+	new_list->parent_id = parent_id;
 	new_list->next = NULL;
-	add_to_reassembly_bundle_list(ctx, new_list, bundle);
+	if (add_to_reassembly_bundle_list(ctx, new_list,
+					  bundle) != UD3TN_OK) {
+		free(new_list);
+		return;
+	}
 	*r_list_e = new_list;
 	try_reassemble(ctx, r_list_e);
 }
@@ -1001,13 +1408,23 @@ static void bundle_deliver_adu(const struct bp_context *const ctx, struct bundle
 			);
 
 			// Remove the record-specific bytes from the ADU so
-			// only the BPDU remains.
+			// only the BPDU remains by narrowing the slice of the
+			// payload buffer. An owned payload is wrapped for this
+			// instead of moving the BPDU to its start.
+			if (adu.payload_buffer == NULL)
+				adu.payload_buffer = shared_buffer_wrap(
+					adu.payload,
+					adu.length
+				);
 			adu.length = adu.length - bytes_to_skip;
-			memmove(
-				adu.payload,
-				adu.payload + bytes_to_skip,
-				adu.length
-			);
+			if (adu.payload_buffer != NULL)
+				adu.payload += bytes_to_skip;
+			else
+				memmove(
+					adu.payload,
+					adu.payload + bytes_to_skip,
+					adu.length
+				);
 			adu.proc_flags = BUNDLE_FLAG_ADMINISTRATIVE_RECORD;
 
 			const char *agent_id = (
@@ -1073,6 +1490,7 @@ static void bundle_delete(
 			reason
 		);
 
+	bundle_release_backlog(bundle);
 	bundle->ret_constraints &= BUNDLE_RET_CONSTRAINT_NONE;
 	bundle_discard(bundle);
 }
@@ -1084,6 +1502,66 @@ static void bundle_discard(struct bundle *bundle)
 	bundle_drop(bundle);
 }
 
+/* Account for a bundle no longer pending forwarding in admission control. */
+static void bundle_release_backlog(struct bundle *bundle)
+{
+	if (HAS_FLAG(bundle->ret_constraints,
+		     BUNDLE_RET_CONSTRAINT_FORWARD_PENDING))
+		admission_control_release(bundle);
+}
+
+/*
+ * Wake up the workers having held-back bundles to be retried, as every worker
+ * only retries its own bundles.
+ */
+static void wake_up_deferring_workers(const struct bp_context *const ctx)
+{
+	const struct bundle_processor_signal signal = {
+		.type = BP_SIGNAL_RETRY_DEFERRED,
+	};
+
+	for (uint8_t i = 0; i < ctx->worker_count; i++) {
+		if (i == ctx->worker_index ||
+		    !admission_control_claim_retry_wakeup(i))
+			continue;
+		// If the queue is full, the worker retries after handling
+		// the queued signals anyway.
+		hal_queue_try_push_to_back(ctx->worker_queues[i], &signal, 0);
+	}
+}
+
+/*
+ * Re-attempt forwarding bundles held back by admission control for the shard
+ * owned by the context.
+ * NOTE: Must not be called while holding the contact manager semaphore.
+ */
+static void bundle_retry_deferred(const struct bp_context *const ctx)
+{
+	wake_up_deferring_workers(ctx);
+	// The BP task does not own any bundles if workers are used.
+	if (ctx->worker_count && ctx->worker_index == BP_TASK_INDEX)
+		return;
+
+	const uint8_t owner = ctx->worker_count ? ctx->worker_index : 0;
+	// Only the bundles held back at the time of the call are processed,
+	// bundles deferred again are appended to the backlog.
+	size_t count = admission_control_get_retry_count(owner);
+
+	while (count--) {
+		struct bundle *const bundle =
+			admission_control_pop_deferred(owner);
+
+		if (!bundle)
+			break;
+		// Bundles deferred after routing have already been admitted.
+		if (HAS_FLAG(bundle->ret_constraints,
+			     BUNDLE_RET_CONSTRAINT_FORWARD_PENDING))
+			send_bundle(ctx, bundle);
+		else
+			bundle_forward(ctx, bundle);
+	}
+}
+
 /* 6.3 */
 static void bundle_handle_custody_signal(
 	struct bundle_administrative_record *signal)
@@ -1136,10 +1614,19 @@ static void send_status_report(
 		.status = status,
 		.reason = reason
 	};
-	struct bundle *b = generate_status_report(
-		bundle,
-		&report,
-		ctx->local_eid
+	struct bundle *b = (
+		bundle->protocol_version == 7
+		? bundle7_generate_status_report_templated(
+			&ctx->report_template,
+			bundle,
+			&report,
+			hal_time_get_timestamp_ms()
+		)
+		: generate_status_report(
+			bundle,
+			&report,
+			ctx->local_eid
+		)
 	);
 
 	if (b != NULL) {
@@ -1186,14 +1673,95 @@ static inline const char *get_router_status_str(
 	}
 }
 
-static enum ud3tn_result send_bundle(
+static void reschedule_bundle(
 	const struct bp_context *const ctx, struct bundle *bundle)
 {
-	hal_semaphore_take_blocking(ctx->cm_param.semaphore);
+	LOGF_DEBUG(
+		"BundleProcessor: Re-scheduling pre-empted bundle %p",
+		bundle
+	);
+	// The bundle is still admitted, hold it back if possible.
+	if (admission_control_get_config().policy ==
+			ADMISSION_POLICY_DEFER &&
+	    defer_bundle(ctx, bundle) == UD3TN_OK)
+		return;
+	// NOTE: Can only displace bundles of even lower priority.
+	// If routing fails, the bundle has already been deleted by
+	// send_bundle(), including the status report.
+	if (send_bundle(ctx, bundle) != UD3TN_OK)
+		LOGF_DEBUG(
+			"BundleProcessor: Pre-empted bundle %p could not be re-scheduled",
+			bundle
+		);
+}
 
-	enum router_result_status result = router_route_bundle(bundle);
+static void reschedule_preempted_bundles(
+	const struct bp_context *const ctx, struct routed_bundle_list *list)
+{
+	struct routed_bundle_list *next;
 
-	hal_semaphore_release(ctx->cm_param.semaphore);
+	while (list != NULL) {
+		struct bundle *const bundle = list->data;
+
+		next = list->next;
+		object_pool_free(&routed_bundle_list_pool, list);
+		list = next;
+
+		const uint8_t shard = (
+			ctx->worker_count
+			? get_bundle_shard(ctx, bundle)
+			: ctx->worker_index
+		);
+
+		if (shard == ctx->worker_index) {
+			reschedule_bundle(ctx, bundle);
+			continue;
+		}
+
+		// The bundle may belong to another worker, which has to route
+		// it again. The push must not block, as that worker may wait
+		// for our queue in the same way. If its queue is full, the
+		// bundle is held back for it until resources are freed.
+		const struct bundle_processor_signal signal = {
+			.type = BP_SIGNAL_BUNDLE_RESCHEDULE,
+			.bundle = bundle,
+		};
+
+		if (hal_queue_try_push_to_back(ctx->worker_queues[shard],
+					       &signal, 0) == UD3TN_OK)
+			continue;
+		if (defer_bundle(ctx, bundle) == UD3TN_OK) {
+			LOGF_DEBUG(
+				"BundleProcessor: Deferring pre-empted bundle %p for worker %u",
+				bundle,
+				shard
+			);
+			continue;
+		}
+		LOGF_INFO(
+			"BundleProcessor: Cannot hand back pre-empted bundle %p to worker %u",
+			bundle,
+			shard
+		);
+		bundle_forwarding_failed(
+			ctx,
+			bundle,
+			BUNDLE_SR_REASON_DEPLETED_STORAGE
+		);
+	}
+}
+
+static enum ud3tn_result send_bundle(
+	const struct bp_context *const ctx, struct bundle *bundle)
+{
+	struct routed_bundle_list *preempted;
+	enum router_result_status result = router_route_bundle_locking(
+		bundle,
+		ctx->cm_param.semaphore,
+		&preempted
+	);
+
+	reschedule_preempted_bundles(ctx, preempted);
 
 	if (result == ROUTER_RESULT_OK) {
 		/* 5.4-4 */
@@ -1210,14 +1778,25 @@ static enum ud3tn_result send_bundle(
 		bundle,
 		get_router_status_str(result)
 	);
-	if (result == ROUTER_RESULT_EXPIRED)
+	if (result == ROUTER_RESULT_EXPIRED) {
 		bundle_expired(ctx, bundle);
-	else
+	} else if (result == ROUTER_RESULT_NO_TIMELY_CONTACTS &&
+		   admission_control_get_config().policy ==
+			ADMISSION_POLICY_DEFER &&
+		   defer_bundle(ctx, bundle) == UD3TN_OK) {
+		// Held back until contact capacity becomes available.
+		LOGF_DEBUG(
+			"BundleProcessor: Deferring bundle %p: Contacts full",
+			bundle
+		);
+		return UD3TN_OK;
+	} else {
 		bundle_forwarding_contraindicated(
 			ctx,
 			bundle,
 			get_fail_reason(result)
 		);
+	}
 
 	return UD3TN_FAIL;
 }
@@ -1234,8 +1813,8 @@ static enum ud3tn_result send_bundle(
  */
 static bool hop_count_validation(struct bundle *bundle)
 {
-	struct bundle_block *block = bundle_block_find_first_by_type(
-		bundle->blocks, BUNDLE_BLOCK_TYPE_HOP_COUNT);
+	struct bundle_block *block = bundle_find_block(
+		bundle, BUNDLE_BLOCK_TYPE_HOP_COUNT);
 
 	/* No Hop Count block was found */
 	if (block == NULL)
@@ -1273,43 +1852,49 @@ static bool hop_count_validation(struct bundle *bundle)
 		return true;
 	}
 
-	free(block->data);
-
-	block->data = buffer;
-	block->length = bundle7_hop_count_serialize(&hop_count,
-		buffer, BUNDLE7_HOP_COUNT_MAX_ENCODED_SIZE);
+	bundle_block_replace_data(block, buffer, bundle7_hop_count_serialize(
+		&hop_count, buffer, BUNDLE7_HOP_COUNT_MAX_ENCODED_SIZE));
+	bundle_invalidate_block_caches(bundle);
 
 	return true;
 }
 
+/* Verify the CRCs deferred by the parser, see BUNDLE7_PARSER_DEFER_CRC. */
+static bool crc_validation(
+	const struct bp_context *const ctx, struct bundle *bundle)
+{
+	if (bundle->protocol_version != 7)
+		return true;
+
+	// Bundles only passed on may leave the verification to the next hop.
+	if (BUNDLE_PROCESSOR_DEFER_CRC_TO_NEXT_HOP &&
+	    !bundle_endpoint_is_local(ctx, bundle))
+		return true;
+
+	return bundle7_verify_crc(bundle) == UD3TN_OK;
+}
+
 /**
  * Get the agent identifier for local bundle delivery.
- * The agent identifier should follow the local EID behind a slash ('/').
+ * The agent identifier should follow the local EID behind a slash ('/') or,
+ * for `ipn` EIDs, is the service number following the dot.
  */
 static const char *get_agent_id(const struct bp_context *const ctx, const char *dest_eid)
 {
-	const size_t local_len = strlen(ctx->local_eid_prefix);
-	const size_t dest_len = strlen(dest_eid);
-
-	if (dest_len <= local_len)
+	if (!endpoint_is_local(ctx, dest_eid))
 		return NULL;
-	// `ipn` EIDs always end with ".0", prefix ends with "."
-	// -> agent starts after local_len
-	if (ctx->local_eid_is_ipn) {
-		if (dest_eid[local_len - 1] != '.')
-			return NULL;
-		return &dest_eid[local_len];
-	}
-	// The local `dtn` EID prefix never ends with a '/', it follows after
-	// (see bundle_processor_task); the `<=` above protects this check
-	if (dest_eid[local_len] != '/')
+
+	const uint16_t offset = eid_intern_get_info(dest_eid)->agent_id_offset;
+
+	// `dtn` EIDs without the slash do not contain an agent identifier
+	if (offset == 0)
 		return NULL;
-	return &dest_eid[local_len + 1];
+	return &dest_eid[offset];
 }
 
 // Checks whether we know the bundle. If not, adds it to the list.
 static bool bundle_record_add_and_check_known(
-	struct bp_context *const ctx, const struct bundle *bundle)
+	struct bp_context *const ctx, struct bundle *bundle)
 {
 	struct known_bundle_list **cur_entry = &ctx->known_bundle_list;
 	uint64_t cur_time_ms = hal_time_get_timestamp_ms();
@@ -1327,8 +1912,7 @@ static bool bundle_record_add_and_check_known(
 			return true;
 		} else if (e->deadline_ms < cur_time_ms) {
 			*cur_entry = e->next;
-			bundle_free_unique_identifier(&e->id);
-			free(e);
+			object_pool_free(&known_bundle_list_pool, e);
 			continue;
 		} else if (e->deadline_ms > bundle_deadline_ms) {
 			// Won't find, insert here!
@@ -1338,13 +1922,13 @@ static bool bundle_record_add_and_check_known(
 	}
 
 	// 2. If not found, add at current slot (ordered by deadline)
-	struct known_bundle_list *new_entry = malloc(
-		sizeof(struct known_bundle_list)
+	struct known_bundle_list *new_entry = object_pool_alloc(
+		&known_bundle_list_pool
 	);
 
 	if (!new_entry)
 		return false;
-	new_entry->id = bundle_get_unique_identifier(bundle);
+	new_entry->id = bundle_get_id(bundle);
 	new_entry->deadline_ms = bundle_deadline_ms;
 	new_entry->next = *cur_entry;
 	*cur_entry = new_entry;
@@ -1353,20 +1937,18 @@ static bool bundle_record_add_and_check_known(
 }
 
 static bool bundle_reassembled_is_known(
-	struct bp_context *const ctx, const struct bundle *bundle)
+	struct bp_context *const ctx, struct bundle *bundle)
 {
 	struct known_bundle_list **cur_entry = &ctx->known_bundle_list;
 	const uint64_t bundle_deadline_ms = bundle_get_expiration_time_ms(
 		bundle
 	);
+	const struct bundle_id parent_id = bundle_get_parent_id(bundle);
 
 	while (*cur_entry != NULL) {
 		struct known_bundle_list *e = *cur_entry;
 
-		if (bundle_is_equal_parent(bundle, &e->id) &&
-				e->id.fragment_offset == 0 &&
-				e->id.payload_length ==
-					bundle->total_adu_length) {
+		if (bundle_id_equal(&e->id, &parent_id)) {
 			return true;
 		} else if (e->deadline_ms > bundle_deadline_ms) {
 			// Won't find...
@@ -1378,7 +1960,7 @@ static bool bundle_reassembled_is_known(
 }
 
 static void bundle_add_reassembled_as_known(
-	struct bp_context *const ctx, const struct bundle *bundle)
+	struct bp_context *const ctx, struct bundle *bundle)
 {
 	struct known_bundle_list **cur_entry = &ctx->known_bundle_list;
 	const uint64_t bundle_deadline_ms = bundle_get_expiration_time_ms(
@@ -1393,15 +1975,13 @@ static void bundle_add_reassembled_as_known(
 		cur_entry = &(*cur_entry)->next;
 	}
 
-	struct known_bundle_list *new_entry = malloc(
-		sizeof(struct known_bundle_list)
+	struct known_bundle_list *new_entry = object_pool_alloc(
+		&known_bundle_list_pool
 	);
 
 	if (!new_entry)
 		return;
-	new_entry->id = bundle_get_unique_identifier(bundle);
-	new_entry->id.fragment_offset = 0;
-	new_entry->id.payload_length = bundle->total_adu_length;
+	new_entry->id = bundle_get_parent_id(bundle);
 	new_entry->deadline_ms = bundle_deadline_ms;
 	new_entry->next = *cur_entry;
 	*cur_entry = new_entry;
@@ -1,4 +1,5 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/bundle_processor.h"
 #include "ud3tn/cmdline.h"
 #include "ud3tn/common.h"
 #include "ud3tn/eid.h"
@@ -64,6 +65,7 @@ const struct ud3tn_cmdline_options *parse_cmdline(int argc, char *argv[])
 	result->allow_remote_configuration = false;
 	result->exit_immediately = false;
 	result->lifetime_s = DEFAULT_BUNDLE_LIFETIME_S;
+	result->bp_workers = BUNDLE_PROCESSOR_WORKERS;
 	#ifdef ARCHIPEL_CORE
 	result->store_folder = strdup("./" DEFAULT_STORE_LOCATION);
 	#endif
@@ -74,12 +76,13 @@ const struct ud3tn_cmdline_options *parse_cmdline(int argc, char *argv[])
 	result->eid = NULL;
 	result->cla_options = NULL;
 	int option_index = 0;
+	uint64_t workers;
 
 	if (!argv || argc <= 1)
 		goto finish;
 
 	shorten_long_cli_options(argc, argv);
-	while ((opt = getopt(argc, argv, ":a:b:c:e:l:L:m:p:s:S:rRhuP:")) != -1) {
+	while ((opt = getopt(argc, argv, ":a:b:c:e:l:L:m:p:s:S:W:rRhuP:")) != -1) {
 		switch (opt) {
 		case 'a':
 			if (!optarg || strlen(optarg) < 1) {
@@ -177,6 +180,15 @@ const struct ud3tn_cmdline_options *parse_cmdline(int argc, char *argv[])
 			}
 			result->aap2_socket = strdup(optarg);
 			break;
+		case 'W':
+			if (parse_uint64(optarg, &workers) != UD3TN_OK ||
+					!workers ||
+					workers > BUNDLE_PROCESSOR_MAX_WORKERS) {
+				LOG_ERROR("Invalid number of BP workers provided!");
+				return NULL;
+			}
+			result->bp_workers = (uint8_t)workers;
+			break;
 		case 'u':
 			print_usage_text();
 			result->exit_immediately = true;
@@ -257,6 +269,7 @@ static void shorten_long_cli_options(const int argc, char *argv[])
 		{"--aap-socket", "-s"},
 		{"--aap2-socket", "-S"},
 		{"--bp-version", "-b"},
+		{"--bp-workers", "-W"},
 		{"--cla", "-c"},
 		{"--eid", "-e"},
 		{"--help", "-h"},
@@ -292,6 +305,7 @@ static void print_usage_text(void)
 		"    [-m BYTES, --max-bundle-size BYTES] [-r, --status-reports]\n"
 		"    [-R, --allow-remote-config] [-L " LOG_LEVELS ", --log-level " LOG_LEVELS "]\n"
 		"    [-s PATH --aap-socket PATH] [-S PATH --aap2-socket PATH]\n"
+		"    [-W COUNT, --bp-workers COUNT]\n"
 		#ifdef ARCHIPEL_CORE
 		"    [-P PATH --persist PATH] [-u, --usage]\n"
 		#endif
@@ -320,6 +334,7 @@ static void print_help_text(void)
 		"  -s, --aap-socket PATH       path to the UNIX domain socket of the application agent service\n"
 		"  -S, --aap2-socket PATH      path to the UNIX domain socket of the AAP 2.0 service\n"
 		"  -u, --usage                 print usage summary and exit\n"
+		"  -W, --bp-workers COUNT      number of threads processing bundles in parallel\n"
 		#ifdef ARCHIPEL_CORE
 		"  -P, --store PATH            folder to store persisted bundles in\n"
 		#endif
@@ -331,8 +346,9 @@ static void print_help_text(void)
 		"  -l " STR(DEFAULT_BUNDLE_LIFETIME) " \\\n"
 		"  -L " STR(DEFAULT_LOG_LEVEL) " \\\n"
 		"  -m %lu \\\n"
-		"  -s $PWD/" DEFAULT_AAP_SOCKET_FILENAME "\n"
-		"  -S $PWD/" DEFAULT_AAP2_SOCKET_FILENAME "\n"
+		"  -s $PWD/" DEFAULT_AAP_SOCKET_FILENAME " \\\n"
+		"  -S $PWD/" DEFAULT_AAP2_SOCKET_FILENAME " \\\n"
+		"  -W " STR(BUNDLE_PROCESSOR_WORKERS) "\n"
 		#ifdef ARCHIPEL_CORE
 		"  -P $PWD/" DEFAULT_STORE_LOCATION "\n"
 		#endif
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
 #include "ud3tn/common.h"
 #include "ud3tn/contact_manager.h"
+#include "ud3tn/eid_intern.h"
 #include "ud3tn/node.h"
 #include "ud3tn/routing_table.h"
 #include "archipel-core/bundle_restore.h"
@@ -33,7 +34,8 @@ struct contact_manager_task_parameters {
 
 struct contact_info {
 	struct contact *contact;
-	char *eid;
+	// Interned EID
+	const char *eid;
 	char *cla_addr;
 };
 
@@ -109,7 +111,7 @@ static uint8_t check_upcoming(
 
 	/* Add contact */
 	ctx->current_contacts[ctx->current_contact_count].contact = c;
-	ctx->current_contacts[ctx->current_contact_count].eid = strdup(
+	ctx->current_contacts[ctx->current_contact_count].eid = eid_intern(
 		c->node->eid
 	);
 	if (!ctx->current_contacts[ctx->current_contact_count].eid) {
@@ -121,7 +123,9 @@ static uint8_t check_upcoming(
 	);
 	if (!ctx->current_contacts[ctx->current_contact_count].cla_addr) {
 		LOG_ERROR("ContactManager: Failed to copy CLA address");
-		free(ctx->current_contacts[ctx->current_contact_count].eid);
+		eid_intern_release(
+			ctx->current_contacts[ctx->current_contact_count].eid
+		);
 		return 0;
 	}
 	list[index] = ctx->current_contacts[ctx->current_contact_count];
@@ -169,6 +173,47 @@ static int8_t process_upcoming_list(
 	return added;
 }
 
+/*
+ * Determines the contacts to be started from the given snapshot, without
+ * accessing the routing table. Returns false if the result cannot be used
+ * and the contact list has to be processed with the lock held.
+ */
+static bool scan_upcoming_snapshot(
+	struct contact_manager_context *const ctx,
+	const struct routing_table_snapshot *snapshot,
+	const uint64_t current_timestamp_ms,
+	struct contact *candidates[], int8_t *candidate_count)
+{
+	uint32_t i;
+
+	*candidate_count = 0;
+	if (snapshot == NULL)
+		return false;
+
+	ctx->next_contact_time_ms = UINT64_MAX;
+	for (i = 0; i < snapshot->contact_count; i++) {
+		const struct contact_snapshot *cs = &snapshot->contacts[i];
+
+		if (cs->from_ms > current_timestamp_ms) {
+			if (cs->from_ms < ctx->next_contact_time_ms)
+				ctx->next_contact_time_ms = cs->from_ms;
+			/* The snapshot is sorted ascending by from-time */
+			break;
+		}
+		if (cs->to_ms <= current_timestamp_ms)
+			continue;
+		if (cs->to_ms < ctx->next_contact_time_ms)
+			ctx->next_contact_time_ms = cs->to_ms;
+		if (contact_active(ctx, cs->contact))
+			continue;
+		// Let the locked path issue the warnings in this case.
+		if (*candidate_count >= MAX_CONCURRENT_CONTACTS)
+			return false;
+		candidates[(*candidate_count)++] = cs->contact;
+	}
+	return true;
+}
+
 static int hand_over_contact_bundles(
 	struct contact_manager_context *const ctx, Semaphore_t semphr, int8_t i)
 {
@@ -177,7 +222,9 @@ static int hand_over_contact_bundles(
 	hal_semaphore_take_blocking(semphr);
 
 	// NOTE: cinfo.contact MAY not be valid at this point!
-	struct node_table_entry *n = routing_table_lookup_eid(cinfo.eid);
+	struct node_table_entry *n = routing_table_lookup_interned_eid(
+		cinfo.eid
+	);
 	struct contact_list *cl = (n != NULL) ? n->contacts : NULL;
 	bool found = false;
 
@@ -197,7 +244,7 @@ static int hand_over_contact_bundles(
 			cinfo.cla_addr
 		);
 		// Remove invalid contact info
-		free(cinfo.eid);
+		eid_intern_release(cinfo.eid);
 		free(cinfo.cla_addr);
 		if (i < ctx->current_contact_count - 1) {
 			memmove(
@@ -278,23 +325,53 @@ static int hand_over_contact_bundles(
 
 static uint8_t check_for_contacts(
 	struct contact_manager_context *const ctx,
-	struct contact_list *contact_list,
+	struct contact_list **contact_list, Semaphore_t semphr,
 	struct contact_info removed_contacts[])
 {
-	int8_t i;
+	int8_t i, candidate_count, removed_count, added_count = 0;
 	static struct contact_info added_contacts[MAX_CONCURRENT_CONTACTS];
+	struct contact *candidates[MAX_CONCURRENT_CONTACTS];
 	const uint64_t current_timestamp_ms = hal_time_get_timestamp_ms();
-	const int8_t removed_count = remove_expired_contacts(
+
+	// Walk through the contact plan without blocking the BP. The lock is
+	// only taken for activating the resulting contacts.
+	const struct routing_table_snapshot *snapshot =
+		routing_table_snapshot_acquire();
+	const bool scan_ok = scan_upcoming_snapshot(
 		ctx,
+		snapshot,
 		current_timestamp_ms,
-		removed_contacts
+		candidates,
+		&candidate_count
 	);
-	const int8_t added_count = process_upcoming_list(
+	const uint32_t snapshot_version = snapshot ? snapshot->version : 0;
+
+	routing_table_snapshot_release(snapshot);
+
+	hal_semaphore_take_blocking(semphr);
+	removed_count = remove_expired_contacts(
 		ctx,
-		contact_list,
 		current_timestamp_ms,
-		added_contacts
+		removed_contacts
 	);
+	if (scan_ok && snapshot_version == routing_table_get_version()) {
+		// The snapshot is current, thus, the contacts are valid.
+		for (i = 0; i < candidate_count; i++)
+			added_count += check_upcoming(
+				ctx,
+				candidates[i],
+				added_contacts,
+				added_count
+			);
+	} else {
+		added_count = process_upcoming_list(
+			ctx,
+			*contact_list,
+			current_timestamp_ms,
+			added_contacts
+		);
+	}
+	hal_semaphore_release(semphr);
 
 	ASSERT(ctx->next_contact_time_ms > current_timestamp_ms);
 
@@ -351,7 +428,7 @@ static uint8_t check_for_contacts(
 				removed_contacts[i].cla_addr
 			);
 		}
-		free(removed_contacts[i].eid);
+		eid_intern_release(removed_contacts[i].eid);
 		free(removed_contacts[i].cla_addr);
 	}
 	return removed_count;
@@ -371,9 +448,12 @@ static void manage_contacts(
 
 	// NOTE: CM_SIGNAL_UNKNOWN has both flags
 	if (HAS_FLAG(signal, CM_SIGNAL_UPDATE_CONTACT_LIST)) {
-		hal_semaphore_take_blocking(semphr);
-		removed = check_for_contacts(ctx, *contact_list, removed_list);
-		hal_semaphore_release(semphr);
+		removed = check_for_contacts(
+			ctx,
+			contact_list,
+			semphr,
+			removed_list
+		);
 		for (i = 0; i < removed; i++) {
 			/* The contact has to be deleted first... */
 			bundle_processor_inform(
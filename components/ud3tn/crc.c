@@ -15,6 +15,34 @@
 #include <stddef.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
+
+// CRC-32-C instructions of the target, if the compiler may use them (e.g.
+// with -msse4.2 or -march=armv8-a+crc).
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#define CRC32_HW_U8(crc, byte) _mm_crc32_u8((crc), (byte))
+#if defined(__x86_64__)
+#define CRC32_HW_U64(crc, word) ((uint32_t)_mm_crc32_u64((crc), (word)))
+#else // defined(__x86_64__)
+// The 64-bit variant only exists in 64-bit mode, the lower half of the
+// little-endian word holds the first four bytes.
+#define CRC32_HW_U64(crc, word) _mm_crc32_u32( \
+	_mm_crc32_u32((crc), (uint32_t)(word)), (uint32_t)((word) >> 32))
+#endif // defined(__x86_64__)
+#elif defined(__ARM_FEATURE_CRC32) && defined(__aarch64__)
+#include <arm_acle.h>
+#define CRC32_HW_U8(crc, byte) __crc32cb((crc), (byte))
+#define CRC32_HW_U64(crc, word) __crc32cd((crc), (word))
+#endif
+
+// The 64-bit variant expects the first byte in the least significant position,
+// which is only the case for words loaded via memcpy() on little-endian
+// targets. Otherwise, the data is processed byte by byte.
+#if defined(CRC32_HW_U64) && !(defined(__BYTE_ORDER__) && \
+	__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#undef CRC32_HW_U64
+#endif
 
 
 /**
@@ -79,19 +107,20 @@ static void crc16_x25_feed_eof(struct crc_stream *crc)
 	crc->checksum ^= 0xffff;
 }
 
-uint16_t crc16_x25(const uint8_t *data, size_t len)
+static uint32_t crc16_x25_update(uint32_t crc, const uint8_t *p, size_t len)
 {
-	// Initial value as defined in CRC-16 X.25
-	uint16_t crc = 0xffff;
-	const uint8_t *p = data;
-
 	while (len) {
 		crc = (crc >> 8) ^ crc16_x25_table[(crc & 0xff) ^ (*p++)];
 		len--;
 	}
 
-	// Final XOR
-	return crc ^ 0xffff;
+	return crc;
+}
+
+uint16_t crc16_x25(const uint8_t *data, size_t len)
+{
+	// Initial value as defined in CRC-16 X.25, final XOR
+	return crc16_x25_update(0xffff, data, len) ^ 0xffff;
 }
 
 
@@ -279,19 +308,43 @@ static void crc32_feed_eof(struct crc_stream *crc)
 	crc->checksum ^= 0xffffffff;
 }
 
-uint32_t crc32(const uint8_t *data, size_t len)
+static uint32_t crc32_update(uint32_t crc, const uint8_t *p, size_t len)
 {
-	// Initial value as defined in CRC-32 Ethernet
-	uint32_t crc = 0xffffffff;
-	const uint8_t *p = data;
-
+#ifdef CRC32_HW_U8
+	// The instructions operate on the reflected remainder, like the table.
+#ifdef CRC32_HW_U64
+	while (len && ((uintptr_t)p & 7)) {
+		crc = CRC32_HW_U8(crc, *p++);
+		len--;
+	}
+	while (len >= 8) {
+		uint64_t word;
+
+		// The instruction expects the bytes in little-endian order.
+		memcpy(&word, p, 8);
+		crc = CRC32_HW_U64(crc, word);
+		p += 8;
+		len -= 8;
+	}
+#endif // CRC32_HW_U64
+	while (len) {
+		crc = CRC32_HW_U8(crc, *p++);
+		len--;
+	}
+#else // CRC32_HW_U8
 	while (len) {
 		crc = (crc >> 8) ^ crc32_table[(crc & 0xff) ^ (*p++)];
 		len--;
 	}
+#endif // CRC32_HW_U8
 
-	// Final XOR
-	return crc ^ 0xffffffff;
+	return crc;
+}
+
+uint32_t crc32(const uint8_t *data, size_t len)
+{
+	// Initial value as defined in CRC-32 Ethernet, final XOR
+	return crc32_update(0xffffffff, data, len) ^ 0xffffffff;
 }
 
 
@@ -299,6 +352,16 @@ void crc_feed_bytes(struct crc_stream *crc, const uint8_t *data, size_t len)
 {
 	const uint8_t *p = data;
 
+	// Process whole buffers without an indirect call per byte.
+	if (crc->feed == crc32_feed) {
+		crc->checksum = crc32_update(crc->checksum, data, len);
+		return;
+	}
+	if (crc->feed == crc16_x25_feed) {
+		crc->checksum = crc16_x25_update(crc->checksum, data, len);
+		return;
+	}
+
 	while (len) {
 		crc->feed(crc, *p++);
 		len--;
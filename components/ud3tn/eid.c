@@ -4,7 +4,6 @@
 #include "ud3tn/result.h"
 
 #include <ctype.h>
-#include <errno.h>
 #include <inttypes.h>
 #include <limits.h>
 #include <stdint.h>
@@ -12,20 +11,28 @@
 #include <stdlib.h>
 #include <string.h>
 
-// https://datatracker.ietf.org/doc/html/draft-ietf-dtn-bpbis-31#section-4.2.5.1
 enum ud3tn_result validate_eid(const char *const eid)
 {
+	return eid_parse(eid, NULL);
+}
+
+// https://datatracker.ietf.org/doc/html/draft-ietf-dtn-bpbis-31#section-4.2.5.1
+enum ud3tn_result eid_parse(const char *const eid,
+			    struct eid_parsed *const out)
+{
+	struct eid_parsed result = { .scheme = get_eid_scheme(eid) };
 	size_t len;
 	const char *cur;
 
-	switch (get_eid_scheme(eid)) {
+	// NOTE: The offsets fit as get_eid_scheme() checks EID_MAX_LEN.
+	switch (result.scheme) {
 	case EID_SCHEME_DTN:
 		len = strlen(eid);
 		// minimum is dtn:none or dtn://C with C being a char
 		if (len < 7)
 			return UD3TN_FAIL;
 		else if (len == 8 && memcmp(eid, "dtn:none", 8) == 0)
-			return UD3TN_OK;
+			break;
 		else if (memcmp(eid, "dtn://", 6))
 			return UD3TN_FAIL;
 		// check node-name
@@ -39,19 +46,34 @@ enum ud3tn_result validate_eid(const char *const eid)
 		// fail if node-name is zero-length
 		if (cur == &eid[6])
 			return UD3TN_FAIL;
+		result.dtn_node_length = cur - &eid[6];
 		// note that we allow dtn EID with and without trailing slash
 		if (*cur == '\0')
-			return UD3TN_OK;
+			break;
 		// fail if node-name is terminated by something other than '/'
 		if (*cur != '/')
 			return UD3TN_FAIL;
 		// check demux
-		return validate_dtn_eid_demux(cur);
+		if (validate_dtn_eid_demux(cur) != UD3TN_OK)
+			return UD3TN_FAIL;
+		result.agent_id_offset = cur + 1 - eid;
+		break;
 	case EID_SCHEME_IPN:
-		return validate_ipn_eid(eid, NULL, NULL);
+		cur = parse_ipn_ull(&eid[4], &result.ipn_node);
+		if (!cur || *cur != '.')
+			return UD3TN_FAIL;
+		result.agent_id_offset = cur + 1 - eid;
+		cur = parse_ipn_ull(cur + 1, &result.ipn_service);
+		if (!cur || *cur != '\0')
+			return UD3TN_FAIL;
+		break;
 	default:
 		return UD3TN_FAIL;
 	}
+
+	if (out)
+		*out = result;
+	return UD3TN_OK;
 }
 
 enum ud3tn_result validate_dtn_eid_demux(const char *demux)
@@ -179,36 +201,31 @@ enum eid_scheme get_eid_scheme(const char *const eid)
 
 const char *parse_ipn_ull(const char *const cur, uint64_t *const out)
 {
-	unsigned long long tmp;
-	const char *next, *next_strtoull;
+	const char *next;
+	uint64_t tmp = 0;
 
 	if (!cur || *cur == '\0')
 		return NULL;
 
-	// Check that only digits are part of the substring
-	// Otherwise, strtoull may accept things like '-' and thousands
-	// separators according to the currently set locale.
-	next = cur;
-	while (*next && *next >= '0' && *next <= '9')
-		next++;
-	if (*next != '.' && *next != '\0')
-		return NULL;
-
-	errno = 0;
-	tmp = strtoull(cur, (char **)&next_strtoull, 10);
+	// Accumulate the digits directly instead of using strtoull, which
+	// may accept things like '-' and thousands separators according to
+	// the currently set locale.
+	for (next = cur; *next >= '0' && *next <= '9'; next++) {
+		const unsigned int digit = *next - '0';
 
-	// strtoull must have parsed the same as the digit check above
-	if (next != next_strtoull)
-		return NULL;
-	// Special case: returns 0 -> failed OR is actually zero
-	if (tmp == 0 && (next - cur != 1 || *cur != '0'))
+		// Special case: overflow
+		if (tmp > (UINT64_MAX - digit) / 10)
+			return NULL;
+		tmp = tmp * 10 + digit;
+	}
+	if (*next != '.' && *next != '\0')
 		return NULL;
-	// Special case: overflow
-	if (tmp == ULLONG_MAX && errno == ERANGE)
+	// Special case: no digits, or zero not given as a single "0"
+	if (tmp == 0 && next - cur != 1)
 		return NULL;
 
 	if (out)
-		*out = (uint64_t)tmp;
+		*out = tmp;
 
 	return next;
 }
@@ -0,0 +1,265 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/common.h"
+#include "ud3tn/eid.h"
+#include "ud3tn/eid_intern.h"
+#include "ud3tn/hashtable.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if EID_INTERN_SLOT_COUNT < 1
+#error "EID_INTERN_SLOT_COUNT has to be at least 1"
+#endif
+
+struct eid_intern_entry {
+	struct eid_intern_entry *next;
+	// NOTE: Modified atomically. Only the last reference is dropped with
+	// the table locked, so that lookups never resurrect a freed entry.
+	uint32_t ref_count;
+	struct eid_intern_info info;
+	// Points to eid if the EID is a node ID, otherwise holds a reference.
+	const char *node_id;
+	char eid[];
+};
+
+static struct eid_intern_entry *slots[EID_INTERN_SLOT_COUNT];
+static size_t entry_count;
+
+// A single lock protects all slots, regardless of their number. The critical
+// sections only cover the lookup in a slot, so a spinlock is sufficient.
+// Entries are allocated before taking the lock.
+static bool table_lock;
+
+static void lock_table(void)
+{
+	while (__atomic_test_and_set(&table_lock, __ATOMIC_ACQUIRE))
+		;
+}
+
+static void unlock_table(void)
+{
+	__atomic_clear(&table_lock, __ATOMIC_RELEASE);
+}
+
+static inline struct eid_intern_entry *get_entry(const char *const eid)
+{
+	return (struct eid_intern_entry *)(
+		eid - offsetof(struct eid_intern_entry, eid)
+	);
+}
+
+// Has to be called with the table locked.
+static struct eid_intern_entry *find_entry(
+	const char *const eid, const size_t length, const uint32_t hash)
+{
+	struct eid_intern_entry *e = slots[hash % EID_INTERN_SLOT_COUNT];
+
+	for (; e != NULL; e = e->next) {
+		if (e->info.hash == hash && e->info.length == length &&
+		    memcmp(e->eid, eid, length) == 0) {
+			__atomic_add_fetch(&e->ref_count, 1, __ATOMIC_RELAXED);
+			return e;
+		}
+	}
+	return NULL;
+}
+
+static struct eid_intern_entry *create_entry(
+	const char *const eid, const size_t length, const uint32_t hash)
+{
+	struct eid_intern_entry *const e = malloc(
+		sizeof(struct eid_intern_entry) + length + 1
+	);
+
+	if (e == NULL)
+		return NULL;
+
+	memcpy(e->eid, eid, length + 1);
+	e->next = NULL;
+	e->ref_count = 1;
+	e->info.hash = hash;
+	e->info.length = length;
+
+	// Parse the EID once, so that its users do not have to.
+	struct eid_parsed parsed = { .scheme = get_eid_scheme(eid) };
+
+	e->info.valid = (eid_parse(eid, &parsed) == UD3TN_OK);
+	e->info.scheme = parsed.scheme;
+	e->info.ipn_node = parsed.ipn_node;
+	e->info.ipn_service = parsed.ipn_service;
+	e->info.dtn_node_length = parsed.dtn_node_length;
+	e->info.agent_id_offset = parsed.agent_id_offset;
+
+	char *const node_id = get_node_id(eid);
+
+	if (node_id == NULL)
+		e->node_id = NULL;
+	else if (strcmp(node_id, eid) == 0)
+		e->node_id = e->eid;
+	else
+		e->node_id = eid_intern(node_id);
+	free(node_id);
+
+	return e;
+}
+
+static void free_entry(struct eid_intern_entry *const e)
+{
+	const char *const node_id = e->node_id;
+	const bool holds_node_id = (node_id != e->eid);
+
+	free(e);
+	if (holds_node_id)
+		eid_intern_release(node_id);
+}
+
+const char *eid_intern(const char *const eid)
+{
+	if (eid == NULL)
+		return NULL;
+
+	const size_t length = strlen(eid);
+	const uint32_t hash = hashtable_hash(eid, length);
+	struct eid_intern_entry *e;
+
+	lock_table();
+	e = find_entry(eid, length, hash);
+	unlock_table();
+	if (e != NULL)
+		return e->eid;
+
+	struct eid_intern_entry *const new_entry = create_entry(
+		eid,
+		length,
+		hash
+	);
+
+	if (new_entry == NULL)
+		return NULL;
+
+	lock_table();
+	// Another thread may have added the EID in the meantime.
+	e = find_entry(eid, length, hash);
+	if (e == NULL) {
+		struct eid_intern_entry **const slot = (
+			&slots[hash % EID_INTERN_SLOT_COUNT]
+		);
+
+		new_entry->next = *slot;
+		*slot = new_entry;
+		entry_count++;
+	}
+	unlock_table();
+
+	if (e != NULL) {
+		free_entry(new_entry);
+		return e->eid;
+	}
+	return new_entry->eid;
+}
+
+// Writes the decimal representation of the value backwards, ending before end.
+static char *format_u64_backwards(char *end, uint64_t value)
+{
+	do {
+		*--end = '0' + value % 10;
+		value /= 10;
+	} while (value != 0);
+	return end;
+}
+
+const char *eid_intern_ipn(const uint64_t node, const uint64_t service)
+{
+	// "ipn:" + node + "." + service + "\0"
+	char buffer[4 + 20 + 1 + 20 + 1];
+	char *cur = &buffer[sizeof(buffer) - 1];
+
+	*cur = '\0';
+	cur = format_u64_backwards(cur, service);
+	*--cur = '.';
+	cur = format_u64_backwards(cur, node);
+	cur -= 4;
+	memcpy(cur, "ipn:", 4);
+	return eid_intern(cur);
+}
+
+const char *eid_intern_take(char *const eid)
+{
+	const char *const result = eid_intern(eid);
+
+	free(eid);
+	return result;
+}
+
+const char *eid_intern_ref(const char *const eid)
+{
+	if (eid != NULL)
+		__atomic_add_fetch(
+			&get_entry(eid)->ref_count,
+			1,
+			__ATOMIC_RELAXED
+		);
+	return eid;
+}
+
+void eid_intern_release(const char *const eid)
+{
+	if (eid == NULL)
+		return;
+
+	struct eid_intern_entry *const e = get_entry(eid);
+	uint32_t ref_count = __atomic_load_n(&e->ref_count, __ATOMIC_RELAXED);
+
+	while (ref_count > 1) {
+		if (__atomic_compare_exchange_n(&e->ref_count, &ref_count,
+						ref_count - 1, true,
+						__ATOMIC_RELEASE,
+						__ATOMIC_RELAXED))
+			return;
+	}
+
+	lock_table();
+	if (__atomic_sub_fetch(&e->ref_count, 1, __ATOMIC_ACQ_REL) != 0) {
+		// The EID has been looked up again in the meantime.
+		unlock_table();
+		return;
+	}
+
+	struct eid_intern_entry **cur = (
+		&slots[e->info.hash % EID_INTERN_SLOT_COUNT]
+	);
+
+	while (*cur != e)
+		cur = &(*cur)->next;
+	*cur = e->next;
+	entry_count--;
+	unlock_table();
+
+	free_entry(e);
+}
+
+const struct eid_intern_info *eid_intern_get_info(const char *const eid)
+{
+	ASSERT(eid != NULL);
+	return &get_entry(eid)->info;
+}
+
+const char *eid_intern_get_node_id(const char *const eid)
+{
+	if (eid == NULL)
+		return NULL;
+	return get_entry(eid)->node_id;
+}
+
+size_t eid_intern_get_count(void)
+{
+	lock_table();
+
+	const size_t count = entry_count;
+
+	unlock_table();
+	return count;
+}
@@ -0,0 +1,321 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/common.h"
+#include "ud3tn/hashtable.h"
+#include "ud3tn/result.h"
+#include "ud3tn/siphash.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if (HASHTABLE_MIN_CAPACITY & (HASHTABLE_MIN_CAPACITY - 1)) != 0 || \
+	HASHTABLE_MIN_CAPACITY < 2
+#error "HASHTABLE_MIN_CAPACITY has to be a power of two"
+#endif // HASHTABLE_MIN_CAPACITY
+
+// Slots of the old array moved per insertion or removal while growing. With
+// a maximum load factor of 3/4, the old array is empty before the new one
+// (of twice the size) is half full.
+#define MIGRATE_STEP 4
+
+// Marks slots of the old array that have been emptied while growing. Probing
+// has to continue behind them, thus, they cannot be reset to NULL.
+static char tombstone;
+#define TOMBSTONE (&tombstone)
+
+uint32_t hashtable_hash(const char *const key, const size_t length)
+{
+	return (uint32_t)siphash(key, length);
+}
+
+/* SLOT ARRAYS */
+
+static inline bool is_occupied(const struct hashtable_slot *const slot)
+{
+	return slot->key != NULL && slot->key != TOMBSTONE;
+}
+
+static struct hashtable_slot *find_slot(
+	struct hashtable_slot *const slots, const size_t capacity,
+	const char *const key, const size_t length, const uint32_t hash)
+{
+	const size_t mask = capacity - 1;
+
+	if (slots == NULL)
+		return NULL;
+
+	for (size_t i = hash & mask; slots[i].key != NULL; i = (i + 1) & mask) {
+		struct hashtable_slot *const slot = &slots[i];
+
+		if (slot->hash == hash && slot->key_length == length &&
+		    slot->key != TOMBSTONE &&
+		    memcmp(slot->key, key, length) == 0)
+			return slot;
+	}
+	return NULL;
+}
+
+// Does not check whether the key is present, the array must not be full.
+static void insert_slot(struct hashtable_slot *const slots,
+			const size_t capacity,
+			const struct hashtable_slot *const entry)
+{
+	const size_t mask = capacity - 1;
+	size_t i = entry->hash & mask;
+
+	while (slots[i].key != NULL)
+		i = (i + 1) & mask;
+	slots[i] = *entry;
+}
+
+// Backward-shift deletion, keeps the array free of tombstones.
+static void delete_slot(struct hashtable_slot *const slots,
+			const size_t capacity,
+			struct hashtable_slot *const slot)
+{
+	const size_t mask = capacity - 1;
+	size_t hole = (size_t)(slot - slots);
+
+	for (size_t i = (hole + 1) & mask; slots[i].key != NULL;
+	     i = (i + 1) & mask) {
+		const size_t home = slots[i].hash & mask;
+
+		// Move the entry into the hole if the hole is on its probe
+		// sequence, i.e. cyclically between its home slot and itself.
+		if (((i - home) & mask) >= ((i - hole) & mask)) {
+			slots[hole] = slots[i];
+			hole = i;
+		}
+	}
+	slots[hole].key = NULL;
+	slots[hole].value = NULL;
+}
+
+static void release_old_slots(struct hashtable *const tab)
+{
+	free(tab->old_slots);
+	tab->old_slots = NULL;
+	tab->old_capacity = 0;
+	tab->old_count = 0;
+	tab->migrate_index = 0;
+}
+
+static void migrate(struct hashtable *const tab, size_t steps)
+{
+	while (tab->old_slots != NULL && steps-- > 0) {
+		struct hashtable_slot *const slot = (
+			&tab->old_slots[tab->migrate_index++]
+		);
+
+		if (is_occupied(slot)) {
+			insert_slot(tab->slots, tab->capacity, slot);
+			tab->count++;
+			tab->old_count--;
+			slot->key = TOMBSTONE;
+		}
+		if (tab->old_count == 0 ||
+		    tab->migrate_index == tab->old_capacity)
+			release_old_slots(tab);
+	}
+}
+
+static enum ud3tn_result grow(struct hashtable *const tab)
+{
+	const size_t capacity = (
+		tab->capacity == 0
+		? MAX(tab->initial_capacity, (size_t)HASHTABLE_MIN_CAPACITY)
+		: tab->capacity * 2
+	);
+	struct hashtable_slot *const slots = calloc(
+		capacity,
+		sizeof(struct hashtable_slot)
+	);
+
+	if (slots == NULL)
+		return UD3TN_FAIL;
+
+	// Growing again before the previous resize completed only happens if
+	// many entries are added while nothing is removed.
+	migrate(tab, SIZE_MAX);
+	tab->old_slots = tab->slots;
+	tab->old_capacity = tab->capacity;
+	tab->old_count = tab->count;
+	tab->migrate_index = 0;
+	tab->slots = slots;
+	tab->capacity = capacity;
+	tab->count = 0;
+	if (tab->old_count == 0)
+		release_old_slots(tab);
+	return UD3TN_OK;
+}
+
+static inline bool needs_growth(const struct hashtable *const tab)
+{
+	const size_t entries = tab->count + tab->old_count + 1;
+
+	return entries > tab->capacity / 4 * 3;
+}
+
+/* PUBLIC INTERFACE */
+
+void hashtable_init(struct hashtable *const tab, const size_t initial_capacity)
+{
+	ASSERT(tab != NULL);
+	tab->slots = NULL;
+	tab->capacity = 0;
+	tab->initial_capacity = HASHTABLE_MIN_CAPACITY;
+	while (tab->initial_capacity < initial_capacity &&
+	       tab->initial_capacity <= SIZE_MAX / 2)
+		tab->initial_capacity *= 2;
+	tab->count = 0;
+	tab->old_slots = NULL;
+	tab->old_capacity = 0;
+	tab->old_count = 0;
+	tab->migrate_index = 0;
+}
+
+static void clear_slots(struct hashtable_slot *const slots,
+			const size_t capacity,
+			void (*release_value)(void *))
+{
+	for (size_t i = 0; slots != NULL && i < capacity; i++) {
+		if (!is_occupied(&slots[i]))
+			continue;
+		free(slots[i].key);
+		if (release_value)
+			release_value(slots[i].value);
+	}
+	free(slots);
+}
+
+void hashtable_clear(struct hashtable *const tab,
+		     void (*release_value)(void *))
+{
+	ASSERT(tab != NULL);
+	clear_slots(tab->slots, tab->capacity, release_value);
+	clear_slots(tab->old_slots, tab->old_capacity, release_value);
+	hashtable_init(tab, tab->initial_capacity);
+}
+
+enum ud3tn_result hashtable_add_hashed(struct hashtable *const tab,
+				       const char *const key,
+				       const size_t length,
+				       const uint32_t hash, void *const value)
+{
+	ASSERT(tab != NULL);
+	ASSERT(key != NULL);
+	ASSERT(value != NULL);
+	if (!key || !value || length > UINT32_MAX)
+		return UD3TN_FAIL;
+
+	if (hashtable_get_hashed(tab, key, length, hash) != NULL)
+		return UD3TN_FAIL;
+	if (needs_growth(tab) && grow(tab) != UD3TN_OK)
+		return UD3TN_FAIL;
+
+	const struct hashtable_slot entry = {
+		.hash = hash,
+		.key_length = (uint32_t)length,
+		.key = malloc(length + 1),
+		.value = value,
+	};
+
+	if (entry.key == NULL)
+		return UD3TN_FAIL;
+	memcpy(entry.key, key, length);
+	entry.key[length] = '\0';
+
+	insert_slot(tab->slots, tab->capacity, &entry);
+	tab->count++;
+	migrate(tab, MIGRATE_STEP);
+	return UD3TN_OK;
+}
+
+enum ud3tn_result hashtable_add(struct hashtable *const tab,
+				const char *const key, void *const value)
+{
+	const size_t length = strlen(key);
+
+	return hashtable_add_hashed(
+		tab,
+		key,
+		length,
+		hashtable_hash(key, length),
+		value
+	);
+}
+
+void *hashtable_get_hashed(const struct hashtable *const tab,
+			   const char *const key, const size_t length,
+			   const uint32_t hash)
+{
+	struct hashtable_slot *slot;
+
+	ASSERT(tab != NULL);
+	slot = find_slot(tab->slots, tab->capacity, key, length, hash);
+	if (slot == NULL)
+		slot = find_slot(tab->old_slots, tab->old_capacity,
+				 key, length, hash);
+	return slot ? slot->value : NULL;
+}
+
+void *hashtable_get(const struct hashtable *const tab, const char *const key)
+{
+	const size_t length = strlen(key);
+
+	return hashtable_get_hashed(
+		tab,
+		key,
+		length,
+		hashtable_hash(key, length)
+	);
+}
+
+void *hashtable_remove_hashed(struct hashtable *const tab,
+			      const char *const key, const size_t length,
+			      const uint32_t hash)
+{
+	struct hashtable_slot *slot;
+	void *value;
+
+	ASSERT(tab != NULL);
+	slot = find_slot(tab->slots, tab->capacity, key, length, hash);
+	if (slot != NULL) {
+		value = slot->value;
+		free(slot->key);
+		delete_slot(tab->slots, tab->capacity, slot);
+		tab->count--;
+	} else {
+		slot = find_slot(tab->old_slots, tab->old_capacity,
+				 key, length, hash);
+		if (slot == NULL)
+			return NULL;
+		value = slot->value;
+		free(slot->key);
+		slot->key = TOMBSTONE;
+		slot->value = NULL;
+		tab->old_count--;
+	}
+	migrate(tab, MIGRATE_STEP);
+	return value;
+}
+
+void *hashtable_remove(struct hashtable *const tab, const char *const key)
+{
+	const size_t length = strlen(key);
+
+	return hashtable_remove_hashed(
+		tab,
+		key,
+		length,
+		hashtable_hash(key, length)
+	);
+}
+
+size_t hashtable_count(const struct hashtable *const tab)
+{
+	ASSERT(tab != NULL);
+	return tab->count + tab->old_count;
+}
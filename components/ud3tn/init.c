@@ -1,4 +1,5 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/admission_control.h"
 #include "ud3tn/agent_manager.h"
 #include "ud3tn/bundle_processor.h"
 #include "ud3tn/cmdline.h"
@@ -119,6 +120,8 @@ void start_tasks(const struct ud3tn_cmdline_options *const opt)
 			opt->status_reporting;
 	bundle_processor_task_params->allow_remote_configuration =
 			opt->allow_remote_configuration;
+	bundle_processor_task_params->worker_count =
+			opt->bp_workers;
 	#ifdef ARCHIPEL_CORE
 	bundle_processor_task_params->bundle_store =
 			bundle_store;
@@ -133,6 +136,11 @@ void start_tasks(const struct ud3tn_cmdline_options *const opt)
 		bundle_restore_task_config->restore_queue
 	);
 
+	if (admission_control_init() != UD3TN_OK) {
+		LOG_ERROR("INIT: Admission control could not be initialized!");
+		abort();
+	}
+
 	const enum ud3tn_result bp_task_result = hal_task_create(
 		bundle_processor_task,
 		bundle_processor_task_params
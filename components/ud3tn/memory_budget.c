@@ -0,0 +1,248 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/common.h"
+#include "ud3tn/memory_budget.h"
+
+#include "platform/hal_io.h"
+#include "platform/hal_task.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+static struct memory_budget_config MB = {
+	.total_bytes = MEMORY_BUDGET_TOTAL_BYTES,
+	.category_bytes = {
+		[MEMORY_BUDGET_PARSING] = MEMORY_BUDGET_PARSING_BYTES,
+		[MEMORY_BUDGET_FORWARDING] = MEMORY_BUDGET_FORWARDING_BYTES,
+		[MEMORY_BUDGET_REASSEMBLY] = MEMORY_BUDGET_REASSEMBLY_BYTES,
+		[MEMORY_BUDGET_AGENT] = MEMORY_BUDGET_AGENT_BYTES,
+		[MEMORY_BUDGET_STORE] = MEMORY_BUDGET_STORE_BYTES,
+	},
+	.backpressure_percent = MEMORY_BUDGET_BACKPRESSURE_PERCENT,
+};
+
+static const char *const category_names[MEMORY_BUDGET_CATEGORY_COUNT] = {
+	[MEMORY_BUDGET_PARSING] = "parsing",
+	[MEMORY_BUDGET_FORWARDING] = "forwarding",
+	[MEMORY_BUDGET_REASSEMBLY] = "reassembly",
+	[MEMORY_BUDGET_AGENT] = "agent",
+	[MEMORY_BUDGET_STORE] = "store",
+};
+
+// The counters are updated by all tasks handling bundles, thus, they are
+// only accessed atomically instead of being protected by a lock.
+static struct memory_budget_stats stats;
+
+static void update_peak(uint64_t *const peak, const uint64_t value)
+{
+	uint64_t old = __atomic_load_n(peak, __ATOMIC_RELAXED);
+
+	while (value > old &&
+	       !__atomic_compare_exchange_n(peak, &old, value, true,
+					    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		;
+}
+
+static void sub_clamped(uint64_t *const counter, const uint64_t bytes)
+{
+	uint64_t old = __atomic_load_n(counter, __ATOMIC_RELAXED);
+
+	// Clamp at zero like the admission control does for its counters.
+	while (!__atomic_compare_exchange_n(counter, &old,
+					    old > bytes ? old - bytes : 0,
+					    true, __ATOMIC_RELAXED,
+					    __ATOMIC_RELAXED))
+		;
+}
+
+static uint64_t get_threshold(const uint64_t budget)
+{
+	const uint8_t percent = MB.backpressure_percent;
+
+	if (percent >= 100)
+		return budget;
+	return budget / 100 * percent + (budget % 100) * percent / 100;
+}
+
+static bool exceeds(const uint64_t used, const uint64_t budget)
+{
+	return budget != 0 && used > budget;
+}
+
+// Whether pausing the RX tasks lets the memory of the category be freed,
+// see the description in memory_budget.h.
+static bool causes_backpressure(const enum memory_budget_category category)
+{
+	return category != MEMORY_BUDGET_REASSEMBLY &&
+		category != MEMORY_BUDGET_AGENT;
+}
+
+struct memory_budget_config memory_budget_get_config(void)
+{
+	return MB;
+}
+
+void memory_budget_update_config(struct memory_budget_config config)
+{
+	MB = config;
+}
+
+bool memory_budget_acquire(const enum memory_budget_category category,
+			   const uint64_t bytes)
+{
+	ASSERT(category < MEMORY_BUDGET_CATEGORY_COUNT);
+
+	const uint64_t used = __atomic_add_fetch(
+		&stats.bytes[category],
+		bytes,
+		__ATOMIC_RELAXED
+	);
+	const uint64_t total = __atomic_add_fetch(
+		&stats.total_bytes,
+		bytes,
+		__ATOMIC_RELAXED
+	);
+
+	// Optimistically account first, so that concurrent callers cannot
+	// exceed the budget together. They may be denied spuriously, though.
+	if (exceeds(used, MB.category_bytes[category]) ||
+	    exceeds(total, MB.total_bytes)) {
+		sub_clamped(&stats.bytes[category], bytes);
+		sub_clamped(&stats.total_bytes, bytes);
+		__atomic_add_fetch(&stats.rejected_count, 1, __ATOMIC_RELAXED);
+		__atomic_add_fetch(&stats.rejected_bytes, bytes,
+				   __ATOMIC_RELAXED);
+		return false;
+	}
+
+	update_peak(&stats.peak_bytes[category], used);
+	update_peak(&stats.total_peak_bytes, total);
+	return true;
+}
+
+void memory_budget_charge(const enum memory_budget_category category,
+			  const uint64_t bytes)
+{
+	ASSERT(category < MEMORY_BUDGET_CATEGORY_COUNT);
+
+	update_peak(
+		&stats.peak_bytes[category],
+		__atomic_add_fetch(&stats.bytes[category], bytes,
+				   __ATOMIC_RELAXED)
+	);
+	update_peak(
+		&stats.total_peak_bytes,
+		__atomic_add_fetch(&stats.total_bytes, bytes, __ATOMIC_RELAXED)
+	);
+}
+
+void memory_budget_release(const enum memory_budget_category category,
+			   const uint64_t bytes)
+{
+	ASSERT(category < MEMORY_BUDGET_CATEGORY_COUNT);
+
+	sub_clamped(&stats.bytes[category], bytes);
+	sub_clamped(&stats.total_bytes, bytes);
+}
+
+bool memory_budget_is_congested(void)
+{
+	uint64_t total = 0;
+
+	for (int i = 0; i < MEMORY_BUDGET_CATEGORY_COUNT; i++) {
+		if (!causes_backpressure(i))
+			continue;
+
+		const uint64_t used = __atomic_load_n(
+			&stats.bytes[i],
+			__ATOMIC_RELAXED
+		);
+
+		if (MB.category_bytes[i] != 0 &&
+		    used > get_threshold(MB.category_bytes[i]))
+			return true;
+		total += used;
+	}
+
+	return MB.total_bytes != 0 && total > get_threshold(MB.total_bytes);
+}
+
+bool memory_budget_wait(bool (*should_stop)(void *), void *param)
+{
+	if (!memory_budget_is_congested())
+		return false;
+
+	__atomic_add_fetch(&stats.backpressure_count, 1, __ATOMIC_RELAXED);
+	LOGF_DEBUG(
+		"MemoryBudget: %" PRIu64 " bytes in use, pausing until memory is freed",
+		__atomic_load_n(&stats.total_bytes, __ATOMIC_RELAXED)
+	);
+
+	while (!(should_stop && should_stop(param)) &&
+	       memory_budget_is_congested())
+		hal_task_delay(MEMORY_BUDGET_BACKPRESSURE_POLL_MS);
+
+	return true;
+}
+
+struct memory_budget_stats memory_budget_get_stats(void)
+{
+	struct memory_budget_stats result;
+
+	result.total_bytes = __atomic_load_n(
+		&stats.total_bytes,
+		__ATOMIC_RELAXED
+	);
+	result.total_peak_bytes = __atomic_load_n(
+		&stats.total_peak_bytes,
+		__ATOMIC_RELAXED
+	);
+	for (int i = 0; i < MEMORY_BUDGET_CATEGORY_COUNT; i++) {
+		result.bytes[i] = __atomic_load_n(
+			&stats.bytes[i],
+			__ATOMIC_RELAXED
+		);
+		result.peak_bytes[i] = __atomic_load_n(
+			&stats.peak_bytes[i],
+			__ATOMIC_RELAXED
+		);
+	}
+	result.rejected_count = __atomic_load_n(
+		&stats.rejected_count,
+		__ATOMIC_RELAXED
+	);
+	result.rejected_bytes = __atomic_load_n(
+		&stats.rejected_bytes,
+		__ATOMIC_RELAXED
+	);
+	result.backpressure_count = __atomic_load_n(
+		&stats.backpressure_count,
+		__ATOMIC_RELAXED
+	);
+
+	return result;
+}
+
+void memory_budget_log_stats(void)
+{
+	const struct memory_budget_stats s = memory_budget_get_stats();
+
+	LOGF_INFO(
+		"MemoryBudget: %" PRIu64 " bytes in use, peak %" PRIu64 ", budget %" PRIu64 ", %" PRIu64 " requests (%" PRIu64 " bytes) denied, %" PRIu64 " pauses",
+		s.total_bytes,
+		s.total_peak_bytes,
+		MB.total_bytes,
+		s.rejected_count,
+		s.rejected_bytes,
+		s.backpressure_count
+	);
+	for (int i = 0; i < MEMORY_BUDGET_CATEGORY_COUNT; i++)
+		LOGF_INFO(
+			"MemoryBudget: %s: %" PRIu64 " bytes in use, peak %" PRIu64 ", budget %" PRIu64,
+			category_names[i],
+			s.bytes[i],
+			s.peak_bytes[i],
+			MB.category_bytes[i]
+		);
+}
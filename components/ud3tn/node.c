@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
 #include "ud3tn/common.h"
 #include "ud3tn/node.h"
+#include "ud3tn/object_pool.h"
 #include "ud3tn/result.h"
 
 #include "platform/hal_time.h"
@@ -11,6 +12,11 @@
 #include <string.h>
 #include <stdbool.h>
 
+struct object_pool routed_bundle_list_pool =
+	OBJECT_POOL_INITIALIZER("routed_bundle_list", struct routed_bundle_list);
+struct object_pool contact_list_pool =
+	OBJECT_POOL_INITIALIZER("contact_list", struct contact_list);
+
 static int contacts_overlap(struct contact *a, struct contact *b)
 {
 	return (
@@ -75,7 +81,7 @@ static void free_contact_internal(
 	cur_bundle = contact->contact_bundles;
 	while (cur_bundle != NULL) {
 		next = cur_bundle->next;
-		free(cur_bundle);
+		object_pool_free(&routed_bundle_list_pool, cur_bundle);
 		cur_bundle = next;
 	}
 	free(contact);
@@ -248,7 +254,7 @@ struct contact_list *contact_list_free(struct contact_list *e)
 		return NULL;
 	next = e->next;
 	free_contact(e->data);
-	free(e);
+	object_pool_free(&contact_list_pool, e);
 	return next;
 }
 
@@ -261,7 +267,7 @@ static struct contact_list *contact_list_free_internal(
 		return NULL;
 	next = e->next;
 	free_contact_internal(e->data, free_eid_list);
-	free(e);
+	object_pool_free(&contact_list_pool, e);
 	return next;
 }
 
@@ -271,7 +277,7 @@ static inline void add_to_modified_list(
 	struct contact_list *l;
 
 	if (modified != NULL) {
-		l = malloc(sizeof(struct contact_list));
+		l = object_pool_alloc(&contact_list_pool);
 		if (l != NULL) {
 			l->next = *modified;
 			l->data = c;
@@ -422,7 +428,10 @@ struct contact_list *contact_list_difference(
 					} else if ((*cur_slot)->data->active) {
 						l = *cur_slot;
 						*cur_slot = l->next;
-						free(l);
+						object_pool_free(
+							&contact_list_pool,
+							l
+						);
 					} else {
 						*cur_slot = contact_list_free_internal(
 							*cur_slot,
@@ -590,7 +599,7 @@ int add_contact_to_ordered_list(
 		}
 		cur_entry = &(*cur_entry)->next;
 	}
-	new_entry = malloc(sizeof(struct contact_list));
+	new_entry = object_pool_alloc(&contact_list_pool);
 	if (new_entry == NULL)
 		return 0;
 	new_entry->data = contact;
@@ -614,7 +623,7 @@ int remove_contact_from_list(
 		if ((*cur_entry)->data == contact) {
 			tmp = *cur_entry;
 			*cur_entry = (*cur_entry)->next;
-			free(tmp);
+			object_pool_free(&contact_list_pool, tmp);
 			return 1;
 		}
 		cur_entry = &(*cur_entry)->next;
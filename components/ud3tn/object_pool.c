@@ -0,0 +1,348 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/common.h"
+#include "ud3tn/object_pool.h"
+
+#include "platform/hal_io.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if OBJECT_POOL_CACHE_SIZE < 1
+#error "OBJECT_POOL_CACHE_SIZE has to be at least 1"
+#endif // OBJECT_POOL_CACHE_SIZE
+
+// Free objects are linked using their first bytes.
+struct object_pool_object {
+	struct object_pool_object *next;
+};
+
+struct object_pool_slab {
+	struct object_pool_slab *next;
+};
+
+// Objects are aligned like memory returned by malloc().
+union object_alignment {
+	long long ll;
+	long double ld;
+	void *ptr;
+};
+
+#define OBJECT_ALIGNMENT __alignof__(union object_alignment)
+#define ALIGN_UP(size) \
+	(((size) + OBJECT_ALIGNMENT - 1) / OBJECT_ALIGNMENT * OBJECT_ALIGNMENT)
+
+struct object_cache {
+	struct object_pool_object *head;
+	struct object_pool_object *tail;
+	uint32_t count;
+	// Change of the number of objects in use not yet added to the pool's
+	// statistics, to not touch a shared counter on every operation.
+	int32_t pending_in_use;
+};
+
+// Free objects owned by the current thread, indexed by pool->cache_index - 1.
+static __thread struct object_cache thread_caches[OBJECT_POOL_MAX_POOLS];
+
+// All pools that have been used so far, only ever prepended to.
+static struct object_pool *used_pools;
+static int used_pool_count;
+
+static int get_cache_index(struct object_pool *const pool)
+{
+	int index = __atomic_load_n(&pool->cache_index, __ATOMIC_ACQUIRE);
+	int expected = 0;
+
+	if (index > 0)
+		return index - 1;
+
+	if (!__atomic_compare_exchange_n(&pool->cache_index, &expected, -1,
+					 false, __ATOMIC_ACQUIRE,
+					 __ATOMIC_ACQUIRE)) {
+		// Another thread is registering the pool right now.
+		do {
+			index = __atomic_load_n(&pool->cache_index,
+						__ATOMIC_ACQUIRE);
+		} while (index <= 0);
+		return index - 1;
+	}
+
+	index = __atomic_fetch_add(&used_pool_count, 1, __ATOMIC_RELAXED);
+	if (!OBJECT_POOL_USE_MALLOC && index >= OBJECT_POOL_MAX_POOLS)
+		LOGF_WARN(
+			"ObjectPool: More than %d pools in use, \"%s\" falls back to malloc",
+			OBJECT_POOL_MAX_POOLS,
+			pool->name
+		);
+	pool->next = __atomic_load_n(&used_pools, __ATOMIC_RELAXED);
+	while (!__atomic_compare_exchange_n(&used_pools, &pool->next, pool,
+					    true, __ATOMIC_RELEASE,
+					    __ATOMIC_RELAXED))
+		;
+	__atomic_store_n(&pool->cache_index, index + 1, __ATOMIC_RELEASE);
+	return index;
+}
+
+static inline bool uses_cache(const int index)
+{
+	return !OBJECT_POOL_USE_MALLOC && index < OBJECT_POOL_MAX_POOLS;
+}
+
+static void push_global(struct object_pool *const pool,
+			struct object_pool_object *const head,
+			struct object_pool_object *const tail)
+{
+	struct object_pool_object *old = __atomic_load_n(
+		&pool->free_list,
+		__ATOMIC_RELAXED
+	);
+
+	do {
+		tail->next = old;
+	} while (!__atomic_compare_exchange_n(&pool->free_list, &old, head,
+					      true, __ATOMIC_RELEASE,
+					      __ATOMIC_RELAXED));
+}
+
+static bool allocate_slab(struct object_pool *const pool,
+			  struct object_cache *const cache)
+{
+	const size_t header_size = ALIGN_UP(sizeof(struct object_pool_slab));
+	const size_t stride = ALIGN_UP(MAX(
+		pool->object_size,
+		sizeof(struct object_pool_object)
+	));
+	struct object_pool_slab *const slab = malloc(
+		header_size + stride * OBJECT_POOL_SLAB_OBJECTS
+	);
+	uint8_t *objects;
+	struct object_pool_object *next = NULL;
+
+	if (slab == NULL)
+		return false;
+
+	objects = (uint8_t *)slab + header_size;
+
+	for (int i = OBJECT_POOL_SLAB_OBJECTS - 1; i >= 0; i--) {
+		struct object_pool_object *const obj = (void *)(
+			objects + i * stride
+		);
+
+		obj->next = next;
+		next = obj;
+	}
+	cache->head = next;
+	cache->tail = (void *)(
+		objects + (OBJECT_POOL_SLAB_OBJECTS - 1) * stride
+	);
+	cache->count = OBJECT_POOL_SLAB_OBJECTS;
+
+	// Slabs are never released, they are only tracked to keep them
+	// reachable (e.g., for leak checkers).
+	slab->next = __atomic_load_n(&pool->slabs, __ATOMIC_RELAXED);
+	while (!__atomic_compare_exchange_n(&pool->slabs, &slab->next, slab,
+					    true, __ATOMIC_RELEASE,
+					    __ATOMIC_RELAXED))
+		;
+	__atomic_add_fetch(&pool->capacity, OBJECT_POOL_SLAB_OBJECTS,
+			   __ATOMIC_RELAXED);
+	return true;
+}
+
+static bool refill(struct object_pool *const pool,
+		   struct object_cache *const cache)
+{
+	// Taking over the whole list at once is not prone to the ABA problem
+	// that popping single objects using CAS would have.
+	struct object_pool_object *obj = __atomic_exchange_n(
+		&pool->free_list,
+		NULL,
+		__ATOMIC_ACQUIRE
+	);
+
+	if (obj == NULL)
+		return allocate_slab(pool, cache);
+
+	cache->head = obj;
+	cache->count = 1;
+	while (obj->next != NULL) {
+		obj = obj->next;
+		cache->count++;
+	}
+	cache->tail = obj;
+	return true;
+}
+
+// Keep the most recently used objects, return the others to the global list.
+static void flush_surplus(struct object_pool *const pool,
+			  struct object_cache *const cache)
+{
+	struct object_pool_object *last_kept = cache->head;
+
+	for (uint32_t i = 1; i < OBJECT_POOL_CACHE_SIZE; i++)
+		last_kept = last_kept->next;
+	push_global(pool, last_kept->next, cache->tail);
+	last_kept->next = NULL;
+	cache->tail = last_kept;
+	cache->count = OBJECT_POOL_CACHE_SIZE;
+}
+
+static void account_in_use(struct object_pool *const pool,
+			   const int32_t change)
+{
+	// NOTE: May become negative temporarily if objects are released by
+	// threads publishing their changes before the allocating thread.
+	const int32_t in_use = __atomic_add_fetch(
+		&pool->in_use,
+		change,
+		__ATOMIC_RELAXED
+	);
+	int32_t high_water = __atomic_load_n(
+		&pool->high_water,
+		__ATOMIC_RELAXED
+	);
+
+	while (in_use > high_water &&
+	       !__atomic_compare_exchange_n(&pool->high_water, &high_water,
+					    in_use, true, __ATOMIC_RELAXED,
+					    __ATOMIC_RELAXED))
+		;
+}
+
+static void publish_in_use(struct object_pool *const pool,
+			   struct object_cache *const cache)
+{
+	if (cache->pending_in_use == 0)
+		return;
+	account_in_use(pool, cache->pending_in_use);
+	cache->pending_in_use = 0;
+}
+
+void *object_pool_alloc(struct object_pool *const pool)
+{
+	const int index = get_cache_index(pool);
+	struct object_pool_object *obj;
+
+	if (uses_cache(index)) {
+		struct object_cache *const cache = &thread_caches[index];
+
+		if (cache->head == NULL) {
+			publish_in_use(pool, cache);
+			if (!refill(pool, cache))
+				return NULL;
+		}
+		obj = cache->head;
+		cache->head = obj->next;
+		cache->count--;
+		if (++cache->pending_in_use >= OBJECT_POOL_CACHE_SIZE)
+			publish_in_use(pool, cache);
+	} else {
+		obj = malloc(pool->object_size);
+		if (obj == NULL)
+			return NULL;
+		account_in_use(pool, 1);
+	}
+
+	return obj;
+}
+
+void object_pool_free(struct object_pool *const pool, void *const object)
+{
+	const int index = get_cache_index(pool);
+	struct object_pool_object *const obj = object;
+
+	if (object == NULL)
+		return;
+
+	if (!uses_cache(index)) {
+		account_in_use(pool, -1);
+		free(object);
+		return;
+	}
+
+	struct object_cache *const cache = &thread_caches[index];
+
+	obj->next = cache->head;
+	if (cache->head == NULL)
+		cache->tail = obj;
+	cache->head = obj;
+	cache->count++;
+	if (--cache->pending_in_use <= -OBJECT_POOL_CACHE_SIZE)
+		publish_in_use(pool, cache);
+	// Threads that only release objects (e.g., the TX tasks) pass them on
+	// to the threads allocating them.
+	if (cache->count > 2 * OBJECT_POOL_CACHE_SIZE)
+		flush_surplus(pool, cache);
+}
+
+struct object_pool_stats object_pool_get_stats(struct object_pool *const pool)
+{
+	const int index = get_cache_index(pool);
+
+	if (uses_cache(index))
+		publish_in_use(pool, &thread_caches[index]);
+
+	const int32_t in_use = __atomic_load_n(
+		&pool->in_use,
+		__ATOMIC_RELAXED
+	);
+
+	return (struct object_pool_stats) {
+		.in_use = in_use < 0 ? 0 : in_use,
+		.high_water = __atomic_load_n(
+			&pool->high_water,
+			__ATOMIC_RELAXED
+		),
+		.capacity = __atomic_load_n(&pool->capacity, __ATOMIC_RELAXED),
+	};
+}
+
+void object_pool_log_stats(void)
+{
+	struct object_pool *pool = __atomic_load_n(
+		&used_pools,
+		__ATOMIC_ACQUIRE
+	);
+
+	for (; pool != NULL; pool = pool->next) {
+		const struct object_pool_stats stats = object_pool_get_stats(
+			pool
+		);
+
+		LOGF_INFO(
+			"ObjectPool: %s (%zu bytes): %" PRIu32 " in use, high-water mark %" PRIu32 ", capacity %" PRIu32,
+			pool->name,
+			pool->object_size,
+			stats.in_use,
+			stats.high_water,
+			stats.capacity
+		);
+	}
+}
+
+void object_pool_thread_flush(void)
+{
+	struct object_pool *pool = __atomic_load_n(
+		&used_pools,
+		__ATOMIC_ACQUIRE
+	);
+
+	for (; pool != NULL; pool = pool->next) {
+		const int index = get_cache_index(pool);
+
+		if (!uses_cache(index))
+			continue;
+
+		struct object_cache *const cache = &thread_caches[index];
+
+		publish_in_use(pool, cache);
+		if (cache->head == NULL)
+			continue;
+		push_global(pool, cache->head, cache->tail);
+		cache->head = NULL;
+		cache->tail = NULL;
+		cache->count = 0;
+	}
+}
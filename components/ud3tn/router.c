@@ -1,8 +1,9 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
 #include "ud3tn/bundle.h"
 #include "ud3tn/common.h"
-#include "ud3tn/eid.h"
+#include "ud3tn/eid_intern.h"
 #include "ud3tn/node.h"
+#include "ud3tn/object_pool.h"
 #include "ud3tn/router.h"
 #include "ud3tn/routing_table.h"
 
@@ -19,8 +20,12 @@ static struct router_config RC = {
 	.global_mbs = ROUTER_GLOBAL_MBS,
 	.fragment_min_payload = FRAGMENT_MIN_PAYLOAD,
 	.router_min_contacts_htab = ROUTER_MIN_CONTACTS_HTAB,
+	.preemption_enabled = ROUTER_PREEMPTION,
 };
 
+// NOTE: Protected by the routing table lock, as is the rest of the router.
+static struct router_preemption_stats preemption_stats;
+
 struct router_config router_get_config(void)
 {
 	return RC;
@@ -31,18 +36,26 @@ void router_update_config(struct router_config conf)
 	RC = conf;
 }
 
-struct contact_list *router_lookup_destination(char *const dest)
+static const struct node_table_entry *lookup_destination_entry(
+	const char *const dest)
 {
-	char *dest_node_eid = get_node_id(dest);
+	// The node ID is determined once per distinct EID when interning it.
+	const char *const dest_node_eid = eid_intern_get_node_id(dest);
 	const struct node_table_entry *e = NULL;
 
 	if (dest_node_eid)
-		e = routing_table_lookup_eid(dest_node_eid);
+		e = routing_table_lookup_interned_eid(dest_node_eid);
 
 	// Fallback: perform a "dumb" string lookup
-	if (!dest_node_eid || !e)
-		e = routing_table_lookup_eid(dest);
+	if (!dest_node_eid || (!e && dest_node_eid != dest))
+		e = routing_table_lookup_interned_eid(dest);
+
+	return e;
+}
 
+struct contact_list *router_lookup_destination(const char *const dest)
+{
+	const struct node_table_entry *const e = lookup_destination_entry(dest);
 	struct contact_list *result = NULL;
 
 	if (e != NULL) {
@@ -54,8 +67,6 @@ struct contact_list *router_lookup_destination(char *const dest)
 		}
 	}
 
-	free(dest_node_eid);
-
 	return result;
 }
 
@@ -69,20 +80,20 @@ static inline struct max_fragment_size_result {
 {
 	uint32_t payload_capacity = 0;
 	uint32_t max_frag_size = UINT32_MAX;
-	uint32_t min_capacity, c_capacity;
+	uint32_t c_capacity;
 	int32_t c_pay_capacity;
 	struct contact *c;
 
 	(void)exp_time;
-	min_capacity = payload_size / ROUTER_MAX_FRAGMENTS;
-	min_capacity += max_fragment_min_size;
+	// NOTE: There is no limit on the number of fragments, thus, every
+	// contact able to carry a minimum-size fragment is considered.
 	while (contacts != NULL && payload_capacity < payload_size) {
 		c = contacts->data;
 		contacts = contacts->next;
 		//if (c->to_s > exp_time)
 		//	break;
 		c_capacity = ROUTER_CONTACT_CAPACITY(c, priority);
-		if (c_capacity < min_capacity)
+		if (c_capacity < max_fragment_min_size)
 			continue;
 
 		// A CLA may have a maximum bundle size, determine it
@@ -93,11 +104,10 @@ static inline struct max_fragment_size_result {
 		if (!cla_config)
 			continue;
 
+		// NOTE: The contact capacity is not taken into account here,
+		// the fragmentation planner fills every contact up to it.
 		const size_t c_mbs = MIN(
-			MIN(
-				(size_t)c_capacity,
-				cla_config->vtable->cla_mbs_get(cla_config)
-			),
+			cla_config->vtable->cla_mbs_get(cla_config),
 			RC.global_mbs
 		);
 
@@ -177,101 +187,306 @@ uint8_t router_calculate_fragment_route(
 	return (res->contact != NULL);
 }
 
+static void release_contact_capacity(
+	struct contact *contact, struct bundle *bundle, const size_t bundle_size)
+{
+	const enum bundle_routing_priority prio =
+		bundle_get_routing_priority(bundle);
+
+	// This contact is of infinite capacity, do nothing.
+	if (contact->remaining_capacity_p0 == INT32_MAX)
+		return;
+
+	contact->remaining_capacity_p0 += bundle_size;
+	if (prio > BUNDLE_RPRIO_LOW) {
+		contact->remaining_capacity_p1 += bundle_size;
+		if (prio != BUNDLE_RPRIO_NORMAL)
+			contact->remaining_capacity_p2 += bundle_size;
+	}
+}
+
+static struct routed_bundle_list *reverse_bundle_list(
+	struct routed_bundle_list *list)
+{
+	struct routed_bundle_list *result = NULL, *next;
+
+	while (list != NULL) {
+		next = list->next;
+		list->next = result;
+		result = list;
+		list = next;
+	}
+	return result;
+}
+
+static void evict_bundles(
+	struct contact *contact, uint32_t size,
+	enum bundle_routing_priority victim_priority,
+	struct routed_bundle_list **evicted)
+{
+	// Walk the FIFO starting with the most recently added bundle.
+	// Prepending the kept entries restores the original order.
+	struct routed_bundle_list *cur = reverse_bundle_list(
+		contact->contact_bundles
+	);
+	struct routed_bundle_list *kept = NULL, *next;
+
+	while (cur != NULL) {
+		next = cur->next;
+		if (ROUTER_CONTACT_CAPACITY(contact, 0) < (int32_t)size &&
+		    bundle_get_routing_priority(cur->data) == victim_priority) {
+			const size_t bundle_size =
+				bundle_get_serialized_size(cur->data);
+
+			release_contact_capacity(contact, cur->data, bundle_size);
+			preemption_stats.evicted_bundles[victim_priority]++;
+			preemption_stats.evicted_bytes[victim_priority] +=
+				bundle_size;
+			cur->next = *evicted;
+			*evicted = cur;
+		} else {
+			cur->next = kept;
+			kept = cur;
+		}
+		cur = next;
+	}
+	contact->contact_bundles = kept;
+}
+
+struct contact *router_preempt_contact(
+	struct contact_list *contacts, uint32_t size,
+	enum bundle_routing_priority priority, uint64_t exp_time_ms,
+	struct routed_bundle_list **evicted)
+{
+	const uint64_t time_ms = hal_time_get_timestamp_ms();
+	struct contact *c = NULL;
+	enum bundle_routing_priority victim_priority;
+
+	// There is nothing lower-priority bundles could be displaced for.
+	if (priority == BUNDLE_RPRIO_LOW)
+		return NULL;
+
+	while (contacts != NULL) {
+		c = contacts->data;
+		contacts = contacts->next;
+		if (c->from_ms >= exp_time_ms || c->to_ms <= time_ms ||
+		    ROUTER_CONTACT_CAPACITY(c, 0) >= (int32_t)size ||
+		    ROUTER_CONTACT_CAPACITY(c, priority) < (int32_t)size) {
+			c = NULL;
+			continue;
+		}
+		break;
+	}
+	if (c == NULL)
+		return NULL;
+
+	// After removing all lower-priority bundles, the remaining capacity
+	// equals the capacity for the given priority, thus, this suffices.
+	for (victim_priority = BUNDLE_RPRIO_LOW;
+	     victim_priority < priority &&
+	     ROUTER_CONTACT_CAPACITY(c, 0) < (int32_t)size;
+	     victim_priority++)
+		evict_bundles(c, size, victim_priority, evicted);
+	preemption_stats.preemptions++;
+
+	return c;
+}
+
+struct bundle *router_evict_bundle(
+	struct contact_list *contacts,
+	bool (*may_evict)(struct bundle *bundle, const void *param),
+	const void *param)
+{
+	struct contact *victim_contact = NULL;
+	struct bundle *victim = NULL;
+	enum bundle_routing_priority victim_priority = BUNDLE_RPRIO_MAX;
+
+	// Later contacts and, per contact, later bundles replace earlier
+	// candidates of the same priority.
+	for (; contacts != NULL; contacts = contacts->next) {
+		struct routed_bundle_list *cur;
+
+		for (cur = contacts->data->contact_bundles; cur != NULL;
+		     cur = cur->next) {
+			const enum bundle_routing_priority prio =
+				bundle_get_routing_priority(cur->data);
+
+			if (prio > victim_priority ||
+			    !may_evict(cur->data, param))
+				continue;
+			victim = cur->data;
+			victim_contact = contacts->data;
+			victim_priority = prio;
+		}
+	}
+
+	if (victim != NULL)
+		router_remove_bundle_from_contact(victim_contact, victim);
+	return victim;
+}
+
+struct router_preemption_stats router_get_preemption_stats(void)
+{
+	return preemption_stats;
+}
+
+static struct fragment_route *router_result_append(struct router_result *res)
+{
+	if (res->fragments == res->fragment_capacity) {
+		const int32_t capacity = (
+			res->fragment_capacity ? 2 * res->fragment_capacity : 1
+		);
+		struct fragment_route *const fr = realloc(
+			res->fragment_results,
+			capacity * sizeof(struct fragment_route)
+		);
+
+		if (fr == NULL)
+			return NULL;
+		res->fragment_results = fr;
+		res->fragment_capacity = capacity;
+	}
+	return &res->fragment_results[res->fragments];
+}
+
+void router_result_free(struct router_result *res)
+{
+	free(res->fragment_results);
+	res->fragment_results = NULL;
+	res->fragment_capacity = 0;
+	res->fragments = 0;
+}
+
 static inline void router_get_first_route_nonfrag(
 	struct router_result *res, struct contact_list *contacts,
 	struct bundle *bundle, uint32_t bundle_size,
 	uint64_t expiration_time_ms)
 {
-	res->fragment_results[0].payload_size = bundle->payload_block->length;
+	struct fragment_route *const fr = router_result_append(res);
+
+	if (fr == NULL)
+		return;
+	fr->payload_size = bundle->payload_block->length;
 	/* Determine route */
 	if (router_calculate_fragment_route(
-		&res->fragment_results[0], bundle_size,
+		fr, bundle_size,
 		contacts, 0, ROUTER_BUNDLE_PRIORITY(bundle), expiration_time_ms,
 		NULL, 0)
 	) {
 		res->fragments = 1;
-		res->preemption_improved = res->fragment_results[0].preemption_improved;
+		res->preemption_improved = fr->preemption_improved;
+		return;
+	}
+	res->preemption_improved = fr->preemption_improved;
+
+	if (!RC.preemption_enabled || fr->preemption_improved == 0)
+		return;
+
+	fr->contact = router_preempt_contact(
+		contacts,
+		bundle_size,
+		ROUTER_BUNDLE_PRIORITY(bundle),
+		expiration_time_ms,
+		&res->preempted_bundles
+	);
+	if (fr->contact) {
+		LOGF_DEBUG(
+			"Router: Displaced lower-priority bundles for bundle %p",
+			bundle
+		);
+		res->fragments = 1;
 	}
 }
 
-static inline void router_get_first_route_frag(
+uint8_t router_plan_fragments(
 	struct router_result *res, struct contact_list *contacts,
-	struct bundle *bundle, uint32_t bundle_size,
-	uint64_t expiration_time_ms,
-	uint32_t max_frag_sz, uint32_t first_frag_sz, uint32_t last_frag_sz)
+	struct bundle *bundle, uint64_t exp_time_ms, uint32_t max_frag_sz)
 {
-	uint32_t mid_frag_sz, next_frag_sz, remaining_pay, processed_sz;
-	int32_t min_pay, max_pay;
-	int32_t success, index;
-
-	/* Determine fragment minimum sizes */
-	mid_frag_sz = bundle_get_mid_fragment_min_size(bundle);
-	next_frag_sz = first_frag_sz;
-	if (next_frag_sz > max_frag_sz || last_frag_sz > max_frag_sz) {
+	const uint64_t time_ms = hal_time_get_timestamp_ms();
+	const enum bundle_routing_priority prio = ROUTER_BUNDLE_PRIORITY(bundle);
+	const uint32_t first_frag_sz = bundle_get_first_fragment_min_size(
+		bundle
+	);
+	const uint32_t mid_frag_sz = bundle_get_mid_fragment_min_size(bundle);
+	const uint32_t last_frag_sz = bundle_get_last_fragment_min_size(bundle);
+	uint32_t remaining_pay = bundle->payload_block->length;
+	uint32_t cap, limit, header_sz, min_pay;
+	struct fragment_route *fr;
+	struct contact *c;
+	bool infinite;
+
+	res->fragments = 0;
+	res->preemption_improved = 0;
+	if (first_frag_sz > max_frag_sz || last_frag_sz > max_frag_sz) {
 		LOGF_INFO(
 			"Router: Cannot fragment because max. frag. size of %lu bytes is smaller than bundle headers (first = %lu, mid = %lu, last = %lu)",
 			max_frag_sz,
-			next_frag_sz,
+			first_frag_sz,
 			mid_frag_sz,
 			last_frag_sz
 		);
-		return; /* failed */
+		return 0;
 	}
 
-	remaining_pay = bundle->payload_block->length;
-	while (remaining_pay != 0 && res->fragments < ROUTER_MAX_FRAGMENTS) {
-		min_pay = MIN(remaining_pay, RC.fragment_min_payload);
-		max_pay = max_frag_sz - next_frag_sz;
-		if (max_pay < min_pay) {
-			LOGF_INFO(
-				"Router: Cannot fragment because minimum amount of payload (%lu bytes) will not fit in fragment with maximum payload size of %lu bytes",
-				min_pay,
-				max_pay
-			);
-			break; /* failed: remaining_pay != 0 */
+	// The contacts are ordered by their end time, fill each one up to its
+	// remaining capacity before continuing with the next one.
+	for (; contacts != NULL && remaining_pay != 0;
+	     contacts = contacts->next) {
+		c = contacts->data;
+		if (c->from_ms >= exp_time_ms || c->to_ms <= time_ms)
+			continue;
+		if (ROUTER_CONTACT_CAPACITY(c, 0) <= 0) {
+			if (ROUTER_CONTACT_CAPACITY(c, prio) > 0)
+				res->preemption_improved++;
+			continue;
 		}
-		if (remaining_pay <= max_frag_sz - last_frag_sz) {
-			/* Last fragment */
-			res->fragment_results[res->fragments++].payload_size = remaining_pay;
-			remaining_pay = 0;
-		} else {
-			/* Another fragment */
-			max_pay = MIN((int32_t)remaining_pay, max_pay);
-			res->fragment_results[res->fragments++].payload_size = max_pay;
-			remaining_pay -= max_pay;
-			next_frag_sz = mid_frag_sz;
+		cap = ROUTER_CONTACT_CAPACITY(c, 0);
+		infinite = (cap >= INT32_MAX);
+		while (remaining_pay != 0) {
+			limit = MIN(cap, max_frag_sz);
+			/* Can the rest be sent as last fragment? */
+			header_sz = (
+				res->fragments == 0
+				? MAX(first_frag_sz, last_frag_sz)
+				: last_frag_sz
+			);
+			if (limit < header_sz ||
+			    remaining_pay > limit - header_sz) {
+				/* No, create another fragment */
+				header_sz = (
+					res->fragments == 0
+					? first_frag_sz
+					: mid_frag_sz
+				);
+				min_pay = MIN(
+					remaining_pay,
+					RC.fragment_min_payload
+				);
+				if (limit < header_sz + min_pay)
+					break; /* next contact */
+			}
+			fr = router_result_append(res);
+			if (fr == NULL) {
+				res->fragments = 0;
+				return 0;
+			}
+			fr->payload_size = MIN(remaining_pay, limit - header_sz);
+			fr->contact = c;
+			fr->preemption_improved = 0;
+			res->fragments++;
+			remaining_pay -= fr->payload_size;
+			if (!infinite)
+				cap -= fr->payload_size + header_sz;
 		}
 	}
+
 	if (remaining_pay != 0) {
 		res->fragments = 0;
-		return; /* failed */
+		return 0;
 	}
-
-	/* Determine routes */
-	success = 0;
-	res->preemption_improved = 0;
-	processed_sz = 0;
-	for (index = 0; index < res->fragments; index++) {
-		bundle_size = res->fragment_results[index].payload_size;
-		if (index == 0)
-			bundle_size += first_frag_sz;
-		else if (index == res->fragments - 1)
-			bundle_size += last_frag_sz;
-		else
-			bundle_size += mid_frag_sz;
-		success += router_calculate_fragment_route(
-			&res->fragment_results[index], bundle_size,
-			contacts, processed_sz, ROUTER_BUNDLE_PRIORITY(bundle),
-			expiration_time_ms, NULL, 0);
-		res->preemption_improved +=
-			res->fragment_results[index].preemption_improved;
-		processed_sz += bundle_size;
-	}
-	if (success != res->fragments)
-		res->fragments = 0;
+	return 1;
 }
 
-/* max. ~200 bytes on stack */
 struct router_result router_get_first_route(struct bundle *bundle)
 {
 	const uint64_t expiration_time_ms = bundle_get_expiration_time_ms(
@@ -281,8 +496,11 @@ struct router_result router_get_first_route(struct bundle *bundle)
 	struct contact_list *contacts =
 		router_lookup_destination(bundle->destination);
 
+	res.fragment_results = NULL;
+	res.fragment_capacity = 0;
 	res.fragments = 0;
 	res.preemption_improved = 0;
+	res.preempted_bundles = NULL;
 	if (contacts == NULL) {
 		LOGF_INFO(
 			"Router: Could not determine a node over which the destination \"%s\" for bundle %p is reachable",
@@ -338,10 +556,12 @@ struct router_result router_get_first_route(struct bundle *bundle)
 			bundle_size <= mrfs.max_fragment_size)
 		router_get_first_route_nonfrag(&res,
 			contacts, bundle, bundle_size, expiration_time_ms);
-	else
-		router_get_first_route_frag(&res,
-			contacts, bundle, bundle_size, expiration_time_ms,
-			mrfs.max_fragment_size, first_frag_sz, last_frag_sz);
+	// Split the bundle across contacts if none can take it as a whole.
+	if (!res.fragments && !res.preempted_bundles &&
+			!bundle_must_not_fragment(bundle))
+		router_plan_fragments(&res,
+			contacts, bundle, expiration_time_ms,
+			mrfs.max_fragment_size);
 
 	if (!res.fragments)
 		LOGF_INFO(
@@ -355,12 +575,75 @@ finish:
 	while (contacts) {
 		struct contact_list *const tmp = contacts->next;
 
-		free(contacts);
+		object_pool_free(&contact_list_pool, contacts);
 		contacts = tmp;
 	}
 	return res;
 }
 
+// The CLA has to be able to transmit the bundle as a whole.
+static bool cla_can_take_whole(const struct contact *const contact,
+			       const uint32_t bundle_size)
+{
+	struct cla_config *const cla_config = cla_config_get(
+		contact->node->cla_addr
+	);
+
+	return (
+		cla_config &&
+		bundle_size <= MIN(cla_config->vtable->cla_mbs_get(cla_config),
+				   RC.global_mbs)
+	);
+}
+
+struct contact *router_get_direct_contact(struct bundle *bundle)
+{
+	const struct node_table_entry *const e = lookup_destination_entry(
+		bundle->destination
+	);
+	const uint32_t bundle_size = bundle_get_serialized_size(bundle);
+	struct fragment_route fr;
+
+	if (e == NULL)
+		return NULL;
+
+	// The contacts of the node are already ordered like the list built by
+	// router_lookup_destination(), so they do not have to be copied.
+	if (!router_calculate_fragment_route(
+		&fr, bundle_size,
+		e->contacts, 0, ROUTER_BUNDLE_PRIORITY(bundle),
+		bundle_get_expiration_time_ms(bundle),
+		NULL, 0)
+	)
+		return NULL;
+	if (!cla_can_take_whole(fr.contact, bundle_size))
+		return NULL;
+	return fr.contact;
+}
+
+struct contact *router_get_direct_snapshot_contact(
+	struct bundle *bundle, const struct contact_snapshot *contacts,
+	const uint32_t contact_count)
+{
+	const uint64_t time_ms = hal_time_get_timestamp_ms();
+	const uint64_t exp_time_ms = bundle_get_expiration_time_ms(bundle);
+	const uint32_t bundle_size = bundle_get_serialized_size(bundle);
+
+	// Same selection as router_calculate_fragment_route(), the contact
+	// times are taken from the snapshot.
+	for (uint32_t i = 0; i < contact_count; i++) {
+		struct contact *const c = contacts[i].contact;
+
+		if (contacts[i].from_ms >= exp_time_ms ||
+		    contacts[i].to_ms <= time_ms)
+			continue;
+		if (ROUTER_CONTACT_CAPACITY(c, 0) < (int32_t)bundle_size)
+			continue;
+		return cla_can_take_whole(c, bundle_size) ? c : NULL;
+	}
+	return NULL;
+}
+
 /* For use with caching of routes */
 struct router_result router_try_reuse(
 	struct router_result route, struct bundle *bundle)
@@ -433,7 +716,7 @@ enum ud3tn_result router_add_bundle_to_contact(
 		return UD3TN_FAIL;
 	ASSERT(contact->remaining_capacity_p0 > 0);
 
-	new_entry = malloc(sizeof(struct routed_bundle_list));
+	new_entry = object_pool_alloc(&routed_bundle_list_pool);
 	if (new_entry == NULL)
 		return UD3TN_FAIL;
 	new_entry->data = b;
@@ -443,7 +726,7 @@ enum ud3tn_result router_add_bundle_to_contact(
 	while (*cur_entry != NULL) {
 		ASSERT((*cur_entry)->data != b);
 		if ((*cur_entry)->data == b) {
-			free(new_entry);
+			object_pool_free(&routed_bundle_list_pool, new_entry);
 			return UD3TN_FAIL;
 		}
 		cur_entry = &(*cur_entry)->next;
@@ -481,22 +764,12 @@ enum ud3tn_result router_remove_bundle_from_contact(
 		if ((*cur_entry)->data == bundle) {
 			tmp = *cur_entry;
 			*cur_entry = (*cur_entry)->next;
-			free(tmp);
-			// This contact is of infinite capacity, do nothing.
-			if (contact->remaining_capacity_p0 == INT32_MAX)
-				continue;
-
-			const size_t bundle_size =
-				bundle_get_serialized_size(bundle);
-			const enum bundle_routing_priority prio =
-				bundle_get_routing_priority(bundle);
-
-			contact->remaining_capacity_p0 += bundle_size;
-			if (prio > BUNDLE_RPRIO_LOW) {
-				contact->remaining_capacity_p1 += bundle_size;
-				if (prio != BUNDLE_RPRIO_NORMAL)
-					contact->remaining_capacity_p2 += bundle_size;
-			}
+			object_pool_free(&routed_bundle_list_pool, tmp);
+			release_contact_capacity(
+				contact,
+				bundle,
+				bundle_get_serialized_size(bundle)
+			);
 			return UD3TN_OK;
 		}
 		cur_entry = &(*cur_entry)->next;
@@ -2,11 +2,13 @@
 #include "ud3tn/bundle.h"
 #include "ud3tn/bundle_fragmenter.h"
 #include "ud3tn/common.h"
+#include "ud3tn/eid_intern.h"
 #include "ud3tn/node.h"
 #include "ud3tn/router.h"
 #include "ud3tn/routing_table.h"
 
 #include "platform/hal_io.h"
+#include "platform/hal_semaphore.h"
 #include "platform/hal_time.h"
 
 #include <stdbool.h>
@@ -41,11 +43,8 @@ static bool process_router_command(
 	}
 }
 
-enum ud3tn_result router_process_command(
-	struct router_command *command,
-	struct rescheduling_handle rescheduler)
+enum ud3tn_result router_prepare_command(struct router_command *command)
 {
-	bool success = true;
 	const uint64_t cur_time_s = hal_time_get_timestamp_s();
 
 	if (!node_prepare_and_verify(command->data, cur_time_s)) {
@@ -56,6 +55,15 @@ enum ud3tn_result router_process_command(
 		return UD3TN_FAIL;
 	}
 
+	return UD3TN_OK;
+}
+
+enum ud3tn_result router_process_command(
+	struct router_command *command,
+	struct rescheduling_handle rescheduler)
+{
+	bool success = true;
+
 	success = process_router_command(
 		command,
 		rescheduler
@@ -80,7 +88,6 @@ enum ud3tn_result router_process_command(
 
 struct bundle_processing_result {
 	int32_t status_or_fragments;
-	struct bundle *fragments[ROUTER_MAX_FRAGMENTS];
 };
 
 #define BUNDLE_RESULT_NO_ROUTE 0
@@ -105,9 +112,10 @@ static inline enum router_result_status br_to_rrs(int8_t bh_result)
 }
 
 static struct bundle_processing_result apply_fragmentation(
-	struct bundle *bundle, struct router_result route);
+	struct bundle *bundle, struct router_result *route);
 
-static struct bundle_processing_result process_bundle(struct bundle *bundle)
+static struct bundle_processing_result process_bundle(
+	struct bundle *bundle, struct routed_bundle_list **preempted)
 {
 	struct router_result route;
 	struct bundle_processing_result result = {
@@ -123,9 +131,28 @@ static struct bundle_processing_result process_bundle(struct bundle *bundle)
 		return result;
 	}
 
+	// Small bundles are scheduled directly if a contact can take them.
+	if (bundle_get_serialized_size(bundle) <= BUNDLE_SMALL_MAX_SIZE) {
+		struct contact *const contact = router_get_direct_contact(
+			bundle
+		);
+
+		if (contact != NULL) {
+			result.status_or_fragments = (
+				router_add_bundle_to_contact(
+					contact,
+					bundle
+				) == UD3TN_OK
+				? 1
+				: BUNDLE_RESULT_NO_MEMORY
+			);
+			return result;
+		}
+	}
+
 	route = router_get_first_route(bundle);
+	*preempted = route.preempted_bundles;
 	if (route.fragments == 1) {
-		result.fragments[0] = bundle;
 		if (router_add_bundle_to_contact(
 				route.fragment_results[0].contact,
 				bundle) == UD3TN_OK)
@@ -134,27 +161,34 @@ static struct bundle_processing_result process_bundle(struct bundle *bundle)
 			result.status_or_fragments = BUNDLE_RESULT_NO_MEMORY;
 	} else if (route.fragments && !bundle_must_not_fragment(bundle)) {
 		// Only fragment if it is allowed -- if not, there is no route.
-		result = apply_fragmentation(bundle, route);
+		result = apply_fragmentation(bundle, &route);
 	}
+	router_result_free(&route);
 
 	return result;
 }
 
 static struct bundle_processing_result apply_fragmentation(
-	struct bundle *bundle, struct router_result route)
+	struct bundle *bundle, struct router_result *route)
 {
-	struct bundle *frags[ROUTER_MAX_FRAGMENTS];
+	struct bundle **frags;
 	uint32_t size;
 	int32_t f, g;
-	int32_t fragments = route.fragments;
+	int32_t fragments = route->fragments;
 	struct bundle_processing_result result = {
 		.status_or_fragments = BUNDLE_RESULT_NO_MEMORY
 	};
 
+	frags = malloc(fragments * sizeof(struct bundle *));
+	if (frags == NULL)
+		return result;
+
 	/* Create fragments */
+	// They reference slices of the original payload, i.e., splitting off
+	// the next fragment does not copy any payload.
 	frags[0] = bundlefragmenter_initialize_first_fragment(bundle);
 	if (frags[0] == NULL)
-		return result;
+		goto fail;
 
 	for (f = 0; f < fragments - 1; f++) {
 		/* Determine minimal fragmented bundle size */
@@ -164,12 +198,12 @@ static struct bundle_processing_result apply_fragmentation(
 			size = bundle_get_mid_fragment_min_size(bundle);
 
 		frags[f + 1] = bundlefragmenter_fragment_bundle(frags[f],
-			size + route.fragment_results[f].payload_size);
+			size + route->fragment_results[f].payload_size);
 
 		if (frags[f + 1] == NULL) {
 			for (g = 0; g <= f; g++)
 				bundle_free(frags[g]);
-			return result;
+			goto fail;
 		} else if (frags[f] == frags[f + 1]) {
 			// Not fragmented b/c not needed - the router does some
 			// conservative estimations regarding size of CBOR ints
@@ -177,8 +211,7 @@ static struct bundle_processing_result apply_fragmentation(
 			// Just update the count accordingly and do not schedule
 			// the rest.
 			fragments = f + 1;
-			route.fragments = fragments;
-			frags[fragments] = NULL;
+			route->fragments = fragments;
 			break;
 		}
 	}
@@ -186,7 +219,7 @@ static struct bundle_processing_result apply_fragmentation(
 	/* Add to route */
 	for (f = 0; f < fragments; f++) {
 		if (router_add_bundle_to_contact(
-				route.fragment_results[f].contact,
+				route->fragment_results[f].contact,
 				frags[f]) != UD3TN_OK) {
 			LOGF_INFO(
 				"Router: Scheduling bundle %p failed, dropping all fragments.",
@@ -195,33 +228,38 @@ static struct bundle_processing_result apply_fragmentation(
 			// Remove from all previously-scheduled routes
 			for (g = 0; g < f; g++)
 				router_remove_bundle_from_contact(
-					route.fragment_results[g].contact,
+					route->fragment_results[g].contact,
 					frags[g]
 				);
 			// Drop _all_ fragments
 			for (g = 0; g < fragments; g++)
 				bundle_free(frags[g]);
-			return result;
+			goto fail;
 		}
 	}
 
 	/* Success - remove bundle */
 	bundle_free(bundle);
+	free(frags);
 
-	for (f = 0; f < fragments; f++)
-		result.fragments[f] = frags[f];
 	result.status_or_fragments = fragments;
 	return result;
+
+fail:
+	free(frags);
+	return result;
 }
 
-enum router_result_status router_route_bundle(struct bundle *b)
+enum router_result_status router_route_bundle(
+	struct bundle *b, struct routed_bundle_list **preempted)
 {
 	struct bundle_processing_result proc_result = {
 		.status_or_fragments = BUNDLE_RESULT_INVALID
 	};
 
+	*preempted = NULL;
 	if (b != NULL)
-		proc_result = process_bundle(b);
+		proc_result = process_bundle(b, preempted);
 
 	LOGF_DEBUG(
 		"Router: Bundle %p [ %s ] [ frag = %d ]",
@@ -233,3 +271,70 @@ enum router_result_status router_route_bundle(struct bundle *b)
 		return br_to_rrs(proc_result.status_or_fragments);
 	return ROUTER_RESULT_OK;
 }
+
+// Schedules the small bundle for one of the contacts of its destination,
+// looked up in the current snapshot before taking the lock. Returns false
+// with the lock held if the bundle has to be routed regularly.
+static bool route_via_snapshot(struct bundle *b, Semaphore_t lock)
+{
+	if (b == NULL ||
+	    bundle_get_serialized_size(b) > BUNDLE_SMALL_MAX_SIZE ||
+	    bundle_get_expiration_time_ms(b) < hal_time_get_timestamp_ms()) {
+		hal_semaphore_take_blocking(lock);
+		return false;
+	}
+
+	// Same lookup as router_lookup_destination() does
+	const char *const node_id = eid_intern_get_node_id(b->destination);
+	const struct routing_table_snapshot *const snapshot =
+		routing_table_snapshot_acquire();
+	const struct contact_snapshot *contacts = NULL;
+	uint32_t contact_count = routing_table_snapshot_lookup(
+		snapshot,
+		node_id,
+		&contacts
+	);
+	struct contact *contact = NULL;
+
+	if (contact_count == 0 && node_id != b->destination)
+		contact_count = routing_table_snapshot_lookup(
+			snapshot,
+			b->destination,
+			&contacts
+		);
+
+	hal_semaphore_take_blocking(lock);
+	// The contacts must only be accessed if the snapshot is current.
+	if (contact_count != 0 &&
+	    snapshot->version == routing_table_get_version())
+		contact = router_get_direct_snapshot_contact(
+			b,
+			contacts,
+			contact_count
+		);
+	routing_table_snapshot_release(snapshot);
+	if (contact == NULL ||
+	    router_add_bundle_to_contact(contact, b) != UD3TN_OK)
+		return false;
+	hal_semaphore_release(lock);
+	return true;
+}
+
+enum router_result_status router_route_bundle_locking(
+	struct bundle *b, Semaphore_t lock,
+	struct routed_bundle_list **preempted)
+{
+	enum router_result_status result;
+
+	*preempted = NULL;
+	if (route_via_snapshot(b, lock)) {
+		LOGF_DEBUG("Router: Bundle %p [ OK ] [ frag = 1 ]", b);
+		return ROUTER_RESULT_OK;
+	}
+
+	// Fragmentation and pre-emption modify several contacts, thus, the
+	// lock is held while determining the route in that case.
+	result = router_route_bundle(b, preempted);
+	hal_semaphore_release(lock);
+	return result;
+}
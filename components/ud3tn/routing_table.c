@@ -1,10 +1,14 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
 #include "ud3tn/bundle.h"
 #include "ud3tn/common.h"
+#include "ud3tn/eid_intern.h"
+#include "ud3tn/hashtable.h"
 #include "ud3tn/node.h"
+#include "ud3tn/object_pool.h"
 #include "ud3tn/router.h"
 #include "ud3tn/routing_table.h"
-#include "ud3tn/simplehtab.h"
+
+#include "platform/hal_io.h"
 
 #include <stdbool.h>
 #include <stdlib.h>
@@ -13,10 +17,19 @@
 static struct node_list *node_list;
 static struct contact_list *contact_list;
 
-static struct htab_entrylist *htab_elem[NODE_HTAB_SLOT_COUNT];
-static struct htab eid_table;
+static struct hashtable eid_table;
 static uint8_t eid_table_initialized;
 
+// Snapshot handling: readers announce themselves via snapshot_readers before
+// loading current_snapshot. Replaced snapshots are retired and freed by the
+// next writer that observes that no reader is active anymore.
+static struct routing_table_snapshot *current_snapshot;
+static struct routing_table_snapshot *retired_snapshots;
+static unsigned int snapshot_readers;
+static uint32_t table_version;
+
+static void delete_contact(struct contact *contact);
+
 /* INIT */
 
 enum ud3tn_result routing_table_init(void)
@@ -25,8 +38,9 @@ enum ud3tn_result routing_table_init(void)
 		return UD3TN_OK;
 	node_list = NULL;
 	contact_list = NULL;
-	htab_init(&eid_table, NODE_HTAB_SLOT_COUNT, htab_elem);
+	hashtable_init(&eid_table, NODE_HTAB_SLOT_COUNT);
 	eid_table_initialized = 1;
+	routing_table_publish_snapshot();
 	return UD3TN_OK;
 }
 
@@ -35,13 +49,240 @@ void routing_table_free(void)
 	struct node_list *next;
 
 	while (contact_list != NULL)
-		routing_table_delete_contact(contact_list->data);
+		delete_contact(contact_list->data);
 	while (node_list != NULL) {
 		free_node(node_list->node);
 		next = node_list->next;
 		free(node_list);
 		node_list = next;
 	}
+	routing_table_publish_snapshot();
+}
+
+/* SNAPSHOTS */
+
+const struct routing_table_snapshot *routing_table_snapshot_acquire(void)
+{
+	__atomic_add_fetch(&snapshot_readers, 1, __ATOMIC_SEQ_CST);
+	return __atomic_load_n(&current_snapshot, __ATOMIC_SEQ_CST);
+}
+
+void routing_table_snapshot_release(
+	const struct routing_table_snapshot *snapshot)
+{
+	(void)snapshot;
+	__atomic_sub_fetch(&snapshot_readers, 1, __ATOMIC_SEQ_CST);
+}
+
+static void free_snapshot(struct routing_table_snapshot *snapshot)
+{
+	for (uint32_t i = 0; i < snapshot->destination_slot_count; i++)
+		eid_intern_release(snapshot->destinations[i].eid);
+	free(snapshot->destinations);
+	free(snapshot->destination_contacts);
+	free(snapshot);
+}
+
+static struct destination_snapshot *get_destination_slot(
+	const struct routing_table_snapshot *snapshot, const char *eid)
+{
+	const uint32_t mask = snapshot->destination_slot_count - 1;
+	uint32_t i = eid_intern_get_info(eid)->hash & mask;
+
+	// The table is never full, thus, probing terminates.
+	while (snapshot->destinations[i].eid != NULL &&
+	       snapshot->destinations[i].eid != eid)
+		i = (i + 1) & mask;
+	return &snapshot->destinations[i];
+}
+
+// Returns the number of contacts added to the snapshot for the EID.
+static uint32_t add_snapshot_destination(
+	struct routing_table_snapshot *snapshot, const char *key)
+{
+	const struct node_table_entry *const entry = hashtable_get(
+		&eid_table,
+		key
+	);
+	struct destination_snapshot *slot;
+	const char *eid;
+
+	if (entry == NULL)
+		return 0;
+	// If no memory is left, the EID is just not found in the snapshot.
+	eid = eid_intern(key);
+	if (eid == NULL)
+		return 0;
+	slot = get_destination_slot(snapshot, eid);
+	if (slot->eid != NULL) {
+		eid_intern_release(eid);
+		return 0;
+	}
+	slot->eid = eid;
+	slot->contact_count = 0;
+	for (struct contact_list *cur = entry->contacts; cur != NULL;
+	     cur = cur->next)
+		slot->contact_count++;
+	return slot->contact_count;
+}
+
+static void add_snapshot_destinations(struct routing_table_snapshot *snapshot)
+{
+	const size_t eid_count = hashtable_count(&eid_table);
+	uint32_t slot_count = 1, contact_count = 0, i;
+
+	// At least half of the slots stay free.
+	while (slot_count < 2 * eid_count)
+		slot_count *= 2;
+	snapshot->destinations = calloc(
+		slot_count,
+		sizeof(struct destination_snapshot)
+	);
+	if (snapshot->destinations == NULL)
+		return;
+	snapshot->destination_slot_count = slot_count;
+
+	for (struct node_list *n = node_list; n != NULL; n = n->next) {
+		struct node *const node = n->node;
+
+		contact_count += add_snapshot_destination(snapshot, node->eid);
+		for (struct endpoint_list *e = node->endpoints; e != NULL;
+		     e = e->next)
+			contact_count += add_snapshot_destination(
+				snapshot,
+				e->eid
+			);
+		for (struct contact_list *c = node->contacts; c != NULL;
+		     c = c->next) {
+			for (struct endpoint_list *e =
+					c->data->contact_endpoints;
+			     e != NULL; e = e->next)
+				contact_count += add_snapshot_destination(
+					snapshot,
+					e->eid
+				);
+		}
+	}
+
+	snapshot->destination_contacts = malloc(
+		contact_count * sizeof(struct contact_snapshot)
+	);
+	if (contact_count != 0 && snapshot->destination_contacts == NULL) {
+		for (i = 0; i < slot_count; i++)
+			eid_intern_release(snapshot->destinations[i].eid);
+		free(snapshot->destinations);
+		snapshot->destinations = NULL;
+		snapshot->destination_slot_count = 0;
+		return;
+	}
+
+	contact_count = 0;
+	for (i = 0; i < slot_count; i++) {
+		struct destination_snapshot *const d =
+			&snapshot->destinations[i];
+
+		if (d->eid == NULL)
+			continue;
+		d->first_contact = contact_count;
+		for (struct contact_list *cur = routing_table_lookup_eid(
+				d->eid)->contacts;
+		     cur != NULL; cur = cur->next) {
+			snapshot->destination_contacts[contact_count++] =
+				(struct contact_snapshot) {
+					.contact = cur->data,
+					.from_ms = cur->data->from_ms,
+					.to_ms = cur->data->to_ms,
+				};
+		}
+	}
+}
+
+static struct routing_table_snapshot *create_snapshot(void)
+{
+	struct routing_table_snapshot *snapshot;
+	struct contact_list *cur;
+	uint32_t count = 0;
+
+	for (cur = contact_list; cur != NULL; cur = cur->next)
+		count++;
+
+	snapshot = malloc(
+		sizeof(struct routing_table_snapshot) +
+		count * sizeof(struct contact_snapshot)
+	);
+	if (snapshot == NULL)
+		return NULL;
+
+	snapshot->version = table_version;
+	snapshot->contact_count = count;
+	snapshot->destination_slot_count = 0;
+	snapshot->destinations = NULL;
+	snapshot->destination_contacts = NULL;
+	snapshot->next_retired = NULL;
+	count = 0;
+	for (cur = contact_list; cur != NULL; cur = cur->next) {
+		snapshot->contacts[count++] = (struct contact_snapshot) {
+			.contact = cur->data,
+			.from_ms = cur->data->from_ms,
+			.to_ms = cur->data->to_ms,
+		};
+	}
+	// If no memory is left, all destinations are routed with the
+	// routing table lock held.
+	add_snapshot_destinations(snapshot);
+	return snapshot;
+}
+
+uint32_t routing_table_snapshot_lookup(
+	const struct routing_table_snapshot *snapshot, const char *eid,
+	const struct contact_snapshot **contacts)
+{
+	const struct destination_snapshot *d;
+
+	if (snapshot == NULL || snapshot->destination_slot_count == 0 ||
+	    eid == NULL)
+		return 0;
+	d = get_destination_slot(snapshot, eid);
+	if (d->eid == NULL)
+		return 0;
+	*contacts = &snapshot->destination_contacts[d->first_contact];
+	return d->contact_count;
+}
+
+void routing_table_publish_snapshot(void)
+{
+	struct routing_table_snapshot *snapshot, *old;
+
+	table_version++;
+
+	// If this fails, readers keep the previous snapshot. They detect
+	// that it is outdated by means of the version number.
+	snapshot = create_snapshot();
+	if (snapshot == NULL) {
+		LOG_WARN("RoutingTable: Could not allocate new snapshot");
+		return;
+	}
+
+	old = __atomic_exchange_n(&current_snapshot, snapshot,
+				  __ATOMIC_SEQ_CST);
+	if (old != NULL) {
+		old->next_retired = retired_snapshots;
+		retired_snapshots = old;
+	}
+
+	// Every reader that started before the exchange above is counted.
+	if (__atomic_load_n(&snapshot_readers, __ATOMIC_SEQ_CST) != 0)
+		return;
+	while (retired_snapshots != NULL) {
+		old = retired_snapshots;
+		retired_snapshots = old->next_retired;
+		free_snapshot(old);
+	}
+}
+
+uint32_t routing_table_get_version(void)
+{
+	return table_version;
 }
 
 /* LOOKUP */
@@ -83,7 +324,19 @@ struct node *routing_table_lookup_node(const char *eid)
 
 struct node_table_entry *routing_table_lookup_eid(const char *eid)
 {
-	return (struct node_table_entry *)htab_get(&eid_table, eid);
+	return (struct node_table_entry *)hashtable_get(&eid_table, eid);
+}
+
+struct node_table_entry *routing_table_lookup_interned_eid(const char *eid)
+{
+	const struct eid_intern_info *const info = eid_intern_get_info(eid);
+
+	return (struct node_table_entry *)hashtable_get_hashed(
+		&eid_table,
+		eid,
+		info->length,
+		info->hash
+	);
 }
 
 
@@ -134,7 +387,7 @@ static bool add_new_node(struct node *new_node)
 	return true;
 }
 
-bool routing_table_add_node(
+static bool add_node(
 	struct node *new_node, struct rescheduling_handle rescheduler)
 {
 	struct node_list *entry;
@@ -183,7 +436,7 @@ bool routing_table_add_node(
 			);
 		}
 		next = cap_modified->next;
-		free(cap_modified);
+		object_pool_free(&contact_list_pool, cap_modified);
 		cap_modified = next;
 	}
 	add_node_to_tables(cur_node);
@@ -192,6 +445,15 @@ bool routing_table_add_node(
 	return true;
 }
 
+bool routing_table_add_node(
+	struct node *new_node, struct rescheduling_handle rescheduler)
+{
+	const bool result = add_node(new_node, rescheduler);
+
+	routing_table_publish_snapshot();
+	return result;
+}
+
 bool routing_table_replace_node(
 	struct node *node, struct rescheduling_handle rescheduler)
 {
@@ -207,6 +469,7 @@ bool routing_table_replace_node(
 	free_node(entry->node);
 	entry->node = node;
 	add_node_to_tables(node);
+	routing_table_publish_snapshot();
 	return true;
 }
 
@@ -225,12 +488,13 @@ bool routing_table_delete_node_by_eid(
 					rescheduler);
 		free_node(old_node_entry->node);
 		free(old_node_entry);
+		routing_table_publish_snapshot();
 		return true;
 	}
 	return false;
 }
 
-bool routing_table_delete_node(
+static bool delete_node(
 	struct node *new_node, struct rescheduling_handle rescheduler)
 {
 	struct node_list **entry_ptr, *old_node_entry;
@@ -263,7 +527,7 @@ bool routing_table_delete_node(
 				reschedule_bundles(
 					modified->data, rescheduler);
 				next = modified->next;
-				free(modified);
+				object_pool_free(&contact_list_pool, modified);
 				modified = next;
 			}
 			/* Process deleted contacts */
@@ -273,7 +537,10 @@ bool routing_table_delete_node(
 				if (deleted->data->active) {
 					tmp = deleted;
 					deleted = tmp->next;
-					free(tmp);
+					object_pool_free(
+						&contact_list_pool,
+						tmp
+					);
 				} else {
 					deleted = contact_list_free(deleted);
 				}
@@ -287,6 +554,16 @@ bool routing_table_delete_node(
 	return false;
 }
 
+bool routing_table_delete_node(
+	struct node *new_node, struct rescheduling_handle rescheduler)
+{
+	const bool result = delete_node(new_node, rescheduler);
+
+	if (result)
+		routing_table_publish_snapshot();
+	return result;
+}
+
 static bool add_contact_to_node_in_htab(char *eid, struct contact *c);
 static bool remove_contact_from_node_in_htab(char *eid, struct contact *c);
 
@@ -354,7 +631,10 @@ static void remove_node_from_tables(struct node *node, bool drop_contacts,
 			if (cur_contact->data->active) {
 				cur_contact->data->node = NULL;
 				*cur_slot = cur_contact->next;
-				free(cur_contact);
+				object_pool_free(
+					&contact_list_pool,
+					cur_contact
+				);
 				// List item was replaced by next item,
 				// process this one now...
 				continue;
@@ -373,14 +653,17 @@ static bool add_contact_to_node_in_htab(char *eid, struct contact *c)
 	if (!eid || !c)
 		return false;
 
-	entry = (struct node_table_entry *)htab_get(&eid_table, eid);
+	entry = (struct node_table_entry *)hashtable_get(&eid_table, eid);
 	if (entry == NULL) {
 		entry = malloc(sizeof(struct node_table_entry));
 		if (entry == NULL)
 			return false;
 		entry->ref_count = 0;
 		entry->contacts = NULL;
-		htab_add(&eid_table, eid, entry);
+		if (hashtable_add(&eid_table, eid, entry) != UD3TN_OK) {
+			free(entry);
+			return false;
+		}
 	}
 	if (add_contact_to_ordered_list(&(entry->contacts), c, 0)) {
 		entry->ref_count++;
@@ -398,13 +681,13 @@ static bool remove_contact_from_node_in_htab(char *eid, struct contact *c)
 	if (!eid || !c)
 		return false;
 
-	entry = (struct node_table_entry *)htab_get(&eid_table, eid);
+	entry = (struct node_table_entry *)hashtable_get(&eid_table, eid);
 	if (entry == NULL)
 		return false;
 	if (remove_contact_from_list(&(entry->contacts), c)) {
 		entry->ref_count--;
 		if (entry->ref_count <= 0) {
-			htab_remove(&eid_table, eid);
+			hashtable_remove(&eid_table, eid);
 			free(entry);
 		}
 		return true;
@@ -424,6 +707,12 @@ struct node_list *routing_table_get_node_list(void)
 }
 
 void routing_table_delete_contact(struct contact *contact)
+{
+	delete_contact(contact);
+	routing_table_publish_snapshot();
+}
+
+static void delete_contact(struct contact *contact)
 {
 	struct endpoint_list *cur_eid;
 
@@ -490,7 +779,10 @@ void routing_table_contact_passed(
 				rescheduler.reschedule_func_context
 			);
 			tmp = contact->contact_bundles->next;
-			free(contact->contact_bundles);
+			object_pool_free(
+				&routed_bundle_list_pool,
+				contact->contact_bundles
+			);
 			contact->contact_bundles = tmp;
 		}
 	}
@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/common.h"
+#include "ud3tn/shared_buffer.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct shared_buffer *shared_buffer_wrap(uint8_t *data, size_t length)
+{
+	struct shared_buffer *buffer = malloc(sizeof(struct shared_buffer));
+
+	if (buffer == NULL)
+		return NULL;
+	buffer->ref_count = 1;
+	buffer->length = length;
+	buffer->data = data;
+	return buffer;
+}
+
+struct shared_buffer *shared_buffer_create(size_t length)
+{
+	struct shared_buffer *buffer = malloc(
+		sizeof(struct shared_buffer) + length
+	);
+
+	if (buffer == NULL)
+		return NULL;
+	buffer->ref_count = 1;
+	buffer->length = length;
+	buffer->data = (uint8_t *)(buffer + 1);
+	return buffer;
+}
+
+static inline bool has_inline_data(const struct shared_buffer *buffer)
+{
+	return buffer->data == (const uint8_t *)(buffer + 1);
+}
+
+struct shared_buffer *shared_buffer_ref(struct shared_buffer *buffer)
+{
+	ASSERT(buffer != NULL);
+	__atomic_add_fetch(&buffer->ref_count, 1, __ATOMIC_RELAXED);
+	return buffer;
+}
+
+void shared_buffer_unref(struct shared_buffer *buffer)
+{
+	if (buffer == NULL)
+		return;
+	ASSERT(buffer->ref_count != 0);
+	if (__atomic_sub_fetch(&buffer->ref_count, 1, __ATOMIC_ACQ_REL) != 0)
+		return;
+	if (!has_inline_data(buffer))
+		free(buffer->data);
+	free(buffer);
+}
+
+bool shared_buffer_is_exclusive(struct shared_buffer *buffer)
+{
+	return __atomic_load_n(&buffer->ref_count, __ATOMIC_ACQUIRE) == 1;
+}
+
+uint8_t *shared_buffer_take_slice(struct shared_buffer *buffer,
+				  const uint8_t *data, size_t length)
+{
+	uint8_t *result;
+
+	ASSERT(data >= buffer->data &&
+	       data + length <= buffer->data + buffer->length);
+	if (shared_buffer_is_exclusive(buffer) && !has_inline_data(buffer) &&
+	    data == buffer->data && length == buffer->length) {
+		result = buffer->data;
+		buffer->data = NULL;
+	} else {
+		// Copy on write: Others may still read the data.
+		result = malloc(length);
+		if (result != NULL)
+			memcpy(result, data, length);
+	}
+	shared_buffer_unref(buffer);
+	return result;
+}
@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/common.h"
+#include "ud3tn/result.h"
+#include "ud3tn/siphash.h"
+
+#include "platform/hal_io.h"
+#include "platform/hal_platform.h"
+#include "platform/hal_time.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// The key, valid if key_state is positive, -1 while being initialized.
+static uint64_t key[2];
+static int key_state;
+
+static void init_key(void)
+{
+	int expected = 0;
+
+	if (__atomic_load_n(&key_state, __ATOMIC_ACQUIRE) > 0)
+		return;
+
+	if (!__atomic_compare_exchange_n(&key_state, &expected, -1,
+					 false, __ATOMIC_ACQUIRE,
+					 __ATOMIC_ACQUIRE)) {
+		// Another thread is generating the key right now.
+		while (__atomic_load_n(&key_state, __ATOMIC_ACQUIRE) <= 0)
+			;
+		return;
+	}
+
+	if (hal_platform_get_random_bytes(key, sizeof(key)) != UD3TN_OK) {
+		LOG_WARN("SipHash: No random source available, using the system time as key");
+		key[0] = hal_time_get_system_time();
+		key[1] = (uint64_t)(uintptr_t)&key;
+	}
+	__atomic_store_n(&key_state, 1, __ATOMIC_RELEASE);
+}
+
+#define ROTL64(x, b) (((x) << (b)) | ((x) >> (64 - (b))))
+
+static inline void sipround(struct siphash_state *const s)
+{
+	s->v0 += s->v1;
+	s->v1 = ROTL64(s->v1, 13);
+	s->v1 ^= s->v0;
+	s->v0 = ROTL64(s->v0, 32);
+	s->v2 += s->v3;
+	s->v3 = ROTL64(s->v3, 16);
+	s->v3 ^= s->v2;
+	s->v0 += s->v3;
+	s->v3 = ROTL64(s->v3, 21);
+	s->v3 ^= s->v0;
+	s->v2 += s->v1;
+	s->v1 = ROTL64(s->v1, 17);
+	s->v1 ^= s->v2;
+	s->v2 = ROTL64(s->v2, 32);
+}
+
+// One compression round per word, i.e. SipHash-1-3.
+static inline void compress(struct siphash_state *const s, const uint64_t m)
+{
+	s->v3 ^= m;
+	sipround(s);
+	s->v0 ^= m;
+}
+
+static inline uint64_t load_le64(const uint8_t *const p)
+{
+	uint64_t result = 0;
+
+	for (int i = 7; i >= 0; i--)
+		result = (result << 8) | p[i];
+	return result;
+}
+
+void siphash_init(struct siphash_state *const state, const bool wide)
+{
+	init_key();
+	state->v0 = UINT64_C(0x736f6d6570736575) ^ key[0];
+	state->v1 = UINT64_C(0x646f72616e646f6d) ^ key[1];
+	state->v2 = UINT64_C(0x6c7967656e657261) ^ key[0];
+	state->v3 = UINT64_C(0x7465646279746573) ^ key[1];
+	if (wide)
+		state->v1 ^= 0xEE;
+	state->tail = 0;
+	state->length = 0;
+}
+
+void siphash_update(struct siphash_state *const state, const void *const data,
+		    size_t length)
+{
+	const uint8_t *pos = data;
+
+	// Complete the word started by a previous update first.
+	while ((state->length & 7) != 0 && length > 0) {
+		state->tail |= (uint64_t)*pos << (8 * (state->length & 7));
+		state->length++;
+		pos++;
+		length--;
+		if ((state->length & 7) == 0) {
+			compress(state, state->tail);
+			state->tail = 0;
+		}
+	}
+	for (; length >= 8; pos += 8, length -= 8) {
+		compress(state, load_le64(pos));
+		state->length += 8;
+	}
+	for (size_t i = 0; i < length; i++)
+		state->tail |= (uint64_t)pos[i] << (8 * i);
+	state->length += length;
+}
+
+static void finalize(struct siphash_state *const s, const uint8_t marker)
+{
+	compress(s, s->tail | (uint64_t)s->length << 56);
+	s->v2 ^= marker;
+	sipround(s);
+	sipround(s);
+	sipround(s);
+}
+
+uint64_t siphash_final(struct siphash_state *const state)
+{
+	finalize(state, 0xFF);
+	return state->v0 ^ state->v1 ^ state->v2 ^ state->v3;
+}
+
+void siphash_final128(struct siphash_state *const state, uint64_t result[2])
+{
+	finalize(state, 0xEE);
+	result[0] = state->v0 ^ state->v1 ^ state->v2 ^ state->v3;
+	state->v1 ^= 0xDD;
+	sipround(state);
+	sipround(state);
+	sipround(state);
+	result[1] = state->v0 ^ state->v1 ^ state->v2 ^ state->v3;
+}
+
+uint64_t siphash(const void *const data, const size_t length)
+{
+	struct siphash_state state;
+
+	siphash_init(&state, false);
+	siphash_update(&state, data, length);
+	return siphash_final(&state);
+}
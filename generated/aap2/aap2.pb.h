@@ -44,7 +44,10 @@ typedef enum _aap2_ResponseStatus {
     aap2_ResponseStatus_RESPONSE_STATUS_NOT_FOUND = 11,
     /* The Client is not authorized to perform the requested action or a provided
  credential value is not valid for the requested authorization. */
-    aap2_ResponseStatus_RESPONSE_STATUS_UNAUTHORIZED = 12
+    aap2_ResponseStatus_RESPONSE_STATUS_UNAUTHORIZED = 12,
+    /* The request was not processed because the forwarding backlog of the node
+ is full. The Client may retry later. */
+    aap2_ResponseStatus_RESPONSE_STATUS_BACKLOG_FULL = 13
 } aap2_ResponseStatus;
 
 /* Struct definitions */
@@ -179,8 +182,8 @@ extern "C" {
 #define _aap2_BundleADUFlags_ARRAYSIZE ((aap2_BundleADUFlags)(aap2_BundleADUFlags_BUNDLE_ADU_BPDU+1))
 
 #define _aap2_ResponseStatus_MIN aap2_ResponseStatus_RESPONSE_STATUS_UNSPECIFIED
-#define _aap2_ResponseStatus_MAX aap2_ResponseStatus_RESPONSE_STATUS_UNAUTHORIZED
-#define _aap2_ResponseStatus_ARRAYSIZE ((aap2_ResponseStatus)(aap2_ResponseStatus_RESPONSE_STATUS_UNAUTHORIZED+1))
+#define _aap2_ResponseStatus_MAX aap2_ResponseStatus_RESPONSE_STATUS_BACKLOG_FULL
+#define _aap2_ResponseStatus_ARRAYSIZE ((aap2_ResponseStatus)(aap2_ResponseStatus_RESPONSE_STATUS_BACKLOG_FULL+1))
 
 
 
@@ -6,6 +6,7 @@
 #include "bundle6/sdnv.h"
 
 #include "ud3tn/bundle.h"
+#include "ud3tn/bundle_arena.h"
 #include "ud3tn/parser.h"
 #include "ud3tn/result.h"
 
@@ -81,6 +82,9 @@ struct bundle6_parser {
 
 	struct sdnv_state sdnv_state;
 	struct bundle *bundle;
+	struct bundle_arena arena;
+	// Block data of the current bundle accounted in the memory budget
+	uint64_t budget_bytes;
 
 	uint16_t primary_bytes_remaining;
 	uint32_t cur_bytes_remaining;
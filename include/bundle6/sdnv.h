@@ -2,6 +2,7 @@
 #ifndef SDNV_H_INCLUDED
 #define SDNV_H_INCLUDED
 
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -35,6 +36,24 @@ void sdnv_read_u16(struct sdnv_state *state, uint16_t *value, uint8_t byte);
 void sdnv_read_u32(struct sdnv_state *state, uint32_t *value, uint8_t byte);
 void sdnv_read_u64(struct sdnv_state *state, uint64_t *value, uint8_t byte);
 
+/**
+ * @brief Decode a complete SDNV at the start of the given buffer at once,
+ *	which is considerably faster than passing it to sdnv_read_*() byte by
+ *	byte. Up to eight bytes are processed in a single machine word.
+ *
+ * @return The number of bytes of the SDNV, or zero if it does not end within
+ *	the buffer or would be rejected by sdnv_read_*(). The value is only
+ *	modified on success.
+ */
+int_fast8_t sdnv_decode_u8(const uint8_t *buffer, size_t length,
+			   uint8_t *value);
+int_fast8_t sdnv_decode_u16(const uint8_t *buffer, size_t length,
+			    uint16_t *value);
+int_fast8_t sdnv_decode_u32(const uint8_t *buffer, size_t length,
+			    uint32_t *value);
+int_fast8_t sdnv_decode_u64(const uint8_t *buffer, size_t length,
+			    uint64_t *value);
+
 int_fast8_t sdnv_get_size_u8(uint8_t value);
 int_fast8_t sdnv_get_size_u16(uint16_t value);
 int_fast8_t sdnv_get_size_u32(uint32_t value);
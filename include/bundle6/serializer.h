@@ -12,4 +12,15 @@ enum ud3tn_result bundle6_serialize(
 	void (*write)(void *cla_obj, const void *, const size_t),
 	void *cla_obj);
 
+/**
+ * Like bundle6_serialize(), but passes the block data, which stays valid until
+ * the bundle is modified, to write_ref instead of write, such that it can be
+ * referenced instead of being copied.
+ */
+enum ud3tn_result bundle6_serialize_ref(
+	struct bundle *bundle,
+	void (*write)(void *cla_obj, const void *, const size_t),
+	void (*write_ref)(void *cla_obj, const void *, const size_t),
+	void *cla_obj);
+
 #endif /* BUNDLE6_SERIALIZER_H_INCLUDED */
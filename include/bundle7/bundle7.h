@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
-#ifndef BUNDLE_V7_PARSER_H_INCLUDED
-#define BUNDLE_V7_PARSER_H_INCLUDED
+#ifndef BUNDLE7_H_INCLUDED
+#define BUNDLE7_H_INCLUDED
 
 #include "ud3tn/bundle.h"
 #include "ud3tn/result.h"
@@ -25,6 +25,12 @@ size_t bundle7_cbor_uint_sizeof(uint64_t num);
  */
 size_t bundle7_eid_sizeof(const char *eid);
 
+/**
+ * Like bundle7_eid_sizeof(), but for interned EIDs (see ud3tn/eid_intern.h),
+ * using their structured form determined when interning them.
+ */
+size_t bundle7_interned_eid_sizeof(const char *eid);
+
 /**
  * Converts the unified uD3TN flags into BPv7-bis protocol-compliant block
  * processing flags.
@@ -72,4 +78,13 @@ size_t bundle7_get_first_fragment_min_size(struct bundle *bundle);
  */
 size_t bundle7_get_last_fragment_min_size(struct bundle *bundle);
 
-#endif // BUNDLE_V7_PARSER_H_INCLUDED
+/**
+ * Verifies the CRCs of all blocks whose verification has been deferred by the
+ * parser (see BUNDLE7_PARSER_DEFER_CRC), checksumming the block data in one
+ * pass. Blocks with a verified CRC are not processed again.
+ *
+ * @return UD3TN_FAIL if any of the CRCs does not match
+ */
+enum ud3tn_result bundle7_verify_crc(struct bundle *bundle);
+
+#endif // BUNDLE7_H_INCLUDED
@@ -27,4 +27,17 @@ struct bundle *bundle7_create_local(
 	uint64_t creation_time_ms, uint64_t sequence_number,
 	uint64_t lifetime_ms, enum bundle_proc_flags proc_flags);
 
+/**
+ * Like bundle7_create_local(), but for EIDs that have already been interned
+ * (see ud3tn/eid_intern.h). The bundle takes a new reference to each of them,
+ * which avoids looking them up in the intern table again.
+ *
+ * @param report_to The report-to EID of the bundle, e.g. "dtn:none".
+ */
+struct bundle *bundle7_create_local_interned(
+	void *payload, size_t payload_length,
+	const char *source, const char *destination, const char *report_to,
+	uint64_t creation_time_ms, uint64_t sequence_number,
+	uint64_t lifetime_ms, enum bundle_proc_flags proc_flags);
+
 #endif // BUNDLE7_CREATE_H_INCLUDED
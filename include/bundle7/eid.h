@@ -89,4 +89,20 @@ int bundle7_eid_serialize(const char *eid, uint8_t *buffer,
  */
 CborError bundle7_eid_serialize_cbor(const char *eid, CborEncoder *encoder);
 
+
+/**
+ * Like bundle7_eid_serialize(), but for interned EIDs (see ud3tn/eid_intern.h).
+ * IPN EIDs are encoded from the numbers determined when interning them,
+ * without parsing their string representation again.
+ */
+int bundle7_interned_eid_serialize(const char *eid, uint8_t *buffer,
+	size_t buffer_size);
+
+
+/**
+ * Like bundle7_eid_serialize_cbor(), but for interned EIDs.
+ */
+CborError bundle7_interned_eid_serialize_cbor(const char *eid,
+	CborEncoder *encoder);
+
 #endif // BUNDLE7_EID_H_INCLUDED
@@ -2,21 +2,30 @@
 #ifndef BUNDLE_V7_PARSER_H_INCLUDED
 #define BUNDLE_V7_PARSER_H_INCLUDED
 
-#include "bundle7/eid.h"  // struct bundle7_eid_parser
-
 #include "ud3tn/bundle.h"  // struct bundle
+#include "ud3tn/bundle_arena.h"  // struct bundle_arena
 #include "ud3tn/crc.h"     // struct crc_stream
 #include "ud3tn/parser.h"  // struct parser
 #include "ud3tn/result.h"  // enum ud3tn_result
 
-#include "cbor.h"
-
-#include <limits.h>
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 
 #define BUNDLE7_DEFAULT_BUNDLE_QUOTA SIZE_MAX
 
+// Whether the CRC of payload blocks is verified on demand instead of while
+// parsing, see bundle7_verify_crc(). Can be changed per parser at runtime.
+#ifndef BUNDLE7_PARSER_DEFER_CRC
+#define BUNDLE7_PARSER_DEFER_CRC 0
+#endif // BUNDLE7_PARSER_DEFER_CRC
+
+// Maximum length of the items of a block preceding its CRC type (array head,
+// block type, number and flags), which are buffered until the type is known.
+// Every head may take up to nine bytes, as non-shortest heads are accepted.
+#define BUNDLE7_CRC_PREFIX_MAX_SIZE (4 * 9)
+
 enum bundle7_parser_flags {
 	/**
 	 * If the flag is set the parser will - after successfully parsing and
@@ -24,20 +33,69 @@ enum bundle7_parser_flags {
 	 * the parsed CBOR element.
 	 */
 	BUNDLE_V7_PARSER_CRC_FEED = 0x01,
+
+	/**
+	 * The CRC type of the current block is not known yet, the bytes are
+	 * collected in crc_prefix.
+	 */
+	BUNDLE_V7_PARSER_CRC_PREFIX = 0x02,
+
+	/**
+	 * The current block would not be serialized exactly as received, as
+	 * its items are not encoded deterministically or cannot be retained.
+	 */
+	BUNDLE_V7_PARSER_NOT_REENCODABLE = 0x04,
+
+	// The CRC of the current block is verified on demand.
+	BUNDLE_V7_PARSER_CRC_DEFERRED = 0x08,
+};
+
+/**
+ * The CBOR item of the bundle the parser expects next.
+ */
+enum bundle7_parser_stage {
+	BUNDLE7_STAGE_BUNDLE_START,
+	BUNDLE7_STAGE_PRIMARY_BLOCK,
+	BUNDLE7_STAGE_VERSION,
+	BUNDLE7_STAGE_PROC_FLAGS,
+	BUNDLE7_STAGE_CRC_TYPE,
+	BUNDLE7_STAGE_DESTINATION,
+	BUNDLE7_STAGE_SOURCE,
+	BUNDLE7_STAGE_REPORT_TO,
+	BUNDLE7_STAGE_CREATION_TIMESTAMP,
+	BUNDLE7_STAGE_LIFETIME,
+	BUNDLE7_STAGE_FRAGMENT_OFFSET,
+	BUNDLE7_STAGE_TOTAL_ADU_LENGTH,
+	BUNDLE7_STAGE_PRIMARY_CRC,
+	BUNDLE7_STAGE_BLOCK,
+	BUNDLE7_STAGE_BLOCK_TYPE,
+	BUNDLE7_STAGE_BLOCK_NUMBER,
+	BUNDLE7_STAGE_BLOCK_PROC_FLAGS,
+	BUNDLE7_STAGE_BLOCK_CRC_TYPE,
+	BUNDLE7_STAGE_BLOCK_DATA,
+	// Block data is read by the caller ("bulk read")
+	BUNDLE7_STAGE_BLOCK_DATA_BULK,
+	BUNDLE7_STAGE_BLOCK_CRC,
+	BUNDLE7_STAGE_BUNDLE_END,
 };
 
 
 /**
- * BPv7-bis CBOR parser using the iterator-bases CBOR-decoding from TinyCBOR
+ * Streaming BPv7 parser decoding the CBOR items of the bundle directly from
+ * the input, one byte at a time if necessary. Every byte passed to it is
+ * consumed, so it can be fed with arbitrarily split chunks.
  */
 struct bundle7_parser {
 	struct parser *basedata;
 	uint8_t flags;
 
-	// CRC
-	struct crc_stream crc16;
-	struct crc_stream crc32;
-	uint32_t checksum;
+	// CRC of the current block, only of the type it uses
+	struct crc_stream crc;
+	uint8_t crc_prefix[BUNDLE7_CRC_PREFIX_MAX_SIZE];
+	uint8_t crc_prefix_length;
+	// Defer verifying the CRC of payload blocks, see
+	// BUNDLE7_PARSER_DEFER_CRC. Can be updated at any time.
+	bool defer_crc;
 
 	/**
 	 * Counts the number of CBOR bytes parsed for this bundle. This field
@@ -45,15 +103,41 @@ struct bundle7_parser {
 	 */
 	size_t bundle_size;
 	struct bundle *bundle;
+	// Memory for the small blocks of the current bundle
+	struct bundle_arena arena;
+	// Block data of the current bundle accounted in the memory budget
+	uint64_t budget_bytes;
+
+	enum bundle7_parser_stage stage;
+	// Position within composite items (EIDs, timestamp) of the stage
+	uint8_t item;
+	// Number of items of the array of the current block
+	uint64_t items;
+
+	/**
+	 * Head (initial byte and argument) of the CBOR item currently being
+	 * decoded, which may be split across multiple reads.
+	 */
+	struct {
+		uint8_t bytes[9];
+		uint8_t length;
+		// Number of bytes of the argument still missing
+		uint8_t missing;
+		uint64_t value;
+	} head;
 
 	/**
-	 * Parsing callbacks
-	 *
-	 * Each callback can advance this function to pointer to transition
-	 * into the next parsing stage.
+	 * Destination of the content of the string currently being read,
+	 * i.e. of a text string of an EID, a CRC or block data.
 	 */
-	CborError (*parse)(struct bundle7_parser *, CborValue *);
-	CborError (*next)(struct bundle7_parser *, CborValue *);
+	uint8_t *copy_pos;
+	size_t copy_remaining;
+
+	// EID being decoded and the node number of IPN EIDs
+	char *eid;
+	uint64_t ipn_node;
+	// CRC value received
+	union crc crc_value;
 
 	/**
 	 * The maximum block data size allowed for an incoming bundle.
@@ -73,12 +157,26 @@ struct bundle7_parser {
 };
 
 
+/**
+ * @brief Initialize the parser, the callback is invoked for every bundle
+ *	parsed successfully with its CRCs intact.
+ */
 struct parser *bundle7_parser_init(
 	struct bundle7_parser *state,
 	void (*send_callback)(struct bundle *, void *),
 	void *param);
 
 
+/**
+ * @brief Pass the next bytes of the input to the parser.
+ *
+ * If PARSER_FLAG_BULK_READ is set afterwards, the caller has to place the
+ * next_bytes following bytes in next_buffer, clear the flag and invoke the
+ * function again, e.g. with a NULL buffer.
+ *
+ * @return Number of bytes consumed, which is less than length if the bundle
+ *	ends, an error occurs or a bulk read is requested.
+ */
 size_t bundle7_parser_read(
 	struct bundle7_parser *parser,
 	const uint8_t *buffer,
@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef BUNDLE7_PROFILE_H_INCLUDED
+#define BUNDLE7_PROFILE_H_INCLUDED
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/result.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Extension blocks added to every bundle of a profile, in front of the
+ * payload block. None of them carries a CRC.
+ */
+enum bundle7_profile_blocks {
+	BUNDLE7_PROFILE_BLOCKS_NONE = 0x0,
+	BUNDLE7_PROFILE_BUNDLE_AGE  = 0x1,
+	BUNDLE7_PROFILE_HOP_COUNT   = 0x2,
+};
+
+// Payload block, Bundle Age block and Hop Count block
+#define BUNDLE7_PROFILE_MAX_BLOCKS 3
+
+// Array header, block type, block number, flags and CRC type of a block.
+#define BUNDLE7_PROFILE_BLOCK_HEADER_SIZE 5
+
+struct bundle7_profile_block {
+	enum bundle_block_type type;
+	uint8_t number;
+	// Encoded fields in front of the block data, only the length of the
+	// block data follows them.
+	uint8_t header[BUNDLE7_PROFILE_BLOCK_HEADER_SIZE];
+};
+
+/**
+ * A fixed shape of bundles sent by a node or agent, i.e. the same source,
+ * report-to EID, lifetime, CRC type and extension blocks. The serialization
+ * of the fields that are the same for all bundles of the profile is done
+ * once, when the profile is created. Bundles created from a profile reference
+ * it, which allows the serializer to skip the generic encoding of the blocks
+ * as long as the bundle still has the shape of the profile.
+ */
+struct bundle7_profile {
+	// NOTE: Modified atomically, bundles may be freed in different threads.
+	uint32_t ref_count;
+
+	// Interned EIDs, see ud3tn/eid_intern.h.
+	const char *source;
+	const char *report_to;
+	uint64_t lifetime_ms;
+	enum bundle_crc_type crc_type;
+	enum bundle7_profile_blocks extension_blocks;
+	uint16_t hop_limit;
+
+	// The blocks of every bundle, the payload block is the last one.
+	struct bundle7_profile_block blocks[BUNDLE7_PROFILE_MAX_BLOCKS];
+	uint8_t block_count;
+
+	// Encoded primary block fields following the creation timestamp: the
+	// lifetime and the (zero) CRC, which is replaced by the checksum. The
+	// lifetime is only taken from here if the bundle has the one of the
+	// profile.
+	uint8_t tail[9 + 5];
+	uint8_t tail_length;
+	// Length of all fields of the primary block that are the same for all
+	// bundles of the profile, i.e. without the processing flags,
+	// destination EID and creation timestamp fields.
+	size_t fixed_length;
+	// Encoded source and report-to EIDs, which follow the destination EID.
+	size_t eid_segment_length;
+	uint8_t eid_segment[];
+};
+
+/**
+ * Creates a profile for bundles from the given source EID.
+ *
+ * @param source The source EID of all bundles of the profile.
+ * @param report_to The report-to EID of all bundles, e.g. "dtn:none".
+ * @param lifetime_ms The lifetime of all bundles, in milliseconds.
+ * @param crc_type The CRC type of the primary block of all bundles.
+ * @param extension_blocks The extension blocks added to all bundles.
+ * @param hop_limit The hop limit, if a Hop Count block is added.
+ * @return A profile with a reference count of one, or NULL on error.
+ */
+struct bundle7_profile *bundle7_profile_create(
+	const char *source, const char *report_to, uint64_t lifetime_ms,
+	enum bundle_crc_type crc_type,
+	enum bundle7_profile_blocks extension_blocks, uint16_t hop_limit);
+
+/**
+ * Obtains another reference to the given profile, which may be NULL.
+ */
+struct bundle7_profile *bundle7_profile_ref(struct bundle7_profile *profile);
+
+/**
+ * Drops a reference, the profile is freed with the last reference.
+ */
+void bundle7_profile_unref(struct bundle7_profile *profile);
+
+/**
+ * Creates a bundle of the given profile, like bundle7_create_local(). The
+ * primary block is encoded right away, from the fields prepared in the
+ * profile and the given destination EID, creation timestamp and flags.
+ *
+ * @param payload The payload data, memory management is taken over by the
+ *                bundle. In case of errors, the memory is freed.
+ */
+struct bundle *bundle7_profile_create_bundle(
+	struct bundle7_profile *profile,
+	void *payload, size_t payload_length,
+	const char *destination,
+	uint64_t creation_time_ms, uint64_t sequence_number,
+	enum bundle_proc_flags proc_flags);
+
+/**
+ * Creates a bundle of the given profile, like bundle7_profile_create_bundle(),
+ * but with its own lifetime, e.g. for status reports inheriting the remaining
+ * lifetime of the bundle they refer to. The destination EID has to be
+ * interned already, the bundle takes a new reference to it.
+ */
+struct bundle *bundle7_profile_create_bundle_interned(
+	struct bundle7_profile *profile,
+	void *payload, size_t payload_length,
+	const char *destination,
+	uint64_t creation_time_ms, uint64_t sequence_number,
+	uint64_t lifetime_ms, enum bundle_proc_flags proc_flags);
+
+/**
+ * Checks whether the given bundle references a profile and still has its
+ * shape, i.e. it can be serialized using bundle7_profile_serialize().
+ */
+bool bundle7_profile_matches(const struct bundle *bundle);
+
+/**
+ * Serializes a bundle for which bundle7_profile_matches() is true, see
+ * bundle7_serialize_ref() for the parameters. Only the length of every block
+ * is encoded, everything else has been encoded before.
+ */
+enum ud3tn_result bundle7_profile_serialize(
+	struct bundle *bundle,
+	void (*write)(void *cla_obj, const void *, const size_t),
+	void (*write_ref)(void *cla_obj, const void *, const size_t),
+	void *cla_obj);
+
+#endif // BUNDLE7_PROFILE_H_INCLUDED
@@ -2,11 +2,38 @@
 #ifndef BUNDLE7_REPORTS_INCLUDED
 #define BUNDLE7_REPORTS_INCLUDED
 
+#include "bundle7/profile.h"
+
 #include "ud3tn/bundle.h"  // struct bundle, struct bundle_status_report
+#include "ud3tn/result.h"
 
 #include <stddef.h>
 #include <stdint.h>
 
+/**
+ * The parts of status report bundles that are the same for all reports sent
+ * by a node, prepared once to not look up and encode the EIDs for every
+ * report.
+ */
+struct bundle7_report_template {
+	// Profile of the reports, i.e. the local EID as source and "dtn:none"
+	// as report-to EID, which pre-encodes the constant parts of their
+	// primary block
+	struct bundle7_profile *profile;
+};
+
+/**
+ * Prepares a template for the status reports sent from the given source EID.
+ */
+enum ud3tn_result bundle7_report_template_init(
+	struct bundle7_report_template *template,
+	const char *source);
+
+/**
+ * Releases the EIDs referenced by the given template.
+ */
+void bundle7_report_template_deinit(struct bundle7_report_template *template);
+
 /**
  * Generates a BPv7-bis administrative record bundle of type
  * "Bundle status report" for the given bundle that can be send
@@ -18,6 +45,17 @@ struct bundle *bundle7_generate_status_report(
 	const char *source,
 	const uint64_t timestamp_ms);
 
+/**
+ * Like bundle7_generate_status_report(), but using the given template, which
+ * avoids interning the EIDs of the report bundle for every report. The record
+ * is encoded into an exactly sized buffer.
+ */
+struct bundle *bundle7_generate_status_report_templated(
+	const struct bundle7_report_template *template,
+	const struct bundle * const bundle,
+	const struct bundle_status_report *report,
+	const uint64_t timestamp_ms);
+
 
 /**
  * Generates a BPv7-bis administrative record bundle of type
@@ -65,5 +65,16 @@ enum ud3tn_result bundle7_serialize(
 	void (*write)(void *cla_obj, const void *, const size_t),
 	void *cla_obj);
 
+/**
+ * Like bundle7_serialize(), but passes data that stays valid until the bundle
+ * is modified, i.e. the block data and the cached primary block, to write_ref
+ * instead of write, such that it can be referenced instead of being copied.
+ */
+enum ud3tn_result bundle7_serialize_ref(
+	struct bundle *bundle,
+	void (*write)(void *cla_obj, const void *, const size_t),
+	void (*write_ref)(void *cla_obj, const void *, const size_t),
+	void *cla_obj);
+
 
 #endif /* BUNDLE_V7_SERIALIZER_H_INCLUDED */
@@ -14,9 +14,28 @@ struct bibe_header {
 	uint8_t *data;
 };
 
+/**
+ * @brief Parse a BPDU. The encapsulated bundle is not copied, the BPDU refers
+ *	to it in the provided buffer, which thus has to outlive the BPDU.
+ * @return Zero on success, otherwise a CborError.
+ */
 size_t bibe_parser_parse(const uint8_t *buffer, size_t length,
 			 struct bibe_protocol_data_unit *bpdu);
 
+/**
+ * @brief Get the length of the header preceding an encapsulated bundle of the
+ *	given size, i.e. of the AAP SENDBIBE message header and the BPDU header.
+ */
+size_t bibe_get_header_length(const char *dest_eid, size_t payload_len);
+
+/**
+ * @brief Encode the header preceding an encapsulated bundle of the given size
+ *	into the buffer, which has to hold bibe_get_header_length() bytes.
+ * @return The number of bytes written.
+ */
+size_t bibe_encode_header_into(uint8_t *buffer, const char *dest_eid,
+			       size_t payload_len);
+
 struct bibe_header bibe_encode_header(const char *dest_eid, size_t payload_len);
 
 #endif // CLA_BIBE_PROTO_H
@@ -25,6 +25,10 @@
 #define CONTACT_TX_TASK_QUEUE_LENGTH 3
 #endif // CONTACT_TX_TASK_QUEUE_LENGTH
 
+// Space reserved in front of small bundles for a CLA header, see
+// cla_send_packet() in struct cla_vtable.
+#define CLA_TX_PACKET_HEADROOM 16
+
 struct cla_config {
 	const struct cla_vtable *vtable;
 
@@ -53,6 +57,9 @@ struct cla_link {
 	QueueIdentifier_t tx_queue_handle;
 	// Semaphore blocking the TX queue while bundles are being added
 	Semaphore_t tx_queue_sem;
+
+	// Buffers of the TX task for cla_send_packet_iov(), reused per bundle
+	struct bundle_iov tx_iov;
 };
 
 struct cla_tx_queue {
@@ -70,6 +77,10 @@ enum ud3tn_result cla_initialize_all(
 
 struct cla_config *cla_config_get(const char *cla_addr);
 
+// Makes the CLA instance known to cla_config_get() under the name returned by
+// its vtable, replacing the instance previously registered for the name.
+void cla_register(struct cla_config *config);
+
 /*
  * Private API
  */
@@ -137,6 +148,23 @@ struct cla_vtable {
 	void (*cla_send_packet_data)(struct cla_link *,
 				     const void *,
 				     const size_t);
+	/*
+	 * Sends a whole serialized bundle, replacing the three functions
+	 * above for small bundles (optional). CLA_TX_PACKET_HEADROOM bytes in
+	 * front of the data may be overwritten, e.g., by a CLA header, such
+	 * that the packet can be passed to the OS at once.
+	 */
+	void (*cla_send_packet)(struct cla_link *,
+				uint8_t *, size_t, char *);
+	/*
+	 * Sends a whole bundle serialized by bundle_serialize_iov(), replacing
+	 * the first three functions above for bundles not taking the
+	 * small-bundle path (optional). The BUNDLE_IOV_HEADROOM entries in
+	 * front of the iovecs may be used, e.g., for a CLA header, such that
+	 * the packet can be passed to the OS at once, e.g. via sendmsg().
+	 */
+	void (*cla_send_packet_iov)(struct cla_link *,
+				    struct bundle_iov *, char *);
 
 	// RX Task API
 
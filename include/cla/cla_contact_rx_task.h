@@ -18,9 +18,11 @@ enum cla_payload_type {
 	PAYLOAD_IRRELEVANT = 127,
 };
 
-// Size of the input buffer in bytes == size of the chunks used for reading.
+// Size of the input buffer in bytes == maximum number of bytes requested from
+// the link per read. Data that does not fit into half of the buffer, e.g.
+// large payloads, is read directly into its destination (see rx_bulk_read).
 #ifndef CLA_RX_BUFFER_SIZE
-#define CLA_RX_BUFFER_SIZE 64
+#define CLA_RX_BUFFER_SIZE 65536
 #endif // CLA_RX_BUFFER_SIZE
 
 struct rx_task_data {
@@ -32,10 +34,13 @@ struct rx_task_data {
 	struct blackhole_parser blackhole_parser;
 
 	/**
-	 * Size of the input buffer in bytes.
+	 * Input buffer of CLA_RX_BUFFER_SIZE bytes, allocated by
+	 * rx_task_data_init(). The bytes in [read, end) have been received
+	 * but not yet consumed by the parsers, new data is appended at end.
 	 */
 	struct {
-		uint8_t start[CLA_RX_BUFFER_SIZE];
+		uint8_t *start;
+		uint8_t *read;
 		uint8_t *end;
 	} input_buffer;
 
@@ -55,9 +60,10 @@ void rx_task_data_deinit(struct rx_task_data *rx_data);
 // Forward declaration to prevent (circular) inclusion of cla.h here.
 struct cla_link;
 
-// Export read operations for the data decoder binary
-uint8_t *rx_bulk_read(struct cla_link *link);
-uint8_t *rx_chunk_read(struct cla_link *link);
+// Export read operations for the data decoder binary, both return the number
+// of bytes consumed from the input buffer.
+size_t rx_bulk_read(struct cla_link *link);
+size_t rx_chunk_read(struct cla_link *link);
 
 /**
  * @brief cla_launch_contact_rx_task Creates a new RX handler task.
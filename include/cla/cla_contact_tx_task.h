@@ -23,6 +23,15 @@ struct cla_contact_tx_task_command {
 
 enum ud3tn_result cla_launch_contact_tx_task(struct cla_link *link);
 
+/**
+ * @brief Serialize the given bundle and send it via the link. Bundles up to
+ *	BUNDLE_SMALL_MAX_SIZE bytes are assembled on the stack and handed over
+ *	to the CLA as a single packet. Larger bundles are handed over as iovecs
+ *	referencing the block data if the CLA supports it.
+ */
+enum ud3tn_result cla_contact_tx_send_bundle(
+	struct cla_link *link, struct bundle *bundle, char *cla_address);
+
 void cla_contact_tx_task_request_exit(QueueIdentifier_t queue);
 
 #endif /* CLA_CONTACT_TX_TASK_H_INCLUDED */
@@ -37,4 +37,10 @@ void bibe_end_packet(struct cla_link *link);
 void bibe_send_packet_data(
 	struct cla_link *link, const void *data, const size_t length);
 
+void bibe_send_packet(struct cla_link *link, uint8_t *data,
+		      const size_t length, char *cla_addr);
+
+void bibe_send_packet_iov(struct cla_link *link, struct bundle_iov *iov,
+			  char *cla_addr);
+
 #endif /* CLA_bibe_H */
@@ -8,6 +8,7 @@
 #include "ud3tn/bundle_processor.h"
 
 #include <stddef.h>
+#include <stdint.h>
 
 // Whether or not to close active TCP connections after a contact
 #ifndef CLA_MTCP_CLOSE_AFTER_CONTACT
@@ -39,4 +40,10 @@ void mtcp_end_packet(struct cla_link *link);
 void mtcp_send_packet_data(
 	struct cla_link *link, const void *data, const size_t length);
 
+void mtcp_send_packet(struct cla_link *link, uint8_t *data, size_t length,
+		      char *cla_addr);
+
+void mtcp_send_packet_iov(struct cla_link *link, struct bundle_iov *iov,
+			  char *cla_addr);
+
 #endif /* CLA_MTCP_H */
@@ -42,7 +42,8 @@
 #define CLA_TCP_ABORT_ON_LINK_TASK_TERMINATION 0
 #endif // CLA_TCP_ABORT_ON_LINK_TASK_TERMINATION
 
-// The number of slots in the TCP CLA hash tables (e.g. for TCPCLv3 and MTCP)
+// The initial number of slots in the TCP CLA hash tables (e.g. for TCPCLv3 and
+// MTCP), which grow as needed
 #ifndef CLA_TCP_PARAM_HTAB_SLOT_COUNT
 #define CLA_TCP_PARAM_HTAB_SLOT_COUNT 32
 #endif // CLA_TCP_PARAM_HTAB_SLOT_COUNT
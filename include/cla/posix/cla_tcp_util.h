@@ -5,6 +5,7 @@
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 #include <stdbool.h>
 #include <stddef.h>
@@ -67,6 +68,18 @@ ssize_t tcp_send_all(const int socket, const void *const buffer,
  */
 ssize_t tcp_recv_all(const int socket, void *const buffer, const size_t length);
 
+/**
+ * Send the data referenced by the given iovecs to the given socket using as
+ * few calls as possible, ignoring interruptions by signals.
+ *
+ * @param socket The socket to be written to.
+ * @param iov The iovecs referencing the data, which are modified.
+ * @param iov_count The number of iovecs.
+ * @return The return value is compatible to sendmsg(3).
+ *         errno might be set accordingly.
+ */
+ssize_t tcp_send_iov_all(const int socket, struct iovec *iov, size_t iov_count);
+
 /**
  * Helper structure for serializers accepting a writer function.
  */
@@ -10,6 +10,10 @@
 #ifndef HAL_PLATFORM_H_INCLUDED
 #define HAL_PLATFORM_H_INCLUDED
 
+#include "ud3tn/result.h"
+
+#include <stddef.h>
+
 /**
  * @brief hal_platform_init Allows the initialization of the underlying
  *			    operating system or hardware.
@@ -19,4 +23,14 @@
  */
 void hal_platform_init(int argc, char *argv[]);
 
+/**
+ * @brief hal_platform_get_random_bytes Fills the given buffer with random
+ *					bytes, e.g., to seed hash functions.
+ * @param buffer the buffer to be filled
+ * @param length the number of bytes to be written
+ * @return UD3TN_OK if the buffer was filled from a source of randomness
+ *	   suitable for cryptographic purposes, UD3TN_FAIL otherwise
+ */
+enum ud3tn_result hal_platform_get_random_bytes(void *buffer, size_t length);
+
 #endif /* HAL_PLATFORM_H_INCLUDED */
@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef ADMISSION_CONTROL_H_INCLUDED
+#define ADMISSION_CONTROL_H_INCLUDED
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/result.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Behavior if a bundle would exceed the configured backlog limits
+enum admission_policy {
+	// Accept all bundles, only maintain the counters.
+	ADMISSION_POLICY_NONE,
+	// Reject bundles exceeding a limit.
+	ADMISSION_POLICY_REJECT,
+	// Reject bundles of lower priority earlier, i.e., they may only use a
+	// share of the limits (see ADMISSION_*_PRIORITY_SHARE). Bundles
+	// exceeding a limit displace queued bundles of lower priority.
+	ADMISSION_POLICY_DROP_LOWEST,
+	// Hold back bundles exceeding a limit (or not fitting into any
+	// contact) in a bounded in-memory backlog until resources are freed.
+	ADMISSION_POLICY_DEFER,
+};
+
+// Default policy for bundles exceeding the backlog limits.
+#ifndef ADMISSION_POLICY
+#define ADMISSION_POLICY ADMISSION_POLICY_NONE
+#endif // ADMISSION_POLICY
+
+// Maximum bytes of bundle payload pending forwarding (0 = unlimited).
+#ifndef ADMISSION_MAX_BACKLOG_BYTES
+#define ADMISSION_MAX_BACKLOG_BYTES 0
+#endif // ADMISSION_MAX_BACKLOG_BYTES
+
+// Maximum bytes of bundle payload pending forwarding per destination node
+// (0 = unlimited).
+#ifndef ADMISSION_MAX_NODE_BACKLOG_BYTES
+#define ADMISSION_MAX_NODE_BACKLOG_BYTES 0
+#endif // ADMISSION_MAX_NODE_BACKLOG_BYTES
+
+// Share (in percent) of the limits usable by low/normal priority bundles if
+// ADMISSION_POLICY_DROP_LOWEST is used.
+#ifndef ADMISSION_LOW_PRIORITY_SHARE
+#define ADMISSION_LOW_PRIORITY_SHARE 50
+#endif // ADMISSION_LOW_PRIORITY_SHARE
+#ifndef ADMISSION_NORMAL_PRIORITY_SHARE
+#define ADMISSION_NORMAL_PRIORITY_SHARE 75
+#endif // ADMISSION_NORMAL_PRIORITY_SHARE
+
+// Maximum number of bundles held back if ADMISSION_POLICY_DEFER is used.
+#ifndef ADMISSION_DEFER_QUEUE_LENGTH
+#define ADMISSION_DEFER_QUEUE_LENGTH 64
+#endif // ADMISSION_DEFER_QUEUE_LENGTH
+
+// Number of owners (BP workers) held-back bundles are kept apart for, such
+// that every bundle is retried by the worker it belongs to. Bounded by the
+// width of the internal retry bit masks.
+#define ADMISSION_DEFER_OWNER_COUNT 64
+
+// Initial number of slots in the per-destination backlog hash table, which
+// grows as needed.
+#ifndef ADMISSION_HTAB_SLOT_COUNT
+#define ADMISSION_HTAB_SLOT_COUNT 64
+#endif // ADMISSION_HTAB_SLOT_COUNT
+
+struct admission_control_config {
+	enum admission_policy policy;
+	uint64_t max_backlog_bytes;
+	uint64_t max_node_backlog_bytes;
+	uint8_t low_priority_share;
+	uint8_t normal_priority_share;
+};
+
+enum admission_decision {
+	ADMISSION_ACCEPT,
+	ADMISSION_REJECT,
+	ADMISSION_DEFER,
+};
+
+// Determines the queued bundles that may be dropped in favor of a bundle
+// under ADMISSION_POLICY_DROP_LOWEST, see admission_control_get_drop_filter().
+struct admission_drop_filter {
+	// Only bundles of a lower priority are dropped.
+	enum bundle_routing_priority priority;
+	// If set, only bundles to this node ID free the resources needed.
+	const char *node_id;
+};
+
+struct admission_control_stats {
+	uint64_t backlog_bytes;
+	uint64_t backlog_bytes_by_priority[BUNDLE_RPRIO_MAX];
+	uint64_t admitted_bundles;
+	uint64_t admitted_bytes;
+	uint64_t rejected_bundles;
+	uint64_t rejected_bytes;
+	uint64_t deferred_bundles;
+	uint64_t deferred_bytes;
+};
+
+/**
+ * @brief Initialize the admission control state. Has to be called before
+ *	any other function of this module.
+ */
+enum ud3tn_result admission_control_init(void);
+void admission_control_free(void);
+
+struct admission_control_config admission_control_get_config(void);
+void admission_control_update_config(struct admission_control_config config);
+
+/**
+ * @brief Determine whether the bundle would be admitted, without accounting
+ *	it, e.g., for rejecting it at the source agent. Under
+ *	ADMISSION_POLICY_DROP_LOWEST, bundles that may displace queued bundles
+ *	of lower priority are accepted.
+ */
+enum admission_decision admission_control_check(struct bundle *bundle);
+
+/**
+ * @brief Check the bundle against the limits and, if accepted, add it to the
+ *	forwarding backlog. Rejected bundles are counted.
+ */
+enum admission_decision admission_control_admit(struct bundle *bundle);
+
+/**
+ * @brief Determine which queued bundles have to be dropped to admit the
+ *	bundle under ADMISSION_POLICY_DROP_LOWEST.
+ * @return false if the bundle fits into the limits, the policy is not used
+ *	or dropping bundles of lower priority would not help.
+ */
+bool admission_control_get_drop_filter(struct bundle *bundle,
+				       struct admission_drop_filter *filter);
+bool admission_control_drop_filter_matches(
+	const struct admission_drop_filter *filter, struct bundle *bundle);
+
+/**
+ * @brief Remove a previously-admitted bundle (or fragment of it) from the
+ *	forwarding backlog.
+ */
+void admission_control_release(struct bundle *bundle);
+
+/**
+ * @brief Hold back the bundle until resources are freed.
+ * @param owner Index of the BP worker the bundle has to be retried by.
+ * @return UD3TN_FAIL if the policy does not allow it or the backlog is full.
+ */
+enum ud3tn_result admission_control_defer(struct bundle *bundle,
+					  uint8_t owner);
+
+/**
+ * @brief Hold back an already-admitted bundle, e.g., a pre-empted one, until
+ *	resources are freed, regardless of the policy. It is not admitted
+ *	again and not counted as rejected if the backlog is full.
+ * @param owner Index of the BP worker the bundle has to be retried by.
+ * @return UD3TN_FAIL if the backlog is full.
+ */
+enum ud3tn_result admission_control_defer_admitted(struct bundle *bundle,
+						   uint8_t owner);
+
+/**
+ * @brief Indicate that contact capacity may have become available, such that
+ *	held-back bundles should be retried.
+ */
+void admission_control_notify_capacity(void);
+
+/**
+ * @brief Get the number of bundles held back for the given owner to be
+ *	retried, if resources have been freed since the last call for that
+ *	owner, otherwise zero.
+ */
+size_t admission_control_get_retry_count(uint8_t owner);
+
+/**
+ * @brief Determine whether the owner has to be woken up to retry its
+ *	held-back bundles. Returns true only once until the owner calls
+ *	admission_control_get_retry_count().
+ */
+bool admission_control_claim_retry_wakeup(uint8_t owner);
+
+/**
+ * @brief Take the oldest bundle held back for the given owner.
+ */
+struct bundle *admission_control_pop_deferred(uint8_t owner);
+
+struct admission_control_stats admission_control_get_stats(void);
+
+#endif /* ADMISSION_CONTROL_H_INCLUDED */
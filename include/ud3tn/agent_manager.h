@@ -19,6 +19,10 @@ struct agent {
 struct agent_list {
 	struct agent agent_data;
 	struct agent_list *next;
+	// Number of callbacks in progress, protected by the agent manager.
+	unsigned int ref_count;
+	// Released by the last callback of a deregistered agent.
+	Semaphore_t released;
 };
 
 /**
@@ -31,10 +35,11 @@ void agent_manager_init(const char *const ud3tn_local_eid, QueueIdentifier_t res
 /**
  * @brief agent_forward Invoke the callback associated with the specified
  *	sink_identifier in the thread of the caller
+ * @note Callbacks are invoked without holding a lock, i.e., an agent's
+ *	callback may run concurrently in multiple BP workers and has to
+ *	protect the state it modifies. Callbacks may call agent_forward again.
  * @return int Return an error if the sink_identifier is unknown or the
  *	callback is NULL
- *
- * @not_thread_safe
  */
 int agent_forward(const char *sink_identifier, struct bundle_adu data,
 		  const void *bp_context);
@@ -47,20 +52,17 @@ int agent_forward(const char *sink_identifier, struct bundle_adu data,
  * @param is_subscriber Whether to receive bundles with this agent or not
  * @return int Return an error if the sink_identifier is not unique or
  *	registration fails
- *
- * @not_thread_safe
  */
 int agent_register(struct agent agent, bool is_subscriber);
 
 /**
  * @brief agent_deregister Remove the agent associated with the specified
- *	sink_identifier
+ *	sink_identifier, waiting for callbacks of the agent in progress
+ * @note Must not be called from within a callback of the agent.
  * @param sink_identifier The identifier of the agent to be unregistered
  * @param is_subscriber Whether to receive bundles with this agent or not
  * @return int Return an error if the sink_identifier is unknown or the
  *	deregistration fails
- *
- * @not_thread_safe
  */
 int agent_deregister(const char *sink_identifier, bool is_subscriber);
 
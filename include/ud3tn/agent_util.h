@@ -8,15 +8,31 @@
 #include <stddef.h>
 #include <stdint.h>
 
+/**
+ * Creates a profile for the BPv7 bundles sent by the given sink of the local
+ * node, see bundle7/profile.h. The bundles have the same shape as the ones
+ * created without a profile.
+ */
+struct bundle7_profile *agent_create_profile(const char *local_eid,
+	const char *sink_id, const uint64_t lifetime_ms);
+
+/**
+ * Creates a bundle sent by the given sink of the local node. If a profile
+ * created by agent_create_profile() for the sink is passed, BPv7 bundles are
+ * created from it, the local EID, sink ID and lifetime are taken from the
+ * profile in this case.
+ */
 struct bundle *agent_create_bundle(const uint8_t bp_version,
-	const char *local_eid, char *sink_id, char *destination,
+	struct bundle7_profile *profile,
+	const char *local_eid, char *sink_id, const char *destination,
 	const uint64_t creation_timestamp_ms, const uint64_t sequence_number,
 	const uint64_t lifetime_ms, void *payload, size_t payload_length,
 	enum bundle_proc_flags flags);
 
 struct bundle *agent_create_forward_bundle(
 	const struct bundle_agent_interface *bundle_agent_interface,
-	const uint8_t bp_version, char *sink_id, char *destination,
+	const uint8_t bp_version, struct bundle7_profile *profile,
+	char *sink_id, const char *destination,
 	const uint64_t creation_timestamp_ms, const uint64_t sequence_number,
 	const uint64_t lifetime_ms, void *payload, size_t payload_length,
 	enum bundle_proc_flags flags);
@@ -26,7 +42,8 @@ struct bp_context;
 struct bundle *agent_create_forward_bundle_direct(
 	const struct bp_context *bundle_processor_context,
 	const char *local_eid,
-	const uint8_t bp_version, char *sink_id, char *destination,
+	const uint8_t bp_version, struct bundle7_profile *profile,
+	char *sink_id, const char *destination,
 	const uint64_t creation_timestamp_s, const uint64_t sequence_number,
 	const uint64_t lifetime, void *payload, size_t payload_length,
 	enum bundle_proc_flags flags);
@@ -3,17 +3,29 @@
 #define BUNDLE_H_INCLUDED
 
 #include "ud3tn/common.h"
+#include "ud3tn/object_pool.h"
 #include "ud3tn/result.h"
+#include "ud3tn/shared_buffer.h"
 
 #include <stdbool.h>  // bool
 #include <stddef.h>   // size_t
 #include <stdint.h>   // uint*_t
 
+#include <sys/uio.h>  // struct iovec
+
 // Bundles requiring more space will be dropped immediately for safety.
 #ifndef BUNDLE_MAX_SIZE
 #define BUNDLE_MAX_SIZE 1073741824
 #endif // BUNDLE_MAX_SIZE
 
+// Bundles up to this serialized size (in bytes) take the small-bundle fast
+// path: they are routed directly to the first suitable contact and the TX task
+// serializes them into a buffer on its stack, handing the CLA a complete packet
+// at once. Zero disables the fast path.
+#ifndef BUNDLE_SMALL_MAX_SIZE
+#define BUNDLE_SMALL_MAX_SIZE 512
+#endif // BUNDLE_SMALL_MAX_SIZE
+
 struct endpoint_list {
 	char *eid;
 	struct endpoint_list *next;
@@ -121,6 +133,13 @@ union crc {
 };
 
 
+struct bundle_block;
+
+struct bundle_block_list {
+	struct bundle_block *data;
+	struct bundle_block_list *next;
+};
+
 struct bundle_block {
 	enum bundle_block_type type;
 	uint8_t number;
@@ -128,6 +147,9 @@ struct bundle_block {
 
 	uint32_t length;
 	uint8_t *data;
+	/* If set, data points into this buffer, which is shared with other
+	 * blocks (e.g. fragments), and must neither be modified nor freed. */
+	struct shared_buffer *buffer;
 
 	/* RFC 5050: EID references associated to the block */
 	struct endpoint_list *eid_refs;
@@ -135,6 +157,17 @@ struct bundle_block {
 	/* BPbis: CRC */
 	enum bundle_crc_type crc_type;
 	union crc crc;
+	/* If set, the received CRC has not been verified yet, crc_partial
+	 * holds the checksum over the block up to its data (see
+	 * bundle7_verify_crc()). */
+	bool crc_pending;
+	uint32_t crc_partial;
+
+	/* List entry allocated together with the block, which is used by
+	 * bundle_block_entry_create() unless it is already in use. Walking a
+	 * block list thus only touches one object per block. */
+	bool list_entry_in_use;
+	struct bundle_block_list list_entry;
 };
 
 struct bundle_hop_count {
@@ -142,11 +175,19 @@ struct bundle_hop_count {
 	uint16_t count;
 };
 
-struct bundle_block_list {
-	struct bundle_block *data;
-	struct bundle_block_list *next;
+/*
+ * 128-bit digest of the fields identifying a bundle or fragment: protocol
+ * version, source EID, creation timestamp, sequence number, fragment offset
+ * and payload length. It is computed using SipHash (see siphash.h), thus, IDs
+ * are only comparable within a single run of uD3TN.
+ */
+struct bundle_id {
+	uint64_t lo;
+	uint64_t hi;
 };
 
+struct bundle7_profile;
+
 struct bundle {
 	uint8_t protocol_version;
 
@@ -154,11 +195,12 @@ struct bundle {
 	enum bundle_retention_constraints ret_constraints;
 	enum bundle_crc_type crc_type;
 
-	char *destination;
-	char *source;
-	char *report_to;
+	// NOTE: All EIDs are interned, see ud3tn/eid_intern.h.
+	const char *destination;
+	const char *source;
+	const char *report_to;
 	// RFC 5050
-	char *current_custodian;
+	const char *current_custodian;
 
 	// DTN timestamp of bundle creation, in milliseconds. Zero if undetermined.
 	uint64_t creation_timestamp_ms;
@@ -177,19 +219,29 @@ struct bundle {
 	 */
 	uint16_t primary_block_length;
 
+	/**
+	 * Caches, see bundle_invalidate_block_caches() and
+	 * bundle_recalculate_header_length().
+	 */
+	// Serialized size of the whole bundle, zero if not determined yet.
+	size_t serialized_size;
+	// BPv7: Primary block including its CRC (primary_block_length bytes),
+	// NULL if it has not been encoded yet.
+	uint8_t *encoded_primary_block;
+	// Bit (type % 32) is set for the type of every block of the bundle,
+	// zero if not determined yet. See bundle_has_block_type().
+	uint32_t block_type_filter;
+	// Zero if not computed yet, see bundle_get_id().
+	struct bundle_id id;
+
+	// BPv7: The profile the bundle has been created from, a reference is
+	// held by the bundle. NULL for all other bundles, see bundle7/profile.h.
+	struct bundle7_profile *profile;
+
 	struct bundle_block_list *blocks;
 	struct bundle_block *payload_block;
 };
 
-struct bundle_unique_identifier {
-	uint8_t protocol_version;
-	char *source;
-	uint64_t creation_timestamp_ms;
-	uint64_t sequence_number;
-	uint32_t fragment_offset;
-	uint32_t payload_length;
-};
-
 enum bundle_administrative_record_type {
 	// administrative record is a status report
 	BUNDLE_AR_STATUS_REPORT  = 1,
@@ -371,10 +423,14 @@ enum bundle_routing_priority {
 struct bundle_adu {
 	uint8_t protocol_version;
 	enum bundle_proc_flags proc_flags;
-	char *source;
-	char *destination;
+	// Interned EIDs
+	const char *source;
+	const char *destination;
 	uint8_t *payload;
 	size_t length;
+	/* If set, the payload is an immutable slice of this buffer which is
+	 * released instead of freeing the payload. */
+	struct shared_buffer *payload_buffer;
 	uint64_t bundle_creation_timestamp_ms;
 	uint64_t bundle_sequence_number;
 };
@@ -409,6 +465,12 @@ uint64_t bundle_get_expiration_time_s(const struct bundle *bundle);
 enum ud3tn_result bundle_age_update(struct bundle *bundle,
 	const uint64_t dwell_time_ms);
 
+// Pools for the structures below, bundle_free() and bundle_block_free() as
+// well as bundle_block_entry_free() return the objects to them.
+extern struct object_pool bundle_pool;
+extern struct object_pool bundle_block_pool;
+extern struct object_pool bundle_block_list_pool;
+
 struct bundle *bundle_init(void);
 void bundle_free_dynamic_parts(struct bundle *bundle);
 void bundle_reset(struct bundle *bundle);
@@ -423,12 +485,31 @@ void bundle_drop(struct bundle *bundle);
  */
 void bundle_copy_headers(struct bundle *to, const struct bundle *from);
 
+/**
+ * Recalculate the length of the primary block, has to be invoked after
+ * modifying any primary block field. Invalidates the serialization cache.
+ */
 enum ud3tn_result bundle_recalculate_header_length(struct bundle *bundle);
+
+/**
+ * Invalidate the cached serialized size and block types, has to be invoked
+ * after adding, removing or modifying extension blocks (e.g., updating the
+ * bundle age).
+ */
+static inline void bundle_invalidate_block_caches(struct bundle *bundle)
+{
+	bundle->serialized_size = 0;
+	bundle->block_type_filter = 0;
+}
+
 struct bundle *bundle_dup(const struct bundle *bundle);
 
 enum bundle_routing_priority bundle_get_routing_priority(
 	struct bundle *bundle);
 
+/**
+ * Get the serialized size of the bundle, which is cached until invalidated.
+ */
 size_t bundle_get_serialized_size(struct bundle *bundle);
 size_t bundle_get_first_fragment_min_size(struct bundle *bundle);
 size_t bundle_get_mid_fragment_min_size(struct bundle *bundle);
@@ -447,6 +528,42 @@ struct bundle_block_list *bundle_block_list_dup(struct bundle_block_list *e);
 struct bundle_block *bundle_block_find_first_by_type(
 	struct bundle_block_list *blocks, enum bundle_block_type type);
 
+/**
+ * Check whether the bundle may contain a block of the given type. If false
+ * is returned, it is guaranteed to contain none. This check is O(1) after
+ * the first invocation until the blocks are modified.
+ */
+bool bundle_has_block_type(struct bundle *bundle, enum bundle_block_type type);
+
+/**
+ * Like bundle_block_find_first_by_type(), but the block list is only walked
+ * if bundle_has_block_type() returns true.
+ */
+struct bundle_block *bundle_find_block(
+	struct bundle *bundle, enum bundle_block_type type);
+
+/**
+ * Convert the data owned by the block into a shared buffer, such that
+ * duplicates of the block reference it instead of copying it. Shared data
+ * must not be modified, use bundle_block_replace_data() instead.
+ */
+enum ud3tn_result bundle_block_make_shared(struct bundle_block *b);
+
+/**
+ * Let the target block reference a slice of the source block's data without
+ * copying it. The source data is converted into a shared buffer if needed.
+ */
+enum ud3tn_result bundle_block_share_slice(
+	struct bundle_block *target, struct bundle_block *source,
+	uint32_t offset, uint32_t length);
+
+/**
+ * Replace the data of the block by the given malloc'd buffer, releasing the
+ * previous (owned or shared) data.
+ */
+void bundle_block_replace_data(
+	struct bundle_block *b, uint8_t *data, uint32_t length);
+
 /**
  * Serializes a bundle into its on-wire byte-string representation.
  */
@@ -455,13 +572,66 @@ enum ud3tn_result bundle_serialize(
 	void (*write)(void *cla_obj, const void *, const size_t),
 	void *cla_obj);
 
-struct bundle_unique_identifier bundle_get_unique_identifier(
-	const struct bundle *bundle);
-void bundle_free_unique_identifier(struct bundle_unique_identifier *id);
-bool bundle_is_equal(
-	const struct bundle *bundle, const struct bundle_unique_identifier *id);
-bool bundle_is_equal_parent(
-	const struct bundle *bundle, const struct bundle_unique_identifier *id);
+// Number of unused entries in front of bundle_iov.iov, e.g. for a CLA header.
+#define BUNDLE_IOV_HEADROOM 1
+
+/*
+ * A serialized bundle as an array of iovecs, see bundle_serialize_iov().
+ * The encoded block headers are placed in a contiguous scratch buffer, whereas
+ * the block data is referenced in place, thus, the iovecs are only valid until
+ * the bundle is modified or freed. The buffers are reused for every bundle.
+ */
+struct bundle_iov {
+	// Entries to be sent in order, e.g. via writev() or sendmsg().
+	// BUNDLE_IOV_HEADROOM entries in front of them may be overwritten.
+	struct iovec *iov;
+	size_t iov_count;
+	// The total length of the data referenced by iov, i.e. serialized size
+	size_t length;
+
+	// Internal state
+	struct iovec *entries;
+	size_t entries_capacity;
+	uint8_t *scratch;
+	size_t scratch_length;
+	size_t scratch_capacity;
+	bool overflow;
+};
+
+void bundle_iov_init(struct bundle_iov *iov);
+void bundle_iov_free(struct bundle_iov *iov);
+
+/**
+ * Serializes a bundle into an array of iovecs referencing the block data in
+ * place instead of passing every piece of it to a write callback. The exact
+ * serialized size is known before encoding and the required buffers are
+ * allocated at once. Fails if the encoded size does not match it.
+ */
+enum ud3tn_result bundle_serialize_iov(
+	struct bundle *bundle, struct bundle_iov *iov);
+
+/**
+ * Get the ID of the bundle, which is computed once when the bundle has been
+ * parsed or first requested and cached until the primary block changes, see
+ * bundle_recalculate_header_length().
+ */
+struct bundle_id bundle_get_id(struct bundle *bundle);
+
+/**
+ * Get the ID of the original bundle a fragment has been created from, i.e.
+ * the ID of the reassembled bundle. Equals bundle_get_id() for bundles that
+ * are no fragments.
+ */
+struct bundle_id bundle_get_parent_id(struct bundle *bundle);
+
+static inline bool bundle_id_equal(
+	const struct bundle_id *a, const struct bundle_id *b)
+{
+	return a->lo == b->lo && a->hi == b->hi;
+}
+
+bool bundle_is_equal(struct bundle *bundle, const struct bundle_id *id);
+bool bundle_is_equal_parent(struct bundle *bundle, const struct bundle_id *id);
 
 /* ADU Operations */
 
@@ -474,9 +644,16 @@ struct bundle_adu bundle_adu_init(const struct bundle *bundle);
 /**
  * Initialize a new bundle ADU struct from the given bundle data, take over
  * the payload and remove it from the bundle. Note that the bundle is not freed.
+ * If the payload is shared with other bundles, the ADU references it, too.
  */
 struct bundle_adu bundle_to_adu(struct bundle *bundle);
 
+/**
+ * Remove the payload from the ADU and return it as malloc'd data owned by the
+ * caller, which is only copied if the payload is shared with others.
+ */
+uint8_t *bundle_adu_take_payload(struct bundle_adu *adu);
+
 /**
  * Free the members (including EIDs and payload) of the given ADU struct.
  */
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef BUNDLE_ARENA_H_INCLUDED
+#define BUNDLE_ARENA_H_INCLUDED
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/result.h"
+#include "ud3tn/shared_buffer.h"
+
+#include <stddef.h>
+
+/*
+ * Bump-pointer arena for the block data of a bundle being parsed. Instead of
+ * allocating every small block separately, the parsers place the data of all
+ * blocks up to BUNDLE_ARENA_MAX_BLOCK_SIZE bytes in one buffer which is
+ * shared by the blocks (see bundle_block_share_slice()). The memory is thus
+ * released at once when the last of these blocks is freed. Larger blocks,
+ * e.g. the payload of most bundles, are still allocated separately.
+ */
+
+// Data of blocks up to this size is placed in the arena, zero disables it.
+#ifndef BUNDLE_ARENA_MAX_BLOCK_SIZE
+#define BUNDLE_ARENA_MAX_BLOCK_SIZE 128
+#endif // BUNDLE_ARENA_MAX_BLOCK_SIZE
+
+// Size of a new arena, which is enlarged if a single block requires more.
+#ifndef BUNDLE_ARENA_SIZE
+#define BUNDLE_ARENA_SIZE 256
+#endif // BUNDLE_ARENA_SIZE
+
+struct bundle_arena {
+	struct shared_buffer *buffer;
+	size_t used;
+};
+
+/**
+ * @brief Provide uninitialized memory for the data of the given block, which
+ *	must not hold any data yet. The memory is either taken from the arena
+ *	or allocated separately, in both cases the block takes care of it.
+ */
+enum ud3tn_result bundle_arena_alloc_block_data(
+	struct bundle_arena *arena, struct bundle_block *block, size_t length);
+
+/**
+ * @brief Drop the reference to the current arena, has to be invoked when
+ *	the bundle has been parsed (or discarded) to not place data of the next
+ *	bundle in the same arena. The arena itself stays valid as long as any
+ *	block references it.
+ */
+void bundle_arena_release(struct bundle_arena *arena);
+
+#endif // BUNDLE_ARENA_H_INCLUDED
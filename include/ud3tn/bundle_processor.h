@@ -21,6 +21,22 @@ enum failed_forwarding_policy {
 #define FAILED_FORWARD_POLICY POLICY_DROP
 #endif // FAILED_FORWARD_POLICY
 
+// Default number of BP worker threads bundles are distributed to. If set to 1,
+// all bundles are processed by the BP task itself.
+#ifndef BUNDLE_PROCESSOR_WORKERS
+#define BUNDLE_PROCESSOR_WORKERS 1
+#endif // BUNDLE_PROCESSOR_WORKERS
+
+// Upper bound for the number of BP worker threads.
+#define BUNDLE_PROCESSOR_MAX_WORKERS 64
+
+// Whether bundles which are only forwarded are passed on without verifying a
+// CRC deferred by the parser (see BUNDLE7_PARSER_DEFER_CRC). The received CRC
+// is retained in this case, so that the next hop verifies it.
+#ifndef BUNDLE_PROCESSOR_DEFER_CRC_TO_NEXT_HOP
+#define BUNDLE_PROCESSOR_DEFER_CRC_TO_NEXT_HOP 0
+#endif // BUNDLE_PROCESSOR_DEFER_CRC_TO_NEXT_HOP
+
 // Interface to the bundle agent, provided to other agents and the CLA.
 struct bundle_agent_interface {
 	char *local_eid;
@@ -39,6 +55,12 @@ enum bundle_processor_signal_type {
 	BP_SIGNAL_CONTACT_OVER,
 	BP_SIGNAL_AGENT_REGISTER_RPC,
 	BP_SIGNAL_AGENT_DEREGISTER_RPC,
+	// A bundle pre-empted by another worker, to be routed again by the
+	// worker it belongs to.
+	BP_SIGNAL_BUNDLE_RESCHEDULE,
+	// Resources have been freed, retry the bundles held back by admission
+	// control for the receiving worker.
+	BP_SIGNAL_RETRY_DEFERRED,
 };
 
 // for performing (de)register operations
@@ -62,6 +84,8 @@ struct bundle_processor_task_parameters {
 	const char *local_eid;
 	bool status_reporting;
 	bool allow_remote_configuration;
+	// Number of shards (worker threads) bundles are distributed to
+	uint8_t worker_count;
 	#ifdef ARCHIPEL_CORE
 	struct bundle_store* bundle_store;
 	QueueIdentifier_t bundle_restore_queue;
@@ -88,12 +112,13 @@ int bundle_processor_perform_agent_action(
 	bool wait_for_feedback);
 
 // Forward declaration of internal opaque struct. Only to be used by agents
-// from the BP task (not thread safe).
+// from the BP task or one of its workers (not thread safe).
 struct bp_context;
 
 /**
  * @brief Dispatch a bundle - only to be executed from the BP thread.
- * @note Only to be used by agents from the BP task (not thread safe).
+ * @note Only to be used by agents from the BP task or one of its workers,
+ *	using the context passed to the agent callback (not thread safe).
  */
 enum ud3tn_result bundle_processor_bundle_dispatch(
 	void *bp_context, struct bundle *bundle);
@@ -105,6 +130,21 @@ enum ud3tn_result bundle_processor_bundle_dispatch(
 void bundle_processor_handle_router_command(
 	void *bp_context, struct router_command *cmd);
 
+/**
+ * @brief Select the BP worker responsible for a bundle.
+ *
+ * Bundles addressed to the local node are assigned by source node, all
+ * others by destination node.
+ *
+ * @param bundle The bundle, with interned source and destination EIDs
+ * @param destination_is_local Whether the bundle is addressed to us
+ * @param worker_count The number of workers, at least one
+ * @return The index of the worker, less than worker_count
+ */
+uint8_t bundle_processor_get_worker_index(
+	const struct bundle *bundle, bool destination_is_local,
+	uint8_t worker_count);
+
 void bundle_processor_task(void *param);
 
 #endif /* BUNDLEPROCESSOR_H_INCLUDED */
@@ -63,6 +63,7 @@ struct ud3tn_cmdline_options {
 	char *aap2_socket; // e.g.: /tmp/ud3tn.aap2.socket
 	uint8_t bundle_version;
 	uint8_t log_level;
+	uint8_t bp_workers; // number of BP worker threads
 	bool status_reporting;
 	bool allow_remote_configuration;
 	bool exit_immediately; // after parsing --help or --usage etc.
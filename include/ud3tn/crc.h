@@ -75,6 +75,12 @@ uint32_t crc32(const uint8_t *data, size_t len);
 
 void crc_init(struct crc_stream *crc, enum crc_version version);
 
+/**
+ * @brief Feed the given bytes into the CRC stream, which is considerably
+ *	faster than invoking feed() for every byte. CRC-32-C is computed using
+ *	the CRC instructions of the target if the compiler may emit them, e.g.
+ *	with -msse4.2 on x86-64 or -march=armv8-a+crc on AArch64.
+ */
 void crc_feed_bytes(struct crc_stream *crc, const uint8_t *data, size_t len);
 
 
@@ -15,6 +15,23 @@ enum eid_scheme {
 	EID_SCHEME_IPN,
 };
 
+/**
+ * Structured form of a valid EID, see eid_parse().
+ */
+struct eid_parsed {
+	enum eid_scheme scheme;
+	// ipn: The node and service number
+	uint64_t ipn_node;
+	uint64_t ipn_service;
+	// dtn: The length of the node name, e.g., of "node" in "dtn://node/a",
+	// zero for "dtn:none"
+	uint16_t dtn_node_length;
+	// Offset of the agent ID in the EID string, i.e. of the demux following
+	// "dtn://node/" (which may be empty) or of the ipn service number, zero
+	// if the EID does not contain one (e.g. "dtn://node" or "dtn:none")
+	uint16_t agent_id_offset;
+};
+
 /**
  * Performs validation for the given EID string.
  *
@@ -24,6 +41,18 @@ enum eid_scheme {
  */
 enum ud3tn_result validate_eid(const char *eid);
 
+/**
+ * Validates the given EID string and determines its structured form in a
+ * single pass, so that it has not to be parsed again later.
+ *
+ * @param eid EID string
+ * @param out An optional pointer to return the structured form, which is only
+ *            modified if the EID is valid
+ *
+ * @return UD3TN_OK if the EID string is valid, see validate_eid().
+ */
+enum ud3tn_result eid_parse(const char *eid, struct eid_parsed *out);
+
 /**
  * Validate the demux part of a dtn EID, i.e., the agent ID for us.
  *
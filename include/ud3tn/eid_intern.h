@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef EID_INTERN_H_INCLUDED
+#define EID_INTERN_H_INCLUDED
+
+#include "ud3tn/eid.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Global table of interned endpoint identifiers. Every distinct EID string is
+ * stored once, together with its hash and parsed form. Interned EIDs are
+ * reference-counted, immutable strings, thus, two interned EIDs are equal if
+ * and only if the pointers are equal. They must only be released using
+ * eid_intern_release() and never be modified or passed to free().
+ */
+
+// Number of slots in the EID table. Every slot holds a chain of entries, thus,
+// the number of EIDs is not limited by it. The default keeps the chains short
+// for the EIDs of a few hundred nodes and their agents at 8 KiB on 64-bit
+// platforms, larger deployments should raise it.
+#ifndef EID_INTERN_SLOT_COUNT
+#define EID_INTERN_SLOT_COUNT 1024
+#endif // EID_INTERN_SLOT_COUNT
+
+struct eid_intern_info {
+	// Hash of the EID string, see hashtable_hash().
+	uint32_t hash;
+	size_t length;
+	// Whether the EID is valid, see eid_parse().
+	bool valid;
+	// The structured form of the EID, see struct eid_parsed. Only the
+	// scheme is set if the EID is not valid.
+	enum eid_scheme scheme;
+	uint64_t ipn_node;
+	uint64_t ipn_service;
+	uint16_t dtn_node_length;
+	uint16_t agent_id_offset;
+};
+
+/**
+ * @brief Obtain a reference to the interned copy of the given EID string.
+ * @return The interned EID or NULL if the argument is NULL or no memory is
+ *         left.
+ */
+const char *eid_intern(const char *eid);
+
+/**
+ * @brief Obtain a reference to the interned "ipn:node.service" EID without
+ *        having to format and allocate it as a string first.
+ * @return The interned EID or NULL if no memory is left.
+ */
+const char *eid_intern_ipn(uint64_t node, uint64_t service);
+
+/**
+ * @brief Intern the given malloc'd EID string and free it.
+ * @return The interned EID or NULL if the argument is NULL or no memory is
+ *         left.
+ */
+const char *eid_intern_take(char *eid);
+
+/**
+ * @brief Obtain another reference to an interned EID, passing NULL is allowed.
+ * @return The given interned EID.
+ */
+const char *eid_intern_ref(const char *eid);
+
+/**
+ * @brief Drop a reference to an interned EID, passing NULL is allowed.
+ */
+void eid_intern_release(const char *eid);
+
+/**
+ * @brief Obtain the parsed form of an interned EID.
+ */
+const struct eid_intern_info *eid_intern_get_info(const char *eid);
+
+/**
+ * @brief Obtain the interned node ID of an interned EID, see get_node_id().
+ * @return The node ID, which stays valid as long as the given EID is
+ *         referenced, or NULL if the EID does not have a node ID.
+ */
+const char *eid_intern_get_node_id(const char *eid);
+
+/**
+ * @brief Obtain the number of distinct EIDs currently interned.
+ */
+size_t eid_intern_get_count(void);
+
+#endif // EID_INTERN_H_INCLUDED
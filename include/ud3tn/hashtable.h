@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef HASHTABLE_H_INCLUDED
+#define HASHTABLE_H_INCLUDED
+
+#include "ud3tn/result.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Hash table mapping strings to (non-NULL) pointers, replacing simplehtab.
+ *
+ * Entries are stored in a single array using open addressing with linear
+ * probing. Every slot contains the hash and length of its key, thus, probing
+ * only dereferences keys that are very likely equal to the one looked up. If
+ * the load factor exceeds 3/4, an array of twice the size is allocated and the
+ * entries are moved over a few slots per modifying operation, so no single
+ * insertion has to rehash the whole table.
+ *
+ * Keys are hashed using SipHash (see siphash.h), so that peers cannot degrade
+ * the tables by sending crafted EIDs. As the hash is the same for all tables,
+ * it can be computed once and passed to the *_hashed() functions (see, e.g.,
+ * eid_intern_get_info()).
+ *
+ * Keys are copied on insertion. The tables are not thread-safe.
+ */
+
+// Number of slots allocated on the first insertion if no (larger) capacity is
+// passed to hashtable_init(). Has to be a power of two, and
+// unsigned like the capacities it is compared against.
+#ifndef HASHTABLE_MIN_CAPACITY
+#define HASHTABLE_MIN_CAPACITY 8U
+#endif // HASHTABLE_MIN_CAPACITY
+
+struct hashtable_slot {
+	uint32_t hash;
+	uint32_t key_length;
+	// NULL if the slot is empty
+	char *key;
+	void *value;
+};
+
+struct hashtable {
+	struct hashtable_slot *slots;
+	// Always a power of two, zero until the first insertion
+	size_t capacity;
+	size_t initial_capacity;
+	size_t count;
+
+	// Array the entries are moved out of while growing, otherwise NULL
+	struct hashtable_slot *old_slots;
+	size_t old_capacity;
+	size_t old_count;
+	size_t migrate_index;
+};
+
+/**
+ * @brief Initialize an empty table. No memory is allocated until the first
+ *	insertion. A zero-initialized table is equivalent to one initialized
+ *	with an initial capacity of zero.
+ * @param initial_capacity Number of slots to start with, rounded up to a power
+ *	of two (at least HASHTABLE_MIN_CAPACITY). The table grows as needed.
+ */
+void hashtable_init(struct hashtable *tab, size_t initial_capacity);
+
+/**
+ * @brief Remove all entries and release the memory of the table, which can be
+ *	used again afterwards.
+ * @param release_value Function invoked for every value removed, may be NULL.
+ */
+void hashtable_clear(struct hashtable *tab, void (*release_value)(void *));
+
+/**
+ * @brief Hash the given key like the hash table does.
+ */
+uint32_t hashtable_hash(const char *key, size_t length);
+
+/**
+ * @brief Add a new entry to the table.
+ * @return UD3TN_OK, or UD3TN_FAIL if the key is already present or no memory
+ *	is left.
+ */
+enum ud3tn_result hashtable_add(struct hashtable *tab, const char *key,
+				void *value);
+enum ud3tn_result hashtable_add_hashed(struct hashtable *tab, const char *key,
+				       size_t length, uint32_t hash,
+				       void *value);
+
+/**
+ * @brief Look up the value associated with the given key.
+ * @return The value or NULL if the key is not present.
+ */
+void *hashtable_get(const struct hashtable *tab, const char *key);
+void *hashtable_get_hashed(const struct hashtable *tab, const char *key,
+			   size_t length, uint32_t hash);
+
+/**
+ * @brief Remove the entry with the given key from the table.
+ * @return The value of the removed entry or NULL if the key was not present.
+ */
+void *hashtable_remove(struct hashtable *tab, const char *key);
+void *hashtable_remove_hashed(struct hashtable *tab, const char *key,
+			      size_t length, uint32_t hash);
+
+/**
+ * @brief Obtain the number of entries in the table.
+ */
+size_t hashtable_count(const struct hashtable *tab);
+
+#endif // HASHTABLE_H_INCLUDED
@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef MEMORY_BUDGET_H_INCLUDED
+#define MEMORY_BUDGET_H_INCLUDED
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Global accounting of the memory held by bundles on their way through uD3TN,
+ * split up by where the memory is held. Only block data is accounted, which
+ * dominates the memory use of all but the smallest bundles.
+ *
+ * If the total usage or the usage of a category exceeds
+ * MEMORY_BUDGET_BACKPRESSURE_PERCENT of its budget, the CLA RX tasks stop
+ * reading from their links until memory is freed, such that, e.g., TCP flow
+ * control throttles the peers. Bundles are only dropped if receiving them
+ * would exceed the budget (see memory_budget_acquire()).
+ *
+ * Memory of fragments waiting for reassembly and of ADUs waiting for agents
+ * does not cause backpressure: Reassemblies only complete when more fragments
+ * are received, and a single slow agent must not stall all links. Fragments
+ * exceeding the reassembly budget are rejected instead.
+ *
+ * A budget of zero means "unlimited". The counters are always maintained.
+ */
+
+enum memory_budget_category {
+	// Block data of bundles currently being received by a parser
+	MEMORY_BUDGET_PARSING,
+	// Payload of bundles pending forwarding, e.g. queued on contacts
+	MEMORY_BUDGET_FORWARDING,
+	// Payload of fragments waiting for reassembly
+	MEMORY_BUDGET_REASSEMBLY,
+	// ADUs waiting in the pipes to the application agents
+	MEMORY_BUDGET_AGENT,
+	// Bundles being written back to the bundle store
+	MEMORY_BUDGET_STORE,
+
+	MEMORY_BUDGET_CATEGORY_COUNT
+};
+
+// Maximum total bytes held by bundles (0 = unlimited).
+#ifndef MEMORY_BUDGET_TOTAL_BYTES
+#define MEMORY_BUDGET_TOTAL_BYTES 0
+#endif // MEMORY_BUDGET_TOTAL_BYTES
+
+// Maximum bytes held per category (0 = unlimited).
+#ifndef MEMORY_BUDGET_PARSING_BYTES
+#define MEMORY_BUDGET_PARSING_BYTES 0
+#endif // MEMORY_BUDGET_PARSING_BYTES
+#ifndef MEMORY_BUDGET_FORWARDING_BYTES
+#define MEMORY_BUDGET_FORWARDING_BYTES 0
+#endif // MEMORY_BUDGET_FORWARDING_BYTES
+#ifndef MEMORY_BUDGET_REASSEMBLY_BYTES
+#define MEMORY_BUDGET_REASSEMBLY_BYTES 0
+#endif // MEMORY_BUDGET_REASSEMBLY_BYTES
+#ifndef MEMORY_BUDGET_AGENT_BYTES
+#define MEMORY_BUDGET_AGENT_BYTES 0
+#endif // MEMORY_BUDGET_AGENT_BYTES
+#ifndef MEMORY_BUDGET_STORE_BYTES
+#define MEMORY_BUDGET_STORE_BYTES 0
+#endif // MEMORY_BUDGET_STORE_BYTES
+
+// Share (in percent) of a budget above which the RX tasks pause reading.
+#ifndef MEMORY_BUDGET_BACKPRESSURE_PERCENT
+#define MEMORY_BUDGET_BACKPRESSURE_PERCENT 75
+#endif // MEMORY_BUDGET_BACKPRESSURE_PERCENT
+
+// Interval (in ms) at which paused RX tasks check whether memory was freed.
+#ifndef MEMORY_BUDGET_BACKPRESSURE_POLL_MS
+#define MEMORY_BUDGET_BACKPRESSURE_POLL_MS 10
+#endif // MEMORY_BUDGET_BACKPRESSURE_POLL_MS
+
+struct memory_budget_config {
+	uint64_t total_bytes;
+	uint64_t category_bytes[MEMORY_BUDGET_CATEGORY_COUNT];
+	uint8_t backpressure_percent;
+};
+
+struct memory_budget_stats {
+	uint64_t total_bytes;
+	uint64_t total_peak_bytes;
+	uint64_t bytes[MEMORY_BUDGET_CATEGORY_COUNT];
+	uint64_t peak_bytes[MEMORY_BUDGET_CATEGORY_COUNT];
+	// Requests denied by memory_budget_acquire()
+	uint64_t rejected_count;
+	uint64_t rejected_bytes;
+	// Number of times a thread had to wait in memory_budget_wait()
+	uint64_t backpressure_count;
+};
+
+struct memory_budget_config memory_budget_get_config(void);
+void memory_budget_update_config(struct memory_budget_config config);
+
+/**
+ * @brief Account memory about to be allocated, if it fits into the budgets.
+ * @return true if the memory has been accounted, false if it would exceed the
+ *	total budget or the budget of the category. In the latter case, the
+ *	caller is expected to drop the data.
+ */
+bool memory_budget_acquire(enum memory_budget_category category,
+			   uint64_t bytes);
+
+/**
+ * @brief Account memory that is already held, e.g. when a bundle is handed
+ *	over to another stage, regardless of the budgets.
+ */
+void memory_budget_charge(enum memory_budget_category category,
+			  uint64_t bytes);
+
+/**
+ * @brief Return memory accounted by memory_budget_acquire() or
+ *	memory_budget_charge().
+ */
+void memory_budget_release(enum memory_budget_category category,
+			   uint64_t bytes);
+
+/**
+ * @brief Determine whether the usage of any category causing backpressure,
+ *	or the sum of them, exceeds the backpressure threshold.
+ */
+bool memory_budget_is_congested(void);
+
+/**
+ * @brief Block the calling thread while memory_budget_is_congested() holds,
+ *	checking every MEMORY_BUDGET_BACKPRESSURE_POLL_MS.
+ * @param should_stop Invoked before every check, waiting is aborted if it
+ *	returns true. May be NULL.
+ * @return true if the thread had to wait.
+ */
+bool memory_budget_wait(bool (*should_stop)(void *), void *param);
+
+struct memory_budget_stats memory_budget_get_stats(void);
+
+/**
+ * @brief Log the current and peak usage of all categories.
+ */
+void memory_budget_log_stats(void);
+
+#endif /* MEMORY_BUDGET_H_INCLUDED */
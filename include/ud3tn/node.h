@@ -3,6 +3,7 @@
 #define NODE_H_INCLUDED
 
 #include "ud3tn/bundle.h"
+#include "ud3tn/object_pool.h"
 #include "ud3tn/result.h"
 
 #include <stdint.h>
@@ -57,6 +58,10 @@ struct node_list {
 	_c->remaining_capacity_p0)); \
 })
 
+// Pools for the list entries, (de)allocated per routed bundle and contact.
+extern struct object_pool routed_bundle_list_pool;
+extern struct object_pool contact_list_pool;
+
 struct node *node_create(char *eid);
 struct contact *contact_create(struct node *node);
 
@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef OBJECT_POOL_H_INCLUDED
+#define OBJECT_POOL_H_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Fixed-size object pools for the small structures allocated per bundle
+ * (bundles, blocks, list entries). Objects are carved out of slabs that are
+ * never returned to the system. Every thread keeps a small cache of free
+ * objects per pool, so allocating and releasing an object usually does not
+ * require any synchronization. If a cache runs empty it takes over all objects
+ * released to the global, lock-free free list of the pool by other threads.
+ */
+
+// Use malloc() and free() for every object instead of slabs, e.g., to let
+// tools like ASan or Valgrind track the lifetime of every single object.
+#ifndef OBJECT_POOL_USE_MALLOC
+#define OBJECT_POOL_USE_MALLOC 0
+#endif // OBJECT_POOL_USE_MALLOC
+
+// Number of objects allocated at once if no free object is available.
+#ifndef OBJECT_POOL_SLAB_OBJECTS
+#define OBJECT_POOL_SLAB_OBJECTS 64
+#endif // OBJECT_POOL_SLAB_OBJECTS
+
+// Number of free objects a thread keeps per pool when returning surplus
+// objects to the global free list.
+#ifndef OBJECT_POOL_CACHE_SIZE
+#define OBJECT_POOL_CACHE_SIZE 32
+#endif // OBJECT_POOL_CACHE_SIZE
+
+// Maximum number of pools with per-thread caches. Further pools fall back to
+// malloc() and free().
+#ifndef OBJECT_POOL_MAX_POOLS
+#define OBJECT_POOL_MAX_POOLS 16
+#endif // OBJECT_POOL_MAX_POOLS
+
+struct object_pool_object;
+struct object_pool_slab;
+
+struct object_pool {
+	const char *name;
+	size_t object_size;
+
+	// NOTE: All following members are modified atomically.
+
+	// Index of the per-thread cache plus one, zero until the first use.
+	int cache_index;
+	// Objects released by threads exceeding their cache size.
+	struct object_pool_object *free_list;
+	struct object_pool_slab *slabs;
+	int32_t in_use;
+	int32_t high_water;
+	uint32_t capacity;
+	// List of all pools that have been used, see object_pool_log_stats().
+	struct object_pool *next;
+};
+
+#define OBJECT_POOL_INITIALIZER(pool_name, type) { \
+	.name = (pool_name), \
+	.object_size = sizeof(type), \
+}
+
+/*
+ * Threads update the statistics in batches, i.e. the numbers of objects in
+ * use may lag behind by up to OBJECT_POOL_CACHE_SIZE per other thread.
+ */
+struct object_pool_stats {
+	// Objects currently allocated
+	uint32_t in_use;
+	// Maximum number of objects allocated at the same time
+	uint32_t high_water;
+	// Objects allocated from the system, i.e. in use or free for reuse
+	// (always zero if the pool falls back to malloc)
+	uint32_t capacity;
+};
+
+/**
+ * @brief Allocate an uninitialized object from the pool.
+ * @return The object or NULL if no memory is left.
+ */
+void *object_pool_alloc(struct object_pool *pool);
+
+/**
+ * @brief Return an object allocated using object_pool_alloc() to the pool.
+ *	Passing NULL is allowed and has no effect.
+ */
+void object_pool_free(struct object_pool *pool, void *object);
+
+/**
+ * @brief Obtain the current occupancy statistics of the given pool, including
+ *	all changes made by the calling thread.
+ */
+struct object_pool_stats object_pool_get_stats(struct object_pool *pool);
+
+/**
+ * @brief Log the statistics of all pools that have been used so far.
+ */
+void object_pool_log_stats(void);
+
+/**
+ * @brief Return the objects cached by the calling thread to the global free
+ *	lists, has to be invoked before a thread allocating objects terminates.
+ */
+void object_pool_thread_flush(void);
+
+#endif /* OBJECT_POOL_H_INCLUDED */
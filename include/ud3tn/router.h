@@ -10,14 +10,10 @@
 #include "ud3tn/node.h"
 #include "ud3tn/routing_table.h"
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
-// Maximum number of fragments created by the router.
-#ifndef ROUTER_MAX_FRAGMENTS
-#define ROUTER_MAX_FRAGMENTS 10
-#endif // ROUTER_MAX_FRAGMENTS
-
 // Default maximum bundle size.
 #ifndef ROUTER_GLOBAL_MBS
 #define ROUTER_GLOBAL_MBS SIZE_MAX
@@ -28,6 +24,12 @@
 #define FRAGMENT_MIN_PAYLOAD 8
 #endif // FRAGMENT_MIN_PAYLOAD
 
+// Whether higher-priority bundles may displace lower-priority bundles
+// queued for a contact that would otherwise have no capacity left for them.
+#ifndef ROUTER_PREEMPTION
+#define ROUTER_PREEMPTION 1
+#endif // ROUTER_PREEMPTION
+
 // Below this, the default route will be used
 #ifndef ROUTER_MIN_CONTACTS_HTAB
 #define ROUTER_MIN_CONTACTS_HTAB 10
@@ -38,6 +40,7 @@ struct router_config {
 	uint16_t fragment_min_payload;
 	uint8_t router_min_contacts_htab;
 	uint8_t router_min_contacts_nbf;
+	bool preemption_enabled;
 };
 
 struct fragment_route {
@@ -46,11 +49,22 @@ struct fragment_route {
 	uint8_t preemption_improved;
 };
 
-/* With MAX_FRAGMENTS = 3 and MAX_CONTACTS = 5: 92 bytes on stack */
 struct router_result {
-	struct fragment_route fragment_results[ROUTER_MAX_FRAGMENTS];
+	// Allocated on demand, has to be released via router_result_free().
+	struct fragment_route *fragment_results;
+	int32_t fragment_capacity;
 	int32_t fragments;
 	uint8_t preemption_improved;
+	// Bundles removed from contacts to make room for the routed bundle.
+	struct routed_bundle_list *preempted_bundles;
+};
+
+struct router_preemption_stats {
+	// Number of bundles routed by displacing lower-priority bundles
+	uint64_t preemptions;
+	// Number of bundles and bytes displaced, per routing priority
+	uint64_t evicted_bundles[BUNDLE_RPRIO_MAX];
+	uint64_t evicted_bytes[BUNDLE_RPRIO_MAX];
 };
 
 #define ROUTER_BUNDLE_PRIORITY(bundle) (bundle_get_routing_priority(bundle))
@@ -60,14 +74,75 @@ struct router_result {
 struct router_config router_get_config(void);
 void router_update_config(struct router_config config);
 
-struct contact_list *router_lookup_destination(char *dest);
+// The destination has to be an interned EID, see ud3tn/eid_intern.h.
+struct contact_list *router_lookup_destination(const char *dest);
 uint8_t router_calculate_fragment_route(
 	struct fragment_route *res, uint32_t size,
 	struct contact_list *contacts, uint32_t preprocessed_size,
 	enum bundle_routing_priority priority, uint64_t exp_time,
 	struct contact **excluded_contacts, uint8_t excluded_contacts_count);
 
+/**
+ * @brief Find the first contact over which a bundle of the given size and
+ *	priority could be sent if lower-priority bundles queued for it were
+ *	displaced, and remove as many of them as needed, most recently queued
+ *	and lowest priority first.
+ * @param evicted The removed bundles are prepended to this list.
+ * @return The contact, with sufficient capacity for the bundle, or NULL.
+ */
+struct contact *router_preempt_contact(
+	struct contact_list *contacts, uint32_t size,
+	enum bundle_routing_priority priority, uint64_t exp_time_ms,
+	struct routed_bundle_list **evicted);
+/**
+ * @brief Remove the bundle of the lowest priority for which may_evict()
+ *	returns true from the given contacts, preferring the most recently
+ *	queued one of the latest contact.
+ * @return The removed bundle, which has to be handled by the caller, or NULL.
+ */
+struct bundle *router_evict_bundle(
+	struct contact_list *contacts,
+	bool (*may_evict)(struct bundle *bundle, const void *param),
+	const void *param);
+/**
+ * @brief Get the pre-emption counters.
+ * @note The routing table lock should be held for a consistent result.
+ */
+struct router_preemption_stats router_get_preemption_stats(void);
+
+/**
+ * @brief Determine all fragments of the given bundle in a single pass over
+ *	the contacts, filling each contact up to its remaining capacity, but
+ *	creating no fragment larger than max_frag_sz. The number of fragments
+ *	is not limited.
+ * @return 1 if the whole payload could be assigned to contacts, else 0.
+ */
+uint8_t router_plan_fragments(
+	struct router_result *res, struct contact_list *contacts,
+	struct bundle *bundle, uint64_t exp_time_ms, uint32_t max_frag_sz);
+
 struct router_result router_get_first_route(struct bundle *bundle);
+
+/**
+ * @brief Determine the first contact that can carry the given bundle as a
+ *	whole without displacing other bundles, neither copying the contact list
+ *	nor allocating a result. Intended for small bundles, see
+ *	BUNDLE_SMALL_MAX_SIZE.
+ * @return The contact or NULL, in which case router_get_first_route() has to
+ *	be used to consider fragmentation and pre-emption.
+ */
+struct contact *router_get_direct_contact(struct bundle *bundle);
+/**
+ * @brief Same as router_get_direct_contact(), but selecting from the contacts
+ *	obtained from a routing table snapshot, see
+ *	routing_table_snapshot_lookup().
+ * @note Has to be called with the routing table lock held, after checking
+ *	that the snapshot is still current (see routing_table_get_version()).
+ */
+struct contact *router_get_direct_snapshot_contact(
+	struct bundle *bundle, const struct contact_snapshot *contacts,
+	uint32_t contact_count);
+void router_result_free(struct router_result *res);
 struct router_result router_try_reuse(
 	struct router_result route, struct bundle *bundle);
 
@@ -104,10 +179,36 @@ enum router_result_status {
 	ROUTER_RESULT_EXPIRED,
 };
 
+/**
+ * @brief Sort and validate the node contained in the given command. Does not
+ *	access the routing table, i.e., can be called without holding its lock.
+ * @return UD3TN_OK if valid, otherwise the command has been freed.
+ */
+enum ud3tn_result router_prepare_command(struct router_command *command);
+/**
+ * @brief Apply a command prepared via router_prepare_command() to the
+ *	routing table. Frees the command.
+ */
 enum ud3tn_result router_process_command(
 	struct router_command *command,
 	struct rescheduling_handle rescheduler);
+/**
+ * @brief Route the given bundle, i.e., schedule it (or its fragments) for
+ *	one or more contacts.
+ * @param preempted Set to the list of bundles that have been removed from
+ *	their contacts in favor of the given bundle. These bundles as well as
+ *	the list entries have to be handled by the caller.
+ */
 enum router_result_status router_route_bundle(
-	struct bundle *b);
+	struct bundle *b, struct routed_bundle_list **preempted);
+/**
+ * @brief Same as router_route_bundle(), taking the routing table lock itself.
+ *	For small bundles, the destination is looked up in the current
+ *	routing table snapshot before, such that the lock is only held for
+ *	choosing one of its contacts and queuing the bundle.
+ */
+enum router_result_status router_route_bundle_locking(
+	struct bundle *b, Semaphore_t lock,
+	struct routed_bundle_list **preempted);
 
 #endif /* ROUTER_H_INCLUDED */
@@ -10,7 +10,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
-// Number of slots in the node hash table.
+// Initial number of slots in the node hash table, which grows as needed.
 #ifndef NODE_HTAB_SLOT_COUNT
 #define NODE_HTAB_SLOT_COUNT 128
 #endif // NODE_HTAB_SLOT_COUNT
@@ -29,11 +29,46 @@ struct rescheduling_handle {
 	const void *reschedule_func_context;
 };
 
+struct contact_snapshot {
+	struct contact *contact;
+	uint64_t from_ms;
+	uint64_t to_ms;
+};
+
+/*
+ * Immutable, versioned copy of the contact plan (all contacts ordered by
+ * their start time) and of the contacts per reachable EID. It is
+ * re-published on every modification of the routing table and can be read
+ * without holding the routing table lock. The contact pointers must only be
+ * dereferenced with the lock held and after checking that `version` still
+ * equals routing_table_get_version().
+ */
+struct routing_table_snapshot {
+	uint32_t version;
+	uint32_t contact_count;
+	// Open-addressing table of the interned EIDs reachable via contacts,
+	// see routing_table_snapshot_lookup(). The slot count is a power of
+	// two, unused slots have no EID.
+	uint32_t destination_slot_count;
+	struct destination_snapshot {
+		const char *eid;
+		uint32_t first_contact;
+		uint32_t contact_count;
+	} *destinations;
+	// The contacts of all destinations, each ordered like the contacts
+	// of the corresponding node_table_entry
+	struct contact_snapshot *destination_contacts;
+	struct routing_table_snapshot *next_retired;
+	struct contact_snapshot contacts[];
+};
+
 enum ud3tn_result routing_table_init(void);
 void routing_table_free(void);
 
 struct node *routing_table_lookup_node(const char *eid);
 struct node_table_entry *routing_table_lookup_eid(const char *eid);
+// Same as routing_table_lookup_eid(), using the hash of the interned EID.
+struct node_table_entry *routing_table_lookup_interned_eid(const char *eid);
 uint8_t routing_table_lookup_eid_in_nbf(
 	char *eid, struct node **target, uint8_t max);
 uint8_t routing_table_lookup_hot_node(
@@ -54,4 +89,36 @@ void routing_table_delete_contact(struct contact *contact);
 void routing_table_contact_passed(
 	struct contact *contact, struct rescheduling_handle rescheduler);
 
+/**
+ * @brief Obtain the current contact plan snapshot without locking.
+ *
+ * Every call has to be paired with routing_table_snapshot_release(); the
+ * snapshot stays valid in between, even if the routing table changes.
+ */
+const struct routing_table_snapshot *routing_table_snapshot_acquire(void);
+void routing_table_snapshot_release(
+	const struct routing_table_snapshot *snapshot);
+
+/**
+ * @brief Look up the contacts over which the given interned EID is reachable
+ *	in the snapshot, in the order of routing_table_lookup_interned_eid().
+ * @return The number of contacts, the first of which is stored in *contacts.
+ */
+uint32_t routing_table_snapshot_lookup(
+	const struct routing_table_snapshot *snapshot, const char *eid,
+	const struct contact_snapshot **contacts);
+
+/**
+ * @brief Publish a new snapshot after contact times have been modified
+ *	directly, i.e., not via the routing_table_* functions.
+ * @note Has to be called with the routing table lock held.
+ */
+void routing_table_publish_snapshot(void);
+
+/**
+ * @brief Get the version of the routing table, incremented on every change.
+ * @note Has to be called with the routing table lock held.
+ */
+uint32_t routing_table_get_version(void);
+
 #endif /* ROUTINGTABLE_H_INCLUDED */
@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef SHARED_BUFFER_H_INCLUDED
+#define SHARED_BUFFER_H_INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * A reference-counted, immutable byte buffer. Multiple bundle blocks (e.g.,
+ * the payload blocks of all fragments created from one bundle) may reference
+ * slices of the same buffer instead of owning a copy of the data.
+ */
+struct shared_buffer {
+	// NOTE: Modified atomically, the holders may live in different threads.
+	uint32_t ref_count;
+	size_t length;
+	uint8_t *data;
+};
+
+/**
+ * @brief Take over the given malloc'd data, the reference count is one.
+ * @return The buffer or NULL if no memory is left (the data is not freed).
+ */
+struct shared_buffer *shared_buffer_wrap(uint8_t *data, size_t length);
+
+/**
+ * @brief Allocate a buffer for the given number of bytes, which are stored in
+ *	the same allocation as the buffer itself. The reference count is one.
+ * @return The buffer or NULL if no memory is left.
+ */
+struct shared_buffer *shared_buffer_create(size_t length);
+
+/**
+ * @brief Obtain another reference to the buffer.
+ */
+struct shared_buffer *shared_buffer_ref(struct shared_buffer *buffer);
+
+/**
+ * @brief Drop a reference, the data is freed with the last reference.
+ */
+void shared_buffer_unref(struct shared_buffer *buffer);
+
+/**
+ * @brief Check whether the caller holds the only reference to the buffer.
+ */
+bool shared_buffer_is_exclusive(struct shared_buffer *buffer);
+
+/**
+ * @brief Drop a reference and obtain the given slice of the buffer as data
+ *	owned by the caller. If the caller held the only reference and the slice
+ *	covers the whole buffer, the data is taken over, otherwise it is copied.
+ * @return The malloc'd data or NULL if no memory is left.
+ */
+uint8_t *shared_buffer_take_slice(struct shared_buffer *buffer,
+				  const uint8_t *data, size_t length);
+
+#endif /* SHARED_BUFFER_H_INCLUDED */
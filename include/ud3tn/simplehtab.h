@@ -5,6 +5,11 @@
 #include <stdint.h>
 #include <stddef.h>
 
+/*
+ * Chained hash table with a fixed number of slots. Superseded by hashtable.h,
+ * it is kept as a baseline for the hashtable benchmark.
+ */
+
 struct htab_entrylist {
 	char *key;
 	void *value;
@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef SIPHASH_H_INCLUDED
+#define SIPHASH_H_INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * SipHash-1-3 keyed with a random per-process key, which is obtained via
+ * hal_platform_get_random_bytes() on first use. Hashes are therefore hard to
+ * predict for peers, but only comparable within a single run of uD3TN.
+ */
+
+struct siphash_state {
+	uint64_t v0, v1, v2, v3;
+	// Input bytes not yet processed, in little-endian order
+	uint64_t tail;
+	size_t length;
+};
+
+/**
+ * @brief Start an incremental hash computation.
+ * @param wide Whether a 128-bit result will be requested using
+ *	siphash_final128() instead of siphash_final().
+ */
+void siphash_init(struct siphash_state *state, bool wide);
+
+/**
+ * @brief Append the given data to the hashed input.
+ */
+void siphash_update(struct siphash_state *state, const void *data,
+		    size_t length);
+
+/**
+ * @brief Obtain the 64-bit hash of the input, has to be initialized with
+ *	wide set to false.
+ */
+uint64_t siphash_final(struct siphash_state *state);
+
+/**
+ * @brief Obtain the 128-bit hash of the input, has to be initialized with
+ *	wide set to true.
+ */
+void siphash_final128(struct siphash_state *state, uint64_t result[2]);
+
+/**
+ * @brief Obtain the 64-bit hash of the given data.
+ */
+uint64_t siphash(const void *data, size_t length);
+
+#endif // SIPHASH_H_INCLUDED
@@ -51,6 +51,8 @@ $(eval $(call addComponentWithRules,generated/aap2))
 $(eval $(call generateComponentRules,components/daemon))
 $(eval $(call generateComponentRules,test/unit))
 $(eval $(call generateComponentRules,test/decoder))
+$(eval $(call generateComponentRules,test/benchmark))
+$(eval $(call generateComponentRules,test/fuzz))
 
 build/$(PLATFORM)/libud3tn.so: LIBS = $(LIBS_libud3tn.so)
 build/$(PLATFORM)/libud3tn.so: $(LIBS_libud3tn.so) | build/$(PLATFORM)
@@ -100,6 +102,35 @@ build/$(PLATFORM)/ud3tndecode: LIBS = $(LIBS_ud3tndecode) build/$(PLATFORM)/libu
 build/$(PLATFORM)/ud3tndecode: $(LIBS_ud3tndecode) | build/$(PLATFORM)
 	$(call cmd,link)
 
+# BENCHMARK EXECUTABLE
+
+$(eval $(call addComponent,ud3tnbench,test/benchmark))
+$(eval $(call addComponent,ud3tnbench,test/fuzz))
+
+build/$(PLATFORM)/ud3tnbench: build/$(PLATFORM)/libud3tn.a
+build/$(PLATFORM)/ud3tnbench: LDFLAGS += $(LDFLAGS_EXECUTABLE)
+build/$(PLATFORM)/ud3tnbench: EXTERNAL_INCLUDES += -Itest/fuzz
+ifneq ($(EXPECT_MACOS_LINKER),1)
+# Count all heap allocations, see benchmark_allocations().
+build/$(PLATFORM)/ud3tnbench: CPPFLAGS += -DBENCHMARK_COUNT_ALLOCATIONS
+build/$(PLATFORM)/ud3tnbench: LDFLAGS += -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc
+endif
+build/$(PLATFORM)/ud3tnbench: LIBS = $(LIBS_ud3tnbench) build/$(PLATFORM)/libud3tn.a
+build/$(PLATFORM)/ud3tnbench: $(LIBS_ud3tnbench) | build/$(PLATFORM)
+	$(call cmd,link)
+
+# FUZZER EXECUTABLE
+
+$(eval $(call addComponent,ud3tnfuzz,test/fuzz))
+
+build/$(PLATFORM)/ud3tnfuzz: build/$(PLATFORM)/libud3tn.a
+build/$(PLATFORM)/ud3tnfuzz: LDFLAGS += $(LDFLAGS_EXECUTABLE) -fsanitize=fuzzer
+# libFuzzer provides main(), take the entry points from the component archive.
+build/$(PLATFORM)/ud3tnfuzz: LDFLAGS_PRE += -Wl,-u,LLVMFuzzerTestOneInput,-u,LLVMFuzzerInitialize
+build/$(PLATFORM)/ud3tnfuzz: LIBS = $(LIBS_ud3tnfuzz) build/$(PLATFORM)/libud3tn.a
+build/$(PLATFORM)/ud3tnfuzz: $(LIBS_ud3tnfuzz) | build/$(PLATFORM)
+	$(call cmd,link)
+
 # GENERAL RULES
 
 build/$(PLATFORM): | build
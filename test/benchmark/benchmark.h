@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef BENCHMARK_H_INCLUDED
+#define BENCHMARK_H_INCLUDED
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct benchmark {
+	const char *name;
+	const char *description;
+	// Receives the arguments following the benchmark name.
+	int (*run)(int argc, char *argv[]);
+};
+
+/**
+ * @brief Get a monotonic timestamp in nanoseconds.
+ */
+uint64_t benchmark_time_ns(void);
+
+/**
+ * @brief Print a single result line: "<benchmark>.<metric>: <value> <unit>",
+ *	or a JSON object per line if UD3TNBENCH_FORMAT=json is set.
+ */
+void benchmark_report(const char *benchmark, const char *metric,
+		      double value, const char *unit);
+
+/**
+ * @brief Parse the optional numeric argument at the given index, or return
+ *	the default value if it has not been provided.
+ */
+uint64_t benchmark_arg_u64(int argc, char *argv[], int index,
+			   uint64_t default_value);
+
+/**
+ * @brief Get the number of heap allocations performed so far by all code of
+ *	the binary, if it has been linked to count them.
+ */
+bool benchmark_allocations(uint64_t *count);
+
+int benchmark_bibe_tunnel(int argc, char *argv[]);
+int benchmark_bp_workers(int argc, char *argv[]);
+int benchmark_bundle7_parser(int argc, char *argv[]);
+int benchmark_bundle7_profile(int argc, char *argv[]);
+int benchmark_bundle_blocks(int argc, char *argv[]);
+int benchmark_eid_intern(int argc, char *argv[]);
+int benchmark_fragmentation(int argc, char *argv[]);
+int benchmark_hashtable(int argc, char *argv[]);
+int benchmark_mtcp_loopback(int argc, char *argv[]);
+int benchmark_object_pool(int argc, char *argv[]);
+int benchmark_parsers(int argc, char *argv[]);
+int benchmark_sdnv(int argc, char *argv[]);
+int benchmark_status_report(int argc, char *argv[]);
+
+#endif /* BENCHMARK_H_INCLUDED */
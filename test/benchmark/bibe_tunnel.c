@@ -0,0 +1,303 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "benchmark.h"
+
+#include "aap/aap.h"
+#include "aap/aap_serializer.h"
+
+#include "bundle7/create.h"
+#include "bundle7/parser.h"
+
+#include "cla/bibe_proto.h"
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/common.h"
+#include "ud3tn/parser.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCHMARK_NAME "bibe_tunnel"
+
+#define DEFAULT_BUNDLES 10000
+#define DEFAULT_PAYLOAD_LENGTH 65536
+
+#define DEST_EID "dtn://tunnel-end.dtn/bibe"
+
+struct memory_sink {
+	uint8_t *data;
+	size_t length;
+	size_t capacity;
+};
+
+static void write_to_memory(void *obj, const void *data, const size_t length)
+{
+	struct memory_sink *const sink = obj;
+
+	if (sink->data && sink->length + length <= sink->capacity)
+		memcpy(sink->data + sink->length, data, length);
+	sink->length += length;
+}
+
+static void receive_bundle(struct bundle *bundle, void *param)
+{
+	struct bundle **const result = param;
+
+	*result = bundle;
+}
+
+// Encapsulate the bundle as done before, i.e. as the payload of an AAP
+// message encoded into a buffer, which is returned.
+static uint8_t *encapsulate_copy(struct bundle *bundle, size_t *length)
+{
+	const size_t size = bundle_get_serialized_size(bundle);
+	const size_t hdr_len = bibe_get_header_length(DEST_EID, size);
+	struct memory_sink sink = {
+		.data = malloc(hdr_len + size),
+		.length = hdr_len,
+		.capacity = hdr_len + size,
+	};
+
+	if (!sink.data)
+		return NULL;
+	bibe_encode_header_into(sink.data, DEST_EID, size);
+	if (bundle_serialize(bundle, write_to_memory, &sink) != UD3TN_OK ||
+	    sink.length != sink.capacity) {
+		free(sink.data);
+		return NULL;
+	}
+	*length = sink.length;
+	return sink.data;
+}
+
+// Encapsulate the bundle like the BIBE CLA does, i.e. into iovecs referencing
+// the block data, preceded by the header.
+static bool encapsulate_iov(struct bundle *bundle, struct bundle_iov *iov,
+			    uint8_t *header, size_t *length)
+{
+	if (bundle_serialize_iov(bundle, iov) != UD3TN_OK)
+		return false;
+	iov->iov[-1] = (struct iovec) {
+		.iov_base = header,
+		.iov_len = bibe_encode_header_into(header, DEST_EID,
+						   iov->length),
+	};
+	*length = iov->iov[-1].iov_len + iov->length;
+	return true;
+}
+
+// Decapsulate the bundle from the BPDU received via AAP, optionally copying
+// it out of the BPDU first, as done before.
+static bool decapsulate(struct bundle7_parser *parser, struct bundle **bundle,
+			const uint8_t *bpdu_data, const size_t bpdu_length,
+			const bool copy)
+{
+	struct parser *const p = parser->basedata;
+	struct bibe_protocol_data_unit bpdu;
+	const uint8_t *data;
+
+	if (bibe_parser_parse(bpdu_data, bpdu_length, &bpdu) != 0)
+		return false;
+
+	uint8_t *const copied = copy ? malloc(bpdu.payload_length) : NULL;
+
+	if (copy && !copied)
+		return false;
+	if (copy)
+		memcpy(copied, bpdu.encapsulated_bundle, bpdu.payload_length);
+	data = copy ? copied : bpdu.encapsulated_bundle;
+
+	// Perform the bulk reads like the CLA RX task does.
+	size_t pos = 0;
+
+	*bundle = NULL;
+	bundle7_parser_reset(parser);
+	while (pos < bpdu.payload_length && p->status == PARSER_STATUS_GOOD) {
+		if (p->flags & PARSER_FLAG_BULK_READ) {
+			if (p->next_bytes > bpdu.payload_length - pos)
+				break;
+			memcpy(p->next_buffer, data + pos, p->next_bytes);
+			pos += p->next_bytes;
+			p->flags &= ~PARSER_FLAG_BULK_READ;
+			bundle7_parser_read(parser, NULL, 0);
+			continue;
+		}
+		pos += bundle7_parser_read(parser, data + pos,
+					   bpdu.payload_length - pos);
+	}
+
+	free(copied);
+	return p->status == PARSER_STATUS_DONE && *bundle != NULL;
+}
+
+static void report(const char *const mode, const uint64_t ns,
+		   const uint64_t allocations, const bool counted,
+		   const uint64_t bundles, const double bytes)
+{
+	char metric[64];
+
+	snprintf(metric, sizeof(metric), "%s_per_bundle", mode);
+	benchmark_report(BENCHMARK_NAME, metric, (double)ns / bundles, "ns");
+	// Bytes per nanosecond equal gigabytes per second.
+	snprintf(metric, sizeof(metric), "%s_throughput", mode);
+	benchmark_report(BENCHMARK_NAME, metric, ns ? bytes / ns : 0, "GB/s");
+	if (counted) {
+		snprintf(metric, sizeof(metric), "%s_allocations_per_bundle",
+			 mode);
+		benchmark_report(BENCHMARK_NAME, metric,
+				 (double)allocations / bundles, "");
+	}
+}
+
+static uint64_t run_encapsulation(struct bundle *bundle,
+				  const uint64_t bundles)
+{
+	uint8_t header[128];
+	struct bundle_iov iov;
+	uint64_t failed = 0, alloc_start, alloc_end;
+	uint64_t ns, start_ns;
+	size_t length = 0;
+	bool counted;
+
+	bundle_iov_init(&iov);
+
+	counted = benchmark_allocations(&alloc_start);
+	start_ns = benchmark_time_ns();
+	for (uint64_t i = 0; i < bundles; i++) {
+		uint8_t *const data = encapsulate_copy(bundle, &length);
+
+		if (!data)
+			failed++;
+		free(data);
+	}
+	ns = benchmark_time_ns() - start_ns;
+	benchmark_allocations(&alloc_end);
+	report("encapsulate_copy", ns, alloc_end - alloc_start, counted,
+	       bundles, (double)bundles * length);
+
+	counted = benchmark_allocations(&alloc_start);
+	start_ns = benchmark_time_ns();
+	for (uint64_t i = 0; i < bundles; i++) {
+		if (!encapsulate_iov(bundle, &iov, header, &length))
+			failed++;
+	}
+	ns = benchmark_time_ns() - start_ns;
+	benchmark_allocations(&alloc_end);
+	report("encapsulate_iov", ns, alloc_end - alloc_start, counted,
+	       bundles, (double)bundles * length);
+
+	// Both variants have to produce the same data.
+	uint8_t *const expected = encapsulate_copy(bundle, &length);
+	size_t pos = 0;
+
+	if (!expected || !encapsulate_iov(bundle, &iov, header, &length)) {
+		failed++;
+	} else {
+		// Including the header in front of the iovecs
+		const struct iovec *const entries = iov.iov - 1;
+
+		for (size_t i = 0; i < iov.iov_count + 1; i++) {
+			if (pos + entries[i].iov_len > length ||
+			    memcmp(expected + pos, entries[i].iov_base,
+				   entries[i].iov_len) != 0)
+				failed++;
+			pos += entries[i].iov_len;
+		}
+		if (pos != length)
+			failed++;
+	}
+	free(expected);
+
+	bundle_iov_free(&iov);
+	return failed;
+}
+
+static uint64_t run_decapsulation(const char *const mode,
+				  const uint8_t *bpdu, const size_t length,
+				  const uint64_t bundles, const bool copy)
+{
+	struct bundle7_parser parser;
+	struct bundle *bundle = NULL;
+	uint64_t failed = 0, alloc_start, alloc_end;
+
+	if (!bundle7_parser_init(&parser, receive_bundle, &bundle))
+		return 1;
+
+	const bool counted = benchmark_allocations(&alloc_start);
+	const uint64_t start_ns = benchmark_time_ns();
+
+	for (uint64_t i = 0; i < bundles; i++) {
+		if (!decapsulate(&parser, &bundle, bpdu, length, copy))
+			failed++;
+		bundle_free(bundle);
+	}
+
+	const uint64_t ns = benchmark_time_ns() - start_ns;
+
+	benchmark_allocations(&alloc_end);
+	report(mode, ns, alloc_end - alloc_start, counted, bundles,
+	       (double)bundles * length);
+
+	bundle7_parser_deinit(&parser);
+	return failed;
+}
+
+int benchmark_bibe_tunnel(int argc, char *argv[])
+{
+	const uint64_t bundles = benchmark_arg_u64(
+		argc, argv, 0, DEFAULT_BUNDLES
+	);
+	const uint64_t payload_length = benchmark_arg_u64(
+		argc, argv, 1, DEFAULT_PAYLOAD_LENGTH
+	);
+	struct bundle *bundle = NULL;
+	uint8_t *message = NULL;
+	size_t length;
+	uint64_t failed = 0;
+
+	if (bundles == 0 || payload_length > UINT32_MAX / 2) {
+		fprintf(stderr, "Invalid arguments.\n");
+		return 1;
+	}
+
+	bundle = bundle7_create_local(
+		calloc(1, payload_length), payload_length,
+		"dtn://tunnel-start.dtn/source", "dtn://sink.dtn/sink",
+		1000, 1, 3600000, BUNDLE_FLAG_NONE
+	);
+	if (bundle)
+		message = encapsulate_copy(bundle, &length);
+	if (!message) {
+		fprintf(stderr, "Could not create bundle.\n");
+		bundle_free(bundle);
+		return 1;
+	}
+
+	failed += run_encapsulation(bundle, bundles);
+
+	// The BPDU, as received via AAP, follows the header of the message.
+	const struct aap_message aap_header = {
+		.type = AAP_MESSAGE_SENDBIBE,
+		.eid_length = strlen(DEST_EID),
+		// Discard const, the AAP functions do not modify the EID.
+		.eid = (char *)DEST_EID,
+		.payload_length = 0,
+	};
+	const size_t bpdu_offset = aap_get_serialized_size(&aap_header);
+
+	failed += run_decapsulation("decapsulate_copy",
+				    message + bpdu_offset,
+				    length - bpdu_offset, bundles, true);
+	failed += run_decapsulation("decapsulate_in_place",
+				    message + bpdu_offset,
+				    length - bpdu_offset, bundles, false);
+
+	free(message);
+	bundle_free(bundle);
+
+	benchmark_report(BENCHMARK_NAME, "failed", failed, "");
+	return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,362 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "benchmark.h"
+
+#include "bundle7/create.h"
+#include "bundle7/parser.h"
+#include "bundle7/serializer.h"
+
+#include "platform/hal_queue.h"
+
+#include "ud3tn/agent_manager.h"
+#include "ud3tn/bundle.h"
+#include "ud3tn/bundle_processor.h"
+#include "ud3tn/parser.h"
+
+#ifdef ARCHIPEL_CORE
+#include "archipel-core/bundle_restore.h"
+#define RESTORE_SIGNAL_SIZE sizeof(struct bundle_restore_signal)
+#else // ARCHIPEL_CORE
+#define RESTORE_SIGNAL_SIZE sizeof(void *)
+#endif // ARCHIPEL_CORE
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCHMARK_NAME "bp_workers"
+
+#define DEFAULT_BUNDLES 100000
+#define DEFAULT_PAYLOAD_LENGTH 1024
+#define DEFAULT_MAX_WORKERS 8
+
+#define LOCAL_EID "ipn:1.0"
+// Number of source nodes and of local agents the bundles are addressed to
+#define NODE_COUNT 64
+#define AGENT_COUNT 4
+#define QUEUE_LENGTH 1024
+// Pushed to the queue of a worker to stop it.
+#define STOP_INDEX UINT64_MAX
+
+struct wire_bundle {
+	uint8_t *data;
+	size_t length;
+	size_t capacity;
+	char sink_identifier[8];
+};
+
+struct worker {
+	pthread_t thread;
+	QueueIdentifier_t queue;
+	const struct wire_bundle *wire;
+	struct bundle7_parser parser;
+	struct bundle *bundle;
+	uint64_t failed;
+};
+
+static uint64_t delivered;
+
+static void write_to_memory(void *obj, const void *data, const size_t length)
+{
+	struct wire_bundle *const wire = obj;
+
+	if (wire->data && wire->length + length <= wire->capacity)
+		memcpy(wire->data + wire->length, data, length);
+	wire->length += length;
+}
+
+static void receive_bundle(struct bundle *bundle, void *param)
+{
+	struct worker *const w = param;
+
+	w->bundle = bundle;
+}
+
+static void agent_callback(struct bundle_adu data, void *param,
+			   const void *bp_context)
+{
+	(void)param;
+	(void)bp_context;
+	__atomic_add_fetch(&delivered, 1, __ATOMIC_RELAXED);
+	bundle_adu_free_members(data);
+}
+
+// Parse the bundle as received by a CLA, performing the bulk reads
+// requested by the parser.
+static bool parse(struct worker *const w, const struct wire_bundle *wire)
+{
+	struct parser *const p = w->parser.basedata;
+	size_t pos = 0;
+
+	w->bundle = NULL;
+	bundle7_parser_reset(&w->parser);
+	while (pos < wire->length && p->status == PARSER_STATUS_GOOD) {
+		if (p->flags & PARSER_FLAG_BULK_READ) {
+			if (p->next_bytes > wire->length - pos)
+				return false;
+			memcpy(p->next_buffer, wire->data + pos, p->next_bytes);
+			pos += p->next_bytes;
+			p->flags &= ~PARSER_FLAG_BULK_READ;
+			bundle7_parser_read(&w->parser, NULL, 0);
+			continue;
+		}
+		pos += bundle7_parser_read(&w->parser, wire->data + pos,
+					   wire->length - pos);
+	}
+
+	return p->status == PARSER_STATUS_DONE && w->bundle != NULL;
+}
+
+// Receives bundles like a BP worker: parse, hand the ADU to the agent.
+static void *run_worker(void *param)
+{
+	struct worker *const w = param;
+	uint64_t index;
+
+	for (;;) {
+		if (hal_queue_receive(w->queue, &index, -1) != UD3TN_OK)
+			continue;
+		if (index == STOP_INDEX)
+			break;
+
+		const struct wire_bundle *const wire = &w->wire[index];
+
+		if (!parse(w, wire)) {
+			bundle_free(w->bundle);
+			w->failed++;
+			continue;
+		}
+
+		struct bundle_adu adu = bundle_to_adu(w->bundle);
+
+		bundle_free(w->bundle);
+		if (agent_forward(wire->sink_identifier, adu, NULL) != 0)
+			w->failed++;
+	}
+	return NULL;
+}
+
+// Distribute the bundles to the given number of workers like the BP task,
+// measuring the time until all of them have been delivered.
+static uint64_t run(const struct wire_bundle *wire,
+		    const uint8_t *const shards, const uint64_t bundles,
+		    const uint8_t worker_count, uint64_t *const duration_ns)
+{
+	struct worker workers[BUNDLE_PROCESSOR_MAX_WORKERS];
+	const uint64_t stop = STOP_INDEX;
+	uint64_t failed = 0;
+	uint8_t started = 0;
+
+	delivered = 0;
+	for (; started < worker_count; started++) {
+		struct worker *const w = &workers[started];
+
+		w->wire = wire;
+		w->failed = 0;
+		w->queue = hal_queue_create(QUEUE_LENGTH, sizeof(uint64_t));
+		if (!w->queue)
+			break;
+		if (!bundle7_parser_init(&w->parser, receive_bundle, w)) {
+			hal_queue_delete(w->queue);
+			break;
+		}
+		if (pthread_create(&w->thread, NULL, run_worker, w) != 0) {
+			bundle7_parser_deinit(&w->parser);
+			hal_queue_delete(w->queue);
+			break;
+		}
+	}
+	if (started != worker_count)
+		failed++;
+
+	const uint64_t start_ns = benchmark_time_ns();
+
+	for (uint64_t i = 0; started == worker_count && i < bundles; i++) {
+		const uint64_t index = i % NODE_COUNT;
+
+		hal_queue_push_to_back(workers[shards[index]].queue, &index);
+	}
+	for (uint8_t i = 0; i < started; i++)
+		hal_queue_push_to_back(workers[i].queue, &stop);
+	for (uint8_t i = 0; i < started; i++)
+		pthread_join(workers[i].thread, NULL);
+
+	*duration_ns = benchmark_time_ns() - start_ns;
+
+	for (uint8_t i = 0; i < started; i++) {
+		failed += workers[i].failed;
+		bundle7_parser_deinit(&workers[i].parser);
+		hal_queue_delete(workers[i].queue);
+	}
+	if (started == worker_count && delivered != bundles)
+		failed++;
+	return failed;
+}
+
+static enum ud3tn_result create_wire_bundles(
+	struct wire_bundle *const wire, const uint64_t payload_length)
+{
+	char source[32], destination[32];
+
+	for (unsigned int i = 0; i < NODE_COUNT; i++) {
+		const unsigned int service = 1 + i % AGENT_COUNT;
+
+		snprintf(source, sizeof(source), "ipn:%u.1", i + 2);
+		snprintf(destination, sizeof(destination), "ipn:1.%u",
+			 service);
+		snprintf(wire[i].sink_identifier,
+			 sizeof(wire[i].sink_identifier), "%u", service);
+
+		struct bundle *const bundle = bundle7_create_local(
+			calloc(1, payload_length), payload_length,
+			source, destination, 1000, i, 3600000,
+			BUNDLE_FLAG_NONE
+		);
+
+		if (!bundle)
+			return UD3TN_FAIL;
+		// Let the bundle carry the CRCs the parser has to verify.
+		bundle->crc_type = BUNDLE_CRC_TYPE_32;
+		bundle->payload_block->crc_type = BUNDLE_CRC_TYPE_32;
+		bundle_recalculate_header_length(bundle);
+		wire[i].capacity = bundle_get_serialized_size(bundle);
+		wire[i].length = 0;
+		wire[i].data = malloc(wire[i].capacity);
+
+		const enum ud3tn_result result = (
+			wire[i].data
+			? bundle7_serialize(bundle, write_to_memory, &wire[i])
+			: UD3TN_FAIL
+		);
+
+		bundle_free(bundle);
+		if (result != UD3TN_OK || wire[i].length != wire[i].capacity)
+			return UD3TN_FAIL;
+	}
+	return UD3TN_OK;
+}
+
+// Assign the bundles of every source node to a worker like the BP task.
+static enum ud3tn_result get_shards(const struct wire_bundle *wire,
+				    uint8_t *const shards,
+				    const uint8_t worker_count)
+{
+	struct worker w;
+	enum ud3tn_result result = UD3TN_OK;
+
+	if (!bundle7_parser_init(&w.parser, receive_bundle, &w))
+		return UD3TN_FAIL;
+	for (unsigned int i = 0; result == UD3TN_OK && i < NODE_COUNT; i++) {
+		if (!parse(&w, &wire[i])) {
+			result = UD3TN_FAIL;
+		} else {
+			shards[i] = bundle_processor_get_worker_index(
+				w.bundle,
+				true,
+				worker_count
+			);
+		}
+		bundle_free(w.bundle);
+	}
+	bundle7_parser_deinit(&w.parser);
+	return result;
+}
+
+static enum ud3tn_result register_agents(QueueIdentifier_t restore_queue)
+{
+	static char sink_identifiers[AGENT_COUNT][8];
+
+	agent_manager_init(LOCAL_EID, restore_queue);
+	for (unsigned int i = 0; i < AGENT_COUNT; i++) {
+		snprintf(sink_identifiers[i], sizeof(sink_identifiers[i]),
+			 "%u", i + 1);
+		if (agent_register((struct agent){
+			.sink_identifier = sink_identifiers[i],
+			.callback = agent_callback,
+		}, true) != 0)
+			return UD3TN_FAIL;
+	}
+
+#ifdef ARCHIPEL_CORE
+	struct bundle_restore_signal signal;
+
+	// Registering an agent requests to restore stored bundles for it.
+	while (hal_queue_receive(restore_queue, &signal, 0) == UD3TN_OK)
+		free(signal.destination);
+#endif // ARCHIPEL_CORE
+	return UD3TN_OK;
+}
+
+int benchmark_bp_workers(int argc, char *argv[])
+{
+	const uint64_t bundles = benchmark_arg_u64(
+		argc, argv, 0, DEFAULT_BUNDLES
+	);
+	const uint64_t payload_length = benchmark_arg_u64(
+		argc, argv, 1, DEFAULT_PAYLOAD_LENGTH
+	);
+	const uint64_t max_workers = benchmark_arg_u64(
+		argc, argv, 2, DEFAULT_MAX_WORKERS
+	);
+	struct wire_bundle wire[NODE_COUNT] = { { .data = NULL } };
+	uint8_t shards[NODE_COUNT];
+	QueueIdentifier_t restore_queue = NULL;
+	uint64_t failed = 0, single_ns = 0;
+	int rc = 1;
+
+	if (bundles == 0 || payload_length > UINT32_MAX / 2 ||
+	    max_workers == 0 || max_workers > BUNDLE_PROCESSOR_MAX_WORKERS) {
+		fprintf(stderr, "Invalid arguments.\n");
+		return 1;
+	}
+
+	restore_queue = hal_queue_create(AGENT_COUNT, RESTORE_SIGNAL_SIZE);
+	if (!restore_queue || register_agents(restore_queue) != UD3TN_OK) {
+		fprintf(stderr, "Could not register agents.\n");
+		goto out;
+	}
+	if (create_wire_bundles(wire, payload_length) != UD3TN_OK) {
+		fprintf(stderr, "Could not create bundles.\n");
+		goto out;
+	}
+
+	benchmark_report(BENCHMARK_NAME, "serialized_size", wire[0].length,
+			 "B");
+
+	// 1, 2, 4, ... workers, up to the given maximum
+	for (uint64_t workers = 1; workers <= max_workers; workers *= 2) {
+		char metric[64];
+		uint64_t ns;
+
+		if (get_shards(wire, shards, (uint8_t)workers) != UD3TN_OK) {
+			failed++;
+			break;
+		}
+		failed += run(wire, shards, bundles, (uint8_t)workers, &ns);
+		if (workers == 1)
+			single_ns = ns;
+
+		snprintf(metric, sizeof(metric),
+			 "workers_%u_bundles_per_second",
+			 (unsigned int)workers);
+		benchmark_report(BENCHMARK_NAME, metric,
+				 ns ? (double)bundles * 1e9 / ns : 0, "1/s");
+		snprintf(metric, sizeof(metric), "workers_%u_speedup",
+			 (unsigned int)workers);
+		benchmark_report(BENCHMARK_NAME, metric,
+				 ns ? (double)single_ns / ns : 0, "");
+	}
+
+	benchmark_report(BENCHMARK_NAME, "failed", failed, "");
+	rc = failed == 0 ? 0 : 1;
+
+out:
+	for (unsigned int i = 0; i < NODE_COUNT; i++)
+		free(wire[i].data);
+	if (restore_queue)
+		hal_queue_delete(restore_queue);
+	return rc;
+}
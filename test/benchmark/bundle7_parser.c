@@ -0,0 +1,183 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "benchmark.h"
+
+#include "bundle7/bundle7.h"
+#include "bundle7/create.h"
+#include "bundle7/parser.h"
+#include "bundle7/serializer.h"
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/common.h"
+#include "ud3tn/parser.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCHMARK_NAME "bundle7_parser"
+
+#define DEFAULT_BUNDLES 100000
+#define DEFAULT_PAYLOAD_LENGTH 1024
+#define DEFAULT_CHUNK_LENGTH 64
+
+struct memory_sink {
+	uint8_t *data;
+	size_t length;
+	size_t capacity;
+};
+
+static void write_to_memory(void *obj, const void *data, const size_t length)
+{
+	struct memory_sink *const sink = obj;
+
+	if (sink->data && sink->length + length <= sink->capacity)
+		memcpy(sink->data + sink->length, data, length);
+	sink->length += length;
+}
+
+static void receive_bundle(struct bundle *bundle, void *param)
+{
+	struct bundle **const result = param;
+
+	*result = bundle;
+}
+
+// Pass the serialized bundle to the parser in chunks of the given size,
+// performing the bulk reads like the CLA RX task does.
+static bool parse(struct bundle7_parser *parser, struct bundle **bundle,
+		  const struct memory_sink *wire, const size_t chunk_length)
+{
+	struct parser *const p = parser->basedata;
+	size_t pos = 0;
+
+	*bundle = NULL;
+	bundle7_parser_reset(parser);
+	while (pos < wire->length && p->status == PARSER_STATUS_GOOD) {
+		if (p->flags & PARSER_FLAG_BULK_READ) {
+			if (p->next_bytes > wire->length - pos)
+				return false;
+			memcpy(p->next_buffer, wire->data + pos, p->next_bytes);
+			pos += p->next_bytes;
+			p->flags &= ~PARSER_FLAG_BULK_READ;
+			bundle7_parser_read(parser, NULL, 0);
+			continue;
+		}
+
+		const size_t length = MIN(chunk_length, wire->length - pos);
+
+		pos += bundle7_parser_read(parser, wire->data + pos, length);
+	}
+
+	return p->status == PARSER_STATUS_DONE && *bundle != NULL;
+}
+
+// Parse the bundle the given number of times, optionally verifying the CRCs
+// deferred by the parser afterwards, and report the results.
+static uint64_t run(const char *const mode, struct bundle7_parser *parser,
+		    struct bundle **bundle, const struct memory_sink *wire,
+		    const size_t chunk_length, const uint64_t bundles,
+		    const bool verify)
+{
+	char metric[64];
+	uint64_t ns = 0, failed = 0;
+
+	for (uint64_t i = 0; i < bundles; i++) {
+		const uint64_t start_ns = benchmark_time_ns();
+
+		if (!parse(parser, bundle, wire, chunk_length) ||
+		    (verify && bundle7_verify_crc(*bundle) != UD3TN_OK))
+			failed++;
+		ns += benchmark_time_ns() - start_ns;
+		bundle_free(*bundle);
+	}
+
+	const double bytes = (double)bundles * wire->length;
+
+	snprintf(metric, sizeof(metric), "%s_bundles_per_second", mode);
+	benchmark_report(BENCHMARK_NAME, metric,
+			 ns ? (double)bundles * 1e9 / ns : 0, "1/s");
+	// Bytes per nanosecond equal gigabytes per second.
+	snprintf(metric, sizeof(metric), "%s_throughput", mode);
+	benchmark_report(BENCHMARK_NAME, metric, ns ? bytes / ns : 0, "GB/s");
+	snprintf(metric, sizeof(metric), "%s_cpu_per_gb", mode);
+	benchmark_report(BENCHMARK_NAME, metric, ns / bytes, "s");
+	return failed;
+}
+
+int benchmark_bundle7_parser(int argc, char *argv[])
+{
+	const uint64_t bundles = benchmark_arg_u64(
+		argc, argv, 0, DEFAULT_BUNDLES
+	);
+	const uint64_t payload_length = benchmark_arg_u64(
+		argc, argv, 1, DEFAULT_PAYLOAD_LENGTH
+	);
+	const uint64_t chunk_length = benchmark_arg_u64(
+		argc, argv, 2, DEFAULT_CHUNK_LENGTH
+	);
+	struct memory_sink wire = { .data = NULL };
+	struct bundle7_parser parser;
+	struct bundle *prototype = NULL;
+	struct bundle *bundle = NULL;
+	uint64_t failed = 0;
+	int rc = 1;
+
+	if (bundles == 0 || chunk_length == 0 ||
+	    payload_length > UINT32_MAX / 2) {
+		fprintf(stderr, "Invalid arguments.\n");
+		return 1;
+	}
+
+	prototype = bundle7_create_local(
+		calloc(1, payload_length), payload_length,
+		"dtn://bench/source", "dtn://bench/sink",
+		1000, 1, 3600000, BUNDLE_FLAG_NONE
+	);
+	if (!prototype) {
+		fprintf(stderr, "Could not create bundle.\n");
+		goto out;
+	}
+	// Let the bundle carry the CRCs the parser has to verify.
+	prototype->crc_type = BUNDLE_CRC_TYPE_32;
+	prototype->payload_block->crc_type = BUNDLE_CRC_TYPE_32;
+	bundle_recalculate_header_length(prototype);
+	wire.capacity = bundle_get_serialized_size(prototype);
+	wire.data = malloc(wire.capacity);
+	if (!wire.data ||
+	    bundle7_serialize(prototype, write_to_memory, &wire) != UD3TN_OK ||
+	    wire.length != wire.capacity) {
+		fprintf(stderr, "Could not serialize bundle.\n");
+		goto out;
+	}
+	if (!bundle7_parser_init(&parser, receive_bundle, &bundle)) {
+		fprintf(stderr, "Could not initialize parser.\n");
+		goto out;
+	}
+
+	benchmark_report(BENCHMARK_NAME, "serialized_size", wire.length, "B");
+
+	// CRCs verified while parsing
+	parser.defer_crc = false;
+	failed += run("whole", &parser, &bundle, &wire, wire.length,
+		      bundles, false);
+	failed += run("chunked", &parser, &bundle, &wire, chunk_length,
+		      bundles, false);
+	// Payload CRC verified on demand, or left to the next hop
+	parser.defer_crc = true;
+	failed += run("deferred", &parser, &bundle, &wire, wire.length,
+		      bundles, false);
+	failed += run("verified", &parser, &bundle, &wire, wire.length,
+		      bundles, true);
+	bundle7_parser_deinit(&parser);
+
+	benchmark_report(BENCHMARK_NAME, "failed", failed, "");
+	rc = failed == 0 ? 0 : 1;
+
+out:
+	bundle_free(prototype);
+	free(wire.data);
+	return rc;
+}
@@ -0,0 +1,193 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "benchmark.h"
+
+#include "bundle7/profile.h"
+#include "bundle7/serializer.h"
+
+#include "ud3tn/bundle.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCHMARK_NAME "bundle7_profile"
+
+#define DEFAULT_BUNDLES 100000
+#define DEFAULT_PAYLOAD_LENGTH 64
+
+#define SOURCE_EID "ipn:1.1"
+#define DESTINATION_EID "ipn:2.1"
+#define TIMESTAMP_MS 1700000000000
+#define LIFETIME_MS 86400000
+#define HOP_LIMIT 30
+
+// The serialized bundles, one after another.
+struct output {
+	uint8_t *data;
+	size_t length;
+	size_t capacity;
+};
+
+static void write_to_output(void *obj, const void *data, const size_t length)
+{
+	struct output *const out = obj;
+
+	if (out->length + length <= out->capacity)
+		memcpy(out->data + out->length, data, length);
+	out->length += length;
+}
+
+static void report(const char *const mode, const uint64_t ns,
+		   const uint64_t allocations, const bool counted,
+		   const uint64_t bundles, const size_t bytes)
+{
+	char metric[64];
+
+	snprintf(metric, sizeof(metric), "%s_per_bundle", mode);
+	benchmark_report(BENCHMARK_NAME, metric, (double)ns / bundles, "ns");
+	if (bytes) {
+		// Bytes per nanosecond equal gigabytes per second.
+		snprintf(metric, sizeof(metric), "%s_throughput", mode);
+		benchmark_report(BENCHMARK_NAME, metric,
+				 ns ? (double)bytes / ns : 0, "GB/s");
+	}
+	if (counted) {
+		snprintf(metric, sizeof(metric), "%s_allocations_per_bundle",
+			 mode);
+		benchmark_report(BENCHMARK_NAME, metric,
+				 (double)allocations / bundles, "");
+	}
+}
+
+static uint64_t serialize_all(const char *const mode,
+			      struct bundle **bundles, const uint64_t count,
+			      struct output *out)
+{
+	uint64_t failed = 0, alloc_start, alloc_end;
+
+	out->length = 0;
+
+	const bool counted = benchmark_allocations(&alloc_start);
+	const uint64_t start_ns = benchmark_time_ns();
+
+	for (uint64_t i = 0; i < count; i++) {
+		if (bundle7_serialize(bundles[i], write_to_output,
+				      out) != UD3TN_OK)
+			failed++;
+	}
+
+	const uint64_t ns = benchmark_time_ns() - start_ns;
+
+	benchmark_allocations(&alloc_end);
+	report(mode, ns, alloc_end - alloc_start, counted, count,
+	       out->length);
+	return failed + (out->length > out->capacity ? 1 : 0);
+}
+
+int benchmark_bundle7_profile(int argc, char *argv[])
+{
+	const uint64_t count = benchmark_arg_u64(
+		argc, argv, 0, DEFAULT_BUNDLES
+	);
+	const uint64_t payload_length = benchmark_arg_u64(
+		argc, argv, 1, DEFAULT_PAYLOAD_LENGTH
+	);
+	struct bundle7_profile *profile;
+	struct bundle **bundles;
+	uint64_t failed = 0, alloc_start, alloc_end;
+
+	if (count == 0 || payload_length > UINT32_MAX) {
+		fprintf(stderr, "Invalid arguments.\n");
+		return 1;
+	}
+
+	// IPN EIDs, a CRC-32 over the primary block, a Bundle Age and a Hop
+	// Count block
+	profile = bundle7_profile_create(
+		SOURCE_EID, "dtn:none", LIFETIME_MS, BUNDLE_CRC_TYPE_32,
+		BUNDLE7_PROFILE_BUNDLE_AGE | BUNDLE7_PROFILE_HOP_COUNT,
+		HOP_LIMIT
+	);
+	bundles = calloc(count, sizeof(*bundles));
+	if (!profile || !bundles) {
+		fprintf(stderr, "Could not create profile.\n");
+		bundle7_profile_unref(profile);
+		free(bundles);
+		return 1;
+	}
+
+	const bool counted = benchmark_allocations(&alloc_start);
+	const uint64_t start_ns = benchmark_time_ns();
+
+	for (uint64_t i = 0; failed == 0 && i < count; i++) {
+		bundles[i] = bundle7_profile_create_bundle(
+			profile, calloc(1, payload_length), payload_length,
+			DESTINATION_EID, TIMESTAMP_MS, i, BUNDLE_FLAG_NONE
+		);
+		if (!bundles[i])
+			failed++;
+	}
+
+	const uint64_t ns = benchmark_time_ns() - start_ns;
+
+	benchmark_allocations(&alloc_end);
+	if (failed) {
+		fprintf(stderr, "Could not create bundles.\n");
+		goto out;
+	}
+	report("profile_create", ns, alloc_end - alloc_start, counted, count,
+	       0);
+
+	size_t size = 0;
+
+	for (uint64_t i = 0; i < count; i++)
+		size += bundle_get_serialized_size(bundles[i]);
+
+	struct output profile_out = { .data = malloc(size), .capacity = size };
+	struct output generic_out = { .data = malloc(size), .capacity = size };
+
+	if (!profile_out.data || !generic_out.data) {
+		fprintf(stderr, "Could not allocate output buffers.\n");
+		failed++;
+		goto out_free_buffers;
+	}
+	// Fault in the pages of the buffers before measuring.
+	memset(profile_out.data, 0, size);
+	memset(generic_out.data, 0, size);
+
+	failed += serialize_all("profile_serialize", bundles, count,
+				&profile_out);
+
+	// Serialize the same bundles like any other bundle, including encoding
+	// the primary block on first use, which a profile does on creation.
+	for (uint64_t i = 0; i < count; i++) {
+		bundle7_profile_unref(bundles[i]->profile);
+		bundles[i]->profile = NULL;
+		bundle_recalculate_header_length(bundles[i]);
+	}
+	failed += serialize_all("generic_serialize", bundles, count,
+				&generic_out);
+	failed += serialize_all("generic_serialize_cached", bundles, count,
+				&generic_out);
+
+	// Both serializers have to produce the same data.
+	if (profile_out.length != generic_out.length ||
+	    memcmp(profile_out.data, generic_out.data,
+		   profile_out.length) != 0)
+		failed++;
+
+out_free_buffers:
+	free(profile_out.data);
+	free(generic_out.data);
+out:
+	for (uint64_t i = 0; i < count; i++)
+		bundle_free(bundles[i]);
+	free(bundles);
+	bundle7_profile_unref(profile);
+
+	benchmark_report(BENCHMARK_NAME, "failed", failed, "");
+	return failed == 0 ? 0 : 1;
+}
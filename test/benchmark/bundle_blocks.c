@@ -0,0 +1,206 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "benchmark.h"
+
+#include "bundle7/bundle_age.h"
+#include "bundle7/create.h"
+#include "bundle7/hopcount.h"
+#include "bundle7/parser.h"
+#include "bundle7/serializer.h"
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/object_pool.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCHMARK_NAME "bundle_blocks"
+
+#define DEFAULT_BUNDLES 100000
+#define DEFAULT_PAYLOAD_LENGTH 64
+#define MAX_SERIALIZED_SIZE (1024 * 1024)
+
+struct memory_sink {
+	uint8_t *data;
+	size_t length;
+};
+
+static void write_to_memory(void *obj, const void *data, const size_t length)
+{
+	struct memory_sink *const sink = obj;
+
+	if (sink->data && sink->length + length <= MAX_SERIALIZED_SIZE)
+		memcpy(sink->data + sink->length, data, length);
+	sink->length += length;
+}
+
+static bool prepend_block(struct bundle *bundle, enum bundle_block_type type,
+			  uint8_t number, const uint8_t *data, size_t length)
+{
+	struct bundle_block *const block = bundle_block_create(type);
+	struct bundle_block_list *entry = bundle_block_entry_create(block);
+
+	if (!entry) {
+		bundle_block_free(block);
+		return false;
+	}
+	block->number = number;
+	block->crc_type = BUNDLE_CRC_TYPE_16;
+	block->data = malloc(length);
+	if (!block->data) {
+		bundle_block_entry_free(entry);
+		return false;
+	}
+	memcpy(block->data, data, length);
+	block->length = length;
+	entry->next = bundle->blocks;
+	bundle->blocks = entry;
+	bundle_invalidate_block_caches(bundle);
+	return true;
+}
+
+// A bundle with the extension blocks a forwarding node typically sees.
+static struct bundle *create_prototype(size_t payload_length)
+{
+	// CBOR: [1, "GS4"]
+	static const uint8_t previous_node[] = {
+		0x82, 0x01, 0x63, 0x47, 0x53, 0x34
+	};
+	const struct bundle_hop_count hop_count = { .limit = 30, .count = 0 };
+	uint8_t hop_count_data[BUNDLE7_HOP_COUNT_MAX_ENCODED_SIZE];
+	uint8_t age_data[BUNDLE_AGE_MAX_ENCODED_SIZE];
+	struct bundle *bundle = bundle7_create_local(
+		calloc(1, payload_length), payload_length,
+		"dtn://bench/source", "dtn://bench/sink",
+		1000, 1, 3600000, BUNDLE_FLAG_NONE
+	);
+
+	if (!bundle)
+		return NULL;
+	if (!prepend_block(bundle, BUNDLE_BLOCK_TYPE_BUNDLE_AGE, 4, age_data,
+			   bundle_age_serialize(0, age_data,
+						sizeof(age_data))) ||
+	    !prepend_block(bundle, BUNDLE_BLOCK_TYPE_HOP_COUNT, 3,
+			   hop_count_data,
+			   bundle7_hop_count_serialize(
+				&hop_count, hop_count_data,
+				sizeof(hop_count_data))) ||
+	    !prepend_block(bundle, BUNDLE_BLOCK_TYPE_PREVIOUS_NODE, 2,
+			   previous_node, sizeof(previous_node))) {
+		bundle_free(bundle);
+		return NULL;
+	}
+	return bundle;
+}
+
+static void receive_bundle(struct bundle *bundle, void *param)
+{
+	struct bundle **const result = param;
+
+	*result = bundle;
+}
+
+// The per-bundle block operations of the bundle processor and TX task.
+static size_t process(struct bundle *bundle, struct memory_sink *sink)
+{
+	struct bundle_block_list **e = &bundle->blocks;
+
+	if (bundle_find_block(bundle, BUNDLE_BLOCK_TYPE_HOP_COUNT) == NULL)
+		return 0;
+	while (bundle_has_block_type(bundle, BUNDLE_BLOCK_TYPE_PREVIOUS_NODE) &&
+	       *e != NULL) {
+		if ((*e)->data->type == BUNDLE_BLOCK_TYPE_PREVIOUS_NODE) {
+			*e = bundle_block_entry_free(*e);
+			bundle_invalidate_block_caches(bundle);
+			break;
+		}
+		e = &(*e)->next;
+	}
+	if (bundle_age_update(bundle, 1) != UD3TN_OK)
+		return 0;
+
+	const size_t size = bundle_get_serialized_size(bundle);
+
+	sink->length = 0;
+	bundle7_serialize(bundle, write_to_memory, sink);
+	return sink->length == size ? size : 0;
+}
+
+int benchmark_bundle_blocks(int argc, char *argv[])
+{
+	const uint64_t bundles = benchmark_arg_u64(
+		argc, argv, 0, DEFAULT_BUNDLES
+	);
+	const uint64_t payload_length = benchmark_arg_u64(
+		argc, argv, 1, DEFAULT_PAYLOAD_LENGTH
+	);
+	struct memory_sink wire = { .data = malloc(MAX_SERIALIZED_SIZE) };
+	struct memory_sink out = { .data = malloc(MAX_SERIALIZED_SIZE) };
+	struct bundle7_parser parser;
+	struct bundle *prototype = NULL;
+	struct bundle *bundle = NULL;
+	uint64_t parse_ns = 0, process_ns = 0, failed = 0;
+	int rc = 1;
+
+	if (!wire.data || !out.data || bundles == 0 ||
+	    payload_length > MAX_SERIALIZED_SIZE / 2) {
+		fprintf(stderr, "Invalid arguments or out of memory.\n");
+		goto out;
+	}
+
+	prototype = create_prototype(payload_length);
+	if (!prototype ||
+	    bundle7_serialize(prototype, write_to_memory, &wire) != UD3TN_OK) {
+		fprintf(stderr, "Could not create bundle.\n");
+		goto out;
+	}
+	if (!bundle7_parser_init(&parser, receive_bundle, &bundle)) {
+		fprintf(stderr, "Could not initialize parser.\n");
+		goto out;
+	}
+
+	for (uint64_t i = 0; i < bundles; i++) {
+		uint64_t start_ns = benchmark_time_ns();
+
+		bundle = NULL;
+		bundle7_parser_reset(&parser);
+		bundle7_parser_read(&parser, wire.data, wire.length);
+
+		const uint64_t parsed_ns = benchmark_time_ns();
+
+		if (!bundle || process(bundle, &out) == 0)
+			failed++;
+		process_ns += benchmark_time_ns() - parsed_ns;
+		parse_ns += parsed_ns - start_ns;
+		bundle_free(bundle);
+	}
+	bundle7_parser_deinit(&parser);
+
+	const struct object_pool_stats blocks = object_pool_get_stats(
+		&bundle_block_pool
+	);
+	const struct object_pool_stats entries = object_pool_get_stats(
+		&bundle_block_list_pool
+	);
+
+	benchmark_report(BENCHMARK_NAME, "serialized_size", wire.length, "B");
+	benchmark_report(BENCHMARK_NAME, "parse_per_bundle",
+			 (double)parse_ns / bundles, "ns");
+	benchmark_report(BENCHMARK_NAME, "process_per_bundle",
+			 (double)process_ns / bundles, "ns");
+	benchmark_report(BENCHMARK_NAME, "block_high_water",
+			 blocks.high_water, "");
+	benchmark_report(BENCHMARK_NAME, "list_entry_high_water",
+			 entries.high_water, "");
+	benchmark_report(BENCHMARK_NAME, "failed", failed, "");
+	rc = failed == 0 ? 0 : 1;
+
+out:
+	bundle_free(prototype);
+	free(wire.data);
+	free(out.data);
+	return rc;
+}
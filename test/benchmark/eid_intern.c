@@ -0,0 +1,154 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "benchmark.h"
+
+#include "ud3tn/eid.h"
+#include "ud3tn/eid_intern.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCHMARK_NAME "eid_intern"
+
+#define DEFAULT_BUNDLES 1000000
+#define DEFAULT_NODES 64
+#define MAX_NODES 4096
+#define EID_LENGTH 64
+
+// The EIDs of a single bundle, as held by the bundle and the derived ADU.
+struct eids {
+	const char *source;
+	const char *destination;
+	const char *report_to;
+	const char *adu_source;
+	const char *adu_destination;
+};
+
+static char (*eid_strings)[EID_LENGTH];
+
+// Steps per bundle as performed before the EIDs have been interned: copy the
+// parsed EIDs, determine the destination node ID for the routing lookup,
+// compare the source for deduplication and copy the EIDs into the ADU.
+static uint64_t run_strdup(const uint64_t bundles, const uint64_t nodes)
+{
+	uint64_t matches = 0;
+
+	for (uint64_t i = 0; i < bundles; i++) {
+		struct eids e = {
+			.source = strdup(eid_strings[i % nodes]),
+			.destination = strdup(eid_strings[(i + 1) % nodes]),
+			.report_to = strdup("dtn:none"),
+		};
+		char *const node_id = get_node_id(e.destination);
+
+		if (node_id && strcmp(node_id, eid_strings[0]) == 0)
+			matches++;
+		if (strcmp(e.source, eid_strings[0]) == 0)
+			matches++;
+		e.adu_source = strdup(e.source);
+		e.adu_destination = strdup(e.destination);
+
+		free(node_id);
+		free((char *)e.source);
+		free((char *)e.destination);
+		free((char *)e.report_to);
+		free((char *)e.adu_source);
+		free((char *)e.adu_destination);
+	}
+	return matches;
+}
+
+// The same steps using interned EIDs.
+static uint64_t run_intern(const uint64_t bundles, const uint64_t nodes)
+{
+	const char *const first = eid_intern(eid_strings[0]);
+	uint64_t matches = 0;
+
+	for (uint64_t i = 0; i < bundles; i++) {
+		struct eids e = {
+			.source = eid_intern(eid_strings[i % nodes]),
+			.destination = eid_intern(eid_strings[(i + 1) % nodes]),
+			.report_to = eid_intern("dtn:none"),
+		};
+
+		if (eid_intern_get_node_id(e.destination) == first)
+			matches++;
+		if (e.source == first)
+			matches++;
+		e.adu_source = eid_intern_ref(e.source);
+		e.adu_destination = eid_intern_ref(e.destination);
+
+		eid_intern_release(e.source);
+		eid_intern_release(e.destination);
+		eid_intern_release(e.report_to);
+		eid_intern_release(e.adu_source);
+		eid_intern_release(e.adu_destination);
+	}
+	eid_intern_release(first);
+	return matches;
+}
+
+int benchmark_eid_intern(int argc, char *argv[])
+{
+	const uint64_t bundles = benchmark_arg_u64(
+		argc, argv, 0, DEFAULT_BUNDLES
+	);
+	const uint64_t nodes = benchmark_arg_u64(argc, argv, 1, DEFAULT_NODES);
+
+	if (bundles == 0 || nodes == 0 || nodes > MAX_NODES) {
+		fprintf(stderr, "Invalid arguments.\n");
+		return 1;
+	}
+
+	// Keep the EIDs interned that are known to the node anyway, e.g.,
+	// referenced by the routing table or by bundles in storage.
+	const char **const known = malloc(nodes * sizeof(const char *));
+
+	eid_strings = malloc(nodes * EID_LENGTH);
+	if (!eid_strings || !known) {
+		fprintf(stderr, "Could not allocate EIDs.\n");
+		free(eid_strings);
+		free(known);
+		return 1;
+	}
+	for (uint64_t n = 0; n < nodes; n++)
+		snprintf(eid_strings[n], EID_LENGTH,
+			 "dtn://node%llu.dtn/bundlesink",
+			 (unsigned long long)n);
+
+	const char *const none = eid_intern("dtn:none");
+
+	for (uint64_t n = 0; n < nodes; n++)
+		known[n] = eid_intern(eid_strings[n]);
+
+	const size_t interned = eid_intern_get_count();
+
+	uint64_t start_ns = benchmark_time_ns();
+	const uint64_t strdup_matches = run_strdup(bundles, nodes);
+	const uint64_t strdup_ns = benchmark_time_ns() - start_ns;
+
+	start_ns = benchmark_time_ns();
+
+	const uint64_t intern_matches = run_intern(bundles, nodes);
+	const uint64_t intern_ns = benchmark_time_ns() - start_ns;
+
+	// No entry has been created while processing the bundles.
+	const bool stable = (eid_intern_get_count() == interned);
+
+	for (uint64_t n = 0; n < nodes; n++)
+		eid_intern_release(known[n]);
+	eid_intern_release(none);
+	free(known);
+	free(eid_strings);
+
+	benchmark_report(BENCHMARK_NAME, "nodes", nodes, "");
+	benchmark_report(BENCHMARK_NAME, "strdup_per_bundle",
+			 (double)strdup_ns / bundles, "ns");
+	benchmark_report(BENCHMARK_NAME, "intern_per_bundle",
+			 (double)intern_ns / bundles, "ns");
+	benchmark_report(BENCHMARK_NAME, "interned", interned, "");
+	return (strdup_matches == intern_matches && stable) ? 0 : 1;
+}
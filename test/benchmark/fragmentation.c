@@ -0,0 +1,181 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "benchmark.h"
+
+#include "bundle7/create.h"
+
+#include "platform/hal_time.h"
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/bundle_fragmenter.h"
+#include "ud3tn/common.h"
+#include "ud3tn/node.h"
+#include "ud3tn/router.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCHMARK_NAME "fragmentation"
+
+#define DEFAULT_PAYLOAD_LENGTH (1024 * 1024 * 1024)
+#define DEFAULT_FRAGMENT_COUNT 1000
+// The payload is distributed over this many consecutive contacts.
+#define CONTACT_COUNT 4
+
+static struct node *create_contacts(uint32_t max_frag_sz,
+				    uint32_t fragment_count)
+{
+	const uint64_t now_ms = hal_time_get_timestamp_ms();
+	const uint32_t per_contact = (
+		(fragment_count + CONTACT_COUNT - 1) / CONTACT_COUNT
+	);
+	struct node *node = node_create("dtn://bench/");
+
+	if (!node)
+		return NULL;
+	for (int i = 0; i < CONTACT_COUNT; i++) {
+		struct contact *c = contact_create(node);
+
+		if (!c) {
+			free_node(node);
+			return NULL;
+		}
+		c->from_ms = now_ms + (i + 1) * 60000;
+		c->to_ms = now_ms + (i + 2) * 60000;
+		c->total_capacity_bytes = MIN(
+			(uint64_t)per_contact * max_frag_sz,
+			(uint64_t)INT32_MAX - 1
+		);
+		c->remaining_capacity_p0 = c->total_capacity_bytes;
+		c->remaining_capacity_p1 = c->total_capacity_bytes;
+		c->remaining_capacity_p2 = c->total_capacity_bytes;
+		add_contact_to_ordered_list(&node->contacts, c, 0);
+	}
+	return node;
+}
+
+// Same procedure as used by the router task.
+static struct bundle **create_fragments(struct bundle *bundle,
+					struct router_result *route)
+{
+	struct bundle **frags = calloc(route->fragments,
+				       sizeof(struct bundle *));
+	uint32_t size;
+
+	if (!frags)
+		return NULL;
+	frags[0] = bundlefragmenter_initialize_first_fragment(bundle);
+	for (int32_t f = 0; frags[f] && f < route->fragments - 1; f++) {
+		if (f == 0)
+			size = bundle_get_first_fragment_min_size(bundle);
+		else
+			size = bundle_get_mid_fragment_min_size(bundle);
+		frags[f + 1] = bundlefragmenter_fragment_bundle(
+			frags[f],
+			size + route->fragment_results[f].payload_size
+		);
+		if (frags[f + 1] == frags[f])
+			frags[f + 1] = NULL;
+	}
+	return frags;
+}
+
+int benchmark_fragmentation(int argc, char *argv[])
+{
+	const uint32_t payload_length = benchmark_arg_u64(
+		argc, argv, 0, DEFAULT_PAYLOAD_LENGTH
+	);
+	const uint32_t fragment_count = benchmark_arg_u64(
+		argc, argv, 1, DEFAULT_FRAGMENT_COUNT
+	);
+	// NOTE: The payload is never touched, i.e., if no copy is made, the
+	// pages are never actually allocated.
+	uint8_t *payload = malloc(payload_length);
+	struct router_result route = { .fragments = 0 };
+	struct bundle **frags = NULL;
+	struct node *node = NULL;
+	uint64_t start_ns, plan_ns, frag_ns, copied = 0, total = 0;
+	int32_t created = 0;
+	int rc = 1;
+
+	if (!payload || fragment_count == 0) {
+		fprintf(stderr, "Invalid arguments or out of memory.\n");
+		free(payload);
+		return 1;
+	}
+
+	struct bundle *bundle = bundle7_create_local(
+		payload, payload_length,
+		"dtn://bench/source", "dtn://bench/sink",
+		hal_time_get_timestamp_ms(), 1, 3600000,
+		BUNDLE_FLAG_NONE
+	);
+
+	if (!bundle) {
+		fprintf(stderr, "Could not create bundle.\n");
+		return 1;
+	}
+
+	const uint32_t header_sz = MAX(
+		MAX(
+			bundle_get_first_fragment_min_size(bundle),
+			bundle_get_mid_fragment_min_size(bundle)
+		),
+		bundle_get_last_fragment_min_size(bundle)
+	);
+	const uint32_t max_frag_sz = header_sz + (
+		(payload_length + fragment_count - 1) / fragment_count
+	);
+
+	node = create_contacts(max_frag_sz, fragment_count);
+	if (!node)
+		goto out;
+
+	start_ns = benchmark_time_ns();
+	if (!router_plan_fragments(&route, node->contacts, bundle,
+				   bundle_get_expiration_time_ms(bundle),
+				   max_frag_sz)) {
+		fprintf(stderr, "Planning the fragmentation failed.\n");
+		goto out;
+	}
+	plan_ns = benchmark_time_ns() - start_ns;
+
+	start_ns = benchmark_time_ns();
+	frags = create_fragments(bundle, &route);
+	frag_ns = benchmark_time_ns() - start_ns;
+	if (!frags)
+		goto out;
+
+	for (; created < route.fragments && frags[created]; created++) {
+		const struct bundle_block *pl = frags[created]->payload_block;
+
+		total += pl->length;
+		if (!pl->buffer || pl->data < payload ||
+		    pl->data + pl->length > payload + payload_length)
+			copied += pl->length;
+	}
+	if (total != payload_length) {
+		fprintf(stderr, "Fragments do not cover the payload.\n");
+		goto out;
+	}
+
+	benchmark_report(BENCHMARK_NAME, "payload", payload_length, "B");
+	benchmark_report(BENCHMARK_NAME, "fragments", created, "");
+	benchmark_report(BENCHMARK_NAME, "plan_time", plan_ns / 1e6, "ms");
+	benchmark_report(BENCHMARK_NAME, "fragment_time", frag_ns / 1e6, "ms");
+	benchmark_report(BENCHMARK_NAME, "per_fragment",
+			 (double)(plan_ns + frag_ns) / created, "ns");
+	benchmark_report(BENCHMARK_NAME, "copied", copied, "B");
+	rc = 0;
+
+out:
+	for (int32_t f = 0; frags && f < route.fragments; f++)
+		bundle_free(frags[f]);
+	free(frags);
+	router_result_free(&route);
+	free_node(node);
+	bundle_free(bundle);
+	return rc;
+}
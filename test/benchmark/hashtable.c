@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "benchmark.h"
+
+#include "ud3tn/hashtable.h"
+#include "ud3tn/routing_table.h"
+#include "ud3tn/simplehtab.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCHMARK_NAME "hashtable"
+
+#define DEFAULT_KEYS 10000
+#define DEFAULT_LOOKUPS 1000000
+#define KEY_LENGTH 48
+
+struct key {
+	char str[KEY_LENGTH];
+	size_t length;
+	uint32_t hash;
+};
+
+struct timings {
+	uint64_t insert_ns;
+	uint64_t lookup_ns;
+	uint64_t remove_ns;
+	uint64_t found;
+};
+
+static struct key *keys;
+
+static struct timings run_simplehtab(const uint64_t count,
+				     const uint64_t lookups)
+{
+	// Sized like the node table of the routing table.
+	struct htab *const tab = htab_alloc(NODE_HTAB_SLOT_COUNT);
+	struct timings t = { .found = 0 };
+	uint64_t start_ns = benchmark_time_ns();
+
+	for (uint64_t i = 0; i < count; i++)
+		htab_add(tab, keys[i].str, &keys[i]);
+	t.insert_ns = benchmark_time_ns() - start_ns;
+
+	start_ns = benchmark_time_ns();
+	for (uint64_t i = 0; i < lookups; i++)
+		if (htab_get(tab, keys[i % count].str) == &keys[i % count])
+			t.found++;
+	t.lookup_ns = benchmark_time_ns() - start_ns;
+
+	start_ns = benchmark_time_ns();
+	for (uint64_t i = 0; i < count; i++)
+		htab_remove(tab, keys[i].str);
+	t.remove_ns = benchmark_time_ns() - start_ns;
+
+	htab_free(tab);
+	return t;
+}
+
+static struct timings run_hashtable(const uint64_t count,
+				    const uint64_t lookups, const int hashed)
+{
+	struct hashtable tab;
+	struct timings t = { .found = 0 };
+	uint64_t start_ns;
+
+	hashtable_init(&tab, NODE_HTAB_SLOT_COUNT);
+
+	start_ns = benchmark_time_ns();
+	for (uint64_t i = 0; i < count; i++)
+		hashtable_add(&tab, keys[i].str, &keys[i]);
+	t.insert_ns = benchmark_time_ns() - start_ns;
+
+	start_ns = benchmark_time_ns();
+	for (uint64_t i = 0; i < lookups; i++) {
+		const struct key *const k = &keys[i % count];
+		const void *const value = (
+			hashed
+			? hashtable_get_hashed(&tab, k->str, k->length, k->hash)
+			: hashtable_get(&tab, k->str)
+		);
+
+		if (value == k)
+			t.found++;
+	}
+	t.lookup_ns = benchmark_time_ns() - start_ns;
+
+	start_ns = benchmark_time_ns();
+	for (uint64_t i = 0; i < count; i++)
+		hashtable_remove(&tab, keys[i].str);
+	t.remove_ns = benchmark_time_ns() - start_ns;
+
+	hashtable_clear(&tab, NULL);
+	return t;
+}
+
+int benchmark_hashtable(int argc, char *argv[])
+{
+	const uint64_t count = benchmark_arg_u64(argc, argv, 0, DEFAULT_KEYS);
+	const uint64_t lookups = benchmark_arg_u64(
+		argc, argv, 1, DEFAULT_LOOKUPS
+	);
+
+	if (count == 0 || lookups == 0) {
+		fprintf(stderr, "Invalid arguments.\n");
+		return 1;
+	}
+
+	keys = malloc(count * sizeof(struct key));
+	if (!keys) {
+		fprintf(stderr, "Could not allocate keys.\n");
+		return 1;
+	}
+	for (uint64_t i = 0; i < count; i++) {
+		keys[i].length = (size_t)snprintf(
+			keys[i].str, KEY_LENGTH,
+			"dtn://node%llu.dtn/",
+			(unsigned long long)i
+		);
+		// Precomputed like the hashes of interned EIDs.
+		keys[i].hash = hashtable_hash(keys[i].str, keys[i].length);
+	}
+
+	const struct timings simple = run_simplehtab(count, lookups);
+	const struct timings table = run_hashtable(count, lookups, 0);
+	const struct timings hashed = run_hashtable(count, lookups, 1);
+
+	free(keys);
+
+	benchmark_report(BENCHMARK_NAME, "keys", count, "");
+	benchmark_report(BENCHMARK_NAME, "simplehtab_insert",
+			 (double)simple.insert_ns / count, "ns");
+	benchmark_report(BENCHMARK_NAME, "simplehtab_lookup",
+			 (double)simple.lookup_ns / lookups, "ns");
+	benchmark_report(BENCHMARK_NAME, "simplehtab_remove",
+			 (double)simple.remove_ns / count, "ns");
+	benchmark_report(BENCHMARK_NAME, "hashtable_insert",
+			 (double)table.insert_ns / count, "ns");
+	benchmark_report(BENCHMARK_NAME, "hashtable_lookup",
+			 (double)table.lookup_ns / lookups, "ns");
+	benchmark_report(BENCHMARK_NAME, "hashtable_lookup_hashed",
+			 (double)hashed.lookup_ns / lookups, "ns");
+	benchmark_report(BENCHMARK_NAME, "hashtable_remove",
+			 (double)table.remove_ns / count, "ns");
+	return (simple.found == lookups && table.found == lookups &&
+		hashed.found == lookups) ? 0 : 1;
+}
@@ -0,0 +1,192 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "benchmark.h"
+
+#include "platform/hal_platform.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const struct benchmark benchmarks[] = {
+	{
+		"bibe_tunnel",
+		"[bundles] [payload bytes] - encapsulate and decapsulate bundles",
+		benchmark_bibe_tunnel,
+	},
+	{
+		"bp_workers",
+		"[bundles] [payload bytes] [max workers] - scale BP workers",
+		benchmark_bp_workers,
+	},
+	{
+		"bundle7_parser",
+		"[bundles] [payload bytes] [chunk bytes] - parse BPv7 bundles",
+		benchmark_bundle7_parser,
+	},
+	{
+		"bundle7_profile",
+		"[bundles] [payload bytes] - serialize bundles of a profile",
+		benchmark_bundle7_profile,
+	},
+	{
+		"bundle_blocks",
+		"[bundles] [payload bytes] - parse, process and serialize",
+		benchmark_bundle_blocks,
+	},
+	{
+		"eid_intern",
+		"[bundles] [nodes] - compare interned EIDs to copies",
+		benchmark_eid_intern,
+	},
+	{
+		"fragmentation",
+		"[payload bytes] [fragments] - plan and create fragments",
+		benchmark_fragmentation,
+	},
+	{
+		"hashtable",
+		"[keys] [lookups] - compare hashtable to simplehtab",
+		benchmark_hashtable,
+	},
+	{
+		"mtcp_loopback",
+		"[bundles] [payload bytes] - send bundles via MTCP over loopback",
+		benchmark_mtcp_loopback,
+	},
+	{
+		"object_pool",
+		"[threads] [operations per thread] - compare pools to malloc",
+		benchmark_object_pool,
+	},
+	{
+		"parsers",
+		"[iterations] [parser] - parse the corpora of the wire parsers",
+		benchmark_parsers,
+	},
+	{
+		"sdnv",
+		"[values] [bundles] - compare bulk to byte-wise SDNV decoding",
+		benchmark_sdnv,
+	},
+	{
+		"status_report",
+		"[reports] [endpoints] - generate BPv7 status reports",
+		benchmark_status_report,
+	},
+};
+
+#define BENCHMARK_COUNT (sizeof(benchmarks) / sizeof(benchmarks[0]))
+
+uint64_t benchmark_time_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void benchmark_report(const char *benchmark, const char *metric,
+		      double value, const char *unit)
+{
+	static int json = -1;
+
+	if (json < 0) {
+		const char *const format = getenv("UD3TNBENCH_FORMAT");
+
+		json = format && strcmp(format, "json") == 0;
+	}
+
+	if (json)
+		printf("{\"benchmark\": \"%s\", \"metric\": \"%s\", "
+		       "\"value\": %.3f, \"unit\": \"%s\"}\n",
+		       benchmark, metric, value, unit);
+	else
+		printf("%s.%s: %.3f%s%s\n", benchmark, metric, value,
+		       unit[0] ? " " : "", unit);
+}
+
+uint64_t benchmark_arg_u64(int argc, char *argv[], int index,
+			   uint64_t default_value)
+{
+	if (index >= argc)
+		return default_value;
+	return strtoull(argv[index], NULL, 0);
+}
+
+#ifdef BENCHMARK_COUNT_ALLOCATIONS
+
+// The binary is linked with --wrap for the functions below, redirecting all
+// calls to them (also those of libud3tn) here.
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void *__wrap_malloc(size_t size);
+void *__wrap_calloc(size_t count, size_t size);
+void *__wrap_realloc(void *ptr, size_t size);
+
+static uint64_t allocations;
+
+void *__wrap_malloc(size_t size)
+{
+	__atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+	return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+	__atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+	return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+	__atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+	return __real_realloc(ptr, size);
+}
+
+bool benchmark_allocations(uint64_t *count)
+{
+	*count = __atomic_load_n(&allocations, __ATOMIC_RELAXED);
+	return true;
+}
+
+#else // BENCHMARK_COUNT_ALLOCATIONS
+
+bool benchmark_allocations(uint64_t *count)
+{
+	*count = 0;
+	return false;
+}
+
+#endif // BENCHMARK_COUNT_ALLOCATIONS
+
+static void usage(void)
+{
+	fprintf(stderr, "Usage: ud3tnbench <benchmark> [args...]\n\n"
+		"<benchmark> may be one of the following:\n");
+	for (size_t i = 0; i < BENCHMARK_COUNT; i++)
+		fprintf(stderr, "    %s %s\n",
+			benchmarks[i].name, benchmarks[i].description);
+}
+
+int main(const int argc, char *argv[])
+{
+	if (argc < 2 || strcmp(argv[1], "-h") == 0) {
+		usage();
+		return argc < 2;
+	}
+
+	hal_platform_init(argc, argv);
+
+	for (size_t i = 0; i < BENCHMARK_COUNT; i++) {
+		if (strcmp(argv[1], benchmarks[i].name) == 0)
+			return benchmarks[i].run(argc - 2, argv + 2);
+	}
+
+	usage();
+	return 1;
+}
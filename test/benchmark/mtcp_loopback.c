@@ -0,0 +1,321 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "benchmark.h"
+
+#include "bundle7/create.h"
+
+#include "cla/cla.h"
+#include "cla/cla_contact_tx_task.h"
+#include "cla/posix/cla_mtcp.h"
+#include "cla/posix/cla_tcp_common.h"
+
+#include "platform/hal_queue.h"
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/bundle_processor.h"
+#include "ud3tn/node.h"
+#include "ud3tn/object_pool.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCHMARK_NAME "mtcp_loopback"
+
+#define DEFAULT_BUNDLES 100000
+#define DEFAULT_PAYLOAD_LENGTH 64
+// Bundles handed over to the TX task per command, like the contact manager.
+#define BATCH_SIZE 16
+#define SIGNAL_QUEUE_LENGTH 256
+
+static const char *const CLA_ADDR = "127.0.0.1:4222";
+
+// Number of calls into the CLA by the TX task, i.e. of send() invocations.
+static uint64_t cla_calls;
+// Number of reads from the socket by the RX tasks, i.e. of recv() invocations.
+static uint64_t rx_reads;
+
+static const char *bench_name_get(void)
+{
+	return "mtcp";
+}
+
+static void bench_begin_packet(struct cla_link *link, size_t length,
+			       char *cla_addr)
+{
+	cla_calls++;
+	mtcp_begin_packet(link, length, cla_addr);
+}
+
+static void bench_send_packet_data(struct cla_link *link, const void *data,
+				   const size_t length)
+{
+	cla_calls++;
+	mtcp_send_packet_data(link, data, length);
+}
+
+static void bench_send_packet(struct cla_link *link, uint8_t *data,
+			      size_t length, char *cla_addr)
+{
+	cla_calls++;
+	mtcp_send_packet(link, data, length, cla_addr);
+}
+
+static void bench_send_packet_iov(struct cla_link *link, struct bundle_iov *iov,
+				  char *cla_addr)
+{
+	cla_calls++;
+	mtcp_send_packet_iov(link, iov, cla_addr);
+}
+
+static enum ud3tn_result bench_read(struct cla_link *link, uint8_t *buffer,
+				     size_t length, size_t *bytes_read)
+{
+	// Both links have an RX task.
+	__atomic_add_fetch(&rx_reads, 1, __ATOMIC_RELAXED);
+	return cla_tcp_read(link, buffer, length, bytes_read);
+}
+
+// The MTCP CLA without the connection management.
+static const struct cla_vtable bench_vtable = {
+	.cla_name_get = bench_name_get,
+
+	.cla_begin_packet = bench_begin_packet,
+	.cla_end_packet = mtcp_end_packet,
+	.cla_send_packet_data = bench_send_packet_data,
+	.cla_send_packet = bench_send_packet,
+	.cla_send_packet_iov = bench_send_packet_iov,
+
+	.cla_rx_task_reset_parsers = mtcp_reset_parsers,
+	.cla_rx_task_forward_to_specific_parser =
+		mtcp_forward_to_specific_parser,
+
+	.cla_read = bench_read,
+
+	.cla_disconnect_handler = cla_tcp_disconnect_handler,
+};
+
+struct producer {
+	pthread_t thread;
+	struct cla_link *link;
+	uint64_t bundles;
+	uint64_t payload_length;
+	uint64_t failed;
+};
+
+// Acts as the contact manager, handing bundles over to the TX task.
+static void *run_producer(void *param)
+{
+	struct producer *const p = param;
+	uint64_t i = 0;
+
+	while (i < p->bundles) {
+		struct cla_contact_tx_task_command cmd = {
+			.type = TX_COMMAND_BUNDLES,
+			.bundles = NULL,
+			.cla_address = strdup(CLA_ADDR),
+		};
+		struct routed_bundle_list **next = &cmd.bundles;
+
+		for (int b = 0; b < BATCH_SIZE && i < p->bundles; b++, i++) {
+			struct bundle *const bundle = bundle7_create_local(
+				calloc(1, p->payload_length),
+				p->payload_length,
+				"dtn://bench-tx.dtn/sensor",
+				"dtn://bench-rx.dtn/sink",
+				1000, i, 3600000, BUNDLE_FLAG_NONE
+			);
+			struct routed_bundle_list *const entry = (
+				bundle
+				? object_pool_alloc(&routed_bundle_list_pool)
+				: NULL
+			);
+
+			if (!entry) {
+				bundle_free(bundle);
+				p->failed++;
+				continue;
+			}
+			entry->data = bundle;
+			entry->next = NULL;
+			*next = entry;
+			next = &entry->next;
+		}
+		if (!cmd.bundles) {
+			free(cmd.cla_address);
+			continue;
+		}
+		hal_queue_push_to_back(p->link->tx_queue_handle, &cmd);
+	}
+	object_pool_thread_flush();
+	return NULL;
+}
+
+static int connect_loopback(int *const tx_socket, int *const rx_socket)
+{
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+		.sin_port = 0,
+	};
+	socklen_t addr_len = sizeof(addr);
+	const int listener = socket(AF_INET, SOCK_STREAM, 0);
+	int rc = -1;
+
+	*tx_socket = -1;
+	*rx_socket = -1;
+	if (listener < 0)
+		return -1;
+	if (bind(listener, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+	    listen(listener, 1) != 0 ||
+	    getsockname(listener, (struct sockaddr *)&addr, &addr_len) != 0)
+		goto out;
+	*tx_socket = socket(AF_INET, SOCK_STREAM, 0);
+	if (*tx_socket < 0 ||
+	    connect(*tx_socket, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+		goto out;
+	*rx_socket = accept(listener, NULL, NULL);
+	if (*rx_socket >= 0)
+		rc = 0;
+
+out:
+	close(listener);
+	return rc;
+}
+
+int benchmark_mtcp_loopback(int argc, char *argv[])
+{
+	const uint64_t bundles = benchmark_arg_u64(
+		argc, argv, 0, DEFAULT_BUNDLES
+	);
+	const uint64_t payload_length = benchmark_arg_u64(
+		argc, argv, 1, DEFAULT_PAYLOAD_LENGTH
+	);
+	struct bundle_agent_interface bai = {
+		.local_eid = "dtn://bench-rx.dtn/",
+		.bundle_signaling_queue = hal_queue_create(
+			SIGNAL_QUEUE_LENGTH,
+			sizeof(struct bundle_processor_signal)
+		),
+	};
+	struct cla_tcp_config config = {
+		.base = {
+			.vtable = &bench_vtable,
+			.bundle_agent_interface = &bai,
+		},
+		.socket = -1,
+	};
+	// Both ends need their own parser state, i.e. link structure.
+	struct mtcp_link tx_link, rx_link;
+	struct producer producer = {
+		.link = &tx_link.base.base,
+		.bundles = bundles,
+		.payload_length = payload_length,
+		.failed = 0,
+	};
+	struct bundle_processor_signal signal;
+	uint64_t received = 0, sent = 0, failed = 0, serialized_size = 0;
+	int links_down = 0;
+	int tx_socket, rx_socket;
+
+	if (bundles == 0 || !bai.bundle_signaling_queue) {
+		fprintf(stderr, "Invalid arguments or out of memory.\n");
+		return 1;
+	}
+	if (connect_loopback(&tx_socket, &rx_socket) != 0) {
+		fprintf(stderr, "Could not connect via loopback.\n");
+		return 1;
+	}
+
+	memset(&tx_link, 0, sizeof(tx_link));
+	memset(&rx_link, 0, sizeof(rx_link));
+	if (cla_tcp_link_init(&tx_link.base, tx_socket, &config,
+			      (char *)CLA_ADDR, true) != UD3TN_OK ||
+	    cla_tcp_link_init(&rx_link.base, rx_socket, &config,
+			      (char *)CLA_ADDR, false) != UD3TN_OK) {
+		fprintf(stderr, "Could not initialize links.\n");
+		return 1;
+	}
+
+	const uint64_t start_ns = benchmark_time_ns();
+
+	if (pthread_create(&producer.thread, NULL, run_producer,
+			   &producer) != 0) {
+		fprintf(stderr, "Could not start thread.\n");
+		return 1;
+	}
+
+	// Acts as the bundle processor, consuming the signals of both links.
+	while (received + failed + producer.failed < bundles ||
+	       sent + failed + producer.failed < bundles) {
+		if (hal_queue_receive(bai.bundle_signaling_queue, &signal,
+				      -1) != UD3TN_OK)
+			continue;
+		switch (signal.type) {
+		case BP_SIGNAL_BUNDLE_INCOMING:
+			received++;
+			serialized_size = bundle_get_serialized_size(
+				signal.bundle
+			);
+			break;
+		case BP_SIGNAL_TRANSMISSION_SUCCESS:
+			sent++;
+			break;
+		case BP_SIGNAL_TRANSMISSION_FAILURE:
+			failed++;
+			break;
+		case BP_SIGNAL_LINK_DOWN:
+			links_down++;
+			break;
+		default:
+			break;
+		}
+		bundle_free(signal.bundle);
+		free(signal.peer_cla_addr);
+		if (links_down != 0) {
+			fprintf(stderr, "Connection lost.\n");
+			break;
+		}
+	}
+
+	const uint64_t duration_ns = benchmark_time_ns() - start_ns;
+
+	pthread_join(producer.thread, NULL);
+
+	// Closing the connection lets both RX tasks and the TX task exit.
+	shutdown(tx_socket, SHUT_RDWR);
+	while (links_down < 2) {
+		if (hal_queue_receive(bai.bundle_signaling_queue, &signal,
+				      -1) != UD3TN_OK)
+			continue;
+		if (signal.type == BP_SIGNAL_LINK_DOWN)
+			links_down++;
+		bundle_free(signal.bundle);
+		free(signal.peer_cla_addr);
+	}
+	cla_link_wait_cleanup(&tx_link.base.base);
+	cla_link_wait_cleanup(&rx_link.base.base);
+	hal_queue_delete(bai.bundle_signaling_queue);
+
+	benchmark_report(BENCHMARK_NAME, "serialized_size", serialized_size,
+			 "B");
+	benchmark_report(BENCHMARK_NAME, "bundles_per_second",
+			 received * 1e9 / duration_ns, "1/s");
+	benchmark_report(BENCHMARK_NAME, "per_bundle",
+			 (double)duration_ns / bundles, "ns");
+	benchmark_report(BENCHMARK_NAME, "cla_calls_per_bundle",
+			 (double)cla_calls / bundles, "");
+	benchmark_report(BENCHMARK_NAME, "rx_reads_per_bundle",
+			 (double)rx_reads / bundles, "");
+	benchmark_report(BENCHMARK_NAME, "failed",
+			 bundles - received, "");
+	return received == bundles ? 0 : 1;
+}
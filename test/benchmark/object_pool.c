@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "benchmark.h"
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/object_pool.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCHMARK_NAME "object_pool"
+
+#define DEFAULT_THREAD_COUNT 4
+#define DEFAULT_OPERATIONS 1000000
+// Objects held by every thread at the same time, e.g., bundles in flight.
+#define BATCH_SIZE 48
+#define MAX_THREAD_COUNT 64
+
+static struct object_pool pool =
+	OBJECT_POOL_INITIALIZER("benchmark", struct bundle);
+
+struct worker {
+	pthread_t thread;
+	uint64_t operations;
+	bool use_pool;
+};
+
+static void *run_worker(void *param)
+{
+	struct worker *const w = param;
+	void *objects[BATCH_SIZE];
+
+	for (uint64_t op = 0; op < w->operations; op += BATCH_SIZE) {
+		for (int i = 0; i < BATCH_SIZE; i++) {
+			objects[i] = (
+				w->use_pool
+				? object_pool_alloc(&pool)
+				: malloc(sizeof(struct bundle))
+			);
+			// Touch the object like bundle_init() would.
+			*(volatile uint8_t *)objects[i] = 0;
+		}
+		for (int i = 0; i < BATCH_SIZE; i++) {
+			if (w->use_pool)
+				object_pool_free(&pool, objects[i]);
+			else
+				free(objects[i]);
+		}
+	}
+	if (w->use_pool)
+		object_pool_thread_flush();
+	return NULL;
+}
+
+static int run(const bool use_pool, const uint64_t thread_count,
+	       const uint64_t operations, uint64_t *const duration_ns)
+{
+	struct worker workers[MAX_THREAD_COUNT];
+	const uint64_t start_ns = benchmark_time_ns();
+	uint64_t t;
+
+	for (t = 0; t < thread_count; t++) {
+		workers[t].operations = operations;
+		workers[t].use_pool = use_pool;
+		if (pthread_create(&workers[t].thread, NULL,
+				   run_worker, &workers[t]) != 0)
+			break;
+	}
+	for (uint64_t i = 0; i < t; i++)
+		pthread_join(workers[i].thread, NULL);
+	*duration_ns = benchmark_time_ns() - start_ns;
+	return t == thread_count ? 0 : 1;
+}
+
+int benchmark_object_pool(int argc, char *argv[])
+{
+	const uint64_t thread_count = benchmark_arg_u64(
+		argc, argv, 0, DEFAULT_THREAD_COUNT
+	);
+	const uint64_t operations = benchmark_arg_u64(
+		argc, argv, 1, DEFAULT_OPERATIONS
+	);
+	uint64_t malloc_ns, pool_ns;
+
+	if (thread_count == 0 || thread_count > MAX_THREAD_COUNT ||
+	    operations == 0) {
+		fprintf(stderr, "Invalid arguments.\n");
+		return 1;
+	}
+
+	if (run(false, thread_count, operations, &malloc_ns) != 0 ||
+	    run(true, thread_count, operations, &pool_ns) != 0) {
+		fprintf(stderr, "Could not start threads.\n");
+		return 1;
+	}
+
+	const double total_ops = (double)thread_count * operations;
+	const struct object_pool_stats stats = object_pool_get_stats(&pool);
+
+	benchmark_report(BENCHMARK_NAME, "threads", thread_count, "");
+	benchmark_report(BENCHMARK_NAME, "object_size", sizeof(struct bundle),
+			 "B");
+	benchmark_report(BENCHMARK_NAME, "malloc_per_op",
+			 malloc_ns / total_ops, "ns");
+	benchmark_report(BENCHMARK_NAME, "pool_per_op",
+			 pool_ns / total_ops, "ns");
+	benchmark_report(BENCHMARK_NAME, "high_water", stats.high_water, "");
+	benchmark_report(BENCHMARK_NAME, "capacity", stats.capacity, "");
+	return stats.in_use == 0 ? 0 : 1;
+}
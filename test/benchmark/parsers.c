@@ -0,0 +1,209 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "benchmark.h"
+
+#include "parser_targets.h"
+
+#include <dirent.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCHMARK_NAME "parsers"
+
+#define DEFAULT_ITERATIONS 1000
+
+struct corpus {
+	size_t count;
+	uint8_t **messages;
+	size_t *lengths;
+	size_t total_length;
+};
+
+static bool read_file(const char *path, uint8_t **data, size_t *length)
+{
+	FILE *const fp = fopen(path, "rb");
+	long size;
+
+	if (!fp)
+		return false;
+	if (fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) <= 0 ||
+	    fseek(fp, 0, SEEK_SET) != 0) {
+		fclose(fp);
+		return false;
+	}
+	*data = malloc(size);
+	*length = size;
+	if (!*data || fread(*data, 1, size, fp) != (size_t)size) {
+		free(*data);
+		fclose(fp);
+		return false;
+	}
+	fclose(fp);
+	return true;
+}
+
+static void corpus_free(struct corpus *corpus)
+{
+	for (size_t i = 0; i < corpus->count; i++)
+		free(corpus->messages[i]);
+	free(corpus->messages);
+	free(corpus->lengths);
+}
+
+// Reads every regular, non-empty file of the directory as one message.
+static bool corpus_load(struct corpus *corpus, const char *directory)
+{
+	DIR *const dir = opendir(directory);
+	struct dirent *entry;
+	char path[512];
+
+	memset(corpus, 0, sizeof(*corpus));
+	if (!dir)
+		return false;
+	while ((entry = readdir(dir)) != NULL) {
+		uint8_t *data;
+		size_t length;
+
+		if (entry->d_name[0] == '.')
+			continue;
+		snprintf(path, sizeof(path), "%s/%s", directory, entry->d_name);
+		if (!read_file(path, &data, &length))
+			continue;
+
+		uint8_t **const messages = realloc(
+			corpus->messages,
+			(corpus->count + 1) * sizeof(*messages)
+		);
+		size_t *const lengths = realloc(
+			corpus->lengths,
+			(corpus->count + 1) * sizeof(*lengths)
+		);
+
+		if (messages)
+			corpus->messages = messages;
+		if (lengths)
+			corpus->lengths = lengths;
+		if (!messages || !lengths) {
+			free(data);
+			break;
+		}
+		corpus->messages[corpus->count] = data;
+		corpus->lengths[corpus->count] = length;
+		corpus->total_length += length;
+		corpus->count++;
+	}
+	closedir(dir);
+	return corpus->count != 0;
+}
+
+static uint64_t run(const struct parser_target *target, void *state,
+		    const struct corpus *corpus, const size_t chunk_length,
+		    const uint64_t iterations)
+{
+	uint64_t failed = 0, allocations_before, allocations_after;
+	char metric[64], chunk[24];
+
+	const bool counted = benchmark_allocations(&allocations_before);
+	const uint64_t start_ns = benchmark_time_ns();
+
+	for (uint64_t i = 0; i < iterations; i++) {
+		for (size_t m = 0; m < corpus->count; m++) {
+			if (!target->parse(state, corpus->messages[m],
+					   corpus->lengths[m], chunk_length))
+				failed++;
+		}
+	}
+
+	const uint64_t ns = benchmark_time_ns() - start_ns;
+	const uint64_t messages = iterations * corpus->count;
+
+	benchmark_allocations(&allocations_after);
+
+	if (chunk_length)
+		snprintf(chunk, sizeof(chunk), "%zub", chunk_length);
+	else
+		snprintf(chunk, sizeof(chunk), "whole");
+
+	snprintf(metric, sizeof(metric), "%s_%s_per_byte",
+		 target->name, chunk);
+	benchmark_report(BENCHMARK_NAME, metric,
+			 (double)ns / (iterations * corpus->total_length),
+			 "ns");
+	snprintf(metric, sizeof(metric), "%s_%s_per_message",
+		 target->name, chunk);
+	benchmark_report(BENCHMARK_NAME, metric, (double)ns / messages, "ns");
+	if (counted) {
+		snprintf(metric, sizeof(metric),
+			 "%s_%s_allocations_per_message", target->name, chunk);
+		benchmark_report(
+			BENCHMARK_NAME, metric,
+			(double)(allocations_after - allocations_before) /
+			messages,
+			""
+		);
+	}
+	return failed;
+}
+
+static uint64_t benchmark_target(const struct parser_target *target,
+				 const uint64_t iterations)
+{
+	struct corpus corpus;
+	char metric[64];
+	uint64_t failed = 0;
+
+	if (!corpus_load(&corpus, target->corpus)) {
+		fprintf(stderr, "Could not read the corpus at %s, invoke the benchmark from the main project directory.\n",
+			target->corpus);
+		corpus_free(&corpus);
+		return 1;
+	}
+
+	void *const state = target->create();
+
+	if (!state) {
+		fprintf(stderr, "Could not create the %s parser.\n",
+			target->name);
+		corpus_free(&corpus);
+		return 1;
+	}
+
+	snprintf(metric, sizeof(metric), "%s_messages", target->name);
+	benchmark_report(BENCHMARK_NAME, metric, corpus.count, "");
+	snprintf(metric, sizeof(metric), "%s_bytes", target->name);
+	benchmark_report(BENCHMARK_NAME, metric, corpus.total_length, "B");
+
+	for (size_t i = 0; i < parser_chunk_length_count; i++)
+		failed += run(target, state, &corpus, parser_chunk_lengths[i],
+			      iterations);
+
+	target->destroy(state);
+	corpus_free(&corpus);
+	return failed;
+}
+
+int benchmark_parsers(int argc, char *argv[])
+{
+	const uint64_t iterations = benchmark_arg_u64(
+		argc, argv, 0, DEFAULT_ITERATIONS
+	);
+	const char *const name = argc > 1 ? argv[1] : NULL;
+	uint64_t failed = 0;
+
+	if (iterations == 0 || (name && !parser_target_find(name))) {
+		fprintf(stderr, "Invalid arguments.\n");
+		return 1;
+	}
+
+	for (size_t i = 0; i < parser_target_count; i++) {
+		if (!name || strcmp(name, parser_targets[i].name) == 0)
+			failed += benchmark_target(&parser_targets[i],
+						   iterations);
+	}
+
+	benchmark_report(BENCHMARK_NAME, "failed", failed, "");
+	return failed == 0 ? 0 : 1;
+}
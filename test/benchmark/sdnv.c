@@ -0,0 +1,262 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "benchmark.h"
+
+#include "bundle6/create.h"
+#include "bundle6/parser.h"
+#include "bundle6/sdnv.h"
+#include "bundle6/serializer.h"
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/common.h"
+#include "ud3tn/parser.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCHMARK_NAME "sdnv"
+
+#define DEFAULT_VALUES 1000000
+#define DEFAULT_BUNDLES 100000
+#define PAYLOAD_LENGTH 64
+
+struct memory_sink {
+	uint8_t *data;
+	size_t length;
+	size_t capacity;
+};
+
+static void write_to_memory(void *obj, const void *data, const size_t length)
+{
+	struct memory_sink *const sink = obj;
+
+	if (sink->data && sink->length + length <= sink->capacity)
+		memcpy(sink->data + sink->length, data, length);
+	sink->length += length;
+}
+
+static void receive_bundle(struct bundle *bundle, void *param)
+{
+	struct bundle **const result = param;
+
+	*result = bundle;
+}
+
+// Values of all SDNV lengths, with small values being more likely.
+static uint64_t next_value(uint64_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state >> (*state % 64);
+}
+
+static uint64_t decode_bytewise(const uint8_t *buffer, const size_t length,
+				uint64_t *sum)
+{
+	struct sdnv_state state;
+	uint64_t value, count = 0;
+	size_t pos = 0;
+
+	while (pos < length) {
+		sdnv_reset(&state);
+		while (state.status == SDNV_IN_PROGRESS && pos < length)
+			sdnv_read_u64(&state, &value, buffer[pos++]);
+		if (state.status != SDNV_DONE)
+			break;
+		*sum += value;
+		count++;
+	}
+	return count;
+}
+
+static uint64_t decode_bulk(const uint8_t *buffer, const size_t length,
+			    uint64_t *sum)
+{
+	uint64_t value, count = 0;
+	size_t pos = 0;
+
+	while (pos < length) {
+		const int_fast8_t size = sdnv_decode_u64(
+			buffer + pos, length - pos, &value
+		);
+
+		if (size == 0)
+			break;
+		pos += size;
+		*sum += value;
+		count++;
+	}
+	return count;
+}
+
+// Pass the serialized bundle to the parser in chunks of the given size.
+static bool parse(struct bundle6_parser *parser, struct bundle **bundle,
+		  const struct memory_sink *wire, const size_t chunk_length)
+{
+	struct parser *const p = parser->basedata;
+	size_t pos = 0;
+
+	*bundle = NULL;
+	bundle6_parser_reset(parser);
+	while (pos < wire->length && p->status == PARSER_STATUS_GOOD) {
+		if (p->flags & PARSER_FLAG_BULK_READ) {
+			if (p->next_bytes > wire->length - pos)
+				return false;
+			memcpy(p->next_buffer, wire->data + pos, p->next_bytes);
+			pos += p->next_bytes;
+			p->flags &= ~PARSER_FLAG_BULK_READ;
+			bundle6_parser_read(parser, NULL, 0);
+			continue;
+		}
+
+		const size_t length = MIN(chunk_length, wire->length - pos);
+
+		pos += bundle6_parser_read(parser, wire->data + pos, length);
+	}
+
+	return p->status == PARSER_STATUS_DONE && *bundle != NULL;
+}
+
+static uint64_t run_parser(const char *const mode,
+			   struct bundle6_parser *parser, struct bundle **bundle,
+			   const struct memory_sink *wire,
+			   const size_t chunk_length, const uint64_t bundles)
+{
+	char metric[64];
+	uint64_t ns = 0, failed = 0;
+
+	for (uint64_t i = 0; i < bundles; i++) {
+		const uint64_t start_ns = benchmark_time_ns();
+
+		if (!parse(parser, bundle, wire, chunk_length))
+			failed++;
+		ns += benchmark_time_ns() - start_ns;
+		bundle_free(*bundle);
+	}
+
+	snprintf(metric, sizeof(metric), "%s_bundles_per_second", mode);
+	benchmark_report(BENCHMARK_NAME, metric,
+			 ns ? (double)bundles * 1e9 / ns : 0, "1/s");
+	return failed;
+}
+
+static uint64_t benchmark_parser(const uint64_t bundles)
+{
+	struct memory_sink wire = { .data = NULL };
+	struct bundle6_parser parser;
+	struct bundle *prototype;
+	struct bundle *bundle = NULL;
+	uint64_t failed = 1;
+
+	// A small bundle between two CBHE endpoints, mostly consisting of SDNVs
+	prototype = bundle6_create_local(
+		calloc(1, PAYLOAD_LENGTH), PAYLOAD_LENGTH,
+		"ipn:4242.1", "ipn:123456.7",
+		1700000000000, 42, 86400000, BUNDLE_FLAG_NONE
+	);
+	if (!prototype) {
+		fprintf(stderr, "Could not create bundle.\n");
+		return failed;
+	}
+	wire.capacity = bundle_get_serialized_size(prototype);
+	wire.data = malloc(wire.capacity);
+	if (!wire.data ||
+	    bundle6_serialize(prototype, write_to_memory, &wire) != UD3TN_OK ||
+	    wire.length != wire.capacity) {
+		fprintf(stderr, "Could not serialize bundle.\n");
+		goto out;
+	}
+	if (!bundle6_parser_init(&parser, receive_bundle, &bundle)) {
+		fprintf(stderr, "Could not initialize parser.\n");
+		goto out;
+	}
+
+	benchmark_report(BENCHMARK_NAME, "bundle6_serialized_size",
+			 wire.length, "B");
+	// SDNVs decoded at once
+	failed = run_parser("bundle6_whole", &parser, &bundle, &wire,
+			    wire.length, bundles);
+	// SDNVs split across calls, decoded by the byte-wise state machine
+	failed += run_parser("bundle6_bytewise", &parser, &bundle, &wire, 1,
+			     bundles);
+	bundle6_parser_deinit(&parser);
+
+out:
+	bundle_free(prototype);
+	free(wire.data);
+	return failed;
+}
+
+int benchmark_sdnv(int argc, char *argv[])
+{
+	const uint64_t values = benchmark_arg_u64(
+		argc, argv, 0, DEFAULT_VALUES
+	);
+	const uint64_t bundles = benchmark_arg_u64(
+		argc, argv, 1, DEFAULT_BUNDLES
+	);
+	uint64_t state = 88172645463325252;
+	uint64_t sum = 0, bytewise_sum = 0, bulk_sum = 0;
+	uint64_t failed = 0;
+	size_t length = 0;
+
+	if (values == 0 || values > SIZE_MAX / MAX_SDNV_SIZE) {
+		fprintf(stderr, "Invalid arguments.\n");
+		return 1;
+	}
+
+	uint8_t *const buffer = malloc(values * MAX_SDNV_SIZE);
+
+	if (!buffer) {
+		fprintf(stderr, "Could not allocate buffer.\n");
+		return 1;
+	}
+	// Do not let the first write pay for faulting in the pages.
+	memset(buffer, 0, values * MAX_SDNV_SIZE);
+
+	uint64_t start_ns = benchmark_time_ns();
+
+	for (uint64_t i = 0; i < values; i++) {
+		const uint64_t value = next_value(&state);
+
+		length += sdnv_write_u64(buffer + length, value);
+		sum += value;
+	}
+
+	const uint64_t write_ns = benchmark_time_ns() - start_ns;
+
+	start_ns = benchmark_time_ns();
+	if (decode_bytewise(buffer, length, &bytewise_sum) != values)
+		failed++;
+
+	const uint64_t bytewise_ns = benchmark_time_ns() - start_ns;
+
+	start_ns = benchmark_time_ns();
+	if (decode_bulk(buffer, length, &bulk_sum) != values)
+		failed++;
+
+	const uint64_t bulk_ns = benchmark_time_ns() - start_ns;
+
+	if (bytewise_sum != sum || bulk_sum != sum)
+		failed++;
+	free(buffer);
+
+	benchmark_report(BENCHMARK_NAME, "bytes_per_value",
+			 (double)length / values, "B");
+	benchmark_report(BENCHMARK_NAME, "write_per_value",
+			 (double)write_ns / values, "ns");
+	benchmark_report(BENCHMARK_NAME, "read_bytewise_per_value",
+			 (double)bytewise_ns / values, "ns");
+	benchmark_report(BENCHMARK_NAME, "decode_per_value",
+			 (double)bulk_ns / values, "ns");
+
+	if (bundles != 0)
+		failed += benchmark_parser(bundles);
+
+	benchmark_report(BENCHMARK_NAME, "failed", failed, "");
+	return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "benchmark.h"
+
+#include "bundle7/create.h"
+#include "bundle7/reports.h"
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/eid_intern.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCHMARK_NAME "status_report"
+
+#define DEFAULT_REPORTS 1000000
+#define DEFAULT_ENDPOINTS 64
+#define PAYLOAD_LENGTH 64
+
+#define LOCAL_EID "ipn:1.0"
+#define TIMESTAMP_MS 1700000000000
+
+// Creates bundles to be reported on, distributed over the given number of
+// report-to endpoints, as received from a flood of bundles requesting reports.
+static struct bundle **create_bundles(const uint64_t endpoints)
+{
+	struct bundle **const bundles = calloc(endpoints, sizeof(*bundles));
+	char eid[32];
+
+	if (!bundles)
+		return NULL;
+	for (uint64_t i = 0; i < endpoints; i++) {
+		snprintf(eid, sizeof(eid), "ipn:%llu.1",
+			 (unsigned long long)i + 2);
+		bundles[i] = bundle7_create_local(
+			calloc(1, PAYLOAD_LENGTH), PAYLOAD_LENGTH,
+			eid, "ipn:4242.1",
+			TIMESTAMP_MS, i, 86400000,
+			BUNDLE_FLAG_REPORT_RECEPTION |
+			BUNDLE_FLAG_REPORT_STATUS_TIME
+		);
+		if (!bundles[i])
+			return bundles;
+		eid_intern_release(bundles[i]->report_to);
+		bundles[i]->report_to = eid_intern(eid);
+	}
+	return bundles;
+}
+
+static uint64_t run(const char *const mode,
+		    const struct bundle7_report_template *template,
+		    struct bundle **bundles, const uint64_t endpoints,
+		    const uint64_t reports)
+{
+	const struct bundle_status_report report = {
+		.status = BUNDLE_SR_FLAG_BUNDLE_RECEIVED,
+		.reason = BUNDLE_SR_REASON_NO_INFO,
+		.bundle_received_time = TIMESTAMP_MS + 1000,
+	};
+	char metric[64];
+	uint64_t failed = 0;
+
+	const uint64_t start_ns = benchmark_time_ns();
+
+	for (uint64_t i = 0; i < reports; i++) {
+		const struct bundle *const bundle = bundles[i % endpoints];
+		struct bundle *result = (
+			template
+			? bundle7_generate_status_report_templated(
+				template, bundle, &report, TIMESTAMP_MS + 1000
+			)
+			: bundle7_generate_status_report(
+				bundle, &report, LOCAL_EID, TIMESTAMP_MS + 1000
+			)
+		);
+
+		if (!result)
+			failed++;
+		bundle_free(result);
+	}
+
+	const uint64_t ns = benchmark_time_ns() - start_ns;
+
+	snprintf(metric, sizeof(metric), "%s_reports_per_second", mode);
+	benchmark_report(BENCHMARK_NAME, metric,
+			 ns ? (double)reports * 1e9 / ns : 0, "1/s");
+	snprintf(metric, sizeof(metric), "%s_per_report", mode);
+	benchmark_report(BENCHMARK_NAME, metric, (double)ns / reports, "ns");
+	return failed;
+}
+
+int benchmark_status_report(int argc, char *argv[])
+{
+	const uint64_t reports = benchmark_arg_u64(
+		argc, argv, 0, DEFAULT_REPORTS
+	);
+	const uint64_t endpoints = benchmark_arg_u64(
+		argc, argv, 1, DEFAULT_ENDPOINTS
+	);
+	struct bundle7_report_template template;
+	struct bundle **bundles;
+	uint64_t failed = 0;
+
+	if (reports == 0 || endpoints == 0 || endpoints > reports) {
+		fprintf(stderr, "Invalid arguments.\n");
+		return 1;
+	}
+
+	bundles = create_bundles(endpoints);
+	if (!bundles || !bundles[endpoints - 1] ||
+	    bundle7_report_template_init(&template, LOCAL_EID) != UD3TN_OK) {
+		fprintf(stderr, "Could not create bundles.\n");
+		failed++;
+		goto out;
+	}
+
+	const size_t interned = eid_intern_get_count();
+
+	failed += run("untemplated", NULL, bundles, endpoints, reports);
+	failed += run("templated", &template, bundles, endpoints, reports);
+
+	// Generating the reports must not leave any EIDs behind.
+	if (eid_intern_get_count() != interned)
+		failed++;
+	bundle7_report_template_deinit(&template);
+
+out:
+	for (uint64_t i = 0; bundles && i < endpoints; i++)
+		bundle_free(bundles[i]);
+	free(bundles);
+
+	benchmark_report(BENCHMARK_NAME, "failed", failed, "");
+	return failed == 0 ? 0 : 1;
+}
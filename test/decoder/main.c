@@ -18,6 +18,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 // GENERIC CLA EMULATION
@@ -110,19 +111,21 @@ static enum ud3tn_result parse_until_done(
 		.parse_param = parse_param,
 		.error = false,
 	};
-	link.base.rx_task_data.input_buffer.end = (
-		&link.base.rx_task_data.input_buffer.start[0]
-	);
 
 	// See cla_contact_rx_task in cla_contact_rx_task.c
 	struct rx_task_data *rx_data = &link.base.rx_task_data;
-	uint8_t *parsed;
+
+	rx_data->input_buffer.start = malloc(CLA_RX_BUFFER_SIZE);
+	if (!rx_data->input_buffer.start)
+		return UD3TN_FAIL;
+	rx_data->input_buffer.read = rx_data->input_buffer.start;
+	rx_data->input_buffer.end = rx_data->input_buffer.start;
 
 	for (;;) {
 		if (HAS_FLAG(rx_data->cur_parser->flags, PARSER_FLAG_BULK_READ))
-			parsed = rx_bulk_read(&link.base);
+			rx_bulk_read(&link.base);
 		else
-			parsed = rx_chunk_read(&link.base);
+			rx_chunk_read(&link.base);
 
 		if (rx_data->cur_parser->status == PARSER_STATUS_ERROR) {
 			fprintf(stderr, "Parser error reported, aborting.\n");
@@ -137,26 +140,10 @@ static enum ud3tn_result parse_until_done(
 			fprintf(stderr, "Parser reset detected, aborting.\n");
 			break;
 		}
-
-		/* The whole input buffer was consumed, reset it. */
-		if (parsed == rx_data->input_buffer.end) {
-			rx_data->input_buffer.end = rx_data->input_buffer.start;
-		} else if (parsed != rx_data->input_buffer.start) {
-			ASSERT(parsed > rx_data->input_buffer.start);
-			memmove(rx_data->input_buffer.start,
-				parsed,
-				rx_data->input_buffer.end - parsed);
-			rx_data->input_buffer.end -=
-				parsed - rx_data->input_buffer.start;
-		} else if (rx_data->input_buffer.end ==
-			 rx_data->input_buffer.start + CLA_RX_BUFFER_SIZE) {
-			fprintf(stderr, "Error: Parsing buffer full, reset.\n");
-			link.error = true;
-			rx_data->input_buffer.end = rx_data->input_buffer.start;
-			break;
-		}
 	}
 
+	free(rx_data->input_buffer.start);
+
 	if (link.error || rx_data->cur_parser->status != PARSER_STATUS_DONE)
 		return UD3TN_FAIL;
 
@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "parser_targets.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// libFuzzer entry points, see https://llvm.org/docs/LibFuzzer.html
+int LLVMFuzzerInitialize(int *argc, char ***argv);
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static const struct parser_target *target;
+static void *target_state;
+
+int LLVMFuzzerInitialize(int *argc, char ***argv)
+{
+	const char *const name = getenv("UD3TN_FUZZ_TARGET");
+
+	(void)argc;
+	(void)argv;
+
+	target = parser_target_find(name);
+	if (!target) {
+		fprintf(stderr, "Set UD3TN_FUZZ_TARGET to one of:");
+		for (size_t i = 0; i < parser_target_count; i++)
+			fprintf(stderr, " %s", parser_targets[i].name);
+		fprintf(stderr, "\n");
+		exit(EXIT_FAILURE);
+	}
+
+	// Like in the CLA RX task, the parser is kept across messages.
+	target_state = target->create();
+	if (!target_state) {
+		fprintf(stderr, "Could not create the %s parser.\n",
+			target->name);
+		exit(EXIT_FAILURE);
+	}
+	return 0;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	// Derive the chunk size from the input, so that the corpus files can
+	// be shared with the benchmark and every crash is reproducible.
+	const size_t chunk_length = parser_chunk_lengths[
+		size % parser_chunk_length_count
+	];
+
+	target->parse(target_state, data, size, chunk_length);
+	return 0;
+}
@@ -0,0 +1,507 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "parser_targets.h"
+
+#include "aap/aap.h"
+#include "aap/aap_parser.h"
+
+#include "agents/config_parser.h"
+
+#include "bundle6/parser.h"
+#include "bundle7/parser.h"
+
+#include "cla/bibe_proto.h"
+#include "cla/mtcp_proto.h"
+#include "cla/posix/cla_tcpclv3_proto.h"
+
+#include "spp/spp.h"
+#include "spp/spp_parser.h"
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/common.h"
+#include "ud3tn/node.h"
+#include "ud3tn/parser.h"
+#include "ud3tn/router.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef size_t (*read_func_t)(void *, const uint8_t *, size_t);
+
+/*
+ * Passes the message to the parser like the CLA RX task does (see
+ * buffer_read() and rx_bulk_read() in cla_contact_rx_task.c): "receiving"
+ * up to chunk_length further bytes whenever the parser cannot make progress
+ * with the bytes received but not yet consumed, and serving bulk reads from
+ * the remainder of the message. Stops when the parser leaves the GOOD state.
+ *
+ * Returns whether the parser finished and stores the number of bytes
+ * consumed from the message.
+ */
+static bool feed(struct parser *const p, const read_func_t read, void *obj,
+		 const uint8_t *const data, const size_t length,
+		 const size_t chunk_length, size_t *const consumed)
+{
+	const size_t chunk = chunk_length ? chunk_length : length;
+	size_t pos = 0, received = 0;
+
+	while (p->status == PARSER_STATUS_GOOD) {
+		if (HAS_FLAG(p->flags, PARSER_FLAG_BULK_READ)) {
+			if (p->next_bytes > length - pos)
+				break;
+			memcpy(p->next_buffer, data + pos, p->next_bytes);
+			pos += p->next_bytes;
+			received = MAX(received, pos);
+			p->flags &= ~PARSER_FLAG_BULK_READ;
+			read(obj, NULL, 0);
+			continue;
+		}
+
+		const size_t parsed = (
+			pos < received
+			? read(obj, data + pos, received - pos)
+			: 0
+		);
+
+		pos += parsed;
+		if (parsed != 0 || p->status != PARSER_STATUS_GOOD ||
+		    HAS_FLAG(p->flags, PARSER_FLAG_BULK_READ))
+			continue;
+		// Nothing consumed: the parser is waiting for more data.
+		if (received == length)
+			break;
+		received += MIN(chunk, length - received);
+	}
+
+	*consumed = pos;
+	return p->status == PARSER_STATUS_DONE;
+}
+
+static void store_bundle(struct bundle *bundle, void *param)
+{
+	struct bundle **const result = param;
+
+	bundle_free(*result);
+	*result = bundle;
+}
+
+// BPv6
+
+struct bundle6_target {
+	struct bundle6_parser parser;
+	struct bundle *result;
+};
+
+static size_t read_bundle6(void *obj, const uint8_t *buffer, size_t length)
+{
+	struct bundle6_target *const t = obj;
+
+	return bundle6_parser_read(&t->parser, buffer, length);
+}
+
+static void *create_bundle6(void)
+{
+	struct bundle6_target *const t = calloc(1, sizeof(*t));
+
+	if (t && !bundle6_parser_init(&t->parser, store_bundle, &t->result)) {
+		free(t);
+		return NULL;
+	}
+	return t;
+}
+
+static bool parse_bundle6(void *state, const uint8_t *data, size_t length,
+			  size_t chunk_length)
+{
+	struct bundle6_target *const t = state;
+	size_t consumed;
+
+	bundle6_parser_reset(&t->parser);
+
+	const bool done = feed(t->parser.basedata, read_bundle6, t,
+			       data, length, chunk_length, &consumed);
+	const bool success = done && t->result != NULL;
+
+	bundle_free(t->result);
+	t->result = NULL;
+	return success;
+}
+
+static void destroy_bundle6(void *state)
+{
+	struct bundle6_target *const t = state;
+
+	bundle6_parser_deinit(&t->parser);
+	free(t);
+}
+
+// BPv7
+
+struct bundle7_target {
+	struct bundle7_parser parser;
+	struct bundle *result;
+};
+
+static size_t read_bundle7(void *obj, const uint8_t *buffer, size_t length)
+{
+	struct bundle7_target *const t = obj;
+
+	return bundle7_parser_read(&t->parser, buffer, length);
+}
+
+static void *create_bundle7(void)
+{
+	struct bundle7_target *const t = calloc(1, sizeof(*t));
+
+	if (t && !bundle7_parser_init(&t->parser, store_bundle, &t->result)) {
+		free(t);
+		return NULL;
+	}
+	return t;
+}
+
+static bool parse_bundle7(void *state, const uint8_t *data, size_t length,
+			  size_t chunk_length)
+{
+	struct bundle7_target *const t = state;
+	size_t consumed;
+
+	bundle7_parser_reset(&t->parser);
+
+	const bool done = feed(t->parser.basedata, read_bundle7, t,
+			       data, length, chunk_length, &consumed);
+	const bool success = done && t->result != NULL;
+
+	bundle_free(t->result);
+	t->result = NULL;
+	return success;
+}
+
+static void destroy_bundle7(void *state)
+{
+	struct bundle7_target *const t = state;
+
+	bundle7_parser_deinit(&t->parser);
+	free(t);
+}
+
+// AAP
+
+static size_t read_aap(void *obj, const uint8_t *buffer, size_t length)
+{
+	return aap_parser_read(obj, buffer, length);
+}
+
+static void *create_aap(void)
+{
+	struct aap_parser *const parser = malloc(sizeof(*parser));
+
+	if (!parser)
+		return NULL;
+	aap_parser_init(parser);
+	// Like the application agent, see application_agent.c
+	parser->max_payload_length = BUNDLE_MAX_SIZE;
+	return parser;
+}
+
+static bool parse_aap(void *state, const uint8_t *data, size_t length,
+		      size_t chunk_length)
+{
+	struct aap_parser *const parser = state;
+	size_t consumed;
+
+	aap_parser_reset(parser);
+
+	const bool done = feed(parser->basedata, read_aap, parser,
+			       data, length, chunk_length, &consumed);
+	struct aap_message message = aap_parser_extract_message(parser);
+	const bool success = done && message.type != AAP_MESSAGE_INVALID;
+
+	aap_message_clear(&message);
+	return success;
+}
+
+static void destroy_aap(void *state)
+{
+	aap_parser_deinit(state);
+	free(state);
+}
+
+// SPP (the space packet header, the data is left to the bundle parsers)
+
+struct spp_target {
+	struct spp_parser parser;
+	struct spp_context_t *context;
+};
+
+static size_t read_spp(void *obj, const uint8_t *buffer, size_t length)
+{
+	struct spp_target *const t = obj;
+	const size_t parsed = spp_parser_read(&t->parser, buffer, length);
+
+	// See invoke_spp_parser() in test/decoder/main.c
+	if (t->parser.state == SPP_PARSER_STATE_DATA_SUBPARSER)
+		t->parser.base.status = PARSER_STATUS_DONE;
+	else if (t->parser.state == SPP_PARSER_STATE_SH_ANCILLARY_SUBPARSER)
+		t->parser.base.status = PARSER_STATUS_ERROR;
+	return parsed;
+}
+
+static void *create_spp(void)
+{
+	struct spp_target *const t = calloc(1, sizeof(*t));
+
+	if (!t)
+		return NULL;
+	t->context = spp_new_context();
+	if (!t->context || !spp_parser_init(&t->parser, t->context)) {
+		spp_free_context(t->context);
+		free(t);
+		return NULL;
+	}
+	return t;
+}
+
+static bool parse_spp(void *state, const uint8_t *data, size_t length,
+		      size_t chunk_length)
+{
+	struct spp_target *const t = state;
+	struct spp_meta_t meta;
+	size_t consumed, data_length;
+
+	spp_parser_reset(&t->parser);
+
+	const bool done = feed(&t->parser.base, read_spp, t,
+			       data, length, chunk_length, &consumed);
+
+	return (
+		done &&
+		spp_parser_get_meta(&t->parser, &meta) &&
+		spp_parser_get_data_length(&t->parser, &data_length) &&
+		data_length <= length - consumed
+	);
+}
+
+static void destroy_spp(void *state)
+{
+	struct spp_target *const t = state;
+
+	spp_free_context(t->context);
+	free(t);
+}
+
+// Configuration agent
+
+struct config_target {
+	struct config_parser parser;
+	struct router_command *result;
+};
+
+static void store_router_command(void *param, struct router_command *cmd)
+{
+	struct config_target *const t = param;
+
+	t->result = cmd;
+}
+
+static void free_router_command(struct router_command *const cmd)
+{
+	if (!cmd)
+		return;
+	if (cmd->data)
+		free_node(cmd->data);
+	free(cmd);
+}
+
+static size_t read_config(void *obj, const uint8_t *buffer, size_t length)
+{
+	struct config_target *const t = obj;
+
+	return config_parser_read(&t->parser, buffer, length);
+}
+
+static void *create_config(void)
+{
+	struct config_target *const t = calloc(1, sizeof(*t));
+
+	if (t && !config_parser_init(&t->parser, store_router_command, t)) {
+		free(t);
+		return NULL;
+	}
+	return t;
+}
+
+static bool parse_config(void *state, const uint8_t *data, size_t length,
+			 size_t chunk_length)
+{
+	struct config_target *const t = state;
+	size_t consumed;
+
+	config_parser_reset(&t->parser);
+
+	const bool done = feed(t->parser.basedata, read_config, t,
+			       data, length, chunk_length, &consumed);
+	const bool success = done && t->result != NULL;
+
+	free_router_command(t->result);
+	t->result = NULL;
+	return success;
+}
+
+static void destroy_config(void *state)
+{
+	struct config_target *const t = state;
+
+	// There is no deinit function, the agent keeps its parser forever.
+	free_router_command(t->parser.router_command);
+	free(t->parser.current_int_data);
+	free(t->parser.basedata);
+	free(t);
+}
+
+// MTCP (the framing, the bundle is left to the bundle parsers)
+
+static size_t read_mtcp(void *obj, const uint8_t *buffer, size_t length)
+{
+	struct parser *const parser = obj;
+	const size_t parsed = mtcp_parser_parse(parser, buffer, length);
+
+	// The CLA passes the following next_bytes bytes to a bundle parser.
+	if (HAS_FLAG(parser->flags, PARSER_FLAG_DATA_SUBPARSER))
+		parser->status = PARSER_STATUS_DONE;
+	return parsed;
+}
+
+static void *create_mtcp(void)
+{
+	return malloc(sizeof(struct parser));
+}
+
+static bool parse_mtcp(void *state, const uint8_t *data, size_t length,
+		       size_t chunk_length)
+{
+	struct parser *const parser = state;
+	size_t consumed;
+
+	mtcp_parser_reset(parser);
+
+	const bool done = feed(parser, read_mtcp, parser,
+			       data, length, chunk_length, &consumed);
+
+	// Invalid headers are skipped byte by byte by the parser.
+	return done && consumed != 0 && parser->next_bytes == length - consumed;
+}
+
+static void destroy_mtcp(void *state)
+{
+	free(state);
+}
+
+// TCPCLv3 (the data segment header, the bundle is left to the bundle parsers)
+
+static size_t read_tcpclv3(void *obj, const uint8_t *buffer, size_t length)
+{
+	struct tcpclv3_parser *const parser = obj;
+	const size_t parsed = tcpclv3_parser_read(parser, buffer, length);
+
+	if (parser->stage == TCPCLV3_FORWARD_BUNDLE)
+		parser->basedata.status = PARSER_STATUS_DONE;
+	return parsed;
+}
+
+static void *create_tcpclv3(void)
+{
+	struct tcpclv3_parser *const parser = malloc(sizeof(*parser));
+
+	if (parser)
+		tcpclv3_parser_init(parser);
+	return parser;
+}
+
+static bool parse_tcpclv3(void *state, const uint8_t *data, size_t length,
+			  size_t chunk_length)
+{
+	struct tcpclv3_parser *const parser = state;
+	size_t consumed;
+
+	tcpclv3_parser_reset(parser);
+	sdnv_reset(&parser->sdnv_state);
+
+	const bool done = feed(&parser->basedata, read_tcpclv3, parser,
+			       data, length, chunk_length, &consumed);
+
+	return done && parser->fragment_size == length - consumed;
+}
+
+static void destroy_tcpclv3(void *state)
+{
+	struct tcpclv3_parser *const parser = state;
+
+	tcpclv3_parser_reset(parser);
+	free(parser);
+}
+
+// BIBE (a protocol data unit, which is always parsed as a whole)
+
+static void *create_bibe(void)
+{
+	// The parser is stateless.
+	return malloc(1);
+}
+
+static bool parse_bibe(void *state, const uint8_t *data, size_t length,
+		       size_t chunk_length)
+{
+	struct bibe_protocol_data_unit bpdu;
+
+	(void)state;
+	(void)chunk_length;
+	if (bibe_parser_parse(data, length, &bpdu) != 0)
+		return false;
+	// The encapsulated bundle is referenced in place.
+	return (
+		bpdu.encapsulated_bundle >= data &&
+		bpdu.payload_length <= length &&
+		bpdu.encapsulated_bundle + bpdu.payload_length <= data + length
+	);
+}
+
+static void destroy_bibe(void *state)
+{
+	free(state);
+}
+
+#define TARGET(name, corpus) \
+	{ #name, corpus, create_##name, parse_##name, destroy_##name }
+
+const struct parser_target parser_targets[] = {
+	TARGET(bundle6, "test/decoder/examples/bpv6_test"),
+	TARGET(bundle7, "test/decoder/examples/bpv7_test"),
+	TARGET(aap, "test/decoder/examples/aap_test"),
+	TARGET(spp, "test/decoder/examples/spp_test"),
+	TARGET(config, "test/decoder/examples/config_test"),
+	TARGET(mtcp, "test/decoder/examples/mtcp_test"),
+	TARGET(tcpclv3, "test/decoder/examples/tcpclv3_test"),
+	TARGET(bibe, "test/decoder/examples/bibe_test"),
+};
+
+const size_t parser_target_count = (
+	sizeof(parser_targets) / sizeof(parser_targets[0])
+);
+
+const size_t parser_chunk_lengths[] = { 1, 64, 4096, 0 };
+
+const size_t parser_chunk_length_count = (
+	sizeof(parser_chunk_lengths) / sizeof(parser_chunk_lengths[0])
+);
+
+const struct parser_target *parser_target_find(const char *name)
+{
+	for (size_t i = 0; name && i < parser_target_count; i++) {
+		if (strcmp(parser_targets[i].name, name) == 0)
+			return &parser_targets[i];
+	}
+	return NULL;
+}
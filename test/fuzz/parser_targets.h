@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef PARSER_TARGETS_H_INCLUDED
+#define PARSER_TARGETS_H_INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A wire parser driven like the CLA RX task drives it, shared by the parser
+ * benchmark and the libFuzzer entry points.
+ */
+struct parser_target {
+	const char *name;
+	// Directory of the corpus, relative to the main project directory.
+	const char *corpus;
+	// Creates the parser state, which is reused for all messages.
+	void *(*create)(void);
+	/**
+	 * Parses a single message, passing it to the parser in chunks of at
+	 * most chunk_length bytes (zero meaning all at once) and releasing
+	 * the result afterwards. Returns whether the message has been parsed
+	 * successfully and completely.
+	 */
+	bool (*parse)(void *state, const uint8_t *data, size_t length,
+		      size_t chunk_length);
+	void (*destroy)(void *state);
+};
+
+extern const struct parser_target parser_targets[];
+extern const size_t parser_target_count;
+
+// The chunk sizes messages are passed in: 1 B, 64 B, 4 KiB and as a whole (0)
+extern const size_t parser_chunk_lengths[];
+extern const size_t parser_chunk_length_count;
+
+/**
+ * @brief Look up the target of the given name, or return NULL.
+ */
+const struct parser_target *parser_target_find(const char *name);
+
+#endif /* PARSER_TARGETS_H_INCLUDED */
@@ -14,10 +14,15 @@
 
 # To use TCPCL instead MTCP, replace "mtcp" with "tcpclv3" in this file.
 
+# The optional fourth argument sets the number of BP worker threads of the
+# two forwarding instances (default: 1). To assess how throughput scales with
+# the number of workers, run the test with 1, 2, 4, and 8 workers and compare
+# the resulting traffic, e.g. using iftop (see below).
+
 set -e
 
 if [[ -z "$1" || -z "$2" || -z "$3" ]]; then
-    echo "Usage: $0 <ud3tn-dir> <runas-user> <bundle-size-bytes>" >&2
+    echo "Usage: $0 <ud3tn-dir> <runas-user> <bundle-size-bytes> [<bp-workers>]" >&2
 fi
 
 if [[ "$EUID" -ne 0 ]]; then
@@ -29,6 +34,7 @@ set -u
 WORK_DIR="$1"
 RUNAS_USER=$2
 BUNDLE_SIZE=$3
+BP_WORKERS=${4:-1}
 SOCK_DIR="$(mktemp -d)"
 
 echo "Sockets and logs will be stored here: $SOCK_DIR" >&2
@@ -70,9 +76,9 @@ ip -netns $NS2 link set dev $VE2 up
 ip -netns $NS1 addr add "$IP1/24" dev $VE1
 ip -netns $NS2 addr add "$IP2/24" dev $VE2
 
-ip netns exec $NS1 sudo -u $RUNAS_USER "$WORK_DIR/build/posix/ud3tn" -c "mtcp:$IP1,4222" -e "dtn://ud3tn1.dtn/" -s "$SOCK_DIR/ud3tn1.socket" -S "$SOCK_DIR/ud3tn1.aap2.socket" > "$SOCK_DIR/ud3tn1.log" &
+ip netns exec $NS1 sudo -u $RUNAS_USER "$WORK_DIR/build/posix/ud3tn" -c "mtcp:$IP1,4222" -e "dtn://ud3tn1.dtn/" -W "$BP_WORKERS" -s "$SOCK_DIR/ud3tn1.socket" -S "$SOCK_DIR/ud3tn1.aap2.socket" > "$SOCK_DIR/ud3tn1.log" &
 UD3TN_1=$!
-ip netns exec $NS2 sudo -u $RUNAS_USER "$WORK_DIR/build/posix/ud3tn" -c "mtcp:$IP2,4222" -e "dtn://ud3tn2.dtn/" -s "$SOCK_DIR/ud3tn2.socket" -S "$SOCK_DIR/ud3tn2.aap2.socket" > "$SOCK_DIR/ud3tn2.log" &
+ip netns exec $NS2 sudo -u $RUNAS_USER "$WORK_DIR/build/posix/ud3tn" -c "mtcp:$IP2,4222" -e "dtn://ud3tn2.dtn/" -W "$BP_WORKERS" -s "$SOCK_DIR/ud3tn2.socket" -S "$SOCK_DIR/ud3tn2.aap2.socket" > "$SOCK_DIR/ud3tn2.log" &
 UD3TN_2=$!
 ip netns exec $NS1 sudo -u $RUNAS_USER "$WORK_DIR/build/posix/ud3tn" -c "mtcp:$IP1,4223" -e "dtn://ud3tn3.dtn/" -s "$SOCK_DIR/ud3tn3.socket" -S "$SOCK_DIR/ud3tn3.aap2.socket" > "$SOCK_DIR/ud3tn3.log" &
 UD3TN_3=$!
@@ -4,10 +4,16 @@
 void testud3tn(void)
 {
 	RUN_TEST_GROUP(simplehtab);
+	RUN_TEST_GROUP(hashtable);
+	RUN_TEST_GROUP(object_pool);
 	RUN_TEST_GROUP(sdnv);
 	RUN_TEST_GROUP(node);
 	RUN_TEST_GROUP(routingTable);
+	RUN_TEST_GROUP(router);
+	RUN_TEST_GROUP(admission_control);
+	RUN_TEST_GROUP(memory_budget);
 	RUN_TEST_GROUP(eid);
+	RUN_TEST_GROUP(eid_intern);
 	RUN_TEST_GROUP(crc);
 	RUN_TEST_GROUP(bundle6Create);
 	RUN_TEST_GROUP(bundle6ParserSerializer);
@@ -16,6 +22,7 @@ void testud3tn(void)
 	RUN_TEST_GROUP(bundle7Reports);
 	RUN_TEST_GROUP(bundle7Fragmentation);
 	RUN_TEST_GROUP(bundle7Create);
+	RUN_TEST_GROUP(bundle7Profile);
 	RUN_TEST_GROUP(spp);
 	RUN_TEST_GROUP(spp_parser);
 	RUN_TEST_GROUP(spp_timecodes);
@@ -26,6 +33,11 @@ void testud3tn(void)
 	RUN_TEST_GROUP(bibe_parser);
 	RUN_TEST_GROUP(bibe_validation);
 	RUN_TEST_GROUP(bundle);
+	RUN_TEST_GROUP(bundle_arena);
+	RUN_TEST_GROUP(cla_rx_task);
+	RUN_TEST_GROUP(cla_tx_task);
+	RUN_TEST_GROUP(agent_manager);
+	RUN_TEST_GROUP(bundle_processor);
 #ifdef PLATFORM_POSIX
 	RUN_TEST_GROUP(simple_queue);
 #endif // PLATFORM_POSIX
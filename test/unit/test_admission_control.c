@@ -0,0 +1,365 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/admission_control.h"
+#include "ud3tn/bundle.h"
+
+#include "bundle6/create.h"
+
+#include "testud3tn_unity.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+static struct admission_control_config saved_config;
+
+static struct bundle *create_bundle(const char *const destination,
+				    const size_t payload_length,
+				    const enum bundle_proc_flags flags)
+{
+	void *const payload = calloc(1, payload_length);
+
+	TEST_ASSERT_NOT_NULL(payload);
+
+	struct bundle *const b = bundle6_create_local(
+		payload, payload_length,
+		"dtn://sender/src", destination,
+		0, 1, 42000,
+		flags
+	);
+
+	TEST_ASSERT_NOT_NULL(b);
+	return b;
+}
+
+static void set_limits(const enum admission_policy policy,
+		       const uint64_t max_backlog_bytes,
+		       const uint64_t max_node_backlog_bytes)
+{
+	struct admission_control_config config = saved_config;
+
+	config.policy = policy;
+	config.max_backlog_bytes = max_backlog_bytes;
+	config.max_node_backlog_bytes = max_node_backlog_bytes;
+	config.low_priority_share = 50;
+	config.normal_priority_share = 75;
+	admission_control_update_config(config);
+}
+
+TEST_GROUP(admission_control);
+
+TEST_SETUP(admission_control)
+{
+	TEST_ASSERT_EQUAL(UD3TN_OK, admission_control_init());
+	saved_config = admission_control_get_config();
+}
+
+TEST_TEAR_DOWN(admission_control)
+{
+	struct bundle *b;
+
+	for (uint8_t owner = 0; owner < ADMISSION_DEFER_OWNER_COUNT; owner++)
+		while ((b = admission_control_pop_deferred(owner)) != NULL)
+			bundle_free(b);
+	admission_control_update_config(saved_config);
+	admission_control_free();
+}
+
+TEST(admission_control, accounting)
+{
+	struct bundle *b1 = create_bundle("dtn://a/x", 10, BUNDLE_FLAG_NONE);
+	struct bundle *b2 = create_bundle("dtn://a/y", 20, BUNDLE_FLAG_NONE);
+	struct admission_control_stats stats;
+
+	set_limits(ADMISSION_POLICY_NONE, 0, 0);
+	TEST_ASSERT_EQUAL(ADMISSION_ACCEPT, admission_control_admit(b1));
+	TEST_ASSERT_EQUAL(ADMISSION_ACCEPT, admission_control_admit(b2));
+	stats = admission_control_get_stats();
+	TEST_ASSERT_EQUAL_UINT64(30, stats.backlog_bytes);
+	TEST_ASSERT_EQUAL_UINT64(
+		30,
+		stats.backlog_bytes_by_priority[BUNDLE_RPRIO_LOW]
+	);
+	TEST_ASSERT_EQUAL_UINT64(2, stats.admitted_bundles);
+	TEST_ASSERT_EQUAL_UINT64(30, stats.admitted_bytes);
+
+	admission_control_release(b1);
+	admission_control_release(b2);
+	stats = admission_control_get_stats();
+	TEST_ASSERT_EQUAL_UINT64(0, stats.backlog_bytes);
+	TEST_ASSERT_EQUAL_UINT64(
+		0,
+		stats.backlog_bytes_by_priority[BUNDLE_RPRIO_LOW]
+	);
+
+	// Releasing more than admitted does not underflow.
+	admission_control_release(b1);
+	stats = admission_control_get_stats();
+	TEST_ASSERT_EQUAL_UINT64(0, stats.backlog_bytes);
+
+	bundle_free(b1);
+	bundle_free(b2);
+}
+
+TEST(admission_control, reject_global_limit)
+{
+	struct bundle *b1 = create_bundle("dtn://a/x", 60, BUNDLE_FLAG_NONE);
+	struct bundle *b2 = create_bundle("dtn://b/x", 60, BUNDLE_FLAG_NONE);
+	struct admission_control_stats stats;
+
+	set_limits(ADMISSION_POLICY_REJECT, 100, 0);
+	TEST_ASSERT_EQUAL(ADMISSION_ACCEPT, admission_control_admit(b1));
+	TEST_ASSERT_EQUAL(ADMISSION_REJECT, admission_control_check(b2));
+	TEST_ASSERT_EQUAL(ADMISSION_REJECT, admission_control_admit(b2));
+	stats = admission_control_get_stats();
+	TEST_ASSERT_EQUAL_UINT64(60, stats.backlog_bytes);
+	TEST_ASSERT_EQUAL_UINT64(1, stats.rejected_bundles);
+	TEST_ASSERT_EQUAL_UINT64(60, stats.rejected_bytes);
+
+	admission_control_release(b1);
+	TEST_ASSERT_EQUAL(ADMISSION_ACCEPT, admission_control_admit(b2));
+	admission_control_release(b2);
+
+	bundle_free(b1);
+	bundle_free(b2);
+}
+
+TEST(admission_control, reject_node_limit)
+{
+	struct bundle *b1 = create_bundle("dtn://a/x", 60, BUNDLE_FLAG_NONE);
+	struct bundle *b2 = create_bundle("dtn://b/x", 60, BUNDLE_FLAG_NONE);
+	struct bundle *b3 = create_bundle("dtn://a/y", 60, BUNDLE_FLAG_NONE);
+
+	set_limits(ADMISSION_POLICY_REJECT, 0, 100);
+	TEST_ASSERT_EQUAL(ADMISSION_ACCEPT, admission_control_admit(b1));
+	TEST_ASSERT_EQUAL(ADMISSION_ACCEPT, admission_control_admit(b2));
+	// Same destination node as b1
+	TEST_ASSERT_EQUAL(ADMISSION_REJECT, admission_control_admit(b3));
+
+	admission_control_release(b1);
+	TEST_ASSERT_EQUAL(ADMISSION_ACCEPT, admission_control_admit(b3));
+	admission_control_release(b2);
+	admission_control_release(b3);
+	TEST_ASSERT_EQUAL_UINT64(0, admission_control_get_stats().backlog_bytes);
+
+	bundle_free(b1);
+	bundle_free(b2);
+	bundle_free(b3);
+}
+
+TEST(admission_control, drop_lowest_priority_first)
+{
+	struct bundle *low = create_bundle("dtn://a/x", 60, BUNDLE_FLAG_NONE);
+	struct bundle *high = create_bundle(
+		"dtn://a/x", 60,
+		BUNDLE_V6_FLAG_EXPEDITED_PRIORITY
+	);
+
+	set_limits(ADMISSION_POLICY_DROP_LOWEST, 100, 0);
+	// Low-priority bundles may use 50% of the limit.
+	TEST_ASSERT_EQUAL(ADMISSION_REJECT, admission_control_admit(low));
+	TEST_ASSERT_EQUAL(ADMISSION_ACCEPT, admission_control_admit(high));
+	TEST_ASSERT_EQUAL_UINT64(
+		60,
+		admission_control_get_stats().backlog_bytes_by_priority[
+			BUNDLE_RPRIO_HIGH
+		]
+	);
+	admission_control_release(high);
+
+	bundle_free(low);
+	bundle_free(high);
+}
+
+TEST(admission_control, drop_lowest_filter)
+{
+	struct admission_drop_filter filter;
+	struct bundle *low = create_bundle("dtn://a/x", 40, BUNDLE_FLAG_NONE);
+	struct bundle *low_b = create_bundle("dtn://b/x", 40, BUNDLE_FLAG_NONE);
+	struct bundle *high = create_bundle(
+		"dtn://a/x", 80,
+		BUNDLE_V6_FLAG_EXPEDITED_PRIORITY
+	);
+	struct bundle *huge = create_bundle(
+		"dtn://a/x", 120,
+		BUNDLE_V6_FLAG_EXPEDITED_PRIORITY
+	);
+
+	set_limits(ADMISSION_POLICY_DROP_LOWEST, 100, 0);
+	TEST_ASSERT_EQUAL(ADMISSION_ACCEPT, admission_control_admit(low));
+	TEST_ASSERT_FALSE(admission_control_get_drop_filter(low_b, &filter));
+
+	// The high-priority bundle only fits if the queued one is dropped.
+	TEST_ASSERT_EQUAL(ADMISSION_ACCEPT, admission_control_check(high));
+	TEST_ASSERT_EQUAL(ADMISSION_REJECT, admission_control_admit(high));
+	TEST_ASSERT_TRUE(admission_control_get_drop_filter(high, &filter));
+	TEST_ASSERT_NULL(filter.node_id);
+	TEST_ASSERT_TRUE(admission_control_drop_filter_matches(&filter, low));
+	TEST_ASSERT_TRUE(admission_control_drop_filter_matches(&filter, low_b));
+	TEST_ASSERT_FALSE(admission_control_drop_filter_matches(&filter, huge));
+
+	// Dropping bundles does not help if the bundle exceeds the limit.
+	TEST_ASSERT_EQUAL(ADMISSION_REJECT, admission_control_check(huge));
+	TEST_ASSERT_FALSE(admission_control_get_drop_filter(huge, &filter));
+
+	// Under the node limit, only bundles to the same node are dropped.
+	set_limits(ADMISSION_POLICY_DROP_LOWEST, 1000, 100);
+	TEST_ASSERT_TRUE(admission_control_get_drop_filter(high, &filter));
+	TEST_ASSERT_NOT_NULL(filter.node_id);
+	TEST_ASSERT_TRUE(admission_control_drop_filter_matches(&filter, low));
+	TEST_ASSERT_FALSE(admission_control_drop_filter_matches(&filter, low_b));
+
+	admission_control_release(low);
+	TEST_ASSERT_FALSE(admission_control_get_drop_filter(high, &filter));
+	TEST_ASSERT_EQUAL(ADMISSION_ACCEPT, admission_control_admit(high));
+	admission_control_release(high);
+
+	bundle_free(low);
+	bundle_free(low_b);
+	bundle_free(high);
+	bundle_free(huge);
+}
+
+TEST(admission_control, defer_and_retry)
+{
+	struct bundle *b1 = create_bundle("dtn://a/x", 60, BUNDLE_FLAG_NONE);
+	struct bundle *b2 = create_bundle("dtn://a/x", 60, BUNDLE_FLAG_NONE);
+	struct bundle *b3 = create_bundle("dtn://a/x", 60, BUNDLE_FLAG_NONE);
+
+	set_limits(ADMISSION_POLICY_DEFER, 100, 0);
+	TEST_ASSERT_EQUAL(ADMISSION_ACCEPT, admission_control_admit(b1));
+	TEST_ASSERT_EQUAL(ADMISSION_DEFER, admission_control_admit(b2));
+	TEST_ASSERT_EQUAL(UD3TN_OK, admission_control_defer(b2, 0));
+	TEST_ASSERT_EQUAL(ADMISSION_DEFER, admission_control_admit(b3));
+	TEST_ASSERT_EQUAL(UD3TN_OK, admission_control_defer(b3, 0));
+	TEST_ASSERT_EQUAL_UINT64(2, admission_control_get_stats().deferred_bundles);
+
+	// Nothing to retry until resources are freed.
+	TEST_ASSERT_EQUAL(0, admission_control_get_retry_count(0));
+	admission_control_release(b1);
+	TEST_ASSERT_EQUAL(2, admission_control_get_retry_count(0));
+	TEST_ASSERT_EQUAL(0, admission_control_get_retry_count(0));
+
+	// Bundles are retried in FIFO order.
+	TEST_ASSERT_EQUAL_PTR(b2, admission_control_pop_deferred(0));
+	TEST_ASSERT_EQUAL_PTR(b3, admission_control_pop_deferred(0));
+	TEST_ASSERT_NULL(admission_control_pop_deferred(0));
+
+	admission_control_notify_capacity();
+	TEST_ASSERT_EQUAL(0, admission_control_get_retry_count(0));
+
+	bundle_free(b1);
+	bundle_free(b2);
+	bundle_free(b3);
+}
+
+TEST(admission_control, defer_per_owner)
+{
+	struct bundle *b1 = create_bundle("dtn://a/x", 1, BUNDLE_FLAG_NONE);
+	struct bundle *b2 = create_bundle("dtn://b/x", 1, BUNDLE_FLAG_NONE);
+	struct bundle *b3 = create_bundle("dtn://a/x", 1, BUNDLE_FLAG_NONE);
+
+	set_limits(ADMISSION_POLICY_DEFER, 0, 0);
+	TEST_ASSERT_EQUAL(UD3TN_OK, admission_control_defer(b1, 0));
+	TEST_ASSERT_EQUAL(UD3TN_OK, admission_control_defer(b2, 5));
+	TEST_ASSERT_EQUAL(UD3TN_OK, admission_control_defer(b3, 0));
+
+	// Every owner is woken up once and retries only its own bundles.
+	admission_control_notify_capacity();
+	TEST_ASSERT_TRUE(admission_control_claim_retry_wakeup(5));
+	TEST_ASSERT_FALSE(admission_control_claim_retry_wakeup(5));
+	TEST_ASSERT_FALSE(admission_control_claim_retry_wakeup(1));
+	TEST_ASSERT_EQUAL(1, admission_control_get_retry_count(5));
+	TEST_ASSERT_FALSE(admission_control_claim_retry_wakeup(5));
+	TEST_ASSERT_EQUAL_PTR(b2, admission_control_pop_deferred(5));
+	TEST_ASSERT_NULL(admission_control_pop_deferred(5));
+
+	TEST_ASSERT_EQUAL(2, admission_control_get_retry_count(0));
+	TEST_ASSERT_EQUAL_PTR(b1, admission_control_pop_deferred(0));
+	TEST_ASSERT_EQUAL_PTR(b3, admission_control_pop_deferred(0));
+	TEST_ASSERT_NULL(admission_control_pop_deferred(0));
+
+	// Owners without held-back bundles are not woken up.
+	admission_control_notify_capacity();
+	TEST_ASSERT_FALSE(admission_control_claim_retry_wakeup(0));
+	TEST_ASSERT_FALSE(admission_control_claim_retry_wakeup(5));
+
+	bundle_free(b1);
+	bundle_free(b2);
+	bundle_free(b3);
+}
+
+TEST(admission_control, defer_queue_bounded)
+{
+	struct bundle *b[ADMISSION_DEFER_QUEUE_LENGTH + 1];
+
+	set_limits(ADMISSION_POLICY_DEFER, 0, 0);
+	for (size_t i = 0; i < ADMISSION_DEFER_QUEUE_LENGTH; i++) {
+		b[i] = create_bundle("dtn://a/x", 1, BUNDLE_FLAG_NONE);
+		TEST_ASSERT_EQUAL(UD3TN_OK, admission_control_defer(b[i], 0));
+	}
+	b[ADMISSION_DEFER_QUEUE_LENGTH] = create_bundle(
+		"dtn://a/x", 1, BUNDLE_FLAG_NONE
+	);
+	TEST_ASSERT_EQUAL(
+		UD3TN_FAIL,
+		admission_control_defer(b[ADMISSION_DEFER_QUEUE_LENGTH], 0)
+	);
+	TEST_ASSERT_EQUAL_UINT64(1, admission_control_get_stats().rejected_bundles);
+	bundle_free(b[ADMISSION_DEFER_QUEUE_LENGTH]);
+
+	// Other policies do not hold back bundles.
+	set_limits(ADMISSION_POLICY_REJECT, 0, 0);
+	for (size_t i = 0; i < ADMISSION_DEFER_QUEUE_LENGTH; i++)
+		bundle_free(admission_control_pop_deferred(0));
+	b[0] = create_bundle("dtn://a/x", 1, BUNDLE_FLAG_NONE);
+	TEST_ASSERT_EQUAL(UD3TN_FAIL, admission_control_defer(b[0], 0));
+	bundle_free(b[0]);
+}
+
+TEST(admission_control, defer_admitted_bundles)
+{
+	struct bundle *b[ADMISSION_DEFER_QUEUE_LENGTH + 1];
+
+	// Admitted bundles are held back regardless of the policy.
+	set_limits(ADMISSION_POLICY_REJECT, 0, 0);
+	for (size_t i = 0; i <= ADMISSION_DEFER_QUEUE_LENGTH; i++)
+		b[i] = create_bundle("dtn://a/x", 1, BUNDLE_FLAG_NONE);
+	for (size_t i = 0; i < ADMISSION_DEFER_QUEUE_LENGTH; i++)
+		TEST_ASSERT_EQUAL(
+			UD3TN_OK,
+			admission_control_defer_admitted(b[i], 1)
+		);
+	TEST_ASSERT_EQUAL(
+		UD3TN_FAIL,
+		admission_control_defer_admitted(
+			b[ADMISSION_DEFER_QUEUE_LENGTH], 1
+		)
+	);
+	// A full backlog does not count as a rejection by admission control.
+	TEST_ASSERT_EQUAL_UINT64(0, admission_control_get_stats().rejected_bundles);
+
+	admission_control_notify_capacity();
+	TEST_ASSERT_EQUAL(0, admission_control_get_retry_count(0));
+	TEST_ASSERT_EQUAL(
+		ADMISSION_DEFER_QUEUE_LENGTH,
+		admission_control_get_retry_count(1)
+	);
+	for (size_t i = 0; i < ADMISSION_DEFER_QUEUE_LENGTH; i++)
+		TEST_ASSERT_EQUAL_PTR(b[i], admission_control_pop_deferred(1));
+	for (size_t i = 0; i <= ADMISSION_DEFER_QUEUE_LENGTH; i++)
+		bundle_free(b[i]);
+}
+
+TEST_GROUP_RUNNER(admission_control)
+{
+	RUN_TEST_CASE(admission_control, accounting);
+	RUN_TEST_CASE(admission_control, reject_global_limit);
+	RUN_TEST_CASE(admission_control, reject_node_limit);
+	RUN_TEST_CASE(admission_control, drop_lowest_priority_first);
+	RUN_TEST_CASE(admission_control, drop_lowest_filter);
+	RUN_TEST_CASE(admission_control, defer_and_retry);
+	RUN_TEST_CASE(admission_control, defer_per_owner);
+	RUN_TEST_CASE(admission_control, defer_queue_bounded);
+	RUN_TEST_CASE(admission_control, defer_admitted_bundles);
+}
@@ -0,0 +1,258 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/agent_manager.h"
+#include "ud3tn/bundle.h"
+#include "ud3tn/eid_intern.h"
+
+#include "platform/hal_queue.h"
+#include "platform/hal_semaphore.h"
+
+#include "archipel-core/bundle_restore.h"
+
+#include "testud3tn_unity.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef PLATFORM_POSIX
+#include <pthread.h>
+#endif // PLATFORM_POSIX
+
+#define LOCAL_EID "ipn:1.0"
+#define RESTORE_QUEUE_LENGTH 16
+
+static QueueIdentifier_t restore_queue;
+
+struct agent_state {
+	const char *sink_identifier;
+	unsigned int calls;
+	// Forwarded to from the callback, if set
+	const char *next_sink_identifier;
+	// If set, the callback signals "entered" and waits for "proceed".
+	Semaphore_t entered;
+	Semaphore_t proceed;
+};
+
+static struct agent_state agents[3];
+
+static struct bundle_adu create_adu(const char *const destination)
+{
+	return (struct bundle_adu){
+		.protocol_version = 7,
+		.source = eid_intern("ipn:2.1"),
+		.destination = eid_intern(destination),
+		.payload = malloc(1),
+		.length = 1,
+	};
+}
+
+static void callback(struct bundle_adu data, void *param,
+		     const void *bp_context)
+{
+	struct agent_state *const state = param;
+
+	(void)bp_context;
+	state->calls++;
+	bundle_adu_free_members(data);
+
+	if (state->entered) {
+		hal_semaphore_release(state->entered);
+		hal_semaphore_take_blocking(state->proceed);
+	}
+	if (state->next_sink_identifier) {
+		const char *const next = state->next_sink_identifier;
+
+		// Only forward once if an agent forwards to itself.
+		state->next_sink_identifier = NULL;
+		TEST_ASSERT_EQUAL(0, agent_forward(next, create_adu(next),
+						   NULL));
+	}
+}
+
+static void register_agent(struct agent_state *const state,
+			   const char *const sink_identifier)
+{
+	state->sink_identifier = sink_identifier;
+	TEST_ASSERT_EQUAL(0, agent_register((struct agent){
+		.sink_identifier = sink_identifier,
+		.callback = callback,
+		.param = state,
+	}, true));
+}
+
+TEST_GROUP(agent_manager);
+
+TEST_SETUP(agent_manager)
+{
+	static bool initialized;
+
+	// The agent manager cannot be de-initialized.
+	if (!initialized) {
+		restore_queue = hal_queue_create(
+			RESTORE_QUEUE_LENGTH,
+			sizeof(struct bundle_restore_signal)
+		);
+		TEST_ASSERT_NOT_NULL(restore_queue);
+		agent_manager_init(LOCAL_EID, restore_queue);
+		initialized = true;
+	}
+	memset(agents, 0, sizeof(agents));
+}
+
+TEST_TEAR_DOWN(agent_manager)
+{
+	struct bundle_restore_signal signal;
+
+	for (size_t i = 0; i < sizeof(agents) / sizeof(agents[0]); i++) {
+		if (agents[i].sink_identifier &&
+		    is_agent_available(agents[i].sink_identifier))
+			agent_deregister(agents[i].sink_identifier, true);
+		if (agents[i].entered)
+			hal_semaphore_delete(agents[i].entered);
+		if (agents[i].proceed)
+			hal_semaphore_delete(agents[i].proceed);
+	}
+
+	// Registering an agent requests to restore stored bundles for it.
+	while (hal_queue_receive(restore_queue, &signal, 0) == UD3TN_OK)
+		free(signal.destination);
+}
+
+TEST(agent_manager, forward_to_registered_agent)
+{
+	register_agent(&agents[0], "1");
+
+	TEST_ASSERT_TRUE(is_agent_available("1"));
+	TEST_ASSERT_EQUAL(0, agent_forward("1", create_adu("ipn:1.1"), NULL));
+	TEST_ASSERT_EQUAL(1, agents[0].calls);
+
+	// Unknown sinks and duplicate registrations are rejected.
+	TEST_ASSERT_EQUAL(-1, agent_forward("2", create_adu("ipn:1.2"), NULL));
+	TEST_ASSERT_EQUAL(-1, agent_register((struct agent){
+		.sink_identifier = "1",
+		.callback = callback,
+		.param = &agents[0],
+	}, true));
+
+	TEST_ASSERT_EQUAL(0, agent_deregister("1", true));
+	TEST_ASSERT_FALSE(is_agent_available("1"));
+	TEST_ASSERT_EQUAL(-1, agent_forward("1", create_adu("ipn:1.1"), NULL));
+	TEST_ASSERT_EQUAL(-1, agent_deregister("1", true));
+	TEST_ASSERT_EQUAL(1, agents[0].calls);
+}
+
+TEST(agent_manager, forward_from_callback)
+{
+	register_agent(&agents[0], "1");
+	register_agent(&agents[1], "2");
+
+	// Agents may dispatch bundles to other local agents and themselves,
+	// which are delivered in the same thread.
+	agents[0].next_sink_identifier = "2";
+	agents[1].next_sink_identifier = "2";
+	TEST_ASSERT_EQUAL(0, agent_forward("1", create_adu("ipn:1.1"), NULL));
+	TEST_ASSERT_EQUAL(1, agents[0].calls);
+	TEST_ASSERT_EQUAL(2, agents[1].calls);
+}
+
+#ifdef PLATFORM_POSIX
+
+static void *forward_in_thread(void *param)
+{
+	struct agent_state *const state = param;
+
+	TEST_ASSERT_EQUAL(0, agent_forward(
+		state->sink_identifier,
+		create_adu("ipn:1.1"),
+		NULL
+	));
+	return NULL;
+}
+
+static void *deregister_in_thread(void *param)
+{
+	Semaphore_t deregistered = param;
+
+	TEST_ASSERT_EQUAL(0, agent_deregister("1", true));
+	hal_semaphore_release(deregistered);
+	return NULL;
+}
+
+static void make_blocking(struct agent_state *const state)
+{
+	state->entered = hal_semaphore_init_binary();
+	state->proceed = hal_semaphore_init_binary();
+	TEST_ASSERT_NOT_NULL(state->entered);
+	TEST_ASSERT_NOT_NULL(state->proceed);
+}
+
+TEST(agent_manager, callback_does_not_block_others)
+{
+	pthread_t thread;
+
+	register_agent(&agents[0], "1");
+	register_agent(&agents[1], "2");
+	make_blocking(&agents[0]);
+
+	TEST_ASSERT_EQUAL(0, pthread_create(&thread, NULL, forward_in_thread,
+					    &agents[0]));
+	hal_semaphore_take_blocking(agents[0].entered);
+
+	// While the callback of the first agent blocks, e.g. because an
+	// application does not read its bundles, other agents can be used.
+	TEST_ASSERT_EQUAL(0, agent_forward("2", create_adu("ipn:1.2"), NULL));
+	TEST_ASSERT_EQUAL(1, agents[1].calls);
+	register_agent(&agents[2], "3");
+	TEST_ASSERT_EQUAL(0, agent_deregister("3", true));
+
+	hal_semaphore_release(agents[0].proceed);
+	TEST_ASSERT_EQUAL(0, pthread_join(thread, NULL));
+	TEST_ASSERT_EQUAL(1, agents[0].calls);
+}
+
+TEST(agent_manager, deregister_waits_for_callback)
+{
+	Semaphore_t deregistered = hal_semaphore_init_binary();
+	pthread_t forwarding, deregistering;
+
+	TEST_ASSERT_NOT_NULL(deregistered);
+	register_agent(&agents[0], "1");
+	make_blocking(&agents[0]);
+
+	TEST_ASSERT_EQUAL(0, pthread_create(&forwarding, NULL,
+					    forward_in_thread, &agents[0]));
+	hal_semaphore_take_blocking(agents[0].entered);
+	TEST_ASSERT_EQUAL(0, pthread_create(&deregistering, NULL,
+					    deregister_in_thread,
+					    deregistered));
+
+	// The agent's parameters are still in use by the callback, thus,
+	// deregistering returns only after the callback has returned. The
+	// agent cannot be found anymore in the meantime.
+	TEST_ASSERT_EQUAL(UD3TN_FAIL, hal_semaphore_try_take(deregistered,
+							     50));
+	TEST_ASSERT_EQUAL(-1, agent_forward("1", create_adu("ipn:1.1"), NULL));
+
+	hal_semaphore_release(agents[0].proceed);
+	TEST_ASSERT_EQUAL(UD3TN_OK, hal_semaphore_try_take(deregistered,
+							   5000));
+	TEST_ASSERT_EQUAL(0, pthread_join(forwarding, NULL));
+	TEST_ASSERT_EQUAL(0, pthread_join(deregistering, NULL));
+	TEST_ASSERT_EQUAL(1, agents[0].calls);
+	TEST_ASSERT_FALSE(is_agent_available("1"));
+	hal_semaphore_delete(deregistered);
+}
+
+#endif // PLATFORM_POSIX
+
+TEST_GROUP_RUNNER(agent_manager)
+{
+	RUN_TEST_CASE(agent_manager, forward_to_registered_agent);
+	RUN_TEST_CASE(agent_manager, forward_from_callback);
+#ifdef PLATFORM_POSIX
+	RUN_TEST_CASE(agent_manager, callback_does_not_block_others);
+	RUN_TEST_CASE(agent_manager, deregister_waits_for_callback);
+#endif // PLATFORM_POSIX
+}
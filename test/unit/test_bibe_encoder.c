@@ -56,8 +56,31 @@ TEST(bibe_header_encoder, encode_header)
 	free(hdr.data);
 }
 
+TEST(bibe_header_encoder, encode_header_into)
+{
+	uint8_t buffer[EXPECTED_HEADER_LENGTH + 1];
+
+	TEST_ASSERT_EQUAL(
+		EXPECTED_HEADER_LENGTH,
+		bibe_get_header_length("dtn://ud3tn.dtn", 90)
+	);
+
+	buffer[EXPECTED_HEADER_LENGTH] = 0xAA;
+	TEST_ASSERT_EQUAL(
+		EXPECTED_HEADER_LENGTH,
+		bibe_encode_header_into(buffer, "dtn://ud3tn.dtn", 90)
+	);
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(
+		valid_header_bytes,
+		buffer,
+		EXPECTED_HEADER_LENGTH
+	);
+	TEST_ASSERT_EQUAL_UINT8(0xAA, buffer[EXPECTED_HEADER_LENGTH]);
+}
+
 TEST_GROUP_RUNNER(bibe_header_encoder)
 {
 	RUN_TEST_CASE(bibe_header_encoder, get_encoded_size);
 	RUN_TEST_CASE(bibe_header_encoder, encode_header);
+	RUN_TEST_CASE(bibe_header_encoder, encode_header_into);
 }
@@ -63,14 +63,34 @@ TEST(bibe_parser, parse_bpdu)
 	TEST_ASSERT_EQUAL_INT(0, err);
 	TEST_ASSERT_EQUAL_UINT64(0, bpdu.transmission_id);
 	TEST_ASSERT_EQUAL_UINT64(0, bpdu.retransmission_time);
+	TEST_ASSERT_EQUAL_UINT64(ENC_BUNDLE_LEN, bpdu.payload_length);
 	TEST_ASSERT_EQUAL_UINT8_ARRAY(
 		encapsulated_bundle_bytes,
 		bpdu.encapsulated_bundle,
 		ENC_BUNDLE_LEN
 	);
+	// The bundle is not copied but referenced in the BPDU.
+	TEST_ASSERT_EQUAL_PTR(
+		&valid_bpdu[VALID_BPDU_LEN - ENC_BUNDLE_LEN],
+		bpdu.encapsulated_bundle
+	);
+}
+
+TEST(bibe_parser, parse_truncated_bpdu)
+{
+	struct bibe_protocol_data_unit bpdu;
+
+	size_t err = bibe_parser_parse(
+		valid_bpdu,
+		VALID_BPDU_LEN - 1,
+		&bpdu
+	);
+
+	TEST_ASSERT_NOT_EQUAL(0, err);
 }
 
 TEST_GROUP_RUNNER(bibe_parser)
 {
 	RUN_TEST_CASE(bibe_parser, parse_bpdu);
+	RUN_TEST_CASE(bibe_parser, parse_truncated_bpdu);
 }
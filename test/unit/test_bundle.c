@@ -1,8 +1,11 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
 #include "bundle6/bundle6.h"
+#include "bundle6/create.h"
 #include "bundle7/bundle7.h"
 
 #include "ud3tn/bundle.h"
+#include "ud3tn/eid_intern.h"
+#include "ud3tn/shared_buffer.h"
 
 #include "testud3tn_unity.h"
 
@@ -34,7 +37,7 @@ TEST(bundle, bundle_reset)
 
 	bundle_reset(bundle);
 
-	bundle = malloc(sizeof(struct bundle));
+	bundle = object_pool_alloc(&bundle_pool);
 
 	TEST_ASSERT_NOT_NULL(bundle);
 
@@ -42,10 +45,10 @@ TEST(bundle, bundle_reset)
 	bundle->proc_flags = BUNDLE_FLAG_ACKNOWLEDGEMENT_REQUESTED;
 	bundle->ret_constraints = BUNDLE_RET_CONSTRAINT_CUSTODY_ACCEPTED;
 
-	bundle->destination = strdup("dtn:GS2");
-	bundle->source = strdup("ipnd:243.350");
-	bundle->report_to = strdup("dtn:none");
-	bundle->current_custodian = strdup("dtn:GS2");
+	bundle->destination = eid_intern("dtn:GS2");
+	bundle->source = eid_intern("ipnd:243.350");
+	bundle->report_to = eid_intern("dtn:none");
+	bundle->current_custodian = eid_intern("dtn:GS2");
 
 	bundle->crc_type = BUNDLE_CRC_TYPE_32;
 	bundle->creation_timestamp_ms = 5;
@@ -55,8 +58,10 @@ TEST(bundle, bundle_reset)
 	bundle->fragment_offset = 24;
 	bundle->total_adu_length = 3;
 	bundle->primary_block_length = 8;
+	bundle->serialized_size = 42;
+	bundle->encoded_primary_block = malloc(8);
 
-	struct bundle_block_list *bundle_block_list = malloc(sizeof(struct bundle_block_list));
+	struct bundle_block_list *bundle_block_list = object_pool_alloc(&bundle_block_list_pool);
 
 	bundle_block_list->data = NULL;
 	bundle_block_list->next = NULL;
@@ -89,6 +94,8 @@ TEST(bundle, bundle_reset)
 	TEST_ASSERT_EQUAL(bundle->fragment_offset, 0);
 	TEST_ASSERT_EQUAL(bundle->total_adu_length, 0);
 	TEST_ASSERT_EQUAL(bundle->primary_block_length, 0);
+	TEST_ASSERT_EQUAL(bundle->serialized_size, 0);
+	TEST_ASSERT_EQUAL(bundle->encoded_primary_block, NULL);
 	TEST_ASSERT_EQUAL(bundle->blocks, NULL);
 	TEST_ASSERT_EQUAL(bundle->payload_block, NULL);
 
@@ -115,14 +122,14 @@ TEST(bundle, bundle_drop)
 
 TEST(bundle, bundle_copy_headers)
 {
-	struct bundle *to = malloc(sizeof(struct bundle));
+	struct bundle *to = object_pool_alloc(&bundle_pool);
 	struct bundle *from = bundle_init();
 
-	from->destination = strdup("dtn:GS3");
-	from->source = strdup("dtn:GS1");
-	from->report_to = strdup("dtn:none");
-	from->current_custodian = strdup("dtn:GS2");
-	from->destination = strdup("dtn:GS4");
+	from->destination = eid_intern("dtn:GS3");
+	from->source = eid_intern("dtn:GS1");
+	from->report_to = eid_intern("dtn:none");
+	from->current_custodian = eid_intern("dtn:GS2");
+	from->destination = eid_intern("dtn:GS4");
 
 	bundle_copy_headers(to, from);
 
@@ -143,7 +150,7 @@ TEST(bundle, bundle_recalculate_header_length)
 
 	TEST_ASSERT_EQUAL(UD3TN_FAIL, bundle_recalculate_header_length(bundle_fail));
 
-	struct bundle *bundle = malloc(sizeof(struct bundle));
+	struct bundle *bundle = object_pool_alloc(&bundle_pool);
 
 	TEST_ASSERT_NOT_NULL(bundle);
 
@@ -151,10 +158,10 @@ TEST(bundle, bundle_recalculate_header_length)
 	bundle->proc_flags = BUNDLE_FLAG_ACKNOWLEDGEMENT_REQUESTED;
 	bundle->ret_constraints = BUNDLE_RET_CONSTRAINT_CUSTODY_ACCEPTED;
 
-	bundle->destination = strdup("dtn:GS2");
-	bundle->source = strdup("ipnd:243.350");
-	bundle->report_to = strdup("dtn:none");
-	bundle->current_custodian = strdup("dtn:GS2");
+	bundle->destination = eid_intern("dtn:GS2");
+	bundle->source = eid_intern("ipnd:243.350");
+	bundle->report_to = eid_intern("dtn:none");
+	bundle->current_custodian = eid_intern("dtn:GS2");
 
 	bundle->crc_type = BUNDLE_CRC_TYPE_32;
 	bundle->creation_timestamp_ms = 5;
@@ -164,8 +171,10 @@ TEST(bundle, bundle_recalculate_header_length)
 	bundle->fragment_offset = 24;
 	bundle->total_adu_length = 3;
 	bundle->primary_block_length = 8;
+	bundle->serialized_size = 0;
+	bundle->encoded_primary_block = NULL;
 
-	struct bundle_block_list *bundle_block_list = malloc(sizeof(struct bundle_block_list));
+	struct bundle_block_list *bundle_block_list = object_pool_alloc(&bundle_block_list_pool);
 
 	bundle_block_list->data = bundle_block_create(0);
 	bundle_block_list->next = NULL;
@@ -191,7 +200,7 @@ TEST(bundle, bundle_dup)
 
 	TEST_ASSERT_NULL(bundle_dup(bundle));
 
-	bundle = malloc(sizeof(struct bundle));
+	bundle = object_pool_alloc(&bundle_pool);
 
 	TEST_ASSERT_NOT_NULL(bundle);
 
@@ -199,10 +208,10 @@ TEST(bundle, bundle_dup)
 	bundle->proc_flags = BUNDLE_FLAG_ACKNOWLEDGEMENT_REQUESTED;
 	bundle->ret_constraints = BUNDLE_RET_CONSTRAINT_CUSTODY_ACCEPTED;
 
-	bundle->destination = strdup("dtn:GS2");
-	bundle->source = strdup("ipnd:243.350");
-	bundle->report_to = strdup("dtn:none");
-	bundle->current_custodian = strdup("dtn:GS2");
+	bundle->destination = eid_intern("dtn:GS2");
+	bundle->source = eid_intern("ipnd:243.350");
+	bundle->report_to = eid_intern("dtn:none");
+	bundle->current_custodian = eid_intern("dtn:GS2");
 
 	bundle->crc_type = BUNDLE_CRC_TYPE_32;
 	bundle->creation_timestamp_ms = 5;
@@ -212,6 +221,8 @@ TEST(bundle, bundle_dup)
 	bundle->fragment_offset = 24;
 	bundle->total_adu_length = 3;
 	bundle->primary_block_length = 8;
+	bundle->serialized_size = 0;
+	bundle->encoded_primary_block = NULL;
 
 	struct bundle_block_list *prev;
 	struct bundle_block_list *entry;
@@ -350,6 +361,47 @@ TEST(bundle, bundle_get_serialized_size)
 	bundle_free(bundle);
 }
 
+TEST(bundle, bundle_serialized_size_cache)
+{
+	struct bundle *bundle = bundle6_create_local(
+		malloc(10), 10, "dtn://node1/src", "dtn://node2/dst",
+		1, 0, 86400000, BUNDLE_FLAG_NONE);
+
+	TEST_ASSERT_NOT_NULL(bundle);
+
+	const size_t size = bundle_get_serialized_size(bundle);
+
+	TEST_ASSERT_EQUAL(bundle6_get_serialized_size(bundle), size);
+	TEST_ASSERT_EQUAL(size, bundle->serialized_size);
+
+	// Copies of the bundle retain the size, copied headers do not.
+	struct bundle *dup = bundle_dup(bundle);
+
+	TEST_ASSERT_NOT_NULL(dup);
+	TEST_ASSERT_EQUAL(size, dup->serialized_size);
+	bundle_free(dup);
+
+	dup = bundle_init();
+	TEST_ASSERT_NOT_NULL(dup);
+	bundle_copy_headers(dup, bundle);
+	TEST_ASSERT_EQUAL(0, dup->serialized_size);
+	bundle_free(dup);
+
+	// The cache is kept until the bundle is modified.
+	bundle->payload_block->length = 5;
+	TEST_ASSERT_EQUAL(size, bundle_get_serialized_size(bundle));
+	bundle_invalidate_block_caches(bundle);
+	TEST_ASSERT_EQUAL(size - 5, bundle_get_serialized_size(bundle));
+
+	bundle->lifetime_ms = 1;
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_recalculate_header_length(bundle));
+	TEST_ASSERT_EQUAL(0, bundle->serialized_size);
+	TEST_ASSERT_EQUAL(bundle6_get_serialized_size(bundle),
+			  bundle_get_serialized_size(bundle));
+
+	bundle_free(bundle);
+}
+
 TEST(bundle, bundle_list_entry_create)
 {
 	struct bundle *bundle = NULL;
@@ -412,6 +464,76 @@ TEST(bundle, bundle_block_find_first_by_type)
 	TEST_ASSERT_NULL(test_block);
 }
 
+TEST(bundle, bundle_has_block_type)
+{
+	struct bundle *bundle = bundle_init();
+
+	TEST_ASSERT_NOT_NULL(bundle);
+	TEST_ASSERT_FALSE(bundle_has_block_type(
+		bundle, BUNDLE_BLOCK_TYPE_PAYLOAD));
+
+	struct bundle_block *payload = bundle_block_create(
+		BUNDLE_BLOCK_TYPE_PAYLOAD);
+	struct bundle_block *hop_c = bundle_block_create(
+		BUNDLE_BLOCK_TYPE_HOP_COUNT);
+
+	bundle->blocks = bundle_block_entry_create(hop_c);
+	bundle->blocks->next = bundle_block_entry_create(payload);
+	bundle_invalidate_block_caches(bundle);
+
+	TEST_ASSERT_TRUE(bundle_has_block_type(
+		bundle, BUNDLE_BLOCK_TYPE_PAYLOAD));
+	TEST_ASSERT_TRUE(bundle_has_block_type(
+		bundle, BUNDLE_BLOCK_TYPE_HOP_COUNT));
+	TEST_ASSERT_FALSE(bundle_has_block_type(
+		bundle, BUNDLE_BLOCK_TYPE_BUNDLE_AGE));
+	TEST_ASSERT_EQUAL_PTR(hop_c, bundle_find_block(
+		bundle, BUNDLE_BLOCK_TYPE_HOP_COUNT));
+	TEST_ASSERT_NULL(bundle_find_block(
+		bundle, BUNDLE_BLOCK_TYPE_PREVIOUS_NODE));
+
+	// The result is cached until the blocks are modified.
+	bundle->blocks = bundle_block_entry_free(bundle->blocks);
+	TEST_ASSERT_TRUE(bundle_has_block_type(
+		bundle, BUNDLE_BLOCK_TYPE_HOP_COUNT));
+	bundle_invalidate_block_caches(bundle);
+	TEST_ASSERT_FALSE(bundle_has_block_type(
+		bundle, BUNDLE_BLOCK_TYPE_HOP_COUNT));
+	TEST_ASSERT_NULL(bundle_find_block(
+		bundle, BUNDLE_BLOCK_TYPE_HOP_COUNT));
+
+	bundle_free(bundle);
+}
+
+TEST(bundle, bundle_block_entry_embedded)
+{
+	struct bundle_block *b = bundle_block_create(BUNDLE_BLOCK_TYPE_PAYLOAD);
+
+	TEST_ASSERT_NOT_NULL(b);
+
+	// The first entry is allocated together with the block.
+	struct bundle_block_list *first = bundle_block_entry_create(b);
+
+	TEST_ASSERT_EQUAL_PTR(&b->list_entry, first);
+	TEST_ASSERT_TRUE(b->list_entry_in_use);
+
+	// Duplicates obtain their own embedded entry.
+	struct bundle_block_list *dup = bundle_block_entry_dup(first);
+
+	TEST_ASSERT_NOT_NULL(dup);
+	TEST_ASSERT_EQUAL_PTR(&dup->data->list_entry, dup);
+
+	// Further entries for the same block are allocated separately.
+	struct bundle_block_list *second = bundle_block_entry_create(b);
+
+	TEST_ASSERT_NOT_NULL(second);
+	TEST_ASSERT_NOT_EQUAL(first, second);
+	object_pool_free(&bundle_block_list_pool, second);
+
+	TEST_ASSERT_NULL(bundle_block_entry_free(dup));
+	TEST_ASSERT_NULL(bundle_block_entry_free(first));
+}
+
 TEST(bundle, bundle_block_entry_create)
 {
 	struct bundle_block *b = NULL;
@@ -470,6 +592,34 @@ TEST(bundle, bundle_block_dup)
 	TEST_ASSERT_EQUAL(block->crc_type, bundle_block_duplication->crc_type);
 }
 
+TEST(bundle, bundle_block_dup_shares_data)
+{
+	struct bundle_block *block = bundle_block_create(
+		BUNDLE_BLOCK_TYPE_PAYLOAD
+	);
+	const uint8_t payload[5] = { 0x44, 0x54, 0x4e, 0x21, 0x00 };
+
+	TEST_ASSERT_NOT_NULL(block);
+	block->length = sizeof(payload);
+	block->data = malloc(sizeof(payload));
+	TEST_ASSERT_NOT_NULL(block->data);
+	memcpy(block->data, payload, sizeof(payload));
+
+	struct bundle_block *dup = bundle_block_dup(block);
+
+	TEST_ASSERT_NOT_NULL(dup);
+	TEST_ASSERT_NOT_NULL(block->buffer);
+	TEST_ASSERT_EQUAL_PTR(block->buffer, dup->buffer);
+	TEST_ASSERT_EQUAL_PTR(block->data, dup->data);
+	TEST_ASSERT_EQUAL_UINT32(2, dup->buffer->ref_count);
+
+	// The data stays valid as long as one of the blocks references it.
+	bundle_block_free(block);
+	TEST_ASSERT_EQUAL_UINT32(1, dup->buffer->ref_count);
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(payload, dup->data, sizeof(payload));
+	bundle_block_free(dup);
+}
+
 TEST(bundle, bundle_block_entry_dup)
 {
 	struct bundle_block_list *e = NULL;
@@ -495,7 +645,7 @@ TEST(bundle, bundle_block_list_dup)
 
 	TEST_ASSERT_NULL(bundle_block_list_dup(blocks));
 
-	blocks = malloc(sizeof(struct bundle_block_list));
+	blocks = object_pool_alloc(&bundle_block_list_pool);
 
 	struct bundle_block_list *prev = NULL;
 	struct bundle_block_list *entry = NULL;
@@ -566,10 +716,10 @@ TEST(bundle, bundle_get_fragment_min_size)
 	bundle->proc_flags = BUNDLE_FLAG_ACKNOWLEDGEMENT_REQUESTED;
 	bundle->ret_constraints = BUNDLE_RET_CONSTRAINT_CUSTODY_ACCEPTED;
 
-	bundle->destination = strdup("dtn:GS2");
-	bundle->source = strdup("ipnd:243.350");
-	bundle->report_to = strdup("dtn:none");
-	bundle->current_custodian = strdup("dtn:GS2");
+	bundle->destination = eid_intern("dtn:GS2");
+	bundle->source = eid_intern("ipnd:243.350");
+	bundle->report_to = eid_intern("dtn:none");
+	bundle->current_custodian = eid_intern("dtn:GS2");
 
 	bundle->crc_type = BUNDLE_CRC_TYPE_32;
 	bundle->creation_timestamp_ms = 5;
@@ -579,6 +729,8 @@ TEST(bundle, bundle_get_fragment_min_size)
 	bundle->fragment_offset = 24;
 	bundle->total_adu_length = 3;
 	bundle->primary_block_length = 8;
+	bundle->serialized_size = 0;
+	bundle->encoded_primary_block = NULL;
 
 	struct bundle_block_list *prev;
 	struct bundle_block_list *entry;
@@ -710,14 +862,9 @@ TEST(bundle, bundle_age_update)
 	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_age_update(bundle, 5));
 }
 
-TEST(bundle, bundle_get_unique_identifier)
+static struct bundle *create_id_test_bundle(void)
 {
 	struct bundle *bundle = bundle_init();
-	struct bundle_unique_identifier *bundle_id =
-		malloc(sizeof(struct bundle_unique_identifier));
-
-	bundle->source = strdup("ipn:243.350");
-
 	struct bundle_block *block = bundle_block_create(BUNDLE_BLOCK_TYPE_PAYLOAD);
 
 	uint8_t payload[13] = {
@@ -725,6 +872,7 @@ TEST(bundle, bundle_get_unique_identifier)
 		0x6c, 0x64, 0x21
 	};
 
+	TEST_ASSERT_NOT_NULL(block);
 	block->number = 0;
 	block->crc_type = bundle->crc_type;
 	block->length = sizeof(payload);
@@ -732,87 +880,123 @@ TEST(bundle, bundle_get_unique_identifier)
 	TEST_ASSERT_NOT_NULL(block->data);
 	memcpy(block->data, payload, sizeof(payload));
 	bundle->payload_block = block;
-
-	bundle_id->creation_timestamp_ms = 0;
-	bundle_id->protocol_version = 6;
-	bundle_id->source = strdup("ipn:243.350");
-	bundle_id->sequence_number = 0;
-	bundle_id->fragment_offset = 0;
-	bundle_id->payload_length = 13;
-
-	struct bundle_unique_identifier bundle_id_2 = bundle_get_unique_identifier(bundle);
-
-	TEST_ASSERT_EQUAL(bundle_id->creation_timestamp_ms, bundle_id_2.creation_timestamp_ms);
-	TEST_ASSERT_EQUAL(bundle_id->protocol_version, bundle_id_2.protocol_version);
-	TEST_ASSERT_EQUAL_STRING(bundle_id->source, bundle_id_2.source);
-	TEST_ASSERT_EQUAL(bundle_id->sequence_number, bundle_id_2.sequence_number);
-	TEST_ASSERT_EQUAL(bundle_id->fragment_offset, bundle_id_2.fragment_offset);
-	TEST_ASSERT_EQUAL(bundle_id->payload_length, bundle_id_2.payload_length);
+	bundle->blocks = bundle_block_entry_create(block);
+	bundle->protocol_version = 7;
+	bundle->source = eid_intern("ipn:243.350");
+	bundle->destination = eid_intern("ipn:243.351");
+	bundle->report_to = eid_intern("dtn:none");
+	bundle->current_custodian = eid_intern("dtn:none");
+	bundle->creation_timestamp_ms = 1000;
+	bundle->sequence_number = 0;
+	return bundle;
 }
 
-TEST(bundle, bundle_free_unique_identifier)
+TEST(bundle, bundle_get_id)
 {
-	struct bundle *bundle = bundle_init();
-	struct bundle_unique_identifier *bundle_id =
-		malloc(sizeof(struct bundle_unique_identifier));
+	struct bundle *bundle = create_id_test_bundle();
+	struct bundle *other = create_id_test_bundle();
+	const struct bundle_id id = bundle_get_id(bundle);
+	struct bundle_id other_id = bundle_get_id(other);
+
+	TEST_ASSERT_FALSE(id.lo == 0 && id.hi == 0);
+	TEST_ASSERT_TRUE(bundle_id_equal(&id, &other_id));
+
+	// Every identifying field has to be reflected in the ID.
+	other->sequence_number = 1;
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_recalculate_header_length(other));
+	other_id = bundle_get_id(other);
+	TEST_ASSERT_FALSE(bundle_id_equal(&id, &other_id));
+
+	other->sequence_number = 0;
+	other->creation_timestamp_ms = 2000;
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_recalculate_header_length(other));
+	other_id = bundle_get_id(other);
+	TEST_ASSERT_FALSE(bundle_id_equal(&id, &other_id));
+
+	other->creation_timestamp_ms = 1000;
+	eid_intern_release(other->source);
+	other->source = eid_intern("ipn:243.352");
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_recalculate_header_length(other));
+	other_id = bundle_get_id(other);
+	TEST_ASSERT_FALSE(bundle_id_equal(&id, &other_id));
+
+	eid_intern_release(other->source);
+	other->source = eid_intern("ipn:243.350");
+	other->payload_block->length = 12;
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_recalculate_header_length(other));
+	other_id = bundle_get_id(other);
+	TEST_ASSERT_FALSE(bundle_id_equal(&id, &other_id));
+
+	other->payload_block->length = 13;
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_recalculate_header_length(other));
+	other_id = bundle_get_id(other);
+	TEST_ASSERT_TRUE(bundle_id_equal(&id, &other_id));
+
+	// Copied headers do not carry over the cached ID of the payload.
+	struct bundle *copy = bundle_init();
+
+	bundle_copy_headers(copy, bundle);
+	TEST_ASSERT_EQUAL(0, copy->id.lo);
+	TEST_ASSERT_EQUAL(0, copy->id.hi);
+	bundle_free(copy);
 
-	bundle->source = strdup("ipn:243.350");
-	bundle_id->creation_timestamp_ms = 0;
-	bundle_id->protocol_version = 6;
-	bundle_id->source = strdup("ipn:243.350");
-	bundle_id->sequence_number = 0;
-	bundle_id->fragment_offset = 0;
-	bundle_id->payload_length = 13;
-
-	bundle_free_unique_identifier(bundle_id);
+	bundle_free(bundle);
+	bundle_free(other);
 }
 
-TEST(bundle, bundle_is_equal)
+TEST(bundle, bundle_get_parent_id)
 {
-	struct bundle *bundle = bundle_init();
-	struct bundle_unique_identifier *bundle_id =
-		malloc(sizeof(struct bundle_unique_identifier));
+	struct bundle *bundle = create_id_test_bundle();
+	struct bundle *fragment = create_id_test_bundle();
+	const struct bundle_id id = bundle_get_id(bundle);
+	struct bundle_id parent_id = bundle_get_parent_id(bundle);
 
-	struct bundle_block *block = bundle_block_create(BUNDLE_BLOCK_TYPE_PAYLOAD);
+	TEST_ASSERT_TRUE(bundle_id_equal(&id, &parent_id));
 
-	uint8_t payload[13] = {
-		0x4c, 0x48, 0x65, 0x6c, 0x6c, 0x6f, 0x20, 0x77, 0x6f, 0x72,
-		0x6c, 0x64, 0x21
-	};
+	// The second half of the payload as a fragment
+	fragment->proc_flags |= BUNDLE_FLAG_IS_FRAGMENT;
+	fragment->fragment_offset = 5;
+	fragment->total_adu_length = 13;
+	fragment->payload_block->length = 8;
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_recalculate_header_length(fragment));
 
-	block->number = 0;
-	block->crc_type = bundle->crc_type;
-	block->length = sizeof(payload);
-	block->data = malloc(sizeof(payload));
-	TEST_ASSERT_NOT_NULL(block->data);
-	memcpy(block->data, payload, sizeof(payload));
-	bundle->payload_block = block;
+	const struct bundle_id fragment_id = bundle_get_id(fragment);
+
+	parent_id = bundle_get_parent_id(fragment);
+	TEST_ASSERT_FALSE(bundle_id_equal(&id, &fragment_id));
+	TEST_ASSERT_TRUE(bundle_id_equal(&id, &parent_id));
 
-	bundle->source = strdup("ipn:243.350");
-	bundle_id->creation_timestamp_ms = 0;
-	bundle_id->protocol_version = 6;
-	bundle_id->source = strdup("ipn:243.350");
-	bundle_id->sequence_number = 0;
-	bundle_id->fragment_offset = 0;
-	bundle_id->payload_length = 13;
+	bundle_free(bundle);
+	bundle_free(fragment);
+}
 
-	TEST_ASSERT_TRUE(bundle_is_equal_parent(bundle, bundle_id));
+TEST(bundle, bundle_is_equal)
+{
+	struct bundle *bundle = create_id_test_bundle();
+	struct bundle *fragment = create_id_test_bundle();
+	const struct bundle_id id = bundle_get_id(bundle);
 
-	bundle_id->sequence_number = 1;
-	TEST_ASSERT_FALSE(bundle_is_equal_parent(bundle, bundle_id));
+	fragment->proc_flags |= BUNDLE_FLAG_IS_FRAGMENT;
+	fragment->fragment_offset = 0;
+	fragment->total_adu_length = 13;
+	fragment->payload_block->length = 5;
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_recalculate_header_length(fragment));
 
-	bundle_id->sequence_number = 0;
-	TEST_ASSERT_TRUE(bundle_is_equal(bundle, bundle_id));
-	bundle_id->fragment_offset = 5;
-	TEST_ASSERT_FALSE(bundle_is_equal(bundle, bundle_id));
+	TEST_ASSERT_TRUE(bundle_is_equal(bundle, &id));
+	TEST_ASSERT_TRUE(bundle_is_equal_parent(bundle, &id));
+	TEST_ASSERT_FALSE(bundle_is_equal(fragment, &id));
+	TEST_ASSERT_TRUE(bundle_is_equal_parent(fragment, &id));
+
+	bundle_free(bundle);
+	bundle_free(fragment);
 }
 
 TEST(bundle, bundle_adu_init)
 {
 	struct bundle *bundle = bundle_init();
 
-	bundle->destination = strdup("dtn:GS2");
-	bundle->source = strdup("ipn:243.350");
+	bundle->destination = eid_intern("dtn:GS2");
+	bundle->source = eid_intern("ipn:243.350");
 
 	struct bundle_block *block = bundle_block_create(BUNDLE_BLOCK_TYPE_PAYLOAD);
 
@@ -840,7 +1024,7 @@ TEST(bundle, bundle_adu_init)
 
 TEST(bundle, bundle_to_adu)
 {
-	struct bundle *bundle = malloc(sizeof(struct bundle));
+	struct bundle *bundle = object_pool_alloc(&bundle_pool);
 
 	TEST_ASSERT_NOT_NULL(bundle);
 
@@ -848,10 +1032,10 @@ TEST(bundle, bundle_to_adu)
 	bundle->proc_flags = BUNDLE_FLAG_ACKNOWLEDGEMENT_REQUESTED;
 	bundle->ret_constraints = BUNDLE_RET_CONSTRAINT_CUSTODY_ACCEPTED;
 
-	bundle->destination = strdup("dtn:GS2");
-	bundle->source = strdup("ipnd:243.350");
-	bundle->report_to = strdup("dtn:none");
-	bundle->current_custodian = strdup("dtn:GS2");
+	bundle->destination = eid_intern("dtn:GS2");
+	bundle->source = eid_intern("ipnd:243.350");
+	bundle->report_to = eid_intern("dtn:none");
+	bundle->current_custodian = eid_intern("dtn:GS2");
 
 	bundle->crc_type = BUNDLE_CRC_TYPE_32;
 	bundle->creation_timestamp_ms = 5;
@@ -861,11 +1045,14 @@ TEST(bundle, bundle_to_adu)
 	bundle->fragment_offset = 24;
 	bundle->total_adu_length = 3;
 	bundle->primary_block_length = 8;
+	bundle->serialized_size = 0;
+	bundle->encoded_primary_block = NULL;
 
-	struct bundle_block *block = malloc(sizeof(struct bundle_block));
+	struct bundle_block *block = bundle_block_create(
+		BUNDLE_BLOCK_TYPE_PAYLOAD
+	);
 	struct bundle_block_list *blocks = NULL;
 
-	block = bundle_block_create(BUNDLE_BLOCK_TYPE_PAYLOAD);
 	blocks = bundle_block_entry_create(block);
 	bundle->blocks = blocks;
 	uint8_t payload[6] = {
@@ -891,6 +1078,51 @@ TEST(bundle, bundle_to_adu)
 	bundle_adu_free_members(adu);
 }
 
+TEST(bundle, bundle_to_adu_shared_payload)
+{
+	struct bundle *bundle = bundle_init();
+	struct bundle_block *block = bundle_block_create(
+		BUNDLE_BLOCK_TYPE_PAYLOAD
+	);
+	const uint8_t payload[6] = { 0x82, 0x01, 0x63, 0x47, 0x53, 0x34 };
+
+	TEST_ASSERT_NOT_NULL(bundle);
+	TEST_ASSERT_NOT_NULL(block);
+	bundle->destination = eid_intern("dtn://GS2/");
+	bundle->source = eid_intern("ipn:243.350");
+	block->length = sizeof(payload);
+	block->data = malloc(sizeof(payload));
+	TEST_ASSERT_NOT_NULL(block->data);
+	memcpy(block->data, payload, sizeof(payload));
+	bundle->blocks = bundle_block_entry_create(block);
+	bundle->payload_block = block;
+
+	// Another copy of the payload is still referenced, e.g., by a fragment.
+	struct bundle_block *other = bundle_block_dup(block);
+
+	TEST_ASSERT_NOT_NULL(other);
+
+	struct bundle_adu adu = bundle_to_adu(bundle);
+
+	TEST_ASSERT_EQUAL_PTR(other->buffer, adu.payload_buffer);
+	TEST_ASSERT_EQUAL_PTR(other->data, adu.payload);
+	TEST_ASSERT_EQUAL(sizeof(payload), adu.length);
+
+	// Taking over the payload copies it as it is still shared.
+	uint8_t *const taken = bundle_adu_take_payload(&adu);
+
+	TEST_ASSERT_NOT_NULL(taken);
+	TEST_ASSERT_NOT_EQUAL(other->data, taken);
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(payload, taken, sizeof(payload));
+	TEST_ASSERT_NULL(adu.payload_buffer);
+	TEST_ASSERT_EQUAL_UINT32(1, other->buffer->ref_count);
+
+	free(taken);
+	bundle_adu_free_members(adu);
+	bundle_block_free(other);
+	bundle_free(bundle);
+}
+
 
 TEST_GROUP_RUNNER(bundle)
 {
@@ -903,20 +1135,25 @@ TEST_GROUP_RUNNER(bundle)
 	RUN_TEST_CASE(bundle, bundle_dup);
 	RUN_TEST_CASE(bundle, bundle_get_routing_priority);
 	RUN_TEST_CASE(bundle, bundle_get_serialized_size);
+	RUN_TEST_CASE(bundle, bundle_serialized_size_cache);
 	RUN_TEST_CASE(bundle, bundle_list_entry_create);
 	RUN_TEST_CASE(bundle, bundle_list_entry_free);
 	RUN_TEST_CASE(bundle, bundle_block_find_first_by_type);
+	RUN_TEST_CASE(bundle, bundle_has_block_type);
+	RUN_TEST_CASE(bundle, bundle_block_entry_embedded);
 	RUN_TEST_CASE(bundle, bundle_block_entry_create);
 	RUN_TEST_CASE(bundle, bundle_block_entry_free);
 	RUN_TEST_CASE(bundle, bundle_block_dup);
+	RUN_TEST_CASE(bundle, bundle_block_dup_shares_data);
 	RUN_TEST_CASE(bundle, bundle_block_entry_dup);
 	RUN_TEST_CASE(bundle, bundle_block_list_dup);
 	RUN_TEST_CASE(bundle, bundle_get_fragment_min_size);
 	RUN_TEST_CASE(bundle, bundle_get_expiration_time_s);
 	RUN_TEST_CASE(bundle, bundle_age_update);
-	RUN_TEST_CASE(bundle, bundle_get_unique_identifier);
-	RUN_TEST_CASE(bundle, bundle_free_unique_identifier);
+	RUN_TEST_CASE(bundle, bundle_get_id);
+	RUN_TEST_CASE(bundle, bundle_get_parent_id);
 	RUN_TEST_CASE(bundle, bundle_is_equal);
 	RUN_TEST_CASE(bundle, bundle_adu_init);
 	RUN_TEST_CASE(bundle, bundle_to_adu);
+	RUN_TEST_CASE(bundle, bundle_to_adu_shared_payload);
 }
@@ -4,6 +4,7 @@
 #include "bundle6/parser.h"
 
 #include "ud3tn/bundle.h"
+#include "ud3tn/eid_intern.h"
 #include "ud3tn/node.h"
 
 #include "platform/hal_time.h"
@@ -35,8 +36,8 @@ TEST_SETUP(bundle6ParserSerializer)
 		BUNDLE_FLAG_REPORT_DELIVERY |
 		BUNDLE_V6_FLAG_CUSTODY_TRANSFER_REQUESTED
 	);
-	b->report_to = strdup("dtn:reportto");
-	b->current_custodian = strdup("dtn:custodian");
+	b->report_to = eid_intern("dtn:reportto");
+	b->current_custodian = eid_intern("dtn:custodian");
 
 	struct bundle_block *block = bundle_block_create(
 		BUNDLE_BLOCK_TYPE_HOP_COUNT
@@ -186,6 +187,48 @@ TEST(bundle6ParserSerializer, parse_and_serialize)
 	free(serializebuffer);
 }
 
+TEST(bundle6ParserSerializer, serialize_iov)
+{
+	struct bundle_iov iov;
+	const size_t serialized_size = bundle_get_serialized_size(b);
+	uint8_t *expected = malloc(serialized_size);
+	uint8_t *gathered = malloc(serialized_size);
+	struct buf_info bi = {
+		.buf = expected,
+		.pos = 0,
+	};
+	size_t pos = 0;
+
+	TEST_ASSERT_NOT_NULL(expected);
+	TEST_ASSERT_NOT_NULL(gathered);
+	bundle6_serialize(b, _write, &bi);
+	TEST_ASSERT_EQUAL(serialized_size, bi.pos);
+
+	bundle_iov_init(&iov);
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_serialize_iov(b, &iov));
+	TEST_ASSERT_EQUAL(serialized_size, iov.length);
+
+	// The encoded primary block and block headers are merged with each
+	// other unless interrupted by the referenced block data.
+	TEST_ASSERT_EQUAL(4, iov.iov_count);
+	TEST_ASSERT_EQUAL_PTR(b->payload_block->data, iov.iov[1].iov_base);
+	TEST_ASSERT_EQUAL_PTR(b->blocks->next->data->data,
+			      iov.iov[3].iov_base);
+
+	for (size_t i = 0; i < iov.iov_count; i++) {
+		TEST_ASSERT_TRUE(pos + iov.iov[i].iov_len <= serialized_size);
+		memcpy(gathered + pos, iov.iov[i].iov_base,
+		       iov.iov[i].iov_len);
+		pos += iov.iov[i].iov_len;
+	}
+	TEST_ASSERT_EQUAL(serialized_size, pos);
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, gathered, serialized_size);
+
+	bundle_iov_free(&iov);
+	free(gathered);
+	free(expected);
+}
+
 // Bundle sourced and captured from ION v3.7.4, see #7 for details
 static uint8_t ION_TEST_BUNDLE_IPN_CBHE[] = {
 	// Primary Block
@@ -307,5 +350,6 @@ TEST(bundle6ParserSerializer, parse_cbhe)
 TEST_GROUP_RUNNER(bundle6ParserSerializer)
 {
 	RUN_TEST_CASE(bundle6ParserSerializer, parse_and_serialize);
+	RUN_TEST_CASE(bundle6ParserSerializer, serialize_iov);
 	RUN_TEST_CASE(bundle6ParserSerializer, parse_cbhe);
 }
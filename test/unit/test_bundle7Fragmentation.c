@@ -1,9 +1,11 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
 #include "testud3tn_unity.h"
 
+#include "bundle7/create.h"
 #include "bundle7/fragment.h"
 
 #include "ud3tn/bundle.h"
+#include "ud3tn/eid_intern.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -39,9 +41,9 @@ TEST(bundle7Fragmentation, fragment_bundle)
 	bundle->protocol_version = 7;
 	bundle->crc_type = BUNDLE_CRC_TYPE_32;
 
-	bundle->destination = strdup("dtn:GS2");
-	bundle->source = strdup("ipn:243.350");
-	bundle->report_to = strdup("dtn:none");
+	bundle->destination = eid_intern("dtn:GS2");
+	bundle->source = eid_intern("ipn:243.350");
+	bundle->report_to = eid_intern("dtn:none");
 
 	bundle->creation_timestamp_ms = 0;
 	bundle->sequence_number = 0;
@@ -160,7 +162,67 @@ TEST(bundle7Fragmentation, fragment_bundle)
 	TEST_ASSERT_NULL(entry->next);
 }
 
+TEST(bundle7Fragmentation, fragments_share_payload)
+{
+	uint8_t *payload = malloc(100);
+	struct bundle *second;
+
+	TEST_ASSERT_NOT_NULL(payload);
+	for (int i = 0; i < 100; i++)
+		payload[i] = i;
+
+	bundle = bundle7_create_local(
+		payload, 100, "dtn://src/", "dtn://dst/", 0, 0, 86400,
+		BUNDLE_FLAG_NONE
+	);
+	TEST_ASSERT_NOT_NULL(bundle);
+
+	const size_t first_min = bundle_get_first_fragment_min_size(bundle);
+
+	fragment = bundle7_fragment_bundle(bundle, first_min + 30);
+	TEST_ASSERT_NOT_NULL(fragment);
+	second = bundle7_fragment_bundle(
+		fragment,
+		bundle_get_first_fragment_min_size(fragment) + 30
+	);
+	TEST_ASSERT_NOT_NULL(second);
+
+	// No copy is made, all fragments reference the original payload.
+	TEST_ASSERT_NOT_NULL(bundle->payload_block->buffer);
+	TEST_ASSERT_EQUAL_PTR(bundle->payload_block->buffer,
+			      fragment->payload_block->buffer);
+	TEST_ASSERT_EQUAL_PTR(bundle->payload_block->buffer,
+			      second->payload_block->buffer);
+	TEST_ASSERT_EQUAL(3, bundle->payload_block->buffer->ref_count);
+	TEST_ASSERT_EQUAL_PTR(payload, bundle->payload_block->data);
+	TEST_ASSERT_EQUAL_PTR(payload + 30, fragment->payload_block->data);
+	TEST_ASSERT_EQUAL_PTR(payload + 60, second->payload_block->data);
+	TEST_ASSERT_EQUAL(30, bundle->payload_block->length);
+	TEST_ASSERT_EQUAL(30, fragment->payload_block->length);
+	TEST_ASSERT_EQUAL(40, second->payload_block->length);
+	TEST_ASSERT_EQUAL(60, second->fragment_offset);
+	TEST_ASSERT_EQUAL(100, second->total_adu_length);
+
+	// The payload stays valid until the last fragment is freed.
+	bundle_free(bundle);
+	bundle = NULL;
+	bundle_free(fragment);
+	fragment = NULL;
+	TEST_ASSERT_EQUAL(1, second->payload_block->buffer->ref_count);
+	TEST_ASSERT_EQUAL_UINT8(99, second->payload_block->data[39]);
+
+	// A fragment referencing a slice is delivered as a copy.
+	struct bundle_adu adu = bundle_to_adu(second);
+
+	TEST_ASSERT_EQUAL(40, adu.length);
+	TEST_ASSERT_EQUAL_UINT8(60, adu.payload[0]);
+	TEST_ASSERT_NULL(second->payload_block->buffer);
+	bundle_adu_free_members(adu);
+	bundle_free(second);
+}
+
 TEST_GROUP_RUNNER(bundle7Fragmentation)
 {
 	RUN_TEST_CASE(bundle7Fragmentation, fragment_bundle);
+	RUN_TEST_CASE(bundle7Fragmentation, fragments_share_payload);
 }
@@ -5,6 +5,7 @@
  * Raw CBOR data is loaded from "test_bundle7Data.c".
  */
 
+#include "bundle7/bundle7.h"
 #include "bundle7/eid.h"
 #include "bundle7/parser.h"
 #include "bundle7/reports.h"
@@ -12,6 +13,8 @@
 #include "bundle7/bundle_age.h"
 
 #include "ud3tn/bundle.h"
+#include "ud3tn/common.h"
+#include "ud3tn/crc.h"
 #include "ud3tn/report_manager.h"
 
 #include "testud3tn_unity.h"
@@ -406,6 +409,440 @@ TEST(bundle7Parser, invalid_crc_handling)
 	TEST_ASSERT_NULL(bundle);
 }
 
+// ------------------------------
+// Deferred Payload CRC Handling
+// ------------------------------
+
+static void parse_deferred(struct bundle7_parser *state,
+			   const uint8_t *data, const size_t length)
+{
+	bundle7_parser_reset(state);
+
+	size_t parsed = bundle7_parser_read(state, data, length);
+
+	TEST_ASSERT_EQUAL(PARSER_STATUS_DONE, state->basedata->status);
+	TEST_ASSERT_FALSE(state->basedata->flags & PARSER_FLAG_CRC_INVALID);
+	TEST_ASSERT_EQUAL(parsed, length);
+	TEST_ASSERT_NOT_NULL(bundle);
+
+	// The received CRC is retained for verification or forwarding
+	TEST_ASSERT_TRUE(bundle->payload_block->crc_pending);
+}
+
+TEST(bundle7Parser, deferred_crc_handling)
+{
+	struct bundle7_parser state;
+	struct parser *parser = bundle7_parser_init(
+		&state,
+		&send_callback,
+		NULL
+	);
+	uint8_t corrupted[64];
+
+	TEST_ASSERT_NOT_NULL(parser);
+	state.defer_crc = true;
+
+	// CRC 16 payload block checksum
+	parse_deferred(&state, cbor_crc16_payload_block,
+		       len_crc16_payload_block);
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle7_verify_crc(bundle));
+	TEST_ASSERT_FALSE(bundle->payload_block->crc_pending);
+	bundle_free(bundle);
+	bundle = NULL;
+
+	// CRC 32 payload block checksum
+	parse_deferred(&state, cbor_crc32_payload_block,
+		       len_crc32_payload_block);
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle7_verify_crc(bundle));
+	bundle_free(bundle);
+	bundle = NULL;
+
+	// A corrupted payload is only detected on verification
+	TEST_ASSERT_TRUE(len_crc32_payload_block <= sizeof(corrupted));
+	memcpy(corrupted, cbor_crc32_payload_block, len_crc32_payload_block);
+	corrupted[len_crc32_payload_block - 7] ^= 0x01;
+	parse_deferred(&state, corrupted, len_crc32_payload_block);
+	TEST_ASSERT_EQUAL(UD3TN_FAIL, bundle7_verify_crc(bundle));
+	TEST_ASSERT_FALSE(bundle->payload_block->crc_pending);
+	bundle_free(bundle);
+	bundle = NULL;
+
+	bundle7_parser_deinit(&state);
+}
+
+/**
+ * Feed the data to the parser in chunks of the given size, performing the
+ * bulk reads requested by it.
+ *
+ * @return Number of bytes consumed
+ */
+static size_t parse_chunked(struct bundle7_parser *state,
+			    const uint8_t *data, const size_t length,
+			    const size_t chunk_size)
+{
+	size_t read = 0;
+
+	bundle7_parser_reset(state);
+	while (read < length &&
+	       state->basedata->status == PARSER_STATUS_GOOD) {
+		if (state->basedata->flags & PARSER_FLAG_BULK_READ) {
+			if (state->basedata->next_bytes > length - read)
+				break;
+			memcpy(state->basedata->next_buffer, data + read,
+			       state->basedata->next_bytes);
+			read += state->basedata->next_bytes;
+			state->basedata->flags &= ~PARSER_FLAG_BULK_READ;
+			bundle7_parser_read(state, NULL, 0);
+			continue;
+		}
+
+		const size_t chunk = MIN(chunk_size, length - read);
+		const size_t parsed = bundle7_parser_read(state, data + read,
+							  chunk);
+
+		read += parsed;
+		if (parsed < chunk &&
+		    !(state->basedata->flags & PARSER_FLAG_BULK_READ))
+			break;
+	}
+
+	return read;
+}
+
+// Set the CRC-16 in the last two bytes of the block, which are zero.
+static void set_crc16(uint8_t *block, const size_t length)
+{
+	const uint16_t crc = crc16_x25(block, length);
+
+	block[length - 2] = crc >> 8;
+	block[length - 1] = crc & 0xff;
+}
+
+// All heads preceding the CRC types use the longest encoding of 9 bytes.
+#define LONG_HEAD(value) 0, 0, 0, 0, 0, 0, 0, (value)
+
+static const uint8_t cbor_long_heads_primary[] = {
+	0x9b, LONG_HEAD(9),			// Primary block, 9 items
+	0x1b, LONG_HEAD(7),			// Version
+	0x1b, LONG_HEAD(0),			// Processing flags
+	0x1b, LONG_HEAD(BUNDLE_CRC_TYPE_16),	// CRC type
+	0x82, 0x02, 0x82, 0x01, 0x01,		// Destination ipn:1.1
+	0x82, 0x02, 0x82, 0x02, 0x01,		// Source ipn:2.1
+	0x82, 0x01, 0x00,			// Report-to dtn:none
+	0x82, 0x00, 0x00,			// Creation timestamp
+	0x1a, 0x00, 0x01, 0x51, 0x80,		// Lifetime
+	0x42, 0x00, 0x00,			// CRC
+};
+
+static const uint8_t cbor_long_heads_payload[] = {
+	0x9b, LONG_HEAD(6),			// Payload block, 6 items
+	0x1b, LONG_HEAD(BUNDLE_BLOCK_TYPE_PAYLOAD),
+	0x1b, LONG_HEAD(1),			// Block number
+	0x1b, LONG_HEAD(0),			// Block processing flags
+	0x1b, LONG_HEAD(BUNDLE_CRC_TYPE_16),	// CRC type
+	0x42, 'h', 'i',				// Data
+	0x42, 0x00, 0x00,			// CRC
+};
+
+// Assemble a bundle of the given blocks, setting their CRC-16 fields.
+static size_t assemble_bundle(uint8_t *out, const size_t size,
+			      const uint8_t *primary, const size_t primary_len,
+			      const uint8_t *payload, const size_t payload_len)
+{
+	TEST_ASSERT_TRUE(2 + primary_len + payload_len <= size);
+
+	out[0] = 0x9f;
+	memcpy(out + 1, primary, primary_len);
+	set_crc16(out + 1, primary_len);
+	memcpy(out + 1 + primary_len, payload, payload_len);
+	set_crc16(out + 1 + primary_len, payload_len);
+	out[1 + primary_len + payload_len] = 0xff;
+
+	return 2 + primary_len + payload_len;
+}
+
+TEST(bundle7Parser, long_heads_before_crc_type)
+{
+	struct bundle7_parser state;
+	struct parser *parser = bundle7_parser_init(
+		&state,
+		&send_callback,
+		NULL
+	);
+	uint8_t data[128];
+	const size_t length = assemble_bundle(
+		data, sizeof(data),
+		cbor_long_heads_primary, sizeof(cbor_long_heads_primary),
+		cbor_long_heads_payload, sizeof(cbor_long_heads_payload)
+	);
+
+	TEST_ASSERT_NOT_NULL(parser);
+
+	// The buffered heads must neither overflow nor break the CRCs, no
+	// matter how they are split up.
+	for (size_t chunk = 1; chunk <= length; chunk++) {
+		const size_t parsed = parse_chunked(&state, data, length,
+						    chunk);
+
+		TEST_ASSERT_EQUAL(length, parsed);
+		TEST_ASSERT_EQUAL(PARSER_STATUS_DONE, state.basedata->status);
+		TEST_ASSERT_FALSE(state.basedata->flags &
+				  PARSER_FLAG_CRC_INVALID);
+		TEST_ASSERT_NOT_NULL(bundle);
+		if (bundle == NULL)
+			break;
+
+		TEST_ASSERT_EQUAL(BUNDLE_CRC_TYPE_16, bundle->crc_type);
+		TEST_ASSERT_EQUAL_STRING("ipn:1.1", bundle->destination);
+		TEST_ASSERT_EQUAL(1, bundle->payload_block->number);
+		TEST_ASSERT_EQUAL(2, bundle->payload_block->length);
+		TEST_ASSERT_EQUAL_UINT8_ARRAY("hi",
+					      bundle->payload_block->data, 2);
+		bundle_free(bundle);
+		bundle = NULL;
+	}
+
+	bundle7_parser_deinit(&state);
+}
+
+// --------------------
+// Malformed CBOR Input
+// --------------------
+
+static const uint8_t cbor_crc16_primary[] = {
+	0x89, 0x07, 0x00, BUNDLE_CRC_TYPE_16,	// 9 items, CRC-16
+	0x82, 0x02, 0x82, 0x01, 0x01,		// Destination ipn:1.1
+	0x82, 0x02, 0x82, 0x02, 0x01,		// Source ipn:2.1
+	0x82, 0x01, 0x00,			// Report-to dtn:none
+	0x82, 0x00, 0x00,			// Creation timestamp
+	0x1a, 0x00, 0x01, 0x51, 0x80,		// Lifetime
+	0x42, 0x00, 0x00,			// CRC
+};
+
+static const uint8_t cbor_crc16_payload[] = {
+	0x86, BUNDLE_BLOCK_TYPE_PAYLOAD, 0x01, 0x00, BUNDLE_CRC_TYPE_16,
+	0x42, 'h', 'i',				// Data
+	0x42, 0x00, 0x00,			// CRC
+};
+
+// Offset of the CRC field of the primary block in the assembled bundle
+#define CRC16_PRIMARY_CRC_OFFSET (1 + sizeof(cbor_crc16_primary) - 3)
+
+static void expect_parser_error(struct bundle7_parser *state,
+				const uint8_t *data, const size_t length)
+{
+	parse_chunked(state, data, length, length);
+	TEST_ASSERT_EQUAL(PARSER_STATUS_ERROR, state->basedata->status);
+	TEST_ASSERT_NULL(bundle);
+}
+
+TEST(bundle7Parser, wrong_item_counts)
+{
+	struct bundle7_parser state;
+	struct parser *parser = bundle7_parser_init(
+		&state,
+		&send_callback,
+		NULL
+	);
+	uint8_t primary[sizeof(cbor_crc16_primary)];
+	uint8_t payload[sizeof(cbor_crc16_payload)];
+	uint8_t data[128];
+	size_t length;
+
+	TEST_ASSERT_NOT_NULL(parser);
+
+	// The primary block has 9 items with a CRC, 8 without it, and two
+	// more if the bundle is a fragment.
+	static const uint8_t primary_heads[] = { 0x88, 0x8a, 0x8b, 0x9f };
+
+	memcpy(payload, cbor_crc16_payload, sizeof(payload));
+	for (size_t i = 0; i < sizeof(primary_heads); i++) {
+		memcpy(primary, cbor_crc16_primary, sizeof(primary));
+		primary[0] = primary_heads[i];
+		length = assemble_bundle(data, sizeof(data),
+					 primary, sizeof(primary),
+					 payload, sizeof(payload));
+		expect_parser_error(&state, data, length);
+	}
+
+	// Canonical blocks have 6 items with a CRC, 5 without it.
+	static const uint8_t block_heads[] = { 0x84, 0x85, 0x87, 0x9f };
+
+	memcpy(primary, cbor_crc16_primary, sizeof(primary));
+	for (size_t i = 0; i < sizeof(block_heads); i++) {
+		memcpy(payload, cbor_crc16_payload, sizeof(payload));
+		payload[0] = block_heads[i];
+		length = assemble_bundle(data, sizeof(data),
+					 primary, sizeof(primary),
+					 payload, sizeof(payload));
+		expect_parser_error(&state, data, length);
+	}
+
+	// Without a CRC type, the CRC field must be omitted.
+	memcpy(payload, cbor_crc16_payload, sizeof(payload));
+	payload[4] = BUNDLE_CRC_TYPE_NONE;
+	length = assemble_bundle(data, sizeof(data), primary, sizeof(primary),
+				 payload, sizeof(payload));
+	expect_parser_error(&state, data, length);
+
+	bundle7_parser_deinit(&state);
+}
+
+TEST(bundle7Parser, truncated_and_mismatched_crc)
+{
+	struct bundle7_parser state;
+	struct parser *parser = bundle7_parser_init(
+		&state,
+		&send_callback,
+		NULL
+	);
+	uint8_t valid[128];
+	uint8_t data[128];
+	const size_t length = assemble_bundle(
+		valid, sizeof(valid),
+		cbor_crc16_primary, sizeof(cbor_crc16_primary),
+		cbor_crc16_payload, sizeof(cbor_crc16_payload)
+	);
+
+	TEST_ASSERT_NOT_NULL(parser);
+
+	// CRC field shorter than required by the CRC type
+	memcpy(data, valid, length);
+	data[CRC16_PRIMARY_CRC_OFFSET] = 0x41;
+	memmove(&data[CRC16_PRIMARY_CRC_OFFSET + 2],
+		&data[CRC16_PRIMARY_CRC_OFFSET + 3],
+		length - CRC16_PRIMARY_CRC_OFFSET - 3);
+	expect_parser_error(&state, data, length - 1);
+
+	// CRC-32 field in a block declaring a CRC-16
+	memcpy(data, valid, CRC16_PRIMARY_CRC_OFFSET);
+	data[CRC16_PRIMARY_CRC_OFFSET] = 0x44;
+	memset(&data[CRC16_PRIMARY_CRC_OFFSET + 1], 0, 4);
+	memcpy(&data[CRC16_PRIMARY_CRC_OFFSET + 5],
+	       &valid[CRC16_PRIMARY_CRC_OFFSET + 3],
+	       length - CRC16_PRIMARY_CRC_OFFSET - 3);
+	expect_parser_error(&state, data, length + 2);
+
+	// CRC field that is no byte string
+	memcpy(data, valid, length);
+	data[CRC16_PRIMARY_CRC_OFFSET] = 0x02;
+	expect_parser_error(&state, data, length);
+
+	// Checksum not matching the data of the blocks
+	for (size_t i = 1; i <= 2; i++) {
+		memcpy(data, valid, length);
+		data[length - 1 - i] ^= 0x80;
+		TEST_ASSERT_EQUAL(length, parse_chunked(&state, data, length,
+							length));
+		TEST_ASSERT_EQUAL(PARSER_STATUS_DONE, state.basedata->status);
+		TEST_ASSERT_TRUE(state.basedata->flags &
+				 PARSER_FLAG_CRC_INVALID);
+		TEST_ASSERT_NULL(bundle);
+	}
+
+	// The bundle is not complete until the final "break" is received.
+	for (size_t cut = 1; cut < length; cut++) {
+		parse_chunked(&state, valid, cut, cut);
+		TEST_ASSERT_EQUAL(PARSER_STATUS_GOOD, state.basedata->status);
+		TEST_ASSERT_NULL(bundle);
+	}
+
+	bundle7_parser_deinit(&state);
+}
+
+TEST(bundle7Parser, non_shortest_heads)
+{
+	struct bundle7_parser state;
+	struct parser *parser = bundle7_parser_init(
+		&state,
+		&send_callback,
+		NULL
+	);
+	static const uint8_t primary[] = {
+		0x89, 0x07, 0x18, 0x00, 0x01,		// Flags: 2 bytes
+		0x82, 0x02, 0x82, 0x01, 0x19, 0x00, 0x01,
+		0x82, 0x02, 0x82, 0x02, 0x01,
+		0x82, 0x01, 0x00,
+		0x82, 0x1a, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x1b, LONG_HEAD(0x10),			// Lifetime
+		0x42, 0x00, 0x00,
+	};
+	static const uint8_t payload[] = {
+		0x86, 0x01, 0x01, 0x00, 0x01,
+		0x58, 0x02, 'h', 'i',			// Length: 2 bytes
+		0x42, 0x00, 0x00,
+	};
+	uint8_t data[128];
+	const size_t length = assemble_bundle(data, sizeof(data),
+					      primary, sizeof(primary),
+					      payload, sizeof(payload));
+
+	TEST_ASSERT_NOT_NULL(parser);
+
+	// The payload CRC could not be verified against the serialized block
+	// later, it is verified right away.
+	state.defer_crc = true;
+	for (size_t chunk = 1; chunk <= length; chunk++) {
+		TEST_ASSERT_EQUAL(length, parse_chunked(&state, data, length,
+							chunk));
+		TEST_ASSERT_EQUAL(PARSER_STATUS_DONE, state.basedata->status);
+		TEST_ASSERT_FALSE(state.basedata->flags &
+				  PARSER_FLAG_CRC_INVALID);
+		TEST_ASSERT_NOT_NULL(bundle);
+		if (bundle == NULL)
+			break;
+
+		TEST_ASSERT_EQUAL_STRING("ipn:1.1", bundle->destination);
+		TEST_ASSERT_EQUAL(0x10, bundle->lifetime_ms);
+		TEST_ASSERT_EQUAL(2, bundle->payload_block->length);
+		TEST_ASSERT_FALSE(bundle->payload_block->crc_pending);
+		bundle_free(bundle);
+		bundle = NULL;
+	}
+
+	bundle7_parser_deinit(&state);
+}
+
+TEST(bundle7Parser, crc_chunked)
+{
+	struct bundle7_parser state;
+	struct parser *parser = bundle7_parser_init(
+		&state,
+		&send_callback,
+		NULL
+	);
+	const struct {
+		const uint8_t *data;
+		size_t length;
+	} bundles[] = {
+		{ cbor_crc16_primary_block, len_crc16_primary_block },
+		{ cbor_crc16_payload_block, len_crc16_payload_block },
+		{ cbor_crc32_primary_block, len_crc32_primary_block },
+		{ cbor_crc32_payload_block, len_crc32_payload_block },
+	};
+
+	TEST_ASSERT_NOT_NULL(parser);
+
+	// Every field is split up in one of the iterations.
+	for (size_t i = 0; i < sizeof(bundles) / sizeof(bundles[0]); i++) {
+		for (size_t chunk = 1; chunk <= bundles[i].length; chunk++) {
+			TEST_ASSERT_EQUAL(bundles[i].length, parse_chunked(
+				&state, bundles[i].data, bundles[i].length,
+				chunk
+			));
+			TEST_ASSERT_EQUAL(PARSER_STATUS_DONE,
+					  state.basedata->status);
+			TEST_ASSERT_FALSE(state.basedata->flags &
+					  PARSER_FLAG_CRC_INVALID);
+			TEST_ASSERT_NOT_NULL(bundle);
+			bundle_free(bundle);
+			bundle = NULL;
+		}
+	}
+
+	bundle7_parser_deinit(&state);
+}
+
 static const uint8_t cbor_status_report[] = {
 	// [
 	//   1,                   // Record type code
@@ -531,6 +968,12 @@ TEST_GROUP_RUNNER(bundle7Parser)
 	RUN_TEST_CASE(bundle7Parser, crc16_verification);
 	RUN_TEST_CASE(bundle7Parser, crc32_verification);
 	RUN_TEST_CASE(bundle7Parser, invalid_crc_handling);
+	RUN_TEST_CASE(bundle7Parser, deferred_crc_handling);
+	RUN_TEST_CASE(bundle7Parser, long_heads_before_crc_type);
+	RUN_TEST_CASE(bundle7Parser, wrong_item_counts);
+	RUN_TEST_CASE(bundle7Parser, truncated_and_mismatched_crc);
+	RUN_TEST_CASE(bundle7Parser, non_shortest_heads);
+	RUN_TEST_CASE(bundle7Parser, crc_chunked);
 	RUN_TEST_CASE(bundle7Parser, status_report_parser);
 	RUN_TEST_CASE(bundle7Parser, hop_count);
 	RUN_TEST_CASE(bundle7Parser, bundle_age);
@@ -0,0 +1,287 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "bundle7/bundle7.h"
+#include "bundle7/create.h"
+#include "bundle7/profile.h"
+#include "bundle7/serializer.h"
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/eid_intern.h"
+
+#include "testud3tn_unity.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+TEST_GROUP(bundle7Profile);
+
+TEST_SETUP(bundle7Profile)
+{
+}
+
+TEST_TEAR_DOWN(bundle7Profile)
+{
+}
+
+static const uint8_t test_payload[] = "Hello world!";
+
+struct serialized_data {
+	uint8_t data[256];
+	size_t length;
+};
+
+static void write_memory(void *cla_obj, const void *data, const size_t len)
+{
+	struct serialized_data *const out = cla_obj;
+
+	TEST_ASSERT_TRUE_MESSAGE(
+		out->length + len <= sizeof(out->data),
+		"CBOR too long");
+	memcpy(out->data + out->length, data, len);
+	out->length += len;
+}
+
+static struct bundle *create_bundle(struct bundle7_profile *profile,
+				    const char *destination,
+				    const uint64_t creation_time_ms,
+				    const uint64_t sequence_number)
+{
+	uint8_t *const payload = malloc(sizeof(test_payload));
+
+	TEST_ASSERT_NOT_NULL(payload);
+	memcpy(payload, test_payload, sizeof(test_payload));
+
+	struct bundle *const bundle = bundle7_profile_create_bundle(
+		profile, payload, sizeof(test_payload), destination,
+		creation_time_ms, sequence_number,
+		BUNDLE_FLAG_REPORT_DELIVERY
+	);
+
+	TEST_ASSERT_NOT_NULL(bundle);
+	return bundle;
+}
+
+// Serializes the bundle from its profile, and again using the generic
+// serializer after dropping the profile and the encoded primary block.
+static void check_same_as_generic(struct bundle *bundle)
+{
+	struct serialized_data from_profile = { .length = 0 };
+	struct serialized_data generic = { .length = 0 };
+
+	TEST_ASSERT_TRUE(bundle7_profile_matches(bundle));
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle7_serialize(bundle, write_memory,
+						      &from_profile));
+	TEST_ASSERT_EQUAL(bundle_get_serialized_size(bundle),
+			  from_profile.length);
+
+	bundle7_profile_unref(bundle->profile);
+	bundle->profile = NULL;
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_recalculate_header_length(bundle));
+	TEST_ASSERT_FALSE(bundle7_profile_matches(bundle));
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle7_serialize(bundle, write_memory,
+						      &generic));
+
+	TEST_ASSERT_EQUAL(generic.length, from_profile.length);
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(generic.data, from_profile.data,
+				      generic.length);
+}
+
+TEST(bundle7Profile, same_as_generic)
+{
+	static const struct {
+		const char *source;
+		const char *destination;
+		uint64_t lifetime_ms;
+		enum bundle_crc_type crc_type;
+		enum bundle7_profile_blocks extension_blocks;
+		uint64_t creation_time_ms;
+		uint64_t sequence_number;
+	} cases[] = {
+		{ "ipn:243.350", "ipn:1.2", 86400000, BUNDLE_CRC_TYPE_32,
+		  BUNDLE7_PROFILE_BUNDLE_AGE | BUNDLE7_PROFILE_HOP_COUNT,
+		  658489863000, 0 },
+		{ "ipn:4294967296.1", "ipn:23.24", 10, BUNDLE_CRC_TYPE_16,
+		  BUNDLE7_PROFILE_HOP_COUNT, 0, 65536 },
+		{ "dtn://ud3tn.dtn/agent", "dtn://sink.dtn/", 3600000,
+		  BUNDLE_CRC_TYPE_NONE, BUNDLE7_PROFILE_BUNDLE_AGE,
+		  1, 23 },
+		{ "dtn://ud3tn.dtn/agent", "ipn:1.0", UINT32_MAX + 1ULL,
+		  BUNDLE_CRC_TYPE_32, BUNDLE7_PROFILE_BLOCKS_NONE,
+		  UINT64_MAX, 255 },
+	};
+
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		struct bundle7_profile *const profile = bundle7_profile_create(
+			cases[i].source,
+			"dtn:none",
+			cases[i].lifetime_ms,
+			cases[i].crc_type,
+			cases[i].extension_blocks,
+			30
+		);
+
+		TEST_ASSERT_NOT_NULL(profile);
+
+		struct bundle *const bundle = create_bundle(
+			profile,
+			cases[i].destination,
+			cases[i].creation_time_ms,
+			cases[i].sequence_number
+		);
+
+		// The profile is kept alive by the bundle.
+		bundle7_profile_unref(profile);
+		check_same_as_generic(bundle);
+		bundle_free(bundle);
+	}
+}
+
+TEST(bundle7Profile, same_as_create_local)
+{
+	struct bundle7_profile *const profile = bundle7_profile_create(
+		"ipn:243.350", "dtn:none", 86400000, DEFAULT_BPV7_CRC_TYPE,
+		BUNDLE7_PROFILE_BLOCKS_NONE, 0
+	);
+
+	TEST_ASSERT_NOT_NULL(profile);
+
+	struct bundle *const bundle = create_bundle(profile, "dtn://sink.dtn/",
+						    658489863000, 1);
+	uint8_t *const payload = malloc(sizeof(test_payload));
+
+	TEST_ASSERT_NOT_NULL(payload);
+	memcpy(payload, test_payload, sizeof(test_payload));
+
+	struct bundle *const local = bundle7_create_local(
+		payload, sizeof(test_payload), "ipn:243.350",
+		"dtn://sink.dtn/", 658489863000, 1, 86400000,
+		BUNDLE_FLAG_REPORT_DELIVERY
+	);
+
+	TEST_ASSERT_NOT_NULL(local);
+	TEST_ASSERT_EQUAL(local->primary_block_length,
+			  bundle->primary_block_length);
+
+	struct serialized_data expected = { .length = 0 };
+	struct serialized_data actual = { .length = 0 };
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle7_serialize(local, write_memory,
+						      &expected));
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle7_serialize(bundle, write_memory,
+						      &actual));
+	TEST_ASSERT_EQUAL(expected.length, actual.length);
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(expected.data, actual.data,
+				      expected.length);
+
+	bundle_free(local);
+	bundle_free(bundle);
+	bundle7_profile_unref(profile);
+}
+
+TEST(bundle7Profile, own_lifetime)
+{
+	struct bundle7_profile *const profile = bundle7_profile_create(
+		"ipn:243.350", "dtn:none", 86400000, DEFAULT_BPV7_CRC_TYPE,
+		BUNDLE7_PROFILE_BLOCKS_NONE, 0
+	);
+	const char *const destination = eid_intern("ipn:1.0");
+	// Shorter and longer encodings than the lifetime of the profile
+	const uint64_t lifetimes[] = { 10, 86400000, 0x100000000 };
+
+	TEST_ASSERT_NOT_NULL(profile);
+	TEST_ASSERT_NOT_NULL(destination);
+
+	for (size_t i = 0; i < sizeof(lifetimes) / sizeof(lifetimes[0]); i++) {
+		uint8_t *const payload = malloc(sizeof(test_payload));
+
+		TEST_ASSERT_NOT_NULL(payload);
+		memcpy(payload, test_payload, sizeof(test_payload));
+
+		struct bundle *const bundle = (
+			bundle7_profile_create_bundle_interned(
+				profile, payload, sizeof(test_payload),
+				destination, 658489863000, 1, lifetimes[i],
+				BUNDLE_FLAG_ADMINISTRATIVE_RECORD
+			)
+		);
+
+		TEST_ASSERT_NOT_NULL(bundle);
+		TEST_ASSERT_EQUAL_PTR(destination, bundle->destination);
+		TEST_ASSERT_EQUAL_UINT64(lifetimes[i], bundle->lifetime_ms);
+		check_same_as_generic(bundle);
+		bundle_free(bundle);
+	}
+
+	eid_intern_release(destination);
+	bundle7_profile_unref(profile);
+}
+
+TEST(bundle7Profile, changed_shape)
+{
+	struct bundle7_profile *const profile = bundle7_profile_create(
+		"ipn:243.350", "dtn:none", 86400000, BUNDLE_CRC_TYPE_32,
+		BUNDLE7_PROFILE_HOP_COUNT, 30
+	);
+
+	TEST_ASSERT_NOT_NULL(profile);
+
+	struct bundle *const bundle = create_bundle(profile, "ipn:1.2",
+						    658489863000, 1);
+	struct bundle *const dup = bundle_dup(bundle);
+
+	TEST_ASSERT_NOT_NULL(dup);
+	TEST_ASSERT_EQUAL_PTR(profile, dup->profile);
+	TEST_ASSERT_EQUAL(3, profile->ref_count);
+
+	// A block added on the way, e.g. a previous node block, is serialized
+	// by the generic serializer.
+	struct bundle_block *const block = bundle_block_create(
+		BUNDLE_BLOCK_TYPE_PREVIOUS_NODE
+	);
+	struct bundle_block_list *const entry = bundle_block_entry_create(
+		block
+	);
+
+	TEST_ASSERT_NOT_NULL(entry);
+	block->number = 4;
+	block->crc_type = BUNDLE_CRC_TYPE_NONE;
+	block->data = malloc(3);
+	TEST_ASSERT_NOT_NULL(block->data);
+	memcpy(block->data, (uint8_t []){ 0x82, 0x01, 0x00 }, 3);
+	block->length = 3;
+	entry->next = bundle->blocks;
+	bundle->blocks = entry;
+	bundle_invalidate_block_caches(bundle);
+	TEST_ASSERT_FALSE(bundle7_profile_matches(bundle));
+
+	struct serialized_data data = { .length = 0 };
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle7_serialize(bundle, write_memory,
+						      &data));
+	TEST_ASSERT_EQUAL(bundle_get_serialized_size(bundle), data.length);
+
+	// Modifying the primary block drops the encoded block, which is
+	// encoded by the generic serializer again.
+	bundle_free(bundle);
+	dup->lifetime_ms = 1000;
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_recalculate_header_length(dup));
+	TEST_ASSERT_FALSE(bundle7_profile_matches(dup));
+	data.length = 0;
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle7_serialize(dup, write_memory,
+						      &data));
+	TEST_ASSERT_TRUE(bundle7_profile_matches(dup));
+	TEST_ASSERT_EQUAL(bundle_get_serialized_size(dup), data.length);
+
+	bundle_free(dup);
+	TEST_ASSERT_EQUAL(1, profile->ref_count);
+	bundle7_profile_unref(profile);
+}
+
+TEST_GROUP_RUNNER(bundle7Profile)
+{
+	RUN_TEST_CASE(bundle7Profile, same_as_generic);
+	RUN_TEST_CASE(bundle7Profile, same_as_create_local);
+	RUN_TEST_CASE(bundle7Profile, own_lifetime);
+	RUN_TEST_CASE(bundle7Profile, changed_shape);
+}
@@ -2,6 +2,7 @@
 #include "bundle7/reports.h"
 
 #include "ud3tn/bundle.h"
+#include "ud3tn/eid_intern.h"
 
 #include "testud3tn_unity.h"
 
@@ -24,9 +25,9 @@ static struct bundle *create_bundle(void)
 	bundle->protocol_version = 7;
 	bundle->proc_flags |= BUNDLE_FLAG_REPORT_STATUS_TIME;
 
-	bundle->destination = strdup("dtn:GS1");
-	bundle->source = strdup("ipn:243.350");
-	bundle->report_to = strdup("dtn:GS2");
+	bundle->destination = eid_intern("dtn:GS1");
+	bundle->source = eid_intern("ipn:243.350");
+	bundle->report_to = eid_intern("dtn:GS2");
 
 	bundle->creation_timestamp_ms = 1000;
 	bundle->lifetime_ms = 299000;
@@ -134,7 +135,94 @@ TEST(bundle7Reports, generate_status_reports)
 }
 
 
+TEST(bundle7Reports, generate_status_reports_templated)
+{
+	struct bundle7_report_template template;
+
+	bundle = create_bundle();
+	// Fragment information, no times
+	bundle->proc_flags = BUNDLE_FLAG_IS_FRAGMENT;
+	bundle->fragment_offset = 500;
+
+	struct bundle_status_report report = {
+		.status = BUNDLE_SR_FLAG_BUNDLE_DELETED,
+		.bundle_deleted_time = 100,
+		.reason = BUNDLE_SR_REASON_LIFETIME_EXPIRED,
+	};
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle7_report_template_init(
+		&template, "ipn:1.0"
+	));
+
+	const size_t interned = eid_intern_get_count();
+	struct bundle *record = bundle7_generate_status_report_templated(
+		&template, bundle, &report, 2000
+	);
+
+	TEST_ASSERT_NOT_NULL(record);
+	// The report references the EIDs of the template and the bundle.
+	TEST_ASSERT_EQUAL(interned, eid_intern_get_count());
+	TEST_ASSERT_EQUAL_PTR(template.profile->source, record->source);
+	// The primary block is prepared from the template.
+	TEST_ASSERT_EQUAL_PTR(template.profile, record->profile);
+	TEST_ASSERT_EQUAL_PTR(bundle->report_to, record->destination);
+	TEST_ASSERT_EQUAL_STRING("dtn:none", record->report_to);
+	TEST_ASSERT_EQUAL(298000, record->lifetime_ms);
+
+	// [
+	//   1,                  # Administative Record Type
+	//   [
+	//     [                 # Bundle Status Information
+	//       [false],
+	//       [false],
+	//       [false],
+	//       [true]
+	//     ],
+	//     1,                # Reason Code
+	//     [2, [243, 350]],  # Source EID
+	//     [1000, 0],        # Creation Timestamp (orig. Bundle)
+	//     500,              # Fragment Offset
+	//     13                # Fragment Length
+	//   ]
+	// ]
+	const uint8_t cbor_report[] = {
+		0x82, 0x01, 0x86, 0x84, 0x81, 0xf4, 0x81, 0xf4, 0x81, 0xf4,
+		0x81, 0xf5, 0x01, 0x82, 0x02, 0x82, 0x18, 0xf3, 0x19, 0x01,
+		0x5e, 0x82, 0x19, 0x03, 0xe8, 0x00, 0x19, 0x01, 0xf4, 0x0d,
+	};
+
+	TEST_ASSERT_EQUAL(sizeof(cbor_report), record->payload_block->length);
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(
+		cbor_report,
+		record->payload_block->data,
+		sizeof(cbor_report)
+	);
+
+	// Equal to the report generated without template
+	struct bundle *other = bundle7_generate_status_report(
+		bundle, &report, "ipn:1.0", 2000
+	);
+
+	TEST_ASSERT_NOT_NULL(other);
+	TEST_ASSERT_EQUAL_PTR(record->source, other->source);
+	TEST_ASSERT_EQUAL(record->primary_block_length,
+			  other->primary_block_length);
+	TEST_ASSERT_EQUAL(record->payload_block->length,
+			  other->payload_block->length);
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(
+		record->payload_block->data,
+		other->payload_block->data,
+		record->payload_block->length
+	);
+
+	bundle_free(other);
+	bundle_free(record);
+	bundle7_report_template_deinit(&template);
+}
+
+
 TEST_GROUP_RUNNER(bundle7Reports)
 {
 	RUN_TEST_CASE(bundle7Reports, generate_status_reports);
+	RUN_TEST_CASE(bundle7Reports, generate_status_reports_templated);
 }
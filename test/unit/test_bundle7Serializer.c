@@ -14,6 +14,7 @@
 #include "platform/hal_io.h"
 
 #include "ud3tn/bundle.h"
+#include "ud3tn/eid_intern.h"
 
 #include "testud3tn_unity.h"
 
@@ -73,9 +74,9 @@ TEST(bundle7Serializer, simple_bundle)
 		| BUNDLE_V6_FLAG_NORMAL_PRIORITY;
 	bundle->crc_type = BUNDLE_CRC_TYPE_NONE;
 
-	bundle->destination = strdup("dtn:GS2");
-	bundle->source = strdup("ipn:243.350");
-	bundle->report_to = strdup("dtn:none");
+	bundle->destination = eid_intern("dtn:GS2");
+	bundle->source = eid_intern("ipn:243.350");
+	bundle->report_to = eid_intern("dtn:none");
 
 	bundle->creation_timestamp_ms = 658489863000; // 2020-11-12T09:51:03
 	bundle->sequence_number = 0;
@@ -162,6 +163,153 @@ TEST(bundle7Serializer, simple_bundle)
 	bundle_free(bundle);
 }
 
+struct serialized_data {
+	uint8_t data[128];
+	size_t length;
+};
+
+static void write_memory(void *cla_obj, const void *data, const size_t len)
+{
+	struct serialized_data *const out = cla_obj;
+
+	TEST_ASSERT_TRUE_MESSAGE(
+		out->length + len <= sizeof(out->data),
+		"CBOR too long");
+	memcpy(out->data + out->length, data, len);
+	out->length += len;
+}
+
+TEST(bundle7Serializer, cached_primary_block)
+{
+	struct bundle *bundle = bundle_init();
+
+	TEST_ASSERT_NOT_NULL(bundle);
+
+	bundle->protocol_version = 7;
+	bundle->proc_flags = BUNDLE_FLAG_MUST_NOT_BE_FRAGMENTED
+		| BUNDLE_FLAG_REPORT_DELIVERY;
+	bundle->crc_type = BUNDLE_CRC_TYPE_16;
+	bundle->destination = eid_intern("dtn:GS2");
+	bundle->source = eid_intern("ipn:243.350");
+	bundle->report_to = eid_intern("dtn:none");
+	bundle->creation_timestamp_ms = 658489863000;
+	bundle->lifetime_ms = 86400;
+
+	struct bundle_block *block = bundle_block_create(
+		BUNDLE_BLOCK_TYPE_PAYLOAD
+	);
+
+	block->crc_type = BUNDLE_CRC_TYPE_NONE;
+	block->length = 0;
+	bundle->payload_block = block;
+	bundle->blocks = bundle_block_entry_create(block);
+	TEST_ASSERT_NOT_NULL(bundle->blocks);
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_recalculate_header_length(bundle));
+
+	struct serialized_data first = { .length = 0 };
+	struct serialized_data second = { .length = 0 };
+
+	TEST_ASSERT_NULL(bundle->encoded_primary_block);
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle7_serialize(bundle, write_memory,
+						      &first));
+	TEST_ASSERT_NOT_NULL(bundle->encoded_primary_block);
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle7_serialize(bundle, write_memory,
+						      &second));
+	TEST_ASSERT_EQUAL(bundle_get_serialized_size(bundle), first.length);
+	TEST_ASSERT_EQUAL(first.length, second.length);
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(first.data, second.data, first.length);
+
+	// Modifying the primary block invalidates the encoded block.
+	bundle->sequence_number = 1;
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_recalculate_header_length(bundle));
+	TEST_ASSERT_NULL(bundle->encoded_primary_block);
+	second.length = 0;
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle7_serialize(bundle, write_memory,
+						      &second));
+	TEST_ASSERT_EQUAL(first.length, second.length);
+	TEST_ASSERT_FALSE(memcmp(first.data, second.data, first.length) == 0);
+
+	bundle_free(bundle);
+}
+
+// Copy the data referenced by the iovecs into the given buffer.
+static size_t gather_iov(const struct bundle_iov *iov, uint8_t *buffer,
+			 const size_t length)
+{
+	size_t pos = 0;
+
+	for (size_t i = 0; i < iov->iov_count; i++) {
+		TEST_ASSERT_TRUE(pos + iov->iov[i].iov_len <= length);
+		memcpy(buffer + pos, iov->iov[i].iov_base,
+		       iov->iov[i].iov_len);
+		pos += iov->iov[i].iov_len;
+	}
+	return pos;
+}
+
+TEST(bundle7Serializer, iov_serialization)
+{
+	static const uint8_t payload[] = "Hello world!";
+	struct bundle *bundle = bundle_init();
+	struct bundle_iov iov;
+	uint8_t gathered[128];
+
+	TEST_ASSERT_NOT_NULL(bundle);
+
+	bundle->protocol_version = 7;
+	bundle->proc_flags = BUNDLE_FLAG_MUST_NOT_BE_FRAGMENTED;
+	bundle->crc_type = BUNDLE_CRC_TYPE_32;
+	bundle->destination = eid_intern("dtn:GS2");
+	bundle->source = eid_intern("ipn:243.350");
+	bundle->report_to = eid_intern("dtn:none");
+	bundle->creation_timestamp_ms = 658489863000;
+	bundle->lifetime_ms = 86400;
+
+	struct bundle_block *block = bundle_block_create(
+		BUNDLE_BLOCK_TYPE_PAYLOAD
+	);
+
+	block->crc_type = BUNDLE_CRC_TYPE_16;
+	block->length = sizeof(payload);
+	block->data = malloc(sizeof(payload));
+	TEST_ASSERT_NOT_NULL(block->data);
+	memcpy(block->data, payload, sizeof(payload));
+	bundle->payload_block = block;
+	bundle->blocks = bundle_block_entry_create(block);
+	TEST_ASSERT_NOT_NULL(bundle->blocks);
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_recalculate_header_length(bundle));
+
+	struct serialized_data expected = { .length = 0 };
+
+	bundle_iov_init(&iov);
+
+	// Serializing again reuses the buffers of the first run.
+	for (int i = 0; i < 2; i++) {
+		TEST_ASSERT_EQUAL(UD3TN_OK, bundle_serialize_iov(bundle, &iov));
+		TEST_ASSERT_EQUAL(bundle_get_serialized_size(bundle),
+				  iov.length);
+		TEST_ASSERT_EQUAL(iov.length,
+				  gather_iov(&iov, gathered, sizeof(gathered)));
+		if (i == 0)
+			TEST_ASSERT_EQUAL(UD3TN_OK, bundle7_serialize(
+				bundle, write_memory, &expected));
+		TEST_ASSERT_EQUAL(expected.length, iov.length);
+		TEST_ASSERT_EQUAL_UINT8_ARRAY(expected.data, gathered,
+					      iov.length);
+	}
+
+	// Bundle header, cached primary block, block header, payload data,
+	// CRC and trailer, whereby adjacent encoded pieces are merged
+	TEST_ASSERT_EQUAL(5, iov.iov_count);
+	TEST_ASSERT_EQUAL_PTR(bundle->encoded_primary_block,
+			      iov.iov[1].iov_base);
+	TEST_ASSERT_EQUAL_PTR(block->data, iov.iov[3].iov_base);
+	TEST_ASSERT_EQUAL(sizeof(payload), iov.iov[3].iov_len);
+
+	bundle_iov_free(&iov);
+	bundle_free(bundle);
+}
+
 // -----------------------
 // CRC 16 AX.25 Generation
 // -----------------------
@@ -223,9 +371,9 @@ TEST(bundle7Serializer, crc16_generation)
 	bundle->proc_flags = BUNDLE_FLAG_NONE;
 	bundle->crc_type = BUNDLE_CRC_TYPE_16;
 
-	bundle->destination = strdup("dtn:GS2");
-	bundle->source = strdup("dtn:none");
-	bundle->report_to = strdup("dtn:none");
+	bundle->destination = eid_intern("dtn:GS2");
+	bundle->source = eid_intern("dtn:none");
+	bundle->report_to = eid_intern("dtn:none");
 
 	bundle->creation_timestamp_ms = 0;
 	bundle->sequence_number = 0;
@@ -338,9 +486,9 @@ TEST(bundle7Serializer, crc32_generation)
 	bundle->proc_flags = BUNDLE_FLAG_NONE;
 	bundle->crc_type = BUNDLE_CRC_TYPE_32;
 
-	bundle->destination = strdup("dtn:GS2");
-	bundle->source = strdup("dtn:none");
-	bundle->report_to = strdup("dtn:none");
+	bundle->destination = eid_intern("dtn:GS2");
+	bundle->source = eid_intern("dtn:none");
+	bundle->report_to = eid_intern("dtn:none");
 
 	bundle->creation_timestamp_ms = 0;
 	bundle->sequence_number = 0;
@@ -536,6 +684,8 @@ TEST_GROUP_RUNNER(bundle7Serializer)
 	RUN_TEST_CASE(bundle7Serializer, hop_count);
 	RUN_TEST_CASE(bundle7Serializer, bundle_age);
 	RUN_TEST_CASE(bundle7Serializer, simple_bundle);
+	RUN_TEST_CASE(bundle7Serializer, cached_primary_block);
+	RUN_TEST_CASE(bundle7Serializer, iov_serialization);
 	RUN_TEST_CASE(bundle7Serializer, crc16_generation);
 	RUN_TEST_CASE(bundle7Serializer, crc32_generation);
 }
@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/bundle.h"
+#include "ud3tn/bundle_arena.h"
+#include "ud3tn/result.h"
+#include "ud3tn/shared_buffer.h"
+
+#include "testud3tn_unity.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+static struct bundle_arena arena;
+
+TEST_GROUP(bundle_arena);
+
+TEST_SETUP(bundle_arena)
+{
+	arena = (struct bundle_arena){ NULL, 0 };
+}
+
+TEST_TEAR_DOWN(bundle_arena)
+{
+	bundle_arena_release(&arena);
+}
+
+TEST(bundle_arena, small_blocks_share_arena)
+{
+	struct bundle_block *a = bundle_block_create(BUNDLE_BLOCK_TYPE_HOP_COUNT);
+	struct bundle_block *b = bundle_block_create(BUNDLE_BLOCK_TYPE_PAYLOAD);
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_arena_alloc_block_data(&arena, a, 3));
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_arena_alloc_block_data(&arena, b, 5));
+	TEST_ASSERT_NOT_NULL(a->buffer);
+	TEST_ASSERT_EQUAL_PTR(a->buffer, b->buffer);
+	TEST_ASSERT_EQUAL_PTR(a->data + 3, b->data);
+	memset(a->data, 0xAA, 3);
+	memset(b->data, 0xBB, 5);
+
+	// The arena stays valid as long as a block references it.
+	bundle_arena_release(&arena);
+	bundle_block_free(a);
+	TEST_ASSERT_EQUAL_UINT8(0xBB, b->data[4]);
+	TEST_ASSERT_TRUE(shared_buffer_is_exclusive(b->buffer));
+	bundle_block_free(b);
+}
+
+TEST(bundle_arena, large_blocks_separate)
+{
+	struct bundle_block *a = bundle_block_create(BUNDLE_BLOCK_TYPE_PAYLOAD);
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_arena_alloc_block_data(
+		&arena, a, BUNDLE_ARENA_MAX_BLOCK_SIZE + 1));
+	TEST_ASSERT_NULL(a->buffer);
+	TEST_ASSERT_NOT_NULL(a->data);
+	TEST_ASSERT_NULL(arena.buffer);
+	bundle_block_free(a);
+}
+
+TEST(bundle_arena, new_arena_if_full)
+{
+	struct bundle_block *blocks[BUNDLE_ARENA_SIZE + 1];
+	const size_t count = BUNDLE_ARENA_SIZE + 1;
+
+	for (size_t i = 0; i < count; i++) {
+		blocks[i] = bundle_block_create(BUNDLE_BLOCK_TYPE_PAYLOAD);
+		TEST_ASSERT_EQUAL(UD3TN_OK, bundle_arena_alloc_block_data(
+			&arena, blocks[i], 1));
+		blocks[i]->data[0] = (uint8_t)i;
+	}
+	TEST_ASSERT_EQUAL_PTR(blocks[0]->buffer, blocks[count - 2]->buffer);
+	TEST_ASSERT_NOT_EQUAL(blocks[0]->buffer, blocks[count - 1]->buffer);
+	TEST_ASSERT_EQUAL(1, arena.used);
+	for (size_t i = 0; i < count; i++) {
+		TEST_ASSERT_EQUAL_UINT8((uint8_t)i, blocks[i]->data[0]);
+		bundle_block_free(blocks[i]);
+	}
+}
+
+TEST(bundle_arena, payload_to_adu)
+{
+	struct bundle *bundle = bundle_init();
+	struct bundle_block *pl = bundle_block_create(BUNDLE_BLOCK_TYPE_PAYLOAD);
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_arena_alloc_block_data(&arena, pl, 4));
+	memcpy(pl->data, "test", 4);
+	pl->length = 4;
+	bundle->blocks = bundle_block_entry_create(pl);
+	bundle->payload_block = pl;
+	bundle_arena_release(&arena);
+
+	struct bundle_adu adu = bundle_to_adu(bundle);
+
+	// The ADU keeps the arena alive after the bundle is gone.
+	bundle_free(bundle);
+	TEST_ASSERT_EQUAL(4, adu.length);
+	TEST_ASSERT_EQUAL_MEMORY("test", adu.payload, 4);
+	bundle_adu_free_members(adu);
+}
+
+TEST(bundle_arena, shared_buffer_create)
+{
+	struct shared_buffer *buffer = shared_buffer_create(16);
+
+	TEST_ASSERT_NOT_NULL(buffer);
+	TEST_ASSERT_EQUAL(16, buffer->length);
+	TEST_ASSERT_TRUE(shared_buffer_is_exclusive(buffer));
+	memset(buffer->data, 0x42, 16);
+
+	// Inline data cannot be taken over, thus, it is copied.
+	uint8_t *const copy = shared_buffer_take_slice(buffer, buffer->data, 16);
+
+	TEST_ASSERT_NOT_NULL(copy);
+	TEST_ASSERT_EQUAL_UINT8(0x42, copy[15]);
+	free(copy);
+}
+
+TEST_GROUP_RUNNER(bundle_arena)
+{
+	RUN_TEST_CASE(bundle_arena, small_blocks_share_arena);
+	RUN_TEST_CASE(bundle_arena, large_blocks_separate);
+	RUN_TEST_CASE(bundle_arena, new_arena_if_full);
+	RUN_TEST_CASE(bundle_arena, payload_to_adu);
+	RUN_TEST_CASE(bundle_arena, shared_buffer_create);
+}
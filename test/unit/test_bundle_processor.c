@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/bundle.h"
+#include "ud3tn/bundle_processor.h"
+#include "ud3tn/eid_intern.h"
+
+#include "bundle7/create.h"
+
+#include "testud3tn_unity.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NODE_COUNT 64
+
+static struct bundle *create_bundle(const char *const source,
+				    const char *const destination,
+				    const uint64_t sequence_number)
+{
+	struct bundle *const bundle = bundle7_create_local(
+		malloc(1), 1, source, destination,
+		658489863000, sequence_number, 86400000, BUNDLE_FLAG_NONE
+	);
+
+	TEST_ASSERT_NOT_NULL(bundle);
+	return bundle;
+}
+
+static uint8_t get_worker(const char *const source,
+			  const char *const destination,
+			  const bool destination_is_local,
+			  const uint8_t worker_count)
+{
+	struct bundle *const bundle = create_bundle(source, destination, 1);
+	const uint8_t index = bundle_processor_get_worker_index(
+		bundle,
+		destination_is_local,
+		worker_count
+	);
+
+	TEST_ASSERT_TRUE(index < worker_count);
+	bundle_free(bundle);
+	return index;
+}
+
+TEST_GROUP(bundle_processor);
+
+TEST_SETUP(bundle_processor)
+{
+}
+
+TEST_TEAR_DOWN(bundle_processor)
+{
+}
+
+TEST(bundle_processor, single_worker)
+{
+	TEST_ASSERT_EQUAL(0, get_worker("ipn:2.1", "ipn:1.1", true, 1));
+	TEST_ASSERT_EQUAL(0, get_worker("ipn:2.1", "ipn:3.1", false, 1));
+	TEST_ASSERT_EQUAL(0, get_worker("dtn://a.dtn/x", "dtn://b.dtn/y",
+					false, 1));
+}
+
+TEST(bundle_processor, local_bundles_by_source_node)
+{
+	// All bundles of one source node meet the same reassembly and
+	// duplicate detection state, regardless of the endpoints.
+	const uint8_t ipn = get_worker("ipn:2.1", "ipn:1.1", true, 8);
+	const uint8_t dtn = get_worker("dtn://a.dtn/x", "dtn://local.dtn/a",
+				       true, 8);
+
+	TEST_ASSERT_EQUAL(ipn, get_worker("ipn:2.42", "ipn:1.1", true, 8));
+	TEST_ASSERT_EQUAL(ipn, get_worker("ipn:2.1", "ipn:1.2", true, 8));
+	TEST_ASSERT_EQUAL(dtn, get_worker("dtn://a.dtn/y/z",
+					  "dtn://local.dtn/b", true, 8));
+
+	// Fragments of a bundle only differ in their offsets.
+	struct bundle *const bundle = create_bundle("ipn:2.1", "ipn:1.1", 7);
+
+	bundle->proc_flags |= BUNDLE_FLAG_IS_FRAGMENT;
+	bundle->fragment_offset = 1000;
+	bundle->total_adu_length = 2000;
+	TEST_ASSERT_EQUAL(ipn, bundle_processor_get_worker_index(bundle,
+								 true, 8));
+	bundle_free(bundle);
+}
+
+TEST(bundle_processor, forwarded_bundles_by_destination_node)
+{
+	// Bundles of one flow are kept in order by a single worker.
+	const uint8_t ipn = get_worker("ipn:2.1", "ipn:3.1", false, 8);
+	const uint8_t dtn = get_worker("dtn://a.dtn/x", "dtn://b.dtn/y",
+				       false, 8);
+
+	TEST_ASSERT_EQUAL(ipn, get_worker("ipn:4.1", "ipn:3.1", false, 8));
+	TEST_ASSERT_EQUAL(ipn, get_worker("ipn:2.1", "ipn:3.99", false, 8));
+	TEST_ASSERT_EQUAL(dtn, get_worker("dtn://c.dtn/", "dtn://b.dtn/z",
+					  false, 8));
+}
+
+TEST(bundle_processor, nodes_use_all_workers)
+{
+	static const uint8_t worker_counts[] = { 2, 4, 8 };
+	char destination[32];
+
+	for (size_t i = 0; i < sizeof(worker_counts); i++) {
+		unsigned int bundles[8] = { 0 };
+
+		for (unsigned int node = 0; node < NODE_COUNT; node++) {
+			snprintf(destination, sizeof(destination),
+				 "ipn:%u.1", node + 10);
+			bundles[get_worker("ipn:2.1", destination, false,
+					   worker_counts[i])]++;
+		}
+		for (uint8_t w = 0; w < worker_counts[i]; w++)
+			TEST_ASSERT_NOT_EQUAL(0, bundles[w]);
+	}
+}
+
+TEST_GROUP_RUNNER(bundle_processor)
+{
+	RUN_TEST_CASE(bundle_processor, single_worker);
+	RUN_TEST_CASE(bundle_processor, local_bundles_by_source_node);
+	RUN_TEST_CASE(bundle_processor, forwarded_bundles_by_destination_node);
+	RUN_TEST_CASE(bundle_processor, nodes_use_all_workers);
+}
@@ -0,0 +1,284 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "cla/cla.h"
+#include "cla/cla_contact_rx_task.h"
+
+#include "bundle7/parser.h"
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/common.h"
+#include "ud3tn/parser.h"
+
+#include "testud3tn_unity.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+extern const uint8_t cbor_simple_bundle[];
+extern const size_t len_simple_bundle;
+
+#define MAX_BUNDLES 8
+#define MAX_SEGMENTS 4
+#define PAYLOAD_LENGTH 1000
+
+// The data returned by the consecutive reads from the link
+struct segment {
+	const uint8_t *data;
+	size_t length;
+};
+
+static struct {
+	struct segment segments[MAX_SEGMENTS];
+	size_t count;
+	size_t current;
+} script;
+
+static struct bundle *bundles[MAX_BUNDLES];
+static size_t bundle_count;
+
+static struct cla_vtable vtable;
+static struct cla_config config;
+static struct cla_link rx_link;
+
+// A bundle without CRCs and a payload of PAYLOAD_LENGTH bytes, read in bulk
+static uint8_t large_bundle[64 + PAYLOAD_LENGTH];
+static size_t large_bundle_length;
+
+static void collect_bundle(struct bundle *bundle, void *param)
+{
+	(void)param;
+	TEST_ASSERT_TRUE(bundle_count < MAX_BUNDLES);
+	if (bundle_count < MAX_BUNDLES)
+		bundles[bundle_count++] = bundle;
+	else
+		bundle_free(bundle);
+}
+
+static void reset_parsers(struct cla_link *const cla_link)
+{
+	rx_task_reset_parsers(&cla_link->rx_task_data);
+	cla_link->rx_task_data.cur_parser = (
+		cla_link->rx_task_data.bundle7_parser.basedata
+	);
+}
+
+static size_t forward_to_parser(struct cla_link *const cla_link,
+				const uint8_t *const buffer,
+				const size_t length)
+{
+	struct rx_task_data *const rx_data = &cla_link->rx_task_data;
+
+	if (rx_data->payload_type == PAYLOAD_UNKNOWN)
+		return select_bundle_parser_version(rx_data, buffer, length);
+	return bundle7_parser_read(&rx_data->bundle7_parser, buffer, length);
+}
+
+static enum ud3tn_result scripted_read(struct cla_link *const cla_link,
+				       uint8_t *const buffer,
+				       const size_t length,
+				       size_t *const bytes_read)
+{
+	(void)cla_link;
+	if (script.current == script.count)
+		return UD3TN_FAIL;
+
+	struct segment *const segment = &script.segments[script.current];
+	const size_t bytes = MIN(length, segment->length);
+
+	memcpy(buffer, segment->data, bytes);
+	segment->data += bytes;
+	segment->length -= bytes;
+	if (segment->length == 0)
+		script.current++;
+
+	*bytes_read = bytes;
+	return UD3TN_OK;
+}
+
+static void add_segment(const uint8_t *data, const size_t length)
+{
+	TEST_ASSERT_TRUE(script.count < MAX_SEGMENTS);
+	script.segments[script.count++] = (struct segment){ data, length };
+}
+
+static size_t build_large_bundle(void)
+{
+	static const uint8_t header[] = {
+		0x9f,
+		0x88, 0x07, 0x00, 0x00,			// Primary block
+		0x82, 0x02, 0x82, 0x01, 0x01,
+		0x82, 0x02, 0x82, 0x02, 0x01,
+		0x82, 0x01, 0x00,
+		0x82, 0x00, 0x00,
+		0x1a, 0x00, 0x01, 0x51, 0x80,
+		0x85, 0x01, 0x01, 0x00, 0x00,		// Payload block
+		0x59, PAYLOAD_LENGTH >> 8, PAYLOAD_LENGTH & 0xff,
+	};
+	size_t length = sizeof(header);
+
+	memcpy(large_bundle, header, sizeof(header));
+	for (size_t i = 0; i < PAYLOAD_LENGTH; i++)
+		large_bundle[length++] = (uint8_t)i;
+	large_bundle[length++] = 0xff;
+
+	return length;
+}
+
+TEST_GROUP(cla_rx_task);
+
+TEST_SETUP(cla_rx_task)
+{
+	memset(&script, 0, sizeof(script));
+	bundle_count = 0;
+
+	vtable = (struct cla_vtable){
+		.cla_rx_task_reset_parsers = reset_parsers,
+		.cla_rx_task_forward_to_specific_parser = forward_to_parser,
+		.cla_read = scripted_read,
+	};
+	config = (struct cla_config){ .vtable = &vtable };
+	rx_link = (struct cla_link){ .config = &config };
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, rx_task_data_init(&rx_link.rx_task_data,
+						      &config));
+	rx_link.rx_task_data.bundle7_parser.send_callback = collect_bundle;
+	rx_link.rx_task_data.bundle7_parser.send_param = NULL;
+	rx_link.rx_task_data.cur_parser = (
+		rx_link.rx_task_data.bundle7_parser.basedata
+	);
+
+	large_bundle_length = build_large_bundle();
+}
+
+TEST_TEAR_DOWN(cla_rx_task)
+{
+	for (size_t i = 0; i < bundle_count; i++)
+		bundle_free(bundles[i]);
+	bundle_count = 0;
+	rx_task_data_deinit(&rx_link.rx_task_data);
+}
+
+static void check_large_bundle(const struct bundle *bundle)
+{
+	TEST_ASSERT_EQUAL(PAYLOAD_LENGTH, bundle->payload_block->length);
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(&large_bundle[large_bundle_length -
+						    PAYLOAD_LENGTH - 1],
+				      bundle->payload_block->data,
+				      PAYLOAD_LENGTH);
+}
+
+TEST(cla_rx_task, several_bundles_per_chunk)
+{
+	uint8_t data[3 * 128];
+	const size_t length = 3 * len_simple_bundle;
+
+	TEST_ASSERT_TRUE(length <= sizeof(data));
+	for (size_t i = 0; i < 3; i++)
+		memcpy(&data[i * len_simple_bundle], cbor_simple_bundle,
+		       len_simple_bundle);
+	add_segment(data, length);
+
+	TEST_ASSERT_EQUAL(length, rx_chunk_read(&rx_link));
+	TEST_ASSERT_EQUAL(3, bundle_count);
+	TEST_ASSERT_EQUAL_PTR(rx_link.rx_task_data.input_buffer.end,
+			      rx_link.rx_task_data.input_buffer.read);
+	TEST_ASSERT_EQUAL(PARSER_STATUS_GOOD,
+			  rx_link.rx_task_data.cur_parser->status);
+}
+
+TEST(cla_rx_task, bundles_around_bulk_read)
+{
+	const size_t prefix = large_bundle_length - PAYLOAD_LENGTH / 2;
+	uint8_t first[128 + sizeof(large_bundle)];
+	uint8_t second[128 + sizeof(large_bundle)];
+
+	// A complete bundle followed by the first half of the payload of the
+	// large bundle, which is the bulk read after the chunk.
+	memcpy(first, cbor_simple_bundle, len_simple_bundle);
+	memcpy(&first[len_simple_bundle], large_bundle, prefix);
+	add_segment(first, len_simple_bundle + prefix);
+
+	// The rest of the payload, followed by the next bundle
+	const size_t rest = large_bundle_length - prefix;
+
+	memcpy(second, &large_bundle[prefix], rest);
+	memcpy(&second[rest], cbor_simple_bundle, len_simple_bundle);
+	add_segment(second, rest + len_simple_bundle);
+
+	TEST_ASSERT_EQUAL(len_simple_bundle + prefix, rx_chunk_read(&rx_link));
+	TEST_ASSERT_EQUAL(1, bundle_count);
+	TEST_ASSERT_TRUE(HAS_FLAG(rx_link.rx_task_data.cur_parser->flags,
+				  PARSER_FLAG_BULK_READ));
+
+	// The read position is moved to the start of the input buffer when
+	// it is cleared, all of the received data has been consumed.
+	TEST_ASSERT_EQUAL(rest + len_simple_bundle, rx_bulk_read(&rx_link));
+	TEST_ASSERT_EQUAL(3, bundle_count);
+	check_large_bundle(bundles[1]);
+	TEST_ASSERT_EQUAL_PTR(rx_link.rx_task_data.input_buffer.end,
+			      rx_link.rx_task_data.input_buffer.read);
+}
+
+TEST(cla_rx_task, compaction_in_chunk_read)
+{
+	struct rx_task_data *const rx_data = &rx_link.rx_task_data;
+	const size_t prefix = len_simple_bundle / 2;
+	uint8_t *const read = (
+		rx_data->input_buffer.start + CLA_RX_BUFFER_SIZE * 3 / 4
+	);
+
+	// The start of a bundle is left unconsumed in the second half of the
+	// buffer, it is moved to the start before receiving its rest.
+	memcpy(read, cbor_simple_bundle, prefix);
+	rx_data->input_buffer.read = read;
+	rx_data->input_buffer.end = read + prefix;
+	add_segment(&cbor_simple_bundle[prefix], len_simple_bundle - prefix);
+
+	TEST_ASSERT_EQUAL(len_simple_bundle, rx_chunk_read(&rx_link));
+	TEST_ASSERT_EQUAL(1, bundle_count);
+	TEST_ASSERT_EQUAL_PTR(rx_data->input_buffer.start + len_simple_bundle,
+			      rx_data->input_buffer.read);
+	TEST_ASSERT_EQUAL_PTR(rx_data->input_buffer.end,
+			      rx_data->input_buffer.read);
+}
+
+TEST(cla_rx_task, compaction_in_bulk_read)
+{
+	struct rx_task_data *const rx_data = &rx_link.rx_task_data;
+	const size_t header = large_bundle_length - PAYLOAD_LENGTH - 1;
+	const size_t unconsumed = PAYLOAD_LENGTH / 4;
+	uint8_t *const read = (
+		rx_data->input_buffer.start + CLA_RX_BUFFER_SIZE * 3 / 4
+	);
+
+	// Let the parser request the payload in bulk.
+	TEST_ASSERT_EQUAL(header, select_bundle_parser_version(
+		rx_data, large_bundle, header
+	));
+	TEST_ASSERT_TRUE(HAS_FLAG(rx_data->cur_parser->flags,
+				  PARSER_FLAG_BULK_READ));
+	TEST_ASSERT_EQUAL(PAYLOAD_LENGTH, rx_data->cur_parser->next_bytes);
+
+	// Part of the payload is already in the second half of the buffer.
+	memcpy(read, &large_bundle[header], unconsumed);
+	rx_data->input_buffer.read = read;
+	rx_data->input_buffer.end = read + unconsumed;
+	add_segment(&large_bundle[header + unconsumed],
+		    large_bundle_length - header - unconsumed);
+
+	// The payload and the final "break" are consumed from the buffer.
+	TEST_ASSERT_EQUAL(PAYLOAD_LENGTH + 1, rx_bulk_read(&rx_link));
+	TEST_ASSERT_EQUAL(1, bundle_count);
+	check_large_bundle(bundles[0]);
+	TEST_ASSERT_EQUAL_PTR(rx_data->input_buffer.start + PAYLOAD_LENGTH + 1,
+			      rx_data->input_buffer.read);
+}
+
+TEST_GROUP_RUNNER(cla_rx_task)
+{
+	RUN_TEST_CASE(cla_rx_task, several_bundles_per_chunk);
+	RUN_TEST_CASE(cla_rx_task, bundles_around_bulk_read);
+	RUN_TEST_CASE(cla_rx_task, compaction_in_chunk_read);
+	RUN_TEST_CASE(cla_rx_task, compaction_in_bulk_read);
+}
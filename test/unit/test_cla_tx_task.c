@@ -0,0 +1,234 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "cla/cla.h"
+#include "cla/cla_contact_tx_task.h"
+
+#include "bundle6/create.h"
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/result.h"
+
+#include "testud3tn_unity.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/uio.h>
+
+#define CLA_ADDRESS "mtcp:receiver"
+
+struct output {
+	uint8_t data[2 * BUNDLE_SMALL_MAX_SIZE];
+	size_t length;
+};
+
+// The data handed over to the CLA and the number of calls of the respective
+// vtable functions
+static struct output sent;
+static unsigned int packets, iov_packets, data_calls;
+static unsigned int begun, ended;
+static size_t announced_length;
+
+// The bundle as serialized via bundle_serialize()
+static struct output expected;
+
+static struct bundle *bundle;
+static struct cla_vtable vtable;
+static struct cla_config config;
+static struct cla_link tx_link;
+
+static void append(struct output *const out, const void *const data,
+		   const size_t length)
+{
+	TEST_ASSERT_TRUE(length <= sizeof(out->data) - out->length);
+	if (length > sizeof(out->data) - out->length)
+		return;
+	memcpy(&out->data[out->length], data, length);
+	out->length += length;
+}
+
+static void write_expected(void *obj, const void *data, const size_t length)
+{
+	append(obj, data, length);
+}
+
+static void send_packet(struct cla_link *link, uint8_t *data, size_t length,
+			char *cla_address)
+{
+	TEST_ASSERT_EQUAL_PTR(&tx_link, link);
+	TEST_ASSERT_EQUAL_STRING(CLA_ADDRESS, cla_address);
+	packets++;
+	append(&sent, data, length);
+}
+
+static void send_packet_iov(struct cla_link *link, struct bundle_iov *iov,
+			    char *cla_address)
+{
+	TEST_ASSERT_EQUAL_PTR(&tx_link, link);
+	TEST_ASSERT_EQUAL_STRING(CLA_ADDRESS, cla_address);
+	iov_packets++;
+	for (size_t i = 0; i < iov->iov_count; i++)
+		append(&sent, iov->iov[i].iov_base, iov->iov[i].iov_len);
+	TEST_ASSERT_EQUAL(iov->length, sent.length);
+}
+
+static void begin_packet(struct cla_link *link, size_t length,
+			 char *cla_address)
+{
+	TEST_ASSERT_EQUAL_PTR(&tx_link, link);
+	TEST_ASSERT_EQUAL_STRING(CLA_ADDRESS, cla_address);
+	begun++;
+	announced_length = length;
+}
+
+static void send_packet_data(struct cla_link *link, const void *data,
+			     const size_t length)
+{
+	TEST_ASSERT_EQUAL_PTR(&tx_link, link);
+	TEST_ASSERT_EQUAL(begun, ended + 1);
+	data_calls++;
+	append(&sent, data, length);
+}
+
+static void end_packet(struct cla_link *link)
+{
+	TEST_ASSERT_EQUAL_PTR(&tx_link, link);
+	ended++;
+}
+
+// Create a bundle of exactly the given serialized size.
+static struct bundle *create_bundle(const size_t size)
+{
+	struct bundle *b = NULL;
+	size_t payload_length = size;
+
+	// The size of the payload length SDNV does not change between both
+	// attempts, thus, the second one is exact.
+	for (int attempt = 0; attempt < 2; attempt++) {
+		bundle_free(b);
+		b = bundle6_create_local(
+			calloc(1, payload_length), payload_length,
+			"dtn://sender/src", "dtn://receiver/sink",
+			0, 1, 3600000, BUNDLE_FLAG_NONE
+		);
+		TEST_ASSERT_NOT_NULL(b);
+		payload_length += size - bundle_get_serialized_size(b);
+	}
+	TEST_ASSERT_EQUAL(size, bundle_get_serialized_size(b));
+
+	// Fill the payload, such that misplaced data is detected.
+	for (size_t i = 0; i < b->payload_block->length; i++)
+		b->payload_block->data[i] = (uint8_t)i;
+
+	expected.length = 0;
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_serialize(b, write_expected,
+						     &expected));
+	TEST_ASSERT_EQUAL(size, expected.length);
+	return b;
+}
+
+static enum ud3tn_result send_bundle(void)
+{
+	return cla_contact_tx_send_bundle(&tx_link, bundle, CLA_ADDRESS);
+}
+
+static void check_sent(void)
+{
+	TEST_ASSERT_EQUAL(expected.length, sent.length);
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(expected.data, sent.data,
+				      expected.length);
+}
+
+TEST_GROUP(cla_tx_task);
+
+TEST_SETUP(cla_tx_task)
+{
+	memset(&sent, 0, sizeof(sent));
+	packets = 0;
+	iov_packets = 0;
+	data_calls = 0;
+	begun = 0;
+	ended = 0;
+	announced_length = 0;
+	bundle = NULL;
+
+	vtable = (struct cla_vtable){
+		.cla_begin_packet = begin_packet,
+		.cla_end_packet = end_packet,
+		.cla_send_packet_data = send_packet_data,
+		.cla_send_packet = send_packet,
+		.cla_send_packet_iov = send_packet_iov,
+	};
+	config = (struct cla_config){ .vtable = &vtable };
+	tx_link = (struct cla_link){ .config = &config };
+	bundle_iov_init(&tx_link.tx_iov);
+}
+
+TEST_TEAR_DOWN(cla_tx_task)
+{
+	bundle_iov_free(&tx_link.tx_iov);
+	bundle_free(bundle);
+}
+
+TEST(cla_tx_task, small_bundle_as_single_packet)
+{
+	// The largest bundle fitting into the buffer on the stack
+	bundle = create_bundle(BUNDLE_SMALL_MAX_SIZE);
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, send_bundle());
+	TEST_ASSERT_EQUAL(1, packets);
+	TEST_ASSERT_EQUAL(0, iov_packets + begun + data_calls + ended);
+	check_sent();
+}
+
+TEST(cla_tx_task, small_bundle_without_send_packet)
+{
+	vtable.cla_send_packet = NULL;
+	bundle = create_bundle(BUNDLE_SMALL_MAX_SIZE);
+
+	// The serialized bundle is passed to the CLA at once.
+	TEST_ASSERT_EQUAL(UD3TN_OK, send_bundle());
+	TEST_ASSERT_EQUAL(1, begun);
+	TEST_ASSERT_EQUAL(1, data_calls);
+	TEST_ASSERT_EQUAL(1, ended);
+	TEST_ASSERT_EQUAL(BUNDLE_SMALL_MAX_SIZE, announced_length);
+	TEST_ASSERT_EQUAL(0, iov_packets);
+	check_sent();
+}
+
+TEST(cla_tx_task, large_bundle_as_iov)
+{
+	// Just too large for the buffer on the stack
+	bundle = create_bundle(BUNDLE_SMALL_MAX_SIZE + 1);
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, send_bundle());
+	TEST_ASSERT_EQUAL(0, packets);
+	TEST_ASSERT_EQUAL(1, iov_packets);
+	TEST_ASSERT_EQUAL(0, begun + data_calls + ended);
+	check_sent();
+}
+
+TEST(cla_tx_task, large_bundle_without_send_packet_iov)
+{
+	vtable.cla_send_packet_iov = NULL;
+	bundle = create_bundle(BUNDLE_SMALL_MAX_SIZE + 1);
+
+	// The bundle is passed to the CLA piece by piece while serializing.
+	TEST_ASSERT_EQUAL(UD3TN_OK, send_bundle());
+	TEST_ASSERT_EQUAL(0, packets);
+	TEST_ASSERT_EQUAL(1, begun);
+	TEST_ASSERT_TRUE(data_calls > 1);
+	TEST_ASSERT_EQUAL(1, ended);
+	TEST_ASSERT_EQUAL(BUNDLE_SMALL_MAX_SIZE + 1, announced_length);
+	check_sent();
+}
+
+TEST_GROUP_RUNNER(cla_tx_task)
+{
+	RUN_TEST_CASE(cla_tx_task, small_bundle_as_single_packet);
+	RUN_TEST_CASE(cla_tx_task, small_bundle_without_send_packet);
+	RUN_TEST_CASE(cla_tx_task, large_bundle_as_iov);
+	RUN_TEST_CASE(cla_tx_task, large_bundle_without_send_packet_iov);
+}
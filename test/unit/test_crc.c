@@ -88,9 +88,47 @@ TEST(crc, crc32)
 	TEST_ASSERT_EQUAL_HEX32(0xee7f4af1, crc.checksum);
 }
 
+TEST(crc, crc_feed_bytes)
+{
+	const enum crc_version versions[] = {
+		CRC16_X25, CRC16_CCITT_FALSE, CRC32
+	};
+	uint8_t data[64];
+	struct crc_stream bytewise, bulk;
+
+	for (size_t i = 0; i < sizeof(data); i++)
+		data[i] = (uint8_t)(i * 37 + 11);
+
+	// Cover all alignments and lengths around the word size
+	for (size_t v = 0; v < sizeof(versions) / sizeof(versions[0]); v++) {
+		for (size_t offset = 0; offset < 8; offset++) {
+			for (size_t len = 0; len + offset <= 40; len++) {
+				crc_init(&bytewise, versions[v]);
+				crc_init(&bulk, versions[v]);
+				for (size_t i = 0; i < len; i++)
+					bytewise.feed(&bytewise,
+						      data[offset + i]);
+				crc_feed_bytes(&bulk, &data[offset], len);
+				bytewise.feed_eof(&bytewise);
+				bulk.feed_eof(&bulk);
+				TEST_ASSERT_EQUAL_HEX32(bytewise.checksum,
+							bulk.checksum);
+			}
+		}
+	}
+
+	// Feeding in several parts has to yield the same result
+	crc_init(&bulk, CRC32);
+	crc_feed_bytes(&bulk, m4, 3);
+	crc_feed_bytes(&bulk, m4 + 3, sizeof(m4) - 4);
+	bulk.feed_eof(&bulk);
+	TEST_ASSERT_EQUAL_HEX32(0xee7f4af1, bulk.checksum);
+}
+
 TEST_GROUP_RUNNER(crc)
 {
 	RUN_TEST_CASE(crc, crc16_x25);
 	RUN_TEST_CASE(crc, crc16_ccitt_false);
 	RUN_TEST_CASE(crc, crc32);
+	RUN_TEST_CASE(crc, crc_feed_bytes);
 }
@@ -209,6 +209,53 @@ TEST(eid, parse_ipn_ull)
 	TEST_ASSERT_NULL(parse_ipn_ull("", NULL));
 }
 
+TEST(eid, eid_parse)
+{
+	struct eid_parsed parsed;
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, eid_parse("ipn:243.350", &parsed));
+	TEST_ASSERT_EQUAL(EID_SCHEME_IPN, parsed.scheme);
+	TEST_ASSERT_EQUAL_UINT64(243, parsed.ipn_node);
+	TEST_ASSERT_EQUAL_UINT64(350, parsed.ipn_service);
+	TEST_ASSERT_EQUAL(8, parsed.agent_id_offset);
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, eid_parse(
+		"ipn:18446744073709551615.18446744073709551615", &parsed
+	));
+	TEST_ASSERT_EQUAL_UINT64(UINT64_MAX, parsed.ipn_node);
+	TEST_ASSERT_EQUAL_UINT64(UINT64_MAX, parsed.ipn_service);
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, eid_parse("dtn://ud3tn/a/b", &parsed));
+	TEST_ASSERT_EQUAL(EID_SCHEME_DTN, parsed.scheme);
+	TEST_ASSERT_EQUAL(5, parsed.dtn_node_length);
+	TEST_ASSERT_EQUAL(12, parsed.agent_id_offset);
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, eid_parse("dtn://ud3tn/", &parsed));
+	TEST_ASSERT_EQUAL(5, parsed.dtn_node_length);
+	TEST_ASSERT_EQUAL(12, parsed.agent_id_offset);
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, eid_parse("dtn://ud3tn", &parsed));
+	TEST_ASSERT_EQUAL(5, parsed.dtn_node_length);
+	TEST_ASSERT_EQUAL(0, parsed.agent_id_offset);
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, eid_parse("dtn:none", &parsed));
+	TEST_ASSERT_EQUAL(EID_SCHEME_DTN, parsed.scheme);
+	TEST_ASSERT_EQUAL(0, parsed.dtn_node_length);
+	TEST_ASSERT_EQUAL(0, parsed.agent_id_offset);
+
+	// The output is not modified for invalid EIDs.
+	TEST_ASSERT_EQUAL(UD3TN_FAIL, eid_parse("ipn:1.00", &parsed));
+	TEST_ASSERT_EQUAL(UD3TN_FAIL, eid_parse(
+		"ipn:18446744073709551616.0", &parsed
+	));
+	TEST_ASSERT_EQUAL(UD3TN_FAIL, eid_parse("dtn://ud3tn+/", &parsed));
+	TEST_ASSERT_EQUAL(EID_SCHEME_DTN, parsed.scheme);
+	TEST_ASSERT_EQUAL(0, parsed.dtn_node_length);
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, eid_parse("ipn:0.1", NULL));
+	TEST_ASSERT_EQUAL(UD3TN_FAIL, eid_parse(NULL, NULL));
+}
+
 TEST(eid, get_node_id)
 {
 	TEST_ASSERT_EQUAL_ASTRING("dtn://ud3tn/", get_node_id("dtn://ud3tn/a"));
@@ -257,6 +304,7 @@ TEST_GROUP_RUNNER(eid)
 	RUN_TEST_CASE(eid, get_eid_scheme);
 	RUN_TEST_CASE(eid, validate_ipn_eid);
 	RUN_TEST_CASE(eid, parse_ipn_ull);
+	RUN_TEST_CASE(eid, eid_parse);
 	RUN_TEST_CASE(eid, get_node_id);
 	RUN_TEST_CASE(eid, get_agent_id_ptr);
 }
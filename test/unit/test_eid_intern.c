@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/eid.h"
+#include "ud3tn/eid_intern.h"
+
+#include "testud3tn_unity.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+TEST_GROUP(eid_intern);
+
+TEST_SETUP(eid_intern)
+{
+}
+
+TEST_TEAR_DOWN(eid_intern)
+{
+}
+
+TEST(eid_intern, same_string_same_pointer)
+{
+	const size_t count = eid_intern_get_count();
+	char buffer[] = "dtn://intern.dtn/a";
+	const char *const a = eid_intern("dtn://intern.dtn/a");
+	const char *const b = eid_intern(buffer);
+	const char *const c = eid_intern("dtn://intern.dtn/b");
+
+	TEST_ASSERT_NOT_NULL(a);
+	TEST_ASSERT_EQUAL_PTR(a, b);
+	TEST_ASSERT_NOT_EQUAL(a, c);
+	TEST_ASSERT_NOT_EQUAL(buffer, a);
+	TEST_ASSERT_EQUAL_STRING("dtn://intern.dtn/a", a);
+	// Both EIDs and their shared node ID "dtn://intern.dtn/"
+	TEST_ASSERT_EQUAL(count + 3, eid_intern_get_count());
+
+	eid_intern_release(a);
+	eid_intern_release(b);
+	eid_intern_release(c);
+	TEST_ASSERT_EQUAL(count, eid_intern_get_count());
+
+	TEST_ASSERT_NULL(eid_intern(NULL));
+	eid_intern_release(NULL);
+}
+
+TEST(eid_intern, ref_release)
+{
+	const size_t count = eid_intern_get_count();
+	const char *const a = eid_intern("ipn:77.1");
+
+	TEST_ASSERT_EQUAL_PTR(a, eid_intern_ref(a));
+	TEST_ASSERT_NULL(eid_intern_ref(NULL));
+	eid_intern_release(a);
+	TEST_ASSERT_EQUAL(count + 2, eid_intern_get_count());
+	eid_intern_release(a);
+	TEST_ASSERT_EQUAL(count, eid_intern_get_count());
+}
+
+TEST(eid_intern, take)
+{
+	const char *const a = eid_intern("dtn://intern.dtn/take");
+	const char *const b = eid_intern_take(strdup("dtn://intern.dtn/take"));
+
+	TEST_ASSERT_EQUAL_PTR(a, b);
+	TEST_ASSERT_NULL(eid_intern_take(NULL));
+	eid_intern_release(a);
+	eid_intern_release(b);
+}
+
+TEST(eid_intern, info)
+{
+	const char *const ipn = eid_intern("ipn:243.350");
+	const char *const dtn = eid_intern("dtn://intern.dtn/x");
+	const struct eid_intern_info *info = eid_intern_get_info(ipn);
+
+	TEST_ASSERT_EQUAL(EID_SCHEME_IPN, info->scheme);
+	TEST_ASSERT_EQUAL_UINT64(243, info->ipn_node);
+	TEST_ASSERT_EQUAL_UINT64(350, info->ipn_service);
+	TEST_ASSERT_EQUAL(strlen("ipn:243.350"), info->length);
+	TEST_ASSERT_TRUE(info->valid);
+	TEST_ASSERT_EQUAL(8, info->agent_id_offset);
+
+	info = eid_intern_get_info(dtn);
+	TEST_ASSERT_EQUAL(EID_SCHEME_DTN, info->scheme);
+	TEST_ASSERT_EQUAL_UINT64(0, info->ipn_node);
+	TEST_ASSERT_EQUAL(strlen("dtn://intern.dtn/x"), info->length);
+	TEST_ASSERT_TRUE(info->valid);
+	TEST_ASSERT_EQUAL(strlen("intern.dtn"), info->dtn_node_length);
+	TEST_ASSERT_EQUAL(strlen("dtn://intern.dtn/"), info->agent_id_offset);
+
+	eid_intern_release(ipn);
+	eid_intern_release(dtn);
+}
+
+TEST(eid_intern, ipn)
+{
+	const char *const a = eid_intern("ipn:243.350");
+	const char *const b = eid_intern_ipn(243, 350);
+	const char *const c = eid_intern_ipn(UINT64_MAX, 0);
+
+	TEST_ASSERT_EQUAL_PTR(a, b);
+	TEST_ASSERT_EQUAL_STRING("ipn:18446744073709551615.0", c);
+	TEST_ASSERT_EQUAL_UINT64(UINT64_MAX, eid_intern_get_info(c)->ipn_node);
+
+	const char *const invalid = eid_intern("ipn:1.x");
+
+	TEST_ASSERT_FALSE(eid_intern_get_info(invalid)->valid);
+
+	eid_intern_release(a);
+	eid_intern_release(b);
+	eid_intern_release(c);
+	eid_intern_release(invalid);
+}
+
+TEST(eid_intern, node_id)
+{
+	const char *const node = eid_intern("dtn://node1/");
+	const char *const agent = eid_intern("dtn://node1/agent");
+	const char *const ipn = eid_intern("ipn:1.0");
+	const char *const ipn_agent = eid_intern("ipn:1.42");
+	const char *const group = eid_intern("dtn://node1/~group");
+	const char *const none = eid_intern("dtn:none");
+
+	TEST_ASSERT_EQUAL_PTR(node, eid_intern_get_node_id(node));
+	TEST_ASSERT_EQUAL_PTR(node, eid_intern_get_node_id(agent));
+	TEST_ASSERT_EQUAL_PTR(ipn, eid_intern_get_node_id(ipn));
+	TEST_ASSERT_EQUAL_PTR(ipn, eid_intern_get_node_id(ipn_agent));
+	TEST_ASSERT_NULL(eid_intern_get_node_id(group));
+	TEST_ASSERT_NULL(eid_intern_get_node_id(NULL));
+
+	char *const expected = get_node_id("dtn:none");
+
+	TEST_ASSERT_EQUAL_STRING(expected, eid_intern_get_node_id(none));
+	free(expected);
+
+	// The node ID stays valid as long as the EID is referenced.
+	eid_intern_release(node);
+	TEST_ASSERT_EQUAL_STRING("dtn://node1/",
+				 eid_intern_get_node_id(agent));
+
+	eid_intern_release(agent);
+	eid_intern_release(ipn);
+	eid_intern_release(ipn_agent);
+	eid_intern_release(group);
+	eid_intern_release(none);
+}
+
+TEST_GROUP_RUNNER(eid_intern)
+{
+	RUN_TEST_CASE(eid_intern, same_string_same_pointer);
+	RUN_TEST_CASE(eid_intern, ref_release);
+	RUN_TEST_CASE(eid_intern, take);
+	RUN_TEST_CASE(eid_intern, info);
+	RUN_TEST_CASE(eid_intern, ipn);
+	RUN_TEST_CASE(eid_intern, node_id);
+}
@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/hashtable.h"
+
+#include "testud3tn_unity.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MANY_KEYS 1000
+
+static struct hashtable tab;
+static int values[MANY_KEYS];
+static int released;
+
+static void count_release(void *value)
+{
+	(void)value;
+	released++;
+}
+
+static void make_key(char *const buf, const size_t size, const int i)
+{
+	snprintf(buf, size, "dtn://node%d.dtn/", i);
+}
+
+TEST_GROUP(hashtable);
+
+TEST_SETUP(hashtable)
+{
+	hashtable_init(&tab, 0);
+	released = 0;
+}
+
+TEST_TEAR_DOWN(hashtable)
+{
+	hashtable_clear(&tab, NULL);
+}
+
+TEST(hashtable, add_get_remove)
+{
+	TEST_ASSERT_NULL(hashtable_get(&tab, "test"));
+	TEST_ASSERT_EQUAL(UD3TN_OK, hashtable_add(&tab, "test", &values[0]));
+	TEST_ASSERT_EQUAL(UD3TN_FAIL, hashtable_add(&tab, "test", &values[1]));
+	TEST_ASSERT_EQUAL_PTR(&values[0], hashtable_get(&tab, "test"));
+	TEST_ASSERT_NULL(hashtable_get(&tab, "tes"));
+	TEST_ASSERT_NULL(hashtable_get(&tab, "test2"));
+	TEST_ASSERT_EQUAL(1, hashtable_count(&tab));
+	TEST_ASSERT_EQUAL_PTR(&values[0], hashtable_remove(&tab, "test"));
+	TEST_ASSERT_NULL(hashtable_remove(&tab, "test"));
+	TEST_ASSERT_NULL(hashtable_get(&tab, "test"));
+	TEST_ASSERT_EQUAL(0, hashtable_count(&tab));
+}
+
+TEST(hashtable, key_is_copied)
+{
+	char key[] = "dtn://copied.dtn/";
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, hashtable_add(&tab, key, &values[0]));
+	key[6] = 'x';
+	TEST_ASSERT_NULL(hashtable_get(&tab, key));
+	TEST_ASSERT_EQUAL_PTR(&values[0],
+			      hashtable_get(&tab, "dtn://copied.dtn/"));
+}
+
+TEST(hashtable, hashed_matches_unhashed)
+{
+	const char *const key = "ipn:1.0";
+	const uint32_t hash = hashtable_hash(key, strlen(key));
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, hashtable_add(&tab, key, &values[0]));
+	TEST_ASSERT_EQUAL_PTR(
+		&values[0],
+		hashtable_get_hashed(&tab, key, strlen(key), hash)
+	);
+	TEST_ASSERT_EQUAL_PTR(
+		&values[0],
+		hashtable_remove_hashed(&tab, key, strlen(key), hash)
+	);
+	TEST_ASSERT_EQUAL(0, hashtable_count(&tab));
+}
+
+TEST(hashtable, grow_incrementally)
+{
+	char key[32];
+	int i;
+
+	for (i = 0; i < MANY_KEYS; i++) {
+		make_key(key, sizeof(key), i);
+		TEST_ASSERT_EQUAL(UD3TN_OK,
+				  hashtable_add(&tab, key, &values[i]));
+		// Entries have to be found while being moved.
+		make_key(key, sizeof(key), i / 2);
+		TEST_ASSERT_EQUAL_PTR(&values[i / 2],
+				      hashtable_get(&tab, key));
+	}
+	TEST_ASSERT_EQUAL(MANY_KEYS, hashtable_count(&tab));
+	TEST_ASSERT_TRUE(tab.capacity >= MANY_KEYS);
+
+	// Remove every other entry, the rest has to stay reachable.
+	for (i = 0; i < MANY_KEYS; i += 2) {
+		make_key(key, sizeof(key), i);
+		TEST_ASSERT_EQUAL_PTR(&values[i], hashtable_remove(&tab, key));
+	}
+	for (i = 0; i < MANY_KEYS; i++) {
+		make_key(key, sizeof(key), i);
+		TEST_ASSERT_EQUAL_PTR(i % 2 ? &values[i] : NULL,
+				      hashtable_get(&tab, key));
+	}
+	TEST_ASSERT_EQUAL(MANY_KEYS / 2, hashtable_count(&tab));
+}
+
+TEST(hashtable, colliding_hashes)
+{
+	char key[32];
+	int i;
+
+	// All keys share the same hash, i.e. form a single probe sequence
+	// that wraps around the end of the array.
+	for (i = 0; i < 64; i++) {
+		make_key(key, sizeof(key), i);
+		TEST_ASSERT_EQUAL(UD3TN_OK, hashtable_add_hashed(
+			&tab, key, strlen(key), UINT32_MAX, &values[i]
+		));
+	}
+	for (i = 0; i < 64; i += 3) {
+		make_key(key, sizeof(key), i);
+		TEST_ASSERT_EQUAL_PTR(&values[i], hashtable_remove_hashed(
+			&tab, key, strlen(key), UINT32_MAX
+		));
+	}
+	for (i = 0; i < 64; i++) {
+		make_key(key, sizeof(key), i);
+		TEST_ASSERT_EQUAL_PTR(
+			i % 3 ? &values[i] : NULL,
+			hashtable_get_hashed(&tab, key, strlen(key), UINT32_MAX)
+		);
+	}
+}
+
+TEST(hashtable, clear)
+{
+	char key[32];
+	int i;
+
+	for (i = 0; i < 100; i++) {
+		make_key(key, sizeof(key), i);
+		TEST_ASSERT_EQUAL(UD3TN_OK,
+				  hashtable_add(&tab, key, &values[i]));
+	}
+	hashtable_clear(&tab, count_release);
+	TEST_ASSERT_EQUAL(100, released);
+	TEST_ASSERT_EQUAL(0, hashtable_count(&tab));
+	make_key(key, sizeof(key), 0);
+	TEST_ASSERT_NULL(hashtable_get(&tab, key));
+	TEST_ASSERT_EQUAL(UD3TN_OK, hashtable_add(&tab, key, &values[0]));
+	TEST_ASSERT_EQUAL_PTR(&values[0], hashtable_get(&tab, key));
+}
+
+TEST_GROUP_RUNNER(hashtable)
+{
+	RUN_TEST_CASE(hashtable, add_get_remove);
+	RUN_TEST_CASE(hashtable, key_is_copied);
+	RUN_TEST_CASE(hashtable, hashed_matches_unhashed);
+	RUN_TEST_CASE(hashtable, grow_incrementally);
+	RUN_TEST_CASE(hashtable, colliding_hashes);
+	RUN_TEST_CASE(hashtable, clear);
+}
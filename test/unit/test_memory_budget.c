@@ -0,0 +1,189 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/memory_budget.h"
+
+#include "testud3tn_unity.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+static struct memory_budget_config saved_config;
+static struct memory_budget_stats initial;
+static int stop_calls;
+
+static void set_budgets(const uint64_t total, const uint64_t parsing)
+{
+	struct memory_budget_config config = saved_config;
+
+	config.total_bytes = total;
+	for (int i = 0; i < MEMORY_BUDGET_CATEGORY_COUNT; i++)
+		config.category_bytes[i] = 0;
+	config.category_bytes[MEMORY_BUDGET_PARSING] = parsing;
+	config.backpressure_percent = 50;
+	memory_budget_update_config(config);
+}
+
+static bool release_and_stop(void *param)
+{
+	(void)param;
+	stop_calls++;
+	memory_budget_release(MEMORY_BUDGET_FORWARDING, 800);
+	return false;
+}
+
+static bool always_stop(void *param)
+{
+	(void)param;
+	stop_calls++;
+	return true;
+}
+
+TEST_GROUP(memory_budget);
+
+TEST_SETUP(memory_budget)
+{
+	saved_config = memory_budget_get_config();
+	initial = memory_budget_get_stats();
+	stop_calls = 0;
+}
+
+TEST_TEAR_DOWN(memory_budget)
+{
+	memory_budget_update_config(saved_config);
+}
+
+TEST(memory_budget, account_and_peak)
+{
+	struct memory_budget_stats s;
+
+	set_budgets(0, 0);
+	TEST_ASSERT_TRUE(memory_budget_acquire(MEMORY_BUDGET_PARSING, 100));
+	memory_budget_charge(MEMORY_BUDGET_REASSEMBLY, 50);
+	s = memory_budget_get_stats();
+	TEST_ASSERT_EQUAL_UINT64(initial.total_bytes + 150, s.total_bytes);
+	TEST_ASSERT_EQUAL_UINT64(
+		initial.bytes[MEMORY_BUDGET_PARSING] + 100,
+		s.bytes[MEMORY_BUDGET_PARSING]
+	);
+	TEST_ASSERT_EQUAL_UINT64(
+		initial.bytes[MEMORY_BUDGET_REASSEMBLY] + 50,
+		s.bytes[MEMORY_BUDGET_REASSEMBLY]
+	);
+	TEST_ASSERT_TRUE(s.total_peak_bytes >= s.total_bytes);
+
+	memory_budget_release(MEMORY_BUDGET_PARSING, 100);
+	memory_budget_release(MEMORY_BUDGET_REASSEMBLY, 50);
+	s = memory_budget_get_stats();
+	TEST_ASSERT_EQUAL_UINT64(initial.total_bytes, s.total_bytes);
+	TEST_ASSERT_EQUAL_UINT64(
+		initial.bytes[MEMORY_BUDGET_PARSING],
+		s.bytes[MEMORY_BUDGET_PARSING]
+	);
+	// The peak is retained.
+	TEST_ASSERT_TRUE(s.peak_bytes[MEMORY_BUDGET_PARSING] >=
+			 initial.bytes[MEMORY_BUDGET_PARSING] + 100);
+}
+
+TEST(memory_budget, acquire_respects_budgets)
+{
+	struct memory_budget_stats s;
+
+	set_budgets(initial.total_bytes + 1000,
+		    initial.bytes[MEMORY_BUDGET_PARSING] + 500);
+	TEST_ASSERT_TRUE(memory_budget_acquire(MEMORY_BUDGET_PARSING, 500));
+	// Exceeds the category budget
+	TEST_ASSERT_FALSE(memory_budget_acquire(MEMORY_BUDGET_PARSING, 1));
+	// Exceeds the total budget
+	TEST_ASSERT_FALSE(memory_budget_acquire(MEMORY_BUDGET_AGENT, 501));
+	TEST_ASSERT_TRUE(memory_budget_acquire(MEMORY_BUDGET_AGENT, 500));
+
+	s = memory_budget_get_stats();
+	TEST_ASSERT_EQUAL_UINT64(initial.total_bytes + 1000, s.total_bytes);
+	TEST_ASSERT_EQUAL_UINT64(initial.rejected_count + 2, s.rejected_count);
+	TEST_ASSERT_EQUAL_UINT64(initial.rejected_bytes + 502,
+				 s.rejected_bytes);
+
+	// Charging always succeeds, even beyond the budget.
+	memory_budget_charge(MEMORY_BUDGET_FORWARDING, 100);
+	s = memory_budget_get_stats();
+	TEST_ASSERT_EQUAL_UINT64(initial.total_bytes + 1100, s.total_bytes);
+
+	memory_budget_release(MEMORY_BUDGET_PARSING, 500);
+	memory_budget_release(MEMORY_BUDGET_AGENT, 500);
+	memory_budget_release(MEMORY_BUDGET_FORWARDING, 100);
+	TEST_ASSERT_TRUE(memory_budget_acquire(MEMORY_BUDGET_PARSING, 500));
+	memory_budget_release(MEMORY_BUDGET_PARSING, 500);
+}
+
+TEST(memory_budget, congestion)
+{
+	set_budgets(0, 0);
+	TEST_ASSERT_FALSE(memory_budget_is_congested());
+	TEST_ASSERT_FALSE(memory_budget_wait(always_stop, NULL));
+	TEST_ASSERT_EQUAL(0, stop_calls);
+
+	// Congested above 50 % of the total budget
+	set_budgets(initial.total_bytes + 1000, 0);
+	memory_budget_charge(MEMORY_BUDGET_FORWARDING, 500);
+	TEST_ASSERT_FALSE(memory_budget_is_congested());
+	memory_budget_charge(MEMORY_BUDGET_FORWARDING, 300);
+	TEST_ASSERT_TRUE(memory_budget_is_congested());
+
+	TEST_ASSERT_TRUE(memory_budget_wait(always_stop, NULL));
+	TEST_ASSERT_EQUAL(1, stop_calls);
+	TEST_ASSERT_TRUE(memory_budget_is_congested());
+
+	// Waiting ends as soon as the memory is released.
+	stop_calls = 0;
+	TEST_ASSERT_TRUE(memory_budget_wait(release_and_stop, NULL));
+	TEST_ASSERT_EQUAL(1, stop_calls);
+	TEST_ASSERT_FALSE(memory_budget_is_congested());
+	TEST_ASSERT_EQUAL_UINT64(
+		initial.backpressure_count + 2,
+		memory_budget_get_stats().backpressure_count
+	);
+
+	// Congested above 50 % of a category budget
+	set_budgets(0, initial.bytes[MEMORY_BUDGET_PARSING] + 100);
+	TEST_ASSERT_TRUE(memory_budget_acquire(MEMORY_BUDGET_PARSING, 60));
+	TEST_ASSERT_TRUE(memory_budget_is_congested());
+	memory_budget_release(MEMORY_BUDGET_PARSING, 60);
+	TEST_ASSERT_FALSE(memory_budget_is_congested());
+}
+
+TEST(memory_budget, no_backpressure_from_reassembly_and_agents)
+{
+	struct memory_budget_config config = saved_config;
+
+	for (int i = 0; i < MEMORY_BUDGET_CATEGORY_COUNT; i++)
+		config.category_bytes[i] = initial.bytes[i] + 100;
+	config.total_bytes = 0;
+	config.backpressure_percent = 50;
+	memory_budget_update_config(config);
+
+	// Pausing the RX tasks would prevent the fragments completing a
+	// reassembly from being received, or stall all links for one agent.
+	TEST_ASSERT_TRUE(memory_budget_acquire(MEMORY_BUDGET_REASSEMBLY, 90));
+	memory_budget_charge(MEMORY_BUDGET_AGENT, 200);
+	TEST_ASSERT_FALSE(memory_budget_is_congested());
+	TEST_ASSERT_FALSE(memory_budget_wait(always_stop, NULL));
+
+	// They are not counted for the total budget, either.
+	set_budgets(initial.total_bytes + 300, 0);
+	TEST_ASSERT_FALSE(memory_budget_is_congested());
+
+	// Fragments exceeding the budget are rejected instead.
+	config.total_bytes = 0;
+	memory_budget_update_config(config);
+	TEST_ASSERT_FALSE(memory_budget_acquire(MEMORY_BUDGET_REASSEMBLY, 20));
+
+	memory_budget_release(MEMORY_BUDGET_REASSEMBLY, 90);
+	memory_budget_release(MEMORY_BUDGET_AGENT, 200);
+}
+
+TEST_GROUP_RUNNER(memory_budget)
+{
+	RUN_TEST_CASE(memory_budget, account_and_peak);
+	RUN_TEST_CASE(memory_budget, acquire_respects_budgets);
+	RUN_TEST_CASE(memory_budget, congestion);
+	RUN_TEST_CASE(memory_budget, no_backpressure_from_reassembly_and_agents);
+}
@@ -53,13 +53,13 @@ TEST_SETUP(node)
 	some_eids2->next->next = NULL;
 	some_eids2 = endpoint_list_strip_and_sort(some_eids2);
 	/* contacts */
-	some_ct1 = malloc(sizeof(struct contact_list));
+	some_ct1 = object_pool_alloc(&contact_list_pool);
 	some_ct1->data = createct(1000, 3000, 300, "ipn:1.0");
-	some_ct1->next = malloc(sizeof(struct contact_list));
+	some_ct1->next = object_pool_alloc(&contact_list_pool);
 	some_ct1->next->data = createct(16000000, 16001000, 500,
 					"ipn:1.0");
 	some_ct1->next->next = NULL;
-	some_ct2 = malloc(sizeof(struct contact_list));
+	some_ct2 = object_pool_alloc(&contact_list_pool);
 	some_ct2->data = createct(16000000, 16001000, 600, "ipn:1.0");
 	some_ct2->next = NULL;
 }
@@ -159,7 +159,8 @@ TEST(node, contact_list_union)
 	TEST_ASSERT_NOT_NULL(mod);
 	TEST_ASSERT_NULL(mod->next);
 	TEST_ASSERT_EQUAL_PTR(some_ct1->next->data, mod->data);
-	free(mod); /* data is freed by tear_down */
+	/* data is freed by tear_down */
+	object_pool_free(&contact_list_pool, mod);
 }
 
 TEST(node, contact_list_difference)
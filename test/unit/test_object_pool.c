@@ -0,0 +1,159 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/object_pool.h"
+
+#include "testud3tn_unity.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef PLATFORM_POSIX
+#include <pthread.h>
+#endif // PLATFORM_POSIX
+
+struct test_object {
+	uint64_t id;
+	uint8_t data[40];
+};
+
+#define OBJECT_COUNT (3 * OBJECT_POOL_SLAB_OBJECTS + 1)
+
+static struct test_object *objects[OBJECT_COUNT];
+
+TEST_GROUP(object_pool);
+
+TEST_SETUP(object_pool)
+{
+	memset(objects, 0, sizeof(objects));
+}
+
+TEST_TEAR_DOWN(object_pool)
+{
+}
+
+TEST(object_pool, alloc_and_free)
+{
+	static struct object_pool pool =
+		OBJECT_POOL_INITIALIZER("test", struct test_object);
+	struct test_object *obj = object_pool_alloc(&pool);
+	struct object_pool_stats stats;
+
+	TEST_ASSERT_NOT_NULL(obj);
+	memset(obj, 0xAB, sizeof(*obj));
+	stats = object_pool_get_stats(&pool);
+	TEST_ASSERT_EQUAL_UINT32(1, stats.in_use);
+	TEST_ASSERT_EQUAL_UINT32(1, stats.high_water);
+
+	object_pool_free(&pool, obj);
+	object_pool_free(&pool, NULL);
+	stats = object_pool_get_stats(&pool);
+	TEST_ASSERT_EQUAL_UINT32(0, stats.in_use);
+	TEST_ASSERT_EQUAL_UINT32(1, stats.high_water);
+
+#if !OBJECT_POOL_USE_MALLOC
+	TEST_ASSERT_EQUAL_UINT32(OBJECT_POOL_SLAB_OBJECTS, stats.capacity);
+	// The most recently released object is handed out first.
+	TEST_ASSERT_EQUAL_PTR(obj, object_pool_alloc(&pool));
+	object_pool_free(&pool, obj);
+#endif // !OBJECT_POOL_USE_MALLOC
+}
+
+TEST(object_pool, objects_are_distinct)
+{
+	static struct object_pool pool =
+		OBJECT_POOL_INITIALIZER("test", struct test_object);
+	struct object_pool_stats stats;
+
+	for (uint64_t i = 0; i < OBJECT_COUNT; i++) {
+		objects[i] = object_pool_alloc(&pool);
+		TEST_ASSERT_NOT_NULL(objects[i]);
+		TEST_ASSERT_EQUAL(
+			0,
+			(uintptr_t)objects[i] % sizeof(uint64_t)
+		);
+		objects[i]->id = i;
+		memset(objects[i]->data, (int)i, sizeof(objects[i]->data));
+	}
+	for (uint64_t i = 0; i < OBJECT_COUNT; i++) {
+		TEST_ASSERT_EQUAL_UINT64(i, objects[i]->id);
+		TEST_ASSERT_EQUAL_UINT8((uint8_t)i, objects[i]->data[39]);
+	}
+
+	stats = object_pool_get_stats(&pool);
+	TEST_ASSERT_EQUAL_UINT32(OBJECT_COUNT, stats.in_use);
+	TEST_ASSERT_EQUAL_UINT32(OBJECT_COUNT, stats.high_water);
+
+	for (int i = 0; i < OBJECT_COUNT; i++)
+		object_pool_free(&pool, objects[i]);
+	stats = object_pool_get_stats(&pool);
+	TEST_ASSERT_EQUAL_UINT32(0, stats.in_use);
+	TEST_ASSERT_EQUAL_UINT32(OBJECT_COUNT, stats.high_water);
+
+	const uint32_t capacity = stats.capacity;
+
+	// All objects are reused, also those returned to the global list.
+	for (int i = 0; i < OBJECT_COUNT; i++)
+		objects[i] = object_pool_alloc(&pool);
+	stats = object_pool_get_stats(&pool);
+	TEST_ASSERT_EQUAL_UINT32(capacity, stats.capacity);
+	for (int i = 0; i < OBJECT_COUNT; i++)
+		object_pool_free(&pool, objects[i]);
+}
+
+#ifdef PLATFORM_POSIX
+
+static struct object_pool thread_pool =
+	OBJECT_POOL_INITIALIZER("test", struct test_object);
+
+static void *free_objects(void *param)
+{
+	(void)param;
+	for (int i = 0; i < OBJECT_COUNT; i++)
+		object_pool_free(&thread_pool, objects[i]);
+	object_pool_thread_flush();
+	return NULL;
+}
+
+TEST(object_pool, release_in_other_thread)
+{
+	pthread_t thread;
+	struct object_pool_stats stats;
+
+	for (int i = 0; i < OBJECT_COUNT; i++) {
+		objects[i] = object_pool_alloc(&thread_pool);
+		TEST_ASSERT_NOT_NULL(objects[i]);
+	}
+
+	const uint32_t capacity = object_pool_get_stats(
+		&thread_pool
+	).capacity;
+
+	TEST_ASSERT_EQUAL(0, pthread_create(&thread, NULL,
+					    free_objects, NULL));
+	TEST_ASSERT_EQUAL(0, pthread_join(thread, NULL));
+	stats = object_pool_get_stats(&thread_pool);
+	TEST_ASSERT_EQUAL_UINT32(0, stats.in_use);
+	TEST_ASSERT_EQUAL_UINT32(OBJECT_COUNT, stats.high_water);
+
+	// The objects released by the other thread are handed out again.
+	for (int i = 0; i < OBJECT_COUNT; i++) {
+		objects[i] = object_pool_alloc(&thread_pool);
+		TEST_ASSERT_NOT_NULL(objects[i]);
+	}
+	stats = object_pool_get_stats(&thread_pool);
+	TEST_ASSERT_EQUAL_UINT32(capacity, stats.capacity);
+	for (int i = 0; i < OBJECT_COUNT; i++)
+		object_pool_free(&thread_pool, objects[i]);
+}
+
+#endif // PLATFORM_POSIX
+
+TEST_GROUP_RUNNER(object_pool)
+{
+	RUN_TEST_CASE(object_pool, alloc_and_free);
+	RUN_TEST_CASE(object_pool, objects_are_distinct);
+#ifdef PLATFORM_POSIX
+	RUN_TEST_CASE(object_pool, release_in_other_thread);
+#endif // PLATFORM_POSIX
+}
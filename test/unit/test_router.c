@@ -0,0 +1,546 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/bundle.h"
+#include "ud3tn/eid_intern.h"
+#include "ud3tn/node.h"
+#include "ud3tn/router.h"
+#include "ud3tn/routing_table.h"
+
+#include "bundle6/create.h"
+
+#include "cla/cla.h"
+
+#include "platform/hal_semaphore.h"
+#include "platform/hal_time.h"
+
+#include "testud3tn_unity.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_PAYLOAD_LENGTH 100
+
+static struct node *node;
+static struct contact *c1, *c2;
+static struct contact_list *contacts;
+// All bundles created by the test, freed after it
+static struct bundle *bundles[16];
+static size_t bundle_count;
+static uint32_t bundle_size;
+// Whether the node has been handed over to the routing table
+static bool node_routed;
+
+// The CLA of the node, which is looked up to determine its MBS.
+static size_t cla_mbs;
+
+static const char *cla_name_get(void)
+{
+	return "mtcp";
+}
+
+static size_t cla_mbs_get(struct cla_config *config)
+{
+	(void)config;
+	return cla_mbs;
+}
+
+static const struct cla_vtable cla_vtable = {
+	.cla_name_get = cla_name_get,
+	.cla_mbs_get = cla_mbs_get,
+};
+
+static struct cla_config cla = { .vtable = &cla_vtable };
+
+static struct bundle *create_sized_bundle(const uint32_t payload_length,
+					  const enum bundle_proc_flags flags)
+{
+	void *const payload = calloc(1, payload_length);
+
+	TEST_ASSERT_NOT_NULL(payload);
+
+	struct bundle *const b = bundle6_create_local(
+		payload, payload_length,
+		"dtn://sender/src", "dtn://receiver/sink",
+		// The bundles do not expire before the contacts start.
+		hal_time_get_timestamp_ms(), bundle_count, 3600000,
+		// Enlarge the flags SDNV, such that the priority flags do not
+		// change the bundle size.
+		flags | BUNDLE_FLAG_REPORT_RECEPTION
+	);
+
+	TEST_ASSERT_NOT_NULL(b);
+	bundles[bundle_count++] = b;
+	return b;
+}
+
+static struct bundle *create_bundle(const enum bundle_proc_flags flags)
+{
+	return create_sized_bundle(TEST_PAYLOAD_LENGTH, flags);
+}
+
+static void set_capacity(struct contact *c, int32_t capacity)
+{
+	c->total_capacity_bytes = capacity;
+	c->remaining_capacity_p0 = capacity;
+	c->remaining_capacity_p1 = capacity;
+	c->remaining_capacity_p2 = capacity;
+}
+
+static struct contact *create_contact(uint64_t from_ms, uint64_t to_ms,
+				      int32_t capacity)
+{
+	struct contact *const c = contact_create(node);
+
+	c->from_ms = from_ms;
+	c->to_ms = to_ms;
+	set_capacity(c, capacity);
+	return c;
+}
+
+// Make the node reachable via the CLA, which the routing functions looking up
+// the bundle destination require.
+static void add_node_to_routing_table(void)
+{
+	node->cla_addr = strdup("mtcp:receiver");
+	TEST_ASSERT_NOT_NULL(node->cla_addr);
+	TEST_ASSERT_TRUE(routing_table_add_node(
+		node,
+		(struct rescheduling_handle){ .reschedule_func = NULL }
+	));
+	node_routed = true;
+
+	// The capacity is re-calculated from the (zero) bitrate.
+	set_capacity(c1, 3 * bundle_size);
+	set_capacity(c2, 3 * bundle_size);
+}
+
+static struct bundle *enqueue(struct contact *c,
+			      const enum bundle_proc_flags flags)
+{
+	struct bundle *const b = create_bundle(flags);
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, router_add_bundle_to_contact(c, b));
+	return b;
+}
+
+static size_t list_length(struct routed_bundle_list *list)
+{
+	size_t result = 0;
+
+	for (; list != NULL; list = list->next)
+		result++;
+	return result;
+}
+
+static void free_evicted(struct routed_bundle_list *list)
+{
+	struct routed_bundle_list *next;
+
+	while (list != NULL) {
+		next = list->next;
+		object_pool_free(&routed_bundle_list_pool, list);
+		list = next;
+	}
+}
+
+static bool may_evict_other(struct bundle *bundle, const void *param)
+{
+	return bundle != param;
+}
+
+TEST_GROUP(router);
+
+TEST_SETUP(router)
+{
+	const uint64_t now_ms = hal_time_get_timestamp_ms();
+
+	bundle_count = 0;
+	bundle_size = bundle_get_serialized_size(
+		create_bundle(BUNDLE_FLAG_NONE)
+	);
+	// CLA instances cannot be removed, thus, it is kept registered.
+	cla_register(&cla);
+	cla_mbs = SIZE_MAX;
+	node_routed = false;
+	TEST_ASSERT_EQUAL(UD3TN_OK, routing_table_init());
+
+	node = node_create("dtn://receiver/");
+	// Each contact has capacity for three bundles.
+	c1 = create_contact(now_ms + 10000, now_ms + 20000, 3 * bundle_size);
+	c2 = create_contact(now_ms + 30000, now_ms + 40000, 3 * bundle_size);
+	add_contact_to_ordered_list(&node->contacts, c1, 0);
+	add_contact_to_ordered_list(&node->contacts, c2, 0);
+	contacts = node->contacts;
+}
+
+TEST_TEAR_DOWN(router)
+{
+	if (node_routed) {
+		// Contacts with queued bundles are not deleted.
+		free_evicted(c1->contact_bundles);
+		c1->contact_bundles = NULL;
+		free_evicted(c2->contact_bundles);
+		c2->contact_bundles = NULL;
+		routing_table_free();
+	} else {
+		free_node(node);
+	}
+	for (size_t i = 0; i < bundle_count; i++)
+		bundle_free(bundles[i]);
+}
+
+TEST(router, preempt_lowest_priority_first)
+{
+	struct routed_bundle_list *evicted = NULL;
+	const struct router_preemption_stats before =
+		router_get_preemption_stats();
+
+	struct bundle *low1 = enqueue(c1, BUNDLE_FLAG_NONE);
+	struct bundle *normal = enqueue(c1, BUNDLE_V6_FLAG_NORMAL_PRIORITY);
+	struct bundle *low2 = enqueue(c1, BUNDLE_FLAG_NONE);
+
+	TEST_ASSERT_EQUAL(0, ROUTER_CONTACT_CAPACITY(c1, BUNDLE_RPRIO_LOW));
+	TEST_ASSERT_EQUAL(
+		(int32_t)(2 * bundle_size),
+		ROUTER_CONTACT_CAPACITY(c1, BUNDLE_RPRIO_NORMAL)
+	);
+	TEST_ASSERT_EQUAL(
+		(int32_t)(3 * bundle_size),
+		ROUTER_CONTACT_CAPACITY(c1, BUNDLE_RPRIO_HIGH)
+	);
+
+	// Low-priority bundles cannot displace anything.
+	TEST_ASSERT_NULL(router_preempt_contact(
+		contacts, bundle_size, BUNDLE_RPRIO_LOW, UINT64_MAX, &evicted
+	));
+
+	// Only the most recently queued low-priority bundle is removed.
+	TEST_ASSERT_EQUAL_PTR(c1, router_preempt_contact(
+		contacts, bundle_size, BUNDLE_RPRIO_HIGH, UINT64_MAX, &evicted
+	));
+	TEST_ASSERT_EQUAL(1, list_length(evicted));
+	TEST_ASSERT_EQUAL_PTR(low2, evicted->data);
+	TEST_ASSERT_EQUAL(2, list_length(c1->contact_bundles));
+	TEST_ASSERT_EQUAL_PTR(low1, c1->contact_bundles->data);
+	TEST_ASSERT_EQUAL_PTR(normal, c1->contact_bundles->next->data);
+	TEST_ASSERT_EQUAL(
+		(int32_t)bundle_size,
+		ROUTER_CONTACT_CAPACITY(c1, BUNDLE_RPRIO_LOW)
+	);
+	free_evicted(evicted);
+	evicted = NULL;
+
+	// If a normal-priority bundle has to go, all low-priority ones go
+	// first.
+	TEST_ASSERT_EQUAL_PTR(c1, router_preempt_contact(
+		contacts, 3 * bundle_size, BUNDLE_RPRIO_HIGH, UINT64_MAX,
+		&evicted
+	));
+	TEST_ASSERT_EQUAL(2, list_length(evicted));
+	TEST_ASSERT_NULL(c1->contact_bundles);
+	TEST_ASSERT_EQUAL(
+		(int32_t)(3 * bundle_size),
+		ROUTER_CONTACT_CAPACITY(c1, BUNDLE_RPRIO_LOW)
+	);
+	free_evicted(evicted);
+
+	const struct router_preemption_stats after =
+		router_get_preemption_stats();
+
+	TEST_ASSERT_EQUAL_UINT64(before.preemptions + 2, after.preemptions);
+	TEST_ASSERT_EQUAL_UINT64(
+		before.evicted_bundles[BUNDLE_RPRIO_LOW] + 2,
+		after.evicted_bundles[BUNDLE_RPRIO_LOW]
+	);
+	TEST_ASSERT_EQUAL_UINT64(
+		before.evicted_bundles[BUNDLE_RPRIO_NORMAL] + 1,
+		after.evicted_bundles[BUNDLE_RPRIO_NORMAL]
+	);
+	TEST_ASSERT_EQUAL_UINT64(
+		before.evicted_bytes[BUNDLE_RPRIO_LOW] + 2 * bundle_size,
+		after.evicted_bytes[BUNDLE_RPRIO_LOW]
+	);
+}
+
+TEST(router, evict_lowest_priority_first)
+{
+	struct bundle *low1 = enqueue(c1, BUNDLE_FLAG_NONE);
+	struct bundle *normal = enqueue(c1, BUNDLE_V6_FLAG_NORMAL_PRIORITY);
+	struct bundle *low2 = enqueue(c2, BUNDLE_FLAG_NONE);
+
+	enqueue(c2, BUNDLE_V6_FLAG_EXPEDITED_PRIORITY);
+
+	// The most recently queued bundle of the lowest priority is removed.
+	TEST_ASSERT_EQUAL_PTR(low2, router_evict_bundle(
+		contacts, may_evict_other, NULL
+	));
+	TEST_ASSERT_EQUAL(1, list_length(c2->contact_bundles));
+	TEST_ASSERT_EQUAL(
+		(int32_t)(2 * bundle_size),
+		ROUTER_CONTACT_CAPACITY(c2, BUNDLE_RPRIO_LOW)
+	);
+
+	// Bundles excluded by the callback are kept.
+	TEST_ASSERT_EQUAL_PTR(normal, router_evict_bundle(
+		contacts, may_evict_other, low1
+	));
+	TEST_ASSERT_EQUAL(1, list_length(c1->contact_bundles));
+	TEST_ASSERT_EQUAL_PTR(low1, c1->contact_bundles->data);
+}
+
+TEST(router, expedited_latency_bounded_under_saturation)
+{
+	struct fragment_route route;
+	struct routed_bundle_list *evicted = NULL;
+	struct contact *c;
+	int i;
+
+	// Saturate both contacts with low-priority traffic.
+	for (i = 0; i < 3; i++) {
+		enqueue(c1, BUNDLE_FLAG_NONE);
+		enqueue(c2, BUNDLE_FLAG_NONE);
+	}
+
+	// Without pre-emption, no route is found for expedited bundles.
+	TEST_ASSERT_FALSE(router_calculate_fragment_route(
+		&route, bundle_size, contacts, 0, BUNDLE_RPRIO_HIGH,
+		UINT64_MAX, NULL, 0
+	));
+	TEST_ASSERT_EQUAL(2, route.preemption_improved);
+
+	// With pre-emption, expedited bundles always get the earliest
+	// contact, i.e., are not delayed by the queued low-priority bundles.
+	for (i = 0; i < 6; i++) {
+		c = router_preempt_contact(
+			contacts, bundle_size, BUNDLE_RPRIO_HIGH, UINT64_MAX,
+			&evicted
+		);
+		TEST_ASSERT_EQUAL_PTR(i < 3 ? c1 : c2, c);
+		enqueue(c, BUNDLE_V6_FLAG_EXPEDITED_PRIORITY);
+	}
+	TEST_ASSERT_EQUAL(6, list_length(evicted));
+	free_evicted(evicted);
+	evicted = NULL;
+
+	// When the capacity is used up by expedited bundles, nothing is
+	// displaced anymore.
+	TEST_ASSERT_NULL(router_preempt_contact(
+		contacts, bundle_size, BUNDLE_RPRIO_HIGH, UINT64_MAX, &evicted
+	));
+	TEST_ASSERT_NULL(evicted);
+}
+
+TEST(router, plan_fragments_across_contacts)
+{
+	struct router_result route = { .fragments = 0 };
+	struct contact *const c3 = create_contact(
+		c2->to_ms, c2->to_ms + 10000, 100000
+	);
+	uint32_t used[3] = { 0 }, total_payload = 0, frag_sz;
+	void *const payload = calloc(1, 4000);
+
+	TEST_ASSERT_NOT_NULL(payload);
+	add_contact_to_ordered_list(&node->contacts, c3, 0);
+	contacts = node->contacts;
+
+	struct bundle *const b = bundle6_create_local(
+		payload, 4000,
+		"dtn://sender/src", "dtn://receiver/sink",
+		0, bundle_count, 3600000, BUNDLE_FLAG_NONE
+	);
+
+	TEST_ASSERT_NOT_NULL(b);
+	bundles[bundle_count++] = b;
+
+	const uint32_t first_sz = bundle_get_first_fragment_min_size(b);
+	const uint32_t mid_sz = bundle_get_mid_fragment_min_size(b);
+	const uint32_t last_sz = bundle_get_last_fragment_min_size(b);
+	const uint32_t max_frag_sz = MAX(first_sz, last_sz) + 50;
+
+	// The headers do not fit into the fragments.
+	TEST_ASSERT_EQUAL(0, router_plan_fragments(
+		&route, contacts, b, UINT64_MAX, first_sz - 1
+	));
+	TEST_ASSERT_EQUAL(0, route.fragments);
+
+	TEST_ASSERT_EQUAL(1, router_plan_fragments(
+		&route, contacts, b, UINT64_MAX, max_frag_sz
+	));
+	// There is no fixed limit for the number of fragments.
+	TEST_ASSERT_TRUE(
+		(uint32_t)route.fragments >=
+		4000 / (max_frag_sz - MIN(first_sz, MIN(mid_sz, last_sz)))
+	);
+
+	for (int32_t i = 0; i < route.fragments; i++) {
+		const struct fragment_route *fr = &route.fragment_results[i];
+
+		if (i == 0)
+			frag_sz = first_sz;
+		else if (i == route.fragments - 1)
+			frag_sz = last_sz;
+		else
+			frag_sz = mid_sz;
+		frag_sz += fr->payload_size;
+		TEST_ASSERT_TRUE(frag_sz <= max_frag_sz);
+		TEST_ASSERT_TRUE(fr->payload_size > 0);
+		total_payload += fr->payload_size;
+		// Contacts are filled in order.
+		if (fr->contact == c1) {
+			TEST_ASSERT_EQUAL(0, used[1] + used[2]);
+			used[0] += frag_sz;
+		} else if (fr->contact == c2) {
+			TEST_ASSERT_EQUAL(0, used[2]);
+			used[1] += frag_sz;
+		} else {
+			TEST_ASSERT_EQUAL_PTR(c3, fr->contact);
+			used[2] += frag_sz;
+		}
+	}
+	TEST_ASSERT_EQUAL(4000, total_payload);
+	// The smaller contacts are used up to their capacity.
+	TEST_ASSERT_TRUE(used[0] > 2 * bundle_size);
+	TEST_ASSERT_TRUE(used[0] <= 3 * bundle_size);
+	TEST_ASSERT_TRUE(used[1] > 2 * bundle_size);
+	TEST_ASSERT_TRUE(used[1] <= 3 * bundle_size);
+	TEST_ASSERT_TRUE(used[2] > 0);
+
+	router_result_free(&route);
+	TEST_ASSERT_NULL(route.fragment_results);
+}
+
+TEST(router, direct_contact_hit)
+{
+	struct bundle *const b = create_bundle(BUNDLE_FLAG_NONE);
+
+	add_node_to_routing_table();
+
+	// The first contact with enough capacity is used.
+	TEST_ASSERT_EQUAL_PTR(c1, router_get_direct_contact(b));
+	enqueue(c1, BUNDLE_FLAG_NONE);
+	enqueue(c1, BUNDLE_FLAG_NONE);
+	TEST_ASSERT_EQUAL_PTR(c1, router_get_direct_contact(b));
+	enqueue(c1, BUNDLE_FLAG_NONE);
+	TEST_ASSERT_EQUAL_PTR(c2, router_get_direct_contact(b));
+
+	// The same contact is determined by the generic router.
+	struct router_result route = router_get_first_route(b);
+
+	TEST_ASSERT_EQUAL(1, route.fragments);
+	TEST_ASSERT_EQUAL_PTR(c2, route.fragment_results[0].contact);
+	router_result_free(&route);
+}
+
+TEST(router, direct_contact_miss_falls_back)
+{
+	struct router_result route;
+	// Exceeds the capacity left in each contact, but not in both together
+	struct bundle *const large = create_sized_bundle(
+		TEST_PAYLOAD_LENGTH * 3 / 2,
+		BUNDLE_FLAG_NONE
+	);
+	struct bundle *const small = create_bundle(BUNDLE_FLAG_NONE);
+
+	// Unknown destinations cannot be reached directly.
+	TEST_ASSERT_NULL(router_get_direct_contact(small));
+
+	add_node_to_routing_table();
+	enqueue(c1, BUNDLE_FLAG_NONE);
+	enqueue(c1, BUNDLE_FLAG_NONE);
+	enqueue(c2, BUNDLE_FLAG_NONE);
+	enqueue(c2, BUNDLE_FLAG_NONE);
+
+	// Bundles not fitting into a single contact are fragmented.
+	TEST_ASSERT_NULL(router_get_direct_contact(large));
+	route = router_get_first_route(large);
+	TEST_ASSERT_EQUAL(2, route.fragments);
+	TEST_ASSERT_EQUAL_PTR(c1, route.fragment_results[0].contact);
+	TEST_ASSERT_EQUAL_PTR(c2, route.fragment_results[1].contact);
+	router_result_free(&route);
+
+	// Bundles exceeding the MBS of the CLA are fragmented as well.
+	cla_mbs = bundle_size - 1;
+	TEST_ASSERT_NULL(router_get_direct_contact(small));
+	route = router_get_first_route(small);
+	TEST_ASSERT_TRUE(route.fragments > 1);
+	router_result_free(&route);
+}
+
+TEST(router, direct_snapshot_contact)
+{
+	struct bundle *const b = create_bundle(BUNDLE_FLAG_NONE);
+	const struct routing_table_snapshot *snapshot;
+	const struct contact_snapshot *cs;
+
+	add_node_to_routing_table();
+	snapshot = routing_table_snapshot_acquire();
+
+	// The destination is looked up by its node ID.
+	TEST_ASSERT_EQUAL_UINT32(2, routing_table_snapshot_lookup(
+		snapshot,
+		eid_intern_get_node_id(b->destination),
+		&cs
+	));
+	TEST_ASSERT_EQUAL_PTR(c1, router_get_direct_snapshot_contact(b, cs, 2));
+	enqueue(c1, BUNDLE_FLAG_NONE);
+	enqueue(c1, BUNDLE_FLAG_NONE);
+	enqueue(c1, BUNDLE_FLAG_NONE);
+	TEST_ASSERT_EQUAL_PTR(c2, router_get_direct_snapshot_contact(b, cs, 2));
+	cla_mbs = bundle_size - 1;
+	TEST_ASSERT_NULL(router_get_direct_snapshot_contact(b, cs, 2));
+
+	routing_table_snapshot_release(snapshot);
+}
+
+TEST(router, route_locking_via_snapshot)
+{
+	struct bundle *const small = create_bundle(BUNDLE_FLAG_NONE);
+	struct bundle *const expedited = create_bundle(
+		BUNDLE_V6_FLAG_EXPEDITED_PRIORITY
+	);
+	struct routed_bundle_list *preempted;
+	Semaphore_t lock = hal_semaphore_init_binary();
+
+	TEST_ASSERT_NOT_NULL(lock);
+	hal_semaphore_release(lock);
+	add_node_to_routing_table();
+	enqueue(c1, BUNDLE_FLAG_NONE);
+	enqueue(c1, BUNDLE_FLAG_NONE);
+
+	TEST_ASSERT_EQUAL(
+		ROUTER_RESULT_OK,
+		router_route_bundle_locking(small, lock, &preempted)
+	);
+	TEST_ASSERT_NULL(preempted);
+	TEST_ASSERT_EQUAL_PTR(small, c1->contact_bundles->next->next->data);
+	TEST_ASSERT_FALSE(hal_semaphore_is_blocked(lock));
+
+	// Pre-emption needs the regular route, with the lock held.
+	enqueue(c2, BUNDLE_FLAG_NONE);
+	enqueue(c2, BUNDLE_FLAG_NONE);
+	enqueue(c2, BUNDLE_FLAG_NONE);
+	TEST_ASSERT_EQUAL(
+		ROUTER_RESULT_OK,
+		router_route_bundle_locking(expedited, lock, &preempted)
+	);
+	TEST_ASSERT_EQUAL(1, list_length(preempted));
+	TEST_ASSERT_EQUAL_PTR(small, preempted->data);
+	TEST_ASSERT_FALSE(hal_semaphore_is_blocked(lock));
+	free_evicted(preempted);
+
+	hal_semaphore_delete(lock);
+}
+
+TEST_GROUP_RUNNER(router)
+{
+	RUN_TEST_CASE(router, preempt_lowest_priority_first);
+	RUN_TEST_CASE(router, evict_lowest_priority_first);
+	RUN_TEST_CASE(router, expedited_latency_bounded_under_saturation);
+	RUN_TEST_CASE(router, plan_fragments_across_contacts);
+	RUN_TEST_CASE(router, direct_contact_hit);
+	RUN_TEST_CASE(router, direct_contact_miss_falls_back);
+	RUN_TEST_CASE(router, direct_snapshot_contact);
+	RUN_TEST_CASE(router, route_locking_via_snapshot);
+}
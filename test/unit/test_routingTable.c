@@ -1,5 +1,6 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
 #include "ud3tn/bundle_processor.h"
+#include "ud3tn/eid_intern.h"
 #include "ud3tn/node.h"
 #include "ud3tn/routing_table.h"
 
@@ -273,8 +274,79 @@ TEST(routingTable, routing_table_replace)
 	free_node(node3);
 }
 
+TEST(routingTable, routing_table_snapshot)
+{
+	const struct routing_table_snapshot *s1, *s2;
+	const struct contact_snapshot *cs;
+	const char *const eid1 = eid_intern("node1");
+	const char *const eid2 = eid_intern("node2");
+	const char *const eid5 = eid_intern("node5");
+
+	// This is normally done by `router_task`
+	TEST_ASSERT_EQUAL(1, node_prepare_and_verify(node11, 0));
+	TEST_ASSERT_EQUAL(1, node_prepare_and_verify(node2, 0));
+
+	TEST_ASSERT_TRUE(routing_table_add_node(node11, rescheduler));
+	s1 = routing_table_snapshot_acquire();
+	TEST_ASSERT_NOT_NULL(s1);
+	TEST_ASSERT_EQUAL_UINT32(routing_table_get_version(), s1->version);
+	TEST_ASSERT_EQUAL_UINT32(3, s1->contact_count);
+	TEST_ASSERT_EQUAL_PTR(c1, s1->contacts[0].contact);
+	TEST_ASSERT_EQUAL_PTR(c2, s1->contacts[1].contact);
+	TEST_ASSERT_EQUAL_PTR(c3, s1->contacts[2].contact);
+	TEST_ASSERT_EQUAL_UINT64(4, s1->contacts[2].from_ms);
+	TEST_ASSERT_EQUAL_UINT64(5, s1->contacts[2].to_ms);
+
+	// The contacts are looked up by node and reachable EID.
+	TEST_ASSERT_EQUAL_UINT32(3, routing_table_snapshot_lookup(
+		s1, eid1, &cs));
+	TEST_ASSERT_EQUAL_PTR(c1, cs[0].contact);
+	TEST_ASSERT_EQUAL_PTR(c2, cs[1].contact);
+	TEST_ASSERT_EQUAL_PTR(c3, cs[2].contact);
+	TEST_ASSERT_EQUAL_UINT32(1, routing_table_snapshot_lookup(
+		s1, eid2, &cs));
+	TEST_ASSERT_EQUAL_PTR(c1, cs[0].contact);
+	TEST_ASSERT_EQUAL_UINT32(0, routing_table_snapshot_lookup(
+		s1, eid5, &cs));
+
+	// The held snapshot must not change or vanish on modification
+	TEST_ASSERT_TRUE(routing_table_add_node(node2, rescheduler));
+	s2 = routing_table_snapshot_acquire();
+	TEST_ASSERT_NOT_NULL(s2);
+	TEST_ASSERT_TRUE(s2 != s1);
+	TEST_ASSERT_EQUAL_UINT32(routing_table_get_version(), s2->version);
+	TEST_ASSERT_TRUE(s1->version != s2->version);
+	TEST_ASSERT_EQUAL_UINT32(3, s1->contact_count);
+	TEST_ASSERT_EQUAL_PTR(c3, s1->contacts[2].contact);
+	TEST_ASSERT_EQUAL_UINT32(5, s2->contact_count);
+	TEST_ASSERT_EQUAL_PTR(c8, s2->contacts[3].contact);
+	TEST_ASSERT_EQUAL_PTR(c7, s2->contacts[4].contact);
+	TEST_ASSERT_EQUAL_UINT32(1, routing_table_snapshot_lookup(
+		s1, eid2, &cs));
+	TEST_ASSERT_TRUE(routing_table_snapshot_lookup(s2, eid2, &cs) > 1);
+	routing_table_snapshot_release(s2);
+	routing_table_snapshot_release(s1);
+
+	TEST_ASSERT_TRUE(routing_table_delete_node(
+		node_create("node1"), rescheduler));
+	s1 = routing_table_snapshot_acquire();
+	TEST_ASSERT_EQUAL_UINT32(2, s1->contact_count);
+	routing_table_snapshot_release(s1);
+	TEST_ASSERT_TRUE(routing_table_delete_node(
+		node_create("node2"), rescheduler));
+	free_node(node12);
+	free_node(node13);
+	free_node(node14);
+	free_node(node3);
+	free_node(node4);
+	eid_intern_release(eid1);
+	eid_intern_release(eid2);
+	eid_intern_release(eid5);
+}
+
 TEST_GROUP_RUNNER(routingTable)
 {
 	RUN_TEST_CASE(routingTable, routing_table_add_delete);
 	RUN_TEST_CASE(routingTable, routing_table_replace);
+	RUN_TEST_CASE(routingTable, routing_table_snapshot);
 }
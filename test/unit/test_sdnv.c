@@ -5,6 +5,8 @@
 
 #include "testud3tn_unity.h"
 
+#include <string.h>
+
 TEST_GROUP(sdnv);
 
 TEST_SETUP(sdnv)
@@ -194,9 +196,80 @@ TEST(sdnv, sdnv_read)
 	TEST_ASSERT_EQUAL_INT(10, i);
 }
 
+TEST(sdnv, sdnv_decode)
+{
+	/* Trailing bytes must not be taken into account */
+	uint8_t buffer[16] = { 0 };
+	uint16_t t16;
+	uint32_t t32;
+	uint64_t t64;
+
+	/* max16, tst16, err16 */
+	memcpy(buffer, ARR_MAX16, sizeof(ARR_MAX16));
+	TEST_ASSERT_EQUAL_INT(3, sdnv_decode_u16(buffer, sizeof(buffer), &t16));
+	TEST_ASSERT_EQUAL_HEX16(VAL_MAX16, t16);
+	TEST_ASSERT_EQUAL_INT(3, sdnv_decode_u16(ARR_TST16, 3, &t16));
+	TEST_ASSERT_EQUAL_HEX16(VAL_TST16, t16);
+	TEST_ASSERT_EQUAL_INT(0, sdnv_decode_u16(ARR_ERR16, 3, &t16));
+	TEST_ASSERT_EQUAL_HEX16(VAL_TST16, t16);
+	/* max32, tst32, err32 */
+	memcpy(buffer, ARR_MAX32, sizeof(ARR_MAX32));
+	TEST_ASSERT_EQUAL_INT(5, sdnv_decode_u32(buffer, sizeof(buffer), &t32));
+	TEST_ASSERT_EQUAL_HEX32(VAL_MAX32, t32);
+	TEST_ASSERT_EQUAL_INT(3, sdnv_decode_u32(ARR_TST16, 3, &t32));
+	TEST_ASSERT_EQUAL_HEX32(VAL_TST16, t32);
+	memcpy(buffer, ARR_ERR32, sizeof(ARR_ERR32));
+	TEST_ASSERT_EQUAL_INT(0, sdnv_decode_u32(buffer, sizeof(buffer), &t32));
+	/* max64, tst64, err64 */
+	memcpy(buffer, ARR_MAX64, sizeof(ARR_MAX64));
+	TEST_ASSERT_EQUAL_INT(10, sdnv_decode_u64(buffer, sizeof(buffer), &t64));
+	TEST_ASSERT_EQUAL_HEX64(VAL_MAX64, t64);
+	TEST_ASSERT_EQUAL_INT(10, sdnv_decode_u64(ARR_MAX64, 10, &t64));
+	TEST_ASSERT_EQUAL_HEX64(VAL_MAX64, t64);
+	TEST_ASSERT_EQUAL_INT(3, sdnv_decode_u64(ARR_TST16, 3, &t64));
+	TEST_ASSERT_EQUAL_HEX64(VAL_TST16, t64);
+	TEST_ASSERT_EQUAL_INT(0, sdnv_decode_u64(ARR_ERR64, 10, &t64));
+	/* SDNVs not ending within the buffer */
+	TEST_ASSERT_EQUAL_INT(0, sdnv_decode_u16(ARR_MAX16, 2, &t16));
+	TEST_ASSERT_EQUAL_INT(0, sdnv_decode_u32(ARR_MAX32, 4, &t32));
+	TEST_ASSERT_EQUAL_INT(0, sdnv_decode_u64(ARR_MAX64, 9, &t64));
+	TEST_ASSERT_EQUAL_INT(0, sdnv_decode_u64(ARR_MAX64, 0, &t64));
+}
+
+TEST(sdnv, sdnv_decode_matches_read)
+{
+	uint8_t buffer[16];
+	struct sdnv_state s;
+	uint64_t expected, t64;
+	int_fast8_t size;
+	size_t i;
+
+	/* Pseudo-random values of all lengths at varying buffer offsets */
+	for (uint32_t v = 0; v < (1 << 21); v += 7) {
+		const uint64_t value = ((uint64_t)v * 0x9E3779B97F4A7C15) >>
+			(v & 63);
+
+		size = sdnv_write_u64(buffer + (v % 6), value);
+		TEST_ASSERT_EQUAL_INT(sdnv_get_size_u64(value), size);
+		TEST_ASSERT_EQUAL_INT(size, sdnv_decode_u64(
+			buffer + (v % 6), sizeof(buffer) - (v % 6), &t64));
+		TEST_ASSERT_EQUAL_HEX64(value, t64);
+
+		/* The same bytes passed to the state machine */
+		i = 0;
+		sdnv_reset(&s);
+		while (s.status == SDNV_IN_PROGRESS && i < (size_t)size)
+			sdnv_read_u64(&s, &expected, buffer[(v % 6) + i++]);
+		TEST_ASSERT_EQUAL_INT(SDNV_DONE, s.status);
+		TEST_ASSERT_EQUAL_HEX64(expected, t64);
+	}
+}
+
 TEST_GROUP_RUNNER(sdnv)
 {
 	RUN_TEST_CASE(sdnv, sdnv_get_size);
 	RUN_TEST_CASE(sdnv, sdnv_write);
 	RUN_TEST_CASE(sdnv, sdnv_read);
+	RUN_TEST_CASE(sdnv, sdnv_decode);
+	RUN_TEST_CASE(sdnv, sdnv_decode_matches_read);
 }